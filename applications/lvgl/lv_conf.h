@@ -6,10 +6,60 @@
 #define LV_COLOR_16_SWAP 0
 #define LV_COLOR_DEPTH 16
 #define LV_USE_PERF_MONITOR 1
-// #define LV_USE_GPU_STM32_DMA2D 1
-// #define LV_STM32_DMA2D_TEST
 
 #include <rtconfig.h>
+
+// 绘制后端(menuconfig里选择, 同一时间只能用一个)，不支持的操作都自动回退到软件绘制(draw_sw):
+//
+//   操作                   | DMA2D                  | Arm-2D
+//   -----------------------+------------------------+------------------------------
+//   纯色填充(可带透明度)   | 硬件                   | 加速
+//   带蒙版填充(字体/圆角)  | 硬件(A8蒙版)           | 加速
+//   图片拷贝/透明度混合    | 硬件                   | 加速
+//   带蒙版的图片混合       | 硬件(ARGB8888中转)     | 加速
+//   图片旋转/缩放          | 软件                   | 加速(RGB565/RGB565A8图片, 无抗锯齿, 无重新着色)
+//   ADDITIVE等混合模式     | 软件                   | 软件
+//   重新着色(recolor)      | 软件                   | 加速(不旋转缩放时)
+//   屏幕透明(screen_transp)| 软件                   | 软件
+#if defined(BSP_LVGL_DRAW_ARM2D)
+// Arm-2D: 需要Arm-2D软件包(PKG_USING_ARM_2D)，Cortex-M4上使用其DSP优化的C实现
+#define LV_USE_GPU_ARM2D 1
+#define LV_USE_GPU_STM32_DMA2D 0
+#elif defined(BSP_LVGL_DRAW_DMA2D)
+// 使用DMA2D绘制(填充/图片混合/字体A8蒙版)
+#define LV_USE_GPU_ARM2D 0
+#define LV_USE_GPU_STM32_DMA2D 1
+#define LV_GPU_DMA2D_CMSIS_INCLUDE "stm32f4xx.h"
+// #define LV_STM32_DMA2D_TEST
+#else
+// 纯软件绘制
+#define LV_USE_GPU_ARM2D 0
+#define LV_USE_GPU_STM32_DMA2D 0
+#endif
+// 梯度缓存: 大小在menuconfig里设置(0为不缓存)，可以放到SDRAM里节省片内SRAM
+#ifdef BSP_LVGL_GRAD_CACHE_SIZE
+#define LV_GRAD_CACHE_DEF_SIZE BSP_LVGL_GRAD_CACHE_SIZE
+#endif
+#ifdef BSP_LVGL_GRAD_CACHE_IN_SDRAM
+#define LV_GRAD_CACHE_CUSTOM 1
+#define LV_GRAD_CACHE_CUSTOM_INCLUDE "lv_port_mem.h"
+#define LV_GRAD_CACHE_CUSTOM_ALLOC lv_port_sdram_alloc
+#define LV_GRAD_CACHE_CUSTOM_FREE lv_port_sdram_free
+#endif
+// 图片解码线程: PNG/SJPG在后台线程里解码，解码完成前显示占位色块，解码结果放在图片缓存里
+#ifdef BSP_LVGL_IMG_ASYNC
+#define LV_USE_PNG 1
+#define LV_USE_SJPG 1
+#define LV_USE_IMG_ASYNC 1
+#define LV_IMG_CACHE_DEF_SIZE 8
+#endif
+// 资源文件系统: 挂载在BSP_ASSETFS_PATH的romfs镜像，用"A:img/xxx.bin"打开，图片和字体直接使用镜像里的数据，不再拷贝
+#ifdef BSP_USING_ASSETFS
+#define LV_USE_FS_POSIX 1
+#define LV_FS_POSIX_LETTER 'A'
+#define LV_FS_POSIX_PATH BSP_ASSETFS_PATH "/"
+#define LV_FS_POSIX_CACHE_SIZE 0
+#endif
 #define LV_HOR_RES_MAX 800 // 你屏幕的高
 #define LV_VER_RES_MAX 480 // 你屏幕的宽
 
@@ -1,6 +1,8 @@
 #include <rtthread.h>
 #include <lvgl.h>
 #include <lv_port_indev.h>
+#include "lv_draw_bench.h"
+#include "lv_port_fs.h"
 
 #define DBG_TAG "LVGL.demo"
 #define DBG_LVL DBG_INFO
@@ -81,6 +83,10 @@ static void lvgl_thread_entry(void *parameter)
 
     lv_port_indev_init();
 
+    lv_draw_bench_init();
+
+    lv_port_fs_init();
+
     // 同时使用会冲突
     //  lv_example_get_started_1(); // 小按钮，按一下加一
     lv_example_get_started_3(); // 滑块
@@ -0,0 +1,424 @@
+/**
+ * @file lv_draw_bench.c
+ *
+ * 绘制性能测试: 用当前的绘制后端(DMA2D/Arm-2D)和纯软件绘制(draw_sw)分别绘制同一组场景，
+ * 打印两者的耗时和结果的最大通道误差。
+ * 用法(msh): lv_draw_bench [循环次数]
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <rtthread.h>
+#include <rthw.h>
+#include <stdlib.h>
+#include "lv_draw_bench.h"
+#include "lv_draw_sw.h"
+
+#ifdef BSP_USING_LVGL_DRAW_BENCH
+
+#define DBG_TAG "LVGL.bench"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_W         200 /* 离屏绘制区域的大小 */
+#define BENCH_H         60
+#define BENCH_IMG_W     64  /* 测试图片的大小 */
+#define BENCH_IMG_H     48
+#define BENCH_LOOP_DEF  50
+#define BENCH_TIMEOUT   (RT_TICK_PER_SECOND * 60)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct
+{
+    const char *name;
+    void (*draw)(lv_draw_ctx_t *draw_ctx);
+} bench_scene_t;
+
+/* msh请求的状态，关中断读写 */
+typedef enum
+{
+    BENCH_IDLE,
+    BENCH_REQUESTED,  /* msh等待LVGL线程开始 */
+    BENCH_RUNNING,
+    BENCH_DONE,       /* 运行结束，信号量已经或马上释放，等msh取走 */
+    BENCH_CANCELLED,  /* msh已超时返回，运行结束后不再释放信号量 */
+} bench_state_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void scene_fill(lv_draw_ctx_t *draw_ctx);
+static void scene_fill_opa(lv_draw_ctx_t *draw_ctx);
+static void scene_rounded(lv_draw_ctx_t *draw_ctx);
+static void scene_img_copy(lv_draw_ctx_t *draw_ctx);
+static void scene_img_opa(lv_draw_ctx_t *draw_ctx);
+static void scene_img_alpha(lv_draw_ctx_t *draw_ctx);
+static void scene_img_transform(lv_draw_ctx_t *draw_ctx);
+static void scene_text(lv_draw_ctx_t *draw_ctx);
+static void bench_timer_cb(lv_timer_t *timer);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static const bench_scene_t scenes[] =
+{
+    {"fill",          scene_fill},
+    {"fill opa",      scene_fill_opa},
+    {"rounded rect",  scene_rounded},
+    {"img copy",      scene_img_copy},
+    {"img opa",       scene_img_opa},
+    {"img alpha",     scene_img_alpha},
+    {"img rotate",    scene_img_transform},
+    {"text",          scene_text},
+};
+
+static uint8_t img_rgb_data[BENCH_IMG_W * BENCH_IMG_H * sizeof(lv_color_t)];
+static uint8_t img_argb_data[BENCH_IMG_W * BENCH_IMG_H * LV_IMG_PX_SIZE_ALPHA_BYTE];
+static lv_img_dsc_t img_rgb;
+static lv_img_dsc_t img_argb;
+
+static lv_area_t bench_area;
+static volatile bench_state_t bench_state;
+static rt_uint32_t bench_loops;          /* msh请求的循环次数 */
+static struct rt_semaphore bench_done;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_draw_bench_init(void)
+{
+    rt_uint32_t x, y;
+
+    /* 生成测试图片: 渐变色，带alpha的图片左右两边透明 */
+    for (y = 0; y < BENCH_IMG_H; y++)
+    {
+        for (x = 0; x < BENCH_IMG_W; x++)
+        {
+            lv_color_t c = lv_color_make(x * 4, y * 5, (x + y) * 2);
+            rt_uint32_t i = y * BENCH_IMG_W + x;
+            rt_memcpy(&img_rgb_data[i * sizeof(lv_color_t)], &c, sizeof(lv_color_t));
+            rt_memcpy(&img_argb_data[i * LV_IMG_PX_SIZE_ALPHA_BYTE], &c, sizeof(lv_color_t));
+            img_argb_data[i * LV_IMG_PX_SIZE_ALPHA_BYTE + LV_IMG_PX_SIZE_ALPHA_BYTE - 1] =
+                (x < 8 || x >= BENCH_IMG_W - 8) ? LV_OPA_TRANSP : (lv_opa_t)(x * 4);
+        }
+    }
+
+    img_rgb.header.cf = LV_IMG_CF_TRUE_COLOR;
+    img_rgb.header.w = BENCH_IMG_W;
+    img_rgb.header.h = BENCH_IMG_H;
+    img_rgb.data_size = sizeof(img_rgb_data);
+    img_rgb.data = img_rgb_data;
+
+    img_argb.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    img_argb.header.w = BENCH_IMG_W;
+    img_argb.header.h = BENCH_IMG_H;
+    img_argb.data_size = sizeof(img_argb_data);
+    img_argb.data = img_argb_data;
+
+    lv_area_set(&bench_area, 0, 0, BENCH_W - 1, BENCH_H - 1);
+    rt_sem_init(&bench_done, "lvbench", 0, RT_IPC_FLAG_PRIO);
+
+    /* 测试必须在LVGL线程里运行，这里轮询msh的请求。定时器一直运行，msh线程不碰LVGL */
+    lv_timer_create(bench_timer_cb, 100, NULL);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void scene_fill(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_palette_main(LV_PALETTE_BLUE);
+    lv_draw_rect(draw_ctx, &dsc, &bench_area);
+}
+
+static void scene_fill_opa(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_palette_main(LV_PALETTE_RED);
+    dsc.bg_opa = LV_OPA_50;
+    lv_draw_rect(draw_ctx, &dsc, &bench_area);
+}
+
+static void scene_rounded(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_rect_dsc_t dsc;
+    lv_draw_rect_dsc_init(&dsc);
+    dsc.bg_color = lv_palette_main(LV_PALETTE_GREEN);
+    dsc.radius = 20;
+    dsc.border_width = 3;
+    dsc.border_color = lv_palette_darken(LV_PALETTE_GREEN, 3);
+
+    lv_area_t a;
+    lv_area_set(&a, 5, 5, BENCH_W - 6, BENCH_H - 6);
+    lv_draw_rect(draw_ctx, &dsc, &a);
+}
+
+/* 把图片平铺在整个区域上 */
+static void draw_img_tiled(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_img_dsc_t *img)
+{
+    lv_coord_t x, y;
+    for (y = 0; y < BENCH_H; y += BENCH_IMG_H)
+    {
+        for (x = 0; x < BENCH_W; x += BENCH_IMG_W)
+        {
+            lv_area_t a;
+            lv_area_set(&a, x, y, x + BENCH_IMG_W - 1, y + BENCH_IMG_H - 1);
+            lv_draw_img(draw_ctx, dsc, &a, img);
+        }
+    }
+}
+
+static void scene_img_copy(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+    draw_img_tiled(draw_ctx, &dsc, &img_rgb);
+}
+
+static void scene_img_opa(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+    dsc.opa = LV_OPA_60;
+    draw_img_tiled(draw_ctx, &dsc, &img_rgb);
+}
+
+static void scene_img_alpha(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+    draw_img_tiled(draw_ctx, &dsc, &img_argb);
+}
+
+static void scene_img_transform(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+    dsc.angle = 300; /* 30度 */
+    dsc.zoom = 320;  /* 1.25倍 */
+    dsc.pivot.x = BENCH_IMG_W / 2;
+    dsc.pivot.y = BENCH_IMG_H / 2;
+    dsc.antialias = 0;
+
+    lv_area_t a;
+    lv_area_set(&a, (BENCH_W - BENCH_IMG_W) / 2, (BENCH_H - BENCH_IMG_H) / 2,
+                (BENCH_W + BENCH_IMG_W) / 2 - 1, (BENCH_H + BENCH_IMG_H) / 2 - 1);
+    lv_draw_img(draw_ctx, &dsc, &a, &img_rgb);
+}
+
+static void scene_text(lv_draw_ctx_t *draw_ctx)
+{
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.color = lv_color_black();
+
+    lv_draw_label(draw_ctx, &dsc, &bench_area,
+                  "RT-Thread + LVGL draw benchmark\n"
+                  "The quick brown fox jumps over the lazy dog\n"
+                  "0123456789 !\"#$%&'()*+,-./:;<=>?", NULL);
+}
+
+/* 把绘制上下文指向离屏缓冲区，原来的设置保存到saved里 */
+static void ctx_attach(lv_draw_ctx_t *draw_ctx, lv_color_t *buf, lv_draw_ctx_t *saved)
+{
+    saved->buf = draw_ctx->buf;
+    saved->buf_area = draw_ctx->buf_area;
+    saved->clip_area = draw_ctx->clip_area;
+
+    draw_ctx->buf = buf;
+    draw_ctx->buf_area = &bench_area;
+    draw_ctx->clip_area = &bench_area;
+}
+
+static void ctx_detach(lv_draw_ctx_t *draw_ctx, const lv_draw_ctx_t *saved)
+{
+    draw_ctx->buf = saved->buf;
+    draw_ctx->buf_area = saved->buf_area;
+    draw_ctx->clip_area = saved->clip_area;
+}
+
+/* 绘制loops次，返回耗时(ms) */
+static rt_uint32_t scene_run(lv_draw_ctx_t *draw_ctx, lv_color_t *buf, const bench_scene_t *scene, rt_uint32_t loops)
+{
+    lv_draw_ctx_t saved;
+    rt_uint32_t i;
+
+    lv_memset_ff(buf, BENCH_W * BENCH_H * sizeof(lv_color_t));
+    ctx_attach(draw_ctx, buf, &saved);
+
+    rt_tick_t start = rt_tick_get();
+    for (i = 0; i < loops; i++)
+    {
+        scene->draw(draw_ctx);
+    }
+    lv_draw_wait_for_finish(draw_ctx);
+    rt_tick_t ticks = rt_tick_get() - start;
+
+    ctx_detach(draw_ctx, &saved);
+    return ticks * 1000 / RT_TICK_PER_SECOND;
+}
+
+static rt_uint32_t max_channel_diff(const lv_color_t *a, const lv_color_t *b)
+{
+    rt_uint32_t max_diff = 0;
+    rt_uint32_t i;
+    for (i = 0; i < BENCH_W * BENCH_H; i++)
+    {
+        rt_uint32_t a32 = lv_color_to32(a[i]);
+        rt_uint32_t b32 = lv_color_to32(b[i]);
+        rt_uint32_t shift;
+        for (shift = 0; shift < 24; shift += 8)
+        {
+            rt_int32_t d = (rt_int32_t)((a32 >> shift) & 0xFF) - (rt_int32_t)((b32 >> shift) & 0xFF);
+            if (d < 0)
+                d = -d;
+            if ((rt_uint32_t)d > max_diff)
+                max_diff = d;
+        }
+    }
+    return max_diff;
+}
+
+static void bench_run(rt_uint32_t loops)
+{
+    lv_disp_t *disp = lv_disp_get_default();
+    lv_draw_ctx_t *gpu_ctx = disp->driver->draw_ctx;
+    lv_draw_sw_ctx_t *sw_ctx;
+    lv_color_t *gpu_buf, *sw_buf;
+    rt_uint32_t i;
+
+    gpu_buf = rt_malloc(BENCH_W * BENCH_H * sizeof(lv_color_t));
+    sw_buf = rt_malloc(BENCH_W * BENCH_H * sizeof(lv_color_t));
+    sw_ctx = lv_mem_alloc(sizeof(lv_draw_sw_ctx_t));
+    if (gpu_buf == RT_NULL || sw_buf == RT_NULL || sw_ctx == RT_NULL)
+    {
+        LOG_E("no memory for the benchmark buffers");
+        goto _exit;
+    }
+    lv_draw_sw_init_ctx(disp->driver, &sw_ctx->base_draw);
+
+    /* 绘制函数需要知道当前刷新的显示器 */
+    lv_disp_t *refr_disp = _lv_refr_get_disp_refreshing();
+    _lv_refr_set_disp_refreshing(disp);
+
+    rt_kprintf("LVGL draw benchmark: %dx%d px, %d loops\n", BENCH_W, BENCH_H, loops);
+    rt_kprintf("%-14s %10s %10s %8s %6s\n", "scene", "gpu(ms)", "sw(ms)", "speedup", "diff");
+    for (i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++)
+    {
+        rt_uint32_t t_gpu = scene_run(gpu_ctx, gpu_buf, &scenes[i], loops);
+        rt_uint32_t t_sw = scene_run(&sw_ctx->base_draw, sw_buf, &scenes[i], loops);
+        rt_uint32_t speedup = t_gpu ? t_sw * 100 / t_gpu : 0;
+
+        rt_kprintf("%-14s %10d %10d %5d.%02d %6d\n", scenes[i].name, t_gpu, t_sw,
+                   speedup / 100, speedup % 100, max_channel_diff(gpu_buf, sw_buf));
+    }
+
+    _lv_refr_set_disp_refreshing(refr_disp);
+    lv_draw_sw_deinit_ctx(disp->driver, &sw_ctx->base_draw);
+
+_exit:
+    if (sw_ctx)
+        lv_mem_free(sw_ctx);
+    if (sw_buf)
+        rt_free(sw_buf);
+    if (gpu_buf)
+        rt_free(gpu_buf);
+}
+
+static void bench_timer_cb(lv_timer_t *timer)
+{
+    rt_base_t level;
+    rt_bool_t cancelled;
+
+    LV_UNUSED(timer);
+
+    level = rt_hw_interrupt_disable();
+    if (bench_state != BENCH_REQUESTED)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+    bench_state = BENCH_RUNNING;
+    rt_hw_interrupt_enable(level);
+
+    bench_run(bench_loops);
+
+    level = rt_hw_interrupt_disable();
+    cancelled = bench_state == BENCH_CANCELLED;
+    bench_state = cancelled ? BENCH_IDLE : BENCH_DONE;
+    rt_hw_interrupt_enable(level);
+
+    /* 没人等了就不释放，信号量不会留给下一次请求 */
+    if (!cancelled)
+        rt_sem_release(&bench_done);
+}
+
+static int lv_draw_bench(int argc, char **argv)
+{
+    rt_uint32_t loops = BENCH_LOOP_DEF;
+    bench_state_t state;
+    rt_base_t level;
+    rt_err_t result;
+
+    if (argc > 1)
+        loops = atoi(argv[1]);
+    if (loops == 0)
+    {
+        rt_kprintf("Usage: lv_draw_bench [loops]\n");
+        return -RT_EINVAL;
+    }
+
+    /* 两个msh同时调用时只有一个能拿到 */
+    level = rt_hw_interrupt_disable();
+    if (bench_state != BENCH_IDLE)
+    {
+        rt_hw_interrupt_enable(level);
+        rt_kprintf("benchmark is already running\n");
+        return -RT_EBUSY;
+    }
+    bench_loops = loops;
+    bench_state = BENCH_REQUESTED;
+    rt_hw_interrupt_enable(level);
+
+    result = rt_sem_take(&bench_done, BENCH_TIMEOUT);
+
+    level = rt_hw_interrupt_disable();
+    state = bench_state;
+    if (state == BENCH_REQUESTED)
+        bench_state = BENCH_IDLE;      /* LVGL线程被阻塞时取消请求，不要在之后某个时刻突然运行 */
+    else if (state == BENCH_RUNNING)
+        bench_state = BENCH_CANCELLED; /* 正在运行的结束后由LVGL线程回到空闲 */
+    rt_hw_interrupt_enable(level);
+
+    if (state == BENCH_DONE)
+    {
+        /* 超时后刚好结束时等LVGL线程释放信号量并取走，再放开下一次请求 */
+        if (result != RT_EOK)
+            rt_sem_take(&bench_done, RT_WAITING_FOREVER);
+        bench_state = BENCH_IDLE;
+        return RT_EOK;
+    }
+
+    LOG_E("benchmark timeout");
+    return -RT_ETIMEOUT;
+}
+MSH_CMD_EXPORT(lv_draw_bench, LVGL draw time: current backend vs draw_sw);
+
+#else
+
+void lv_draw_bench_init(void)
+{
+}
+
+#endif /* BSP_USING_LVGL_DRAW_BENCH */
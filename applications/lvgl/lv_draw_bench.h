@@ -0,0 +1,40 @@
+/**
+ * @file lv_draw_bench.h
+ *
+ */
+
+#ifndef LV_DRAW_BENCH_H
+#define LV_DRAW_BENCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+/* 在LVGL线程里注册绘制性能测试(lv_draw_bench命令)，必须在lv_port_disp_init()之后调用 */
+void lv_draw_bench_init(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_BENCH_H*/
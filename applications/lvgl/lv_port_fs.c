@@ -0,0 +1,307 @@
+/**
+ * @file lv_port_fs.c
+ *
+ * 资源文件系统: 把mkromfs.py --binary生成的romfs镜像挂载到BSP_ASSETFS_PATH，
+ * LVGL通过POSIX驱动('A:')打开里面的图片和字体，直接使用镜像里的数据(lv_fs_map)，不再拷贝到堆里。
+ * 镜像可以烧写在片内flash里(原地读取)，也可以从文件读到SDRAM里(挂载时重定位)。
+ *
+ * 生成镜像: python rt-thread/tools/mkromfs.py --binary [--addr 0x080C0000] <资源目录> assets.bin
+ * 性能测试(msh): lv_asset_bench <图片> <字体> [循环次数]，例如 lv_asset_bench A:img/logo.bin A:font/font_16.bin
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <rtthread.h>
+#include <stdlib.h>
+#include "lv_port_fs.h"
+
+#ifdef BSP_USING_ASSETFS
+
+#include <dfs_fs.h>
+#include <dfs_romfs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "lv_port_mem.h"
+
+#define DBG_TAG "LVGL.fs"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define BENCH_LOOP_DEF  20
+#define BENCH_PATH_MAX  64
+#define BENCH_TIMEOUT   (RT_TICK_PER_SECOND * 60)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void *assetfs_image(rt_size_t *size);
+#ifdef BSP_USING_LVGL_ASSET_BENCH
+static void bench_timer_cb(lv_timer_t *timer);
+#endif
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+#ifdef BSP_USING_LVGL_ASSET_BENCH
+static char bench_img_path[BENCH_PATH_MAX];
+static char bench_font_path[BENCH_PATH_MAX];
+static volatile rt_uint32_t bench_loops; /* msh请求的循环次数, 0: 没有请求 */
+static struct rt_semaphore bench_done;
+#endif
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_port_fs_init(void)
+{
+    const struct romfs_dirent *root;
+    rt_size_t size;
+    void *image;
+
+#ifdef BSP_USING_LVGL_ASSET_BENCH
+    rt_sem_init(&bench_done, "lvasset", 0, RT_IPC_FLAG_PRIO);
+    /* 测试必须在LVGL线程里运行，这里轮询msh的请求 */
+    lv_timer_create(bench_timer_cb, 100, NULL);
+#endif
+
+    image = assetfs_image(&size);
+    if (image == RT_NULL)
+        return;
+
+    /* 检查镜像，不在生成时指定的地址上的话把里面的指针改成现在的地址 */
+    root = dfs_romfs_image(image, size);
+    if (root == RT_NULL)
+    {
+        LOG_E("invalid asset image at 0x%08x", image);
+        return;
+    }
+
+    if (dfs_mount(RT_NULL, BSP_ASSETFS_PATH, "rom", 0, root) != 0)
+    {
+        LOG_E("failed to mount the asset image on %s", BSP_ASSETFS_PATH);
+        return;
+    }
+    LOG_I("asset image (%d bytes) mounted on %s", size, BSP_ASSETFS_PATH);
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+#ifdef BSP_ASSETFS_IN_FLASH
+
+/* 烧写在片内flash里的镜像，原地使用 */
+static void *assetfs_image(rt_size_t *size)
+{
+    *size = BSP_ASSETFS_SIZE;
+    return (void *)BSP_ASSETFS_ADDR;
+}
+
+#else
+
+/* 把镜像文件读到SDRAM里，一直不释放 */
+static void *assetfs_image(rt_size_t *size)
+{
+    struct stat st;
+    void *image;
+    int fd;
+
+    fd = open(BSP_ASSETFS_FILE, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        LOG_E("can't open the asset image %s", BSP_ASSETFS_FILE);
+        return RT_NULL;
+    }
+
+    image = RT_NULL;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        LOG_E("can't get the size of %s", BSP_ASSETFS_FILE);
+        goto _exit;
+    }
+
+    image = lv_port_sdram_alloc(st.st_size);
+    if (image == RT_NULL)
+    {
+        LOG_E("no memory for the asset image (%d bytes)", st.st_size);
+        goto _exit;
+    }
+
+    if (read(fd, image, st.st_size) != st.st_size)
+    {
+        LOG_E("failed to read %s", BSP_ASSETFS_FILE);
+        lv_port_sdram_free(image);
+        image = RT_NULL;
+        goto _exit;
+    }
+    *size = st.st_size;
+
+_exit:
+    close(fd);
+    return image;
+}
+
+#endif /* BSP_ASSETFS_IN_FLASH */
+
+#ifdef BSP_USING_LVGL_ASSET_BENCH
+
+static rt_size_t heap_used(void)
+{
+    rt_size_t total, used, max_used;
+    rt_memory_info(&total, &used, &max_used);
+    return used;
+}
+
+/* 打开图片并准备好所有像素loops次，返回耗时(ms)，heap保存打开时占用的堆 */
+static rt_int32_t bench_img(const char *path, rt_uint32_t loops, rt_size_t *heap)
+{
+    lv_img_decoder_dsc_t dsc;
+    lv_color_t *line = RT_NULL;
+    rt_size_t used = heap_used();
+    rt_uint32_t i;
+    lv_coord_t y;
+
+    rt_tick_t start = rt_tick_get();
+    for (i = 0; i < loops; i++)
+    {
+        if (lv_img_decoder_open(&dsc, path, lv_color_black(), 0) != LV_RES_OK)
+            break;
+        if (i == 0)
+            *heap = heap_used() - used;
+
+        /* 没有img_data的图片在绘制时一行一行地读 */
+        if (dsc.img_data == NULL)
+        {
+            if (line == RT_NULL)
+                line = rt_malloc(dsc.header.w * LV_IMG_PX_SIZE_ALPHA_BYTE);
+            for (y = 0; line && y < dsc.header.h; y++)
+                lv_img_decoder_read_line(&dsc, 0, y, dsc.header.w, (uint8_t *)line);
+        }
+        lv_img_decoder_close(&dsc);
+    }
+    rt_tick_t ticks = rt_tick_get() - start;
+
+    if (line)
+        rt_free(line);
+    return i < loops ? -1 : (rt_int32_t)(ticks * 1000 / RT_TICK_PER_SECOND);
+}
+
+/* 加载和释放字体loops次，返回耗时(ms)，heap保存字体占用的堆 */
+static rt_int32_t bench_font(const char *path, rt_uint32_t loops, rt_size_t *heap)
+{
+    lv_font_t *font;
+    rt_size_t used = heap_used();
+    rt_uint32_t i;
+
+    rt_tick_t start = rt_tick_get();
+    for (i = 0; i < loops; i++)
+    {
+        font = lv_font_load(path);
+        if (font == NULL)
+            return -1;
+        if (i == 0)
+            *heap = heap_used() - used;
+        lv_font_free(font);
+    }
+    rt_tick_t ticks = rt_tick_get() - start;
+
+    return ticks * 1000 / RT_TICK_PER_SECOND;
+}
+
+static void bench_run(rt_uint32_t loops)
+{
+    lv_fs_drv_t *drv = lv_fs_get_drv(LV_FS_POSIX_LETTER);
+    const void *(*map_cb)(struct _lv_fs_drv_t *, void *, uint32_t *);
+    rt_int32_t t_map, t_copy;
+    rt_size_t heap_map = 0, heap_copy = 0;
+
+    if (drv == NULL || drv->map_cb == NULL)
+    {
+        LOG_E("drive %c: can't map files", LV_FS_POSIX_LETTER);
+        return;
+    }
+    map_cb = drv->map_cb;
+
+    rt_kprintf("LVGL asset benchmark: %d loops\n", loops);
+    rt_kprintf("%-6s %12s %12s %12s %12s\n", "asset", "in place(ms)", "heap", "copy(ms)", "heap");
+
+    t_map = bench_img(bench_img_path, loops, &heap_map);
+    drv->map_cb = NULL;
+    t_copy = bench_img(bench_img_path, loops, &heap_copy);
+    drv->map_cb = map_cb;
+    if (t_map < 0 || t_copy < 0)
+        rt_kprintf("%-6s can't open %s\n", "image", bench_img_path);
+    else
+        rt_kprintf("%-6s %12d %12d %12d %12d\n", "image", t_map, heap_map, t_copy, heap_copy);
+
+    t_map = bench_font(bench_font_path, loops, &heap_map);
+    drv->map_cb = NULL;
+    t_copy = bench_font(bench_font_path, loops, &heap_copy);
+    drv->map_cb = map_cb;
+    if (t_map < 0 || t_copy < 0)
+        rt_kprintf("%-6s can't load %s\n", "font", bench_font_path);
+    else
+        rt_kprintf("%-6s %12d %12d %12d %12d\n", "font", t_map, heap_map, t_copy, heap_copy);
+}
+
+static void bench_timer_cb(lv_timer_t *timer)
+{
+    LV_UNUSED(timer);
+
+    if (bench_loops == 0)
+        return;
+
+    bench_run(bench_loops);
+    bench_loops = 0;
+    rt_sem_release(&bench_done);
+}
+
+static int lv_asset_bench(int argc, char **argv)
+{
+    rt_uint32_t loops = BENCH_LOOP_DEF;
+
+    if (argc > 3)
+        loops = atoi(argv[3]);
+    if (argc < 3 || loops == 0)
+    {
+        rt_kprintf("Usage: lv_asset_bench <image> <font> [loops]\n");
+        rt_kprintf("e.g.   lv_asset_bench A:img/logo.bin A:font/font_16.bin\n");
+        return -RT_EINVAL;
+    }
+    if (bench_loops != 0)
+    {
+        rt_kprintf("benchmark is already running\n");
+        return -RT_EBUSY;
+    }
+
+    rt_strncpy(bench_img_path, argv[1], sizeof(bench_img_path) - 1);
+    rt_strncpy(bench_font_path, argv[2], sizeof(bench_font_path) - 1);
+    bench_loops = loops;
+    if (rt_sem_take(&bench_done, BENCH_TIMEOUT) != RT_EOK)
+    {
+        LOG_E("benchmark timeout");
+        return -RT_ETIMEOUT;
+    }
+    return RT_EOK;
+}
+MSH_CMD_EXPORT(lv_asset_bench, LVGL image and font loading: in place vs copy);
+
+#endif /* BSP_USING_LVGL_ASSET_BENCH */
+
+#else
+
+void lv_port_fs_init(void)
+{
+}
+
+#endif /* BSP_USING_ASSETFS */
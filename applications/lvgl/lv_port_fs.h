@@ -0,0 +1,40 @@
+/**
+ * @file lv_port_fs.h
+ *
+ */
+
+#ifndef LV_PORT_FS_H
+#define LV_PORT_FS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+/* 挂载资源文件系统(romfs镜像)，注册lv_asset_bench命令，在LVGL线程里lv_init()之后调用 */
+void lv_port_fs_init(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_FS_H*/
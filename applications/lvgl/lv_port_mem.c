@@ -0,0 +1,75 @@
+/**
+ * @file lv_port_mem.c
+ *
+ * LVGL缓存的内存分配: 梯度缓存等较大又不常访问的数据放到SDRAM里，节省片内SRAM。
+ * 用法(msh): lv_grad_stat 打印梯度缓存的统计信息
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <rtthread.h>
+#include "lv_port_mem.h"
+#include "lvgl.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define SDRAM_HEAP_NAME "sdram" /* drv_sdram.c里初始化的memheap */
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+#ifdef RT_USING_MEMHEAP
+static struct rt_memheap *sdram_heap = RT_NULL;
+static rt_bool_t sdram_heap_inited = RT_FALSE;
+#endif
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+void *lv_port_sdram_alloc(size_t size)
+{
+#ifdef RT_USING_MEMHEAP
+    /* 只查找一次，之后的释放要和分配用同一个堆 */
+    if (!sdram_heap_inited)
+    {
+        sdram_heap = (struct rt_memheap *)rt_object_find(SDRAM_HEAP_NAME, RT_Object_Class_MemHeap);
+        sdram_heap_inited = RT_TRUE;
+    }
+    if (sdram_heap != RT_NULL)
+    {
+        return rt_memheap_alloc(sdram_heap, size);
+    }
+#endif
+    return rt_malloc(size);
+}
+
+void lv_port_sdram_free(void *ptr)
+{
+#ifdef RT_USING_MEMHEAP
+    if (sdram_heap != RT_NULL)
+    {
+        rt_memheap_free(ptr);
+        return;
+    }
+#endif
+    rt_free(ptr);
+}
+
+#ifdef RT_USING_MSH
+static void lv_grad_stat(int argc, char **argv)
+{
+    lv_grad_cache_stat_t stat;
+
+    /* 只读计数器，不需要在LVGL线程里执行 */
+    lv_gradient_get_cache_stat(&stat);
+    rt_kprintf("gradient cache: %d/%d bytes, %d items\n", (int)stat.used_size, (int)stat.max_size, (int)stat.item_cnt);
+    rt_kprintf("hit %d, miss %d, evict %d, not cached %d\n", (int)stat.hit, (int)stat.miss, (int)stat.evict, (int)stat.not_cached);
+    if (argc > 1 && rt_strcmp(argv[1], "reset") == 0)
+    {
+        lv_gradient_reset_cache_stat();
+    }
+}
+MSH_CMD_EXPORT(lv_grad_stat, LVGL gradient cache statistics: lv_grad_stat [reset]);
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file lv_port_mem.h
+ *
+ */
+
+#ifndef LV_PORT_MEM_H
+#define LV_PORT_MEM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stddef.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+/* 从SDRAM(名为"sdram"的memheap)分配内存，SDRAM没有初始化时从系统堆分配 */
+void *lv_port_sdram_alloc(size_t size);
+void lv_port_sdram_free(void *ptr);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_PORT_MEM_H*/
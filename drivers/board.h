@@ -65,6 +65,8 @@ extern "C"
  * STEP 4, according to serial port number to define serial port tx/rx DMA function in the board.h file
  *                 such as     #define BSP_UART1_RX_USING_DMA
  *
+ * The DMA and the ring sizes of UART1 are set in Apollo Board Config with RT_USING_SERIAL_V2.
+ *
  */
 
 #define BSP_USING_UART1
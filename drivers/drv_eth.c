@@ -16,6 +16,7 @@
 
 #include "drv_config.h"
 #include "drv_eth.h"
+#include "drv_eth_dma.h"
 #include <netif/ethernetif.h>
 #include <lwipopts.h>
 
@@ -33,6 +34,15 @@
 
 #define MAX_ADDR_LEN 6
 
+/* lwIP can hold as many received frames as the RX descriptors */
+#define ETH_RX_DESC_NUM     ETH_RXBUFNB
+#define ETH_RX_PBUF_NUM     (ETH_RXBUFNB * 2)
+/* a frame takes one TX descriptor per pbuf of its chain */
+#define ETH_TX_DESC_NUM     (ETH_TXBUFNB * 4)
+/* shorter frames are copied to give their buffer back at once */
+#define ETH_RX_COPY_BREAK   128
+#define ETH_TX_TIMEOUT      (RT_TICK_PER_SECOND / 10)
+
 struct rt_stm32_eth
 {
     /* inherit from ethernet device */
@@ -47,10 +57,10 @@ struct rt_stm32_eth
     rt_uint32_t    ETH_Speed;
     /* ETH_Duplex_Mode */
     rt_uint32_t    ETH_Mode;
+    /* descriptor rings */
+    struct eth_dma dma;
 };
 
-static ETH_DMADescTypeDef *DMARxDscrTab, *DMATxDscrTab;
-static rt_uint8_t *Rx_Buff, *Tx_Buff;
 static  ETH_HandleTypeDef EthHandle;
 static struct rt_stm32_eth stm32_eth_device;
 
@@ -114,11 +124,12 @@ static rt_err_t rt_stm32_eth_init(rt_device_t dev)
         LOG_D("eth hardware init success");
     }
 
-    /* Initialize Tx Descriptors list: Chain Mode */
-    HAL_ETH_DMATxDescListInit(&EthHandle, DMATxDscrTab, Tx_Buff, ETH_TXBUFNB);
+    /* the descriptors point at the pbufs, not at buffers of the HAL */
+    EthHandle.Instance->DMATDLAR = (uint32_t)stm32_eth_device.dma.tx_desc;
+    EthHandle.Instance->DMARDLAR = (uint32_t)stm32_eth_device.dma.rx_desc;
 
-    /* Initialize Rx Descriptors list: Chain Mode  */
-    HAL_ETH_DMARxDescListInit(&EthHandle, DMARxDscrTab, Rx_Buff, ETH_RXBUFNB);
+    /* the sent frames are freed after the TX interrupt */
+    __HAL_ETH_DMA_ENABLE_IT(&EthHandle, ETH_DMA_IT_T);
 
     /* ETH interrupt Init */
     HAL_NVIC_SetPriority(ETH_IRQn, 0x07, 0);
@@ -187,195 +198,105 @@ static rt_err_t rt_stm32_eth_control(rt_device_t dev, int cmd, void *args)
     return RT_EOK;
 }
 
-/* ethernet device interface */
-/* transmit data*/
-rt_err_t rt_stm32_eth_tx(rt_device_t dev, struct pbuf *p)
+/* resume the DMA after descriptors were given to it */
+static void stm32_eth_tx_poll(struct eth_dma *dma)
 {
-    rt_err_t ret = RT_ERROR;
-    HAL_StatusTypeDef state;
-    struct pbuf *q;
-    uint8_t *buffer = (uint8_t *)(EthHandle.TxDesc->Buffer1Addr);
-    __IO ETH_DMADescTypeDef *DmaTxDesc;
-    uint32_t framelength = 0;
-    uint32_t bufferoffset = 0;
-    uint32_t byteslefttocopy = 0;
-    uint32_t payloadoffset = 0;
-
-    DmaTxDesc = EthHandle.TxDesc;
-    bufferoffset = 0;
-
-    /* copy frame from pbufs to driver buffers */
-    for (q = p; q != NULL; q = q->next)
+    /* When Transmit Underflow flag is set, clear it and issue a Transmit Poll Demand to resume transmission */
+    if ((EthHandle.Instance->DMASR & ETH_DMASR_TUS) != (uint32_t)RESET)
     {
-        /* Is this buffer available? If not, goto error */
-        if ((DmaTxDesc->Status & ETH_DMATXDESC_OWN) != (uint32_t)RESET)
-        {
-            LOG_D("buffer not valid");
-            ret = ERR_USE;
-            goto error;
-        }
-
-        /* Get bytes in current lwIP buffer */
-        byteslefttocopy = q->len;
-        payloadoffset = 0;
-
-        /* Check if the length of data to copy is bigger than Tx buffer size*/
-        while ((byteslefttocopy + bufferoffset) > ETH_TX_BUF_SIZE)
-        {
-            /* Copy data to Tx buffer*/
-            SMEMCPY((uint8_t *)((uint8_t *)buffer + bufferoffset), (uint8_t *)((uint8_t *)q->payload + payloadoffset), (ETH_TX_BUF_SIZE - bufferoffset));
-
-            /* Point to next descriptor */
-            DmaTxDesc = (ETH_DMADescTypeDef *)(DmaTxDesc->Buffer2NextDescAddr);
+        /* Clear TUS ETHERNET DMA flag */
+        EthHandle.Instance->DMASR = ETH_DMASR_TUS;
+    }
+    EthHandle.Instance->DMATPDR = 0;
+}
 
-            /* Check if the buffer is available */
-            if ((DmaTxDesc->Status & ETH_DMATXDESC_OWN) != (uint32_t)RESET)
-            {
-                LOG_E("dma tx desc buffer is not valid");
-                ret = ERR_USE;
-                goto error;
-            }
+static void stm32_eth_rx_poll(struct eth_dma *dma)
+{
+    /* When Rx Buffer unavailable flag is set: clear it and resume reception */
+    if ((EthHandle.Instance->DMASR & ETH_DMASR_RBUS) != (uint32_t)RESET)
+    {
+        /* Clear RBUS ETHERNET DMA flag */
+        EthHandle.Instance->DMASR = ETH_DMASR_RBUS;
+    }
+    EthHandle.Instance->DMARPDR = 0;
+}
 
-            buffer = (uint8_t *)(DmaTxDesc->Buffer1Addr);
+static rt_bool_t stm32_eth_tx_capable(struct eth_dma *dma, const void *buf, rt_size_t len)
+{
+    /* the DMA can't reach the CCM RAM */
+    return (rt_ubase_t)buf + len <= CCMDATARAM_BASE || (rt_ubase_t)buf > CCMDATARAM_END;
+}
 
-            byteslefttocopy = byteslefttocopy - (ETH_TX_BUF_SIZE - bufferoffset);
-            payloadoffset = payloadoffset + (ETH_TX_BUF_SIZE - bufferoffset);
-            framelength = framelength + (ETH_TX_BUF_SIZE - bufferoffset);
-            bufferoffset = 0;
-        }
+static const struct eth_dma_ops stm32_eth_dma_ops =
+{
+    stm32_eth_tx_poll,
+    stm32_eth_rx_poll,
+    stm32_eth_tx_capable,
+};
 
-        /* Copy the remaining bytes */
-        SMEMCPY((uint8_t *)((uint8_t *)buffer + bufferoffset), (uint8_t *)((uint8_t *)q->payload + payloadoffset), byteslefttocopy);
-        bufferoffset = bufferoffset + byteslefttocopy;
-        framelength = framelength + byteslefttocopy;
-    }
+/* ethernet device interface */
+/* transmit data*/
+rt_err_t rt_stm32_eth_tx(rt_device_t dev, struct pbuf *p)
+{
+    rt_err_t ret;
 
 #ifdef ETH_TX_DUMP
-    dump_hex(buffer, p->tot_len);
-#endif
-
-    /* Prepare transmit descriptors to give to DMA */
-    /* TODO Optimize data send speed*/
-    LOG_D("transmit frame length :%d", framelength);
-
-    /* wait for unlocked */
-    while (EthHandle.Lock == HAL_LOCKED);
+    struct pbuf *q;
 
-    state = HAL_ETH_TransmitFrame(&EthHandle, framelength);
-    if (state != HAL_OK)
+    for (q = p; q != NULL; q = q->next)
     {
-        LOG_E("eth transmit frame faild: %d", state);
+        dump_hex(q->payload, q->len);
     }
+#endif
 
-    ret = ERR_OK;
-
-error:
+    LOG_D("transmit frame length :%d", p->tot_len);
 
-    /* When Transmit Underflow flag is set, clear it and issue a Transmit Poll Demand to resume transmission */
-    if ((EthHandle.Instance->DMASR & ETH_DMASR_TUS) != (uint32_t)RESET)
+    /* the DMA sends from the pbufs, they are freed after the TX interrupt */
+    ret = eth_dma_tx(&stm32_eth_device.dma, p, ETH_TX_TIMEOUT);
+    if (ret != RT_EOK)
     {
-        /* Clear TUS ETHERNET DMA flag */
-        EthHandle.Instance->DMASR = ETH_DMASR_TUS;
-
-        /* Resume DMA transmission*/
-        EthHandle.Instance->DMATPDR = 0;
+        LOG_E("eth transmit frame faild: %d", ret);
+        return ERR_USE;
     }
 
-    return ret;
+    return ERR_OK;
 }
 
 /* receive data*/
 struct pbuf *rt_stm32_eth_rx(rt_device_t dev)
 {
+    struct pbuf *p;
 
-    struct pbuf *p = NULL;
-    struct pbuf *q = NULL;
-    HAL_StatusTypeDef state;
-    uint16_t len = 0;
-    uint8_t *buffer;
-    __IO ETH_DMADescTypeDef *dmarxdesc;
-    uint32_t bufferoffset = 0;
-    uint32_t payloadoffset = 0;
-    uint32_t byteslefttocopy = 0;
-    uint32_t i = 0;
-
-    /* Get received frame */
-    state = HAL_ETH_GetReceivedFrame_IT(&EthHandle);
-    if (state != HAL_OK)
+    /* the frame is in the buffers the DMA wrote, they go back to it when lwIP frees the pbuf */
+    p = eth_dma_rx(&stm32_eth_device.dma);
+    if (p == NULL)
     {
-        LOG_D("receive frame faild");
         return NULL;
     }
 
-    /* Obtain the size of the packet and put it into the "len" variable. */
-    len = EthHandle.RxFrameInfos.length;
-    buffer = (uint8_t *)EthHandle.RxFrameInfos.buffer;
-
-    LOG_D("receive frame len : %d", len);
-
-    if (len > 0)
-    {
-        /* We allocate a pbuf chain of pbufs from the Lwip buffer pool */
-        p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
-    }
+    LOG_D("receive frame len : %d", p->tot_len);
 
 #ifdef ETH_RX_DUMP
-    dump_hex(buffer, p->tot_len);
+    dump_hex(p->payload, p->len);
 #endif
 
-    if (p != NULL)
-    {
-        dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
-        bufferoffset = 0;
-        for (q = p; q != NULL; q = q->next)
-        {
-            byteslefttocopy = q->len;
-            payloadoffset = 0;
-
-            /* Check if the length of bytes to copy in current pbuf is bigger than Rx buffer size*/
-            while ((byteslefttocopy + bufferoffset) > ETH_RX_BUF_SIZE)
-            {
-                /* Copy data to pbuf */
-                SMEMCPY((uint8_t *)((uint8_t *)q->payload + payloadoffset), (uint8_t *)((uint8_t *)buffer + bufferoffset), (ETH_RX_BUF_SIZE - bufferoffset));
-
-                /* Point to next descriptor */
-                dmarxdesc = (ETH_DMADescTypeDef *)(dmarxdesc->Buffer2NextDescAddr);
-                buffer = (uint8_t *)(dmarxdesc->Buffer1Addr);
-
-                byteslefttocopy = byteslefttocopy - (ETH_RX_BUF_SIZE - bufferoffset);
-                payloadoffset = payloadoffset + (ETH_RX_BUF_SIZE - bufferoffset);
-                bufferoffset = 0;
-            }
-            /* Copy remaining data in pbuf */
-            SMEMCPY((uint8_t *)((uint8_t *)q->payload + payloadoffset), (uint8_t *)((uint8_t *)buffer + bufferoffset), byteslefttocopy);
-            bufferoffset = bufferoffset + byteslefttocopy;
-        }
-    }
+    return p;
+}
 
-    /* Release descriptors to DMA */
-    /* Point to first descriptor */
-    dmarxdesc = EthHandle.RxFrameInfos.FSRxDesc;
-    /* Set Own bit in Rx descriptors: gives the buffers back to DMA */
-    for (i = 0; i < EthHandle.RxFrameInfos.SegCount; i++)
+#ifdef RT_LWIP_USING_ETH_NAPI
+/* the rx thread masks the rx interrupt while it receives, TX completions still interrupt */
+static void rt_stm32_eth_rx_irq(rt_device_t dev, rt_bool_t enable)
+{
+    if (enable)
     {
-        dmarxdesc->Status |= ETH_DMARXDESC_OWN;
-        dmarxdesc = (ETH_DMADescTypeDef *)(dmarxdesc->Buffer2NextDescAddr);
+        __HAL_ETH_DMA_ENABLE_IT(&EthHandle, ETH_DMA_IT_R);
     }
-
-    /* Clear Segment_Count */
-    EthHandle.RxFrameInfos.SegCount = 0;
-
-    /* When Rx Buffer unavailable flag is set: clear it and resume reception */
-    if ((EthHandle.Instance->DMASR & ETH_DMASR_RBUS) != (uint32_t)RESET)
+    else
     {
-        /* Clear RBUS ETHERNET DMA flag */
-        EthHandle.Instance->DMASR = ETH_DMASR_RBUS;
-        /* Resume DMA reception */
-        EthHandle.Instance->DMARPDR = 0;
+        __HAL_ETH_DMA_DISABLE_IT(&EthHandle, ETH_DMA_IT_R);
     }
-
-    return p;
 }
+#endif /* RT_LWIP_USING_ETH_NAPI */
 
 /* interrupt service routine */
 void ETH_IRQHandler(void)
@@ -392,6 +313,14 @@ void ETH_IRQHandler(void)
 void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
 {
     rt_err_t result;
+
+    /* the HAL handles one of RX and TX per interrupt, take a TX completion with it */
+    if (__HAL_ETH_DMA_GET_FLAG(heth, ETH_DMA_FLAG_T))
+    {
+        __HAL_ETH_DMA_CLEAR_IT(heth, ETH_DMA_IT_T);
+        eth_dma_tx_isr(&stm32_eth_device.dma);
+    }
+
     result = eth_device_ready(&(stm32_eth_device.parent));
     if (result != RT_EOK)
     {
@@ -399,6 +328,14 @@ void HAL_ETH_RxCpltCallback(ETH_HandleTypeDef *heth)
     }
 }
 
+void HAL_ETH_TxCpltCallback(ETH_HandleTypeDef *heth)
+{
+    eth_dma_tx_isr(&stm32_eth_device.dma);
+
+    /* the rx thread frees the sent frames */
+    eth_device_ready(&(stm32_eth_device.parent));
+}
+
 void HAL_ETH_ErrorCallback(ETH_HandleTypeDef *heth)
 {
     LOG_E("eth err");
@@ -550,6 +487,128 @@ static void phy_monitor_thread_entry(void *parameter)
 #endif /* PHY_USING_INTERRUPT_MODE */
 }
 
+/* Register the EMAC device */
+static int rt_hw_stm32_eth_init(void)
+{
+    rt_err_t state = RT_EOK;
+
+    RT_ASSERT(sizeof(struct eth_dma_desc) == sizeof(ETH_DMADescTypeDef));
+
+    /* Prepare the descriptors and the receive pbufs */
+    state = eth_dma_init(&stm32_eth_device.dma, &stm32_eth_dma_ops,
+                         ETH_RX_DESC_NUM, ETH_RX_PBUF_NUM, ETH_TX_DESC_NUM);
+    if (state != RT_EOK)
+    {
+        LOG_E("No memory");
+        return state;
+    }
+    stm32_eth_device.dma.rx_copy_break = ETH_RX_COPY_BREAK;
+#ifdef RT_LWIP_USING_HW_CHECKSUM
+    stm32_eth_device.dma.tx_flags = ETH_DMA_TX_CIC_FULL;
+#endif
+
+    stm32_eth_device.ETH_Speed = ETH_SPEED_100M;
+            }
+            else
+            {
+                stm32_eth_device.ETH_Speed = ETH_SPEED_10M;
+                LOG_D("10Mbps");
+            }
+
+            if (phy_speed & PHY_FULL_DUPLEX)
+            {
+                LOG_D("full-duplex");
+                stm32_eth_device.ETH_Mode = ETH_MODE_FULLDUPLEX;
+            }
+            else
+            {
+                LOG_D("half-duplex");
+                stm32_eth_device.ETH_Mode = ETH_MODE_HALFDUPLEX;
+            }
+
+            /* send link up. */
+            eth_device_linkchange(&stm32_eth_device.parent, RT_TRUE);
+        }
+        else
+        {
+            LOG_I("link down");
+            eth_device_linkchange(&stm32_eth_device.parent, RT_FALSE);
+        }
+    }
+}
+
+#ifdef PHY_USING_INTERRUPT_MODE
+static void eth_phy_isr(void *args)
+{
+    rt_uint32_t status = 0;
+
+    HAL_ETH_ReadPHYRegister(&EthHandle, PHY_INTERRUPT_FLAG_REG, (uint32_t *)&status);
+    LOG_D("phy interrupt status reg is 0x%X", status);
+
+    phy_linkchange();
+}
+#endif /* PHY_USING_INTERRUPT_MODE */
+
+static void phy_monitor_thread_entry(void *parameter)
+{
+    uint8_t phy_addr = 0xFF;
+    uint8_t detected_count = 0;
+
+    while(phy_addr == 0xFF)
+    {
+        /* phy search */
+        rt_uint32_t i, temp;
+        for (i = 0; i <= 0x1F; i++)
+        {
+            EthHandle.Init.PhyAddress = i;
+            HAL_ETH_ReadPHYRegister(&EthHandle, PHY_ID1_REG, (uint32_t *)&temp);
+
+            if (temp != 0xFFFF && temp != 0x00)
+            {
+                phy_addr = i;
+                break;
+            }
+        }
+
+        detected_count++;
+        rt_thread_mdelay(1000);
+
+        if (detected_count > 10)
+        {
+            LOG_E("No PHY device was detected, please check hardware!");
+        }
+    }
+
+    LOG_D("Found a phy, address:0x%02X", phy_addr);
+
+    /* RESET PHY */
+    LOG_D("RESET PHY!");
+    HAL_ETH_WritePHYRegister(&EthHandle, PHY_BASIC_CONTROL_REG, PHY_RESET_MASK);
+    rt_thread_mdelay(2000);
+    HAL_ETH_WritePHYRegister(&EthHandle, PHY_BASIC_CONTROL_REG, PHY_AUTO_NEGOTIATION_MASK);
+
+    phy_linkchange();
+#ifdef PHY_USING_INTERRUPT_MODE
+    /* configuration intterrupt pin */
+    rt_pin_mode(PHY_INT_PIN, PIN_MODE_INPUT_PULLUP);
+    rt_pin_attach_irq(PHY_INT_PIN, PIN_IRQ_MODE_FALLING, eth_phy_isr, (void *)"callbackargs");
+    rt_pin_irq_enable(PHY_INT_PIN, PIN_IRQ_ENABLE);
+
+    /* enable phy interrupt */
+    HAL_ETH_WritePHYRegister(&EthHandle, PHY_INTERRUPT_MASK_REG, PHY_INT_MASK);
+#if defined(PHY_INTERRUPT_CTRL_REG)
+    HAL_ETH_WritePHYRegister(&EthHandle, PHY_INTERRUPT_CTRL_REG, PHY_INTERRUPT_EN);
+#endif
+#else /* PHY_USING_INTERRUPT_MODE */
+    stm32_eth_device.poll_link_timer = rt_timer_create("phylnk", (void (*)(void*))phy_linkchange,
+                                        NULL, RT_TICK_PER_SECOND, RT_TIMER_FLAG_PERIODIC);
+    if (!stm32_eth_device.poll_link_timer || rt_timer_start(stm32_eth_device.poll_link_timer) != RT_EOK)
+    {
+        LOG_E("Start link change detection timer failed");
+    }
+#endif /* PHY_USING_INTERRUPT_MODE */
+}
+
 /* Register the EMAC device */
 static int rt_hw_stm32_eth_init(void)
 {
@@ -610,6 +669,9 @@ static int rt_hw_stm32_eth_init(void)
 
     stm32_eth_device.parent.eth_rx     = rt_stm32_eth_rx;
     stm32_eth_device.parent.eth_tx     = rt_stm32_eth_tx;
+#ifdef RT_LWIP_USING_ETH_NAPI
+    stm32_eth_device.parent.eth_rx_irq = rt_stm32_eth_rx_irq;
+#endif
 
     /* register eth device */
     state = eth_device_init(&(stm32_eth_device.parent), "e0");
@@ -643,25 +705,7 @@ static int rt_hw_stm32_eth_init(void)
 __exit:
     if (state != RT_EOK)
     {
-        if (Rx_Buff)
-        {
-            rt_free(Rx_Buff);
-        }
-
-        if (Tx_Buff)
-        {
-            rt_free(Tx_Buff);
-        }
-
-        if (DMARxDscrTab)
-        {
-            rt_free(DMARxDscrTab);
-        }
-
-        if (DMATxDscrTab)
-        {
-            rt_free(DMATxDscrTab);
-        }
+        eth_dma_deinit(&stm32_eth_device.dma);
     }
 
     return state;
@@ -0,0 +1,735 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and self test of the descriptor rings of the Ethernet driver on
+ * a simulated MAC.
+ *
+ * The simulated DMA walks the TX descriptors on the poll demand like the
+ * DMA of the STM32 does, gathers the buffers of a frame, loops it back into
+ * the RX descriptors with the frame length and the CRC, gives the
+ * descriptors back and raises the TX interrupt. A frame is dropped when the
+ * RX descriptors are still owned by the driver.
+ *
+ * The benchmark sends TCP sized frames of a header and a data pbuf and
+ * short frames through the rings, copying every frame like the driver of
+ * the HAL did, without copies, and with the copy breaks of the driver. The
+ * time of the simulated DMA isn't counted. The self test sends frames of
+ * random chains, holds received frames and frees them out of order, fills
+ * the TX ring while the DMA is stopped, starves the RX ring, and compares
+ * every received frame with the sent one. A frame with a PBUF_REF changed
+ * after the output and the TCP frames of lwIP before 2.1.0 must be copied.
+ *
+ * Enable RT_USING_CPUTIME for times below a tick.
+ *
+ * msh: eth_dma_bench [frames]
+ */
+
+#include <board.h>
+#ifdef BSP_USING_ETH_BENCH
+
+#include <rthw.h>
+#include <rtdevice.h>
+#include <stdlib.h>
+#include <lwip/init.h>
+#include "drv_eth_dma.h"
+
+#define BENCH_RX_NUM        4
+#define BENCH_RX_BUF_NUM    8
+#define BENCH_TX_NUM        16
+#define BENCH_FRAMES        2000
+#define BENCH_HDR_LEN       54
+#define BENCH_FRAME_LEN     1514
+#define BENCH_SHORT_LEN     60
+#define BENCH_COPY_BREAK    128
+
+#define CHECK_FRAMES        3000
+#define CHECK_HOLD          (BENCH_RX_BUF_NUM - BENCH_RX_NUM)
+#define CHECK_MIN_LEN       42
+#define CHECK_PATTERN_SIZE  4096
+
+struct eth_sim
+{
+    struct eth_dma dma;
+    struct eth_dma_desc *tx_desc;       /* next descriptors of the simulated DMA */
+    struct eth_dma_desc *rx_desc;
+    rt_bool_t stopped;                  /* the DMA ignores the poll demands */
+    rt_bool_t limited;                  /* the DMA can't read the frames of the stack */
+    rt_uint32_t overflows;
+    rt_uint64_t clocks;                 /* time of the simulated DMA */
+    rt_uint8_t frame[ETH_DMA_RX_BUF_SIZE];
+};
+
+static struct eth_sim sim;
+static rt_uint8_t pattern[CHECK_PATTERN_SIZE];
+static rt_uint32_t seed;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static rt_uint64_t bench_clock(void)
+{
+#ifdef RT_USING_CPUTIME
+    return clock_cpu_gettime();
+#else
+    return rt_tick_get();
+#endif
+}
+
+static rt_uint32_t bench_ns(rt_uint64_t clocks, rt_uint32_t count)
+{
+#ifdef RT_USING_CPUTIME
+    return (rt_uint32_t)(clocks * clock_cpu_getres() / count);
+#else
+    return (rt_uint32_t)(clocks * (1000000000ULL / RT_TICK_PER_SECOND) / count);
+#endif
+}
+
+/* write a frame into the RX descriptors as the MAC does */
+static void sim_receive(struct eth_sim *sim, rt_size_t len)
+{
+    struct eth_dma_desc *desc = sim->rx_desc;
+    rt_size_t total = len + ETH_DMA_CRC_SIZE;
+    rt_size_t done, size, n;
+    rt_uint32_t status;
+
+    for (done = 0; done < total; done += desc->control & ETH_DMA_RX_RBS1)
+    {
+        if (!(desc->status & ETH_DMA_RX_OWN))
+        {
+            sim->overflows++;
+            return;
+        }
+        desc = (struct eth_dma_desc *)desc->next;
+    }
+
+    desc = sim->rx_desc;
+    for (done = 0; done < total; done += n)
+    {
+        size = desc->control & ETH_DMA_RX_RBS1;
+        n = total - done < size ? total - done : size;
+        if (done < len)
+        {
+            rt_memcpy((void *)desc->buf1, sim->frame + done, n < len - done ? n : len - done);
+        }
+
+        status = done == 0 ? ETH_DMA_RX_FS : 0;
+        if (done + n == total)
+        {
+            status |= ETH_DMA_RX_LS | (total << ETH_DMA_RX_FL_SHIFT);
+        }
+        desc->status = status;
+        desc = (struct eth_dma_desc *)desc->next;
+    }
+    sim->rx_desc = desc;
+}
+
+static void sim_tx_poll(struct eth_dma *dma)
+{
+    struct eth_sim *sim = rt_container_of(dma, struct eth_sim, dma);
+    struct eth_dma_desc *desc;
+    rt_uint64_t start = bench_clock();
+    rt_size_t len = 0, n;
+    rt_bool_t irq = RT_FALSE;
+
+    while (!sim->stopped && ((desc = sim->tx_desc)->status & ETH_DMA_TX_OWN))
+    {
+        if (desc->status & ETH_DMA_TX_FS)
+        {
+            len = 0;
+        }
+        n = desc->control & ETH_DMA_TX_TBS1;
+        if (len + n <= sizeof(sim->frame))
+        {
+            rt_memcpy(sim->frame + len, (const void *)desc->buf1, n);
+        }
+        len += n;
+
+        if (desc->status & ETH_DMA_TX_LS)
+        {
+            sim_receive(sim, len);
+            irq |= (desc->status & ETH_DMA_TX_IC) != 0;
+        }
+        desc->status &= ~ETH_DMA_TX_OWN;
+        sim->tx_desc = (struct eth_dma_desc *)desc->next;
+    }
+    sim->clocks += bench_clock() - start;
+
+    if (irq)
+    {
+        eth_dma_tx_isr(dma);
+    }
+}
+
+static void sim_rx_poll(struct eth_dma *dma)
+{
+    /* the loopback writes the RX descriptors on the TX poll demand */
+}
+
+static rt_bool_t sim_tx_capable(struct eth_dma *dma, const void *buf, rt_size_t len)
+{
+    struct eth_sim *sim = rt_container_of(dma, struct eth_sim, dma);
+
+    return !sim->limited;
+}
+
+static const struct eth_dma_ops sim_ops =
+{
+    sim_tx_poll,
+    sim_rx_poll,
+    sim_tx_capable,
+};
+
+static rt_err_t sim_open(rt_uint16_t rx_copy_break, rt_uint16_t tx_copy_break, rt_bool_t limited)
+{
+    if (eth_dma_init(&sim.dma, &sim_ops, BENCH_RX_NUM, BENCH_RX_BUF_NUM, BENCH_TX_NUM) != RT_EOK)
+    {
+        rt_kprintf("no memory for the rings\n");
+        return -RT_ENOMEM;
+    }
+    sim.dma.rx_copy_break = rx_copy_break;
+    sim.dma.tx_copy_break = tx_copy_break;
+    sim.tx_desc = sim.dma.tx_desc;
+    sim.rx_desc = sim.dma.rx_desc;
+    sim.stopped = RT_FALSE;
+    sim.limited = limited;
+    sim.overflows = 0;
+    sim.clocks = 0;
+
+    return RT_EOK;
+}
+
+/* all RX buffers are back and all TX descriptors reclaimed */
+static rt_bool_t sim_close(void)
+{
+    struct eth_dma_rx_buf *buf;
+    rt_uint32_t free = 0;
+
+    eth_dma_tx_reclaim(&sim.dma);
+    for (buf = sim.dma.rx_free; buf != RT_NULL; buf = buf->next)
+    {
+        free++;
+    }
+    free += sim.dma.rx_filled;
+    eth_dma_deinit(&sim.dma);
+
+    return free == BENCH_RX_BUF_NUM && sim.dma.tx_used == 0;
+}
+
+/*
+ * a frame of `len` bytes of the pattern from `off` after the pad, the pbufs end at the offsets of `cuts`,
+ * every other pbuf of the type `data` points into the pattern
+ */
+static struct pbuf *frame_alloc(rt_uint32_t off, rt_uint16_t len, const rt_uint16_t *cuts, int num, pbuf_type data)
+{
+    struct pbuf *p = RT_NULL, *q;
+    rt_uint16_t start = 0, end;
+    int i;
+
+    for (i = 0; i <= num; i++)
+    {
+        end = i < num ? cuts[i] : len;
+        if (i & 1)
+        {
+            /* data of the application sent in place */
+            q = pbuf_alloc(PBUF_RAW, end - start, data);
+            if (q)
+            {
+                q->payload = &pattern[off + start];
+            }
+        }
+        else
+        {
+            q = pbuf_alloc(PBUF_RAW, end - start + (i ? 0 : ETH_PAD_SIZE), PBUF_RAM);
+            if (q)
+            {
+                rt_memcpy((rt_uint8_t *)q->payload + (i ? 0 : ETH_PAD_SIZE), &pattern[off + start], end - start);
+            }
+        }
+        if (q == RT_NULL)
+        {
+            if (p)
+            {
+                pbuf_free(p);
+            }
+            return RT_NULL;
+        }
+
+        if (p)
+        {
+            pbuf_cat(p, q);
+        }
+        else
+        {
+            p = q;
+        }
+        start = end;
+    }
+
+    return p;
+}
+
+static rt_bool_t frame_check(struct pbuf *p, rt_uint32_t off, rt_uint16_t len)
+{
+    struct pbuf *q;
+    rt_uint16_t pad = ETH_PAD_SIZE;
+
+    if (p->tot_len != len + ETH_PAD_SIZE)
+    {
+        return RT_FALSE;
+    }
+    for (q = p; q != RT_NULL; q = q->next, pad = 0)
+    {
+        if (rt_memcmp((rt_uint8_t *)q->payload + pad, &pattern[off], q->len - pad) != 0)
+        {
+            return RT_FALSE;
+        }
+        off += q->len - pad;
+    }
+
+    return RT_TRUE;
+}
+
+static void bench_run(const char *mode, rt_uint16_t len, rt_uint16_t rx_copy_break,
+                      rt_uint16_t tx_copy_break, rt_bool_t limited, rt_uint32_t frames)
+{
+    struct eth_dma_stat stat;
+    struct pbuf *p;
+    rt_uint64_t clocks = 0, start;
+    rt_uint16_t cut = BENCH_HDR_LEN;
+    rt_uint32_t i, ns, received = 0;
+    rt_bool_t ok;
+
+    if (sim_open(rx_copy_break, tx_copy_break, limited) != RT_EOK)
+    {
+        return;
+    }
+
+    for (i = 0; i < frames; i++)
+    {
+        p = frame_alloc(0, len, &cut, len > cut ? 1 : 0, PBUF_ROM);
+        if (p == RT_NULL)
+        {
+            rt_kprintf("no memory for the frames\n");
+            break;
+        }
+
+        start = bench_clock();
+        eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER);
+        pbuf_free(p);
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            received++;
+            pbuf_free(p);
+        }
+        clocks += bench_clock() - start;
+    }
+
+    eth_dma_get_stat(&sim.dma, &stat);
+    clocks = clocks > sim.clocks ? clocks - sim.clocks : 0;
+    ok = sim_close();
+    if (i == 0)
+    {
+        return;
+    }
+
+    ns = bench_ns(clocks, i);
+    rt_kprintf("%-12s %6d %8d %9d %9d %9d %9d%s\n", mode, len, received, ns,
+               ns ? len * 1000 / ns : 0, stat.tx_copies, stat.rx_copies,
+               ok && received == i ? "" : "  (frames lost)");
+}
+
+static rt_bool_t check_chains(void)
+{
+    struct pbuf *hold[CHECK_HOLD], *p;
+    rt_uint32_t offs[BENCH_TX_NUM + BENCH_RX_BUF_NUM];
+    rt_uint16_t lens[BENCH_TX_NUM + BENCH_RX_BUF_NUM];
+    rt_uint16_t cuts[4];
+    rt_uint32_t head = 0, tail = 0, sent = 0, received = 0, bad = 0;
+    rt_uint32_t i, j;
+    int held = 0, num;
+    rt_bool_t ok;
+
+    if (sim_open(BENCH_COPY_BREAK, BENCH_COPY_BREAK, RT_FALSE) != RT_EOK)
+    {
+        return RT_FALSE;
+    }
+
+    for (i = 0; i < CHECK_FRAMES; i++)
+    {
+        rt_uint32_t off = bench_rand() % (CHECK_PATTERN_SIZE - BENCH_FRAME_LEN);
+        rt_uint16_t len = CHECK_MIN_LEN + bench_rand() % (BENCH_FRAME_LEN - CHECK_MIN_LEN + 1);
+
+        /* up to 5 pbufs, some of them empty but the last */
+        num = bench_rand() % 5;
+        for (j = 0; j < num; j++)
+        {
+            cuts[j] = bench_rand() % len;
+        }
+        for (j = 1; j < num; j++)
+        {
+            if (cuts[j] < cuts[j - 1])
+            {
+                cuts[j] = cuts[j - 1];
+            }
+        }
+
+        p = frame_alloc(off, len, cuts, num, PBUF_ROM);
+        if (p == RT_NULL || eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER) != RT_EOK)
+        {
+            bad++;
+        }
+        else
+        {
+            offs[head % (sizeof(offs) / sizeof(offs[0]))] = off;
+            lens[head % (sizeof(lens) / sizeof(lens[0]))] = len;
+            head++;
+            sent++;
+        }
+        if (p)
+        {
+            pbuf_free(p);
+        }
+
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            j = tail++ % (sizeof(offs) / sizeof(offs[0]));
+            if (!frame_check(p, offs[j], lens[j]))
+            {
+                bad++;
+            }
+            received++;
+
+            /* the stack keeps some frames and frees them later in another order */
+            if (held < CHECK_HOLD && (bench_rand() & 1))
+            {
+                hold[held++] = p;
+            }
+            else
+            {
+                pbuf_free(p);
+            }
+            if (held > 0 && (bench_rand() & 3) == 0)
+            {
+                j = bench_rand() % held;
+                pbuf_free(hold[j]);
+                hold[j] = hold[--held];
+            }
+        }
+    }
+    while (held > 0)
+    {
+        pbuf_free(hold[--held]);
+    }
+
+    ok = sim.overflows == 0 && sim_close();
+    rt_kprintf("chains:      %s, %d frames sent, %d received, %d bad\n",
+               ok && bad == 0 && received == sent ? "PASS" : "FAIL", sent, received, bad);
+
+    return ok && bad == 0 && received == sent;
+}
+
+static rt_bool_t check_tx_full(void)
+{
+    struct pbuf *p;
+    rt_uint16_t cut = BENCH_HDR_LEN;
+    rt_uint32_t sent = 0, received = 0, bad = 0;
+    rt_err_t result;
+    rt_bool_t ok;
+
+    if (sim_open(0, 0, RT_FALSE) != RT_EOK)
+    {
+        return RT_FALSE;
+    }
+
+    /* two descriptors per frame while the DMA is stopped */
+    sim.stopped = RT_TRUE;
+    do
+    {
+        p = frame_alloc(sent, BENCH_FRAME_LEN, &cut, 1, PBUF_ROM);
+        if (p == RT_NULL)
+        {
+            break;
+        }
+        result = eth_dma_tx(&sim.dma, p, 0);
+        pbuf_free(p);
+        sent += result == RT_EOK;
+    } while (result == RT_EOK);
+
+    sim.stopped = RT_FALSE;
+    sim_tx_poll(&sim.dma);
+    while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+    {
+        bad += !frame_check(p, received, BENCH_FRAME_LEN);
+        received++;
+        pbuf_free(p);
+    }
+
+    ok = sim_close();
+    ok = ok && sent == BENCH_TX_NUM / 2 && received == BENCH_RX_NUM && bad == 0;
+    rt_kprintf("tx full:     %s, %d frames queued, %d received in %d RX descriptors\n",
+               ok ? "PASS" : "FAIL", sent, received, BENCH_RX_NUM);
+
+    return ok;
+}
+
+static rt_bool_t check_rx_starved(void)
+{
+    struct eth_dma_stat stat;
+    struct pbuf *hold[BENCH_RX_BUF_NUM + 1], *p;
+    rt_uint32_t i, overflows, received = 0, bad = 0;
+    int held = 0;
+    rt_bool_t ok;
+
+    if (sim_open(0, 0, RT_FALSE) != RT_EOK)
+    {
+        return RT_FALSE;
+    }
+
+    /* the stack holds all buffers, the later frames are dropped */
+    for (i = 0; i < BENCH_RX_BUF_NUM * 2; i++)
+    {
+        p = frame_alloc(i, BENCH_FRAME_LEN, RT_NULL, 0, PBUF_ROM);
+        if (p)
+        {
+            eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER);
+            pbuf_free(p);
+        }
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            bad += !frame_check(p, i, BENCH_FRAME_LEN) || held == BENCH_RX_BUF_NUM;
+            hold[held++] = p;
+        }
+    }
+    overflows = sim.overflows;
+    eth_dma_get_stat(&sim.dma, &stat);
+
+    /* the freed buffers go back to the descriptors */
+    while (held > 0)
+    {
+        pbuf_free(hold[--held]);
+    }
+    for (i = 0; i < BENCH_RX_BUF_NUM; i++)
+    {
+        p = frame_alloc(i, BENCH_FRAME_LEN, RT_NULL, 0, PBUF_ROM);
+        if (p)
+        {
+            eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER);
+            pbuf_free(p);
+        }
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            bad += !frame_check(p, i, BENCH_FRAME_LEN);
+            received++;
+            pbuf_free(p);
+        }
+    }
+
+    ok = sim_close() && bad == 0 && overflows == BENCH_RX_BUF_NUM && stat.rx_starved > 0
+         && received == BENCH_RX_BUF_NUM && sim.overflows == overflows;
+    rt_kprintf("rx starved:  %s, %d frames dropped while held, %d received after the free\n",
+               ok ? "PASS" : "FAIL", overflows, received);
+
+    return ok;
+}
+
+static rt_bool_t check_limited(void)
+{
+    struct eth_dma_stat stat;
+    struct pbuf *p;
+    rt_uint16_t cut = BENCH_HDR_LEN;
+    rt_uint32_t i, received = 0, bad = 0;
+    rt_bool_t ok;
+
+    if (sim_open(0, 0, RT_TRUE) != RT_EOK)
+    {
+        return RT_FALSE;
+    }
+
+    /* frames the DMA can't read are copied */
+    for (i = 0; i < BENCH_TX_NUM; i++)
+    {
+        p = frame_alloc(i, BENCH_FRAME_LEN, &cut, 1, PBUF_ROM);
+        if (p)
+        {
+            eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER);
+            pbuf_free(p);
+        }
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            bad += !frame_check(p, received, BENCH_FRAME_LEN);
+            received++;
+            pbuf_free(p);
+        }
+    }
+    eth_dma_get_stat(&sim.dma, &stat);
+
+    ok = sim_close() && bad == 0 && received == BENCH_TX_NUM && stat.tx_copies == BENCH_TX_NUM;
+    rt_kprintf("copied tx:   %s, %d frames copied, %d received\n", ok ? "PASS" : "FAIL",
+               stat.tx_copies, received);
+
+    return ok;
+}
+
+static rt_bool_t check_volatile(void)
+{
+    static rt_uint8_t data[BENCH_FRAME_LEN];
+    struct eth_dma_stat stat;
+    struct pbuf *p;
+    rt_uint16_t cut = BENCH_HDR_LEN;
+    rt_uint32_t i, received = 0, bad = 0;
+    rt_bool_t ok;
+
+    if (sim_open(0, 0, RT_FALSE) != RT_EOK)
+    {
+        return RT_FALSE;
+    }
+
+    /* the data of a PBUF_REF is changed after the output, the DMA sends it later */
+    for (i = 0; i < BENCH_TX_NUM; i++)
+    {
+        p = frame_alloc(i, BENCH_FRAME_LEN, &cut, 1, PBUF_REF);
+        if (p == RT_NULL)
+        {
+            break;
+        }
+        rt_memcpy(data, p->next->payload, p->next->len);
+        p->next->payload = data;
+
+        sim.stopped = RT_TRUE;
+        eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER);
+        pbuf_free(p);
+        rt_memset(data, 0, sizeof(data));
+        sim.stopped = RT_FALSE;
+        sim_tx_poll(&sim.dma);
+
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            bad += !frame_check(p, i, BENCH_FRAME_LEN);
+            received++;
+            pbuf_free(p);
+        }
+    }
+    eth_dma_get_stat(&sim.dma, &stat);
+
+    ok = sim_close() && bad == 0 && received == BENCH_TX_NUM && stat.tx_copies == BENCH_TX_NUM;
+    rt_kprintf("volatile:    %s, %d frames copied, %d received\n", ok ? "PASS" : "FAIL",
+               stat.tx_copies, received);
+
+    return ok;
+}
+
+static rt_bool_t check_tcp(void)
+{
+    struct eth_dma_stat stat;
+    struct pbuf *p;
+    rt_uint16_t cut = BENCH_HDR_LEN;
+    rt_uint8_t saved[3];
+    rt_uint32_t i, copies, received = 0, bad = 0;
+    rt_bool_t ok;
+
+#if LWIP_VERSION_MAJOR == 1U || (LWIP_VERSION_MAJOR == 2U && LWIP_VERSION_MINOR == 0U)
+    /* the segments are retransmitted in place */
+    copies = BENCH_TX_NUM;
+#else
+    copies = 0;
+#endif
+
+    if (sim_open(0, 0, RT_FALSE) != RT_EOK)
+    {
+        return RT_FALSE;
+    }
+
+    /* an IPv4 TCP header at the start of the pattern */
+    saved[0] = pattern[12];
+    saved[1] = pattern[13];
+    saved[2] = pattern[14 + 9];
+    pattern[12] = 0x08;
+    pattern[13] = 0x00;
+    pattern[14 + 9] = 6;
+
+    for (i = 0; i < BENCH_TX_NUM; i++)
+    {
+        p = frame_alloc(0, BENCH_FRAME_LEN, &cut, 1, PBUF_ROM);
+        if (p)
+        {
+            eth_dma_tx(&sim.dma, p, RT_WAITING_FOREVER);
+            pbuf_free(p);
+        }
+        while ((p = eth_dma_rx(&sim.dma)) != RT_NULL)
+        {
+            bad += !frame_check(p, 0, BENCH_FRAME_LEN);
+            received++;
+            pbuf_free(p);
+        }
+    }
+    eth_dma_get_stat(&sim.dma, &stat);
+
+    pattern[12] = saved[0];
+    pattern[13] = saved[1];
+    pattern[14 + 9] = saved[2];
+
+    ok = sim_close() && bad == 0 && received == BENCH_TX_NUM && stat.tx_copies == copies;
+    rt_kprintf("tcp:         %s, %d frames copied for lwIP %d.%d, %d received\n", ok ? "PASS" : "FAIL",
+               stat.tx_copies, LWIP_VERSION_MAJOR, LWIP_VERSION_MINOR, received);
+
+    return ok;
+}
+
+static int eth_dma_bench(int argc, char **argv)
+{
+    rt_uint32_t frames = BENCH_FRAMES;
+    rt_uint32_t i;
+    rt_bool_t ok;
+
+    if (argc > 1)
+    {
+        frames = atoi(argv[1]);
+        if (frames == 0)
+        {
+            rt_kprintf("Usage: eth_dma_bench [frames]\n");
+            return -RT_EINVAL;
+        }
+    }
+
+    for (i = 0; i < sizeof(pattern); i++)
+    {
+        pattern[i] = (rt_uint8_t)(i * 13 + (i >> 8));
+    }
+    seed = 1;
+
+    rt_kprintf("%d frames through %d RX and %d TX descriptors, %d RX buffers\n",
+               frames, BENCH_RX_NUM, BENCH_TX_NUM, BENCH_RX_BUF_NUM);
+    rt_kprintf("%-12s %6s %8s %9s %9s %9s %9s\n", "mode", "bytes", "frames", "ns/frame",
+               "MB/s", "tx copies", "rx copies");
+    bench_run("copy", BENCH_FRAME_LEN, ETH_DMA_RX_BUF_SIZE, 0, RT_TRUE, frames);
+    bench_run("zero copy", BENCH_FRAME_LEN, 0, 0, RT_FALSE, frames);
+    bench_run("copy break", BENCH_FRAME_LEN, BENCH_COPY_BREAK, BENCH_COPY_BREAK, RT_FALSE, frames);
+    bench_run("copy", BENCH_SHORT_LEN, ETH_DMA_RX_BUF_SIZE, 0, RT_TRUE, frames);
+    bench_run("zero copy", BENCH_SHORT_LEN, 0, 0, RT_FALSE, frames);
+    bench_run("copy break", BENCH_SHORT_LEN, BENCH_COPY_BREAK, BENCH_COPY_BREAK, RT_FALSE, frames);
+    rt_kprintf("\n");
+
+    ok = check_chains();
+    ok = check_tx_full() && ok;
+    ok = check_rx_starved() && ok;
+    ok = check_limited() && ok;
+    ok = check_volatile() && ok;
+    ok = check_tcp() && ok;
+    rt_kprintf("self test: %s\n", ok ? "PASS" : "FAIL");
+
+    return ok ? 0 : -RT_ERROR;
+}
+MSH_CMD_EXPORT(eth_dma_bench, benchmark of the zero copy Ethernet descriptor rings);
+
+#endif /* BSP_USING_ETH_BENCH */
@@ -0,0 +1,548 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <board.h>
+#if defined(BSP_USING_ETH) || defined(BSP_USING_ETH_BENCH)
+
+#include <rthw.h>
+#include <lwip/init.h>
+#include "drv_eth_dma.h"
+
+#define LOG_TAG             "drv.ethdma"
+#include <drv_log.h>
+
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "the zero copy RX of the Ethernet DMA needs LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+/* the pad of lwIP is in front of the DMA buffer */
+#define RX_BUF_STRIDE       RT_ALIGN(ETH_DMA_RX_BUF_SIZE + ETH_PAD_SIZE, 4)
+
+#define RING_NEXT(i, num)   ((rt_uint16_t)((i) + 1 == (num) ? 0 : (i) + 1))
+
+/* the data of a pbuf may change after the output returns, it is sent from a copy */
+#ifdef PBUF_NEEDS_COPY
+#define PBUF_VOLATILE(q)    PBUF_NEEDS_COPY(q)
+#else
+#define PBUF_VOLATILE(q)    ((q)->type == PBUF_REF)
+#endif
+
+#define ETHTYPE_IP          0x0800U
+#define ETHTYPE_IPV6        0x86DDU
+#define IP_PROTO_TCP        6U
+
+/* give free buffers to the descriptors without one, with interrupts disabled */
+static rt_bool_t eth_dma_rx_refill(struct eth_dma *dma)
+{
+    struct eth_dma_rx_buf *buf;
+    struct eth_dma_desc *desc;
+    rt_bool_t filled = RT_FALSE;
+
+    while (dma->rx_filled < dma->rx_num && dma->rx_free != RT_NULL)
+    {
+        buf = dma->rx_free;
+        dma->rx_free = buf->next;
+
+        desc = &dma->rx_desc[dma->rx_fill];
+        dma->rx_ring[dma->rx_fill] = buf;
+        desc->buf1 = (rt_ubase_t)(buf->mem + ETH_PAD_SIZE);
+        desc->status = ETH_DMA_RX_OWN;
+
+        dma->rx_fill = RING_NEXT(dma->rx_fill, dma->rx_num);
+        dma->rx_filled++;
+        filled = RT_TRUE;
+    }
+
+    return filled;
+}
+
+static void eth_dma_rx_put(struct eth_dma *dma, struct eth_dma_rx_buf *buf)
+{
+    rt_base_t level;
+    rt_bool_t filled;
+
+    level = rt_hw_interrupt_disable();
+    buf->next = dma->rx_free;
+    dma->rx_free = buf;
+    filled = eth_dma_rx_refill(dma);
+    rt_hw_interrupt_enable(level);
+
+    if (filled)
+    {
+        dma->ops->rx_poll(dma);
+    }
+}
+
+/* lwIP frees a received frame */
+static void eth_dma_rx_free(struct pbuf *p)
+{
+    struct eth_dma_rx_buf *buf = (struct eth_dma_rx_buf *)p;
+
+    eth_dma_rx_put(buf->dma, buf);
+}
+
+static void eth_dma_rx_drop(struct eth_dma *dma, struct eth_dma_rx_buf *buf)
+{
+    if (dma->rx_head)
+    {
+        pbuf_free(dma->rx_head);
+        dma->rx_head = RT_NULL;
+    }
+    eth_dma_rx_put(dma, buf);
+    dma->stat.rx_errors++;
+}
+
+/* a descriptor written by the DMA, returns the frame at its last descriptor */
+static struct pbuf *eth_dma_rx_segment(struct eth_dma *dma, struct eth_dma_rx_buf *buf, rt_uint32_t status)
+{
+    struct pbuf *p;
+    rt_uint32_t head_len, frame_len;
+    rt_uint16_t len, offset;
+
+    if (status & ETH_DMA_RX_FS)
+    {
+        if (dma->rx_head)
+        {
+            /* the last descriptor of the previous frame is missing */
+            pbuf_free(dma->rx_head);
+            dma->rx_head = RT_NULL;
+            dma->stat.rx_errors++;
+        }
+    }
+    else if (dma->rx_head == RT_NULL)
+    {
+        eth_dma_rx_drop(dma, buf);
+        return RT_NULL;
+    }
+
+    head_len = dma->rx_head ? dma->rx_head->tot_len - ETH_PAD_SIZE : 0;
+    if (status & ETH_DMA_RX_LS)
+    {
+        frame_len = (status & ETH_DMA_RX_FL) >> ETH_DMA_RX_FL_SHIFT;
+        if ((status & ETH_DMA_RX_ES) || frame_len < head_len + ETH_DMA_CRC_SIZE
+                || frame_len - head_len - ETH_DMA_CRC_SIZE > ETH_DMA_RX_BUF_SIZE)
+        {
+            eth_dma_rx_drop(dma, buf);
+            return RT_NULL;
+        }
+        len = frame_len - head_len - ETH_DMA_CRC_SIZE;
+    }
+    else
+    {
+        len = ETH_DMA_RX_BUF_SIZE;
+    }
+
+    if ((status & ETH_DMA_RX_FS) && (status & ETH_DMA_RX_LS) && len <= dma->rx_copy_break)
+    {
+        /* a short frame gives its buffer back at once */
+        p = pbuf_alloc(PBUF_RAW, len + ETH_PAD_SIZE, PBUF_POOL);
+        if (p)
+        {
+            pbuf_take(p, buf->mem, len + ETH_PAD_SIZE);
+            dma->stat.rx_copies++;
+            dma->stat.rx_frames++;
+        }
+        else
+        {
+            dma->stat.rx_drops++;
+        }
+        eth_dma_rx_put(dma, buf);
+        return p;
+    }
+
+    /* the pad is in the first pbuf only */
+    offset = (status & ETH_DMA_RX_FS) ? 0 : ETH_PAD_SIZE;
+    if (offset == 0)
+    {
+        len += ETH_PAD_SIZE;
+    }
+    p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &buf->pc, buf->mem + offset, RX_BUF_STRIDE - offset);
+    RT_ASSERT(p != RT_NULL);
+
+    if (dma->rx_head)
+    {
+        pbuf_cat(dma->rx_head, p);
+    }
+    else
+    {
+        dma->rx_head = p;
+    }
+    if (!(status & ETH_DMA_RX_LS))
+    {
+        return RT_NULL;
+    }
+
+    p = dma->rx_head;
+    dma->rx_head = RT_NULL;
+    dma->stat.rx_frames++;
+
+    return p;
+}
+
+struct pbuf *eth_dma_rx(struct eth_dma *dma)
+{
+    struct eth_dma_rx_buf *buf;
+    struct pbuf *p;
+    rt_uint32_t status;
+    rt_base_t level;
+    rt_bool_t filled;
+
+    RT_ASSERT(dma);
+
+    eth_dma_tx_reclaim(dma);
+
+    while (1)
+    {
+        level = rt_hw_interrupt_disable();
+        status = dma->rx_desc[dma->rx_cur].status;
+        if (dma->rx_filled == 0 || (status & ETH_DMA_RX_OWN))
+        {
+            rt_hw_interrupt_enable(level);
+            return RT_NULL;
+        }
+        buf = dma->rx_ring[dma->rx_cur];
+        dma->rx_ring[dma->rx_cur] = RT_NULL;
+        dma->rx_cur = RING_NEXT(dma->rx_cur, dma->rx_num);
+        dma->rx_filled--;
+        rt_hw_interrupt_enable(level);
+
+        p = eth_dma_rx_segment(dma, buf, status);
+
+        level = rt_hw_interrupt_disable();
+        filled = eth_dma_rx_refill(dma);
+        if (dma->rx_filled < dma->rx_num)
+        {
+            /* lwIP holds all buffers, the DMA stops at the empty descriptor */
+            dma->stat.rx_starved++;
+        }
+        rt_hw_interrupt_enable(level);
+
+        if (filled)
+        {
+            dma->ops->rx_poll(dma);
+        }
+        if (p)
+        {
+            return p;
+        }
+    }
+}
+
+/* free the frames of the descriptors the DMA gave back, with the tx lock */
+static void eth_dma_tx_clean(struct eth_dma *dma)
+{
+    struct eth_dma_desc *desc;
+    rt_uint32_t status;
+
+    while (dma->tx_used)
+    {
+        desc = &dma->tx_desc[dma->tx_tail];
+        status = desc->status;
+        if (status & ETH_DMA_TX_OWN)
+        {
+            break;
+        }
+
+        if ((status & ETH_DMA_TX_LS) && (status & ETH_DMA_TX_ES))
+        {
+            dma->stat.tx_errors++;
+        }
+        if (dma->tx_pbuf[dma->tx_tail])
+        {
+            pbuf_free(dma->tx_pbuf[dma->tx_tail]);
+            dma->tx_pbuf[dma->tx_tail] = RT_NULL;
+        }
+        dma->tx_tail = RING_NEXT(dma->tx_tail, dma->tx_num);
+        dma->tx_used--;
+    }
+}
+
+void eth_dma_tx_reclaim(struct eth_dma *dma)
+{
+    RT_ASSERT(dma);
+
+    rt_mutex_take(&dma->tx_lock, RT_WAITING_FOREVER);
+    eth_dma_tx_clean(dma);
+    rt_mutex_release(&dma->tx_lock);
+}
+
+static rt_err_t eth_dma_tx_wait(struct eth_dma *dma, rt_uint16_t segs, rt_int32_t timeout)
+{
+    rt_err_t result = RT_EOK;
+
+    eth_dma_tx_clean(dma);
+    if (dma->tx_num - dma->tx_used >= segs)
+    {
+        return RT_EOK;
+    }
+
+    dma->stat.tx_waits++;
+    while (result == RT_EOK)
+    {
+        /* the flag is set before the check, a completion after it releases the semaphore */
+        dma->tx_waiting = RT_TRUE;
+        eth_dma_tx_clean(dma);
+        if (dma->tx_num - dma->tx_used >= segs)
+        {
+            break;
+        }
+        if (timeout == 0)
+        {
+            result = -RT_ETIMEOUT;
+            break;
+        }
+
+        /* the rx thread may reclaim meanwhile */
+        rt_mutex_release(&dma->tx_lock);
+        result = rt_sem_take(&dma->tx_sem, timeout);
+        rt_mutex_take(&dma->tx_lock, RT_WAITING_FOREVER);
+    }
+    dma->tx_waiting = RT_FALSE;
+
+    return result;
+}
+
+#if LWIP_VERSION_MAJOR == 1U || (LWIP_VERSION_MAJOR == 2U && LWIP_VERSION_MINOR == 0U)
+/*
+ * Before 2.1.0 the TCP of lwIP rewrites the headers of a segment in place to
+ * retransmit it, without tcp_output_segment_busy() to wait for the driver.
+ */
+static rt_bool_t eth_dma_tx_is_tcp(struct pbuf *p)
+{
+    const rt_uint8_t *frame = (const rt_uint8_t *)p->payload;
+    rt_uint16_t type;
+
+    /* the Ethernet and the IP header are in the first pbuf */
+    if (p->len < 14 + 20)
+    {
+        return RT_FALSE;
+    }
+
+    type = (frame[12] << 8) | frame[13];
+    if (type == ETHTYPE_IP)
+    {
+        return frame[14 + 9] == IP_PROTO_TCP;
+    }
+    if (type == ETHTYPE_IPV6)
+    {
+        return frame[14 + 6] == IP_PROTO_TCP;
+    }
+
+    return RT_FALSE;
+}
+#else
+#define eth_dma_tx_is_tcp(p)    RT_FALSE
+#endif
+
+rt_err_t eth_dma_tx(struct eth_dma *dma, struct pbuf *p, rt_int32_t timeout)
+{
+    struct eth_dma_desc *desc;
+    struct pbuf *frame, *q;
+    rt_uint32_t flags;
+    rt_uint16_t segs = 0, first, i;
+    rt_err_t result = RT_EOK;
+
+    RT_ASSERT(dma);
+    RT_ASSERT(p);
+
+#if ETH_PAD_SIZE
+    pbuf_header(p, -ETH_PAD_SIZE);
+#endif
+
+    frame = p;
+    for (q = p; q != RT_NULL; q = q->next)
+    {
+        if (q->len == 0)
+        {
+            continue;
+        }
+        segs++;
+        if (PBUF_VOLATILE(q) || (dma->ops->tx_capable && !dma->ops->tx_capable(dma, q->payload, q->len)))
+        {
+            frame = RT_NULL;
+        }
+    }
+    if (segs > dma->tx_num || (segs > 1 && p->tot_len <= dma->tx_copy_break) || eth_dma_tx_is_tcp(p))
+    {
+        frame = RT_NULL;
+    }
+
+    if (frame == RT_NULL)
+    {
+        frame = pbuf_alloc(PBUF_RAW, p->tot_len, PBUF_RAM);
+        if (frame == RT_NULL)
+        {
+            result = -RT_ENOMEM;
+            goto __exit;
+        }
+        pbuf_copy(frame, p);
+        segs = 1;
+        dma->stat.tx_copies++;
+    }
+    else
+    {
+        pbuf_ref(frame);
+    }
+
+    rt_mutex_take(&dma->tx_lock, RT_WAITING_FOREVER);
+    result = eth_dma_tx_wait(dma, segs, timeout);
+    if (result != RT_EOK)
+    {
+        rt_mutex_release(&dma->tx_lock);
+        pbuf_free(frame);
+        goto __exit;
+    }
+
+    /* the first descriptor is given to the DMA after the others */
+    first = dma->tx_head;
+    for (i = 0, q = frame; q != RT_NULL; q = q->next)
+    {
+        if (q->len == 0)
+        {
+            continue;
+        }
+
+        flags = ETH_DMA_TX_TCH | dma->tx_flags;
+        flags |= (i == 0) ? ETH_DMA_TX_FS : ETH_DMA_TX_OWN;
+        if (++i == segs)
+        {
+            flags |= ETH_DMA_TX_LS | ETH_DMA_TX_IC;
+            /* the frame is freed with its last descriptor */
+            dma->tx_pbuf[dma->tx_head] = frame;
+        }
+
+        desc = &dma->tx_desc[dma->tx_head];
+        desc->buf1 = (rt_ubase_t)q->payload;
+        desc->control = q->len & ETH_DMA_TX_TBS1;
+        desc->status = flags;
+
+        dma->tx_head = RING_NEXT(dma->tx_head, dma->tx_num);
+        dma->tx_used++;
+    }
+    dma->tx_desc[first].status |= ETH_DMA_TX_OWN;
+    dma->stat.tx_frames++;
+    rt_mutex_release(&dma->tx_lock);
+
+    dma->ops->tx_poll(dma);
+
+__exit:
+#if ETH_PAD_SIZE
+    pbuf_header(p, ETH_PAD_SIZE);
+#endif
+    return result;
+}
+
+void eth_dma_tx_isr(struct eth_dma *dma)
+{
+    if (dma->tx_waiting)
+    {
+        rt_sem_release(&dma->tx_sem);
+    }
+}
+
+void eth_dma_get_stat(struct eth_dma *dma, struct eth_dma_stat *stat)
+{
+    RT_ASSERT(dma);
+    RT_ASSERT(stat);
+
+    *stat = dma->stat;
+}
+
+rt_err_t eth_dma_init(struct eth_dma *dma, const struct eth_dma_ops *ops,
+                      rt_uint16_t rx_num, rt_uint16_t rx_buf_num, rt_uint16_t tx_num)
+{
+    rt_uint16_t i;
+
+    RT_ASSERT(dma);
+    RT_ASSERT(ops && ops->tx_poll && ops->rx_poll);
+    RT_ASSERT(rx_num > 0 && rx_buf_num >= rx_num && tx_num > 0);
+
+    rt_memset(dma, 0, sizeof(struct eth_dma));
+    dma->ops = ops;
+    dma->rx_num = rx_num;
+    dma->rx_buf_num = rx_buf_num;
+    dma->tx_num = tx_num;
+
+    dma->rx_desc = (struct eth_dma_desc *)rt_calloc(rx_num, sizeof(struct eth_dma_desc));
+    dma->rx_ring = (struct eth_dma_rx_buf **)rt_calloc(rx_num, sizeof(struct eth_dma_rx_buf *));
+    dma->rx_bufs = (struct eth_dma_rx_buf *)rt_calloc(rx_buf_num, sizeof(struct eth_dma_rx_buf));
+    dma->rx_mem = (rt_uint8_t *)rt_malloc(rx_buf_num * RX_BUF_STRIDE);
+    dma->tx_desc = (struct eth_dma_desc *)rt_calloc(tx_num, sizeof(struct eth_dma_desc));
+    dma->tx_pbuf = (struct pbuf **)rt_calloc(tx_num, sizeof(struct pbuf *));
+    if (!dma->rx_desc || !dma->rx_ring || !dma->rx_bufs || !dma->rx_mem || !dma->tx_desc || !dma->tx_pbuf)
+    {
+        LOG_E("no memory for %d RX buffers", rx_buf_num);
+        rt_free(dma->rx_desc);
+        rt_free(dma->rx_ring);
+        rt_free(dma->rx_bufs);
+        rt_free(dma->rx_mem);
+        rt_free(dma->tx_desc);
+        rt_free(dma->tx_pbuf);
+        return -RT_ENOMEM;
+    }
+
+    for (i = 0; i < rx_num; i++)
+    {
+        dma->rx_desc[i].control = ETH_DMA_RX_RCH | ETH_DMA_RX_BUF_SIZE;
+        dma->rx_desc[i].next = (rt_ubase_t)&dma->rx_desc[RING_NEXT(i, rx_num)];
+    }
+    for (i = rx_buf_num; i > 0; i--)
+    {
+        struct eth_dma_rx_buf *buf = &dma->rx_bufs[i - 1];
+
+        buf->pc.custom_free_function = eth_dma_rx_free;
+        buf->dma = dma;
+        buf->mem = dma->rx_mem + (i - 1) * RX_BUF_STRIDE;
+        buf->next = dma->rx_free;
+        dma->rx_free = buf;
+    }
+    eth_dma_rx_refill(dma);
+
+    for (i = 0; i < tx_num; i++)
+    {
+        dma->tx_desc[i].status = ETH_DMA_TX_TCH;
+        dma->tx_desc[i].next = (rt_ubase_t)&dma->tx_desc[RING_NEXT(i, tx_num)];
+    }
+    rt_mutex_init(&dma->tx_lock, "ethtx", RT_IPC_FLAG_PRIO);
+    rt_sem_init(&dma->tx_sem, "ethtx", 0, RT_IPC_FLAG_FIFO);
+
+    return RT_EOK;
+}
+
+void eth_dma_deinit(struct eth_dma *dma)
+{
+    RT_ASSERT(dma);
+
+    while (dma->tx_used)
+    {
+        if (dma->tx_pbuf[dma->tx_tail])
+        {
+            pbuf_free(dma->tx_pbuf[dma->tx_tail]);
+        }
+        dma->tx_tail = RING_NEXT(dma->tx_tail, dma->tx_num);
+        dma->tx_used--;
+    }
+    if (dma->rx_head)
+    {
+        pbuf_free(dma->rx_head);
+        dma->rx_head = RT_NULL;
+    }
+
+    rt_mutex_detach(&dma->tx_lock);
+    rt_sem_detach(&dma->tx_sem);
+    rt_free(dma->rx_desc);
+    rt_free(dma->rx_ring);
+    rt_free(dma->rx_bufs);
+    rt_free(dma->rx_mem);
+    rt_free(dma->tx_desc);
+    rt_free(dma->tx_pbuf);
+}
+
+#endif /* BSP_USING_ETH || BSP_USING_ETH_BENCH */
@@ -13,6 +13,9 @@
 #ifdef RT_USING_QSPI
 #include "drv_qspi.h"
 #include "drv_config.h"
+#ifdef RT_USING_QSPI_NOR
+#include <qspi_nor.h>
+#endif
 
 #define DRV_DEBUG
 #define LOG_TAG              "drv.qspi"
@@ -124,11 +127,8 @@ static int stm32_qspi_init(struct rt_qspi_device *device, struct rt_qspi_configu
     return result;
 }
 
-static void qspi_send_cmd(struct stm32_qspi_bus *qspi_bus, struct rt_qspi_message *message)
+static void qspi_cmd_config(struct rt_qspi_message *message, QSPI_CommandTypeDef *cmd)
 {
-    RT_ASSERT(qspi_bus != RT_NULL);
-    RT_ASSERT(message != RT_NULL);
-
     QSPI_CommandTypeDef Cmdhandler;
 
     /* set QSPI cmd struct */
@@ -197,6 +197,17 @@ static void qspi_send_cmd(struct stm32_qspi_bus *qspi_bus, struct rt_qspi_messag
     Cmdhandler.DdrMode = QSPI_DDR_MODE_DISABLE;
     Cmdhandler.DdrHoldHalfCycle = QSPI_DDR_HHC_ANALOG_DELAY;
     Cmdhandler.NbData = message->parent.length;
+    *cmd = Cmdhandler;
+}
+
+static void qspi_send_cmd(struct stm32_qspi_bus *qspi_bus, struct rt_qspi_message *message)
+{
+    RT_ASSERT(qspi_bus != RT_NULL);
+    RT_ASSERT(message != RT_NULL);
+
+    QSPI_CommandTypeDef Cmdhandler;
+
+    qspi_cmd_config(message, &Cmdhandler);
     HAL_QSPI_Command(&qspi_bus->QSPI_Handler, &Cmdhandler, 5000);
 }
 
@@ -390,6 +401,43 @@ void QSPI_DMA_IRQHandler(void)
 }
 #endif /* BSP_QSPI_USING_DMA */
 
+#if defined(RT_USING_QSPI_NOR) && !defined(BSP_QSPI_USING_SOFTCS)
+/**
+  * @brief  Switch the QSPI bus to the memory mapped mode with a read command.
+  * @param  device   QSPI device of the flash
+  * @param  message  read command, without address content and data buffers
+  * @retval the address of the flash in the memory, RT_NULL on failure
+  */
+const void *qspi_nor_port_map(struct rt_qspi_device *device, struct rt_qspi_message *message)
+{
+    struct stm32_qspi_bus *qspi_bus = device->parent.bus->parent.user_data;
+    QSPI_MemoryMappedTypeDef mapped_cfg = {0};
+    QSPI_CommandTypeDef Cmdhandler;
+
+    qspi_cmd_config(message, &Cmdhandler);
+    mapped_cfg.TimeOutActivation = QSPI_TIMEOUT_COUNTER_DISABLE;
+    if (HAL_QSPI_MemoryMapped(&qspi_bus->QSPI_Handler, &Cmdhandler, &mapped_cfg) != HAL_OK)
+    {
+        LOG_E("QSPI memory mapped mode failed(%d)!", qspi_bus->QSPI_Handler.ErrorCode);
+        qspi_bus->QSPI_Handler.State = HAL_QSPI_STATE_READY;
+        return RT_NULL;
+    }
+
+    return (const void *)QSPI_BASE;
+}
+
+/**
+  * @brief  Leave the memory mapped mode for the indirect commands.
+  * @param  device   QSPI device of the flash
+  */
+void qspi_nor_port_unmap(struct rt_qspi_device *device)
+{
+    struct stm32_qspi_bus *qspi_bus = device->parent.bus->parent.user_data;
+
+    HAL_QSPI_Abort(&qspi_bus->QSPI_Handler);
+}
+#endif /* RT_USING_QSPI_NOR && !BSP_QSPI_USING_SOFTCS */
+
 static int rt_hw_qspi_bus_init(void)
 {
     return stm32_qspi_register_bus(&_stm32_qspi_bus, "qspi1");
@@ -375,11 +375,11 @@ static void rthw_sdio_request(struct rt_mmcsd_host *host, struct rt_mmcsd_req *r
         {
             rt_uint32_t size = data->blks * data->blksize;
 
-            RT_ASSERT(size <= SDIO_BUFF_SIZE);
-
             pkg.buff = data->buf;
             if ((rt_uint32_t)data->buf & (SDIO_ALIGN_LEN - 1))
             {
+                /* only the unaligned buffers are limited by the cache buffer */
+                RT_ASSERT(size <= SDIO_BUFF_SIZE);
                 pkg.buff = cache_buf;
                 if (data->flags & DATA_DIR_WRITE)
                 {
@@ -662,6 +662,8 @@ struct rt_mmcsd_host *sdio_host_create(struct stm32_sdio_des *sdio_des)
 #else
     host->flags = MMCSD_MUTBLKWRITE | MMCSD_SUP_SDIO_IRQ;
 #endif
+    /* aligned buffers are sent by DMA directly, up to max_blk_count blocks */
+    host->flags |= MMCSD_SUP_BIG_DMA;
     host->max_seg_size = SDIO_BUFF_SIZE;
     host->max_dma_segs = 1;
     host->max_blk_size = 512;
@@ -16,7 +16,7 @@
 
 #include "board.h"
 
-#ifdef RT_USING_SERIAL
+#ifdef RT_USING_SERIAL_V1
 
 #include "string.h"
 #include "stdlib.h"
@@ -1377,4 +1377,4 @@ int rt_hw_usart_init(void)
     return result;
 }
 
-#endif /* RT_USING_SERIAL */
+#endif /* RT_USING_SERIAL_V1 */
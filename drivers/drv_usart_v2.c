@@ -11,6 +11,7 @@
 #include "board.h"
 
 #ifdef RT_USING_SERIAL_V2
+#include <stdlib.h>
 #include "drv_usart_v2.h"
 
 //#define DRV_DEBUG
@@ -107,6 +108,221 @@ static struct stm32_uart_config uart_config[] =
 };
 
 
+static rt_err_t stm32_uart_clk_enable(struct stm32_uart_config *config)
+{
+    /* uart clock enable */
+    switch ((uint32_t)config->Instance)
+    {
+#ifdef BSP_USING_UART1
+    case (uint32_t)USART1:
+        __HAL_RCC_USART1_CLK_ENABLE();
+        break;
+#endif /* BSP_USING_UART1 */
+#ifdef BSP_USING_UART2
+    case (uint32_t)USART2:
+        __HAL_RCC_USART2_CLK_ENABLE();
+        break;
+#endif /* BSP_USING_UART2 */
+#ifdef BSP_USING_UART3
+    case (uint32_t)USART3:
+        __HAL_RCC_USART3_CLK_ENABLE();
+        break;
+#endif /* BSP_USING_UART3 */
+#ifdef BSP_USING_UART4
+#if defined(SOC_SERIES_STM32F0) || defined(SOC_SERIES_STM32L0) || \
+   defined(SOC_SERIES_STM32G0)
+    case (uint32_t)USART4:
+        __HAL_RCC_USART4_CLK_ENABLE();
+#else
+    case (uint32_t)UART4:
+        __HAL_RCC_UART4_CLK_ENABLE();
+#endif
+        break;
+#endif /* BSP_USING_UART4 */
+#ifdef BSP_USING_UART5
+#if defined(SOC_SERIES_STM32F0) || defined(SOC_SERIES_STM32L0) || \
+   defined(SOC_SERIES_STM32G0)
+    case (uint32_t)USART5:
+        __HAL_RCC_USART5_CLK_ENABLE();
+#else
+    case (uint32_t)UART5:
+        __HAL_RCC_UART5_CLK_ENABLE();
+#endif
+        break;
+#endif /* BSP_USING_UART5 */
+#ifdef BSP_USING_UART6
+    case (uint32_t)USART6:
+        __HAL_RCC_USART6_CLK_ENABLE();
+        break;
+#endif /* BSP_USING_UART6 */
+#ifdef BSP_USING_UART7
+#if defined(SOC_SERIES_STM32F0)
+    case (uint32_t)USART7:
+        __HAL_RCC_USART7_CLK_ENABLE();
+#else
+    case (uint32_t)UART7:
+        __HAL_RCC_UART7_CLK_ENABLE();
+#endif
+        break;
+#endif /* BSP_USING_UART7 */
+#ifdef BSP_USING_UART8
+#if defined(SOC_SERIES_STM32F0)
+    case (uint32_t)USART8:
+        __HAL_RCC_USART8_CLK_ENABLE();
+#else
+    case (uint32_t)UART8:
+        __HAL_RCC_UART8_CLK_ENABLE();
+#endif
+        break;
+#endif /* BSP_USING_UART8 */
+#ifdef BSP_USING_LPUART1
+    case (uint32_t)LPUART1:
+       __HAL_RCC_LPUART1_CLK_ENABLE();
+        break;
+#endif /* BSP_USING_LPUART1 */
+    default:
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t stm32_gpio_clk_enable(GPIO_TypeDef *gpiox)
+{
+    /* check the parameters */
+    RT_ASSERT(IS_GPIO_ALL_INSTANCE(gpiox));
+
+    /* gpio ports clock enable */
+    switch ((uint32_t)gpiox)
+    {
+#if defined(__HAL_RCC_GPIOA_CLK_ENABLE)
+    case (uint32_t)GPIOA:
+        __HAL_RCC_GPIOA_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOB_CLK_ENABLE)
+    case (uint32_t)GPIOB:
+        __HAL_RCC_GPIOB_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOC_CLK_ENABLE)
+    case (uint32_t)GPIOC:
+        __HAL_RCC_GPIOC_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOD_CLK_ENABLE)
+    case (uint32_t)GPIOD:
+        __HAL_RCC_GPIOD_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOE_CLK_ENABLE)
+    case (uint32_t)GPIOE:
+        __HAL_RCC_GPIOE_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOF_CLK_ENABLE)
+    case (uint32_t)GPIOF:
+        __HAL_RCC_GPIOF_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOG_CLK_ENABLE)
+    case (uint32_t)GPIOG:
+        __HAL_RCC_GPIOG_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOH_CLK_ENABLE)
+    case (uint32_t)GPIOH:
+        __HAL_RCC_GPIOH_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOI_CLK_ENABLE)
+    case (uint32_t)GPIOI:
+        __HAL_RCC_GPIOI_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOJ_CLK_ENABLE)
+    case (uint32_t)GPIOJ:
+        __HAL_RCC_GPIOJ_CLK_ENABLE();
+        break;
+#endif
+#if defined(__HAL_RCC_GPIOK_CLK_ENABLE)
+    case (uint32_t)GPIOK:
+        __HAL_RCC_GPIOK_CLK_ENABLE();
+        break;
+#endif
+    default:
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+static int up_char(char * c)
+{
+    if ((*c >= 'a') && (*c <= 'z'))
+    {
+        *c = *c - 32;
+    }
+    return 0;
+}
+
+static void get_pin_by_name(const char* pin_name, GPIO_TypeDef **port, uint16_t *pin)
+{
+    int pin_num = atoi((char*) &pin_name[2]);
+    char port_name = pin_name[1];
+    up_char(&port_name);
+    up_char(&port_name);
+    *port = ((GPIO_TypeDef *) ((uint32_t) GPIOA
+            + (uint32_t) (port_name - 'A') * ((uint32_t) GPIOB - (uint32_t) GPIOA)));
+    *pin = (GPIO_PIN_0 << pin_num);
+}
+static rt_err_t stm32_gpio_configure(struct stm32_uart_config *config)
+{
+    int uart_num = 0;
+    GPIO_InitTypeDef GPIO_InitStruct = {0};
+    GPIO_TypeDef *tx_port;
+    GPIO_TypeDef *rx_port;
+    uint16_t tx_pin;
+    uint16_t rx_pin;
+    uart_num = config->name[4] - '0';
+    get_pin_by_name(config->rx_pin_name, &rx_port, &rx_pin);
+    get_pin_by_name(config->tx_pin_name, &tx_port, &tx_pin);
+    /* gpio ports clock enable */
+    stm32_gpio_clk_enable(tx_port);
+    if (tx_port != rx_port)
+    {
+        stm32_gpio_clk_enable(rx_port);
+    }
+    
+    /* rx pin initialize */
+    GPIO_InitStruct.Pin = tx_pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_AF_PP;
+    GPIO_InitStruct.Pull = GPIO_PULLUP;
+    GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_HIGH;
+#if defined(SOC_SERIES_STM32F2) || defined(SOC_SERIES_STM32F4) || \
+    defined(SOC_SERIES_STM32F7) || defined(SOC_SERIES_STM32G4) || \
+    defined(SOC_SERIES_STM32L1) || defined(SOC_SERIES_STM32L4)
+#define GPIO_AF7   ((uint8_t)0x07)
+#define GPIO_AF8   ((uint8_t)0x08)
+    /* uart1-3 -> AF7, uart4-8 -> AF8 */
+    if (uart_num <= 3)
+    {
+        GPIO_InitStruct.Alternate = GPIO_AF7;
+    }
+    else
+    {
+        GPIO_InitStruct.Alternate = GPIO_AF8;
+    }
+#endif
+    HAL_GPIO_Init(tx_port, &GPIO_InitStruct);
+
+    /* rx pin initialize */
+    GPIO_InitStruct.Pin = rx_pin;
+    HAL_GPIO_Init(rx_port, &GPIO_InitStruct);
+
+    return RT_EOK;
+}
+
 static struct stm32_uart uart_obj[sizeof(uart_config) / sizeof(uart_config[0])] = {0};
 
 static rt_err_t stm32_configure(struct rt_serial_device *serial, struct serial_configure *cfg)
@@ -117,6 +333,11 @@ static rt_err_t stm32_configure(struct rt_serial_device *serial, struct serial_c
 
     uart = rt_container_of(serial, struct stm32_uart, serial);
 
+    /* uart clock enable */
+    stm32_uart_clk_enable(uart->config);
+    /* uart gpio clock enable and gpio pin init */
+    stm32_gpio_configure(uart->config);
+
     uart->handle.Instance          = uart->config->Instance;
     uart->handle.Init.BaudRate     = cfg->baud_rate;
     uart->handle.Init.HwFlowCtl    = UART_HWCONTROL_NONE;
@@ -169,7 +390,7 @@ static rt_err_t stm32_configure(struct rt_serial_device *serial, struct serial_c
     }
 
 #ifdef RT_SERIAL_USING_DMA
-    uart->dma_rx.remaining_cnt = serial->config.rx_bufsz;
+    uart->dma_rx.last_index = 0;
 #endif
 
     if (HAL_UART_Init(&uart->handle) != HAL_OK)
@@ -218,6 +439,7 @@ static rt_err_t stm32_control(struct rt_serial_device *serial, int cmd, void *ar
         else if (ctrl_arg == RT_DEVICE_FLAG_DMA_RX)
         {
             __HAL_UART_DISABLE_IT(&(uart->handle), UART_IT_RXNE);
+            __HAL_UART_DISABLE_IT(&(uart->handle), UART_IT_IDLE);
 
             HAL_NVIC_DisableIRQ(uart->config->dma_rx->dma_irq);
             if (HAL_DMA_Abort(&(uart->dma_rx.handle)) != HAL_OK)
@@ -380,44 +602,23 @@ static rt_size_t stm32_transmit(struct rt_serial_device     *serial,
 }
 
 #ifdef RT_SERIAL_USING_DMA
-static void dma_recv_isr(struct rt_serial_device *serial, rt_uint8_t isr_flag)
+static void dma_recv_isr(struct rt_serial_device *serial)
 {
     struct stm32_uart *uart;
+    struct rt_serial_rx_fifo *rx_fifo;
     rt_base_t level;
     rt_size_t recv_len, counter;
 
     RT_ASSERT(serial != RT_NULL);
     uart = rt_container_of(serial, struct stm32_uart, serial);
+    rx_fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
+    RT_ASSERT(rx_fifo != RT_NULL);
 
     level = rt_hw_interrupt_disable();
-    recv_len = 0;
     counter = __HAL_DMA_GET_COUNTER(&(uart->dma_rx.handle));
-
-    switch (isr_flag)
-    {
-    case UART_RX_DMA_IT_IDLE_FLAG:
-        if (counter <= uart->dma_rx.remaining_cnt)
-            recv_len = uart->dma_rx.remaining_cnt - counter;
-        else
-            recv_len = serial->config.rx_bufsz + uart->dma_rx.remaining_cnt - counter;
-        break;
-
-    case UART_RX_DMA_IT_HT_FLAG:
-        if (counter < uart->dma_rx.remaining_cnt)
-            recv_len = uart->dma_rx.remaining_cnt - counter;
-        break;
-
-    case UART_RX_DMA_IT_TC_FLAG:
-        if(counter >= uart->dma_rx.remaining_cnt)
-            recv_len = serial->config.rx_bufsz + uart->dma_rx.remaining_cnt - counter;
-
-    default:
-        break;
-    }
-
+    recv_len = rt_serial_dma_rx_len(rx_fifo->rb.buffer_size, &uart->dma_rx.last_index, counter);
     if (recv_len)
     {
-        uart->dma_rx.remaining_cnt = counter;
         rt_hw_serial_isr(serial, RT_SERIAL_EVENT_RX_DMADONE | (recv_len << 8));
     }
     rt_hw_interrupt_enable(level);
@@ -426,6 +627,21 @@ static void dma_recv_isr(struct rt_serial_device *serial, rt_uint8_t isr_flag)
 #endif  /* RT_SERIAL_USING_DMA */
 
 
+/* count the errors of the received data, reading the data register clears them */
+static void uart_error_isr(struct rt_serial_device *serial)
+{
+    struct stm32_uart *uart;
+
+    uart = rt_container_of(serial, struct stm32_uart, serial);
+    if (__HAL_UART_GET_FLAG(&(uart->handle), UART_FLAG_ORE) != RESET)
+        rt_hw_serial_isr(serial, RT_SERIAL_EVENT_RX_ERROR | (RT_SERIAL_ERR_OVERRUN << 8));
+    if (__HAL_UART_GET_FLAG(&(uart->handle), UART_FLAG_FE) != RESET ||
+        __HAL_UART_GET_FLAG(&(uart->handle), UART_FLAG_NE) != RESET)
+        rt_hw_serial_isr(serial, RT_SERIAL_EVENT_RX_ERROR | (RT_SERIAL_ERR_FRAMING << 8));
+    if (__HAL_UART_GET_FLAG(&(uart->handle), UART_FLAG_PE) != RESET)
+        rt_hw_serial_isr(serial, RT_SERIAL_EVENT_RX_ERROR | (RT_SERIAL_ERR_PARITY << 8));
+}
+
 /**
  * Uart common interrupt process. This need add to uart ISR.
  *
@@ -445,7 +661,8 @@ static void uart_isr(struct rt_serial_device *serial)
         rx_fifo = (struct rt_serial_rx_fifo *) serial->serial_rx;
         RT_ASSERT(rx_fifo != RT_NULL);
 
-        rt_ringbuffer_putchar(&(rx_fifo->rb), UART_GET_RDR(&uart->handle, stm32_uart_get_mask(uart->handle.Init.WordLength, uart->handle.Init.Parity)));
+        uart_error_isr(serial);
+        rt_spsc_ring_putchar(&(rx_fifo->rb), UART_GET_RDR(&uart->handle, stm32_uart_get_mask(uart->handle.Init.WordLength, uart->handle.Init.Parity)));
 
         rt_hw_serial_isr(serial, RT_SERIAL_EVENT_RX_IND);
     }
@@ -490,12 +707,14 @@ static void uart_isr(struct rt_serial_device *serial)
     else if ((uart->uart_dma_flag) && (__HAL_UART_GET_FLAG(&(uart->handle), UART_FLAG_IDLE) != RESET)
              && (__HAL_UART_GET_IT_SOURCE(&(uart->handle), UART_IT_IDLE) != RESET))
     {
-        dma_recv_isr(serial, UART_RX_DMA_IT_IDLE_FLAG);
+        dma_recv_isr(serial);
+        uart_error_isr(serial);
         __HAL_UART_CLEAR_IDLEFLAG(&uart->handle);
     }
 #endif
     else
     {
+        uart_error_isr(serial);
         if (__HAL_UART_GET_FLAG(&(uart->handle), UART_FLAG_ORE) != RESET)
         {
             LOG_E("(%s) serial device Overrun error!", serial->parent.parent.name);
@@ -1051,8 +1270,9 @@ static void stm32_dma_config(struct rt_serial_device *serial, rt_ubase_t flag)
     {
         rx_fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
         RT_ASSERT(rx_fifo != RT_NULL);
-        /* Start DMA transfer */
-        if (HAL_UART_Receive_DMA(&(uart->handle), rx_fifo->buffer, serial->config.rx_bufsz) != HAL_OK)
+        /* Start DMA transfer, the ring is the buffer of the circular DMA */
+        uart->dma_rx.last_index = 0;
+        if (HAL_UART_Receive_DMA(&(uart->handle), rx_fifo->buffer, rx_fifo->rb.buffer_size) != HAL_OK)
         {
             /* Transfer error in reception process */
             RT_ASSERT(0);
@@ -1099,7 +1319,7 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
     struct stm32_uart *uart;
     RT_ASSERT(huart != NULL);
     uart = (struct stm32_uart *)huart;
-    dma_recv_isr(&uart->serial, UART_RX_DMA_IT_TC_FLAG);
+    dma_recv_isr(&uart->serial);
 }
 
 /**
@@ -1114,7 +1334,7 @@ void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
     struct stm32_uart *uart;
     RT_ASSERT(huart != NULL);
     uart = (struct stm32_uart *)huart;
-    dma_recv_isr(&uart->serial, UART_RX_DMA_IT_HT_FLAG);
+    dma_recv_isr(&uart->serial);
 }
 
 /**
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __DRV_ETH_DMA_H__
+#define __DRV_ETH_DMA_H__
+
+#include <rtthread.h>
+#include <lwip/pbuf.h>
+
+/* size of the RX buffers, a multiple of 16 for the DMA and above the largest frame */
+#define ETH_DMA_RX_BUF_SIZE         1536
+
+/* the enhanced descriptor of the Ethernet DMA, the layout of ETH_DMADescTypeDef */
+struct eth_dma_desc
+{
+    volatile rt_uint32_t status;
+    volatile rt_uint32_t control;
+    volatile rt_ubase_t buf1;
+    volatile rt_ubase_t next;
+    volatile rt_uint32_t ext_status;
+    rt_uint32_t reserved;
+    rt_uint32_t time_low;
+    rt_uint32_t time_high;
+};
+
+/* TDES0 */
+#define ETH_DMA_TX_OWN              0x80000000U
+#define ETH_DMA_TX_IC               0x40000000U     /* interrupt on completion */
+#define ETH_DMA_TX_LS               0x20000000U
+#define ETH_DMA_TX_FS               0x10000000U
+#define ETH_DMA_TX_CIC_FULL         0x00C00000U     /* IP and TCP/UDP/ICMP checksum insertion */
+#define ETH_DMA_TX_TCH              0x00100000U
+#define ETH_DMA_TX_ES               0x00008000U
+/* TDES1 */
+#define ETH_DMA_TX_TBS1             0x00001FFFU
+
+/* RDES0 */
+#define ETH_DMA_RX_OWN              0x80000000U
+#define ETH_DMA_RX_FL               0x3FFF0000U
+#define ETH_DMA_RX_FL_SHIFT         16
+#define ETH_DMA_RX_ES               0x00008000U
+#define ETH_DMA_RX_FS               0x00000200U
+#define ETH_DMA_RX_LS               0x00000100U
+/* RDES1 */
+#define ETH_DMA_RX_RCH              0x00004000U
+#define ETH_DMA_RX_RBS1             0x00001FFFU
+
+/* the frame length of the RX descriptors includes the CRC */
+#define ETH_DMA_CRC_SIZE            4
+
+struct eth_dma;
+
+struct eth_dma_ops
+{
+    /* resume the suspended TX or RX DMA after descriptors were given to it */
+    void (*tx_poll)(struct eth_dma *dma);
+    void (*rx_poll)(struct eth_dma *dma);
+    /* whether the DMA can read a buffer, RT_NULL if it can read everything */
+    rt_bool_t (*tx_capable)(struct eth_dma *dma, const void *buf, rt_size_t len);
+};
+
+struct eth_dma_stat
+{
+    rt_uint32_t rx_frames;
+    rt_uint32_t rx_copies;              /* frames copied for rx_copy_break */
+    rt_uint32_t rx_errors;              /* frames dropped for errors of the MAC */
+    rt_uint32_t rx_drops;               /* frames dropped for lack of pbufs */
+    rt_uint32_t rx_starved;             /* descriptors left without a buffer */
+    rt_uint32_t tx_frames;
+    rt_uint32_t tx_copies;              /* frames copied into one pbuf */
+    rt_uint32_t tx_waits;               /* frames waiting for free descriptors */
+    rt_uint32_t tx_errors;
+};
+
+struct eth_dma_rx_buf
+{
+    struct pbuf_custom pc;
+    struct eth_dma *dma;
+    struct eth_dma_rx_buf *next;
+    rt_uint8_t *mem;
+};
+
+/*
+ * Descriptor rings of an Ethernet DMA in the chained mode without copies.
+ *
+ * The RX descriptors point at buffers of a pool of custom pbufs. A received
+ * frame is handed to lwIP in the buffers it was written to, the descriptors
+ * get other buffers of the pool, and a buffer goes back to the pool and to
+ * the empty descriptors when lwIP frees its pbuf. The pool is larger than the
+ * ring, so the stack can hold some frames without stopping the reception.
+ *
+ * A transmitted frame takes one descriptor per pbuf of its chain and points
+ * it at the payload. The chain is referenced until the DMA has sent it, the
+ * completed descriptors are reclaimed by eth_dma_tx() and eth_dma_rx() after
+ * the interrupt of the DMA. A chain with a PBUF_REF pbuf, whose data the
+ * caller may change after the output returns, is sent from a copy, and so
+ * are the TCP segments of lwIP before 2.1.0, which are retransmitted in place.
+ *
+ * Frames up to `rx_copy_break` and `tx_copy_break` bytes are copied, which
+ * returns the RX buffer at once and saves descriptors for short chains. Set
+ * them and `tx_flags` after eth_dma_init().
+ */
+struct eth_dma
+{
+    const struct eth_dma_ops *ops;
+    void *user_data;
+
+    struct eth_dma_desc *rx_desc;
+    struct eth_dma_rx_buf **rx_ring;    /* buffers of the descriptors */
+    struct eth_dma_rx_buf *rx_bufs;
+    struct eth_dma_rx_buf *rx_free;
+    rt_uint8_t *rx_mem;
+    struct pbuf *rx_head;               /* frame of several descriptors */
+    rt_uint16_t rx_num;
+    rt_uint16_t rx_buf_num;
+    rt_uint16_t rx_cur;                 /* next descriptor of the DMA */
+    rt_uint16_t rx_fill;                /* next descriptor without a buffer */
+    rt_uint16_t rx_filled;
+    rt_uint16_t rx_copy_break;
+
+    struct eth_dma_desc *tx_desc;
+    struct pbuf **tx_pbuf;              /* frames of the last descriptors */
+    rt_uint16_t tx_num;
+    rt_uint16_t tx_head;                /* next free descriptor */
+    rt_uint16_t tx_tail;                /* oldest descriptor of the DMA */
+    rt_uint16_t tx_used;
+    rt_uint16_t tx_copy_break;
+    rt_uint32_t tx_flags;               /* TDES0 bits of all frames, e.g. the checksum insertion */
+    rt_bool_t tx_waiting;
+    struct rt_mutex tx_lock;
+    struct rt_semaphore tx_sem;
+
+    struct eth_dma_stat stat;
+};
+
+/**
+ * allocate the rings and the RX pool, and give all descriptors to the DMA
+ *
+ * @param dma rings
+ * @param ops operations of the DMA
+ * @param rx_num RX descriptors
+ * @param rx_buf_num RX buffers, at least rx_num
+ * @param tx_num TX descriptors
+ *
+ * @return RT_EOK on success, -RT_ENOMEM on failure
+ */
+rt_err_t eth_dma_init(struct eth_dma *dma, const struct eth_dma_ops *ops,
+                      rt_uint16_t rx_num, rt_uint16_t rx_buf_num, rt_uint16_t tx_num);
+
+/**
+ * free the rings, the DMA must be stopped and all RX pbufs freed
+ */
+void eth_dma_deinit(struct eth_dma *dma);
+
+/**
+ * reclaim the sent frames and take the next received frame
+ *
+ * @return the frame, RT_NULL if there is none
+ */
+struct pbuf *eth_dma_rx(struct eth_dma *dma);
+
+/**
+ * queue a frame to the DMA, waiting up to `timeout` ticks for descriptors
+ *
+ * @return RT_EOK on success, -RT_ENOMEM or -RT_ETIMEOUT on failure
+ */
+rt_err_t eth_dma_tx(struct eth_dma *dma, struct pbuf *p, rt_int32_t timeout);
+
+/**
+ * reclaim the descriptors of the sent frames and free them
+ */
+void eth_dma_tx_reclaim(struct eth_dma *dma);
+
+/**
+ * the TX interrupt of the DMA, wakes a frame waiting for descriptors
+ */
+void eth_dma_tx_isr(struct eth_dma *dma);
+
+void eth_dma_get_stat(struct eth_dma *dma, struct eth_dma_stat *stat);
+
+#endif /* __DRV_ETH_DMA_H__ */
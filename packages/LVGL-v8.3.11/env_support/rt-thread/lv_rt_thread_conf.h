@@ -61,6 +61,11 @@
 #define lv_vsnprintf rt_vsnprintf
 #define LV_SPRINTF_USE_FLOAT 0
 
+#define LV_IMG_ASYNC_USE_RTTHREAD 1
+#ifdef PKG_LVGL_THREAD_PRIO
+#  define LV_IMG_ASYNC_THREAD_PRIO (PKG_LVGL_THREAD_PRIO + 1) /*Decode images when the LVGL thread is idle*/
+#endif
+
 /*=====================
  *  COMPILER SETTINGS
  *====================*/
@@ -157,6 +157,15 @@
  *0 mean no caching.*/
 #define LV_GRAD_CACHE_DEF_SIZE 0
 
+/*1: use custom allocator for the gradient cache items, e.g. to place them into an external RAM.
+ *0: use `lv_mem_alloc()` and `lv_mem_free()`*/
+#define LV_GRAD_CACHE_CUSTOM 0
+#if LV_GRAD_CACHE_CUSTOM
+    #define LV_GRAD_CACHE_CUSTOM_INCLUDE <stdlib.h>   /*Header for the allocator functions*/
+    #define LV_GRAD_CACHE_CUSTOM_ALLOC   malloc
+    #define LV_GRAD_CACHE_CUSTOM_FREE    free
+#endif
+
 /*Allow dithering the gradients (to achieve visual smooth color gradients on limited color depth display)
  *LV_DITHER_GRADIENT implies allocating one or two more lines of the object's rendering surface
  *The increase in memory consumption is (32 bits * object width) plus 24 bits * object width if using error diffusion */
@@ -608,6 +617,10 @@
 
 /*File system interfaces for common APIs */
 
+/*Number of blocks cached per file by the drivers below with a cache size > 0.
+ *The cache size is the size of a block. Files opened for reading share the cache.*/
+#define LV_FS_CACHE_BLOCK_CNT 1
+
 /*API for fopen, fread, etc*/
 #define LV_USE_FS_STDIO 0
 #if LV_USE_FS_STDIO
@@ -737,6 +750,21 @@
     #endif // LV_IME_PINYIN_USE_K9_MODE
 #endif
 
+/*1: Decode images of the PNG, SJPG, BMP, etc. decoders in a background thread.
+ *A placeholder is drawn until the image is ready, then the widgets showing it are redrawn.
+ *Requires: LV_IMG_CACHE_DEF_SIZE > 0 and a thread-safe `lv_mem_alloc` (LV_MEM_CUSTOM 1)*/
+#define LV_USE_IMG_ASYNC 0
+#if LV_USE_IMG_ASYNC
+    /*1: Create the worker with RT-Thread; 0: with pthread*/
+    #define LV_IMG_ASYNC_USE_RTTHREAD 0
+    /*Stack size and priority of the worker thread (RT-Thread only). It should have lower priority than the LVGL thread*/
+    #define LV_IMG_ASYNC_STACK_SIZE (8 * 1024)
+    #define LV_IMG_ASYNC_THREAD_PRIO 22
+    /*Color and opacity of the placeholder (the opacity is used if the image has alpha channel)*/
+    #define LV_IMG_ASYNC_PLACEHOLDER_COLOR lv_color_hex(0xd0d0d0)
+    #define LV_IMG_ASYNC_PLACEHOLDER_OPA LV_OPA_50
+#endif
+
 /*==================
 * EXAMPLES
 *==================*/
@@ -24,6 +24,7 @@
 
 typedef struct {
     lv_fs_file_t f;
+    const uint8_t * data;   /*The image data (after the header) if the file is memory mapped*/
     lv_color_t * palette;
     lv_opa_t * opa;
 } lv_img_decoder_built_in_data_t;
@@ -351,6 +352,14 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
 
         lv_img_decoder_built_in_data_t * user_data = dsc->user_data;
         lv_memcpy_small(&user_data->f, &f, sizeof(f));
+
+        /*If the file is in memory use the image in place*/
+        uint32_t size = 0;
+        const uint8_t * data = lv_fs_map(&f, &size);
+        uint32_t data_size = lv_img_buf_get_img_size(dsc->header.w, dsc->header.h, dsc->header.cf);
+        if(data && size >= sizeof(lv_img_header_t) && size - sizeof(lv_img_header_t) >= data_size) {
+            user_data->data = data + sizeof(lv_img_header_t);
+        }
     }
     else if(dsc->src_type == LV_IMG_SRC_VARIABLE) {
         /*The variables should have valid data*/
@@ -368,6 +377,11 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
             dsc->img_data = ((lv_img_dsc_t *)dsc->src)->data;
             return LV_RES_OK;
         }
+        else if(((lv_img_decoder_built_in_data_t *)dsc->user_data)->data) {
+            /*The file is in memory, give a pointer to it*/
+            dsc->img_data = ((lv_img_decoder_built_in_data_t *)dsc->user_data)->data;
+            return LV_RES_OK;
+        }
         else {
             /*If it's a file, read all to memory*/
             uint32_t len = dsc->header.w * dsc->header.h;
@@ -395,6 +409,11 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
             dsc->img_data = ((lv_img_dsc_t *)dsc->src)->data;
             return LV_RES_OK;
         }
+        else if(((lv_img_decoder_built_in_data_t *)dsc->user_data)->data) {
+            /*The file is in memory, give a pointer to it*/
+            dsc->img_data = ((lv_img_decoder_built_in_data_t *)dsc->user_data)->data;
+            return LV_RES_OK;
+        }
         else {
             /*If it's a file it need to be read line by line later*/
             return LV_RES_OK;
@@ -428,7 +447,7 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
             return LV_RES_INV;
         }
 
-        if(dsc->src_type == LV_IMG_SRC_FILE) {
+        if(dsc->src_type == LV_IMG_SRC_FILE && user_data->data == NULL) {
             /*Read the palette from file*/
             lv_fs_seek(&user_data->f, 4, LV_FS_SEEK_SET); /*Skip the header*/
             lv_color32_t cur_color;
@@ -441,7 +460,8 @@ lv_res_t lv_img_decoder_built_in_open(lv_img_decoder_t * decoder, lv_img_decoder
         }
         else {
             /*The palette begins in the beginning of the image data. Just point to it.*/
-            lv_color32_t * palette_p = (lv_color32_t *)((lv_img_dsc_t *)dsc->src)->data;
+            const uint8_t * data = dsc->src_type == LV_IMG_SRC_FILE ? user_data->data : ((lv_img_dsc_t *)dsc->src)->data;
+            lv_color32_t * palette_p = (lv_color32_t *)data;
 
             uint32_t i;
             for(i = 0; i < palette_size; i++) {
@@ -628,6 +648,9 @@ static lv_res_t lv_img_decoder_built_in_line_alpha(lv_img_decoder_dsc_t * dsc, l
 
         data_tmp = img_dsc->data + ofs;
     }
+    else if(user_data->data) {
+        data_tmp = user_data->data + ofs;
+    }
     else {
         lv_fs_seek(&user_data->f, ofs + 4, LV_FS_SEEK_SET); /*+4 to skip the header*/
         lv_fs_read(&user_data->f, fs_buf, w, NULL);
@@ -695,6 +718,9 @@ static lv_res_t lv_img_decoder_built_in_line_indexed(lv_img_decoder_dsc_t * dsc,
         const lv_img_dsc_t * img_dsc = dsc->src;
         data_tmp                     = img_dsc->data + ofs;
     }
+    else if(user_data->data) {
+        data_tmp = user_data->data + ofs;
+    }
     else {
         lv_fs_seek(&user_data->f, ofs + 4, LV_FS_SEEK_SET); /*+4 to skip the header*/
         lv_fs_read(&user_data->f, fs_buf, w, NULL);
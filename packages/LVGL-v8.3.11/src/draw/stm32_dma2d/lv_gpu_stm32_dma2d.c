@@ -23,6 +23,10 @@
 
 #define CACHE_ROW_SIZE 32U // cache row size in Bytes
 
+#ifndef STAGING_BUF_PX
+    #define STAGING_BUF_PX 2048U // max. pixels of the ARGB8888 buffer used to merge a map with its mask
+#endif
+
 // For code/implementation discussion refer to https://github.com/lvgl/lvgl/issues/3714#issuecomment-1365187036
 // astyle --options=lvgl/scripts/code-format.cfg --ignore-exclude-errors lvgl/src/draw/stm32_dma2d/*.c lvgl/src/draw/stm32_dma2d/*.h
 
@@ -70,6 +74,9 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_map(const lv_color_t * des
 LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_paint(const lv_color_t * dst_buf, lv_coord_t dst_stride,
                                                             const lv_area_t * draw_area, const lv_opa_t * mask_buf, lv_coord_t mask_stride, const lv_point_t * mask_offset,
                                                             lv_color_t color, lv_opa_t opa);
+LV_STM32_DMA2D_STATIC lv_res_t _lv_draw_stm32_dma2d_blend_map_masked(const lv_color_t * dest_buf, lv_coord_t dest_stride,
+                                                                     const lv_area_t * draw_area, const lv_color_t * src_buf, lv_coord_t src_stride, const lv_point_t * src_offset,
+                                                                     const lv_opa_t * mask_buf, lv_coord_t mask_stride, const lv_point_t * mask_offset, lv_opa_t opa);
 LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_copy_buffer(const lv_color_t * dest_buf, lv_coord_t dest_stride,
                                                             const lv_area_t * draw_area, const lv_color_t * src_buf, lv_coord_t src_stride, const lv_point_t * src_offset);
 LV_STM32_DMA2D_STATIC void _lv_gpu_stm32_dma2d_await_dma_transfer_finish(lv_disp_drv_t * disp_drv);
@@ -99,13 +106,13 @@ void lv_draw_stm32_dma2d_init(void)
 #if defined(STM32F4) || defined(STM32F7) || defined(STM32U5)
     RCC->AHB1ENR |= RCC_AHB1ENR_DMA2DEN; // enable DMA2D
     // wait for hardware access to complete
-    __asm volatile("DSB\n");
+    __DSB();
     volatile uint32_t temp = RCC->AHB1ENR;
     LV_UNUSED(temp);
 #elif defined(STM32H7)
     RCC->AHB3ENR |= RCC_AHB3ENR_DMA2DEN;
     // wait for hardware access to complete
-    __asm volatile("DSB\n");
+    __DSB();
     volatile uint32_t temp = RCC->AHB3ENR;
     LV_UNUSED(temp);
 #else
@@ -127,8 +134,9 @@ void lv_draw_stm32_dma2d_ctx_init(lv_disp_drv_t * drv, lv_draw_ctx_t * draw_ctx)
     dma2d_draw_ctx->blend = lv_draw_stm32_dma2d_blend;
     dma2d_draw_ctx->base_draw.draw_img_decoded = lv_draw_stm32_dma2d_img_decoded;
     //dma2d_draw_ctx->base_draw.draw_img = lv_draw_stm32_dma2d_img;
-    // Note: currently it does not make sense use lv_gpu_stm32_dma2d_wait_cb() since waiting starts right after the dma2d transfer
-    //dma2d_draw_ctx->base_draw.wait_for_finish = lv_gpu_stm32_dma2d_wait_cb;
+    // Fills are not awaited when started, so the CPU can prepare the next primitive (masks, glyphs, decoding)
+    // while DMA2D writes the draw buffer. LVGL calls wait_for_finish before it touches the buffer again.
+    dma2d_draw_ctx->base_draw.wait_for_finish = lv_gpu_stm32_dma2d_wait_cb;
     dma2d_draw_ctx->base_draw.buffer_copy = lv_draw_stm32_dma2d_buffer_copy;
 }
 
@@ -141,6 +149,7 @@ void lv_draw_stm32_dma2d_ctx_deinit(lv_disp_drv_t * drv, lv_draw_ctx_t * draw_ct
 static void lv_draw_stm32_dma2d_blend(lv_draw_ctx_t * draw_ctx, const lv_draw_sw_blend_dsc_t * dsc)
 {
     if(dsc->blend_mode != LV_BLEND_MODE_NORMAL) {
+        _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL);
         lv_draw_sw_blend_basic(draw_ctx, dsc);
         return;
     }
@@ -188,45 +197,17 @@ static void lv_draw_stm32_dma2d_blend(lv_draw_ctx_t * draw_ctx, const lv_draw_sw
         }
         else {   // 0.2%
             // note: (x)RGB dsc->src_buf does not carry alpha channel bytes,
-            // alpha channel bytes are carried in dsc->mask_buf
-#if LV_COLOR_DEPTH == 32
+            // alpha channel bytes are carried in dsc->mask_buf (e.g. Shop Items)
             lv_coord_t src_stride = lv_area_get_width(dsc->blend_area);
             lv_point_t src_offset = lv_area_get_offset(dsc->blend_area, &draw_area); // source image offset in relation to draw_area
-            lv_coord_t draw_width = lv_area_get_width(&draw_area);
-            lv_coord_t draw_height = lv_area_get_height(&draw_area);
-
-            // merge mask alpha bytes with src RGB bytes
-            // TODO: optimize by reading 4 or 8 mask bytes at a time
-            mask += (mask_stride * mask_offset.y) + mask_offset.x;
-            lv_color_t * src_buf = (lv_color_t *)dsc->src_buf;
-            src_buf += (src_stride * src_offset.y) + src_offset.x;
-            uint16_t mask_buffer_offset = mask_stride - draw_width;
-            uint16_t src_buffer_offset = src_stride - draw_width;
-            while(draw_height > 0) {
-                draw_height--;
-                for(uint16_t x = 0; x < draw_width; x++) {
-                    (*src_buf).ch.alpha = *mask;
-                    src_buf++;
-                    mask++;
-                }
-                mask += mask_buffer_offset;
-                src_buf += src_buffer_offset;
-            }
-
             lv_area_move(&draw_area, -draw_ctx->buf_area->x1,
                          -draw_ctx->buf_area->y1); // translate the screen draw area to the origin of the buffer area
-            _lv_draw_stm32_dma2d_blend_map(draw_ctx->buf, dest_stride, &draw_area, dsc->src_buf, src_stride, &src_offset, dsc->opa,
-                                           ARGB8888, false);
-#else
-            // Note: 16-bit bitmap hardware blending with mask and background is possible, but requires a temp 24 or 32-bit buffer to combine bitmap with mask first.
-
-            lv_draw_sw_blend_basic(draw_ctx, dsc); // (e.g. Shop Items)
-            // clean cache after software drawing - this does not help since this is not the only place where buffer is written without dma2d
-            // lv_coord_t draw_width = lv_area_get_width(&draw_area);
-            // lv_coord_t draw_height = lv_area_get_height(&draw_area);
-            // uint32_t dest_address = (uint32_t)(draw_ctx->buf + (dest_stride * draw_area.y1) + draw_area.x1);
-            // __lv_gpu_stm32_dma2d_clean_cache(dest_address, dest_stride - draw_width, draw_width, draw_height, sizeof(lv_color_t));
-#endif
+            if(_lv_draw_stm32_dma2d_blend_map_masked(draw_ctx->buf, dest_stride, &draw_area, dsc->src_buf, src_stride, &src_offset,
+                                                     mask, mask_stride, &mask_offset, dsc->opa) != LV_RES_OK) {
+                // no memory for the staging buffer, let the CPU blend it
+                _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL);
+                lv_draw_sw_blend_basic(draw_ctx, dsc);
+            }
         }
     }
     else {
@@ -298,7 +279,7 @@ static void lv_draw_stm32_dma2d_img_decoded(lv_draw_ctx_t * draw_ctx, const lv_d
 
 static lv_point_t lv_area_get_offset(const lv_area_t * area1, const lv_area_t * area2)
 {
-    lv_point_t offset = {x: area2->x1 - area1->x1, y: area2->y1 - area1->y1};
+    lv_point_t offset = {.x = area2->x1 - area1->x1, .y = area2->y1 - area1->y1};
     return offset;
 }
 
@@ -371,7 +352,7 @@ LV_STM32_DMA2D_STATIC lv_res_t lv_draw_stm32_dma2d_img(lv_draw_ctx_t * draw_ctx,
 LV_STM32_DMA2D_STATIC void lv_gpu_stm32_dma2d_wait_cb(lv_draw_ctx_t * draw_ctx)
 {
     lv_disp_t * disp = _lv_refr_get_disp_refreshing();
-    _lv_gpu_stm32_dma2d_await_dma_transfer_finish(disp->driver);
+    _lv_gpu_stm32_dma2d_await_dma_transfer_finish(disp ? disp->driver : NULL);
     lv_draw_sw_wait_for_finish(draw_ctx);
 }
 
@@ -386,7 +367,6 @@ LV_STM32_DMA2D_STATIC void lv_gpu_stm32_dma2d_wait_cb(lv_draw_ctx_t * draw_ctx)
 LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_fill(const lv_color_t * dest_buf, lv_coord_t dest_stride,
                                                            const lv_area_t * draw_area, lv_color_t color, lv_opa_t opa)
 {
-    LV_ASSERT_MSG(!isDma2dInProgess, "dma2d transfer has not finished"); // critical
     lv_coord_t draw_width = lv_area_get_width(draw_area);
     lv_coord_t draw_height = lv_area_get_height(draw_area);
 
@@ -399,7 +379,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_fill(const lv_color_t * de
 #if defined(DMA2D_OPFCCR_RBS_Pos)
         DMA2D->OPFCCR |= (RBS_BIT << DMA2D_OPFCCR_RBS_Pos);
 #endif
-        DMA2D->OMAR = (uint32_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
+        DMA2D->OMAR = (lv_uintptr_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
         DMA2D->OOR = dest_stride - draw_width;  // out buffer offset
         // Note: unlike FGCOLR and BGCOLR, OCOLR bits must match DMA2D_OUTPUT_COLOR, alpha can be specified
 #if RBS_BIT
@@ -420,7 +400,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_fill(const lv_color_t * de
 
         // Note: in Alpha Mode 1 FGMAR and FGOR are not used to supply foreground A8 bytes,
         // those bytes are replaced by constant ALPHA defined in FGPFCCR
-        DMA2D->FGMAR = (uint32_t)dest_buf;
+        DMA2D->FGMAR = (lv_uintptr_t)dest_buf;
         DMA2D->FGOR = dest_stride;
         DMA2D->FGCOLR = lv_color_to32(color) & 0x00ffffff; // swap FGCOLR R/B bits if FGPFCCR.RBS (RBS_BIT) bit is set
 
@@ -428,7 +408,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_fill(const lv_color_t * de
 #if defined(DMA2D_BGPFCCR_RBS_Pos)
         DMA2D->BGPFCCR |= (RBS_BIT << DMA2D_BGPFCCR_RBS_Pos);
 #endif
-        DMA2D->BGMAR = (uint32_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
+        DMA2D->BGMAR = (lv_uintptr_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
         DMA2D->BGOR = dest_stride - draw_width;
         DMA2D->BGCOLR = 0;  // used in A4 and A8 modes only
         __lv_gpu_stm32_dma2d_clean_cache(DMA2D->BGMAR, DMA2D->BGOR, draw_width, draw_height, sizeof(lv_color_t));
@@ -458,7 +438,6 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_map(const lv_color_t * des
                                                           const lv_area_t * draw_area, const void * src_buf, lv_coord_t src_stride, const lv_point_t * src_offset, lv_opa_t opa,
                                                           dma2d_color_format_t src_color_format, bool ignore_src_alpha)
 {
-    LV_ASSERT_MSG(!isDma2dInProgess, "dma2d transfer has not finished"); // critical
     if(opa <= LV_OPA_MIN || src_color_format == UNSUPPORTED) return;
     lv_coord_t draw_width = lv_area_get_width(draw_area);
     lv_coord_t draw_height = lv_area_get_height(draw_area);
@@ -516,7 +495,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_map(const lv_color_t * des
 #if defined(DMA2D_FGPFCCR_RBS_Pos)
     DMA2D->FGPFCCR |= (RBS_BIT << DMA2D_FGPFCCR_RBS_Pos);
 #endif
-    DMA2D->FGMAR = ((uint32_t)src_buf) + srcBpp * ((src_stride * src_offset->y) + src_offset->x);
+    DMA2D->FGMAR = ((lv_uintptr_t)src_buf) + srcBpp * ((src_stride * src_offset->y) + src_offset->x);
     DMA2D->FGOR = src_stride - draw_width;
     DMA2D->FGCOLR = 0;  // used in A4 and A8 modes only
     __lv_gpu_stm32_dma2d_clean_cache(DMA2D->FGMAR, DMA2D->FGOR, draw_width, draw_height, srcBpp);
@@ -525,7 +504,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_map(const lv_color_t * des
 #if defined(DMA2D_OPFCCR_RBS_Pos)
     DMA2D->OPFCCR |= (RBS_BIT << DMA2D_OPFCCR_RBS_Pos);
 #endif
-    DMA2D->OMAR = (uint32_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
+    DMA2D->OMAR = (lv_uintptr_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
     DMA2D->OOR = dest_stride - draw_width;
     DMA2D->OCOLR = 0;
 
@@ -545,6 +524,8 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_map(const lv_color_t * des
     DMA2D->NLR = (draw_width << DMA2D_NLR_PL_Pos) | (draw_height << DMA2D_NLR_NL_Pos);
 
     _lv_gpu_stm32_dma2d_start_dma_transfer();
+    // src_buf may be a temporary buffer (e.g. transformed image line) which is reused right after returning
+    _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL);
 }
 
 /**
@@ -557,7 +538,6 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_paint(const lv_color_t * d
                                                             const lv_area_t * draw_area, const lv_opa_t * mask_buf, lv_coord_t mask_stride, const lv_point_t * mask_offset,
                                                             lv_color_t color, lv_opa_t opa)
 {
-    LV_ASSERT_MSG(!isDma2dInProgess, "dma2d transfer has not finished"); // critical
     lv_coord_t draw_width = lv_area_get_width(draw_area);
     lv_coord_t draw_height = lv_area_get_height(draw_area);
 
@@ -572,7 +552,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_paint(const lv_color_t * d
                            DMA2D_FGPFCCR_AM_Pos); // Alpha Mode: Replace original foreground image alpha channel value by FGPFCCR.ALPHA multiplied with original alpha channel value
     }
     //DMA2D->FGPFCCR |= (RBS_BIT << DMA2D_FGPFCCR_RBS_Pos);
-    DMA2D->FGMAR = (uint32_t)(mask_buf + (mask_stride * mask_offset->y) + mask_offset->x);
+    DMA2D->FGMAR = (lv_uintptr_t)(mask_buf + (mask_stride * mask_offset->y) + mask_offset->x);
     DMA2D->FGOR = mask_stride - draw_width;
     DMA2D->FGCOLR = lv_color_to32(color) & 0x00ffffff;  // swap FGCOLR R/B bits if FGPFCCR.RBS (RBS_BIT) bit is set
     __lv_gpu_stm32_dma2d_clean_cache(DMA2D->FGMAR, DMA2D->FGOR, draw_width, draw_height, sizeof(lv_opa_t));
@@ -581,7 +561,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_paint(const lv_color_t * d
 #if defined(DMA2D_BGPFCCR_RBS_Pos)
     DMA2D->BGPFCCR |= (RBS_BIT << DMA2D_BGPFCCR_RBS_Pos);
 #endif
-    DMA2D->BGMAR = (uint32_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
+    DMA2D->BGMAR = (lv_uintptr_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
     DMA2D->BGOR = dest_stride - draw_width;
     DMA2D->BGCOLR = 0;  // used in A4 and A8 modes only
     __lv_gpu_stm32_dma2d_clean_cache(DMA2D->BGMAR, DMA2D->BGOR, draw_width, draw_height, sizeof(lv_color_t));
@@ -597,6 +577,67 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_paint(const lv_color_t * d
     DMA2D->NLR = (draw_width << DMA2D_NLR_PL_Pos) | (draw_height << DMA2D_NLR_NL_Pos);
 
     _lv_gpu_stm32_dma2d_start_dma_transfer();
+    // the mask buffer is refilled by the caller (e.g. next glyph or next mask line) right after returning
+    _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL);
+}
+
+/**
+ * @brief Blends src map with a separate alpha mask (e.g. TRUE_COLOR_ALPHA and RGB565A8 images split by draw_sw).
+ * DMA2D has no way to fetch color and alpha from two planes, so they are merged into an ARGB8888 staging buffer
+ * band by band. The alpha is calculated exactly like lv_draw_sw_blend_basic() does it.
+ * @param src_offset src offset in relation to dst
+ * @param mask_offset mask offset in relation to dst
+ * @param opa constant opacity to be applied
+ * @return LV_RES_INV if the staging buffer can't be allocated, nothing is drawn then
+ */
+LV_STM32_DMA2D_STATIC lv_res_t _lv_draw_stm32_dma2d_blend_map_masked(const lv_color_t * dest_buf, lv_coord_t dest_stride,
+                                                                     const lv_area_t * draw_area, const lv_color_t * src_buf, lv_coord_t src_stride, const lv_point_t * src_offset,
+                                                                     const lv_opa_t * mask_buf, lv_coord_t mask_stride, const lv_point_t * mask_offset, lv_opa_t opa)
+{
+    if(opa <= LV_OPA_MIN) return LV_RES_OK;
+    lv_coord_t draw_width = lv_area_get_width(draw_area);
+    lv_coord_t draw_height = lv_area_get_height(draw_area);
+    lv_coord_t band_height = LV_MAX(STAGING_BUF_PX / draw_width, 1);
+    if(band_height > draw_height) band_height = draw_height;
+
+    uint32_t * stage_buf = lv_mem_buf_get(draw_width * band_height * sizeof(uint32_t));
+    if(stage_buf == NULL) {
+        LV_LOG_WARN("no memory for the staging buffer");
+        return LV_RES_INV;
+    }
+
+    src_buf += (src_stride * src_offset->y) + src_offset->x;
+    mask_buf += (mask_stride * mask_offset->y) + mask_offset->x;
+    lv_area_t band_area = *draw_area;
+    lv_point_t stage_offset = {.x = 0, .y = 0};
+
+    while(band_area.y1 <= draw_area->y2) {
+        band_area.y2 = LV_MIN(band_area.y1 + band_height - 1, draw_area->y2);
+        lv_coord_t h = lv_area_get_height(&band_area);
+
+        // the previous band is still being read by DMA2D
+        _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL);
+
+        uint32_t * stage_px = stage_buf;
+        lv_coord_t x, y;
+        for(y = 0; y < h; y++) {
+            for(x = 0; x < draw_width; x++) {
+                lv_opa_t a = mask_buf[x];
+                if(opa <= LV_OPA_MAX) a = a >= LV_OPA_MAX ? opa : (lv_opa_t)(((uint32_t)opa * a) >> 8);
+                stage_px[x] = (lv_color_to32(src_buf[x]) & 0x00ffffff) | ((uint32_t)a << 24);
+            }
+            stage_px += draw_width;
+            src_buf += src_stride;
+            mask_buf += mask_stride;
+        }
+
+        _lv_draw_stm32_dma2d_blend_map(dest_buf, dest_stride, &band_area, stage_buf, draw_width, &stage_offset, LV_OPA_COVER,
+                                       ARGB8888, false);
+        band_area.y1 = band_area.y2 + 1;
+    }
+
+    lv_mem_buf_release(stage_buf);
+    return LV_RES_OK;
 }
 
 /**
@@ -606,7 +647,6 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_blend_paint(const lv_color_t * d
 LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_copy_buffer(const lv_color_t * dest_buf, lv_coord_t dest_stride,
                                                             const lv_area_t * draw_area, const lv_color_t * src_buf, lv_coord_t src_stride, const lv_point_t * src_offset)
 {
-    LV_ASSERT_MSG(!isDma2dInProgess, "dma2d transfer has not finished"); // critical
     lv_coord_t draw_width = lv_area_get_width(draw_area);
     lv_coord_t draw_height = lv_area_get_height(draw_area);
 
@@ -618,7 +658,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_copy_buffer(const lv_color_t * d
 #if defined(DMA2D_FGPFCCR_RBS_Pos)
     DMA2D->FGPFCCR |= (RBS_BIT << DMA2D_FGPFCCR_RBS_Pos);
 #endif
-    DMA2D->FGMAR = (uint32_t)(src_buf + (src_stride * src_offset->y) + src_offset->x);
+    DMA2D->FGMAR = (lv_uintptr_t)(src_buf + (src_stride * src_offset->y) + src_offset->x);
     DMA2D->FGOR = src_stride - draw_width;
     DMA2D->FGCOLR = 0;  // used in A4 and A8 modes only
     __lv_gpu_stm32_dma2d_clean_cache(DMA2D->FGMAR, DMA2D->FGOR, draw_width, draw_height, sizeof(lv_color_t));
@@ -629,7 +669,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_copy_buffer(const lv_color_t * d
 #if defined(DMA2D_OPFCCR_RBS_Pos)
     DMA2D->OPFCCR |= (RBS_BIT << DMA2D_OPFCCR_RBS_Pos);
 #endif
-    DMA2D->OMAR = (uint32_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
+    DMA2D->OMAR = (lv_uintptr_t)(dest_buf + (dest_stride * draw_area->y1) + draw_area->x1);
     DMA2D->OOR = dest_stride - draw_width;
     DMA2D->OCOLR = 0;
 
@@ -637,6 +677,7 @@ LV_STM32_DMA2D_STATIC void _lv_draw_stm32_dma2d_copy_buffer(const lv_color_t * d
     DMA2D->NLR = (draw_width << DMA2D_NLR_PL_Pos) | (draw_height << DMA2D_NLR_NL_Pos);
 
     _lv_gpu_stm32_dma2d_start_dma_transfer();
+    _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL);
 }
 
 LV_STM32_DMA2D_STATIC void _lv_gpu_stm32_dma2d_start_dma_transfer(void)
@@ -650,8 +691,9 @@ LV_STM32_DMA2D_STATIC void _lv_gpu_stm32_dma2d_start_dma_transfer(void)
                                      (DMA2D->NLR & DMA2D_NLR_NL_Msk) >> DMA2D_NLR_NL_Pos, sizeof(lv_color_t));
 #endif
     DMA2D->CR |= DMA2D_CR_START;
-    // Note: for some reason mask buffer gets damaged during transfer if waiting is postponed
-    _lv_gpu_stm32_dma2d_await_dma_transfer_finish(NULL); // FIXME: this line should not be needed here, but it is
+    // Note: the transfer is not awaited here, the next draw awaits it before setting up the registers.
+    // Transfers reading a caller owned buffer (mask, source map) wait right after starting since that
+    // buffer is reused as soon as they return.
 }
 
 LV_STM32_DMA2D_STATIC void _lv_gpu_stm32_dma2d_await_dma_transfer_finish(lv_disp_drv_t * disp_drv)
@@ -10,10 +10,17 @@
 #include "../../misc/lv_math.h"
 #include "../../hal/lv_hal_disp.h"
 #include "../../core/lv_refr.h"
+#include "lv_draw_sw_blend_rgb565.h"
 
 /*********************
  *      DEFINES
  *********************/
+/*The RGB565 kernels work on the native, unswapped pixel format and replicate the rounding of `lv_color_mix()`*/
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP == 0 && LV_COLOR_MIX_ROUND_OFS == 0
+    #define BLEND_RGB565_KERNELS 1
+#else
+    #define BLEND_RGB565_KERNELS 0
+#endif
 
 /**********************
  *      TYPEDEFS
@@ -26,9 +33,9 @@
 static void fill_set_px(lv_color_t * dest_buf, const lv_area_t * blend_area, lv_coord_t dest_stride,
                         lv_color_t color, lv_opa_t opa, const lv_opa_t * mask, lv_coord_t mask_stide);
 
-static void /* LV_ATTRIBUTE_FAST_MEM */ fill_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
-                                                    lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa,
-                                                    const lv_opa_t * mask, lv_coord_t mask_stride);
+static void LV_ATTRIBUTE_FAST_MEM fill_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
+                                              lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa,
+                                              const lv_opa_t * mask, lv_coord_t mask_stride);
 
 
 #if LV_COLOR_SCREEN_TRANSP
@@ -46,10 +53,10 @@ static void map_set_px(lv_color_t * dest_buf, const lv_area_t * dest_area, lv_co
                        const lv_color_t * src_buf, lv_coord_t src_stride, lv_opa_t opa,
                        const lv_opa_t * mask, lv_coord_t mask_stride);
 
-static void /* LV_ATTRIBUTE_FAST_MEM */ map_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
-                                                   lv_coord_t dest_stride, const lv_color_t * src_buf,
-                                                   lv_coord_t src_stride, lv_opa_t opa, const lv_opa_t * mask,
-                                                   lv_coord_t mask_stride);
+static void LV_ATTRIBUTE_FAST_MEM map_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
+                                             lv_coord_t dest_stride, const lv_color_t * src_buf,
+                                             lv_coord_t src_stride, lv_opa_t opa, const lv_opa_t * mask,
+                                             lv_coord_t mask_stride);
 
 #if LV_COLOR_SCREEN_TRANSP
 static void /* LV_ATTRIBUTE_FAST_MEM */ map_argb(lv_color_t * dest_buf, const lv_area_t * dest_area,
@@ -244,7 +251,7 @@ static void fill_set_px(lv_color_t * dest_buf, const lv_area_t * blend_area, lv_
     }
 }
 
-static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
+static void LV_ATTRIBUTE_FAST_MEM fill_normal(lv_color_t * dest_buf, const lv_area_t * dest_area,
                                               lv_coord_t dest_stride, lv_color_t color, lv_opa_t opa,
                                               const lv_opa_t * mask, lv_coord_t mask_stride)
 {
@@ -257,10 +264,14 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
     /*No mask*/
     if(mask == NULL) {
         if(opa >= LV_OPA_MAX) {
+#if BLEND_RGB565_KERNELS
+            lv_draw_sw_rgb565_fill((uint16_t *)dest_buf, dest_stride, w, h, color.full);
+#else
             for(y = 0; y < h; y++) {
                 lv_color_fill(dest_buf, color, w);
                 dest_buf += dest_stride;
             }
+#endif
         }
         /*Has opacity*/
         else {
@@ -275,6 +286,13 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
             opa = opa << 3;
 #endif
 
+#if BLEND_RGB565_KERNELS
+            if(w * h >= LV_DRAW_SW_RGB565_FILL_OPA_MIN_PX) {
+                lv_draw_sw_rgb565_fill_opa((uint16_t *)dest_buf, dest_stride, w, h, color.full, opa);
+                return;
+            }
+#endif
+
             uint16_t color_premult[3];
             lv_color_premult(color, opa, color_premult);
             lv_opa_t opa_inv = 255 - opa;
@@ -298,6 +316,11 @@ static LV_ATTRIBUTE_FAST_MEM void fill_normal(lv_color_t * dest_buf, const lv_ar
 #endif
         /*Only the mask matters*/
         if(opa >= LV_OPA_MAX) {
+#if BLEND_RGB565_KERNELS
+            lv_draw_sw_rgb565_fill_mask((uint16_t *)dest_buf, dest_stride, w, h, color.full, mask, mask_stride);
+            LV_UNUSED(c32);
+            return;
+#endif
             int32_t x_end4 = w - 4;
             for(y = 0; y < h; y++) {
                 for(x = 0; x < w && ((lv_uintptr_t)(mask) & 0x3); x++) {
@@ -658,13 +681,21 @@ static void LV_ATTRIBUTE_FAST_MEM map_normal(lv_color_t * dest_buf, const lv_are
     /*Simple fill (maybe with opacity), no masking*/
     if(mask == NULL) {
         if(opa >= LV_OPA_MAX) {
+#if BLEND_RGB565_KERNELS
+            lv_draw_sw_rgb565_copy((uint16_t *)dest_buf, dest_stride, (const uint16_t *)src_buf, src_stride, w, h);
+#else
             for(y = 0; y < h; y++) {
                 lv_memcpy(dest_buf, src_buf, w * sizeof(lv_color_t));
                 dest_buf += dest_stride;
                 src_buf += src_stride;
             }
+#endif
         }
         else {
+#if BLEND_RGB565_KERNELS
+            lv_draw_sw_rgb565_copy_opa((uint16_t *)dest_buf, dest_stride, (const uint16_t *)src_buf, src_stride, w, h, opa);
+            return;
+#endif
             for(y = 0; y < h; y++) {
                 for(x = 0; x < w; x++) {
                     dest_buf[x] = lv_color_mix(src_buf[x], dest_buf[x], opa);
@@ -678,6 +709,11 @@ static void LV_ATTRIBUTE_FAST_MEM map_normal(lv_color_t * dest_buf, const lv_are
     else {
         /*Only the mask matters*/
         if(opa > LV_OPA_MAX) {
+#if BLEND_RGB565_KERNELS
+            lv_draw_sw_rgb565_copy_mask((uint16_t *)dest_buf, dest_stride, (const uint16_t *)src_buf, src_stride, w, h,
+                                        mask, mask_stride);
+            return;
+#endif
             int32_t x_end4 = w - 4;
 
             for(y = 0; y < h; y++) {
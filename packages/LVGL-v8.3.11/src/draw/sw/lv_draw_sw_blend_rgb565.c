@@ -0,0 +1,355 @@
+/**
+ * @file lv_draw_sw_blend_rgb565.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_sw_blend_rgb565.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/*The channels of an RGB565 pixel spread out in a 32-bit word as 00000gggggg00000rrrrr000000bbbbb
+ *so that they can be multiplied by a 5-bit value at once without overflowing into each other*/
+#define SWAR_MASK           0x07E0F81FU
+
+/*Place of the pixel at the lower and at the higher address in a 32-bit word*/
+#if LV_BIG_ENDIAN_SYSTEM
+    #define PX0_SHIFT       16
+    #define PX1_SHIFT       0
+#else
+    #define PX0_SHIFT       0
+    #define PX1_SHIFT       16
+#endif
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static inline uint32_t swar_expand(uint16_t c);
+static inline uint16_t swar_mix(uint32_t fg32, uint16_t bg, uint32_t mix5);
+static inline uint32_t mix5_of(lv_opa_t mix);
+static inline uint16_t mask_px(uint32_t fg32, uint16_t fg, uint16_t bg, lv_opa_t mask);
+static inline bool is_aligned(const void * p);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+#define PACK(px0, px1)      (((uint32_t)(px0) << PX0_SHIFT) | ((uint32_t)(px1) << PX1_SHIFT))
+#define PX0(w32)            ((uint16_t)((w32) >> PX0_SHIFT))
+#define PX1(w32)            ((uint16_t)((w32) >> PX1_SHIFT))
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill(uint16_t * dest_buf, lv_coord_t dest_stride, lv_coord_t w,
+                                                  lv_coord_t h, uint16_t color)
+{
+    uint32_t c32 = PACK(color, color);
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        uint16_t * d = dest_buf;
+        int32_t x = 0;
+        if(w > 0 && !is_aligned(d)) {
+            *d++ = color;
+            x++;
+        }
+
+        uint32_t * d32 = (uint32_t *)d;
+        for(; x <= w - 8; x += 8) {
+            d32[0] = c32;
+            d32[1] = c32;
+            d32[2] = c32;
+            d32[3] = c32;
+            d32 += 4;
+        }
+        for(; x <= w - 2; x += 2) {
+            *d32++ = c32;
+        }
+
+        if(x < w) *((uint16_t *)d32) = color;
+        dest_buf += dest_stride;
+    }
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill_opa(uint16_t * dest_buf, lv_coord_t dest_stride, lv_coord_t w,
+                                                      lv_coord_t h, uint16_t color, lv_opa_t opa)
+{
+    /*The result of a channel depends only on the same channel of the background,
+     *so tabulate every possible background value once instead of multiplying for every pixel.
+     *The entries are already shifted into their place in the pixel.*/
+    uint16_t lut_r[32];
+    uint16_t lut_g[64];
+    uint16_t lut_b[32];
+
+    uint32_t opa_inv = 255 - opa;
+    uint32_t r_pre = (uint32_t)(color >> 11) * opa;
+    uint32_t g_pre = (uint32_t)((color >> 5) & 0x3F) * opa;
+    uint32_t b_pre = (uint32_t)(color & 0x1F) * opa;
+    uint32_t i;
+    for(i = 0; i < 32; i++) {
+        lut_r[i] = (uint16_t)(LV_UDIV255(r_pre + i * opa_inv) << 11);
+        lut_b[i] = (uint16_t)LV_UDIV255(b_pre + i * opa_inv);
+    }
+    for(i = 0; i < 64; i++) {
+        lut_g[i] = (uint16_t)(LV_UDIV255(g_pre + i * opa_inv) << 5);
+    }
+
+#define LUT_PX(c) (uint16_t)(lut_r[(c) >> 11] | lut_g[((c) >> 5) & 0x3F] | lut_b[(c) & 0x1F])
+
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        uint16_t * d = dest_buf;
+        int32_t x = 0;
+        if(w > 0 && !is_aligned(d)) {
+            *d = LUT_PX(*d);
+            d++;
+            x++;
+        }
+
+        uint32_t * d32 = (uint32_t *)d;
+        uint32_t last_in = 0;
+        uint32_t last_out = PACK(LUT_PX(0), LUT_PX(0));
+        for(; x <= w - 2; x += 2) {
+            /*Backgrounds are mostly uniform so cache the last result*/
+            uint32_t in = *d32;
+            if(in != last_in) {
+                last_in = in;
+                last_out = PACK(LUT_PX(PX0(in)), LUT_PX(PX1(in)));
+            }
+            *d32++ = last_out;
+        }
+
+        if(x < w) {
+            d = (uint16_t *)d32;
+            *d = LUT_PX(*d);
+        }
+        dest_buf += dest_stride;
+    }
+
+#undef LUT_PX
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill_mask(uint16_t * dest_buf, lv_coord_t dest_stride, lv_coord_t w,
+                                                       lv_coord_t h, uint16_t color, const lv_opa_t * mask,
+                                                       lv_coord_t mask_stride)
+{
+    uint32_t fg32 = swar_expand(color);
+    uint32_t c32 = PACK(color, color);
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        uint16_t * d = dest_buf;
+        const lv_opa_t * m = mask;
+        int32_t x = 0;
+        if(w > 0 && !is_aligned(d)) {
+            *d = mask_px(fg32, color, *d, *m);
+            d++;
+            m++;
+            x++;
+        }
+
+        uint32_t * d32 = (uint32_t *)d;
+        for(; x <= w - 2; x += 2) {
+            lv_opa_t m0 = m[0];
+            lv_opa_t m1 = m[1];
+            m += 2;
+            /*Glyphs and rounded corners are mostly fully covered or transparent*/
+            if((m0 & m1) == LV_OPA_COVER) {
+                *d32 = c32;
+            }
+            else if(m0 | m1) {
+                uint32_t in = *d32;
+                *d32 = PACK(mask_px(fg32, color, PX0(in), m0), mask_px(fg32, color, PX1(in), m1));
+            }
+            d32++;
+        }
+
+        if(x < w) {
+            d = (uint16_t *)d32;
+            *d = mask_px(fg32, color, *d, *m);
+        }
+        dest_buf += dest_stride;
+        mask += mask_stride;
+    }
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy(uint16_t * dest_buf, lv_coord_t dest_stride,
+                                                  const uint16_t * src_buf, lv_coord_t src_stride,
+                                                  lv_coord_t w, lv_coord_t h)
+{
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        uint16_t * d = dest_buf;
+        const uint16_t * s = src_buf;
+        int32_t x = 0;
+        if(w > 0 && !is_aligned(d)) {
+            *d++ = *s++;
+            x++;
+        }
+
+        uint32_t * d32 = (uint32_t *)d;
+        if(is_aligned(s)) {
+            const uint32_t * s32 = (const uint32_t *)s;
+            for(; x <= w - 8; x += 8) {
+                d32[0] = s32[0];
+                d32[1] = s32[1];
+                d32[2] = s32[2];
+                d32[3] = s32[3];
+                d32 += 4;
+                s32 += 4;
+            }
+            for(; x <= w - 2; x += 2) {
+                *d32++ = *s32++;
+            }
+            s = (const uint16_t *)s32;
+        }
+        else if(x <= w - 3) {
+            /*The source is off by a pixel: read aligned words and put each output word
+             *together from the halves of two neighboring source words.
+             *Stop before reading the word which would be partially out of the row.*/
+            uint32_t prev = *s++;
+            const uint32_t * s32 = (const uint32_t *)s;
+            for(; x <= w - 3; x += 2) {
+                uint32_t cur = *s32++;
+                *d32++ = PACK(prev, PX0(cur));
+                prev = PX1(cur);
+            }
+            s = (const uint16_t *)s32 - 1;
+        }
+
+        d = (uint16_t *)d32;
+        for(; x < w; x++) {
+            *d++ = *s++;
+        }
+        dest_buf += dest_stride;
+        src_buf += src_stride;
+    }
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy_opa(uint16_t * dest_buf, lv_coord_t dest_stride,
+                                                      const uint16_t * src_buf, lv_coord_t src_stride,
+                                                      lv_coord_t w, lv_coord_t h, lv_opa_t opa)
+{
+    uint32_t mix5 = mix5_of(opa);
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        uint16_t * d = dest_buf;
+        const uint16_t * s = src_buf;
+        int32_t x = 0;
+        if(w > 0 && !is_aligned(d)) {
+            *d = swar_mix(swar_expand(*s), *d, mix5);
+            d++;
+            s++;
+            x++;
+        }
+
+        uint32_t * d32 = (uint32_t *)d;
+        for(; x <= w - 2; x += 2) {
+            uint32_t in = *d32;
+            *d32++ = PACK(swar_mix(swar_expand(s[0]), PX0(in), mix5), swar_mix(swar_expand(s[1]), PX1(in), mix5));
+            s += 2;
+        }
+
+        if(x < w) {
+            d = (uint16_t *)d32;
+            *d = swar_mix(swar_expand(*s), *d, mix5);
+        }
+        dest_buf += dest_stride;
+        src_buf += src_stride;
+    }
+}
+
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy_mask(uint16_t * dest_buf, lv_coord_t dest_stride,
+                                                       const uint16_t * src_buf, lv_coord_t src_stride,
+                                                       lv_coord_t w, lv_coord_t h,
+                                                       const lv_opa_t * mask, lv_coord_t mask_stride)
+{
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        uint16_t * d = dest_buf;
+        const uint16_t * s = src_buf;
+        const lv_opa_t * m = mask;
+        int32_t x = 0;
+        if(w > 0 && !is_aligned(d)) {
+            *d = mask_px(swar_expand(*s), *s, *d, *m);
+            d++;
+            s++;
+            m++;
+            x++;
+        }
+
+        /*Word reads from the source only if it's aligned too*/
+        bool s_aligned = is_aligned(s);
+        uint32_t * d32 = (uint32_t *)d;
+        for(; x <= w - 2; x += 2) {
+            lv_opa_t m0 = m[0];
+            lv_opa_t m1 = m[1];
+            if((m0 & m1) == LV_OPA_COVER) {
+                *d32 = s_aligned ? *((const uint32_t *)s) : PACK(s[0], s[1]);
+            }
+            else if(m0 | m1) {
+                uint32_t in = *d32;
+                *d32 = PACK(mask_px(swar_expand(s[0]), s[0], PX0(in), m0),
+                            mask_px(swar_expand(s[1]), s[1], PX1(in), m1));
+            }
+            d32++;
+            s += 2;
+            m += 2;
+        }
+
+        if(x < w) {
+            d = (uint16_t *)d32;
+            *d = mask_px(swar_expand(*s), *s, *d, *m);
+        }
+        dest_buf += dest_stride;
+        src_buf += src_stride;
+        mask += mask_stride;
+    }
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static inline uint32_t swar_expand(uint16_t c)
+{
+    return ((uint32_t)c | ((uint32_t)c << 16)) & SWAR_MASK;
+}
+
+/*Same as the 16 bit `lv_color_mix()` but the foreground is already expanded*/
+static inline uint16_t swar_mix(uint32_t fg32, uint16_t bg, uint32_t mix5)
+{
+    uint32_t bg32 = swar_expand(bg);
+    uint32_t res = ((((fg32 - bg32) * mix5) >> 5) + bg32) & SWAR_MASK;
+    return (uint16_t)((res >> 16) | res);
+}
+
+static inline uint32_t mix5_of(lv_opa_t mix)
+{
+    return ((uint32_t)mix + 4) >> 3;
+}
+
+/*Same as `FILL_NORMAL_MASK_PX` and `MAP_NORMAL_MASK_PX` of `lv_draw_sw_blend.c`*/
+static inline uint16_t mask_px(uint32_t fg32, uint16_t fg, uint16_t bg, lv_opa_t mask)
+{
+    /*A transparent mask gives back `bg` from the mix too*/
+    if(mask == LV_OPA_COVER) return fg;
+    return swar_mix(fg32, bg, mix5_of(mask));
+}
+
+static inline bool is_aligned(const void * p)
+{
+    return ((lv_uintptr_t)p & 0x3) == 0;
+}
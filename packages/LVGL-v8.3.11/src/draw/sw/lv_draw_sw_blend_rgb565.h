@@ -0,0 +1,128 @@
+/**
+ * @file lv_draw_sw_blend_rgb565.h
+ *
+ * Word-at-a-time blending kernels for RGB565 buffers.
+ * They read and write two pixels per 32-bit access and give exactly the same result
+ * as the per-pixel code of `lv_draw_sw_blend.c` with `LV_COLOR_DEPTH 16`, `LV_COLOR_16_SWAP 0`
+ * and `LV_COLOR_MIX_ROUND_OFS 0`. `lv_draw_sw_blend.c` uses them only with this configuration,
+ * however they work on plain `uint16_t` buffers so they can be built (and tested) with any color depth.
+ */
+
+#ifndef LV_DRAW_SW_BLEND_RGB565_H
+#define LV_DRAW_SW_BLEND_RGB565_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "../../misc/lv_color.h"
+#include "../../misc/lv_area.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/*Below this many pixels setting up the lookup tables of `lv_draw_sw_rgb565_fill_opa` doesn't pay off*/
+#define LV_DRAW_SW_RGB565_FILL_OPA_MIN_PX   128
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Fill an area with a color.
+ * @param dest_buf      pointer to the first pixel of the area
+ * @param dest_stride   stride of `dest_buf` in pixels
+ * @param w             width of the area
+ * @param h             height of the area
+ * @param color         the color to fill with
+ */
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill(uint16_t * dest_buf, lv_coord_t dest_stride, lv_coord_t w,
+                                                  lv_coord_t h, uint16_t color);
+
+/**
+ * Fill an area with a color and opacity: `(c * opa + bg * (255 - opa)) / 255` on every channel.
+ * Same as `lv_color_mix_premult()` but it uses per-channel lookup tables, so it has no multiplication per pixel.
+ * @param dest_buf      pointer to the first pixel of the area
+ * @param dest_stride   stride of `dest_buf` in pixels
+ * @param w             width of the area
+ * @param h             height of the area
+ * @param color         the color to fill with
+ * @param opa           opacity of `color`
+ */
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill_opa(uint16_t * dest_buf, lv_coord_t dest_stride, lv_coord_t w,
+                                                      lv_coord_t h, uint16_t color, lv_opa_t opa);
+
+/**
+ * Fill an area with a color through an alpha mask. Same as `lv_color_mix(color, dest, mask)` per pixel.
+ * @param dest_buf      pointer to the first pixel of the area
+ * @param dest_stride   stride of `dest_buf` in pixels
+ * @param w             width of the area
+ * @param h             height of the area
+ * @param color         the color to fill with
+ * @param mask          pointer to the first mask value of the area
+ * @param mask_stride   stride of `mask` in bytes
+ */
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_fill_mask(uint16_t * dest_buf, lv_coord_t dest_stride, lv_coord_t w,
+                                                       lv_coord_t h, uint16_t color, const lv_opa_t * mask,
+                                                       lv_coord_t mask_stride);
+
+/**
+ * Copy an area. The source and the destination can have different alignments.
+ * @param dest_buf      pointer to the first pixel of the destination area
+ * @param dest_stride   stride of `dest_buf` in pixels
+ * @param src_buf       pointer to the first pixel of the source area
+ * @param src_stride    stride of `src_buf` in pixels
+ * @param w             width of the area
+ * @param h             height of the area
+ */
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy(uint16_t * dest_buf, lv_coord_t dest_stride,
+                                                  const uint16_t * src_buf, lv_coord_t src_stride,
+                                                  lv_coord_t w, lv_coord_t h);
+
+/**
+ * Blend an area with an opacity. Same as `lv_color_mix(src, dest, opa)` per pixel.
+ * @param dest_buf      pointer to the first pixel of the destination area
+ * @param dest_stride   stride of `dest_buf` in pixels
+ * @param src_buf       pointer to the first pixel of the source area
+ * @param src_stride    stride of `src_buf` in pixels
+ * @param w             width of the area
+ * @param h             height of the area
+ * @param opa           opacity of the source
+ */
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy_opa(uint16_t * dest_buf, lv_coord_t dest_stride,
+                                                      const uint16_t * src_buf, lv_coord_t src_stride,
+                                                      lv_coord_t w, lv_coord_t h, lv_opa_t opa);
+
+/**
+ * Blend an area through an alpha mask. Same as `lv_color_mix(src, dest, mask)` per pixel.
+ * @param dest_buf      pointer to the first pixel of the destination area
+ * @param dest_stride   stride of `dest_buf` in pixels
+ * @param src_buf       pointer to the first pixel of the source area
+ * @param src_stride    stride of `src_buf` in pixels
+ * @param w             width of the area
+ * @param h             height of the area
+ * @param mask          pointer to the first mask value of the area
+ * @param mask_stride   stride of `mask` in bytes
+ */
+void LV_ATTRIBUTE_FAST_MEM lv_draw_sw_rgb565_copy_mask(uint16_t * dest_buf, lv_coord_t dest_stride,
+                                                       const uint16_t * src_buf, lv_coord_t src_stride,
+                                                       lv_coord_t w, lv_coord_t h,
+                                                       const lv_opa_t * mask, lv_coord_t mask_stride);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_SW_BLEND_RGB565_H*/
@@ -10,6 +10,10 @@
 #include "../../misc/lv_gc.h"
 #include "../../misc/lv_types.h"
 
+#if LV_GRAD_CACHE_CUSTOM
+    #include LV_GRAD_CACHE_CUSTOM_INCLUDE
+#endif
+
 /*********************
  *      DEFINES
  *********************/
@@ -32,41 +36,94 @@
     #error "LV_GRAD_CACHE_DEF_SIZE is too small"
 #endif
 
+#if LV_GRAD_CACHE_CUSTOM
+    #define GRAD_CACHE_ALLOC(size)  LV_GRAD_CACHE_CUSTOM_ALLOC(size)
+    #define GRAD_CACHE_FREE(p)      LV_GRAD_CACHE_CUSTOM_FREE(p)
+#else
+    #define GRAD_CACHE_ALLOC(size)  lv_mem_alloc(size)
+    #define GRAD_CACHE_FREE(p)      lv_mem_free(p)
+#endif
+
+/*Number of hash buckets, must be a power of 2*/
+#define GRAD_CACHE_BUCKET_CNT   32
+
+/*With error diffusion enabled only `LV_DITHER_ORDERED` uses ordered dithering, else every dithering mode does*/
+#if _DITHER_GRADIENT
+    #if LV_DITHER_ERROR_DIFFUSION
+        #define IS_ORDERED_DITHER(d)    ((d) == LV_DITHER_ORDERED)
+    #else
+        #define IS_ORDERED_DITHER(d)    ((d) != LV_DITHER_NONE)
+    #endif
+#endif
+
+/*One step of the FNV-1a hash*/
+#define HASH_ADD(h, v)  h = ((h) ^ (uint32_t)(v)) * 16777619u
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
-static lv_grad_t * next_in_cache(lv_grad_t * item);
-
-typedef lv_res_t (*op_cache_t)(lv_grad_t * c, void * ctx);
-static lv_res_t iterate_cache(op_cache_t func, void * ctx, lv_grad_t ** out);
 static size_t get_cache_item_size(lv_grad_t * c);
-static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h);
-static lv_res_t find_oldest_item_life(lv_grad_t * c, void * ctx);
-static lv_res_t kill_oldest_item(lv_grad_t * c, void * ctx);
-static lv_res_t find_item(lv_grad_t * c, void * ctx);
+static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h, lv_coord_t key_w, uint32_t key);
+static lv_grad_t * find_item(const lv_grad_dsc_t * g, lv_coord_t size, lv_coord_t key_w, uint32_t key);
+static bool dsc_equal(const lv_grad_dsc_t * a, const lv_grad_dsc_t * b);
+static void lru_remove(lv_grad_t * c);
+static void lru_add_head(lv_grad_t * c);
 static void free_item(lv_grad_t * c);
-static  uint32_t compute_key(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h);
+static void kill_oldest_item(void);
+static  uint32_t compute_key(const lv_grad_dsc_t * g, lv_coord_t size, lv_coord_t w);
 
 
 /**********************
  *   STATIC VARIABLE
  **********************/
-static size_t    grad_cache_size = 0;
-static uint8_t * grad_cache_end = 0;
+static bool        grad_cache_inited = false;
+static size_t      grad_cache_size = 0;
+static size_t      grad_cache_used = 0;
+static uint32_t    grad_cache_item_cnt = 0;
+static lv_grad_t * lru_head = NULL;     /*Most recently used item*/
+static lv_grad_t * lru_tail = NULL;     /*Least recently used item, evicted first*/
+static lv_grad_cache_stat_t grad_cache_stat;
 
 /**********************
- *   STATIC FUNCTIONS
+ *      MACROS
  **********************/
-union void_cast {
-    const void * ptr;
-    const uint32_t value;
-};
+#define GRAD_CACHE_BUCKETS  ((lv_grad_t **)LV_GC_ROOT(_lv_grad_cache_mem))
 
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+/*FNV-1a hash of the content of the descriptor, so equal gradients of different styles share the same item*/
 static uint32_t compute_key(const lv_grad_dsc_t * g, lv_coord_t size, lv_coord_t w)
 {
-    union void_cast v;
-    v.ptr = g;
-    return (v.value ^ size ^ (w >> 1)); /*Yes, this is correct, it's like a hash that changes if the width changes*/
+    uint32_t h = 2166136261u;
+    HASH_ADD(h, g->dir);
+#if _DITHER_GRADIENT
+    HASH_ADD(h, g->dither);
+#endif
+    HASH_ADD(h, g->stops_count);
+    uint8_t i;
+    for(i = 0; i < g->stops_count; i++) {
+        HASH_ADD(h, g->stops[i].color.full);
+        HASH_ADD(h, g->stops[i].frac);
+    }
+    HASH_ADD(h, size);
+    HASH_ADD(h, w);
+    return h;
+}
+
+static bool dsc_equal(const lv_grad_dsc_t * a, const lv_grad_dsc_t * b)
+{
+    if(a->dir != b->dir) return false;
+#if _DITHER_GRADIENT
+    if(a->dither != b->dither) return false;
+#endif
+    if(a->stops_count != b->stops_count) return false;
+    uint8_t i;
+    for(i = 0; i < a->stops_count; i++) {
+        if(a->stops[i].color.full != b->stops[i].color.full) return false;
+        if(a->stops[i].frac != b->stops[i].frac) return false;
+    }
+    return true;
 }
 
 static size_t get_cache_item_size(lv_grad_t * c)
@@ -81,85 +138,71 @@ static size_t get_cache_item_size(lv_grad_t * c)
     return s;
 }
 
-static lv_grad_t * next_in_cache(lv_grad_t * item)
+static lv_grad_t * find_item(const lv_grad_dsc_t * g, lv_coord_t size, lv_coord_t key_w, uint32_t key)
 {
-    if(grad_cache_size == 0) return NULL;
+    if(GRAD_CACHE_BUCKETS == NULL) return NULL;
 
-    if(item == NULL)
-        return (lv_grad_t *)LV_GC_ROOT(_lv_grad_cache_mem);
-
-    size_t s = get_cache_item_size(item);
-    /*Compute the size for this cache item*/
-    if((uint8_t *)item + s >= grad_cache_end) return NULL;
-    else return (lv_grad_t *)((uint8_t *)item + s);
-}
-
-static lv_res_t iterate_cache(op_cache_t func, void * ctx, lv_grad_t ** out)
-{
-    lv_grad_t * first = next_in_cache(NULL);
-    while(first != NULL && first->life) {
-        if((*func)(first, ctx) == LV_RES_OK) {
-            if(out != NULL) *out = first;
-            return LV_RES_OK;
-        }
-        first = next_in_cache(first);
+    lv_grad_t * c = GRAD_CACHE_BUCKETS[key & (GRAD_CACHE_BUCKET_CNT - 1)];
+    while(c) {
+        /*The key is only a hash, so compare the content too*/
+        if(c->key == key && c->size == size && c->key_w == key_w && dsc_equal(&c->dsc, g)) return c;
+        c = c->hash_next;
     }
-    return LV_RES_INV;
+    return NULL;
 }
 
-static lv_res_t find_oldest_item_life(lv_grad_t * c, void * ctx)
+static void lru_remove(lv_grad_t * c)
 {
-    uint32_t * min_life = (uint32_t *)ctx;
-    if(c->life < *min_life) *min_life = c->life;
-    return LV_RES_INV;
+    if(c->lru_prev) c->lru_prev->lru_next = c->lru_next;
+    else lru_head = c->lru_next;
+    if(c->lru_next) c->lru_next->lru_prev = c->lru_prev;
+    else lru_tail = c->lru_prev;
+    c->lru_prev = NULL;
+    c->lru_next = NULL;
 }
 
-static void free_item(lv_grad_t * c)
+static void lru_add_head(lv_grad_t * c)
 {
-    size_t size = get_cache_item_size(c);
-    size_t next_items_size = (size_t)(grad_cache_end - (uint8_t *)c) - size;
-    grad_cache_end -= size;
-    if(next_items_size) {
-        uint8_t * old = (uint8_t *)c;
-        lv_memcpy(c, ((uint8_t *)c) + size, next_items_size);
-        /* Then need to fix all internal pointers too */
-        while((uint8_t *)c != grad_cache_end) {
-            c->map = (lv_color_t *)(((uint8_t *)c->map) - size);
-#if _DITHER_GRADIENT
-            c->hmap = (lv_color32_t *)(((uint8_t *)c->hmap) - size);
-#if LV_DITHER_ERROR_DIFFUSION == 1
-            c->error_acc = (lv_scolor24_t *)(((uint8_t *)c->error_acc) - size);
-#endif
-#endif
-            c = (lv_grad_t *)(((uint8_t *)c) + get_cache_item_size(c));
-        }
-        lv_memset_00(old + next_items_size, size);
-    }
+    c->lru_prev = NULL;
+    c->lru_next = lru_head;
+    if(lru_head) lru_head->lru_prev = c;
+    else lru_tail = c;
+    lru_head = c;
 }
 
-static lv_res_t kill_oldest_item(lv_grad_t * c, void * ctx)
+static void free_item(lv_grad_t * c)
 {
-    uint32_t * min_life = (uint32_t *)ctx;
-    if(c->life == *min_life) {
-        /*Found, let's kill it*/
-        free_item(c);
-        return LV_RES_OK;
-    }
-    return LV_RES_INV;
+    /*Unlink from the hash bucket*/
+    lv_grad_t ** p = &GRAD_CACHE_BUCKETS[c->key & (GRAD_CACHE_BUCKET_CNT - 1)];
+    while(*p && *p != c) p = &(*p)->hash_next;
+    if(*p) *p = c->hash_next;
+
+    lru_remove(c);
+    grad_cache_used -= get_cache_item_size(c);
+    grad_cache_item_cnt--;
+    GRAD_CACHE_FREE(c);
 }
 
-static lv_res_t find_item(lv_grad_t * c, void * ctx)
+static void kill_oldest_item(void)
 {
-    uint32_t * k = (uint32_t *)ctx;
-    if(c->key == *k) return LV_RES_OK;
-    return LV_RES_INV;
+    if(lru_tail == NULL) return;
+    free_item(lru_tail);
+    grad_cache_stat.evict++;
 }
 
-static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
+static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h, lv_coord_t key_w, uint32_t key)
 {
     lv_coord_t size = g->dir == LV_GRAD_DIR_HOR ? w : h;
     lv_coord_t map_size = LV_MAX(w, h); /* The map is being used horizontally (width) unless
                                            no dithering is selected where it's used vertically */
+    bool dither_rows = false;
+#if _DITHER_GRADIENT
+    /*Ordered horizontal dithering depends only on `y & 7` so store all the 8 rows*/
+    if(g->dir == LV_GRAD_DIR_HOR && IS_ORDERED_DITHER(g->dither)) {
+        dither_rows = true;
+        map_size = 8 * w;
+    }
+#endif
 
     size_t req_size = ALIGN(sizeof(lv_grad_t)) + ALIGN(map_size * sizeof(lv_color_t));
 #if _DITHER_GRADIENT
@@ -169,62 +212,58 @@ static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord
 #endif
 #endif
 
-    size_t act_size = (size_t)(grad_cache_end - LV_GC_ROOT(_lv_grad_cache_mem));
     lv_grad_t * item = NULL;
-    if(req_size + act_size < grad_cache_size) {
-        item = (lv_grad_t *)grad_cache_end;
+    if(GRAD_CACHE_BUCKETS && req_size <= grad_cache_size) {
+        /*Need to evict items from cache until we find enough space to allocate this one */
+        while(grad_cache_used + req_size > grad_cache_size) kill_oldest_item();
+
+        item = GRAD_CACHE_ALLOC(req_size);
+        /*The heap can be full or fragmented even if the cache isn't*/
+        while(item == NULL && lru_tail) {
+            kill_oldest_item();
+            item = GRAD_CACHE_ALLOC(req_size);
+        }
+    }
+
+    if(item) {
         item->not_cached = 0;
+        item->hash_next = GRAD_CACHE_BUCKETS[key & (GRAD_CACHE_BUCKET_CNT - 1)];
+        GRAD_CACHE_BUCKETS[key & (GRAD_CACHE_BUCKET_CNT - 1)] = item;
+        lru_add_head(item);
+        grad_cache_used += req_size;
+        grad_cache_item_cnt++;
     }
     else {
-        /*Need to evict items from cache until we find enough space to allocate this one */
-        if(req_size <= grad_cache_size) {
-            while(act_size + req_size > grad_cache_size) {
-                uint32_t oldest_life = UINT32_MAX;
-                iterate_cache(&find_oldest_item_life, &oldest_life, NULL);
-                iterate_cache(&kill_oldest_item, &oldest_life, NULL);
-                act_size = (size_t)(grad_cache_end - LV_GC_ROOT(_lv_grad_cache_mem));
-            }
-            item = (lv_grad_t *)grad_cache_end;
-            item->not_cached = 0;
-        }
-        else {
-            /*The cache is too small. Allocate the item manually and free it later.*/
-            item = lv_mem_alloc(req_size);
-            LV_ASSERT_MALLOC(item);
-            if(item == NULL) return NULL;
-            item->not_cached = 1;
-        }
+        /*The cache is too small. Allocate the item manually and free it later.*/
+        item = lv_mem_alloc(req_size);
+        LV_ASSERT_MALLOC(item);
+        if(item == NULL) return NULL;
+        item->not_cached = 1;
+        item->hash_next = NULL;
+        item->lru_prev = NULL;
+        item->lru_next = NULL;
+        grad_cache_stat.not_cached++;
     }
 
-    item->key = compute_key(g, size, w);
+    item->key = key;
     item->life = 1;
     item->filled = 0;
+    item->dither_rows = dither_rows;
     item->alloc_size = map_size;
     item->size = size;
-    if(item->not_cached) {
-        uint8_t * p = (uint8_t *)item;
-        item->map = (lv_color_t *)(p + ALIGN(sizeof(*item)));
-#if _DITHER_GRADIENT
-        item->hmap = (lv_color32_t *)(p + ALIGN(sizeof(*item)) + ALIGN(map_size * sizeof(lv_color_t)));
-#if LV_DITHER_ERROR_DIFFUSION == 1
-        item->error_acc = (lv_scolor24_t *)(p + ALIGN(sizeof(*item)) + ALIGN(size * sizeof(lv_grad_color_t)) +
-                                            ALIGN(map_size * sizeof(lv_color_t)));
-        item->w = w;
-#endif
-#endif
-    }
-    else {
-        item->map = (lv_color_t *)(grad_cache_end + ALIGN(sizeof(*item)));
+    item->key_w = key_w;
+    lv_memcpy_small(&item->dsc, g, sizeof(lv_grad_dsc_t));
+
+    uint8_t * p = (uint8_t *)item;
+    item->map = (lv_color_t *)(p + ALIGN(sizeof(*item)));
 #if _DITHER_GRADIENT
-        item->hmap = (lv_color32_t *)(grad_cache_end + ALIGN(sizeof(*item)) + ALIGN(map_size * sizeof(lv_color_t)));
+    item->hmap = (lv_color32_t *)(p + ALIGN(sizeof(*item)) + ALIGN(map_size * sizeof(lv_color_t)));
 #if LV_DITHER_ERROR_DIFFUSION == 1
-        item->error_acc = (lv_scolor24_t *)(grad_cache_end + ALIGN(sizeof(*item)) + ALIGN(size * sizeof(lv_grad_color_t)) +
-                                            ALIGN(map_size * sizeof(lv_color_t)));
-        item->w = w;
+    item->error_acc = (lv_scolor24_t *)(p + ALIGN(sizeof(*item)) + ALIGN(size * sizeof(lv_grad_color_t)) +
+                                        ALIGN(map_size * sizeof(lv_color_t)));
+    item->w = w;
 #endif
 #endif
-        grad_cache_end += req_size;
-    }
     return item;
 }
 
@@ -234,18 +273,32 @@ static lv_grad_t * allocate_item(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord
  **********************/
 void lv_gradient_free_cache(void)
 {
+    while(lru_tail) free_item(lru_tail);
     lv_mem_free(LV_GC_ROOT(_lv_grad_cache_mem));
-    LV_GC_ROOT(_lv_grad_cache_mem) = grad_cache_end = NULL;
+    LV_GC_ROOT(_lv_grad_cache_mem) = NULL;
     grad_cache_size = 0;
+    grad_cache_inited = true;
 }
 
 void lv_gradient_set_cache_size(size_t max_bytes)
 {
-    lv_mem_free(LV_GC_ROOT(_lv_grad_cache_mem));
-    grad_cache_end = LV_GC_ROOT(_lv_grad_cache_mem) = lv_mem_alloc(max_bytes);
-    LV_ASSERT_MALLOC(LV_GC_ROOT(_lv_grad_cache_mem));
-    lv_memset_00(LV_GC_ROOT(_lv_grad_cache_mem), max_bytes);
+    grad_cache_inited = true;
     grad_cache_size = max_bytes;
+    while(grad_cache_used > grad_cache_size) kill_oldest_item();
+
+    if(max_bytes == 0) {
+        lv_mem_free(LV_GC_ROOT(_lv_grad_cache_mem));
+        LV_GC_ROOT(_lv_grad_cache_mem) = NULL;
+    }
+    else if(LV_GC_ROOT(_lv_grad_cache_mem) == NULL) {
+        LV_GC_ROOT(_lv_grad_cache_mem) = lv_mem_alloc(GRAD_CACHE_BUCKET_CNT * sizeof(lv_grad_t *));
+        LV_ASSERT_MALLOC(LV_GC_ROOT(_lv_grad_cache_mem));
+        if(LV_GC_ROOT(_lv_grad_cache_mem) == NULL) {
+            grad_cache_size = 0;
+            return;
+        }
+        lv_memset_00(LV_GC_ROOT(_lv_grad_cache_mem), GRAD_CACHE_BUCKET_CNT * sizeof(lv_grad_t *));
+    }
 }
 
 lv_grad_t * lv_gradient_get(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
@@ -254,23 +307,30 @@ lv_grad_t * lv_gradient_get(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
     if(g->dir == LV_GRAD_DIR_NONE) return NULL;
 
     /* Step 0: Check if the cache exist (else create it) */
-    static bool inited = false;
-    if(!inited) {
-        lv_gradient_set_cache_size(LV_GRAD_CACHE_DEF_SIZE);
-        inited = true;
-    }
+    if(!grad_cache_inited) lv_gradient_set_cache_size(LV_GRAD_CACHE_DEF_SIZE);
 
     /* Step 1: Search cache for the given key */
     lv_coord_t size = g->dir == LV_GRAD_DIR_HOR ? w : h;
-    uint32_t key = compute_key(g, size, w);
-    lv_grad_t * item = NULL;
-    if(iterate_cache(&find_item, &key, &item) == LV_RES_OK) {
+#if _DITHER_GRADIENT
+    lv_coord_t key_w = w;   /*The map and the error buffer are used horizontally*/
+#else
+    lv_coord_t key_w = g->dir == LV_GRAD_DIR_HOR ? w : 0; /*A vertical map is the same for any width*/
+#endif
+    uint32_t key = compute_key(g, size, key_w);
+    lv_grad_t * item = find_item(g, size, key_w, key);
+    if(item) {
         item->life++; /* Don't forget to bump the counter */
+        if(lru_head != item) {
+            lru_remove(item);
+            lru_add_head(item);
+        }
+        grad_cache_stat.hit++;
         return item;
     }
 
     /* Step 2: Need to allocate an item for it */
-    item = allocate_item(g, w, h);
+    grad_cache_stat.miss++;
+    item = allocate_item(g, w, h, key_w, key);
     if(item == NULL) {
         LV_LOG_WARN("Faild to allcoate item for teh gradient");
         return item;
@@ -284,6 +344,15 @@ lv_grad_t * lv_gradient_get(const lv_grad_dsc_t * g, lv_coord_t w, lv_coord_t h)
 #if LV_DITHER_ERROR_DIFFUSION == 1
     lv_memset_00(item->error_acc, w * sizeof(lv_scolor24_t));
 #endif
+    if(item->dither_rows) {
+        /*Pre-compute the rows so the drawing is a simple copy*/
+        lv_color_t * map = item->map;
+        for(lv_coord_t y = 0; y < 8; y++) {
+            item->map = map + y * item->size;
+            lv_dither_ordered_hor(item, 0, y, item->size);
+        }
+        item->map = map;
+    }
 #else
     for(lv_coord_t i = 0; i < item->size; i++) {
         item->map[i] = lv_gradient_calculate(g, item->size, i);
@@ -344,3 +413,16 @@ void lv_gradient_cleanup(lv_grad_t * grad)
         lv_mem_free(grad);
     }
 }
+
+void lv_gradient_get_cache_stat(lv_grad_cache_stat_t * stat)
+{
+    *stat = grad_cache_stat;
+    stat->item_cnt = grad_cache_item_cnt;
+    stat->used_size = grad_cache_used;
+    stat->max_size = grad_cache_size;
+}
+
+void lv_gradient_reset_cache_stat(void)
+{
+    lv_memset_00(&grad_cache_stat, sizeof(grad_cache_stat));
+}
@@ -38,27 +38,44 @@ typedef lv_color_t lv_grad_color_t;
  *  it's possible to cache the computation in this structure instance.
  *  Whenever possible, this structure is reused instead of recomputing the gradient map */
 typedef struct _lv_gradient_cache_t {
-    uint32_t        key;          /**< A discriminating key that's built from the drawing operation.
-                                   * If the key does not match, the cache item is not used */
-    uint32_t        life : 30;    /**< A life counter that's incremented on usage. Higher counter is
-                                   * less likely to be evicted from the cache */
+    uint32_t        key;          /**< Hash of the gradient descriptor and the size it's computed for.
+                                   * Used to select the hash bucket, `dsc`, `size` and `key_w` are compared too */
+    uint32_t        life : 29;    /**< A life counter that's incremented on usage */
     uint32_t        filled : 1;   /**< Used to skip dithering in it if already done */
     uint32_t        not_cached: 1; /**< The cache was too small so this item is not managed by the cache*/
+    uint32_t        dither_rows: 1; /**< `map` holds the 8 pre-dithered rows of an ordered horizontal dithering,
+                                     * row `y` starts at `map + (y & 7) * size` */
     lv_color_t   *  map;          /**< The computed gradient low bitdepth color map, points into the
-                                   * cache's buffer, no free needed */
+                                   * item's buffer, no free needed */
     lv_coord_t      alloc_size;   /**< The map allocated size in colors */
     lv_coord_t      size;         /**< The computed gradient color map size, in colors */
+    lv_coord_t      key_w;        /**< The width of the object the item was computed for */
+    lv_grad_dsc_t   dsc;          /**< Copy of the gradient descriptor the item was computed from */
+    struct _lv_gradient_cache_t * hash_next;    /**< Next item in the same hash bucket */
+    struct _lv_gradient_cache_t * lru_prev;     /**< Previous (more recently used) item */
+    struct _lv_gradient_cache_t * lru_next;     /**< Next (less recently used) item */
 #if _DITHER_GRADIENT
     lv_color32_t  * hmap;         /**< If dithering, we need to store the current, high bitdepth gradient
-                                   * map too, points to the cache's buffer, no free needed */
+                                   * map too, points to the item's buffer, no free needed */
 #if LV_DITHER_ERROR_DIFFUSION == 1
     lv_scolor24_t * error_acc;    /**< Error diffusion dithering algorithm requires storing the last error
-                                   * drawn, points to the cache's buffer, no free needed  */
+                                   * drawn, points to the item's buffer, no free needed  */
     lv_coord_t      w;            /**< The error array width in pixels */
 #endif
 #endif
 } lv_grad_t;
 
+/** Statistics of the gradient cache */
+typedef struct {
+    uint32_t hit;           /**< Number of `lv_gradient_get` calls served from the cache*/
+    uint32_t miss;          /**< Number of `lv_gradient_get` calls which computed the gradient*/
+    uint32_t evict;         /**< Number of items removed to make room for new ones*/
+    uint32_t not_cached;    /**< Number of items which didn't fit into the cache and were freed after drawing*/
+    uint32_t item_cnt;      /**< Number of items in the cache now*/
+    size_t   used_size;     /**< Bytes used by the items in the cache*/
+    size_t   max_size;      /**< The cache size set by `lv_gradient_set_cache_size`*/
+} lv_grad_cache_stat_t;
+
 
 /**********************
  *      PROTOTYPES
@@ -73,8 +90,8 @@ lv_grad_color_t /* LV_ATTRIBUTE_FAST_MEM */ lv_gradient_calculate(const lv_grad_
                                                                   lv_coord_t frac);
 
 /**
- * Set the gradient cache size
- * @param max_bytes Max cahce size
+ * Set the gradient cache size. The least recently used items are freed if the cache is larger than this.
+ * @param max_bytes Max cache size, the size of the item headers and buffers are counted. 0: disable the cache.
  */
 void lv_gradient_set_cache_size(size_t max_bytes);
 
@@ -90,6 +107,15 @@ lv_grad_t * lv_gradient_get(const lv_grad_dsc_t * gradient, lv_coord_t w, lv_coo
  */
 void lv_gradient_cleanup(lv_grad_t * grad);
 
+/**
+ * Get the statistics of the gradient cache
+ * @param stat      store the result here
+ */
+void lv_gradient_get_cache_stat(lv_grad_cache_stat_t * stat);
+
+/** Clear the hit, miss, evict and not cached counters of the gradient cache */
+void lv_gradient_reset_cache_stat(void);
+
 #ifdef __cplusplus
 } /*extern "C"*/
 #endif
@@ -183,7 +183,7 @@ static void draw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, co
     }
 
     if(grad && dither_mode == LV_DITHER_NONE) {
-        grad->filled = 0; /*Should we force refilling it each draw call ?*/
+        /*The dithering mode is part of the cache key so `map` is filled only once*/
         if(grad_dir == LV_GRAD_DIR_VER)
             grad_size = coords_bg_h;
     }
@@ -215,6 +215,10 @@ static void draw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, co
                     dither_func = NULL;
             }
 #endif
+
+    /*The rows of the ordered horizontal dithering are pre-computed in the cache, just select them line by line*/
+    bool dither_rows = grad && grad->dither_rows && dither_func == lv_dither_ordered_hor;
+    if(dither_rows) dither_func = NULL;
 #endif
 
     /*There is another mask too. Draw line by line. */
@@ -231,6 +235,8 @@ static void draw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, co
 
 #if _DITHER_GRADIENT
             if(dither_func) dither_func(grad, blend_area.x1,  h - bg_coords.y1, grad_size);
+            if(dither_rows) blend_dsc.src_buf = grad->map + ((h - bg_coords.y1) & 7) * grad->size +
+                                                    clipped_coords.x1 - bg_coords.x1;
 #endif
             if(grad_dir == LV_GRAD_DIR_VER) blend_dsc.color = grad->map[h - bg_coords.y1];
             lv_draw_sw_blend(draw_ctx, &blend_dsc);
@@ -257,6 +263,8 @@ static void draw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, co
 
 #if _DITHER_GRADIENT
             if(dither_func) dither_func(grad, blend_area.x1,  top_y - bg_coords.y1, grad_size);
+            if(dither_rows) blend_dsc.src_buf = grad->map + ((top_y - bg_coords.y1) & 7) * grad->size +
+                                                    clipped_coords.x1 - bg_coords.x1;
 #endif
             if(grad_dir == LV_GRAD_DIR_VER) blend_dsc.color = grad->map[top_y - bg_coords.y1];
             lv_draw_sw_blend(draw_ctx, &blend_dsc);
@@ -268,6 +276,8 @@ static void draw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, co
 
 #if _DITHER_GRADIENT
             if(dither_func) dither_func(grad, blend_area.x1,  bottom_y - bg_coords.y1, grad_size);
+            if(dither_rows) blend_dsc.src_buf = grad->map + ((bottom_y - bg_coords.y1) & 7) * grad->size +
+                                                    clipped_coords.x1 - bg_coords.x1;
 #endif
             if(grad_dir == LV_GRAD_DIR_VER) blend_dsc.color = grad->map[bottom_y - bg_coords.y1];
             lv_draw_sw_blend(draw_ctx, &blend_dsc);
@@ -307,6 +317,8 @@ static void draw_bg(lv_draw_ctx_t * draw_ctx, const lv_draw_rect_dsc_t * dsc, co
 
 #if _DITHER_GRADIENT
             if(dither_func) dither_func(grad, blend_area.x1,  h - bg_coords.y1, grad_size);
+            if(dither_rows) blend_dsc.src_buf = grad->map + ((h - bg_coords.y1) & 7) * grad->size +
+                                                    clipped_coords.x1 - bg_coords.x1;
 #endif
             if(grad_dir == LV_GRAD_DIR_VER) blend_dsc.color = grad->map[h - bg_coords.y1];
             lv_draw_sw_blend(draw_ctx, &blend_dsc);
@@ -19,6 +19,11 @@
 #else
     #include <windows.h>
 #endif
+#if defined(__RTTHREAD__) && defined(RT_USING_DFS)
+    #include <sys/ioctl.h>
+    #include <sys/stat.h>
+    #include <dfs_file.h>
+#endif
 
 /*********************
  *      DEFINES
@@ -41,6 +46,9 @@ static lv_fs_res_t fs_read(lv_fs_drv_t * drv, void * file_p, void * buf, uint32_
 static lv_fs_res_t fs_write(lv_fs_drv_t * drv, void * file_p, const void * buf, uint32_t btw, uint32_t * bw);
 static lv_fs_res_t fs_seek(lv_fs_drv_t * drv, void * file_p, uint32_t pos, lv_fs_whence_t whence);
 static lv_fs_res_t fs_tell(lv_fs_drv_t * drv, void * file_p, uint32_t * pos_p);
+#ifdef RT_FIOGETADDR
+    static const void * fs_map(lv_fs_drv_t * drv, void * file_p, uint32_t * size_p);
+#endif
 static void * fs_dir_open(lv_fs_drv_t * drv, const char * path);
 static lv_fs_res_t fs_dir_read(lv_fs_drv_t * drv, void * dir_p, char * fn);
 static lv_fs_res_t fs_dir_close(lv_fs_drv_t * drv, void * dir_p);
@@ -80,6 +88,9 @@ void lv_fs_posix_init(void)
     fs_drv.write_cb = fs_write;
     fs_drv.seek_cb = fs_seek;
     fs_drv.tell_cb = fs_tell;
+#ifdef RT_FIOGETADDR
+    fs_drv.map_cb = fs_map;
+#endif
 
     fs_drv.dir_close_cb = fs_dir_close;
     fs_drv.dir_open_cb = fs_dir_open;
@@ -196,6 +207,26 @@ static lv_fs_res_t fs_tell(lv_fs_drv_t * drv, void * file_p, uint32_t * pos_p)
     return offset < 0 ? LV_FS_RES_FS_ERR : LV_FS_RES_OK;
 }
 
+#ifdef RT_FIOGETADDR
+/**
+ * Get the content of a file which is in memory, e.g. in a ROMFS image of RT-Thread
+ * @param drv pointer to a driver where this function belongs
+ * @param file_p a file handle variable.
+ * @param size_p pointer to store the size of the file
+ * @return pointer to the content of the file or NULL if the file system can't give it
+ */
+static const void * fs_map(lv_fs_drv_t * drv, void * file_p, uint32_t * size_p)
+{
+    LV_UNUSED(drv);
+    rt_ubase_t addr = 0;
+    struct stat st;
+    if(ioctl((lv_uintptr_t)file_p, RT_FIOGETADDR, &addr) != 0 || addr == 0) return NULL;
+    if(fstat((lv_uintptr_t)file_p, &st) != 0) return NULL;
+    *size_p = st.st_size;
+    return (const void *)addr;
+}
+#endif
+
 #ifdef WIN32
     static char next_fn[256];
 #endif
@@ -82,6 +82,11 @@ void lv_extra_init(void)
     lv_bmp_init();
 #endif
 
+#if LV_USE_IMG_ASYNC
+    /*After the decoders to be in front of them*/
+    lv_img_async_init();
+#endif
+
 #if LV_USE_FREETYPE
     /*Init freetype library*/
 #  if LV_FREETYPE_CACHE_SIZE >= 0
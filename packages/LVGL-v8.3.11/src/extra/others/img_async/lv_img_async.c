@@ -0,0 +1,792 @@
+/**
+ * @file lv_img_async.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_img_async.h"
+#if LV_USE_IMG_ASYNC
+
+#include "../../../core/lv_disp.h"
+#include "../../../draw/lv_img_cache.h"
+#include "../../../draw/lv_img_decoder.h"
+#include "../../../misc/lv_gc.h"
+#include "../../../misc/lv_ll.h"
+#include "../../../misc/lv_timer.h"
+#include "../../../widgets/lv_img.h"
+
+#if LV_IMG_ASYNC_USE_RTTHREAD
+    #include <rtthread.h>
+#else
+    #include <pthread.h>
+#endif
+
+#if LV_IMG_CACHE_DEF_SIZE == 0
+    #error "LV_USE_IMG_ASYNC requires the image cache (LV_IMG_CACHE_DEF_SIZE > 0)"
+#endif
+
+#if LV_USE_IMG_ASYNC && LV_MEM_CUSTOM == 0
+    #error "LV_USE_IMG_ASYNC requires a thread-safe lv_mem_alloc (LV_MEM_CUSTOM 1), the built-in heap isn't"
+#endif
+
+/*********************
+ *      DEFINES
+ *********************/
+#define JOB_PRIO_PREFETCH   0
+#define JOB_PRIO_VISIBLE    1
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef enum {
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_DONE,
+    JOB_FAILED,
+    JOB_CANCELLED,
+} job_state_t;
+
+typedef struct {
+    const void * src;               /*Copy of the path or pointer to the variable*/
+    lv_img_src_t src_type;
+    lv_obj_t * scr;                 /*Active screen when the image was requested, NULL for prefetch*/
+    uint32_t seq;                   /*Order of the requests, the newest is decoded first*/
+    uint32_t time_to_open;
+    lv_img_header_t header;         /*Header of the decoded image*/
+    const uint8_t * data;           /*Decoded pixels*/
+    lv_img_decoder_dsc_t dec_dsc;   /*Session of the real decoder if it owns `data`*/
+    uint8_t state;                  /*Protected by the lock*/
+    uint8_t prio;
+    uint8_t cancel : 1;             /*Protected by the lock*/
+    uint8_t own_data : 1;           /*`data` was assembled from lines and has to be freed with `lv_mem_free`*/
+    uint8_t notify : 1;
+} job_t;
+
+typedef struct {
+    const void * src;
+    bool found;
+} invalidate_walk_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static lv_res_t decoder_info(lv_img_decoder_t * decoder, const void * src, lv_img_header_t * header);
+static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc);
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y,
+                                  lv_coord_t len, uint8_t * buf);
+static void decoder_close(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc);
+static lv_img_decoder_t * real_decoder_find(lv_img_decoder_t * start, const void * src, lv_img_header_t * header);
+static bool src_match(const job_t * job, const void * src);
+static job_t * job_find(const void * src);
+static job_t * job_create(const void * src, uint8_t prio);
+static void job_requeue(job_t * job, uint8_t prio);
+static job_t * job_pick(void);
+static lv_res_t job_decode(job_t * job);
+static void job_free_data(job_t * job);
+static void jobs_drop(lv_ll_t * drop_ll);
+static void jobs_cancel(const void * src, lv_obj_t * keep_scr);
+static void scr_change_check(void);
+static void notify_timer_cb(lv_timer_t * t);
+static void invalidate_src(const void * src);
+static lv_obj_tree_walk_res_t invalidate_walk_cb(lv_obj_t * obj, void * user_data);
+static void worker_entry(void);
+static void worker_start(void);
+static void lock(void);
+static void unlock(void);
+static void fs_lock(void);
+static void fs_unlock(void);
+static void worker_signal(void);
+static void worker_wait(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static lv_img_decoder_t * async_decoder;
+static lv_ll_t job_ll;
+static lv_obj_t * last_scr;
+static uint32_t job_seq;
+static bool paused;
+static bool finished;               /*A job was finished since the last notification, protected by the lock*/
+static bool worker_started;
+
+/*The files are opened in the worker thread too, fs_mutex protects the caches of lv_fs*/
+#if LV_IMG_ASYNC_USE_RTTHREAD
+    static struct rt_mutex job_mutex;
+    static struct rt_mutex fs_mutex;
+    static struct rt_semaphore job_sem;
+#else
+    static pthread_mutex_t job_mutex = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_mutex_t fs_mutex = PTHREAD_MUTEX_INITIALIZER;
+    static pthread_cond_t job_cond = PTHREAD_COND_INITIALIZER;
+    static bool job_signaled;
+#endif
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_img_async_init(void)
+{
+    _lv_ll_init(&job_ll, sizeof(job_t));
+
+    /*Created last so it's in front of the other decoders*/
+    async_decoder = lv_img_decoder_create();
+    LV_ASSERT_MALLOC(async_decoder);
+    if(async_decoder == NULL) return;
+    lv_img_decoder_set_info_cb(async_decoder, decoder_info);
+    lv_img_decoder_set_open_cb(async_decoder, decoder_open);
+    lv_img_decoder_set_read_line_cb(async_decoder, decoder_read_line);
+    lv_img_decoder_set_close_cb(async_decoder, decoder_close);
+
+    lv_timer_create(notify_timer_cb, LV_DISP_DEF_REFR_PERIOD, NULL);
+
+#if LV_IMG_ASYNC_USE_RTTHREAD
+    rt_mutex_init(&job_mutex, "lvimg", RT_IPC_FLAG_PRIO);
+    rt_mutex_init(&fs_mutex, "lvfs", RT_IPC_FLAG_PRIO);
+    rt_sem_init(&job_sem, "lvimg", 0, RT_IPC_FLAG_PRIO);
+#endif
+    lv_fs_cache_set_lock_cb(fs_lock, fs_unlock);
+}
+
+lv_res_t lv_img_async_prefetch(const void * src)
+{
+    lv_img_header_t header;
+    if(async_decoder == NULL) return LV_RES_INV;
+    if(decoder_info(async_decoder, src, &header) != LV_RES_OK) return LV_RES_INV;
+
+    lock();
+    job_t * job = job_find(src);
+    if(job == NULL) {
+        job = job_create(src, JOB_PRIO_PREFETCH);
+        if(job) job->scr = NULL;
+    }
+    else if(job->state == JOB_CANCELLED || (job->state == JOB_RUNNING && job->cancel)) {
+        job_requeue(job, JOB_PRIO_PREFETCH);
+        job->scr = NULL;
+    }
+    unlock();
+
+    return job ? LV_RES_OK : LV_RES_INV;
+}
+
+void lv_img_async_cancel(const void * src)
+{
+    if(src == NULL) return;
+    jobs_cancel(src, NULL);
+}
+
+void lv_img_async_cancel_all(void)
+{
+    jobs_cancel(NULL, NULL);
+}
+
+void lv_img_async_set_paused(bool en)
+{
+    lock();
+    paused = en;
+    if(!paused) worker_signal();
+    unlock();
+}
+
+uint32_t lv_img_async_get_pending_cnt(void)
+{
+    uint32_t cnt = 0;
+    job_t * job;
+
+    lock();
+    _LV_LL_READ(&job_ll, job) {
+        if(job->state == JOB_QUEUED || (job->state == JOB_RUNNING && !job->cancel)) cnt++;
+    }
+    unlock();
+
+    return cnt;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Accept the image if a non built-in decoder can open it
+ */
+static lv_res_t decoder_info(lv_img_decoder_t * decoder, const void * src, lv_img_header_t * header)
+{
+    lv_img_src_t src_type = lv_img_src_get_type(src);
+    if(src_type != LV_IMG_SRC_FILE && src_type != LV_IMG_SRC_VARIABLE) return LV_RES_INV;
+
+    return real_decoder_find(decoder, src, header) ? LV_RES_OK : LV_RES_INV;
+}
+
+/**
+ * Hand over the decoded image if it's ready, else queue it and open a placeholder
+ */
+static lv_res_t decoder_open(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
+{
+    LV_UNUSED(decoder);
+
+    /*Animated images decode their frames on their own*/
+    if(dsc->frame_id != 0) return LV_RES_INV;
+
+    lock();
+    job_t * job = job_find(dsc->src);
+    if(job == NULL) {
+        job = job_create(dsc->src, JOB_PRIO_VISIBLE);
+        if(job == NULL) {
+            unlock();
+            return LV_RES_INV;  /*Let the other decoders open it synchronously*/
+        }
+    }
+    else if(job->state == JOB_DONE) {
+        _lv_ll_remove(&job_ll, job);
+        unlock();
+
+        /*From now the job belongs to the cache entry and it's freed on close*/
+        dsc->header = job->header;
+        dsc->img_data = job->data;
+        dsc->time_to_open = job->time_to_open;
+        dsc->user_data = job;
+        return LV_RES_OK;
+    }
+    else if(job->state == JOB_FAILED) {
+        unlock();
+        return LV_RES_INV;
+    }
+    else {
+        job_requeue(job, JOB_PRIO_VISIBLE);
+    }
+    unlock();
+
+    /*Placeholder*/
+    dsc->img_data = NULL;
+    dsc->user_data = NULL;
+    return LV_RES_OK;
+}
+
+/**
+ * Draw the placeholder
+ */
+static lv_res_t decoder_read_line(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc, lv_coord_t x, lv_coord_t y,
+                                  lv_coord_t len, uint8_t * buf)
+{
+    LV_UNUSED(decoder);
+    LV_UNUSED(x);
+    LV_UNUSED(y);
+
+    lv_color_t c = LV_IMG_ASYNC_PLACEHOLDER_COLOR;
+    lv_coord_t i;
+    if(lv_img_cf_has_alpha(dsc->header.cf)) {
+        for(i = 0; i < len; i++) {
+            lv_memcpy_small(buf, &c, sizeof(lv_color_t));
+            buf[LV_IMG_PX_SIZE_ALPHA_BYTE - 1] = LV_IMG_ASYNC_PLACEHOLDER_OPA;
+            buf += LV_IMG_PX_SIZE_ALPHA_BYTE;
+        }
+    }
+    else {
+        lv_color_t * buf_c = (lv_color_t *)buf;
+        for(i = 0; i < len; i++) buf_c[i] = c;
+    }
+
+    return LV_RES_OK;
+}
+
+static void decoder_close(lv_img_decoder_t * decoder, lv_img_decoder_dsc_t * dsc)
+{
+    LV_UNUSED(decoder);
+
+    /*Placeholders have no job*/
+    job_t * job = dsc->user_data;
+    if(job == NULL) return;
+
+    job_free_data(job);
+    if(job->src_type == LV_IMG_SRC_FILE) lv_mem_free((void *)job->src);
+    lv_mem_free(job);
+    dsc->user_data = NULL;
+}
+
+/**
+ * Find a decoder, after `start` in the decoder list, which can open the image.
+ * The built-in decoder is skipped: its images are either raw already or read line by line from the file.
+ */
+static lv_img_decoder_t * real_decoder_find(lv_img_decoder_t * start, const void * src, lv_img_header_t * header)
+{
+    lv_img_decoder_t * d = start ? _lv_ll_get_next(&LV_GC_ROOT(_lv_img_decoder_ll), start) :
+                           _lv_ll_get_head(&LV_GC_ROOT(_lv_img_decoder_ll));
+    while(d) {
+        if(d != async_decoder && d->info_cb && d->open_cb && d->info_cb != lv_img_decoder_built_in_info) {
+            if(d->info_cb(d, src, header) == LV_RES_OK) return d;
+        }
+        d = _lv_ll_get_next(&LV_GC_ROOT(_lv_img_decoder_ll), d);
+    }
+
+    return NULL;
+}
+
+static bool src_match(const job_t * job, const void * src)
+{
+    if(job->src_type == LV_IMG_SRC_FILE) {
+        return lv_img_src_get_type(src) == LV_IMG_SRC_FILE && strcmp(job->src, src) == 0;
+    }
+
+    return job->src == src;
+}
+
+static job_t * job_find(const void * src)
+{
+    job_t * job;
+    _LV_LL_READ(&job_ll, job) {
+        if(src_match(job, src)) return job;
+    }
+
+    return NULL;
+}
+
+/**
+ * Create and queue a job. Called in the LVGL thread with the lock held.
+ */
+static job_t * job_create(const void * src, uint8_t prio)
+{
+    job_t * job = _lv_ll_ins_tail(&job_ll);
+    LV_ASSERT_MALLOC(job);
+    if(job == NULL) return NULL;
+    lv_memset_00(job, sizeof(job_t));
+
+    job->src_type = lv_img_src_get_type(src);
+    if(job->src_type == LV_IMG_SRC_FILE) {
+        size_t fnlen = strlen(src);
+        char * fn = lv_mem_alloc(fnlen + 1);
+        LV_ASSERT_MALLOC(fn);
+        if(fn == NULL) {
+            _lv_ll_remove(&job_ll, job);
+            lv_mem_free(job);
+            return NULL;
+        }
+        strcpy(fn, src);
+        job->src = fn;
+    }
+    else {
+        job->src = src;
+    }
+
+    job->state = JOB_QUEUED;
+    job->prio = prio;
+    job->scr = lv_scr_act();
+    job->seq = ++job_seq;
+
+    if(!worker_started) worker_start();
+    worker_signal();
+
+    return job;
+}
+
+/**
+ * Request a job again, e.g. it was cancelled but the image is shown again. Called with the lock held.
+ */
+static void job_requeue(job_t * job, uint8_t prio)
+{
+    if(job->state == JOB_CANCELLED) {
+        job->state = JOB_QUEUED;
+        worker_signal();
+    }
+    job->cancel = 0;
+    if(job->prio < prio) job->prio = prio;
+    job->scr = lv_scr_act();
+    job->seq = ++job_seq;
+}
+
+/**
+ * Select the next job: the visible images first, the latest requested first. Called with the lock held.
+ */
+static job_t * job_pick(void)
+{
+    job_t * best = NULL;
+    job_t * job;
+    _LV_LL_READ(&job_ll, job) {
+        if(job->state != JOB_QUEUED) continue;
+        if(best == NULL || job->prio > best->prio || (job->prio == best->prio && job->seq > best->seq)) best = job;
+    }
+
+    return best;
+}
+
+/**
+ * Decode an image with the real decoder. Called in the worker thread without the lock.
+ */
+static lv_res_t job_decode(job_t * job)
+{
+    uint32_t t_start = lv_tick_get();
+    lv_img_decoder_dsc_t * dsc = &job->dec_dsc;
+    lv_memset_00(dsc, sizeof(lv_img_decoder_dsc_t));
+    dsc->src = job->src;
+    dsc->src_type = job->src_type;
+    dsc->color = lv_color_black();
+
+    lv_img_decoder_t * d = NULL;
+    while((d = real_decoder_find(d, job->src, &dsc->header)) != NULL) {
+        dsc->decoder = d;
+        if(d->open_cb(d, dsc) == LV_RES_OK) break;
+        dsc->img_data = NULL;
+        dsc->user_data = NULL;
+        dsc->error_msg = NULL;
+    }
+    if(d == NULL) return LV_RES_INV;
+
+    job->header = dsc->header;
+    if(dsc->img_data) {
+        /*The whole image is decoded, keep the session open*/
+        job->data = dsc->img_data;
+        job->own_data = 0;
+    }
+    else {
+        /*Assemble the image from lines*/
+        lv_img_cf_t cf = dsc->header.cf;
+        bool chroma_keyed = lv_img_cf_is_chroma_keyed(cf);
+        bool alpha = cf == LV_IMG_CF_TRUE_COLOR_ALPHA || cf == LV_IMG_CF_RAW_ALPHA;
+        if(d->read_line_cb == NULL || (!alpha && !chroma_keyed && cf != LV_IMG_CF_TRUE_COLOR && cf != LV_IMG_CF_RAW)) {
+            LV_LOG_WARN("unsupported color format %d", cf);
+            d->close_cb(d, dsc);
+            return LV_RES_INV;
+        }
+
+        uint32_t line_size = (uint32_t)dsc->header.w * (alpha ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t));
+        uint8_t * buf = lv_mem_alloc(line_size * dsc->header.h);
+        if(buf == NULL) {
+            LV_LOG_WARN("out of memory");
+            d->close_cb(d, dsc);
+            return LV_RES_INV;
+        }
+
+        lv_res_t res = LV_RES_OK;
+        lv_coord_t y;
+        for(y = 0; y < dsc->header.h && res == LV_RES_OK; y++) {
+            lock();
+            bool cancel = job->cancel;
+            unlock();
+            if(cancel) res = LV_RES_INV;
+            else res = d->read_line_cb(d, dsc, 0, y, dsc->header.w, buf + y * line_size);
+        }
+        d->close_cb(d, dsc);
+        if(res != LV_RES_OK) {
+            lv_mem_free(buf);
+            return LV_RES_INV;
+        }
+
+        if(alpha) job->header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+        else if(chroma_keyed) job->header.cf = LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED;
+        else job->header.cf = LV_IMG_CF_TRUE_COLOR;
+        job->data = buf;
+        job->own_data = 1;
+    }
+
+    job->time_to_open = lv_tick_elaps(t_start);
+    return LV_RES_OK;
+}
+
+static void job_free_data(job_t * job)
+{
+    if(job->data == NULL) return;
+
+    if(job->own_data) {
+        lv_mem_free((void *)job->data);
+    }
+    else if(job->dec_dsc.decoder && job->dec_dsc.decoder->close_cb) {
+        job->dec_dsc.decoder->close_cb(job->dec_dsc.decoder, &job->dec_dsc);
+    }
+    job->data = NULL;
+}
+
+/**
+ * Free the jobs moved to `drop_ll`. Called in the LVGL thread without the lock.
+ */
+static void jobs_drop(lv_ll_t * drop_ll)
+{
+    job_t * job = _lv_ll_get_head(drop_ll);
+    while(job) {
+        job_t * next = _lv_ll_get_next(drop_ll, job);
+        /*Close the placeholders so the image is requested again when it's drawn*/
+        lv_img_cache_invalidate_src(job->src);
+        job_free_data(job);
+        if(job->src_type == LV_IMG_SRC_FILE) lv_mem_free((void *)job->src);
+        _lv_ll_remove(drop_ll, job);
+        lv_mem_free(job);
+        job = next;
+    }
+}
+
+/**
+ * Cancel the jobs of `src` (or all if NULL) which don't belong to `keep_scr`.
+ * Prefetched jobs are kept if `keep_scr` is set.
+ */
+static void jobs_cancel(const void * src, lv_obj_t * keep_scr)
+{
+    lv_ll_t drop_ll;
+    _lv_ll_init(&drop_ll, sizeof(job_t));
+
+    lock();
+    job_t * job = _lv_ll_get_head(&job_ll);
+    while(job) {
+        job_t * next = _lv_ll_get_next(&job_ll, job);
+        bool match;
+        if(src) match = src_match(job, src);
+        else if(keep_scr) match = job->scr != NULL && job->scr != keep_scr;
+        else match = true;
+
+        if(match) {
+            /*The worker drops the result of a running job*/
+            if(job->state == JOB_RUNNING) job->cancel = 1;
+            else if(job->state != JOB_CANCELLED) _lv_ll_chg_list(&job_ll, &drop_ll, job, false);
+        }
+        job = next;
+    }
+    unlock();
+
+    jobs_drop(&drop_ll);
+}
+
+/**
+ * Cancel the images of the previous screen when the active screen changes
+ */
+static void scr_change_check(void)
+{
+    lv_disp_t * disp = lv_disp_get_default();
+    if(disp == NULL) return;
+
+    lv_obj_t * scr = lv_disp_get_scr_act(disp);
+    if(scr == last_scr) return;
+
+    last_scr = scr;
+    jobs_cancel(NULL, scr);
+}
+
+/**
+ * Refresh the images whose decoding was finished. Runs in the LVGL thread.
+ */
+static void notify_timer_cb(lv_timer_t * t)
+{
+    LV_UNUSED(t);
+
+    scr_change_check();
+
+    lv_ll_t drop_ll;
+    _lv_ll_init(&drop_ll, sizeof(job_t));
+
+    lock();
+    if(!finished) {
+        unlock();
+        return;
+    }
+    finished = false;
+
+    job_t * job = _lv_ll_get_head(&job_ll);
+    while(job) {
+        job_t * next = _lv_ll_get_next(&job_ll, job);
+        if(job->state == JOB_CANCELLED) {
+            _lv_ll_chg_list(&job_ll, &drop_ll, job, false);
+        }
+        else if(job->state == JOB_DONE || job->state == JOB_FAILED) {
+            job->notify = 1;
+        }
+        job = next;
+    }
+    unlock();
+
+    jobs_drop(&drop_ll);
+
+    /*Only the LVGL thread adds or removes jobs so the list can be read without the lock*/
+    _LV_LL_READ(&job_ll, job) {
+        if(job->notify) {
+            job->notify = 0;
+            invalidate_src(job->src);
+        }
+    }
+}
+
+/**
+ * Close the placeholder and redraw the widgets showing the image
+ */
+static void invalidate_src(const void * src)
+{
+    lv_img_cache_invalidate_src(src);
+
+    invalidate_walk_t w;
+    w.src = src;
+    w.found = false;
+    lv_disp_t * disp = lv_disp_get_next(NULL);
+    while(disp) {
+        lv_obj_tree_walk(lv_disp_get_scr_act(disp), invalidate_walk_cb, &w);
+        lv_obj_tree_walk(lv_disp_get_layer_top(disp), invalidate_walk_cb, &w);
+        disp = lv_disp_get_next(disp);
+    }
+
+    /*The image is used by a widget which is not known here*/
+    if(!w.found) lv_obj_invalidate(lv_scr_act());
+}
+
+static lv_obj_tree_walk_res_t invalidate_walk_cb(lv_obj_t * obj, void * user_data)
+{
+    invalidate_walk_t * w = user_data;
+
+    const void * obj_src = NULL;
+#if LV_USE_IMG
+    if(lv_obj_check_type(obj, &lv_img_class)) obj_src = lv_img_get_src(obj);
+#endif
+    if(obj_src == NULL) obj_src = lv_obj_get_style_bg_img_src(obj, LV_PART_MAIN);
+    if(obj_src == NULL) return LV_OBJ_TREE_WALK_NEXT;
+
+    bool match;
+    if(lv_img_src_get_type(w->src) == LV_IMG_SRC_FILE) {
+        match = lv_img_src_get_type(obj_src) == LV_IMG_SRC_FILE && strcmp(w->src, obj_src) == 0;
+    }
+    else {
+        match = w->src == obj_src;
+    }
+
+    /*Continue as other widgets can show the same image*/
+    if(match) {
+        lv_obj_invalidate(obj);
+        w->found = true;
+    }
+
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static void worker_entry(void)
+{
+    lock();
+    while(1) {
+        job_t * job = paused ? NULL : job_pick();
+        if(job == NULL) {
+            worker_wait();
+            continue;
+        }
+
+        job->state = JOB_RUNNING;
+        unlock();
+
+        lv_res_t res = job_decode(job);
+
+        lock();
+        if(job->cancel) {
+            if(res == LV_RES_OK) job_free_data(job);
+            job->state = JOB_CANCELLED;
+            job->cancel = 0;
+        }
+        else {
+            job->state = res == LV_RES_OK ? JOB_DONE : JOB_FAILED;
+        }
+        finished = true;
+    }
+}
+
+#if LV_IMG_ASYNC_USE_RTTHREAD
+
+static void worker_thread(void * param)
+{
+    LV_UNUSED(param);
+    worker_entry();
+}
+
+static void worker_start(void)
+{
+    rt_thread_t tid = rt_thread_create("lvimg", worker_thread, RT_NULL, LV_IMG_ASYNC_STACK_SIZE,
+                                       LV_IMG_ASYNC_THREAD_PRIO, 10);
+    if(tid == RT_NULL) {
+        LV_LOG_ERROR("can't create the decoder thread");
+        return;
+    }
+    rt_thread_startup(tid);
+    worker_started = true;
+}
+
+static void lock(void)
+{
+    rt_mutex_take(&job_mutex, RT_WAITING_FOREVER);
+}
+
+static void unlock(void)
+{
+    rt_mutex_release(&job_mutex);
+}
+
+static void fs_lock(void)
+{
+    rt_mutex_take(&fs_mutex, RT_WAITING_FOREVER);
+}
+
+static void fs_unlock(void)
+{
+    rt_mutex_release(&fs_mutex);
+}
+
+static void worker_signal(void)
+{
+    rt_sem_release(&job_sem);
+}
+
+static void worker_wait(void)
+{
+    unlock();
+    rt_sem_take(&job_sem, RT_WAITING_FOREVER);
+    lock();
+}
+
+#else /*pthread*/
+
+static void * worker_thread(void * param)
+{
+    LV_UNUSED(param);
+    worker_entry();
+    return NULL;
+}
+
+static void worker_start(void)
+{
+    pthread_t tid;
+    if(pthread_create(&tid, NULL, worker_thread, NULL) != 0) {
+        LV_LOG_ERROR("can't create the decoder thread");
+        return;
+    }
+    pthread_detach(tid);
+    worker_started = true;
+}
+
+static void lock(void)
+{
+    pthread_mutex_lock(&job_mutex);
+}
+
+static void unlock(void)
+{
+    pthread_mutex_unlock(&job_mutex);
+}
+
+static void fs_lock(void)
+{
+    pthread_mutex_lock(&fs_mutex);
+}
+
+static void fs_unlock(void)
+{
+    pthread_mutex_unlock(&fs_mutex);
+}
+
+static void worker_signal(void)
+{
+    job_signaled = true;
+    pthread_cond_signal(&job_cond);
+}
+
+static void worker_wait(void)
+{
+    while(!job_signaled) pthread_cond_wait(&job_cond, &job_mutex);
+    job_signaled = false;
+}
+
+#endif /*LV_IMG_ASYNC_USE_RTTHREAD*/
+
+#endif /*LV_USE_IMG_ASYNC*/
@@ -0,0 +1,91 @@
+/**
+ * @file lv_img_async.h
+ *
+ */
+
+#ifndef LV_IMG_ASYNC_H
+#define LV_IMG_ASYNC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../../lv_conf_internal.h"
+#include "../../../misc/lv_types.h"
+
+#if LV_USE_IMG_ASYNC
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Register the asynchronous decoder in front of the other image decoders.
+ * Images which would be opened by a non built-in decoder (PNG, SJPG, BMP, ...) are decoded
+ * in a worker thread. Until they are ready a placeholder is drawn, then the image cache entry
+ * is invalidated and the widgets showing the image are redrawn.
+ * Called by `lv_init()`, the worker thread is started on the first request.
+ * @note the decoders allocate memory in the worker thread so `lv_mem_alloc` has to be thread-safe:
+ *       `LV_MEM_CUSTOM 1` with the system's heap
+ */
+void lv_img_async_init(void);
+
+/**
+ * Queue an image to be decoded with low priority, before it's shown.
+ * Images which are being drawn are always decoded first.
+ * @param src   the image source: a file path or pointer to an `lv_img_dsc_t` variable
+ * @return      LV_RES_OK: queued or already decoded; LV_RES_INV: the image can't be decoded asynchronously
+ */
+lv_res_t lv_img_async_prefetch(const void * src);
+
+/**
+ * Cancel the decoding of an image. The result of a decoding in progress is dropped.
+ * Images which are already in the image cache are not affected.
+ * @param src   the image source
+ */
+void lv_img_async_cancel(const void * src);
+
+/**
+ * Cancel all queued and running decodings.
+ * It's done automatically for the images of the previous screen when the active screen changes.
+ */
+void lv_img_async_cancel_all(void);
+
+/**
+ * Pause or resume the worker thread. A decoding in progress is finished.
+ * Useful to leave the CPU to animations.
+ * @param en    true: pause; false: resume
+ */
+void lv_img_async_set_paused(bool en);
+
+/**
+ * Get the number of queued and running decodings.
+ * @return      number of pending jobs
+ */
+uint32_t lv_img_async_get_pending_cnt(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#endif /*LV_USE_IMG_ASYNC*/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_IMG_ASYNC_H*/
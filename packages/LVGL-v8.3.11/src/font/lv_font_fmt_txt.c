@@ -36,13 +36,16 @@ static int8_t get_kern_value(const lv_font_t * font, uint32_t gid_left, uint32_t
 static int32_t unicode_list_compare(const void * ref, const void * element);
 static int32_t kern_pair_8_compare(const void * ref, const void * element);
 static int32_t kern_pair_16_compare(const void * ref, const void * element);
+static uint8_t * get_glyph_buf(uint32_t size);
+static void shift_bitmap(const uint8_t * in, uint8_t * out, uint32_t bit_num, uint8_t bit_ofs);
 
 #if LV_USE_FONT_COMPRESSED
-    static void decompress(const uint8_t * in, uint8_t * out, lv_coord_t w, lv_coord_t h, uint8_t bpp, bool prefilter);
+    static void decompress(const uint8_t * in, uint8_t bit_ofs, uint8_t * out, lv_coord_t w, lv_coord_t h, uint8_t bpp,
+                           bool prefilter);
     static inline void decompress_line(uint8_t * out, lv_coord_t w);
     static inline uint8_t get_bits(const uint8_t * in, uint32_t bit_pos, uint8_t len);
     static inline void bits_write(uint8_t * out, uint32_t bit_pos, uint8_t val, uint8_t len);
-    static inline void rle_init(const uint8_t * in,  uint8_t bpp);
+    static inline void rle_init(const uint8_t * in, uint8_t bit_ofs, uint8_t bpp);
     static inline uint8_t rle_next(void);
 #endif /*LV_USE_FONT_COMPRESSED*/
 
@@ -51,6 +54,7 @@ static int32_t kern_pair_16_compare(const void * ref, const void * element);
  **********************/
 #if LV_USE_FONT_COMPRESSED
     static uint32_t rle_rdp;
+    static uint8_t rle_ofs;
     static const uint8_t * rle_in;
     static uint8_t rle_bpp;
     static uint8_t rle_prev_v;
@@ -86,15 +90,23 @@ const uint8_t * lv_font_get_bitmap_fmt_txt(const lv_font_t * font, uint32_t unic
 
     const lv_font_fmt_txt_glyph_dsc_t * gdsc = &fdsc->glyph_dsc[gid];
 
-    if(fdsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN) {
+    if(fdsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN && fdsc->bitmap_bit_ofs == 0) {
         return &fdsc->glyph_bitmap[gdsc->bitmap_index];
     }
+    /*Handle the bitmap which doesn't start on a byte boundary*/
+    else if(fdsc->bitmap_format == LV_FONT_FMT_TXT_PLAIN) {
+        uint32_t gsize = gdsc->box_w * gdsc->box_h;
+        if(gsize == 0) return NULL;
+
+        uint8_t * buf = get_glyph_buf((gsize * fdsc->bpp + 7) >> 3);
+        if(buf == NULL) return NULL;
+
+        shift_bitmap(&fdsc->glyph_bitmap[gdsc->bitmap_index], buf, gsize * fdsc->bpp, fdsc->bitmap_bit_ofs);
+        return buf;
+    }
     /*Handle compressed bitmap*/
     else {
 #if LV_USE_FONT_COMPRESSED
-        static size_t last_buf_size = 0;
-        if(LV_GC_ROOT(_lv_font_decompr_buf) == NULL) last_buf_size = 0;
-
         uint32_t gsize = gdsc->box_w * gdsc->box_h;
         if(gsize == 0) return NULL;
 
@@ -115,18 +127,13 @@ const uint8_t * lv_font_get_bitmap_fmt_txt(const lv_font_t * font, uint32_t unic
                 break;
         }
 
-        if(last_buf_size < buf_size) {
-            uint8_t * tmp = lv_mem_realloc(LV_GC_ROOT(_lv_font_decompr_buf), buf_size);
-            LV_ASSERT_MALLOC(tmp);
-            if(tmp == NULL) return NULL;
-            LV_GC_ROOT(_lv_font_decompr_buf) = tmp;
-            last_buf_size = buf_size;
-        }
+        uint8_t * buf = get_glyph_buf(buf_size);
+        if(buf == NULL) return NULL;
 
         bool prefilter = fdsc->bitmap_format == LV_FONT_FMT_TXT_COMPRESSED ? true : false;
-        decompress(&fdsc->glyph_bitmap[gdsc->bitmap_index], LV_GC_ROOT(_lv_font_decompr_buf), gdsc->box_w, gdsc->box_h,
+        decompress(&fdsc->glyph_bitmap[gdsc->bitmap_index], fdsc->bitmap_bit_ofs, buf, gdsc->box_w, gdsc->box_h,
                    (uint8_t)fdsc->bpp, prefilter);
-        return LV_GC_ROOT(_lv_font_decompr_buf);
+        return buf;
 #else /*!LV_USE_FONT_COMPRESSED*/
         LV_LOG_WARN("Compressed fonts is used but LV_USE_FONT_COMPRESSED is not enabled in lv_conf.h");
         return NULL;
@@ -194,18 +201,55 @@ bool lv_font_get_glyph_dsc_fmt_txt(const lv_font_t * font, lv_font_glyph_dsc_t *
  */
 void _lv_font_clean_up_fmt_txt(void)
 {
-#if LV_USE_FONT_COMPRESSED
     if(LV_GC_ROOT(_lv_font_decompr_buf)) {
         lv_mem_free(LV_GC_ROOT(_lv_font_decompr_buf));
         LV_GC_ROOT(_lv_font_decompr_buf) = NULL;
     }
-#endif
 }
 
 /**********************
  *   STATIC FUNCTIONS
  **********************/
 
+/**
+ * Get the buffer of the last glyph returned from a decompressed or shifted bitmap
+ * @param size the required size in bytes
+ * @return the buffer or NULL if it can't be allocated
+ */
+static uint8_t * get_glyph_buf(uint32_t size)
+{
+    static size_t last_buf_size = 0;
+    if(LV_GC_ROOT(_lv_font_decompr_buf) == NULL) last_buf_size = 0;
+
+    if(last_buf_size < size) {
+        uint8_t * tmp = lv_mem_realloc(LV_GC_ROOT(_lv_font_decompr_buf), size);
+        LV_ASSERT_MALLOC(tmp);
+        if(tmp == NULL) return NULL;
+        LV_GC_ROOT(_lv_font_decompr_buf) = tmp;
+        last_buf_size = size;
+    }
+
+    return LV_GC_ROOT(_lv_font_decompr_buf);
+}
+
+/**
+ * Copy a bitmap which starts inside a byte to the beginning of a buffer
+ * @param in the first byte of the bitmap
+ * @param out buffer to store the result
+ * @param bit_num number of bits in the bitmap
+ * @param bit_ofs the bitmap starts this many bits after the MSB of `in[0]` (1..7)
+ */
+static void shift_bitmap(const uint8_t * in, uint8_t * out, uint32_t bit_num, uint8_t bit_ofs)
+{
+    uint32_t out_len = (bit_num + 7) >> 3;
+    uint32_t in_len = (bit_num + bit_ofs + 7) >> 3;
+    uint32_t i;
+    for(i = 0; i < out_len; i++) {
+        uint8_t next = i + 1 < in_len ? in[i + 1] : 0;
+        out[i] = (uint8_t)((in[i] << bit_ofs) | (next >> (8 - bit_ofs)));
+    }
+}
+
 static uint32_t get_glyph_dsc_id(const lv_font_t * font, uint32_t letter)
 {
     if(letter == '\0') return 0;
@@ -348,18 +392,20 @@ static int32_t kern_pair_16_compare(const void * ref, const void * element)
 /**
  * The compress a glyph's bitmap
  * @param in the compressed bitmap
+ * @param bit_ofs the bitmap starts this many bits after the MSB of `in[0]`
  * @param out buffer to store the result
  * @param px_num number of pixels in the glyph (width * height)
  * @param bpp bit per pixel (bpp = 3 will be converted to bpp = 4)
  * @param prefilter true: the lines are XORed
  */
-static void decompress(const uint8_t * in, uint8_t * out, lv_coord_t w, lv_coord_t h, uint8_t bpp, bool prefilter)
+static void decompress(const uint8_t * in, uint8_t bit_ofs, uint8_t * out, lv_coord_t w, lv_coord_t h, uint8_t bpp,
+                       bool prefilter)
 {
     uint32_t wrp = 0;
     uint8_t wr_size = bpp;
     if(bpp == 3) wr_size = 4;
 
-    rle_init(in, bpp);
+    rle_init(in, bit_ofs, bpp);
 
     uint8_t * line_buf1 = lv_mem_buf_get(w);
 
@@ -507,12 +553,13 @@ static inline void bits_write(uint8_t * out, uint32_t bit_pos, uint8_t val, uint
     out[byte_pos] |= (val << bit_pos);
 }
 
-static inline void rle_init(const uint8_t * in,  uint8_t bpp)
+static inline void rle_init(const uint8_t * in, uint8_t bit_ofs, uint8_t bpp)
 {
     rle_in = in;
     rle_bpp = bpp;
     rle_state = RLE_STATE_SINGLE;
-    rle_rdp = 0;
+    rle_rdp = bit_ofs;
+    rle_ofs = bit_ofs;
     rle_prev_v = 0;
     rle_cnt = 0;
 }
@@ -524,7 +571,7 @@ static inline uint8_t rle_next(void)
 
     if(rle_state == RLE_STATE_SINGLE) {
         ret = get_bits(rle_in, rle_rdp, rle_bpp);
-        if(rle_rdp != 0 && rle_prev_v == ret) {
+        if(rle_rdp != rle_ofs && rle_prev_v == ret) {
             rle_cnt = 0;
             rle_state = RLE_STATE_REPEATE;
         }
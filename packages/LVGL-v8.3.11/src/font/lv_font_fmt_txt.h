@@ -195,6 +195,10 @@ typedef struct {
 
     /*Cache the last letter and is glyph id*/
     lv_font_fmt_txt_glyph_cache_t * cache;
+
+    /*The bitmaps start this many bits after `glyph_bitmap[bitmap_index]`.
+     *Used by fonts loaded with `lv_font_load()` which use the bitmaps in place in a memory mapped file*/
+    uint8_t bitmap_bit_ofs;
 } lv_font_fmt_txt_dsc_t;
 
 /**********************
@@ -19,10 +19,22 @@
  **********************/
 typedef struct {
     lv_fs_file_t * fp;
+    const uint8_t * data;   /*Read from here instead of `fp` if not NULL*/
     int8_t bit_pos;
     uint8_t byte_value;
 } bit_iterator_t;
 
+typedef struct {
+    lv_fs_file_t * fp;
+    const uint8_t * map;    /*The content of the file if it's memory mapped*/
+    uint32_t map_size;
+} font_file_t;
+
+typedef struct {
+    lv_font_fmt_txt_dsc_t dsc;
+    bool bitmap_mapped;     /*`glyph_bitmap` points into the memory mapped file*/
+} font_dsc_bin_t;
+
 typedef struct font_header_bin {
     uint32_t version;
     uint16_t tables_count;
@@ -64,7 +76,7 @@ typedef struct cmap_table_bin {
  *  STATIC PROTOTYPES
  **********************/
 static bit_iterator_t init_bit_iterator(lv_fs_file_t * fp);
-static bool lvgl_load_font(lv_fs_file_t * fp, lv_font_t * font);
+static bool lvgl_load_font(font_file_t * ff, lv_font_t * font);
 int32_t load_kern(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc, uint8_t format, uint32_t start);
 
 static int read_bits_signed(bit_iterator_t * it, int n_bits, lv_fs_res_t * res);
@@ -79,7 +91,8 @@ static unsigned int read_bits(bit_iterator_t * it, int n_bits, lv_fs_res_t * res
  **********************/
 
 /**
- * Loads a `lv_font_t` object from a binary font file
+ * Loads a `lv_font_t` object from a binary font file.
+ * If the drive can map the file (see `lv_fs_map()`) the glyph bitmaps are used in place.
  * @param font_name filename where the font file is located
  * @return a pointer to the font or NULL in case of error
  */
@@ -90,10 +103,15 @@ lv_font_t * lv_font_load(const char * font_name)
     if(res != LV_FS_RES_OK)
         return NULL;
 
+    font_file_t ff;
+    ff.fp = &file;
+    ff.map_size = 0;
+    ff.map = lv_fs_map(&file, &ff.map_size);
+
     lv_font_t * font = lv_mem_alloc(sizeof(lv_font_t));
     if(font) {
         memset(font, 0, sizeof(lv_font_t));
-        if(!lvgl_load_font(&file, font)) {
+        if(!lvgl_load_font(&ff, font)) {
             LV_LOG_WARN("Error loading font file: %s\n", font_name);
             /*
             * When `lvgl_load_font` fails it can leak some pointers.
@@ -166,7 +184,7 @@ void lv_font_free(lv_font_t * font)
                 lv_mem_free(cmaps);
             }
 
-            if(NULL != dsc->glyph_bitmap) {
+            if(NULL != dsc->glyph_bitmap && !((font_dsc_bin_t *)dsc)->bitmap_mapped) {
                 lv_mem_free((void *)dsc->glyph_bitmap);
             }
             if(NULL != dsc->glyph_dsc) {
@@ -186,6 +204,7 @@ static bit_iterator_t init_bit_iterator(lv_fs_file_t * fp)
 {
     bit_iterator_t it;
     it.fp = fp;
+    it.data = NULL;
     it.bit_pos = -1;
     it.byte_value = 0;
     return it;
@@ -200,9 +219,14 @@ static unsigned int read_bits(bit_iterator_t * it, int n_bits, lv_fs_res_t * res
 
         if(it->bit_pos < 0) {
             it->bit_pos = 7;
-            *res = lv_fs_read(it->fp, &(it->byte_value), 1, NULL);
-            if(*res != LV_FS_RES_OK) {
-                return 0;
+            if(it->data) {
+                it->byte_value = *it->data++;
+            }
+            else {
+                *res = lv_fs_read(it->fp, &(it->byte_value), 1, NULL);
+                if(*res != LV_FS_RES_OK) {
+                    return 0;
+                }
             }
         }
         int8_t bit = (it->byte_value & 0x80) ? 1 : 0;
@@ -335,14 +359,22 @@ static int32_t load_cmaps(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc, u
     return success ? cmaps_length : -1;
 }
 
-static int32_t load_glyph(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc,
+static int32_t load_glyph(font_file_t * ff, lv_font_fmt_txt_dsc_t * font_dsc,
                           uint32_t start, uint32_t * glyph_offset, uint32_t loca_count, font_header_bin_t * header)
 {
+    lv_fs_file_t * fp = ff->fp;
     int32_t glyph_length = read_label(fp, start, "glyf");
     if(glyph_length < 0) {
         return -1;
     }
 
+    /*Use the bitmaps in place if the glyph table is in memory*/
+    const uint8_t * map = ff->map;
+    if(map && (ff->map_size < start || ff->map_size - start < (uint32_t)glyph_length)) {
+        map = NULL;
+    }
+    uint32_t header_bits = header->advance_width_bits + 2 * header->xy_bits + 2 * header->wh_bits;
+
     lv_font_fmt_txt_glyph_dsc_t * glyph_dsc = (lv_font_fmt_txt_glyph_dsc_t *)
                                               lv_mem_alloc(loca_count * sizeof(lv_font_fmt_txt_glyph_dsc_t));
 
@@ -355,13 +387,22 @@ static int32_t load_glyph(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc,
     for(unsigned int i = 0; i < loca_count; ++i) {
         lv_font_fmt_txt_glyph_dsc_t * gdsc = &glyph_dsc[i];
 
-        lv_fs_res_t res = lv_fs_seek(fp, start + glyph_offset[i], LV_FS_SEEK_SET);
-        if(res != LV_FS_RES_OK) {
-            return -1;
-        }
-
+        lv_fs_res_t res = LV_FS_RES_OK;
         bit_iterator_t bit_it = init_bit_iterator(fp);
 
+        if(map) {
+            if(glyph_offset[i] + (header_bits + 7) / 8 > (uint32_t)glyph_length) {
+                return -1;
+            }
+            bit_it.data = map + start + glyph_offset[i];
+        }
+        else {
+            res = lv_fs_seek(fp, start + glyph_offset[i], LV_FS_SEEK_SET);
+            if(res != LV_FS_RES_OK) {
+                return -1;
+            }
+        }
+
         if(header->advance_width_bits == 0) {
             gdsc->adv_w = header->default_advance_width;
         }
@@ -408,12 +449,25 @@ static int32_t load_glyph(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc,
             gdsc->ofs_y = 0;
         }
 
+        if(map) {
+            /*The bitmap follows the header of the glyph*/
+            gdsc->bitmap_index = glyph_offset[i] + nbits / 8;
+            continue;
+        }
+
         gdsc->bitmap_index = cur_bmp_size;
         if(gdsc->box_w * gdsc->box_h != 0) {
             cur_bmp_size += bmp_size;
         }
     }
 
+    if(map) {
+        font_dsc->glyph_bitmap = map + start;
+        font_dsc->bitmap_bit_ofs = header_bits % 8;
+        ((font_dsc_bin_t *)font_dsc)->bitmap_mapped = true;
+        return glyph_length;
+    }
+
     uint8_t * glyph_bmp = (uint8_t *)lv_mem_alloc(sizeof(uint8_t) * cur_bmp_size);
 
     font_dsc->glyph_bitmap = glyph_bmp;
@@ -480,12 +534,13 @@ static int32_t load_glyph(lv_fs_file_t * fp, lv_font_fmt_txt_dsc_t * font_dsc,
  * `lv_font_free` will assume that all non-null pointers are allocated and
  * should be freed.
  */
-static bool lvgl_load_font(lv_fs_file_t * fp, lv_font_t * font)
+static bool lvgl_load_font(font_file_t * ff, lv_font_t * font)
 {
+    lv_fs_file_t * fp = ff->fp;
     lv_font_fmt_txt_dsc_t * font_dsc = (lv_font_fmt_txt_dsc_t *)
-                                       lv_mem_alloc(sizeof(lv_font_fmt_txt_dsc_t));
+                                       lv_mem_alloc(sizeof(font_dsc_bin_t));
 
-    memset(font_dsc, 0, sizeof(lv_font_fmt_txt_dsc_t));
+    memset(font_dsc, 0, sizeof(font_dsc_bin_t));
 
     font->dsc = font_dsc;
 
@@ -562,7 +617,7 @@ static bool lvgl_load_font(lv_fs_file_t * fp, lv_font_t * font)
     /*glyph*/
     uint32_t glyph_start = loca_start + loca_length;
     int32_t glyph_length = load_glyph(
-                               fp, font_dsc, glyph_start, glyph_offset, loca_count, &font_header);
+                               ff, font_dsc, glyph_start, glyph_offset, loca_count, &font_header);
 
     lv_mem_free(glyph_offset);
 
@@ -379,6 +379,39 @@
     #endif
 #endif
 
+/*1: use custom allocator for the gradient cache items, e.g. to place them into an external RAM.
+ *0: use `lv_mem_alloc()` and `lv_mem_free()`*/
+#ifndef LV_GRAD_CACHE_CUSTOM
+    #ifdef CONFIG_LV_GRAD_CACHE_CUSTOM
+        #define LV_GRAD_CACHE_CUSTOM CONFIG_LV_GRAD_CACHE_CUSTOM
+    #else
+        #define LV_GRAD_CACHE_CUSTOM 0
+    #endif
+#endif
+#if LV_GRAD_CACHE_CUSTOM
+    #ifndef LV_GRAD_CACHE_CUSTOM_INCLUDE
+        #ifdef CONFIG_LV_GRAD_CACHE_CUSTOM_INCLUDE
+            #define LV_GRAD_CACHE_CUSTOM_INCLUDE CONFIG_LV_GRAD_CACHE_CUSTOM_INCLUDE
+        #else
+            #define LV_GRAD_CACHE_CUSTOM_INCLUDE <stdlib.h>   /*Header for the allocator functions*/
+        #endif
+    #endif
+    #ifndef LV_GRAD_CACHE_CUSTOM_ALLOC
+        #ifdef CONFIG_LV_GRAD_CACHE_CUSTOM_ALLOC
+            #define LV_GRAD_CACHE_CUSTOM_ALLOC CONFIG_LV_GRAD_CACHE_CUSTOM_ALLOC
+        #else
+            #define LV_GRAD_CACHE_CUSTOM_ALLOC   malloc
+        #endif
+    #endif
+    #ifndef LV_GRAD_CACHE_CUSTOM_FREE
+        #ifdef CONFIG_LV_GRAD_CACHE_CUSTOM_FREE
+            #define LV_GRAD_CACHE_CUSTOM_FREE CONFIG_LV_GRAD_CACHE_CUSTOM_FREE
+        #else
+            #define LV_GRAD_CACHE_CUSTOM_FREE    free
+        #endif
+    #endif
+#endif
+
 /*Allow dithering the gradients (to achieve visual smooth color gradients on limited color depth display)
  *LV_DITHER_GRADIENT implies allocating one or two more lines of the object's rendering surface
  *The increase in memory consumption is (32 bits * object width) plus 24 bits * object width if using error diffusion */
@@ -1978,6 +2011,16 @@
 
 /*File system interfaces for common APIs */
 
+/*Number of blocks cached per file by the drivers below with a cache size > 0.
+ *The cache size is the size of a block. Files opened for reading share the cache.*/
+#ifndef LV_FS_CACHE_BLOCK_CNT
+    #ifdef CONFIG_LV_FS_CACHE_BLOCK_CNT
+        #define LV_FS_CACHE_BLOCK_CNT CONFIG_LV_FS_CACHE_BLOCK_CNT
+    #else
+        #define LV_FS_CACHE_BLOCK_CNT 1
+    #endif
+#endif
+
 /*API for fopen, fread, etc*/
 #ifndef LV_USE_FS_STDIO
     #ifdef CONFIG_LV_USE_FS_STDIO
@@ -2379,6 +2422,57 @@
     #endif // LV_IME_PINYIN_USE_K9_MODE
 #endif
 
+/*1: Decode images of the PNG, SJPG, BMP, etc. decoders in a background thread.
+ *A placeholder is drawn until the image is ready, then the widgets showing it are redrawn.
+ *Requires: LV_IMG_CACHE_DEF_SIZE > 0 and a thread-safe `lv_mem_alloc` (e.g. LV_MEM_CUSTOM 1)*/
+#ifndef LV_USE_IMG_ASYNC
+    #ifdef CONFIG_LV_USE_IMG_ASYNC
+        #define LV_USE_IMG_ASYNC CONFIG_LV_USE_IMG_ASYNC
+    #else
+        #define LV_USE_IMG_ASYNC 0
+    #endif
+#endif
+#if LV_USE_IMG_ASYNC
+    /*1: Create the worker with RT-Thread; 0: with pthread*/
+    #ifndef LV_IMG_ASYNC_USE_RTTHREAD
+        #ifdef CONFIG_LV_IMG_ASYNC_USE_RTTHREAD
+            #define LV_IMG_ASYNC_USE_RTTHREAD CONFIG_LV_IMG_ASYNC_USE_RTTHREAD
+        #else
+            #define LV_IMG_ASYNC_USE_RTTHREAD 0
+        #endif
+    #endif
+    /*Stack size and priority of the worker thread (RT-Thread only). It should have lower priority than the LVGL thread*/
+    #ifndef LV_IMG_ASYNC_STACK_SIZE
+        #ifdef CONFIG_LV_IMG_ASYNC_STACK_SIZE
+            #define LV_IMG_ASYNC_STACK_SIZE CONFIG_LV_IMG_ASYNC_STACK_SIZE
+        #else
+            #define LV_IMG_ASYNC_STACK_SIZE (8 * 1024)
+        #endif
+    #endif
+    #ifndef LV_IMG_ASYNC_THREAD_PRIO
+        #ifdef CONFIG_LV_IMG_ASYNC_THREAD_PRIO
+            #define LV_IMG_ASYNC_THREAD_PRIO CONFIG_LV_IMG_ASYNC_THREAD_PRIO
+        #else
+            #define LV_IMG_ASYNC_THREAD_PRIO 22
+        #endif
+    #endif
+    /*Color and opacity of the placeholder (the opacity is used if the image has alpha channel)*/
+    #ifndef LV_IMG_ASYNC_PLACEHOLDER_COLOR
+        #ifdef CONFIG_LV_IMG_ASYNC_PLACEHOLDER_COLOR
+            #define LV_IMG_ASYNC_PLACEHOLDER_COLOR CONFIG_LV_IMG_ASYNC_PLACEHOLDER_COLOR
+        #else
+            #define LV_IMG_ASYNC_PLACEHOLDER_COLOR lv_color_hex(0xd0d0d0)
+        #endif
+    #endif
+    #ifndef LV_IMG_ASYNC_PLACEHOLDER_OPA
+        #ifdef CONFIG_LV_IMG_ASYNC_PLACEHOLDER_OPA
+            #define LV_IMG_ASYNC_PLACEHOLDER_OPA CONFIG_LV_IMG_ASYNC_PLACEHOLDER_OPA
+        #else
+            #define LV_IMG_ASYNC_PLACEHOLDER_OPA LV_OPA_50
+        #endif
+    #endif
+#endif
+
 /*==================
 * EXAMPLES
 *==================*/
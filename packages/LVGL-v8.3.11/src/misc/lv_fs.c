@@ -25,10 +25,20 @@
  *  STATIC PROTOTYPES
  **********************/
 static const char * lv_fs_get_real_path(const char * path);
+static lv_fs_file_cache_t * cache_get(lv_fs_drv_t * drv, const char * path, lv_fs_mode_t mode);
+static void cache_put(lv_fs_file_cache_t * cache);
+static lv_fs_res_t cache_flush(lv_fs_file_t * file_p);
+static lv_fs_res_t lv_fs_read_cached(lv_fs_file_t * file_p, uint8_t * buf, uint32_t btr, uint32_t * br);
+static lv_fs_res_t lv_fs_write_cached(lv_fs_file_t * file_p, const uint8_t * buf, uint32_t btw, uint32_t * bw);
+static void cache_lock(void);
+static void cache_unlock(void);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static lv_fs_cache_stat_t cache_stat;
+static lv_fs_cache_lock_cb_t cache_lock_cb;
+static lv_fs_cache_lock_cb_t cache_unlock_cb;
 
 /**********************
  *      MACROS
@@ -41,6 +51,7 @@ static const char * lv_fs_get_real_path(const char * path);
 void _lv_fs_init(void)
 {
     _lv_ll_init(&LV_GC_ROOT(_lv_fsdrv_ll), sizeof(lv_fs_drv_t *));
+    _lv_ll_init(&LV_GC_ROOT(_lv_fs_cache_ll), sizeof(lv_fs_file_cache_t));
 }
 
 bool lv_fs_is_ready(char letter)
@@ -90,13 +101,21 @@ lv_fs_res_t lv_fs_open(lv_fs_file_t * file_p, const char * path, lv_fs_mode_t mo
 
     file_p->drv = drv;
     file_p->file_d = file_d;
+    file_p->cache = NULL;
+    file_p->position = 0;
+    file_p->drv_position = 0;
+    file_p->read_end = UINT32_MAX;
 
     if(drv->cache_size) {
-        file_p->cache = lv_mem_alloc(sizeof(lv_fs_file_cache_t));
-        LV_ASSERT_MALLOC(file_p->cache);
-        lv_memset_00(file_p->cache, sizeof(lv_fs_file_cache_t));
-        file_p->cache->start = UINT32_MAX;  /*Set an invalid range by default*/
-        file_p->cache->end = UINT32_MAX - 1;
+        cache_lock();
+        file_p->cache = cache_get(drv, real_path, mode);
+        cache_unlock();
+        if(file_p->cache == NULL) {
+            if(drv->close_cb) drv->close_cb(drv, file_d);
+            file_p->drv = NULL;
+            file_p->file_d = NULL;
+            return LV_FS_RES_OUT_OF_MEM;
+        }
     }
 
     return LV_FS_RES_OK;
@@ -112,16 +131,18 @@ lv_fs_res_t lv_fs_close(lv_fs_file_t * file_p)
         return LV_FS_RES_NOT_IMP;
     }
 
-    lv_fs_res_t res = file_p->drv->close_cb(file_p->drv, file_p->file_d);
-
-    if(file_p->drv->cache_size && file_p->cache) {
-        if(file_p->cache->buffer) {
-            lv_mem_free(file_p->cache->buffer);
-        }
-
-        lv_mem_free(file_p->cache);
+    lv_fs_res_t res = LV_FS_RES_OK;
+    if(file_p->cache) {
+        /*Write back the data while the file is still open*/
+        cache_lock();
+        res = cache_flush(file_p);
+        cache_put(file_p->cache);
+        cache_unlock();
     }
 
+    lv_fs_res_t close_res = file_p->drv->close_cb(file_p->drv, file_p->file_d);
+    if(res == LV_FS_RES_OK) res = close_res;
+
     file_p->file_d = NULL;
     file_p->drv    = NULL;
     file_p->cache  = NULL;
@@ -129,79 +150,6 @@ lv_fs_res_t lv_fs_close(lv_fs_file_t * file_p)
     return res;
 }
 
-static lv_fs_res_t lv_fs_read_cached(lv_fs_file_t * file_p, char * buf, uint32_t btr, uint32_t * br)
-{
-    lv_fs_res_t res = LV_FS_RES_OK;
-    uint32_t file_position = file_p->cache->file_position;
-    uint32_t start = file_p->cache->start;
-    uint32_t end = file_p->cache->end;
-    char * buffer = file_p->cache->buffer;
-    uint16_t buffer_size = file_p->drv->cache_size;
-
-    if(start <= file_position && file_position < end) {
-        /* Data can be read from cache buffer */
-        uint16_t buffer_offset = file_position - start;
-        uint32_t buffer_remaining_length = LV_MIN((uint32_t)buffer_size - buffer_offset, (uint32_t)end - file_position);
-
-        if(btr <= buffer_remaining_length) {
-            /*Data is in cache buffer, and buffer end not reached, no need to read from FS*/
-            lv_memcpy(buf, buffer + buffer_offset, btr);
-            *br = btr;
-        }
-        else {
-            /*First part of data is in cache buffer, but we need to read rest of data from FS*/
-            lv_memcpy(buf, buffer + buffer_offset, buffer_remaining_length);
-
-            uint32_t bytes_read_to_buffer = 0;
-            if(btr > buffer_size) {
-                /*If remaining data chuck is bigger than buffer size, then do not use cache, instead read it directly from FS*/
-                res = file_p->drv->read_cb(file_p->drv, file_p->file_d, (void *)(buf + buffer_remaining_length),
-                                           btr - buffer_remaining_length, &bytes_read_to_buffer);
-            }
-            else {
-                /*If remaining data chunk is smaller than buffer size, then read into cache buffer*/
-                res = file_p->drv->read_cb(file_p->drv, file_p->file_d, (void *)buffer, buffer_size, &bytes_read_to_buffer);
-                file_p->cache->start = file_p->cache->end;
-                file_p->cache->end = file_p->cache->start + bytes_read_to_buffer;
-
-                uint16_t data_chunk_remaining = LV_MIN(btr - buffer_remaining_length, bytes_read_to_buffer);
-                lv_memcpy(buf + buffer_remaining_length, buffer, data_chunk_remaining);
-            }
-            *br = LV_MIN(buffer_remaining_length + bytes_read_to_buffer, btr);
-        }
-    }
-    else {
-        /*Data is not in cache buffer*/
-        if(btr > buffer_size) {
-            /*If bigger data is requested, then do not use cache, instead read it directly*/
-            res = file_p->drv->read_cb(file_p->drv, file_p->file_d, (void *)buf, btr, br);
-        }
-        else {
-            /*If small data is requested, then read from FS into cache buffer*/
-            if(buffer == NULL) {
-                file_p->cache->buffer = lv_mem_alloc(buffer_size);
-                LV_ASSERT_MALLOC(file_p->cache->buffer);
-                buffer = file_p->cache->buffer;
-            }
-
-            uint32_t bytes_read_to_buffer = 0;
-            res = file_p->drv->read_cb(file_p->drv, file_p->file_d, (void *)buffer, buffer_size, &bytes_read_to_buffer);
-            file_p->cache->start = file_position;
-            file_p->cache->end = file_p->cache->start + bytes_read_to_buffer;
-
-            *br = LV_MIN(btr, bytes_read_to_buffer);
-            lv_memcpy(buf, buffer, *br);
-
-        }
-    }
-
-    if(res == LV_FS_RES_OK) {
-        file_p->cache->file_position += *br;
-    }
-
-    return res;
-}
-
 lv_fs_res_t lv_fs_read(lv_fs_file_t * file_p, void * buf, uint32_t btr, uint32_t * br)
 {
     if(br != NULL) *br = 0;
@@ -211,11 +159,14 @@ lv_fs_res_t lv_fs_read(lv_fs_file_t * file_p, void * buf, uint32_t btr, uint32_t
     uint32_t br_tmp = 0;
     lv_fs_res_t res;
 
-    if(file_p->drv->cache_size) {
-        res = lv_fs_read_cached(file_p, (char *)buf, btr, &br_tmp);
+    if(file_p->cache) {
+        cache_lock();
+        res = lv_fs_read_cached(file_p, (uint8_t *)buf, btr, &br_tmp);
+        cache_unlock();
     }
     else {
         res = file_p->drv->read_cb(file_p->drv, file_p->file_d, buf, btr, &br_tmp);
+        cache_stat.drv_reads++;     /*Not locked, only a statistic*/
     }
 
     if(br != NULL) *br = br_tmp;
@@ -236,7 +187,20 @@ lv_fs_res_t lv_fs_write(lv_fs_file_t * file_p, const void * buf, uint32_t btw, u
     }
 
     uint32_t bw_tmp = 0;
-    lv_fs_res_t res = file_p->drv->write_cb(file_p->drv, file_p->file_d, buf, btw, &bw_tmp);
+    lv_fs_res_t res;
+
+    if(file_p->cache) {
+        /*Files opened for reading only share the cache, they can't write*/
+        if(file_p->cache->shared) return LV_FS_RES_DENIED;
+        cache_lock();
+        res = lv_fs_write_cached(file_p, (const uint8_t *)buf, btw, &bw_tmp);
+        cache_unlock();
+    }
+    else {
+        res = file_p->drv->write_cb(file_p->drv, file_p->file_d, buf, btw, &bw_tmp);
+        cache_stat.drv_writes++;    /*Not locked, only a statistic*/
+    }
+
     if(bw != NULL) *bw = bw_tmp;
 
     return res;
@@ -253,37 +217,32 @@ lv_fs_res_t lv_fs_seek(lv_fs_file_t * file_p, uint32_t pos, lv_fs_whence_t whenc
     }
 
     lv_fs_res_t res = LV_FS_RES_OK;
-    if(file_p->drv->cache_size) {
+    if(file_p->cache) {
+        /*The driver seeks only when it reads or writes*/
         switch(whence) {
-            case LV_FS_SEEK_SET: {
-                    file_p->cache->file_position = pos;
-
-                    /*FS seek if new position is outside cache buffer*/
-                    if(file_p->cache->file_position < file_p->cache->start || file_p->cache->file_position > file_p->cache->end) {
-                        res = file_p->drv->seek_cb(file_p->drv, file_p->file_d, file_p->cache->file_position, LV_FS_SEEK_SET);
-                    }
-
-                    break;
-                }
-            case LV_FS_SEEK_CUR: {
-                    file_p->cache->file_position += pos;
-
-                    /*FS seek if new position is outside cache buffer*/
-                    if(file_p->cache->file_position < file_p->cache->start || file_p->cache->file_position > file_p->cache->end) {
-                        res = file_p->drv->seek_cb(file_p->drv, file_p->file_d, file_p->cache->file_position, LV_FS_SEEK_SET);
-                    }
-
-                    break;
-                }
+            case LV_FS_SEEK_SET:
+                file_p->position = pos;
+                break;
+            case LV_FS_SEEK_CUR:
+                file_p->position += pos;
+                break;
             case LV_FS_SEEK_END: {
-                    /*Because we don't know the file size, we do a little trick: do a FS seek, then get new file position from FS*/
+                    /*Because we don't know the file size, we do a little trick: do a FS seek, then get new file position from FS.
+                     *The size can change when the cached data is written back so do it first.*/
+                    cache_lock();
+                    res = cache_flush(file_p);
+                    cache_unlock();
+                    if(res != LV_FS_RES_OK) break;
+
+                    file_p->drv_position = UINT32_MAX;
                     res = file_p->drv->seek_cb(file_p->drv, file_p->file_d, pos, whence);
                     if(res == LV_FS_RES_OK) {
                         uint32_t tmp_position;
                         res = file_p->drv->tell_cb(file_p->drv, file_p->file_d, &tmp_position);
 
                         if(res == LV_FS_RES_OK) {
-                            file_p->cache->file_position = tmp_position;
+                            file_p->position = tmp_position;
+                            file_p->drv_position = tmp_position;
                         }
                     }
                     break;
@@ -310,8 +269,8 @@ lv_fs_res_t lv_fs_tell(lv_fs_file_t * file_p, uint32_t * pos)
     }
 
     lv_fs_res_t res;
-    if(file_p->drv->cache_size) {
-        *pos = file_p->cache->file_position;
+    if(file_p->cache) {
+        *pos = file_p->position;
         res = LV_FS_RES_OK;
     }
     else {
@@ -321,6 +280,35 @@ lv_fs_res_t lv_fs_tell(lv_fs_file_t * file_p, uint32_t * pos)
     return res;
 }
 
+const void * lv_fs_map(lv_fs_file_t * file_p, uint32_t * size_p)
+{
+    if(file_p->drv == NULL || file_p->drv->map_cb == NULL) {
+        return NULL;
+    }
+
+    return file_p->drv->map_cb(file_p->drv, file_p->file_d, size_p);
+}
+
+void lv_fs_cache_get_stat(lv_fs_cache_stat_t * stat)
+{
+    cache_lock();
+    lv_memcpy_small(stat, &cache_stat, sizeof(lv_fs_cache_stat_t));
+    cache_unlock();
+}
+
+void lv_fs_cache_reset_stat(void)
+{
+    cache_lock();
+    lv_memset_00(&cache_stat, sizeof(lv_fs_cache_stat_t));
+    cache_unlock();
+}
+
+void lv_fs_cache_set_lock_cb(lv_fs_cache_lock_cb_t lock_cb, lv_fs_cache_lock_cb_t unlock_cb)
+{
+    cache_lock_cb = lock_cb;
+    cache_unlock_cb = unlock_cb;
+}
+
 lv_fs_res_t lv_fs_dir_open(lv_fs_dir_t * rddir_p, const char * path)
 {
     if(path == NULL) return LV_FS_RES_INV_PARAM;
@@ -393,6 +381,7 @@ lv_fs_res_t lv_fs_dir_close(lv_fs_dir_t * rddir_p)
 void lv_fs_drv_init(lv_fs_drv_t * drv)
 {
     lv_memset_00(drv, sizeof(lv_fs_drv_t));
+    drv->cache_block_cnt = LV_FS_CACHE_BLOCK_CNT;
 }
 
 void lv_fs_drv_register(lv_fs_drv_t * drv_p)
@@ -516,3 +505,367 @@ static const char * lv_fs_get_real_path(const char * path)
 
     return path;
 }
+
+/*Find the cache shared by the files opened for reading only or create a new cache*/
+static lv_fs_file_cache_t * cache_get(lv_fs_drv_t * drv, const char * path, lv_fs_mode_t mode)
+{
+    lv_ll_t * ll = &LV_GC_ROOT(_lv_fs_cache_ll);
+    lv_fs_file_cache_t * cache;
+    bool shared = mode == LV_FS_MODE_RD;
+
+    if(shared) {
+        _LV_LL_READ(ll, cache) {
+            if(cache->drv == drv && cache->block_size == drv->cache_size && strcmp(cache->path, path) == 0) {
+                cache->ref_cnt++;
+                return cache;
+            }
+        }
+        cache = _lv_ll_ins_head(ll);
+    }
+    else {
+        cache = lv_mem_alloc(sizeof(lv_fs_file_cache_t));
+    }
+    LV_ASSERT_MALLOC(cache);
+    if(cache == NULL) return NULL;
+
+    lv_memset_00(cache, sizeof(lv_fs_file_cache_t));
+    cache->drv = drv;
+    cache->shared = shared;
+    cache->readable = (mode & LV_FS_MODE_RD) != 0;
+    cache->ref_cnt = 1;
+    cache->block_size = drv->cache_size;
+    cache->block_cnt = drv->cache_block_cnt ? drv->cache_block_cnt : 1;
+
+    size_t path_len = strlen(path);
+    cache->path = lv_mem_alloc(path_len + 1);
+    cache->blocks = lv_mem_alloc(cache->block_cnt * sizeof(lv_fs_cache_block_t));
+    if(cache->path == NULL || cache->blocks == NULL) {
+        cache_put(cache);
+        return NULL;
+    }
+    lv_memcpy(cache->path, path, path_len + 1);
+
+    uint16_t i;
+    lv_memset_00(cache->blocks, cache->block_cnt * sizeof(lv_fs_cache_block_t));
+    for(i = 0; i < cache->block_cnt; i++) {
+        cache->blocks[i].index = UINT32_MAX;
+    }
+
+    return cache;
+}
+
+/*Free the cache when its last file is closed*/
+static void cache_put(lv_fs_file_cache_t * cache)
+{
+    if(cache->ref_cnt > 1) {
+        cache->ref_cnt--;
+        return;
+    }
+
+    if(cache->blocks) {
+        uint16_t i;
+        for(i = 0; i < cache->block_cnt; i++) {
+            if(cache->blocks[i].data) lv_mem_free(cache->blocks[i].data);
+        }
+        lv_mem_free(cache->blocks);
+    }
+    if(cache->path) lv_mem_free(cache->path);
+
+    if(cache->shared) {
+        _lv_ll_remove(&LV_GC_ROOT(_lv_fs_cache_ll), cache);
+    }
+    lv_mem_free(cache);
+}
+
+/*Drop the blocks of the files opened for reading only when the file was written*/
+static void cache_invalidate_shared(lv_fs_drv_t * drv, const char * path)
+{
+    lv_fs_file_cache_t * cache;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_fs_cache_ll), cache) {
+        if(cache->drv == drv && strcmp(cache->path, path) == 0) {
+            uint16_t i;
+            for(i = 0; i < cache->block_cnt; i++) {
+                cache->blocks[i].index = UINT32_MAX;
+            }
+        }
+    }
+}
+
+static lv_fs_cache_block_t * cache_find(lv_fs_file_cache_t * cache, uint32_t index)
+{
+    uint16_t i;
+    for(i = 0; i < cache->block_cnt; i++) {
+        if(cache->blocks[i].index == index) return &cache->blocks[i];
+    }
+
+    return NULL;
+}
+
+/*Move the position of the driver's file only if it's not there already*/
+static lv_fs_res_t drv_seek(lv_fs_file_t * file_p, uint32_t pos)
+{
+    if(file_p->drv_position == pos) return LV_FS_RES_OK;
+    if(file_p->drv->seek_cb == NULL) return LV_FS_RES_NOT_IMP;
+
+    lv_fs_res_t res = file_p->drv->seek_cb(file_p->drv, file_p->file_d, pos, LV_FS_SEEK_SET);
+    file_p->drv_position = res == LV_FS_RES_OK ? pos : UINT32_MAX;
+    return res;
+}
+
+static lv_fs_res_t drv_read(lv_fs_file_t * file_p, uint32_t pos, void * buf, uint32_t btr, uint32_t * br)
+{
+    *br = 0;
+    lv_fs_res_t res = drv_seek(file_p, pos);
+    if(res != LV_FS_RES_OK) return res;
+
+    res = file_p->drv->read_cb(file_p->drv, file_p->file_d, buf, btr, br);
+    file_p->drv_position = res == LV_FS_RES_OK ? pos + *br : UINT32_MAX;
+    cache_stat.drv_reads++;
+    return res;
+}
+
+/*Write back the modified part of a block*/
+static lv_fs_res_t block_flush(lv_fs_file_t * file_p, lv_fs_cache_block_t * block)
+{
+    if(block->dirty_start == block->dirty_end) return LV_FS_RES_OK;
+
+    uint32_t pos = block->index * file_p->cache->block_size + block->dirty_start;
+    uint32_t btw = block->dirty_end - block->dirty_start;
+    uint32_t bw = 0;
+    lv_fs_res_t res = drv_seek(file_p, pos);
+    if(res != LV_FS_RES_OK) return res;
+
+    res = file_p->drv->write_cb(file_p->drv, file_p->file_d, block->data + block->dirty_start, btw, &bw);
+    file_p->drv_position = res == LV_FS_RES_OK ? pos + bw : UINT32_MAX;
+    cache_stat.drv_writes++;
+    if(res != LV_FS_RES_OK) return res;
+    if(bw != btw) return LV_FS_RES_FULL;
+
+    block->dirty_start = 0;
+    block->dirty_end = 0;
+    cache_invalidate_shared(file_p->drv, file_p->cache->path);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t cache_flush(lv_fs_file_t * file_p)
+{
+    lv_fs_file_cache_t * cache = file_p->cache;
+    uint16_t i;
+    for(i = 0; i < cache->block_cnt; i++) {
+        if(cache->blocks[i].index == UINT32_MAX) continue;
+        lv_fs_res_t res = block_flush(file_p, &cache->blocks[i]);
+        if(res != LV_FS_RES_OK) return res;
+    }
+
+    return LV_FS_RES_OK;
+}
+
+/*Take a free block or the least recently used one for `index`*/
+static lv_fs_res_t cache_alloc_block(lv_fs_file_t * file_p, uint32_t index, lv_fs_cache_block_t ** block_p)
+{
+    lv_fs_file_cache_t * cache = file_p->cache;
+    lv_fs_cache_block_t * block = &cache->blocks[0];
+    uint16_t i;
+    for(i = 0; i < cache->block_cnt; i++) {
+        if(cache->blocks[i].index == UINT32_MAX) {
+            block = &cache->blocks[i];
+            break;
+        }
+        if(cache->blocks[i].life < block->life) block = &cache->blocks[i];
+    }
+
+    if(block->index != UINT32_MAX) {
+        lv_fs_res_t res = block_flush(file_p, block);
+        if(res != LV_FS_RES_OK) return res;
+        cache_stat.evictions++;
+    }
+
+    if(block->data == NULL) {
+        block->data = lv_mem_alloc(file_p->cache->block_size);
+        LV_ASSERT_MALLOC(block->data);
+        if(block->data == NULL) {
+            block->index = UINT32_MAX;
+            return LV_FS_RES_OUT_OF_MEM;
+        }
+    }
+
+    block->index = index;
+    block->len = 0;
+    block->dirty_start = 0;
+    block->dirty_end = 0;
+    block->loaded = false;
+    block->life = ++cache->life_cnt;
+    *block_p = block;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t cache_load_block(lv_fs_file_t * file_p, uint32_t index, lv_fs_cache_block_t ** block_p)
+{
+    uint32_t block_size = file_p->cache->block_size;
+    lv_fs_cache_block_t * block;
+    lv_fs_res_t res = cache_alloc_block(file_p, index, &block);
+    if(res != LV_FS_RES_OK) return res;
+
+    res = drv_read(file_p, index * block_size, block->data, block_size, &block->len);
+    if(res != LV_FS_RES_OK) {
+        block->index = UINT32_MAX;
+        return res;
+    }
+
+    block->loaded = true;
+    *block_p = block;
+    return LV_FS_RES_OK;
+}
+
+/*The caches are used only with the lock held*/
+static lv_fs_res_t lv_fs_read_cached(lv_fs_file_t * file_p, uint8_t * buf, uint32_t btr, uint32_t * br)
+{
+    lv_fs_file_cache_t * cache = file_p->cache;
+    uint32_t block_size = file_p->cache->block_size;
+    uint32_t pos = file_p->position;
+    bool sequential = pos == file_p->read_end;
+    lv_fs_res_t res = LV_FS_RES_OK;
+
+    while(btr > 0) {
+        uint32_t index = pos / block_size;
+        uint32_t ofs = pos % block_size;
+        lv_fs_cache_block_t * block = cache_find(cache, index);
+
+        if(block == NULL && ofs == 0 && btr >= block_size) {
+            /*Read the whole blocks which are not cached directly, in one go*/
+            uint32_t cnt = 1;
+            while(cnt < btr / block_size && cache_find(cache, index + cnt) == NULL) cnt++;
+
+            uint32_t rn;
+            res = drv_read(file_p, pos, buf, cnt * block_size, &rn);
+            if(res != LV_FS_RES_OK) break;
+            pos += rn;
+            buf += rn;
+            btr -= rn;
+            *br += rn;
+            if(rn < cnt * block_size) break;    /*End of the file*/
+            continue;
+        }
+
+        if(block == NULL) {
+            cache_stat.misses++;
+            res = cache_load_block(file_p, index, &block);
+            if(res != LV_FS_RES_OK) break;
+        }
+        else {
+            cache_stat.hits++;
+            block->life = ++cache->life_cnt;
+        }
+
+        /*Only the written part of the file is known if it was opened for writing only*/
+        if(!block->loaded) {
+            res = LV_FS_RES_DENIED;
+            break;
+        }
+
+        if(ofs >= block->len) break;    /*End of the file*/
+        uint32_t n = LV_MIN(block->len - ofs, btr);
+        lv_memcpy(buf, block->data + ofs, n);
+        pos += n;
+        buf += n;
+        btr -= n;
+        *br += n;
+    }
+
+    /*Read the next block ahead if the file is read sequentially*/
+    if(res == LV_FS_RES_OK && btr == 0 && sequential && cache->block_cnt > 1) {
+        uint32_t index = (pos + block_size - 1) / block_size;
+        lv_fs_cache_block_t * block = cache_find(cache, pos / block_size);
+        bool eof = block && block->loaded && block->len < block_size;
+        if(!eof && cache_find(cache, index) == NULL && cache_load_block(file_p, index, &block) == LV_FS_RES_OK) {
+            cache_stat.prefetches++;
+        }
+    }
+
+    file_p->position = pos;
+    file_p->read_end = pos;
+
+    return res;
+}
+
+/*Collect the written data in the blocks, they are written back when they are dropped or the file is closed*/
+static lv_fs_res_t lv_fs_write_cached(lv_fs_file_t * file_p, const uint8_t * buf, uint32_t btw, uint32_t * bw)
+{
+    lv_fs_file_cache_t * cache = file_p->cache;
+    uint32_t block_size = file_p->cache->block_size;
+    uint32_t pos = file_p->position;
+    lv_fs_res_t res = LV_FS_RES_OK;
+
+    while(btw > 0) {
+        uint32_t index = pos / block_size;
+        uint32_t ofs = pos % block_size;
+        uint32_t n = LV_MIN(block_size - ofs, btw);
+        lv_fs_cache_block_t * block = cache_find(cache, index);
+
+        if(block == NULL) {
+            cache_stat.misses++;
+            /*Read the rest of the block if it's not overwritten*/
+            if(cache->readable && n < block_size) {
+                res = cache_load_block(file_p, index, &block);
+            }
+            else {
+                res = cache_alloc_block(file_p, index, &block);
+                if(res == LV_FS_RES_OK && n == block_size) block->loaded = true;
+            }
+            if(res != LV_FS_RES_OK) break;
+        }
+        else {
+            block->life = ++cache->life_cnt;
+        }
+
+        bool clean = block->dirty_start == block->dirty_end;
+        if(!block->loaded) {
+            /*Without the content of the file only a continuous range can be collected*/
+            if(!clean && (ofs > block->dirty_end || ofs + n < block->dirty_start)) {
+                res = block_flush(file_p, block);
+                if(res != LV_FS_RES_OK) break;
+                clean = true;
+            }
+        }
+        else if(ofs > block->len) {
+            /*Writing after the end of the file, the gap is filled with zeros*/
+            lv_memset_00(block->data + block->len, ofs - block->len);
+            if(!clean) block->dirty_start = LV_MIN(block->dirty_start, block->len);
+            else block->dirty_start = block->len;
+            block->dirty_end = LV_MAX(block->dirty_end, block->len);
+            clean = false;
+        }
+
+        lv_memcpy(block->data + ofs, buf, n);
+        if(block->loaded && ofs + n > block->len) block->len = ofs + n;
+
+        if(clean) {
+            block->dirty_start = ofs;
+            block->dirty_end = ofs + n;
+        }
+        else {
+            block->dirty_start = LV_MIN(block->dirty_start, ofs);
+            block->dirty_end = LV_MAX(block->dirty_end, ofs + n);
+        }
+
+        pos += n;
+        buf += n;
+        btw -= n;
+        *bw += n;
+    }
+
+    file_p->position = pos;
+    file_p->read_end = UINT32_MAX;
+
+    return res;
+}
+
+static void cache_lock(void)
+{
+    if(cache_lock_cb) cache_lock_cb();
+}
+
+static void cache_unlock(void)
+{
+    if(cache_unlock_cb) cache_unlock_cb();
+}
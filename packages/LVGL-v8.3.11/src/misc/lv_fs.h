@@ -68,7 +68,8 @@ typedef enum {
 
 typedef struct _lv_fs_drv_t {
     char letter;
-    uint16_t cache_size;
+    uint16_t cache_size;        /**< Size of a cache block, 0: don't cache*/
+    uint16_t cache_block_cnt;   /**< Number of blocks cached per file*/
     bool (*ready_cb)(struct _lv_fs_drv_t * drv);
 
     void * (*open_cb)(struct _lv_fs_drv_t * drv, const char * path, lv_fs_mode_t mode);
@@ -77,6 +78,7 @@ typedef struct _lv_fs_drv_t {
     lv_fs_res_t (*write_cb)(struct _lv_fs_drv_t * drv, void * file_p, const void * buf, uint32_t btw, uint32_t * bw);
     lv_fs_res_t (*seek_cb)(struct _lv_fs_drv_t * drv, void * file_p, uint32_t pos, lv_fs_whence_t whence);
     lv_fs_res_t (*tell_cb)(struct _lv_fs_drv_t * drv, void * file_p, uint32_t * pos_p);
+    const void * (*map_cb)(struct _lv_fs_drv_t * drv, void * file_p, uint32_t * size_p);
 
     void * (*dir_open_cb)(struct _lv_fs_drv_t * drv, const char * path);
     lv_fs_res_t (*dir_read_cb)(struct _lv_fs_drv_t * drv, void * rddir_p, char * fn);
@@ -87,17 +89,49 @@ typedef struct _lv_fs_drv_t {
 #endif
 } lv_fs_drv_t;
 
+/**
+ * Counters of the file caches.
+ */
+typedef struct {
+    uint32_t hits;          /**< Reads served from cached blocks*/
+    uint32_t misses;        /**< Blocks loaded because they were read or written*/
+    uint32_t prefetches;    /**< Blocks loaded ahead of sequential reads*/
+    uint32_t evictions;     /**< Blocks dropped to load others*/
+    uint32_t drv_reads;     /**< Calls of `read_cb`, also by the files without cache (not locked, may miss a few)*/
+    uint32_t drv_writes;    /**< Calls of `write_cb`, also by the files without cache (not locked, may miss a few)*/
+} lv_fs_cache_stat_t;
+
+typedef void (*lv_fs_cache_lock_cb_t)(void);
+
 typedef struct {
-    uint32_t start;
-    uint32_t end;
-    uint32_t file_position;
-    void * buffer;
+    uint32_t index;         /*Number of the block in the file, UINT32_MAX: unused*/
+    uint32_t len;           /*Number of valid bytes*/
+    uint32_t dirty_start;   /*Range of bytes to write back, empty if the block is clean*/
+    uint32_t dirty_end;
+    uint32_t life;          /*Time of the last access, the oldest block is dropped first*/
+    bool loaded;            /*The block was read from the file (else only the dirty range is valid)*/
+    uint8_t * data;
+} lv_fs_cache_block_t;
+
+typedef struct {
+    lv_fs_drv_t * drv;
+    char * path;
+    bool shared;            /*Shared by the files opened for reading only*/
+    bool readable;
+    uint16_t ref_cnt;
+    uint16_t block_size;    /*`cache_size` of the driver when the cache was created*/
+    uint16_t block_cnt;
+    uint32_t life_cnt;
+    lv_fs_cache_block_t * blocks;
 } lv_fs_file_cache_t;
 
 typedef struct {
     void * file_d;
     lv_fs_drv_t * drv;
     lv_fs_file_cache_t * cache;
+    uint32_t position;      /*Position in the file if it's cached*/
+    uint32_t drv_position;  /*Position of `file_d` in the driver, UINT32_MAX: unknown*/
+    uint32_t read_end;      /*End of the last read to detect sequential reads*/
 } lv_fs_file_t;
 
 typedef struct {
@@ -198,6 +232,35 @@ lv_fs_res_t lv_fs_seek(lv_fs_file_t * file_p, uint32_t pos, lv_fs_whence_t whenc
  */
 lv_fs_res_t lv_fs_tell(lv_fs_file_t * file_p, uint32_t * pos);
 
+/**
+ * Get the content of a file which is in memory (e.g. memory mapped flash or a ROM file system image)
+ * to use it in place instead of reading it.
+ * The pointer remains valid after the file is closed, as long as the drive is registered.
+ * @param file_p    pointer to a lv_fs_file_t variable
+ * @param size_p    pointer to store the size of the file
+ * @return          pointer to the content of the file or NULL if the drive can't map it
+ */
+const void * lv_fs_map(lv_fs_file_t * file_p, uint32_t * size_p);
+
+/**
+ * Get the counters of the file caches of all drives
+ * @param stat      pointer to store the counters
+ */
+void lv_fs_cache_get_stat(lv_fs_cache_stat_t * stat);
+
+/**
+ * Reset the counters of the file caches
+ */
+void lv_fs_cache_reset_stat(void);
+
+/**
+ * Set the functions to lock and unlock the file caches if files are used by several threads.
+ * By default the caches are not locked.
+ * @param lock_cb   called before the caches are used, e.g. takes a mutex. NULL: no lock
+ * @param unlock_cb called after the caches are used, e.g. releases the mutex. NULL: no lock
+ */
+void lv_fs_cache_set_lock_cb(lv_fs_cache_lock_cb_t lock_cb, lv_fs_cache_lock_cb_t unlock_cb);
+
 /**
  * Initialize a 'fs_dir_t' variable for directory reading
  * @param rddir_p   pointer to a 'lv_fs_dir_t' variable
@@ -0,0 +1,269 @@
+/**
+ * @file lv_test_dma2d.c
+ *
+ */
+
+#if LV_BUILD_TEST
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_test_dma2d.h"
+#include <string.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#define MODE_M2M        0U
+#define MODE_M2M_PFC    1U
+#define MODE_M2M_BLEND  2U
+#define MODE_R2M        3U
+
+#define CM_ARGB8888     0x0U
+#define CM_RGB888       0x1U
+#define CM_RGB565       0x2U
+#define CM_ARGB1555     0x3U
+#define CM_ARGB4444     0x4U
+#define CM_A8           0x9U
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+typedef struct {
+    uint8_t a;
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+} argb_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static void run_transfer(void);
+static uint32_t px_size(uint32_t cm);
+static argb_t fetch(uintptr_t addr, uint32_t cm, uint32_t const_color);
+static argb_t apply_alpha_mode(argb_t c, uint32_t pfccr);
+static argb_t blend(argb_t fg, argb_t bg);
+static void store(uintptr_t addr, uint32_t cm, argb_t c);
+static void store_raw(uintptr_t addr, uint32_t cm, uint32_t value);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+static DMA2D_TypeDef regs;
+static uint32_t transfer_cnt;
+
+/**********************
+ *  GLOBAL VARIABLES
+ **********************/
+RCC_TypeDef lv_test_rcc;
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+DMA2D_TypeDef * lv_test_dma2d_regs(void)
+{
+    if(regs.CR & DMA2D_CR_START) run_transfer();
+    return &regs;
+}
+
+void lv_test_dma2d_reset(void)
+{
+    memset((void *)&regs, 0, sizeof(regs));
+    transfer_cnt = 0;
+}
+
+bool lv_test_dma2d_is_pending(void)
+{
+    return (regs.CR & DMA2D_CR_START) != 0;
+}
+
+uint32_t lv_test_dma2d_get_transfer_cnt(void)
+{
+    return transfer_cnt;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static void run_transfer(void)
+{
+    uint32_t mode = (regs.CR >> DMA2D_CR_MODE_Pos) & 0x3U;
+    uint32_t w = (regs.NLR & DMA2D_NLR_PL_Msk) >> DMA2D_NLR_PL_Pos;
+    uint32_t h = (regs.NLR & DMA2D_NLR_NL_Msk) >> DMA2D_NLR_NL_Pos;
+    uint32_t fg_cm = regs.FGPFCCR & 0xFU;
+    uint32_t bg_cm = regs.BGPFCCR & 0xFU;
+    uint32_t out_cm = regs.OPFCCR & 0x7U;
+
+    /*The real peripheral refuses these (CEIF) instead of producing garbage*/
+    bool cfg_err = (mode == MODE_M2M && fg_cm != out_cm) || (mode == MODE_M2M_BLEND && bg_cm == CM_A8) ||
+                   out_cm > CM_ARGB4444 || px_size(fg_cm) == 0;
+
+    if(!cfg_err) {
+        uint32_t y;
+        for(y = 0; y < h; y++) {
+            uint32_t x;
+            for(x = 0; x < w; x++) {
+                uintptr_t out_addr = regs.OMAR + ((uintptr_t)y * (w + regs.OOR) + x) * px_size(out_cm);
+                if(mode == MODE_R2M) {
+                    store_raw(out_addr, out_cm, regs.OCOLR);
+                    continue;
+                }
+
+                uintptr_t fg_addr = regs.FGMAR + ((uintptr_t)y * (w + regs.FGOR) + x) * px_size(fg_cm);
+                argb_t fg = fetch(fg_addr, fg_cm, regs.FGCOLR);
+                if(mode == MODE_M2M_BLEND) {
+                    uintptr_t bg_addr = regs.BGMAR + ((uintptr_t)y * (w + regs.BGOR) + x) * px_size(bg_cm);
+                    argb_t bg = fetch(bg_addr, bg_cm, regs.BGCOLR);
+                    fg = blend(apply_alpha_mode(fg, regs.FGPFCCR), apply_alpha_mode(bg, regs.BGPFCCR));
+                }
+                else if(mode == MODE_M2M_PFC) {
+                    fg = apply_alpha_mode(fg, regs.FGPFCCR);
+                }
+                store(out_addr, out_cm, fg);
+            }
+        }
+        transfer_cnt++;
+    }
+
+    regs.CR &= ~DMA2D_CR_START;
+    regs.ISR |= cfg_err ? DMA2D_ISR_CEIF : DMA2D_ISR_TCIF;
+}
+
+static uint32_t px_size(uint32_t cm)
+{
+    switch(cm) {
+        case CM_ARGB8888:
+            return 4;
+        case CM_RGB888:
+            return 3;
+        case CM_RGB565:
+        case CM_ARGB1555:
+        case CM_ARGB4444:
+            return 2;
+        case CM_A8:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/*The PFC expands the narrow channels by replicating their MSBs into the missing LSBs*/
+static inline uint8_t expand(uint32_t v, uint32_t bits)
+{
+    v = v << (8 - bits);
+    return (uint8_t)(v | (v >> bits));
+}
+
+static argb_t fetch(uintptr_t addr, uint32_t cm, uint32_t const_color)
+{
+    const uint8_t * p = (const uint8_t *)addr;
+    uint32_t v;
+    argb_t c;
+    switch(cm) {
+        case CM_ARGB8888:
+            c.b = p[0];
+            c.g = p[1];
+            c.r = p[2];
+            c.a = p[3];
+            break;
+        case CM_RGB888:
+            c.b = p[0];
+            c.g = p[1];
+            c.r = p[2];
+            c.a = 0xFF;
+            break;
+        case CM_RGB565:
+            v = p[0] | (p[1] << 8);
+            c.r = expand(v >> 11, 5);
+            c.g = expand((v >> 5) & 0x3F, 6);
+            c.b = expand(v & 0x1F, 5);
+            c.a = 0xFF;
+            break;
+        case CM_ARGB1555:
+            v = p[0] | (p[1] << 8);
+            c.a = (v & 0x8000) ? 0xFF : 0x00;
+            c.r = expand((v >> 10) & 0x1F, 5);
+            c.g = expand((v >> 5) & 0x1F, 5);
+            c.b = expand(v & 0x1F, 5);
+            break;
+        case CM_ARGB4444:
+            v = p[0] | (p[1] << 8);
+            c.a = expand(v >> 12, 4);
+            c.r = expand((v >> 8) & 0xF, 4);
+            c.g = expand((v >> 4) & 0xF, 4);
+            c.b = expand(v & 0xF, 4);
+            break;
+        case CM_A8:
+        default:
+            c.a = p[0];
+            c.r = (const_color >> 16) & 0xFF;
+            c.g = (const_color >> 8) & 0xFF;
+            c.b = const_color & 0xFF;
+            break;
+    }
+    return c;
+}
+
+static argb_t apply_alpha_mode(argb_t c, uint32_t pfccr)
+{
+    uint32_t am = (pfccr >> DMA2D_FGPFCCR_AM_Pos) & 0x3U;
+    uint32_t alpha = pfccr >> DMA2D_FGPFCCR_ALPHA_Pos;
+    if(am == 1) c.a = (uint8_t)alpha;
+    else if(am == 2) c.a = (uint8_t)((c.a * alpha) / 255);
+    return c;
+}
+
+/*Blender equations of the reference manual (RM0090, "DMA2D blender")*/
+static argb_t blend(argb_t fg, argb_t bg)
+{
+    uint32_t a_mult = (fg.a * bg.a) / 255;
+    uint32_t a_out = fg.a + bg.a - a_mult;
+    argb_t res;
+    res.a = (uint8_t)a_out;
+    if(a_out == 0) {
+        res.r = res.g = res.b = 0;
+        return res;
+    }
+    res.r = (uint8_t)((fg.r * fg.a + bg.r * bg.a - bg.r * a_mult) / a_out);
+    res.g = (uint8_t)((fg.g * fg.a + bg.g * bg.a - bg.g * a_mult) / a_out);
+    res.b = (uint8_t)((fg.b * fg.a + bg.b * bg.a - bg.b * a_mult) / a_out);
+    return res;
+}
+
+static void store(uintptr_t addr, uint32_t cm, argb_t c)
+{
+    uint32_t v;
+    switch(cm) {
+        case CM_ARGB8888:
+            v = ((uint32_t)c.a << 24) | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+            break;
+        case CM_RGB888:
+            v = ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+            break;
+        case CM_RGB565:
+            v = ((uint32_t)(c.r >> 3) << 11) | ((uint32_t)(c.g >> 2) << 5) | (c.b >> 3);
+            break;
+        case CM_ARGB1555:
+            v = ((uint32_t)(c.a >> 7) << 15) | ((uint32_t)(c.r >> 3) << 10) | ((uint32_t)(c.g >> 3) << 5) | (c.b >> 3);
+            break;
+        case CM_ARGB4444:
+        default:
+            v = ((uint32_t)(c.a >> 4) << 12) | ((uint32_t)(c.r >> 4) << 8) | ((uint32_t)(c.g >> 4) << 4) | (c.b >> 4);
+            break;
+    }
+    store_raw(addr, cm, v);
+}
+
+static void store_raw(uintptr_t addr, uint32_t cm, uint32_t value)
+{
+    uint8_t * p = (uint8_t *)addr;
+    uint32_t i;
+    for(i = 0; i < px_size(cm); i++) {
+        p[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+#endif /*LV_BUILD_TEST*/
@@ -0,0 +1,128 @@
+/**
+ * @file lv_test_dma2d.h
+ *
+ * Host-side model of the STM32 DMA2D (Chrom-ART) peripheral.
+ * It stands in for the CMSIS device header so that lv_gpu_stm32_dma2d.c can be
+ * compiled and executed on the host (`LV_GPU_DMA2D_CMSIS_INCLUDE "lv_test_dma2d.h"`).
+ * Only the register-level behavior used by the driver is modelled: R2M, M2M, M2M_PFC
+ * and M2M_BLEND modes with the pixel formats and alpha modes of the STM32F4 series.
+ */
+
+#ifndef LV_TEST_DMA2D_H
+#define LV_TEST_DMA2D_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************
+ *      DEFINES
+ *********************/
+#ifndef STM32F4
+#define STM32F4
+#endif
+
+#define __IO volatile
+#define __DSB() do {} while(0)
+
+#define RCC_AHB1ENR_DMA2DEN         (1UL << 23)
+
+#define DMA2D_CR_START              (1UL << 0)
+#define DMA2D_CR_MODE_Pos           16U
+
+#define DMA2D_ISR_TEIF              (1UL << 0)
+#define DMA2D_ISR_TCIF              (1UL << 1)
+#define DMA2D_ISR_CEIF              (1UL << 5)
+
+#define DMA2D_FGPFCCR_AM_Pos        16U
+#define DMA2D_FGPFCCR_ALPHA_Pos     24U
+#define DMA2D_BGPFCCR_AM_Pos        16U
+#define DMA2D_BGPFCCR_ALPHA_Pos     24U
+
+#define DMA2D_NLR_NL_Pos            0U
+#define DMA2D_NLR_NL_Msk            (0xFFFFUL << DMA2D_NLR_NL_Pos)
+#define DMA2D_NLR_PL_Pos            16U
+#define DMA2D_NLR_PL_Msk            (0x3FFFUL << DMA2D_NLR_PL_Pos)
+
+/**
+ * Every access to `DMA2D` executes the transfer started by the previous access (if any).
+ * This way a transfer "runs in the background" until the driver polls or touches the peripheral again,
+ * so a missing wait in the driver shows up as an unmodified buffer in the tests.
+ */
+#define DMA2D   (lv_test_dma2d_regs())
+#define RCC     (&lv_test_rcc)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/*Address registers are pointer sized so that host buffers can be used directly*/
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t ISR;
+    __IO uint32_t IFCR;
+    __IO uintptr_t FGMAR;
+    __IO uint32_t FGOR;
+    __IO uintptr_t BGMAR;
+    __IO uint32_t BGOR;
+    __IO uint32_t FGPFCCR;
+    __IO uint32_t FGCOLR;
+    __IO uint32_t BGPFCCR;
+    __IO uint32_t BGCOLR;
+    __IO uintptr_t FGCMAR;
+    __IO uintptr_t BGCMAR;
+    __IO uint32_t OPFCCR;
+    __IO uint32_t OCOLR;
+    __IO uintptr_t OMAR;
+    __IO uint32_t OOR;
+    __IO uint32_t NLR;
+    __IO uint32_t LWR;
+    __IO uint32_t AMTCR;
+} DMA2D_TypeDef;
+
+typedef struct {
+    __IO uint32_t AHB1ENR;
+} RCC_TypeDef;
+
+extern RCC_TypeDef lv_test_rcc;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Get the register block of the modelled DMA2D.
+ * A transfer started earlier (CR.START set) is executed before returning.
+ * @return pointer to the registers
+ */
+DMA2D_TypeDef * lv_test_dma2d_regs(void);
+
+/**
+ * Reset the registers and the statistics of the model.
+ */
+void lv_test_dma2d_reset(void);
+
+/**
+ * Tell whether a started transfer has not been executed yet (i.e. nobody waited for it).
+ * It does not touch the registers, so it doesn't complete the transfer.
+ * @return true: a transfer is pending
+ */
+bool lv_test_dma2d_is_pending(void);
+
+/**
+ * Get the number of transfers executed since the last `lv_test_dma2d_reset()`
+ * @return number of transfers
+ */
+uint32_t lv_test_dma2d_get_transfer_cnt(void);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_TEST_DMA2D_H*/
@@ -0,0 +1,340 @@
+#if LV_BUILD_TEST
+/*DMA2D supports only 16 and 32 bit colors, the tests are skipped with the other color depths*/
+#if LV_COLOR_DEPTH == 16 || LV_COLOR_DEPTH == 32
+
+/*Build the STM32 DMA2D draw context against the host-side DMA2D model (see lv_test_dma2d.h)*/
+#define LV_USE_GPU_STM32_DMA2D 1
+#define LV_GPU_DMA2D_CMSIS_INCLUDE "lv_test_dma2d.h"
+#include "../lvgl.h"
+
+#include "unity/unity.h"
+
+/*Some helpers of the driver are not wired into the draw context yet*/
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include "../../src/draw/stm32_dma2d/lv_gpu_stm32_dma2d.c"
+
+#define BUF_W   64
+#define BUF_H   48
+
+static lv_color_t buf_sw[BUF_W * BUF_H];
+static lv_color_t buf_hw[BUF_W * BUF_H];
+static lv_opa_t mask_buf[BUF_W * BUF_H];
+static lv_color_t src_buf[BUF_W * BUF_H];
+static lv_draw_sw_ctx_t ctx_sw;
+static lv_draw_stm32_dma2d_ctx_t ctx_hw;
+static lv_area_t buf_area;
+
+static uint32_t rnd_state;
+
+static uint32_t rnd(void)
+{
+    rnd_state = rnd_state * 1103515245 + 12345;
+    return rnd_state >> 8;
+}
+
+static void init_ctx(lv_draw_sw_ctx_t * ctx, lv_color_t * buf)
+{
+    ctx->base_draw.buf = buf;
+    ctx->base_draw.buf_area = &buf_area;
+    ctx->base_draw.clip_area = &buf_area;
+}
+
+void setUp(void)
+{
+    uint32_t i;
+
+    rnd_state = 1;
+    lv_test_dma2d_reset();
+    _lv_refr_set_disp_refreshing(lv_disp_get_default());
+
+    lv_area_set(&buf_area, 0, 0, BUF_W - 1, BUF_H - 1);
+    lv_draw_sw_init_ctx(NULL, &ctx_sw.base_draw);
+    lv_draw_stm32_dma2d_ctx_init(NULL, &ctx_hw.base_draw);
+    init_ctx(&ctx_sw, buf_sw);
+    init_ctx(&ctx_hw, buf_hw);
+
+    for(i = 0; i < BUF_W * BUF_H; i++) {
+        uint32_t r = rnd();
+        buf_sw[i] = lv_color_make(r & 0xFF, (r >> 8) & 0xFF, (r >> 16) & 0xFF);
+        buf_hw[i] = buf_sw[i];
+        r = rnd();
+        src_buf[i] = lv_color_make(r & 0xFF, (r >> 8) & 0xFF, (r >> 16) & 0xFF);
+        /*Make fully transparent and opaque pixels frequent as in glyphs*/
+        r = rnd() % 4;
+        mask_buf[i] = r == 0 ? LV_OPA_TRANSP : r == 1 ? LV_OPA_COVER : (lv_opa_t)rnd();
+    }
+}
+
+void tearDown(void)
+{
+    _lv_refr_set_disp_refreshing(NULL);
+}
+
+static uint32_t max_channel_diff(void)
+{
+    uint32_t max_diff = 0;
+    uint32_t i;
+    for(i = 0; i < BUF_W * BUF_H; i++) {
+        uint32_t sw32 = lv_color_to32(buf_sw[i]);
+        uint32_t hw32 = lv_color_to32(buf_hw[i]);
+        uint32_t shift;
+        for(shift = 0; shift < 32; shift += 8) {
+            int32_t d = (int32_t)((sw32 >> shift) & 0xFF) - (int32_t)((hw32 >> shift) & 0xFF);
+            if(d < 0) d = -d;
+            if((uint32_t)d > max_diff) max_diff = d;
+        }
+    }
+    return max_diff;
+}
+
+static void blend_both(const lv_draw_sw_blend_dsc_t * dsc)
+{
+    lv_draw_sw_blend(&ctx_sw.base_draw, dsc);
+    lv_draw_sw_blend(&ctx_hw.base_draw, dsc);
+    lv_draw_wait_for_finish(&ctx_hw.base_draw);
+}
+
+void test_fill_is_asynchronous(void)
+{
+    lv_area_t a;
+    lv_area_set(&a, 3, 5, 40, 30);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.color = lv_palette_main(LV_PALETTE_RED);
+    dsc.opa = LV_OPA_COVER;
+
+    lv_draw_sw_blend(&ctx_sw.base_draw, &dsc);
+    lv_draw_sw_blend(&ctx_hw.base_draw, &dsc);
+
+    /*The CPU gets back control before the DMA2D finishes*/
+    TEST_ASSERT_TRUE(lv_test_dma2d_is_pending());
+    TEST_ASSERT_NOT_EQUAL(0, max_channel_diff());
+
+    lv_draw_wait_for_finish(&ctx_hw.base_draw);
+    TEST_ASSERT_FALSE(lv_test_dma2d_is_pending());
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+}
+
+void test_back_to_back_draws_await_the_pending_fill(void)
+{
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, 50, 40);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.color = lv_palette_main(LV_PALETTE_BLUE);
+    dsc.opa = LV_OPA_COVER;
+
+    lv_img_dsc_t img;
+    lv_memset_00(&img, sizeof(img));
+    img.header.w = 20;
+    img.header.h = 16;
+    img.header.cf = LV_IMG_CF_TRUE_COLOR;
+    img.data_size = 20 * 16 * sizeof(lv_color_t);
+    img.data = (const uint8_t *)src_buf;
+
+    lv_draw_img_dsc_t img_dsc;
+    lv_draw_img_dsc_init(&img_dsc);
+
+    lv_area_t coords;
+    lv_area_set(&coords, 30, 20, 30 + 20 - 1, 20 + 16 - 1);
+
+    /*The image is drawn while the fill is still running*/
+    lv_draw_sw_blend(&ctx_sw.base_draw, &dsc);
+    lv_draw_sw_blend(&ctx_hw.base_draw, &dsc);
+    TEST_ASSERT_TRUE(lv_test_dma2d_is_pending());
+
+    lv_draw_img(&ctx_sw.base_draw, &img_dsc, &coords, &img);
+    lv_draw_img(&ctx_hw.base_draw, &img_dsc, &coords, &img);
+    lv_draw_wait_for_finish(&ctx_hw.base_draw);
+
+    TEST_ASSERT_EQUAL(2, lv_test_dma2d_get_transfer_cnt());
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+
+    lv_img_cache_invalidate_src(&img);
+}
+
+void test_fill_with_opa_matches_sw(void)
+{
+    static const lv_opa_t opas[] = {LV_OPA_10, LV_OPA_50, 0x81, LV_OPA_90, LV_OPA_MAX - 1};
+    lv_area_t a;
+    lv_area_set(&a, -10, 7, 50, 60);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.color = lv_color_make(0x12, 0xa5, 0xfe);
+
+    uint32_t i;
+    for(i = 0; i < sizeof(opas) / sizeof(opas[0]); i++) {
+        dsc.opa = opas[i];
+        blend_both(&dsc);
+        TEST_ASSERT_EQUAL(0, max_channel_diff());
+    }
+}
+
+void test_map_matches_sw(void)
+{
+    lv_area_t a;
+    lv_area_set(&a, 2, 2, BUF_W - 3, BUF_H - 3);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.src_buf = src_buf;
+
+    dsc.opa = LV_OPA_COVER;
+    blend_both(&dsc);
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+
+    dsc.opa = LV_OPA_40;
+    blend_both(&dsc);
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+}
+
+void test_a8_mask_paint_matches_sw(void)
+{
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, BUF_W - 1, BUF_H - 1);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.mask_area = &a;
+    dsc.mask_buf = mask_buf;
+    dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+    dsc.color = lv_color_make(0xf0, 0x40, 0x08);
+
+    dsc.opa = LV_OPA_COVER;
+    blend_both(&dsc);
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+    TEST_ASSERT_EQUAL(1, lv_test_dma2d_get_transfer_cnt());
+
+    /*DMA2D multiplies mask and opa as m * opa / 255 while draw_sw uses (m * opa) >> 8*/
+    dsc.opa = LV_OPA_60;
+    blend_both(&dsc);
+    TEST_ASSERT_LESS_OR_EQUAL(1, max_channel_diff());
+}
+
+void test_map_with_mask_matches_sw(void)
+{
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, BUF_W - 1, BUF_H - 1);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.src_buf = src_buf;
+    dsc.mask_area = &a;
+    dsc.mask_buf = mask_buf;
+    dsc.mask_res = LV_DRAW_MASK_RES_CHANGED;
+
+    dsc.opa = LV_OPA_COVER;
+    blend_both(&dsc);
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+    /*The area is larger than the staging buffer so it's blended in bands*/
+    TEST_ASSERT_EQUAL((BUF_W * BUF_H + STAGING_BUF_PX - 1) / STAGING_BUF_PX, lv_test_dma2d_get_transfer_cnt());
+
+    dsc.opa = LV_OPA_70;
+    blend_both(&dsc);
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+}
+
+void test_label_matches_sw(void)
+{
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    dsc.color = lv_color_make(0x20, 0x30, 0xd0);
+
+    lv_area_t coords;
+    lv_area_set(&coords, -3, 4, BUF_W + 10, BUF_H);
+
+    lv_draw_label(&ctx_sw.base_draw, &dsc, &coords, "Chrom-ART Wg", NULL);
+    lv_draw_label(&ctx_hw.base_draw, &dsc, &coords, "Chrom-ART Wg", NULL);
+    lv_draw_wait_for_finish(&ctx_hw.base_draw);
+
+    TEST_ASSERT_NOT_EQUAL(0, lv_test_dma2d_get_transfer_cnt());
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+}
+
+void test_argb_img_matches_sw(void)
+{
+    static uint8_t img_data[20 * 16 * LV_IMG_PX_SIZE_ALPHA_BYTE];
+    uint32_t i;
+    for(i = 0; i < sizeof(img_data); i++) img_data[i] = (uint8_t)rnd();
+
+    lv_img_dsc_t img;
+    lv_memset_00(&img, sizeof(img));
+    img.header.always_zero = 0;
+    img.header.w = 20;
+    img.header.h = 16;
+    img.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+    img.data_size = sizeof(img_data);
+    img.data = img_data;
+
+    lv_draw_img_dsc_t dsc;
+    lv_draw_img_dsc_init(&dsc);
+
+    lv_area_t coords;
+    lv_area_set(&coords, 10, 20, 10 + 20 - 1, 20 + 16 - 1);
+
+    lv_draw_img(&ctx_sw.base_draw, &dsc, &coords, &img);
+    lv_draw_img(&ctx_hw.base_draw, &dsc, &coords, &img);
+    lv_draw_wait_for_finish(&ctx_hw.base_draw);
+
+    TEST_ASSERT_NOT_EQUAL(0, lv_test_dma2d_get_transfer_cnt());
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+
+    lv_img_cache_invalidate_src(&img);
+}
+
+void test_unsupported_blend_mode_falls_back_to_sw(void)
+{
+    lv_area_t a;
+    lv_area_set(&a, 0, 0, 20, 20);
+
+    lv_draw_sw_blend_dsc_t dsc;
+    lv_memset_00(&dsc, sizeof(dsc));
+    dsc.blend_area = &a;
+    dsc.color = lv_color_make(0x40, 0x40, 0x40);
+    dsc.opa = LV_OPA_COVER;
+
+    /*Leave a fill running to check that the fallback waits for it*/
+    lv_draw_sw_blend(&ctx_sw.base_draw, &dsc);
+    lv_draw_sw_blend(&ctx_hw.base_draw, &dsc);
+
+    dsc.blend_mode = LV_BLEND_MODE_ADDITIVE;
+    blend_both(&dsc);
+
+    TEST_ASSERT_EQUAL(1, lv_test_dma2d_get_transfer_cnt());
+    TEST_ASSERT_EQUAL(0, max_channel_diff());
+}
+
+#else
+
+#include "unity/unity.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+#define SKIPPED_TEST(name) void name(void) { TEST_IGNORE(); }
+SKIPPED_TEST(test_fill_is_asynchronous)
+SKIPPED_TEST(test_back_to_back_draws_await_the_pending_fill)
+SKIPPED_TEST(test_fill_with_opa_matches_sw)
+SKIPPED_TEST(test_map_matches_sw)
+SKIPPED_TEST(test_a8_mask_paint_matches_sw)
+SKIPPED_TEST(test_map_with_mask_matches_sw)
+SKIPPED_TEST(test_label_matches_sw)
+SKIPPED_TEST(test_argb_img_matches_sw)
+SKIPPED_TEST(test_unsupported_blend_mode_falls_back_to_sw)
+
+#endif /*LV_COLOR_DEPTH == 16 || LV_COLOR_DEPTH == 32*/
+#endif
@@ -0,0 +1,350 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../src/draw/sw/lv_draw_sw_blend_rgb565.h"
+
+#include "unity/unity.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/*Odd stride so that the rows alternate between 4 byte aligned and unaligned starts*/
+#define BUF_W   97
+#define BUF_H   40
+
+#define BENCH_W     480
+#define BENCH_H     10
+#define BENCH_RUNS  300
+
+static uint16_t buf_ref[BUF_W * BUF_H];
+static uint16_t buf_res[BUF_W * BUF_H];
+static uint16_t src_buf[BUF_W * BUF_H];
+static lv_opa_t mask_buf[BUF_W * BUF_H];
+
+static uint32_t rnd_state;
+
+static uint32_t rnd(void)
+{
+    rnd_state = rnd_state * 1103515245 + 12345;
+    return rnd_state >> 8;
+}
+
+void setUp(void)
+{
+    uint32_t i;
+
+    rnd_state = 1;
+    for(i = 0; i < BUF_W * BUF_H; i++) {
+        buf_ref[i] = (uint16_t)rnd();
+        buf_res[i] = buf_ref[i];
+        src_buf[i] = (uint16_t)rnd();
+        /*Make fully transparent and opaque pixels frequent as in glyphs*/
+        uint32_t r = rnd() % 4;
+        mask_buf[i] = r == 0 ? LV_OPA_TRANSP : r == 1 ? LV_OPA_COVER : (lv_opa_t)rnd();
+    }
+}
+
+void tearDown(void)
+{
+    /* Function run after every test */
+}
+
+/**********************
+ * Reference: the per-pixel code of lv_draw_sw_blend.c with LV_COLOR_DEPTH 16
+ **********************/
+
+static uint16_t ref_mix(uint16_t c1, uint16_t c2, uint8_t mix)
+{
+    mix = (uint32_t)((uint32_t)mix + 4) >> 3;
+    uint32_t bg = (uint32_t)((uint32_t)c2 | ((uint32_t)c2 << 16)) & 0x7E0F81F;
+    uint32_t fg = (uint32_t)((uint32_t)c1 | ((uint32_t)c1 << 16)) & 0x7E0F81F;
+    uint32_t result = ((((fg - bg) * mix) >> 5) + bg) & 0x7E0F81F;
+    return (uint16_t)((result >> 16) | result);
+}
+
+static uint16_t ref_mix_premult(const uint16_t * premult, uint16_t bg, lv_opa_t opa_inv)
+{
+    uint32_t r = LV_UDIV255(premult[0] + (uint32_t)(bg >> 11) * opa_inv);
+    uint32_t g = LV_UDIV255(premult[1] + (uint32_t)((bg >> 5) & 0x3F) * opa_inv);
+    uint32_t b = LV_UDIV255(premult[2] + (uint32_t)(bg & 0x1F) * opa_inv);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void ref_fill(uint16_t * dest, int32_t stride, int32_t w, int32_t h, uint16_t color)
+{
+    int32_t x, y;
+    for(y = 0; y < h; y++) {
+        for(x = 0; x < w; x++) dest[x] = color;
+        dest += stride;
+    }
+}
+
+static void ref_fill_opa(uint16_t * dest, int32_t stride, int32_t w, int32_t h, uint16_t color, lv_opa_t opa)
+{
+    uint16_t premult[3];
+    premult[0] = (uint16_t)((color >> 11) * opa);
+    premult[1] = (uint16_t)(((color >> 5) & 0x3F) * opa);
+    premult[2] = (uint16_t)((color & 0x1F) * opa);
+    lv_opa_t opa_inv = 255 - opa;
+
+    int32_t x, y;
+    for(y = 0; y < h; y++) {
+        for(x = 0; x < w; x++) dest[x] = ref_mix_premult(premult, dest[x], opa_inv);
+        dest += stride;
+    }
+}
+
+static void ref_fill_mask(uint16_t * dest, int32_t stride, int32_t w, int32_t h, uint16_t color,
+                          const lv_opa_t * mask, int32_t mask_stride)
+{
+    int32_t x, y;
+    for(y = 0; y < h; y++) {
+        for(x = 0; x < w; x++) {
+            if(mask[x] == LV_OPA_COVER) dest[x] = color;
+            else dest[x] = ref_mix(color, dest[x], mask[x]);
+        }
+        dest += stride;
+        mask += mask_stride;
+    }
+}
+
+static void ref_copy(uint16_t * dest, int32_t dest_stride, const uint16_t * src, int32_t src_stride,
+                     int32_t w, int32_t h)
+{
+    int32_t y;
+    for(y = 0; y < h; y++) {
+        lv_memcpy(dest, src, w * sizeof(uint16_t));
+        dest += dest_stride;
+        src += src_stride;
+    }
+}
+
+static void ref_copy_opa(uint16_t * dest, int32_t dest_stride, const uint16_t * src, int32_t src_stride,
+                         int32_t w, int32_t h, lv_opa_t opa)
+{
+    int32_t x, y;
+    for(y = 0; y < h; y++) {
+        for(x = 0; x < w; x++) dest[x] = ref_mix(src[x], dest[x], opa);
+        dest += dest_stride;
+        src += src_stride;
+    }
+}
+
+static void ref_copy_mask(uint16_t * dest, int32_t dest_stride, const uint16_t * src, int32_t src_stride,
+                          int32_t w, int32_t h, const lv_opa_t * mask, int32_t mask_stride)
+{
+    int32_t x, y;
+    for(y = 0; y < h; y++) {
+        for(x = 0; x < w; x++) {
+            if(mask[x] == LV_OPA_COVER) dest[x] = src[x];
+            else if(mask[x]) dest[x] = ref_mix(src[x], dest[x], mask[x]);
+        }
+        dest += dest_stride;
+        src += src_stride;
+        mask += mask_stride;
+    }
+}
+
+/**********************
+ * Helpers
+ **********************/
+
+/*Areas starting at every alignment with widths around the unrolled loops' boundaries*/
+static const int32_t xs[] = {0, 1, 2, 3};
+static const int32_t ws[] = {1, 2, 3, 4, 5, 7, 8, 9, 16, 17, 33, 64, 93};
+
+#define FOR_EACH_AREA(x_ofs, w)                                                     \
+    for(uint32_t _xi = 0; _xi < sizeof(xs) / sizeof(xs[0]); _xi++)                  \
+        for(uint32_t _wi = 0; _wi < sizeof(ws) / sizeof(ws[0]); _wi++)              \
+            for(int32_t x_ofs = xs[_xi], w = ws[_wi]; w > 0; w = 0)
+
+static void check_same(void)
+{
+    TEST_ASSERT_EQUAL_HEX16_ARRAY(buf_ref, buf_res, BUF_W * BUF_H);
+}
+
+static void bench(const char * name, void (*ref_cb)(uint16_t *), void (*res_cb)(uint16_t *))
+{
+    static uint16_t bench_buf[BENCH_W * BENCH_H + 1];
+    uint32_t i;
+    clock_t t_ref, t_res;
+
+    /*Use an unaligned start as the draw buffers often have*/
+    for(i = 0; i < BENCH_W * BENCH_H + 1; i++) bench_buf[i] = (uint16_t)rnd();
+    t_ref = clock();
+    for(i = 0; i < BENCH_RUNS; i++) ref_cb(bench_buf + 1);
+    t_ref = clock() - t_ref;
+
+    t_res = clock();
+    for(i = 0; i < BENCH_RUNS; i++) res_cb(bench_buf + 1);
+    t_res = clock() - t_res;
+
+    char msg[128];
+    snprintf(msg, sizeof(msg), "%s: per-pixel %ld us, word-at-a-time %ld us (%d runs of %dx%d px)", name,
+             (long)(t_ref * 1000000 / CLOCKS_PER_SEC), (long)(t_res * 1000000 / CLOCKS_PER_SEC),
+             BENCH_RUNS, BENCH_W, BENCH_H);
+    TEST_MESSAGE(msg);
+}
+
+/**********************
+ * Tests
+ **********************/
+
+void test_fill_is_pixel_exact(void)
+{
+    FOR_EACH_AREA(x_ofs, w) {
+        ref_fill(buf_ref + x_ofs, BUF_W, w, BUF_H, (uint16_t)(w * 1021));
+        lv_draw_sw_rgb565_fill(buf_res + x_ofs, BUF_W, w, BUF_H, (uint16_t)(w * 1021));
+        check_same();
+    }
+}
+
+void test_fill_opa_is_pixel_exact(void)
+{
+    static const lv_opa_t opas[] = {LV_OPA_10, LV_OPA_50, 0x81, LV_OPA_90, 248};
+    uint32_t i;
+    for(i = 0; i < sizeof(opas) / sizeof(opas[0]); i++) {
+        FOR_EACH_AREA(x_ofs, w) {
+            uint16_t color = (uint16_t)rnd();
+            ref_fill_opa(buf_ref + x_ofs, BUF_W, w, BUF_H, color, opas[i]);
+            lv_draw_sw_rgb565_fill_opa(buf_res + x_ofs, BUF_W, w, BUF_H, color, opas[i]);
+            check_same();
+        }
+    }
+}
+
+void test_fill_opa_on_uniform_bg_is_pixel_exact(void)
+{
+    /*Exercise the cache of the last result, including a black background*/
+    ref_fill(buf_ref, BUF_W, BUF_W, BUF_H, 0x0000);
+    ref_fill(buf_res, BUF_W, BUF_W, BUF_H, 0x0000);
+    ref_fill(buf_ref + 10, BUF_W, 20, BUF_H, 0x1234);
+    ref_fill(buf_res + 10, BUF_W, 20, BUF_H, 0x1234);
+
+    ref_fill_opa(buf_ref + 1, BUF_W, 60, BUF_H, 0xf81f, LV_OPA_40);
+    lv_draw_sw_rgb565_fill_opa(buf_res + 1, BUF_W, 60, BUF_H, 0xf81f, LV_OPA_40);
+    check_same();
+}
+
+void test_fill_mask_is_pixel_exact(void)
+{
+    FOR_EACH_AREA(x_ofs, w) {
+        uint16_t color = (uint16_t)rnd();
+        ref_fill_mask(buf_ref + x_ofs, BUF_W, w, BUF_H, color, mask_buf + x_ofs, BUF_W);
+        lv_draw_sw_rgb565_fill_mask(buf_res + x_ofs, BUF_W, w, BUF_H, color, mask_buf + x_ofs, BUF_W);
+        check_same();
+    }
+}
+
+void test_copy_is_pixel_exact(void)
+{
+    int32_t src_ofs;
+    for(src_ofs = 0; src_ofs < 4; src_ofs++) {
+        FOR_EACH_AREA(x_ofs, w) {
+            ref_copy(buf_ref + x_ofs, BUF_W, src_buf + src_ofs, BUF_W, w, BUF_H);
+            lv_draw_sw_rgb565_copy(buf_res + x_ofs, BUF_W, src_buf + src_ofs, BUF_W, w, BUF_H);
+            check_same();
+        }
+    }
+}
+
+void test_copy_opa_is_pixel_exact(void)
+{
+    static const lv_opa_t opas[] = {LV_OPA_10, LV_OPA_50, 0x81, LV_OPA_90, LV_OPA_MAX - 1};
+    uint32_t i;
+    for(i = 0; i < sizeof(opas) / sizeof(opas[0]); i++) {
+        FOR_EACH_AREA(x_ofs, w) {
+            ref_copy_opa(buf_ref + x_ofs, BUF_W, src_buf + i, BUF_W, w, BUF_H, opas[i]);
+            lv_draw_sw_rgb565_copy_opa(buf_res + x_ofs, BUF_W, src_buf + i, BUF_W, w, BUF_H, opas[i]);
+            check_same();
+        }
+    }
+}
+
+void test_copy_mask_is_pixel_exact(void)
+{
+    int32_t src_ofs;
+    for(src_ofs = 0; src_ofs < 4; src_ofs++) {
+        FOR_EACH_AREA(x_ofs, w) {
+            ref_copy_mask(buf_ref + x_ofs, BUF_W, src_buf + src_ofs, BUF_W, w, BUF_H, mask_buf + x_ofs, BUF_W);
+            lv_draw_sw_rgb565_copy_mask(buf_res + x_ofs, BUF_W, src_buf + src_ofs, BUF_W, w, BUF_H, mask_buf + x_ofs,
+                                        BUF_W);
+            check_same();
+        }
+    }
+}
+
+/**********************
+ * Micro-benchmarks: they only report, the timing is not asserted
+ **********************/
+
+static uint16_t bench_src[BENCH_W * BENCH_H];
+static lv_opa_t bench_mask[BENCH_W * BENCH_H];
+
+static void bench_ref_fill(uint16_t * buf)
+{
+    ref_fill(buf, BENCH_W, BENCH_W, BENCH_H, 0x1234);
+}
+
+static void bench_res_fill(uint16_t * buf)
+{
+    lv_draw_sw_rgb565_fill(buf, BENCH_W, BENCH_W, BENCH_H, 0x1234);
+}
+
+static void bench_ref_fill_opa(uint16_t * buf)
+{
+    ref_fill_opa(buf, BENCH_W, BENCH_W, BENCH_H, 0x1234, LV_OPA_50);
+}
+
+static void bench_res_fill_opa(uint16_t * buf)
+{
+    lv_draw_sw_rgb565_fill_opa(buf, BENCH_W, BENCH_W, BENCH_H, 0x1234, LV_OPA_50);
+}
+
+static void bench_ref_fill_mask(uint16_t * buf)
+{
+    ref_fill_mask(buf, BENCH_W, BENCH_W, BENCH_H, 0x1234, bench_mask, BENCH_W);
+}
+
+static void bench_res_fill_mask(uint16_t * buf)
+{
+    lv_draw_sw_rgb565_fill_mask(buf, BENCH_W, BENCH_W, BENCH_H, 0x1234, bench_mask, BENCH_W);
+}
+
+static void bench_ref_copy(uint16_t * buf)
+{
+    ref_copy(buf, BENCH_W, bench_src, BENCH_W, BENCH_W, BENCH_H);
+}
+
+static void bench_res_copy(uint16_t * buf)
+{
+    lv_draw_sw_rgb565_copy(buf, BENCH_W, bench_src, BENCH_W, BENCH_W, BENCH_H);
+}
+
+static void bench_ref_copy_mask(uint16_t * buf)
+{
+    ref_copy_mask(buf, BENCH_W, bench_src, BENCH_W, BENCH_W, BENCH_H, bench_mask, BENCH_W);
+}
+
+static void bench_res_copy_mask(uint16_t * buf)
+{
+    lv_draw_sw_rgb565_copy_mask(buf, BENCH_W, bench_src, BENCH_W, BENCH_W, BENCH_H, bench_mask, BENCH_W);
+}
+
+void test_benchmark(void)
+{
+    uint32_t i;
+    /*Glyph-like mask: transparent and covered runs with anti-aliased edges*/
+    for(i = 0; i < BENCH_W * BENCH_H; i++) {
+        bench_src[i] = (uint16_t)rnd();
+        uint32_t phase = i % 16;
+        bench_mask[i] = phase < 6 ? LV_OPA_TRANSP : phase < 7 || phase == 15 ? (lv_opa_t)rnd() : LV_OPA_COVER;
+    }
+
+    bench("fill", bench_ref_fill, bench_res_fill);
+    bench("fill opa", bench_ref_fill_opa, bench_res_fill_opa);
+    bench("fill mask", bench_ref_fill_mask, bench_res_fill_mask);
+    bench("copy", bench_ref_copy, bench_res_copy);
+    bench("copy mask", bench_ref_copy_mask, bench_res_copy_mask);
+}
+
+#endif
@@ -0,0 +1,253 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../src/draw/sw/lv_draw_sw_gradient.h"
+
+#include "unity/unity.h"
+
+#include <stdio.h>
+#include <time.h>
+
+#define SCREEN_W        800
+#define SCREEN_H        480
+#define BENCH_OBJ_CNT   48
+#define BENCH_RUNS      10
+
+extern lv_color_t test_fb[];
+
+static lv_grad_dsc_t grad_a;
+static lv_grad_dsc_t grad_a_copy;
+static lv_grad_dsc_t grad_b;
+
+static void grad_init(lv_grad_dsc_t * g, lv_grad_dir_t dir, uint32_t c1, uint32_t c2)
+{
+    lv_memset_00(g, sizeof(*g));
+    g->dir = dir;
+    g->stops_count = 2;
+    g->stops[0].color = lv_color_hex(c1);
+    g->stops[0].frac = 0;
+    g->stops[1].color = lv_color_hex(c2);
+    g->stops[1].frac = 255;
+}
+
+void setUp(void)
+{
+    grad_init(&grad_a, LV_GRAD_DIR_VER, 0x102030, 0x405060);
+    grad_init(&grad_a_copy, LV_GRAD_DIR_VER, 0x102030, 0x405060);
+    grad_init(&grad_b, LV_GRAD_DIR_VER, 0x102030, 0x4050a0);
+
+    lv_gradient_free_cache();
+    lv_gradient_set_cache_size(8 * 1024);
+    lv_gradient_reset_cache_stat();
+}
+
+void tearDown(void)
+{
+    lv_obj_clean(lv_scr_act());
+    lv_obj_clear_flag(lv_layer_sys(), LV_OBJ_FLAG_HIDDEN);
+    lv_gradient_set_cache_size(LV_GRAD_CACHE_DEF_SIZE);
+}
+
+void test_equal_gradients_share_item(void)
+{
+    lv_grad_cache_stat_t stat;
+
+    lv_grad_t * g1 = lv_gradient_get(&grad_a, 20, 30);
+    lv_gradient_cleanup(g1);
+    /*Different descriptor with the same content*/
+    lv_grad_t * g2 = lv_gradient_get(&grad_a_copy, 20, 30);
+    lv_gradient_cleanup(g2);
+    TEST_ASSERT_EQUAL_PTR(g1, g2);
+
+    /*Different color, it must not collide*/
+    lv_grad_t * g3 = lv_gradient_get(&grad_b, 20, 30);
+    lv_gradient_cleanup(g3);
+    TEST_ASSERT_NOT_EQUAL(g1, g3);
+
+    /*Different height*/
+    lv_grad_t * g4 = lv_gradient_get(&grad_a, 20, 31);
+    lv_gradient_cleanup(g4);
+    TEST_ASSERT_NOT_EQUAL(g1, g4);
+    TEST_ASSERT_EQUAL(31, g4->size);
+
+    lv_gradient_get_cache_stat(&stat);
+    TEST_ASSERT_EQUAL(1, stat.hit);
+    TEST_ASSERT_EQUAL(3, stat.miss);
+    TEST_ASSERT_EQUAL(3, stat.item_cnt);
+    TEST_ASSERT_EQUAL(0, stat.evict);
+    TEST_ASSERT_LESS_OR_EQUAL(stat.max_size, stat.used_size);
+}
+
+void test_map_content(void)
+{
+    lv_coord_t i;
+    lv_grad_t * g = lv_gradient_get(&grad_a, 10, 50);
+#if _DITHER_GRADIENT
+    for(i = 0; i < 50; i++) TEST_ASSERT_EQUAL_HEX32(lv_gradient_calculate(&grad_a, 50, i).full, g->hmap[i].full);
+#else
+    for(i = 0; i < 50; i++) TEST_ASSERT_EQUAL_HEX32(lv_gradient_calculate(&grad_a, 50, i).full, g->map[i].full);
+#endif
+    lv_gradient_cleanup(g);
+}
+
+void test_lru_eviction(void)
+{
+    lv_grad_cache_stat_t stat;
+    lv_grad_dsc_t grads[3];
+    uint32_t i;
+    for(i = 0; i < 3; i++) grad_init(&grads[i], LV_GRAD_DIR_VER, 0x000000, 0x111111 * i);
+
+    /*Make room for 2 items only*/
+    lv_gradient_cleanup(lv_gradient_get(&grads[0], 100, 100));
+    lv_gradient_get_cache_stat(&stat);
+    lv_gradient_set_cache_size(stat.used_size * 2 + stat.used_size / 2);
+
+    lv_gradient_cleanup(lv_gradient_get(&grads[1], 100, 100));
+    lv_gradient_cleanup(lv_gradient_get(&grads[0], 100, 100));    /*Now grads[1] is the least recently used*/
+    lv_gradient_cleanup(lv_gradient_get(&grads[2], 100, 100));    /*Evicts grads[1]*/
+
+    lv_gradient_reset_cache_stat();
+    lv_gradient_cleanup(lv_gradient_get(&grads[0], 100, 100));
+    lv_gradient_cleanup(lv_gradient_get(&grads[2], 100, 100));
+    lv_gradient_get_cache_stat(&stat);
+    TEST_ASSERT_EQUAL(2, stat.hit);
+    TEST_ASSERT_EQUAL(0, stat.miss);
+
+    lv_gradient_cleanup(lv_gradient_get(&grads[1], 100, 100));
+    lv_gradient_get_cache_stat(&stat);
+    TEST_ASSERT_EQUAL(1, stat.miss);
+    TEST_ASSERT_EQUAL(1, stat.evict);
+    TEST_ASSERT_EQUAL(2, stat.item_cnt);
+    TEST_ASSERT_LESS_OR_EQUAL(stat.max_size, stat.used_size);
+
+    /*Shrinking the cache evicts too*/
+    lv_gradient_set_cache_size(stat.used_size - 1);
+    lv_gradient_get_cache_stat(&stat);
+    TEST_ASSERT_EQUAL(1, stat.item_cnt);
+}
+
+void test_too_large_is_not_cached(void)
+{
+    lv_grad_cache_stat_t stat;
+    lv_gradient_set_cache_size(256);
+
+    lv_grad_t * g = lv_gradient_get(&grad_a, 200, 200);
+    TEST_ASSERT_NOT_NULL(g);
+    TEST_ASSERT_EQUAL(1, g->not_cached);
+    lv_gradient_cleanup(g);
+
+    lv_gradient_get_cache_stat(&stat);
+    TEST_ASSERT_EQUAL(1, stat.not_cached);
+    TEST_ASSERT_EQUAL(0, stat.item_cnt);
+    TEST_ASSERT_EQUAL(0, stat.used_size);
+}
+
+void test_ordered_dither_rows(void)
+{
+#if _DITHER_GRADIENT
+    static lv_color_t ref_rows[8 * 37];
+    lv_coord_t y, x;
+    grad_a.dir = LV_GRAD_DIR_HOR;
+    grad_a.dither = LV_DITHER_ORDERED;
+
+    /*Dither line by line as without the cache*/
+    lv_gradient_set_cache_size(0);
+    lv_grad_t * ref = lv_gradient_get(&grad_a, 37, 20);
+    TEST_ASSERT_EQUAL(1, ref->not_cached);
+    lv_color_t * ref_map = ref->map;
+    for(y = 0; y < 8; y++) {
+        ref->map = ref_rows + y * 37;
+        lv_dither_ordered_hor(ref, 0, y, 37);
+    }
+    ref->map = ref_map;
+    lv_gradient_cleanup(ref);
+
+    lv_gradient_set_cache_size(8 * 1024);
+    lv_grad_t * g = lv_gradient_get(&grad_a, 37, 20);
+    TEST_ASSERT_EQUAL(0, g->not_cached);
+    TEST_ASSERT_EQUAL(1, g->dither_rows);
+    for(x = 0; x < 8 * 37; x++) TEST_ASSERT_EQUAL_HEX32(ref_rows[x].full, g->map[x].full);
+    lv_gradient_cleanup(g);
+#endif
+}
+
+/**********************
+ * Gradient-heavy screen: it compares the rendering with and without cache and reports the time
+ **********************/
+
+static void create_gradient_screen(void)
+{
+    static lv_style_t styles[4];
+    static const lv_grad_dir_t dirs[4] = {LV_GRAD_DIR_VER, LV_GRAD_DIR_HOR, LV_GRAD_DIR_VER, LV_GRAD_DIR_HOR};
+    static const lv_dither_mode_t dithers[4] = {LV_DITHER_NONE, LV_DITHER_NONE, LV_DITHER_ORDERED, LV_DITHER_ORDERED};
+    uint32_t i;
+
+    for(i = 0; i < 4; i++) {
+        lv_style_init(&styles[i]);
+        lv_style_set_bg_color(&styles[i], lv_palette_main(LV_PALETTE_BLUE + i));
+        lv_style_set_bg_grad_color(&styles[i], lv_palette_darken(LV_PALETTE_BLUE + i, 4));
+        lv_style_set_bg_grad_dir(&styles[i], dirs[i]);
+        lv_style_set_bg_dither_mode(&styles[i], dithers[i]);
+        lv_style_set_radius(&styles[i], 8);
+    }
+
+    lv_obj_t * scr = lv_scr_act();
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x303030), 0);
+    lv_obj_set_style_bg_grad_color(scr, lv_color_hex(0x000000), 0);
+    lv_obj_set_style_bg_grad_dir(scr, LV_GRAD_DIR_VER, 0);
+    /*Avoid scrollbars, their fading would make the frames different*/
+    lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
+    /*The performance and memory monitors are different on every frame*/
+    lv_obj_add_flag(lv_layer_sys(), LV_OBJ_FLAG_HIDDEN);
+
+    for(i = 0; i < BENCH_OBJ_CNT; i++) {
+        /*Themed buttons: every style is used by many objects of the same size*/
+        lv_obj_t * btn = lv_btn_create(scr);
+        lv_obj_add_style(btn, &styles[i % 4], 0);
+        lv_obj_set_size(btn, 180, 34);
+        lv_obj_set_pos(btn, 10 + (i % 4) * 195, 10 + (i / 4) * 38);
+    }
+}
+
+static long render(uint32_t runs)
+{
+    uint32_t i;
+    clock_t t = clock();
+    for(i = 0; i < runs; i++) {
+        lv_obj_invalidate(lv_scr_act());
+        lv_refr_now(NULL);
+    }
+    return (long)((clock() - t) * 1000000 / CLOCKS_PER_SEC);
+}
+
+void test_gradient_screen(void)
+{
+    static lv_color_t fb_ref[SCREEN_W * SCREEN_H];
+    lv_grad_cache_stat_t stat;
+
+    create_gradient_screen();
+
+    lv_gradient_set_cache_size(0);
+    render(1);
+    lv_memcpy(fb_ref, test_fb, sizeof(fb_ref));
+    long t_uncached = render(BENCH_RUNS);
+
+    lv_gradient_set_cache_size(32 * 1024);
+    lv_gradient_reset_cache_stat();
+    render(1);
+    TEST_ASSERT_EQUAL_MEMORY(fb_ref, test_fb, sizeof(fb_ref));
+    long t_cached = render(BENCH_RUNS);
+    lv_gradient_get_cache_stat(&stat);
+
+    /*Every gradient is computed once*/
+    TEST_ASSERT_EQUAL(0, stat.evict);
+    TEST_ASSERT_EQUAL(stat.item_cnt, stat.miss);
+    TEST_ASSERT_GREATER_THAN(stat.miss * BENCH_RUNS, stat.hit);
+
+    char msg[160];
+    snprintf(msg, sizeof(msg), "gradient screen: not cached %ld us, cached %ld us (%d runs), "
+             "%u items, %u bytes, %u hits, %u misses", t_uncached, t_cached, BENCH_RUNS,
+             (unsigned)stat.item_cnt, (unsigned)stat.used_size, (unsigned)stat.hit, (unsigned)stat.miss);
+    TEST_MESSAGE(msg);
+}
+
+#endif
@@ -1,8 +1,11 @@
 #if LV_BUILD_TEST
 #include "../lvgl.h"
+#include "../../src/misc/lv_gc.h"
 
 #include "unity/unity.h"
 
+#include <time.h>
+
 
 const char * read_exp =
     "Lorem ipsum dolor sit amet, consectetur adipiscing elit. Etiam sed maximus orci. Morbi massa nisi, varius eu convallis ac, venenatis at metus. In in nibh id urna pretium feugiat vitae eu libero. Ut eget fringilla eros. Nunc ullamcorper lectus mauris, vel rhoncus velit volutpat et. Phasellus sed molestie massa. Maecenas quis dui sollicitudin, vulputate nunc ut, dictum quam. Nam a congue lorem. Nulla non facilisis sapien. Ut luctus nulla nibh, sed finibus urna porta non. Duis aliquet augue id urna euismod auctor. Integer pellentesque vulputate enim non mattis. Donec finibus mattis dolor, et feugiat nisi pharetra porta. Mauris ullamcorper cursus magna. Orci varius natoque penatibus et magnis dis parturient montes, nascetur ridiculus mus.";
@@ -50,4 +53,253 @@ void test_read(void)
     lv_fs_close(&fb);
 }
 
+void test_cache_random_read(void)
+{
+    /*'A' caches 100 byte blocks, read across them in random order*/
+    lv_fs_file_t f;
+    lv_fs_res_t res = lv_fs_open(&f, "A:src/test_files/readtest.txt", LV_FS_MODE_RD);
+    TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+
+    uint32_t len = strlen(read_exp) + 1;  /*The file ends with a '\0'*/
+    uint32_t seed = 1;
+    uint8_t buf[256];
+    uint32_t i;
+    for(i = 0; i < 500; i++) {
+        seed = seed * 1103515245 + 12345;
+        uint32_t pos = (seed >> 8) % len;
+        uint32_t btr = (seed >> 20) % sizeof(buf);
+        uint32_t br;
+
+        res = lv_fs_seek(&f, pos, LV_FS_SEEK_SET);
+        TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+        res = lv_fs_read(&f, buf, btr, &br);
+        TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+        TEST_ASSERT_EQUAL(LV_MIN(btr, len - pos), br);
+        TEST_ASSERT_TRUE(memcmp(buf, read_exp + pos, br) == 0);
+
+        uint32_t tell;
+        lv_fs_tell(&f, &tell);
+        TEST_ASSERT_EQUAL(pos + br, tell);
+    }
+
+    lv_fs_close(&f);
+}
+
+void test_cache_shared(void)
+{
+    lv_fs_file_t fa;
+    lv_fs_file_t fb;
+    lv_fs_open(&fa, "A:src/test_files/readtest.txt", LV_FS_MODE_RD);
+    lv_fs_open(&fb, "A:src/test_files/readtest.txt", LV_FS_MODE_RD);
+    TEST_ASSERT_EQUAL_PTR(fa.cache, fb.cache);
+
+    uint8_t buf[50];
+    uint32_t br;
+    lv_fs_read(&fa, buf, sizeof(buf), &br);
+
+    /*The other file finds the data in the cache*/
+    lv_fs_cache_stat_t stat;
+    lv_fs_cache_reset_stat();
+    lv_fs_read(&fb, buf, sizeof(buf), &br);
+    TEST_ASSERT_EQUAL(sizeof(buf), br);
+    TEST_ASSERT_TRUE(memcmp(buf, read_exp, br) == 0);
+    lv_fs_cache_get_stat(&stat);
+    TEST_ASSERT_EQUAL(1, stat.hits);
+    TEST_ASSERT_EQUAL(0, stat.drv_reads);
+
+    lv_fs_close(&fa);
+    lv_fs_close(&fb);
+}
+
+void test_cache_prefetch(void)
+{
+    lv_fs_file_t f;
+    lv_fs_open(&f, "A:src/test_files/readtest.txt", LV_FS_MODE_RD);
+    lv_fs_cache_reset_stat();
+
+    /*Only the first block is missed, the next ones are read ahead*/
+    uint8_t buf[7];
+    uint32_t cnt = 0;
+    uint32_t br = 1;
+    while(br) {
+        lv_fs_read(&f, buf, sizeof(buf), &br);
+        TEST_ASSERT_TRUE(memcmp(buf, read_exp + cnt, br) == 0);
+        cnt += br;
+    }
+    TEST_ASSERT_EQUAL(strlen(read_exp) + 1, cnt);
+
+    lv_fs_cache_stat_t stat;
+    lv_fs_cache_get_stat(&stat);
+    TEST_ASSERT_EQUAL(1, stat.misses);
+    TEST_ASSERT_TRUE(stat.prefetches > 0);
+    TEST_ASSERT_EQUAL(cnt / 100 + 1, stat.drv_reads);
+
+    lv_fs_close(&f);
+}
+
+#define WRITE_TEST_FILE "/tmp/lv_test_fs_cache.txt"
+
+static void check_file(const char * exp)
+{
+    /*'B' has no cache*/
+    lv_fs_file_t f;
+    lv_fs_res_t res = lv_fs_open(&f, "B:" WRITE_TEST_FILE, LV_FS_MODE_RD);
+    TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+
+    static char buf[1024];
+    uint32_t br;
+    lv_fs_read(&f, buf, sizeof(buf), &br);
+    TEST_ASSERT_EQUAL(strlen(exp), br);
+    TEST_ASSERT_TRUE(memcmp(buf, exp, br) == 0);
+    lv_fs_close(&f);
+}
+
+void test_cache_write(void)
+{
+    uint32_t len = strlen(read_exp);
+    uint32_t bw;
+    uint32_t i;
+
+    /*Small writes are collected into blocks*/
+    lv_fs_file_t fw;
+    lv_fs_res_t res = lv_fs_open(&fw, "A:" WRITE_TEST_FILE, LV_FS_MODE_WR);
+    TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+    lv_fs_cache_reset_stat();
+    for(i = 0; i < len; i += 7) {
+        res = lv_fs_write(&fw, read_exp + i, LV_MIN(7, len - i), &bw);
+        TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+    }
+    lv_fs_close(&fw);
+
+    lv_fs_cache_stat_t stat;
+    lv_fs_cache_get_stat(&stat);
+    TEST_ASSERT_EQUAL((len + 99) / 100, stat.drv_writes);
+    check_file(read_exp);
+
+    /*Modify a part, the files opened for reading see the change after it's written*/
+    lv_fs_file_t fr;
+    char buf[50];
+    uint32_t br;
+    lv_fs_open(&fr, "A:" WRITE_TEST_FILE, LV_FS_MODE_RD);
+    lv_fs_read(&fr, buf, sizeof(buf), &br);
+
+    res = lv_fs_open(&fw, "A:" WRITE_TEST_FILE, LV_FS_MODE_WR | LV_FS_MODE_RD);
+    TEST_ASSERT_EQUAL(LV_FS_RES_OK, res);
+    lv_fs_seek(&fw, 95, LV_FS_SEEK_SET);
+    lv_fs_write(&fw, "0123456789", 10, &bw);
+    lv_fs_seek(&fw, 0, LV_FS_SEEK_END);
+    lv_fs_write(&fw, "END", 3, &bw);
+    lv_fs_close(&fw);
+
+    static char exp[1024];
+    lv_snprintf(exp, sizeof(exp), "%.95s0123456789%sEND", read_exp, read_exp + 105);
+    check_file(exp);
+
+    lv_fs_seek(&fr, 90, LV_FS_SEEK_SET);
+    lv_fs_read(&fr, buf, 20, &br);
+    TEST_ASSERT_EQUAL(20, br);
+    TEST_ASSERT_TRUE(memcmp(buf, exp + 90, br) == 0);
+    lv_fs_close(&fr);
+
+    /*Writing after the end leaves zeros between*/
+    lv_fs_open(&fw, "A:" WRITE_TEST_FILE, LV_FS_MODE_WR | LV_FS_MODE_RD);
+    lv_fs_seek(&fw, len + 3 + 10, LV_FS_SEEK_SET);
+    lv_fs_write(&fw, "X", 1, &bw);
+    lv_fs_seek(&fw, len, LV_FS_SEEK_SET);
+    lv_fs_read(&fw, buf, sizeof(buf), &br);
+    TEST_ASSERT_EQUAL(14, br);
+    TEST_ASSERT_EQUAL_MEMORY("END\0\0\0\0\0\0\0\0\0\0X", buf, 14);
+    lv_fs_close(&fw);
+
+    remove(WRITE_TEST_FILE);
+}
+
+#if LV_USE_PNG && LV_USE_SJPG
+
+#define BENCH_LOOPS         20
+#define BENCH_CACHE_SIZE    4096
+
+/*Decode the image with the decoders directly, without the asynchronous one and the image cache*/
+static void decode(const void * src)
+{
+    lv_ll_t * ll = &LV_GC_ROOT(_lv_img_decoder_ll);
+    lv_img_decoder_t * d;
+    lv_img_decoder_dsc_t dsc;
+    static uint8_t line[1024 * LV_IMG_PX_SIZE_ALPHA_BYTE];
+
+    d = _lv_ll_get_head(ll);
+#if LV_USE_IMG_ASYNC
+    d = _lv_ll_get_next(ll, d);     /*The asynchronous decoder is the first*/
+#endif
+    for(; d; d = _lv_ll_get_next(ll, d)) {
+        lv_memset_00(&dsc, sizeof(dsc));
+        dsc.src = src;
+        dsc.src_type = LV_IMG_SRC_FILE;
+        dsc.decoder = d;
+        if(d->info_cb == NULL || d->info_cb(d, src, &dsc.header) != LV_RES_OK) continue;
+        if(d->open_cb(d, &dsc) != LV_RES_OK) continue;
+
+        if(dsc.img_data == NULL) {
+            TEST_ASSERT_TRUE(dsc.header.w <= 1024);
+            lv_coord_t y;
+            for(y = 0; y < dsc.header.h; y++) {
+                TEST_ASSERT_EQUAL(LV_RES_OK, d->read_line_cb(d, &dsc, 0, y, dsc.header.w, line));
+            }
+        }
+        if(d->close_cb) d->close_cb(d, &dsc);
+        return;
+    }
+
+    TEST_FAIL_MESSAGE("The image couldn't be decoded");
+}
+
+static void bench(const char * src, uint16_t cache_size)
+{
+    lv_fs_drv_t * drv = lv_fs_get_drv('B');
+    uint16_t cache_size_ori = drv->cache_size;
+    drv->cache_size = cache_size;
+
+    lv_fs_cache_reset_stat();
+    struct timespec start;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint32_t i;
+    for(i = 0; i < BENCH_LOOPS; i++) decode(src);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    drv->cache_size = cache_size_ori;
+
+    lv_fs_cache_stat_t stat;
+    lv_fs_cache_get_stat(&stat);
+    uint32_t us = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000;
+    printf("%-40s cache %4d: %7d us, %6d driver reads, %6d hits, %4d misses, %4d prefetches\n",
+           src, cache_size, (int)(us / BENCH_LOOPS), (int)(stat.drv_reads / BENCH_LOOPS),
+           (int)(stat.hits / BENCH_LOOPS), (int)(stat.misses / BENCH_LOOPS), (int)(stat.prefetches / BENCH_LOOPS));
+
+    if(cache_size == 0) TEST_ASSERT_EQUAL(0, stat.hits + stat.misses);
+}
+
+/*Not a real test, it prints how much the cache helps the decoders reading through 'B'*/
+void test_cache_decode_bench(void)
+{
+    static const char * srcs[] = {
+        "B:../examples/libs/png/wink.png",
+        "B:../examples/libs/sjpg/small_image.sjpg",
+    };
+
+    uint32_t i;
+    for(i = 0; i < sizeof(srcs) / sizeof(srcs[0]); i++) {
+        bench(srcs[i], 0);
+        bench(srcs[i], BENCH_CACHE_SIZE);
+    }
+}
+
+#else
+
+void test_cache_decode_bench(void)
+{
+    TEST_IGNORE();
+}
+
+#endif /*LV_USE_PNG && LV_USE_SJPG*/
+
 #endif
@@ -0,0 +1,360 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+
+#include "unity/unity.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*A drive which keeps the files in memory and lets them be used in place*/
+#define MAP_LETTER      'M'
+#define MAP_FILE_MAX    8
+#define IMG_W           13
+#define IMG_H           5
+
+typedef struct {
+    char path[64];
+    uint8_t * data;
+    uint32_t size;
+} map_file_t;
+
+typedef struct {
+    map_file_t * file;
+    uint32_t pos;
+} map_handle_t;
+
+extern lv_font_t font_1;
+extern lv_font_t font_2;
+extern lv_font_t font_3;
+
+static map_file_t map_files[MAP_FILE_MAX];
+static lv_fs_drv_t map_drv;
+static uint32_t map_cnt;
+
+static map_file_t * map_file_find(const char * path)
+{
+    uint32_t i;
+    for(i = 0; i < MAP_FILE_MAX; i++) {
+        if(map_files[i].data && strcmp(map_files[i].path, path) == 0) return &map_files[i];
+    }
+    return NULL;
+}
+
+static map_file_t * map_file_add(const char * path, uint32_t size)
+{
+    uint32_t i;
+    for(i = 0; i < MAP_FILE_MAX; i++) {
+        if(map_files[i].data == NULL) {
+            lv_snprintf(map_files[i].path, sizeof(map_files[i].path), "%s", path);
+            /*Aligned like the files of a ROMFS image*/
+            map_files[i].data = calloc(1, (size + 3) & ~3);
+            map_files[i].size = size;
+            return &map_files[i];
+        }
+    }
+    return NULL;
+}
+
+/*Files not created by the test are loaded from the disk when they are opened first*/
+static void * map_open(lv_fs_drv_t * drv, const char * path, lv_fs_mode_t mode)
+{
+    LV_UNUSED(drv);
+    if(mode != LV_FS_MODE_RD) return NULL;
+
+    map_file_t * file = map_file_find(path);
+    if(file == NULL) {
+        FILE * fp = fopen(path, "rb");
+        if(fp == NULL) return NULL;
+        fseek(fp, 0, SEEK_END);
+        file = map_file_add(path, ftell(fp));
+        fseek(fp, 0, SEEK_SET);
+        TEST_ASSERT_NOT_NULL(file);
+        TEST_ASSERT_EQUAL(1, fread(file->data, file->size, 1, fp));
+        fclose(fp);
+    }
+
+    map_handle_t * h = lv_mem_alloc(sizeof(map_handle_t));
+    h->file = file;
+    h->pos = 0;
+    return h;
+}
+
+static lv_fs_res_t map_close(lv_fs_drv_t * drv, void * file_p)
+{
+    LV_UNUSED(drv);
+    lv_mem_free(file_p);
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t map_read(lv_fs_drv_t * drv, void * file_p, void * buf, uint32_t btr, uint32_t * br)
+{
+    LV_UNUSED(drv);
+    map_handle_t * h = file_p;
+    if(btr > h->file->size - h->pos) btr = h->file->size - h->pos;
+    lv_memcpy(buf, h->file->data + h->pos, btr);
+    h->pos += btr;
+    *br = btr;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t map_seek(lv_fs_drv_t * drv, void * file_p, uint32_t pos, lv_fs_whence_t whence)
+{
+    LV_UNUSED(drv);
+    map_handle_t * h = file_p;
+    if(whence == LV_FS_SEEK_CUR) pos += h->pos;
+    else if(whence == LV_FS_SEEK_END) pos += h->file->size;
+    if(pos > h->file->size) return LV_FS_RES_INV_PARAM;
+    h->pos = pos;
+    return LV_FS_RES_OK;
+}
+
+static lv_fs_res_t map_tell(lv_fs_drv_t * drv, void * file_p, uint32_t * pos_p)
+{
+    LV_UNUSED(drv);
+    *pos_p = ((map_handle_t *)file_p)->pos;
+    return LV_FS_RES_OK;
+}
+
+static const void * map_map(lv_fs_drv_t * drv, void * file_p, uint32_t * size_p)
+{
+    LV_UNUSED(drv);
+    map_handle_t * h = file_p;
+    map_cnt++;
+    *size_p = h->file->size;
+    return h->file->data;
+}
+
+void setUp(void)
+{
+    if(lv_fs_get_drv(MAP_LETTER) == NULL) {
+        lv_fs_drv_init(&map_drv);
+        map_drv.letter = MAP_LETTER;
+        map_drv.open_cb = map_open;
+        map_drv.close_cb = map_close;
+        map_drv.read_cb = map_read;
+        map_drv.seek_cb = map_seek;
+        map_drv.tell_cb = map_tell;
+        lv_fs_drv_register(&map_drv);
+    }
+    map_drv.map_cb = map_map;
+    map_cnt = 0;
+}
+
+void tearDown(void)
+{
+    map_drv.map_cb = map_map;
+}
+
+static bool in_file(const void * p, const char * path)
+{
+    map_file_t * file = map_file_find(path);
+    TEST_ASSERT_NOT_NULL(file);
+    return (const uint8_t *)p >= file->data && (const uint8_t *)p < file->data + file->size;
+}
+
+/*Compare a glyph as the font engine gives it, the bitmaps of a font used in place aren't byte aligned*/
+static uint32_t compare_glyph(const lv_font_t * f1, const lv_font_t * f2, uint32_t letter)
+{
+    static uint8_t bitmap[1024];
+    lv_font_glyph_dsc_t g1;
+    lv_font_glyph_dsc_t g2;
+    bool found = lv_font_get_glyph_dsc(f1, &g1, letter, 0);
+    TEST_ASSERT_EQUAL(found, lv_font_get_glyph_dsc(f2, &g2, letter, 0));
+    if(!found) return 0;
+
+    TEST_ASSERT_EQUAL(g1.adv_w, g2.adv_w);
+    TEST_ASSERT_EQUAL(g1.box_w, g2.box_w);
+    TEST_ASSERT_EQUAL(g1.box_h, g2.box_h);
+    TEST_ASSERT_EQUAL(g1.ofs_x, g2.ofs_x);
+    TEST_ASSERT_EQUAL(g1.ofs_y, g2.ofs_y);
+    TEST_ASSERT_EQUAL(g1.bpp, g2.bpp);
+
+    uint32_t size = (g1.box_w * g1.box_h * g1.bpp + 7) / 8;
+    if(size == 0) return 1;
+    TEST_ASSERT_TRUE(size <= sizeof(bitmap));
+
+    /*The bitmap of compressed fonts is in a shared buffer*/
+    const uint8_t * b1 = lv_font_get_glyph_bitmap(f1, letter);
+    TEST_ASSERT_NOT_NULL(b1);
+    lv_memcpy(bitmap, b1, size);
+    const uint8_t * b2 = lv_font_get_glyph_bitmap(f2, letter);
+    TEST_ASSERT_NOT_NULL(b2);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(bitmap, b2, size);
+    return 1;
+}
+
+static void compare_glyphs(const lv_font_t * f1, const lv_font_t * f2)
+{
+    const lv_font_fmt_txt_dsc_t * dsc = f1->dsc;
+    uint32_t glyph_cnt = 0;
+    uint32_t i;
+
+    for(i = 0; i < dsc->cmap_num; i++) {
+        uint32_t letter;
+        for(letter = dsc->cmaps[i].range_start; letter < dsc->cmaps[i].range_start + dsc->cmaps[i].range_length; letter++) {
+            glyph_cnt += compare_glyph(f1, f2, letter);
+        }
+    }
+
+    TEST_ASSERT_TRUE(glyph_cnt > 0);
+}
+
+static void test_font(const lv_font_t * ref, const char * path)
+{
+    lv_font_t * font = lv_font_load(path);
+    TEST_ASSERT_NOT_NULL(font);
+    TEST_ASSERT_TRUE(map_cnt > 0);
+
+    /*The bitmaps are used in place*/
+    lv_font_fmt_txt_dsc_t * dsc = font->dsc;
+    TEST_ASSERT_TRUE(in_file(dsc->glyph_bitmap, path + 2));
+    compare_glyphs(ref, font);
+
+    lv_font_free(font);
+}
+
+void test_font_in_place(void)
+{
+    test_font(&font_1, "M:src/test_fonts/font_1.fnt");
+    test_font(&font_2, "M:src/test_fonts/font_2.fnt");
+    test_font(&font_3, "M:src/test_fonts/font_3.fnt");
+}
+
+void test_font_copied(void)
+{
+    map_drv.map_cb = NULL;
+
+    lv_font_t * font = lv_font_load("M:src/test_fonts/font_2.fnt");
+    TEST_ASSERT_NOT_NULL(font);
+    lv_font_fmt_txt_dsc_t * dsc = font->dsc;
+    TEST_ASSERT_FALSE(in_file(dsc->glyph_bitmap, "src/test_fonts/font_2.fnt"));
+    compare_glyphs(&font_2, font);
+    lv_font_free(font);
+}
+
+/*Truncated files must not be read past their end*/
+void test_font_truncated(void)
+{
+    map_file_t * src = map_file_find("src/test_fonts/font_1.fnt");
+    TEST_ASSERT_NOT_NULL(src);
+
+    uint32_t size;
+    for(size = src->size - 1; size > 0; size -= LV_MIN(size, 97)) {
+        map_file_t * file = map_file_add("font_1_cut.fnt", size);
+        TEST_ASSERT_NOT_NULL(file);
+        lv_memcpy(file->data, src->data, size);
+
+        lv_font_t * font = lv_font_load("M:font_1_cut.fnt");
+        if(font) lv_font_free(font);
+
+        free(file->data);
+        file->data = NULL;
+    }
+}
+
+/*Create the same image as a file and as a variable*/
+static void create_img(const char * path, lv_img_cf_t cf, lv_img_dsc_t * var)
+{
+    uint32_t size = lv_img_buf_get_img_size(IMG_W, IMG_H, cf);
+    map_file_t * file = map_file_find(path);
+    if(file == NULL) {
+        file = map_file_add(path, sizeof(lv_img_header_t) + size);
+        TEST_ASSERT_NOT_NULL(file);
+
+        lv_img_header_t * header = (lv_img_header_t *)file->data;
+        header->cf = cf;
+        header->w = IMG_W;
+        header->h = IMG_H;
+
+        uint32_t i;
+        uint8_t * data = file->data + sizeof(lv_img_header_t);
+        for(i = 0; i < size; i++) data[i] = (uint8_t)(i * 37 + 11);
+
+        /*Opaque palette*/
+        uint32_t palette_size = cf == LV_IMG_CF_INDEXED_4BIT ? 16 : 0;
+        for(i = 0; i < palette_size; i++) data[i * 4 + 3] = 0xff;
+    }
+
+    lv_memset_00(var, sizeof(lv_img_dsc_t));
+    lv_memcpy(&var->header, file->data, sizeof(lv_img_header_t));
+    var->data_size = size;
+    var->data = file->data + sizeof(lv_img_header_t);
+}
+
+/*Read the image line by line as the draw functions do*/
+static void read_img(const void * src, uint8_t * buf, const uint8_t ** img_data)
+{
+    lv_img_decoder_dsc_t dsc;
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_img_decoder_open(&dsc, src, lv_color_black(), 0));
+    *img_data = dsc.img_data;
+
+    lv_coord_t y;
+    for(y = 0; y < IMG_H && dsc.img_data == NULL; y++) {
+        TEST_ASSERT_EQUAL(LV_RES_OK, lv_img_decoder_read_line(&dsc, 0, y, IMG_W,
+                                                              buf + y * IMG_W * LV_IMG_PX_SIZE_ALPHA_BYTE));
+    }
+    lv_img_decoder_close(&dsc);
+}
+
+static void test_img(lv_img_cf_t cf, bool direct)
+{
+    static uint8_t buf_var[IMG_W * IMG_H * LV_IMG_PX_SIZE_ALPHA_BYTE];
+    static uint8_t buf_map[IMG_W * IMG_H * LV_IMG_PX_SIZE_ALPHA_BYTE];
+    static uint8_t buf_copy[IMG_W * IMG_H * LV_IMG_PX_SIZE_ALPHA_BYTE];
+    const uint8_t * data_var;
+    const uint8_t * data_map;
+    const uint8_t * data_copy;
+    char path[32];
+    lv_img_dsc_t var;
+
+    lv_snprintf(path, sizeof(path), "img_%d.bin", cf);
+    create_img(path, cf, &var);
+    lv_memset_00(buf_var, sizeof(buf_var));
+    lv_memset_00(buf_map, sizeof(buf_map));
+    lv_memset_00(buf_copy, sizeof(buf_copy));
+
+    char src[36];
+    lv_snprintf(src, sizeof(src), "M:%s", path);
+    read_img(&var, buf_var, &data_var);
+    read_img(src, buf_map, &data_map);
+    map_drv.map_cb = NULL;
+    read_img(src, buf_copy, &data_copy);
+    map_drv.map_cb = map_map;
+
+    if(direct) {
+        /*Given in place instead of being read line by line*/
+        TEST_ASSERT_EQUAL_PTR(var.data, data_map);
+        TEST_ASSERT_NULL(data_copy);
+    }
+    else {
+        TEST_ASSERT_NULL(data_map);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(buf_var, buf_map, sizeof(buf_var));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(buf_copy, buf_map, sizeof(buf_var));
+    }
+}
+
+void test_img_in_place(void)
+{
+    test_img(LV_IMG_CF_TRUE_COLOR, true);
+    test_img(LV_IMG_CF_TRUE_COLOR_ALPHA, true);
+    test_img(LV_IMG_CF_ALPHA_4BIT, false);
+    test_img(LV_IMG_CF_INDEXED_4BIT, false);
+}
+
+/*The image data is shorter than the header tells, it must not be used in place*/
+void test_img_truncated(void)
+{
+    map_file_t * file = map_file_add("img_cut.bin", sizeof(lv_img_header_t) + 8);
+    TEST_ASSERT_NOT_NULL(file);
+    lv_img_header_t * header = (lv_img_header_t *)file->data;
+    header->cf = LV_IMG_CF_TRUE_COLOR;
+    header->w = IMG_W;
+    header->h = IMG_H;
+
+    lv_img_decoder_dsc_t dsc;
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_img_decoder_open(&dsc, "M:img_cut.bin", lv_color_black(), 0));
+    TEST_ASSERT_NULL(dsc.img_data);
+    lv_img_decoder_close(&dsc);
+}
+
+#endif
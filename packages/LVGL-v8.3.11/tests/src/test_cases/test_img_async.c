@@ -0,0 +1,244 @@
+#if LV_BUILD_TEST
+#include "../lvgl.h"
+#include "../../src/misc/lv_gc.h"
+
+#include "unity/unity.h"
+
+#include <unistd.h>
+
+#if LV_USE_IMG_ASYNC && LV_USE_PNG && LV_USE_SJPG
+
+#define PNG_FILE    "A:../examples/libs/png/wink.png"
+#define SJPG_FILE   "A:../examples/libs/sjpg/small_image.sjpg"
+
+LV_IMG_DECLARE(img_wink_png)
+
+void setUp(void)
+{
+    lv_img_cache_invalidate_src(NULL);
+}
+
+void tearDown(void)
+{
+    lv_img_async_set_paused(false);
+    lv_img_async_cancel_all();
+    lv_obj_clean(lv_scr_act());
+    lv_img_cache_invalidate_src(NULL);
+}
+
+/*Let the LVGL timers (notification, screen load, refresh) run*/
+static void run_timers(void)
+{
+    uint32_t i;
+    for(i = 0; i < 2; i++) {
+        lv_tick_inc(LV_DISP_DEF_REFR_PERIOD);
+        lv_timer_handler();
+    }
+}
+
+static void wait_decoded(void)
+{
+    uint32_t i;
+    for(i = 0; i < 5000 && lv_img_async_get_pending_cnt(); i++) usleep(1000);
+    TEST_ASSERT_EQUAL(0, lv_img_async_get_pending_cnt());
+
+    run_timers();
+}
+
+/*Open the image with the decoders behind the asynchronous one*/
+static lv_res_t sync_open(lv_img_decoder_dsc_t * dsc, const void * src)
+{
+    lv_ll_t * ll = &LV_GC_ROOT(_lv_img_decoder_ll);
+    lv_img_decoder_t * d = _lv_ll_get_next(ll, _lv_ll_get_head(ll));
+
+    lv_memset_00(dsc, sizeof(lv_img_decoder_dsc_t));
+    dsc->src = src;
+    dsc->src_type = lv_img_src_get_type(src);
+    while(d) {
+        if(d->info_cb && d->info_cb(d, src, &dsc->header) == LV_RES_OK) {
+            dsc->decoder = d;
+            if(d->open_cb(d, dsc) == LV_RES_OK) return LV_RES_OK;
+        }
+        d = _lv_ll_get_next(ll, d);
+    }
+
+    return LV_RES_INV;
+}
+
+static _lv_img_cache_entry_t * show_and_decode(const void * src)
+{
+    lv_obj_t * img = lv_img_create(lv_scr_act());
+    lv_img_set_src(img, src);
+
+    /*The first refresh opens a placeholder*/
+    lv_img_async_set_paused(true);
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(1, lv_img_async_get_pending_cnt());
+
+    _lv_img_cache_entry_t * entry = _lv_img_cache_open(src, lv_color_black(), 0);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_NULL(entry->dec_dsc.img_data);
+
+    uint8_t line[4 * LV_IMG_PX_SIZE_ALPHA_BYTE];
+    lv_color_t c = LV_IMG_ASYNC_PLACEHOLDER_COLOR;
+    lv_color_t px;
+    lv_img_decoder_read_line(&entry->dec_dsc, 0, 0, 4, line);
+    lv_memcpy_small(&px, line, sizeof(lv_color_t));
+    TEST_ASSERT_EQUAL_HEX32(lv_color_to32(c) & 0xffffff, lv_color_to32(px) & 0xffffff);
+    if(lv_img_cf_has_alpha(entry->dec_dsc.header.cf)) {
+        TEST_ASSERT_EQUAL(LV_IMG_ASYNC_PLACEHOLDER_OPA, line[LV_IMG_PX_SIZE_ALPHA_BYTE - 1]);
+    }
+
+    lv_img_async_set_paused(false);
+    wait_decoded();
+
+    /*Redrawn with the decoded image*/
+    entry = _lv_img_cache_open(src, lv_color_black(), 0);
+    TEST_ASSERT_NOT_NULL(entry);
+    TEST_ASSERT_NOT_NULL(entry->dec_dsc.img_data);
+
+    return entry;
+}
+
+void test_png_file(void)
+{
+    lv_img_decoder_dsc_t ref;
+    _lv_img_cache_entry_t * entry = show_and_decode(PNG_FILE);
+
+    TEST_ASSERT_EQUAL(LV_RES_OK, sync_open(&ref, PNG_FILE));
+    TEST_ASSERT_NOT_NULL(ref.img_data);
+    TEST_ASSERT_EQUAL(ref.header.w, entry->dec_dsc.header.w);
+    TEST_ASSERT_EQUAL(ref.header.h, entry->dec_dsc.header.h);
+    TEST_ASSERT_EQUAL(LV_IMG_CF_TRUE_COLOR_ALPHA, entry->dec_dsc.header.cf);
+    TEST_ASSERT_EQUAL_MEMORY(ref.img_data, entry->dec_dsc.img_data,
+                             ref.header.w * ref.header.h * LV_IMG_PX_SIZE_ALPHA_BYTE);
+    ref.decoder->close_cb(ref.decoder, &ref);
+}
+
+void test_png_variable(void)
+{
+    lv_img_decoder_dsc_t ref;
+    _lv_img_cache_entry_t * entry = show_and_decode(&img_wink_png);
+
+    TEST_ASSERT_EQUAL(LV_RES_OK, sync_open(&ref, &img_wink_png));
+    TEST_ASSERT_EQUAL_MEMORY(ref.img_data, entry->dec_dsc.img_data,
+                             ref.header.w * ref.header.h * LV_IMG_PX_SIZE_ALPHA_BYTE);
+    ref.decoder->close_cb(ref.decoder, &ref);
+}
+
+void test_sjpg_file_is_assembled_from_lines(void)
+{
+    static lv_color_t line[1024];
+    lv_img_decoder_dsc_t ref;
+    lv_coord_t y;
+    _lv_img_cache_entry_t * entry = show_and_decode(SJPG_FILE);
+
+    TEST_ASSERT_EQUAL(LV_RES_OK, sync_open(&ref, SJPG_FILE));
+    TEST_ASSERT_NULL(ref.img_data);
+    TEST_ASSERT_EQUAL(LV_IMG_CF_TRUE_COLOR, entry->dec_dsc.header.cf);
+    TEST_ASSERT_LESS_OR_EQUAL(1024, ref.header.w);
+
+    const lv_color_t * data = (const lv_color_t *)entry->dec_dsc.img_data;
+    for(y = 0; y < ref.header.h; y++) {
+        ref.decoder->read_line_cb(ref.decoder, &ref, 0, y, ref.header.w, (uint8_t *)line);
+        TEST_ASSERT_EQUAL_MEMORY(line, data + y * ref.header.w, ref.header.w * sizeof(lv_color_t));
+    }
+    ref.decoder->close_cb(ref.decoder, &ref);
+}
+
+void test_prefetch(void)
+{
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_img_async_prefetch(PNG_FILE));
+    /*Only the images of the PNG, SJPG, etc. decoders are decoded asynchronously*/
+    TEST_ASSERT_EQUAL(LV_RES_INV, lv_img_async_prefetch("A:src/test_files/readtest.txt"));
+    wait_decoded();
+
+    /*Ready on the first draw*/
+    lv_obj_t * img = lv_img_create(lv_scr_act());
+    lv_img_set_src(img, PNG_FILE);
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(0, lv_img_async_get_pending_cnt());
+
+    _lv_img_cache_entry_t * entry = _lv_img_cache_open(PNG_FILE, lv_color_black(), 0);
+    TEST_ASSERT_NOT_NULL(entry->dec_dsc.img_data);
+}
+
+void test_cancel(void)
+{
+    lv_img_async_set_paused(true);
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_img_async_prefetch(PNG_FILE));
+    TEST_ASSERT_EQUAL(LV_RES_OK, lv_img_async_prefetch(SJPG_FILE));
+    TEST_ASSERT_EQUAL(2, lv_img_async_get_pending_cnt());
+
+    lv_img_async_cancel(PNG_FILE);
+    TEST_ASSERT_EQUAL(1, lv_img_async_get_pending_cnt());
+    lv_img_async_cancel_all();
+    TEST_ASSERT_EQUAL(0, lv_img_async_get_pending_cnt());
+}
+
+void test_cancel_on_screen_change(void)
+{
+    lv_obj_t * scr_old = lv_scr_act();
+    lv_obj_t * img = lv_img_create(scr_old);
+    lv_img_set_src(img, PNG_FILE);
+
+    lv_img_async_set_paused(true);
+    lv_refr_now(NULL);
+    TEST_ASSERT_EQUAL(1, lv_img_async_get_pending_cnt());
+
+    /*Prefetched images are kept*/
+    lv_img_async_prefetch(SJPG_FILE);
+
+    lv_obj_t * scr_new = lv_obj_create(NULL);
+    lv_scr_load(scr_new);
+    run_timers();
+    TEST_ASSERT_EQUAL(1, lv_img_async_get_pending_cnt());
+
+    lv_scr_load(scr_old);
+    run_timers();
+    lv_obj_del(scr_new);
+}
+
+#else
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void test_png_file(void)
+{
+    TEST_IGNORE();
+}
+
+void test_png_variable(void)
+{
+    TEST_IGNORE();
+}
+
+void test_sjpg_file_is_assembled_from_lines(void)
+{
+    TEST_IGNORE();
+}
+
+void test_prefetch(void)
+{
+    TEST_IGNORE();
+}
+
+void test_cancel(void)
+{
+    TEST_IGNORE();
+}
+
+void test_cancel_on_screen_change(void)
+{
+    TEST_IGNORE();
+}
+
+#endif
+
+#endif
@@ -95,6 +95,177 @@ static int get_disk(rt_device_t id)
     return -1;
 }
 
+#ifdef RT_DFS_ELM_USE_FASTSEEK
+/*
+ * Cluster link maps of the large files opened for reading.
+ *
+ * Without a map every backward seek walks the FAT chain from the first
+ * cluster of the file. The map holds the fragments of the chain so a seek
+ * only looks up the fragment. The maps are shared by the opens of a file and
+ * kept after the last close, the file is known by its first cluster and size.
+ * A map is dropped when clusters of its volume may have been freed, i.e. by
+ * truncate, unlink, unmount and mkfs; a map in use is freed after the last
+ * close.
+ */
+#ifndef RT_DFS_ELM_FASTSEEK_SIZE
+#define RT_DFS_ELM_FASTSEEK_SIZE        65536
+#endif
+#ifndef RT_DFS_ELM_FASTSEEK_FRAGS_MAX
+#define RT_DFS_ELM_FASTSEEK_FRAGS_MAX   64
+#endif
+#ifndef RT_DFS_ELM_FASTSEEK_CACHE
+#define RT_DFS_ELM_FASTSEEK_CACHE       4
+#endif
+
+/* the map is the size, the length and first cluster of every fragment and 0 */
+#define CLMT_LEN(frags)     (2 + 2 * (frags))
+
+struct elm_clmt
+{
+    FATFS *fat;                 /* RT_NULL: free entry */
+    DWORD sclust;               /* first cluster of the file */
+    FSIZE_t size;
+    DWORD *tbl;
+    rt_uint16_t ref;            /* opens using the map */
+    rt_bool_t stale;            /* free the map after the last close */
+    rt_uint32_t used;           /* age for the replacement */
+};
+
+static struct elm_clmt elm_clmt_cache[RT_DFS_ELM_FASTSEEK_CACHE];
+static struct rt_mutex elm_clmt_lock;
+static rt_uint32_t elm_clmt_age;
+
+static void elm_clmt_free(struct elm_clmt *entry)
+{
+    rt_free(entry->tbl);
+    rt_memset(entry, 0, sizeof(struct elm_clmt));
+}
+
+/* walk the FAT chain of the file once and store its fragments */
+static DWORD *elm_clmt_create(FIL *fd)
+{
+    DWORD len = CLMT_LEN(4), *tbl;
+    FRESULT result;
+
+    while (1)
+    {
+        tbl = (DWORD *)rt_malloc(len * sizeof(DWORD));
+        if (tbl == RT_NULL)
+            return RT_NULL;
+
+        tbl[0] = len;
+        fd->cltbl = tbl;
+        result = f_lseek(fd, CREATE_LINKMAP);
+        fd->cltbl = RT_NULL;
+        if (result == FR_OK)
+            break;
+
+        /* the required length is returned if the map is too small */
+        len = tbl[0];
+        rt_free(tbl);
+        if (result != FR_NOT_ENOUGH_CORE || len > CLMT_LEN(RT_DFS_ELM_FASTSEEK_FRAGS_MAX))
+            return RT_NULL;
+    }
+
+    /* shrink it to the used length */
+    if (tbl[0] < len)
+    {
+        DWORD *used = (DWORD *)rt_realloc(tbl, tbl[0] * sizeof(DWORD));
+
+        if (used != RT_NULL)
+            tbl = used;
+    }
+
+    return tbl;
+}
+
+/* set the map of a file which is opened for reading */
+static void elm_clmt_attach(FIL *fd)
+{
+    struct elm_clmt *entry, *victim = RT_NULL;
+
+    if (f_size(fd) < RT_DFS_ELM_FASTSEEK_SIZE || fd->obj.sclust == 0)
+        return;
+
+    rt_mutex_take(&elm_clmt_lock, RT_WAITING_FOREVER);
+    for (entry = &elm_clmt_cache[0]; entry < &elm_clmt_cache[RT_DFS_ELM_FASTSEEK_CACHE]; entry++)
+    {
+        if (entry->fat == fd->obj.fs && entry->sclust == fd->obj.sclust &&
+            entry->size == f_size(fd) && !entry->stale)
+        {
+            entry->ref++;
+            entry->used = ++elm_clmt_age;
+            fd->cltbl = entry->tbl;
+            goto __exit;
+        }
+
+        /* the oldest entry which is not in use, the free entries have age 0 */
+        if (entry->ref == 0 && (victim == RT_NULL || entry->used < victim->used))
+            victim = entry;
+    }
+
+    fd->cltbl = elm_clmt_create(fd);
+    if (fd->cltbl != RT_NULL && victim != RT_NULL)
+    {
+        if (victim->fat != RT_NULL)
+            elm_clmt_free(victim);
+
+        victim->fat = fd->obj.fs;
+        victim->sclust = fd->obj.sclust;
+        victim->size = f_size(fd);
+        victim->tbl = fd->cltbl;
+        victim->ref = 1;
+        victim->used = ++elm_clmt_age;
+    }
+    /* else all the entries are in use, the map is private to this open */
+
+__exit:
+    rt_mutex_release(&elm_clmt_lock);
+}
+
+static void elm_clmt_detach(DWORD *tbl)
+{
+    struct elm_clmt *entry;
+
+    rt_mutex_take(&elm_clmt_lock, RT_WAITING_FOREVER);
+    for (entry = &elm_clmt_cache[0]; entry < &elm_clmt_cache[RT_DFS_ELM_FASTSEEK_CACHE]; entry++)
+    {
+        if (entry->fat != RT_NULL && entry->tbl == tbl)
+        {
+            entry->ref--;
+            if (entry->ref == 0 && entry->stale)
+                elm_clmt_free(entry);
+            goto __exit;
+        }
+    }
+    rt_free(tbl);
+
+__exit:
+    rt_mutex_release(&elm_clmt_lock);
+}
+
+/* drop the maps of a volume, or of all the volumes if fat is RT_NULL */
+static void elm_clmt_invalidate(FATFS *fat)
+{
+    struct elm_clmt *entry;
+
+    rt_mutex_take(&elm_clmt_lock, RT_WAITING_FOREVER);
+    for (entry = &elm_clmt_cache[0]; entry < &elm_clmt_cache[RT_DFS_ELM_FASTSEEK_CACHE]; entry++)
+    {
+        if (entry->fat == RT_NULL || (fat != RT_NULL && entry->fat != fat))
+            continue;
+
+        if (entry->ref == 0)
+            elm_clmt_free(entry);
+        else
+            entry->stale = RT_TRUE;
+    }
+    rt_mutex_release(&elm_clmt_lock);
+}
+#else
+#define elm_clmt_invalidate(fat) do { } while (0)
+#endif /* RT_DFS_ELM_USE_FASTSEEK */
+
 int dfs_elm_mount(struct dfs_filesystem *fs, unsigned long rwflag, const void *data)
 {
     FATFS *fat;
@@ -184,6 +355,7 @@ int dfs_elm_unmount(struct dfs_filesystem *fs)
     if (result != FR_OK)
         return elm_result_to_dfs(result);
 
+    elm_clmt_invalidate(fat);
     fs->data = RT_NULL;
     disk[index] = RT_NULL;
     rt_free(fat);
@@ -269,12 +441,13 @@ int dfs_elm_mkfs(rt_device_t dev_id)
     opt.fmt = FM_ANY|FM_SFD;
     result = f_mkfs(logic_nbr, &opt, work, FF_MAX_SS);
     rt_free(work); work = RT_NULL;
+    elm_clmt_invalidate(RT_NULL);
 
     /* check flag status, we need clear the temp driver stored in disk[] */
     if (flag == FSM_STATUS_USE_TEMP_DRIVER)
     {
-        rt_free(fat);
         f_mount(RT_NULL, logic_nbr, (BYTE)index);
+        rt_free(fat);
         disk[index] = RT_NULL;
         /* close device */
         rt_device_close(dev_id);
@@ -426,6 +599,14 @@ int dfs_elm_open(struct dfs_fd *file)
             file->size = f_size(fd);
             file->data = fd;
 
+#ifdef RT_DFS_ELM_USE_FASTSEEK
+            if (!(mode & FA_WRITE))
+                elm_clmt_attach(fd);
+#endif
+            /* the clusters of the old file are free */
+            if (file->flags & O_TRUNC)
+                elm_clmt_invalidate(fd->obj.fs);
+
             if (file->flags & O_APPEND)
             {
                 /* seek to the end of file */
@@ -465,6 +646,13 @@ int dfs_elm_close(struct dfs_fd *file)
         fd = (FIL *)(file->data);
         RT_ASSERT(fd != RT_NULL);
 
+#ifdef RT_DFS_ELM_USE_FASTSEEK
+        if (fd->cltbl != RT_NULL)
+        {
+            elm_clmt_detach(fd->cltbl);
+            fd->cltbl = RT_NULL;
+        }
+#endif
         result = f_close(fd);
         if (result == FR_OK)
         {
@@ -491,19 +679,39 @@ int dfs_elm_ioctl(struct dfs_fd *file, int cmd, void *args)
             /* save file read/write point */
             fptr = fd->fptr;
             length = *(off_t*)args;
-            if (length <= fd->obj.objsize)
-            {
-                fd->fptr = length;
+            /* f_truncate() cuts at the cluster of the read/write point */
+            result = f_lseek(fd, length);
+            if (result == FR_OK && length < fd->obj.objsize)
                 result = f_truncate(fd);
-            }
-            else
-            {
-                result = f_lseek(fd, length);
-            }
             /* restore file read/write point */
-            fd->fptr = fptr;
+            if (result == FR_OK && fptr < length)
+                result = f_lseek(fd, fptr);
+            file->pos = fd->fptr;
+            elm_clmt_invalidate(fd->obj.fs);
             return elm_result_to_dfs(result);
         }
+#if FF_USE_EXPAND
+    case RT_FIOEXPAND:
+        {
+            FIL *fd;
+            off_t length;
+            FRESULT result;
+            fd = (FIL *)(file->data);
+            RT_ASSERT(fd != RT_NULL);
+
+            /* only an empty file which is opened for writing */
+            length = *(off_t*)args;
+            if (length <= 0 || f_size(fd) != 0 || !(fd->flag & FA_WRITE))
+                return -EINVAL;
+
+            result = f_expand(fd, (FSIZE_t)length, 1);
+            if (result == FR_DENIED)
+                return -ENOSPC; /* no contiguous free clusters */
+            if (result == FR_OK)
+                file->size = f_size(fd);
+            return elm_result_to_dfs(result);
+        }
+#endif
     }
     return -ENOSYS;
 }
@@ -689,6 +897,8 @@ int dfs_elm_unlink(struct dfs_filesystem *fs, const char *path)
 #if FF_VOLUMES > 1
     rt_free(drivers_fn);
 #endif
+    if (result == FR_OK)
+        elm_clmt_invalidate((FATFS *)fs->data);
     return elm_result_to_dfs(result);
 }
 
@@ -823,7 +1033,7 @@ static const struct dfs_file_ops dfs_elm_fops =
 static const struct dfs_filesystem_ops dfs_elm =
 {
     "elm",
-    DFS_FS_FLAG_DEFAULT,
+    DFS_FS_FLAG_DENTRY,
     &dfs_elm_fops,
 
     dfs_elm_mount,
@@ -838,6 +1048,9 @@ static const struct dfs_filesystem_ops dfs_elm =
 
 int elm_init(void)
 {
+#ifdef RT_DFS_ELM_USE_FASTSEEK
+    rt_mutex_init(&elm_clmt_lock, "elmclmt", RT_IPC_FLAG_PRIO);
+#endif
     /* register fatfs file system */
     dfs_register(&dfs_elm);
 
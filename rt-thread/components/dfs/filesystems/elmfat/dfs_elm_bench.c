@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and self test of the fast seek and the contiguous files of elmfat.
+ *
+ * A FAT image in RAM is formatted and mounted, every sector read or written
+ * costs BENCH_SECTOR_US like an SD card. Two files are written in turns of
+ * BENCH_PIECE bytes so the file has BENCH_FILE_SIZE / BENCH_PIECE fragments.
+ *
+ * The latency of a seek and a read at random offsets of the fragmented file is
+ * measured opened read-write, which walks the FAT chain, and read-only, which
+ * uses the cluster link map. A recording is written while a log grows next to
+ * it, once as usual and once preallocated with RT_FIOEXPAND. The self test
+ * checks the data read through the maps after the files are rewritten,
+ * truncated and removed.
+ *
+ * msh: elm_seek_bench
+ */
+
+#include <rtthread.h>
+#include "ff.h"
+
+/* ELM FatFs provide a DIR struct */
+#define HAVE_DIR_STRUCTURE
+
+#include <dfs.h>
+#include <dfs_fs.h>
+#include <dfs_file.h>
+#include <dfs_bench_disk.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <stdio.h>
+
+#define BENCH_SECTORS           8192    /* 4 MB image */
+#define BENCH_SECTOR_US         100
+#define BENCH_FILE_SIZE         (1024 * 1024)
+#define BENCH_PIECE             (32 * 1024)
+#define BENCH_CHUNK             512
+#define BENCH_SEEKS             500
+#define BENCH_REC_SIZE          (512 * 1024)
+#define BENCH_REC_CHUNK         4096
+#define BENCH_LOG_CHUNK         256     /* appended to the log after every chunk of the recording */
+
+static struct dfs_bench_disk bench_disk;
+static char bench_root[16];
+static rt_uint32_t seed;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+/* the content of a file is a function of the offset */
+static void bench_fill(rt_uint32_t *buf, rt_uint32_t offset, rt_uint32_t len, rt_uint32_t salt)
+{
+    rt_uint32_t i;
+
+    for (i = 0; i < len / 4; i++)
+        buf[i] = (offset + i * 4) ^ salt;
+}
+
+static rt_bool_t bench_verify(const rt_uint32_t *buf, rt_uint32_t offset, rt_uint32_t len, rt_uint32_t salt)
+{
+    rt_uint32_t i;
+
+    for (i = 0; i < len / 4; i++)
+    {
+        if (buf[i] != ((offset + i * 4) ^ salt))
+            return RT_FALSE;
+    }
+
+    return RT_TRUE;
+}
+
+static void bench_path(char *path, rt_size_t size, const char *name)
+{
+    rt_snprintf(path, size, "%s/%s", bench_root, name);
+}
+
+/* write two files in turns of a piece, the pieces of the files interleave */
+static rt_bool_t bench_write_fragmented(const char *name, const char *other)
+{
+    rt_uint32_t buf[BENCH_CHUNK / 4];
+    char path[32];
+    rt_uint32_t offset, i;
+    int fd, fd_other;
+    rt_bool_t ok;
+
+    bench_path(path, sizeof(path), name);
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+    bench_path(path, sizeof(path), other);
+    fd_other = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+    ok = fd >= 0 && fd_other >= 0;
+
+    for (offset = 0; ok && offset < BENCH_FILE_SIZE; offset += BENCH_CHUNK)
+    {
+        bench_fill(buf, offset, BENCH_CHUNK, 0);
+        ok = write(fd, buf, BENCH_CHUNK) == BENCH_CHUNK;
+
+        /* a piece of the other file after every piece */
+        for (i = 0; ok && (offset + BENCH_CHUNK) % BENCH_PIECE == 0 && i < BENCH_PIECE; i += BENCH_CHUNK)
+            ok = write(fd_other, buf, BENCH_CHUNK) == BENCH_CHUNK;
+    }
+
+    if (fd >= 0)
+        close(fd);
+    if (fd_other >= 0)
+        close(fd_other);
+
+    return ok;
+}
+
+/* seek to random offsets and read a chunk, returns the time of a seek in us */
+static int bench_seek(const char *name, int flags, rt_uint32_t size, rt_uint32_t salt,
+                      rt_uint32_t *reads, int *errors)
+{
+    rt_uint32_t buf[BENCH_CHUNK / 4];
+    char path[32];
+    rt_uint32_t offset;
+    rt_tick_t tick;
+    int fd, i;
+
+    bench_path(path, sizeof(path), name);
+    fd = open(path, flags);
+    if (fd < 0)
+    {
+        (*errors)++;
+        return 0;
+    }
+
+    seed = 1;
+    *reads = bench_disk.reads;
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_SEEKS; i++)
+    {
+        offset = bench_rand() % (size / BENCH_CHUNK) * BENCH_CHUNK;
+        if (lseek(fd, offset, SEEK_SET) != offset ||
+            read(fd, buf, BENCH_CHUNK) != BENCH_CHUNK ||
+            !bench_verify(buf, offset, BENCH_CHUNK, salt))
+        {
+            (*errors)++;
+        }
+    }
+    tick = rt_tick_get() - tick;
+    *reads = bench_disk.reads - *reads;
+    close(fd);
+
+    return tick * (1000000 / RT_TICK_PER_SECOND) / BENCH_SEEKS;
+}
+
+/* open a file read-only, returns the sectors read */
+static rt_uint32_t bench_open(const char *name)
+{
+    char path[32];
+    rt_uint32_t reads = bench_disk.reads;
+    int fd;
+
+    bench_path(path, sizeof(path), name);
+    fd = open(path, O_RDONLY);
+    if (fd >= 0)
+        close(fd);
+
+    return bench_disk.reads - reads;
+}
+
+/* write a recording while a log grows, returns the rate in KB/s */
+static int bench_record(const char *name, rt_bool_t expand, rt_uint32_t *writes, int *errors)
+{
+    rt_uint32_t buf[BENCH_REC_CHUNK / 4];
+    char path[32];
+    rt_uint32_t offset;
+    rt_tick_t tick;
+    off_t length;
+    int fd, fd_log;
+
+    bench_path(path, sizeof(path), "log.txt");
+    fd_log = open(path, O_WRONLY | O_CREAT | O_APPEND);
+    bench_path(path, sizeof(path), name);
+    *writes = bench_disk.writes;
+    tick = rt_tick_get();
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0 || fd_log < 0)
+    {
+        (*errors)++;
+        goto __exit;
+    }
+
+    /* preallocate more than needed and cut it to the recorded length */
+    length = BENCH_REC_SIZE + 64 * 1024;
+    if (expand && ioctl(fd, RT_FIOEXPAND, &length) != 0)
+    {
+        rt_kprintf("RT_FIOEXPAND failed\n");
+        (*errors)++;
+    }
+
+    for (offset = 0; offset < BENCH_REC_SIZE; offset += BENCH_REC_CHUNK)
+    {
+        bench_fill(buf, offset, BENCH_REC_CHUNK, 0);
+        if (write(fd, buf, BENCH_REC_CHUNK) != BENCH_REC_CHUNK ||
+            write(fd_log, buf, BENCH_LOG_CHUNK) != BENCH_LOG_CHUNK)
+        {
+            (*errors)++;
+            break;
+        }
+    }
+
+    if (expand && ftruncate(fd, BENCH_REC_SIZE) != 0)
+        (*errors)++;
+
+__exit:
+    if (fd >= 0)
+        close(fd);
+    tick = rt_tick_get() - tick;
+    *writes = bench_disk.writes - *writes;
+    if (fd_log >= 0)
+        close(fd_log);
+
+    return BENCH_REC_SIZE / 1024 * RT_TICK_PER_SECOND / (tick ? tick : 1);
+}
+
+/* the fragments of a file in its cluster link map, -1 if it has no map */
+static int bench_fragments(const char *name)
+{
+    struct dfs_fd *d;
+    char path[32];
+    int fd, frags = -1;
+    FIL *fil;
+
+    bench_path(path, sizeof(path), name);
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -1;
+
+    d = fd_get(fd);
+    if (d != RT_NULL)
+    {
+        fil = (FIL *)d->data;
+        if (fil->cltbl != RT_NULL)
+            frags = (fil->cltbl[0] - 2) / 2;
+        fd_put(d);
+    }
+    close(fd);
+
+    return frags;
+}
+
+#define CHECK(cond) do { if (!(cond)) { rt_kprintf("check failed, line %d: %s\n", __LINE__, #cond); return RT_FALSE; } } while (0)
+
+static rt_bool_t bench_check(void)
+{
+    rt_uint32_t buf[BENCH_CHUNK / 4];
+    char path[32];
+    rt_uint32_t reads, offset;
+    int fd, fd2, errors = 0;
+    struct stat st;
+    off_t length;
+
+    /* two opens share the map */
+    bench_path(path, sizeof(path), "frag.bin");
+    fd = open(path, O_RDONLY);
+    fd2 = open(path, O_RDONLY);
+    CHECK(fd >= 0 && fd2 >= 0);
+    offset = BENCH_FILE_SIZE - BENCH_CHUNK;
+    CHECK(lseek(fd, offset, SEEK_SET) == offset && read(fd, buf, BENCH_CHUNK) == BENCH_CHUNK);
+    CHECK(bench_verify(buf, offset, BENCH_CHUNK, 0));
+    close(fd);
+    CHECK(lseek(fd2, BENCH_CHUNK, SEEK_SET) == BENCH_CHUNK && read(fd2, buf, BENCH_CHUNK) == BENCH_CHUNK);
+    CHECK(bench_verify(buf, BENCH_CHUNK, BENCH_CHUNK, 0));
+
+    /* rewrite the file while it is open, the new content is read by the next open */
+    fd = open(path, O_WRONLY | O_TRUNC);
+    CHECK(fd >= 0);
+    for (offset = 0; offset < BENCH_FILE_SIZE; offset += BENCH_CHUNK)
+    {
+        bench_fill(buf, offset, BENCH_CHUNK, 0x5a5a5a5a);
+        CHECK(write(fd, buf, BENCH_CHUNK) == BENCH_CHUNK);
+    }
+    close(fd);
+    close(fd2);
+    bench_seek("frag.bin", O_RDONLY, BENCH_FILE_SIZE, 0x5a5a5a5a, &reads, &errors);
+    CHECK(errors == 0);
+
+    /* truncate and extend the recording */
+    bench_path(path, sizeof(path), "rec.bin");
+    fd = open(path, O_RDWR);
+    CHECK(fd >= 0);
+    CHECK(ftruncate(fd, BENCH_REC_SIZE / 2) == 0);
+    CHECK(lseek(fd, BENCH_REC_SIZE / 2, SEEK_SET) == BENCH_REC_SIZE / 2);
+    for (offset = BENCH_REC_SIZE / 2; offset < BENCH_REC_SIZE; offset += BENCH_CHUNK)
+    {
+        bench_fill(buf, offset, BENCH_CHUNK, 0x3c3c3c3c);
+        CHECK(write(fd, buf, BENCH_CHUNK) == BENCH_CHUNK);
+    }
+    close(fd);
+    fd = open(path, O_RDONLY);
+    CHECK(fd >= 0);
+    CHECK(lseek(fd, BENCH_REC_SIZE - BENCH_CHUNK, SEEK_SET) == BENCH_REC_SIZE - BENCH_CHUNK);
+    CHECK(read(fd, buf, BENCH_CHUNK) == BENCH_CHUNK);
+    CHECK(bench_verify(buf, BENCH_REC_SIZE - BENCH_CHUNK, BENCH_CHUNK, 0x3c3c3c3c));
+    close(fd);
+
+    /* remove a file and create another one of the same size */
+    CHECK(unlink(path) == 0);
+    CHECK(bench_record("rec.bin", RT_TRUE, &reads, &errors) > 0 && errors == 0);
+    CHECK(stat(path, &st) == 0 && st.st_size == BENCH_REC_SIZE);
+    bench_seek("rec.bin", O_RDONLY, BENCH_REC_SIZE, 0, &reads, &errors);
+    CHECK(errors == 0);
+
+    /* only an empty file is expanded */
+    fd = open(path, O_WRONLY);
+    CHECK(fd >= 0);
+    length = 4096;
+    CHECK(ioctl(fd, RT_FIOEXPAND, &length) != 0);
+    close(fd);
+
+    return RT_TRUE;
+}
+
+static int elm_seek_bench(int argc, char **argv)
+{
+    rt_uint32_t reads[2], writes[2];
+    int us[2], rate[2], frags[2], errors = 0;
+    char path[32];
+    rt_bool_t made = RT_FALSE;
+    rt_bool_t ok;
+
+    if (dfs_bench_disk_create(&bench_disk, "elmbd", BENCH_SECTORS) != RT_EOK)
+    {
+        rt_kprintf("no memory for the image of %d KB\n", BENCH_SECTORS * DFS_BENCH_DISK_SECTOR_SIZE / 1024);
+        return -RT_ENOMEM;
+    }
+    bench_disk.sector_us = BENCH_SECTOR_US;
+
+    if (dfs_mkfs("elm", "elmbd") != 0)
+    {
+        rt_kprintf("can't format the image\n");
+        dfs_bench_disk_delete(&bench_disk);
+        return -RT_ERROR;
+    }
+
+    /* mount on the root or on a directory of the root file system */
+    if (dfs_filesystem_lookup("/") == RT_NULL)
+    {
+        bench_root[0] = '\0';
+        ok = dfs_mount("elmbd", "/", "elm", 0, RT_NULL) == 0;
+    }
+    else
+    {
+        rt_strncpy(bench_root, "/elmbench", sizeof(bench_root));
+        made = mkdir(bench_root, 0) == 0;
+        ok = dfs_mount("elmbd", bench_root, "elm", 0, RT_NULL) == 0;
+    }
+    if (!ok)
+    {
+        rt_kprintf("can't mount the image, RT_DFS_ELM_DRIVES is %d\n", RT_DFS_ELM_DRIVES);
+        if (made)
+            rmdir(bench_root);
+        dfs_bench_disk_delete(&bench_disk);
+        return -RT_ERROR;
+    }
+
+    if (!bench_write_fragmented("frag.bin", "other.bin"))
+    {
+        rt_kprintf("can't write the files\n");
+        goto __exit;
+    }
+
+    rt_kprintf("image %d KB, %d us a sector, file of %d KB in %d fragments\n",
+               BENCH_SECTORS * DFS_BENCH_DISK_SECTOR_SIZE / 1024, BENCH_SECTOR_US,
+               BENCH_FILE_SIZE / 1024, BENCH_FILE_SIZE / BENCH_PIECE);
+
+    us[0] = bench_seek("frag.bin", O_RDWR, BENCH_FILE_SIZE, 0, &reads[0], &errors);
+    writes[0] = bench_open("frag.bin");
+    writes[1] = bench_open("frag.bin");
+    us[1] = bench_seek("frag.bin", O_RDONLY, BENCH_FILE_SIZE, 0, &reads[1], &errors);
+    rt_kprintf("seek and read %d B: %6d us, %d.%d sectors walking the FAT chain\n", BENCH_CHUNK,
+               us[0], reads[0] / BENCH_SEEKS, reads[0] * 10 / BENCH_SEEKS % 10);
+    rt_kprintf("                    %6d us, %d.%d sectors with the cluster link map\n",
+               us[1], reads[1] / BENCH_SEEKS, reads[1] * 10 / BENCH_SEEKS % 10);
+    rt_kprintf("open read-only: %d sectors read to build the map, %d with the cached map\n",
+               writes[0], writes[1]);
+
+    /* the recordings are written one after the other, both next to the growing log */
+    bench_path(path, sizeof(path), "other.bin");
+    unlink(path);
+    rate[0] = bench_record("rec.bin", RT_FALSE, &writes[0], &errors);
+    frags[0] = bench_fragments("rec.bin");
+    rate[1] = bench_record("rec.bin", RT_TRUE, &writes[1], &errors);
+    frags[1] = bench_fragments("rec.bin");
+    rt_kprintf("recording of %d KB: %4d KB/s, %4d sectors written, %3d fragments as usual\n",
+               BENCH_REC_SIZE / 1024, rate[0], writes[0], frags[0]);
+    rt_kprintf("                    %4d KB/s, %4d sectors written, %3d fragments preallocated\n",
+               rate[1], writes[1], frags[1]);
+
+    if (errors)
+        rt_kprintf("%d wrong reads or writes\n", errors);
+    rt_kprintf("invalidation: %s\n", bench_check() ? "PASS" : "FAIL");
+
+__exit:
+    dfs_unmount(bench_root[0] ? bench_root : "/");
+    if (made)
+        rmdir(bench_root);
+    dfs_bench_disk_delete(&bench_disk);
+
+    return RT_EOK;
+}
+MSH_CMD_EXPORT(elm_seek_bench, elmfat fast seek and contiguous file benchmark);
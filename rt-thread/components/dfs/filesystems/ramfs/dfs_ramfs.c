@@ -59,12 +59,37 @@ int dfs_ramfs_ioctl(struct dfs_fd *file, int cmd, void *args)
     return -EIO;
 }
 
+static rt_uint32_t dfs_ramfs_hash(const char *name)
+{
+    rt_uint32_t hash = 2166136261u;
+
+    while (*name)
+    {
+        hash ^= (rt_uint8_t)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/* set the name of a dirent from a path */
+static void dfs_ramfs_set_name(struct ramfs_dirent *dirent, const char *path)
+{
+    /* remove '/' separator */
+    while (*path == '/' && *path)
+        path ++;
+    strncpy(dirent->name, path, RAMFS_NAME_MAX);
+    dirent->name[RAMFS_NAME_MAX - 1] = '\0';
+    dirent->hash = dfs_ramfs_hash(dirent->name);
+}
+
 struct ramfs_dirent *dfs_ramfs_lookup(struct dfs_ramfs *ramfs,
                                       const char       *path,
                                       rt_size_t        *size)
 {
     const char *subpath;
     struct ramfs_dirent *dirent;
+    rt_uint32_t hash;
 
     subpath = path;
     while (*subpath == '/' && *subpath)
@@ -76,11 +101,12 @@ struct ramfs_dirent *dfs_ramfs_lookup(struct dfs_ramfs *ramfs,
         return &(ramfs->root);
     }
 
+    hash = dfs_ramfs_hash(subpath);
     for (dirent = rt_list_entry(ramfs->root.list.next, struct ramfs_dirent, list);
          dirent != &(ramfs->root);
          dirent = rt_list_entry(dirent->list.next, struct ramfs_dirent, list))
     {
-        if (rt_strcmp(dirent->name, subpath) == 0)
+        if (dirent->hash == hash && rt_strcmp(dirent->name, subpath) == 0)
         {
             *size = dirent->size;
 
@@ -213,8 +239,6 @@ int dfs_ramfs_open(struct dfs_fd *file)
         {
             if (file->flags & O_CREAT || file->flags & O_WRONLY)
             {
-                char *name_ptr;
-
                 /* create a file entry */
                 dirent = (struct ramfs_dirent *)
                          rt_memheap_alloc(&(ramfs->memheap),
@@ -224,11 +248,7 @@ int dfs_ramfs_open(struct dfs_fd *file)
                     return -ENOMEM;
                 }
 
-                /* remove '/' separator */
-                name_ptr = file->path;
-                while (*name_ptr == '/' && *name_ptr)
-                    name_ptr ++;
-                strncpy(dirent->name, name_ptr, RAMFS_NAME_MAX);
+                dfs_ramfs_set_name(dirent, file->path);
 
                 rt_list_init(&(dirent->list));
                 dirent->data = NULL;
@@ -376,7 +396,7 @@ int dfs_ramfs_rename(struct dfs_filesystem *fs,
     if (dirent == NULL)
         return -ENOENT;
 
-    strncpy(dirent->name, newpath, RAMFS_NAME_MAX);
+    dfs_ramfs_set_name(dirent, newpath);
 
     return RT_EOK;
 }
@@ -396,7 +416,7 @@ static const struct dfs_file_ops _ram_fops =
 static const struct dfs_filesystem_ops _ramfs =
 {
     "ram",
-    DFS_FS_FLAG_DEFAULT,
+    DFS_FS_FLAG_DENTRY,
     &_ram_fops,
 
     dfs_ramfs_mount,
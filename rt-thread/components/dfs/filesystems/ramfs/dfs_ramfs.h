@@ -24,6 +24,7 @@ struct ramfs_dirent
     struct dfs_ramfs *fs;       /* file system ref */
 
     char name[RAMFS_NAME_MAX];  /* dirent name */
+    rt_uint32_t hash;           /* hash of the name, compared first */
     rt_uint8_t *data;
 
     rt_size_t size;             /* file size */
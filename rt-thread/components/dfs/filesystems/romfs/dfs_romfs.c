@@ -34,6 +34,21 @@ int dfs_romfs_unmount(struct dfs_filesystem *fs)
 
 int dfs_romfs_ioctl(struct dfs_fd *file, int cmd, void *args)
 {
+    struct romfs_dirent *dirent;
+
+    dirent = (struct romfs_dirent *)file->data;
+    RT_ASSERT(dirent != NULL);
+
+    switch (cmd)
+    {
+    case RT_FIOGETADDR:
+        /* the files are in memory, they can be used in place */
+        if (dirent->type != ROMFS_DIRENT_FILE)
+            return -EIO;
+        *(rt_ubase_t *)args = (rt_ubase_t)dirent->data;
+        return RT_EOK;
+    }
+
     return -EIO;
 }
 
@@ -285,6 +300,79 @@ int dfs_romfs_getdents(struct dfs_fd *file, struct dirent *dirp, uint32_t count)
     return index * sizeof(struct dirent);
 }
 
+/*
+ * Check the entries of an image made by `mkromfs.py --binary`, and with
+ * `move` set move them from the address the image was made for (`link`) to
+ * the address it is at (`load`).
+ */
+static int romfs_image_relocate(struct romfs_dirent *dirent, rt_size_t count, rt_ubase_t link,
+                                rt_ubase_t load, rt_size_t size, rt_bool_t move, int depth)
+{
+    rt_size_t index, length;
+    rt_ubase_t name, data;
+
+    if (depth > ROMFS_IMAGE_DEPTH_MAX)
+        return -1;
+
+    for (index = 0; index < count; index ++)
+    {
+        if (check_dirent(&dirent[index]) != 0)
+            return -1;
+
+        name = (rt_ubase_t)dirent[index].name;
+        data = (rt_ubase_t)dirent[index].data;
+        length = dirent[index].size;
+        if (dirent[index].type == ROMFS_DIRENT_DIR)
+            length *= sizeof(struct romfs_dirent);
+
+        /* everything must be in the image */
+        if (name - link >= size || length > size || data - link > size - length)
+            return -1;
+
+        if (move)
+        {
+            dirent[index].name = (const char *)(name - link + load);
+            dirent[index].data = (const rt_uint8_t *)(data - link + load);
+        }
+
+        if (dirent[index].type == ROMFS_DIRENT_DIR &&
+                romfs_image_relocate((struct romfs_dirent *)(data - link + load), dirent[index].size,
+                                     link, load, size, move, depth + 1) != 0)
+            return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * This function checks a romfs image made by `mkromfs.py --binary` and
+ * returns its root directory to mount. An image which isn't at the address
+ * it was made for is relocated in place, so it must be in RAM then.
+ *
+ * @param image the romfs image.
+ * @param size the size of the image.
+ *
+ * @return the root directory, or NULL if the image is not valid.
+ */
+const struct romfs_dirent *dfs_romfs_image(void *image, rt_size_t size)
+{
+    struct romfs_dirent *root = (struct romfs_dirent *)image;
+    rt_ubase_t link, load = (rt_ubase_t)image;
+
+    /* the root directory is followed by its name */
+    if (size < sizeof(struct romfs_dirent) + 4 || root->type != ROMFS_DIRENT_DIR ||
+            rt_strcmp((const char *)(root + 1), "/") != 0)
+        return NULL;
+
+    link = (rt_ubase_t)root->name - sizeof(struct romfs_dirent);
+    if (romfs_image_relocate(root, 1, link, load, size, RT_FALSE, 0) != 0)
+        return NULL;
+    if (link != load)
+        romfs_image_relocate(root, 1, link, load, size, RT_TRUE, 0);
+
+    return root;
+}
+
 static const struct dfs_file_ops _rom_fops =
 {
     dfs_romfs_open,
@@ -299,7 +387,7 @@ static const struct dfs_file_ops _rom_fops =
 static const struct dfs_filesystem_ops _romfs =
 {
     "rom",
-    DFS_FS_FLAG_DEFAULT,
+    DFS_FS_FLAG_DENTRY,
     &_rom_fops,
 
     dfs_romfs_mount,
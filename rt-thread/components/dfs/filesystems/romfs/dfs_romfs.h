@@ -28,4 +28,8 @@ struct romfs_dirent
 int dfs_romfs_init(void);
 extern const struct romfs_dirent romfs_root;
 
+/* romfs image made by `mkromfs.py --binary`, e.g. in memory mapped flash */
+#define ROMFS_IMAGE_DEPTH_MAX   16
+const struct romfs_dirent *dfs_romfs_image(void *image, rt_size_t size);
+
 #endif
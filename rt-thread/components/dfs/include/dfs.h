@@ -55,6 +55,7 @@ extern "C" {
 
 #define DFS_FS_FLAG_DEFAULT     0x00    /* default flag */
 #define DFS_FS_FLAG_FULLPATH    0x01    /* set full path to underlaying file system */
+#define DFS_FS_FLAG_DENTRY      0x02    /* only changed through dfs, lookups can be cached */
 
 /* File types */
 #define FT_REGULAR               0   /* regular file */
@@ -73,6 +74,7 @@ struct dfs_fdtable
 {
     uint32_t maxfd;
     struct dfs_fd **fds;
+    uint32_t *used;              /* bitmap of the allocated entries */
 };
 
 /* Initialization of dfs */
@@ -92,6 +94,7 @@ void dfs_unlock(void);
 int fd_new(void);
 struct dfs_fd *fd_get(int fd);
 void fd_put(struct dfs_fd *fd);
+void dfs_fdtable_free(struct dfs_fdtable *fdt);
 #endif /* DFS_USING_POSIX */
 
 #ifdef __cplusplus
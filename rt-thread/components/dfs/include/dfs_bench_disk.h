@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __DFS_BENCH_DISK_H__
+#define __DFS_BENCH_DISK_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DFS_BENCH_DISK_SECTOR_SIZE      512
+
+/*
+ * A block device in RAM for the benchmarks of the file systems and their
+ * users. The image is erased (0xff) when the disk is created, the reads and
+ * writes take as long as set below.
+ */
+struct dfs_bench_disk
+{
+    struct rt_device parent;
+    rt_uint8_t *image;
+    rt_uint32_t sectors;
+    rt_uint32_t sector_us;              /* delay of each sector read or written */
+    rt_uint32_t write_us;               /* additional delay of each write */
+    rt_uint32_t reads;                  /* sectors */
+    rt_uint32_t writes;
+};
+
+rt_err_t dfs_bench_disk_create(struct dfs_bench_disk *disk, const char *name, rt_uint32_t sectors);
+void dfs_bench_disk_delete(struct dfs_bench_disk *disk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __DFS_DENTRY_H__
+#define __DFS_DENTRY_H__
+
+#include <dfs_fs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef DFS_USING_DENTRY_CACHE
+
+struct dfs_dentry_stat
+{
+    rt_uint32_t hit;                    /* found in the cache */
+    rt_uint32_t negative;               /* hits of a path which does not exist */
+    rt_uint32_t miss;
+    rt_uint32_t insert;
+    rt_uint32_t evict;
+    rt_uint32_t invalidate;
+};
+
+int dfs_dentry_init(void);
+
+/* prefix tree of the mount points, the lookup only takes the read lock */
+int dfs_mnt_insert(struct dfs_filesystem *fs);
+void dfs_mnt_remove(struct dfs_filesystem *fs);
+struct dfs_filesystem *dfs_mnt_lookup(const char *path);
+
+/*
+ * Cache of the paths looked up in a file system, `path` is the path handed
+ * to the file system. Only file systems with DFS_FS_FLAG_DENTRY are cached.
+ *
+ * lookup returns 0 and fills `st` if the path exists, -ENOENT if it does not
+ * exist and -EAGAIN if the path is not in the cache. On a miss `gen` is set
+ * to the generation to pass to insert, which drops the result if the path
+ * may have changed in between.
+ */
+int dfs_dentry_lookup(struct dfs_filesystem *fs, const char *path, struct stat *st, rt_uint32_t *gen);
+/* `st` is NULL for a path which does not exist */
+void dfs_dentry_insert(struct dfs_filesystem *fs, const char *path, const struct stat *st, rt_uint32_t gen);
+/* drop the path */
+void dfs_dentry_remove(struct dfs_filesystem *fs, const char *path);
+/* drop the path and everything below it */
+void dfs_dentry_invalidate(struct dfs_filesystem *fs, const char *path);
+/* drop the paths of a file system, or all paths if `fs` is NULL */
+void dfs_dentry_flush(struct dfs_filesystem *fs);
+
+void dfs_dentry_enable(rt_bool_t enable);
+void dfs_dentry_get_stat(struct dfs_dentry_stat *stat);
+void dfs_dentry_reset_stat(void);
+
+#else
+
+#define dfs_dentry_lookup(fs, path, st, gen)    ((void)(gen), -EAGAIN)
+#define dfs_dentry_insert(fs, path, st, gen)    do { } while (0)
+#define dfs_dentry_remove(fs, path)             do { } while (0)
+#define dfs_dentry_invalidate(fs, path)         do { } while (0)
+#define dfs_dentry_flush(fs)                    do { } while (0)
+
+#endif /* DFS_USING_DENTRY_CACHE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
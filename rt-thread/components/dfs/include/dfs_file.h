@@ -43,6 +43,7 @@ struct dfs_fd
 
     char *path;                  /* Name (below mount point) */
     int ref_count;               /* Descriptor reference count */
+    int index;                   /* Entry in the fd table */
 
     struct dfs_filesystem *fs;
     const struct dfs_file_ops *fops;
@@ -70,6 +71,8 @@ int dfs_file_ftruncate(struct dfs_fd *fd, off_t length);
 
 /* 0x5254 is just a magic number to make these relatively unique ("RT") */
 #define RT_FIOFTRUNCATE 0x52540000U
+#define RT_FIOGETADDR   0x52540001U   /* get the address of a file which is in memory */
+#define RT_FIOEXPAND    0x52540002U   /* allocate contiguous clusters to an empty file, args: off_t *size */
 
 #ifdef __cplusplus
 }
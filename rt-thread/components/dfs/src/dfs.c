@@ -10,9 +10,11 @@
  * 2018-03-20     Heyuanjie    dynamic allocation FD
  */
 
+#include <rthw.h>
 #include <dfs.h>
 #include <dfs_fs.h>
 #include <dfs_file.h>
+#include <dfs_dentry.h>
 #include "dfs_private.h"
 #ifdef RT_USING_LWP
 #include <lwp.h>
@@ -34,6 +36,10 @@ char working_directory[DFS_PATH_MAX] = {"/"};
 #endif
 
 static struct dfs_fdtable _fdtab;
+#if defined(DFS_USING_POSIX) && defined(RT_USING_SMP)
+/* the fd table for fd_get(), see fd_grow() */
+static struct rt_spinlock fd_lock;
+#endif
 
 /**
  * @addtogroup DFS
@@ -63,6 +69,14 @@ int dfs_init(void)
 
     /* create device filesystem lock */
     rt_mutex_init(&fslock, "fslock", RT_IPC_FLAG_PRIO);
+#ifdef DFS_USING_POSIX
+    rt_spin_lock_init(&fd_lock);
+#endif
+
+#ifdef DFS_USING_DENTRY_CACHE
+    /* mount point tree and path cache */
+    dfs_dentry_init();
+#endif
 
 #ifdef DFS_USING_WORKDIR
     /* set current working directory */
@@ -118,51 +132,94 @@ void dfs_unlock(void)
 }
 
 #ifdef DFS_USING_POSIX
-static int fd_alloc(struct dfs_fdtable *fdt, int startfd)
-{
-    int idx;
+#define FD_TABLE_MIN    4
+#define FD_WORDS(n)     (((n) + 31) / 32)
 
-    /* find an empty fd entry */
-    for (idx = startfd; idx < (int)fdt->maxfd; idx++)
+/*
+ * The descriptors are resolved by fd_get() without dfs_lock, under fd_lock
+ * for a few instructions (the interrupts disabled, a spinlock with
+ * RT_USING_SMP). A dfs_fd stays in its slot until the table is freed, a
+ * released one only has a reference count of 0. The count is changed under
+ * fd_lock, and a grown table is published under fd_lock before the old one
+ * is freed, so no core is indexing the old one any more.
+ */
+static int fd_grow(struct dfs_fdtable *fdt)
+{
+    struct dfs_fd **fds, **old_fds;
+    uint32_t *used, *old_used;
+    rt_base_t level;
+    uint32_t cnt;
+
+    /* double the table */
+    cnt = fdt->maxfd ? fdt->maxfd * 2 : FD_TABLE_MIN;
+    cnt = cnt > DFS_FD_MAX ? DFS_FD_MAX : cnt;
+    if (cnt <= fdt->maxfd)
+        return -1;
+
+    fds = (struct dfs_fd **)rt_calloc(cnt, sizeof(struct dfs_fd *));
+    used = (uint32_t *)rt_calloc(FD_WORDS(cnt), sizeof(uint32_t));
+    if (fds == NULL || used == NULL)
     {
-        if (fdt->fds[idx] == RT_NULL)
-            break;
-        if (fdt->fds[idx]->ref_count == 0)
-            break;
+        rt_free(fds);
+        rt_free(used);
+        return -1;
     }
-
-    /* allocate a larger FD container */
-    if (idx == fdt->maxfd && fdt->maxfd < DFS_FD_MAX)
+    if (fdt->maxfd > 0)
     {
-        int cnt, index;
-        struct dfs_fd **fds;
+        rt_memcpy(fds, fdt->fds, fdt->maxfd * sizeof(struct dfs_fd *));
+        rt_memcpy(used, fdt->used, FD_WORDS(fdt->maxfd) * sizeof(uint32_t));
+    }
 
-        /* increase the number of FD with 4 step length */
-        cnt = fdt->maxfd + 4;
-        cnt = cnt > DFS_FD_MAX ? DFS_FD_MAX : cnt;
+    old_fds = fdt->fds;
+    old_used = fdt->used;
+    level = rt_spin_lock_irqsave(&fd_lock);
+    fdt->fds   = fds;
+    fdt->maxfd = cnt;
+    rt_spin_unlock_irqrestore(&fd_lock, level);
+    fdt->used  = used;
 
-        fds = (struct dfs_fd **)rt_realloc(fdt->fds, cnt * sizeof(struct dfs_fd *));
-        if (fds == NULL) goto __exit; /* return fdt->maxfd */
+    rt_free(old_fds);
+    rt_free(old_used);
+
+    return 0;
+}
 
-        /* clean the new allocated fds */
-        for (index = fdt->maxfd; index < cnt; index ++)
+/* find the lowest free entry from startfd in the bitmap, called with dfs_lock */
+static int fd_alloc(struct dfs_fdtable *fdt, int startfd)
+{
+    uint32_t word, mask;
+    int idx;
+
+    while (1)
+    {
+        idx = fdt->maxfd;
+        mask = ~0u << (startfd % 32);
+        for (word = startfd / 32; word < FD_WORDS(fdt->maxfd); word++)
         {
-            fds[index] = NULL;
+            if ((~fdt->used[word] & mask) != 0)
+            {
+                idx = word * 32 + __rt_ffs(~fdt->used[word] & mask) - 1;
+                break;
+            }
+            mask = ~0u;
         }
+        if (idx < (int)fdt->maxfd)
+            break;
 
-        fdt->fds   = fds;
-        fdt->maxfd = cnt;
+        /* allocate a larger FD container */
+        if (fd_grow(fdt) < 0)
+            return fdt->maxfd;
     }
 
-    /* allocate  'struct dfs_fd' */
-    if (idx < (int)fdt->maxfd && fdt->fds[idx] == RT_NULL)
+    /* allocate  'struct dfs_fd', it is kept for the next descriptor in the entry */
+    if (fdt->fds[idx] == RT_NULL)
     {
         fdt->fds[idx] = (struct dfs_fd *)rt_calloc(1, sizeof(struct dfs_fd));
         if (fdt->fds[idx] == RT_NULL)
-            idx = fdt->maxfd;
+            return fdt->maxfd;
     }
+    fdt->used[idx / 32] |= 1u << (idx % 32);
 
-__exit:
     return idx;
 }
 
@@ -177,6 +234,7 @@ int fd_new(void)
     struct dfs_fd *d;
     int idx;
     struct dfs_fdtable *fdt;
+    rt_base_t level;
 
     fdt = dfs_fdtable_get();
     /* lock filesystem */
@@ -194,8 +252,12 @@ int fd_new(void)
     }
 
     d = fdt->fds[idx];
-    d->ref_count = 1;
     d->magic = DFS_FD_MAGIC;
+    d->index = idx;
+    /* fd_get() may take it from now on */
+    level = rt_spin_lock_irqsave(&fd_lock);
+    d->ref_count = 1;
+    rt_spin_unlock_irqrestore(&fd_lock, level);
 
 __result:
     dfs_unlock();
@@ -213,8 +275,9 @@ __result:
  */
 struct dfs_fd *fd_get(int fd)
 {
-    struct dfs_fd *d;
+    struct dfs_fd *d = NULL;
     struct dfs_fdtable *fdt;
+    rt_base_t level;
 
 #ifdef RT_USING_POSIX_STDIO
     if ((0 <= fd) && (fd <= 2))
@@ -223,22 +286,22 @@ struct dfs_fd *fd_get(int fd)
 
     fdt = dfs_fdtable_get();
     fd = fd - DFS_FD_OFFSET;
-    if (fd < 0 || fd >= (int)fdt->maxfd)
+    if (fd < 0)
         return NULL;
 
-    dfs_lock();
-    d = fdt->fds[fd];
-
-    /* check dfs_fd valid or not */
-    if ((d == NULL) || (d->magic != DFS_FD_MAGIC))
+    /* the table and the reference count are not changed under us */
+    level = rt_spin_lock_irqsave(&fd_lock);
+    if (fd < (int)fdt->maxfd)
     {
-        dfs_unlock();
-        return NULL;
-    }
+        d = fdt->fds[fd];
 
-    /* increase the reference count */
-    d->ref_count ++;
-    dfs_unlock();
+        /* check dfs_fd valid or not */
+        if ((d == NULL) || (d->ref_count == 0) || (d->magic != DFS_FD_MAGIC))
+            d = NULL;
+        else /* increase the reference count */
+            d->ref_count ++;
+    }
+    rt_spin_unlock_irqrestore(&fd_lock, level);
 
     return d;
 }
@@ -250,30 +313,45 @@ struct dfs_fd *fd_get(int fd)
  */
 void fd_put(struct dfs_fd *fd)
 {
-    RT_ASSERT(fd != NULL);
+    rt_base_t level;
+    int ref_count;
 
-    dfs_lock();
+    RT_ASSERT(fd != NULL);
 
-    fd->ref_count --;
+    level = rt_spin_lock_irqsave(&fd_lock);
+    ref_count = -- fd->ref_count;
+    rt_spin_unlock_irqrestore(&fd_lock, level);
 
-    /* clear this fd entry */
-    if (fd->ref_count == 0)
+    /* clear this fd entry, fd_get() does not take it any more */
+    if (ref_count == 0)
     {
-        int index;
+        int index = fd->index;
         struct dfs_fdtable *fdt;
 
         fdt = dfs_fdtable_get();
-        for (index = 0; index < (int)fdt->maxfd; index ++)
-        {
-            if (fdt->fds[index] == fd)
-            {
-                rt_free(fd);
-                fdt->fds[index] = 0;
-                break;
-            }
-        }
+        dfs_lock();
+        RT_ASSERT(index < (int)fdt->maxfd && fdt->fds[index] == fd);
+        rt_memset(fd, 0, sizeof(struct dfs_fd));
+        fdt->used[index / 32] &= ~(1u << (index % 32));
+        dfs_unlock();
     }
-    dfs_unlock();
+}
+
+/**
+ * @ingroup Fd
+ *
+ * This function will free a file descriptor table, all descriptors in it
+ * must be closed.
+ */
+void dfs_fdtable_free(struct dfs_fdtable *fdt)
+{
+    uint32_t index;
+
+    for (index = 0; index < fdt->maxfd; index ++)
+        rt_free(fdt->fds[index]);
+    rt_free(fdt->fds);
+    rt_free(fdt->used);
+    rt_memset(fdt, 0, sizeof(struct dfs_fdtable));
 }
 
 #endif /* DFS_USING_POSIX */
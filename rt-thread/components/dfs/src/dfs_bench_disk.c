@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <rtdevice.h>
+#include <dfs_bench_disk.h>
+
+static rt_size_t bench_disk_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    struct dfs_bench_disk *disk = (struct dfs_bench_disk *)dev;
+
+    if (pos + size > disk->sectors)
+        return 0;
+
+    rt_hw_us_delay(disk->sector_us * size);
+    rt_memcpy(buffer, disk->image + pos * DFS_BENCH_DISK_SECTOR_SIZE, size * DFS_BENCH_DISK_SECTOR_SIZE);
+    disk->reads += size;
+
+    return size;
+}
+
+static rt_size_t bench_disk_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    struct dfs_bench_disk *disk = (struct dfs_bench_disk *)dev;
+
+    if (pos + size > disk->sectors)
+        return 0;
+
+    rt_hw_us_delay(disk->write_us + disk->sector_us * size);
+    rt_memcpy(disk->image + pos * DFS_BENCH_DISK_SECTOR_SIZE, buffer, size * DFS_BENCH_DISK_SECTOR_SIZE);
+    disk->writes += size;
+
+    return size;
+}
+
+static rt_err_t bench_disk_control(rt_device_t dev, int cmd, void *args)
+{
+    struct dfs_bench_disk *disk = (struct dfs_bench_disk *)dev;
+
+    if (cmd == RT_DEVICE_CTRL_BLK_GETGEOME)
+    {
+        struct rt_device_blk_geometry *geometry = (struct rt_device_blk_geometry *)args;
+
+        geometry->bytes_per_sector = DFS_BENCH_DISK_SECTOR_SIZE;
+        geometry->block_size = DFS_BENCH_DISK_SECTOR_SIZE;
+        geometry->sector_count = disk->sectors;
+    }
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops bench_disk_ops =
+{
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    bench_disk_read,
+    bench_disk_write,
+    bench_disk_control
+};
+#endif
+
+/* allocate the erased image and register the disk, the delays are set by the caller */
+rt_err_t dfs_bench_disk_create(struct dfs_bench_disk *disk, const char *name, rt_uint32_t sectors)
+{
+    rt_device_t dev = &disk->parent;
+
+    rt_memset(disk, 0, sizeof(*disk));
+    disk->image = (rt_uint8_t *)rt_malloc(sectors * DFS_BENCH_DISK_SECTOR_SIZE);
+    if (disk->image == RT_NULL)
+        return -RT_ENOMEM;
+    rt_memset(disk->image, 0xff, sectors * DFS_BENCH_DISK_SECTOR_SIZE);
+    disk->sectors = sectors;
+
+    dev->type = RT_Device_Class_Block;
+#ifdef RT_USING_DEVICE_OPS
+    dev->ops = &bench_disk_ops;
+#else
+    dev->read = bench_disk_read;
+    dev->write = bench_disk_write;
+    dev->control = bench_disk_control;
+#endif
+
+    if (rt_device_register(dev, name, RT_DEVICE_FLAG_RDWR) != RT_EOK)
+    {
+        rt_free(disk->image);
+        disk->image = RT_NULL;
+        return -RT_ERROR;
+    }
+    return RT_EOK;
+}
+
+void dfs_bench_disk_delete(struct dfs_bench_disk *disk)
+{
+    rt_device_unregister(&disk->parent);
+    rt_free(disk->image);
+    disk->image = RT_NULL;
+}
@@ -0,0 +1,572 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Path lookup cache of dfs.
+ *
+ * The mount points are kept in a prefix tree of path components, finding the
+ * file system of a path walks the components of the path once instead of
+ * comparing it with every mount point.
+ *
+ * The results of the last stat and open calls are kept in a hash table,
+ * including the paths which do not exist. A hit saves the lookup in the file
+ * system, which is a walk over the directory sectors for FAT. Entries are
+ * dropped when the path is written, created, unlinked or renamed and when the
+ * file system is mounted, unmounted or formatted.
+ *
+ * Both are protected by a reader/writer lock, so threads resolving paths do
+ * not wait for each other. A lookup which misses takes a generation number
+ * first, the result of the file system is only inserted if nothing was
+ * dropped since then.
+ */
+
+#include <rthw.h>
+#include <dfs.h>
+#include <dfs_fs.h>
+#include <dfs_dentry.h>
+#include "dfs_private.h"
+
+#ifndef DFS_DENTRY_CACHE_MAX
+#define DFS_DENTRY_CACHE_MAX    32
+#endif
+
+struct dfs_rwlock
+{
+    struct rt_mutex lock;               /* held by the writer, taken shortly by the readers */
+    struct rt_semaphore drain;          /* the last reader wakes up the writer */
+    volatile rt_uint16_t readers;
+    volatile rt_uint8_t waiting;
+};
+
+struct dfs_mnt_node
+{
+    struct dfs_mnt_node *child;
+    struct dfs_mnt_node *sibling;
+    struct dfs_filesystem *fs;          /* mounted on this path */
+    rt_uint16_t len;
+    char name[];                        /* path component, not terminated */
+};
+
+struct dfs_dentry
+{
+    struct dfs_dentry *next;            /* hash chain */
+    struct dfs_filesystem *fs;          /* NULL: free entry */
+    char *path;
+    rt_uint32_t hash;
+    rt_uint8_t exist;
+    rt_uint8_t ref;                     /* used since the clock hand passed */
+    struct stat st;
+};
+
+static struct dfs_rwlock path_lock;
+static struct dfs_mnt_node mnt_root;    /* "/" */
+
+static struct dfs_dentry dentry_pool[DFS_DENTRY_CACHE_MAX];
+static struct dfs_dentry *dentry_hash[DFS_DENTRY_CACHE_MAX];
+static rt_uint16_t dentry_hand;
+static volatile rt_uint32_t dentry_gen;
+static rt_bool_t dentry_enabled = RT_TRUE;
+/* counted without a lock by the readers, the numbers are approximate */
+static struct dfs_dentry_stat dentry_stat;
+
+static void read_lock(void)
+{
+    rt_base_t level;
+
+    rt_mutex_take(&path_lock.lock, RT_WAITING_FOREVER);
+    level = rt_hw_interrupt_disable();
+    path_lock.readers++;
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(&path_lock.lock);
+}
+
+static void read_unlock(void)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    path_lock.readers--;
+    if (path_lock.readers == 0 && path_lock.waiting)
+    {
+        path_lock.waiting = 0;
+        rt_sem_release(&path_lock.drain);
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+static void write_lock(void)
+{
+    rt_base_t level;
+
+    /* new readers wait on the mutex, wait for the ones inside to leave */
+    rt_mutex_take(&path_lock.lock, RT_WAITING_FOREVER);
+    level = rt_hw_interrupt_disable();
+    if (path_lock.readers > 0)
+    {
+        path_lock.waiting = 1;
+        rt_hw_interrupt_enable(level);
+        rt_sem_take(&path_lock.drain, RT_WAITING_FOREVER);
+    }
+    else
+    {
+        rt_hw_interrupt_enable(level);
+    }
+}
+
+static void write_unlock(void)
+{
+    rt_mutex_release(&path_lock.lock);
+}
+
+int dfs_dentry_init(void)
+{
+    rt_mutex_init(&path_lock.lock, "fspath", RT_IPC_FLAG_PRIO);
+    rt_sem_init(&path_lock.drain, "fspath", 0, RT_IPC_FLAG_PRIO);
+    path_lock.readers = 0;
+    path_lock.waiting = 0;
+
+    rt_memset(&mnt_root, 0, sizeof(mnt_root));
+    rt_memset(dentry_pool, 0, sizeof(dentry_pool));
+    rt_memset(dentry_hash, 0, sizeof(dentry_hash));
+    dentry_hand = 0;
+
+    return 0;
+}
+
+/* the next component of a path, skips the separators in front of it */
+static const char *path_component(const char *path, rt_size_t *len)
+{
+    const char *end;
+
+    while (*path == '/')
+        path++;
+    for (end = path; *end != '\0' && *end != '/'; end++);
+    *len = end - path;
+
+    return path;
+}
+
+static struct dfs_mnt_node *mnt_child(struct dfs_mnt_node *node, const char *name, rt_size_t len)
+{
+    for (node = node->child; node != RT_NULL; node = node->sibling)
+    {
+        if (node->len == len && rt_memcmp(node->name, name, len) == 0)
+            return node;
+    }
+
+    return RT_NULL;
+}
+
+/* free the nodes without a mount point below them, returns whether `node` is unused */
+static rt_bool_t mnt_prune(struct dfs_mnt_node *node)
+{
+    struct dfs_mnt_node **link = &node->child;
+    struct dfs_mnt_node *child;
+
+    while ((child = *link) != RT_NULL)
+    {
+        if (mnt_prune(child))
+        {
+            *link = child->sibling;
+            rt_free(child);
+        }
+        else
+        {
+            link = &child->sibling;
+        }
+    }
+
+    return node->child == RT_NULL && node->fs == RT_NULL;
+}
+
+int dfs_mnt_insert(struct dfs_filesystem *fs)
+{
+    struct dfs_mnt_node *node, *child;
+    const char *name = fs->path;
+    rt_size_t len;
+    int result = 0;
+
+    write_lock();
+    node = &mnt_root;
+    for (name = path_component(name, &len); len > 0; name = path_component(name + len, &len))
+    {
+        child = mnt_child(node, name, len);
+        if (child == RT_NULL)
+        {
+            child = (struct dfs_mnt_node *)rt_malloc(sizeof(struct dfs_mnt_node) + len);
+            if (child == RT_NULL)
+            {
+                result = -ENOMEM;
+                break;
+            }
+            child->child = RT_NULL;
+            child->fs = RT_NULL;
+            child->len = len;
+            rt_memcpy(child->name, name, len);
+            child->sibling = node->child;
+            node->child = child;
+        }
+        node = child;
+    }
+
+    if (result == 0)
+        node->fs = fs;
+    else
+        mnt_prune(&mnt_root);
+    write_unlock();
+
+    return result;
+}
+
+void dfs_mnt_remove(struct dfs_filesystem *fs)
+{
+    struct dfs_mnt_node *node;
+    const char *name = fs->path;
+    rt_size_t len;
+
+    write_lock();
+    node = &mnt_root;
+    for (name = path_component(name, &len); len > 0 && node != RT_NULL;
+         name = path_component(name + len, &len))
+    {
+        node = mnt_child(node, name, len);
+    }
+
+    if (node != RT_NULL && node->fs == fs)
+    {
+        node->fs = RT_NULL;
+        mnt_prune(&mnt_root);
+    }
+    write_unlock();
+}
+
+struct dfs_filesystem *dfs_mnt_lookup(const char *path)
+{
+    struct dfs_mnt_node *node;
+    struct dfs_filesystem *fs;
+    rt_size_t len;
+
+    read_lock();
+    node = &mnt_root;
+    fs = node->fs;
+    for (path = path_component(path, &len); len > 0; path = path_component(path + len, &len))
+    {
+        node = mnt_child(node, path, len);
+        if (node == RT_NULL)
+            break;
+        if (node->fs != RT_NULL)
+            fs = node->fs;
+    }
+    read_unlock();
+
+    return fs;
+}
+
+static rt_uint32_t dentry_hash_path(struct dfs_filesystem *fs, const char *path)
+{
+    rt_uint32_t hash = 2166136261u ^ (rt_uint32_t)(rt_ubase_t)fs;
+
+    while (*path)
+    {
+        hash ^= (rt_uint8_t)*path++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static struct dfs_dentry *dentry_find(struct dfs_filesystem *fs, const char *path, rt_uint32_t hash)
+{
+    struct dfs_dentry *d;
+
+    for (d = dentry_hash[hash % DFS_DENTRY_CACHE_MAX]; d != RT_NULL; d = d->next)
+    {
+        if (d->hash == hash && d->fs == fs && rt_strcmp(d->path, path) == 0)
+            return d;
+    }
+
+    return RT_NULL;
+}
+
+/* called with the write lock */
+static void dentry_free(struct dfs_dentry *d)
+{
+    struct dfs_dentry **link = &dentry_hash[d->hash % DFS_DENTRY_CACHE_MAX];
+
+    while (*link != d)
+        link = &(*link)->next;
+    *link = d->next;
+
+    rt_free(d->path);
+    d->path = RT_NULL;
+    d->fs = RT_NULL;
+}
+
+/* a free entry or the first one not used since the clock hand passed */
+static struct dfs_dentry *dentry_alloc(void)
+{
+    struct dfs_dentry *d;
+
+    while (1)
+    {
+        d = &dentry_pool[dentry_hand];
+        dentry_hand = (dentry_hand + 1) % DFS_DENTRY_CACHE_MAX;
+
+        if (d->fs == RT_NULL)
+            return d;
+        if (!d->ref)
+            break;
+        d->ref = 0;
+    }
+
+    dentry_free(d);
+    dentry_stat.evict++;
+
+    return d;
+}
+
+static rt_bool_t dentry_cached(struct dfs_filesystem *fs)
+{
+    return dentry_enabled && fs != RT_NULL && (fs->ops->flags & DFS_FS_FLAG_DENTRY);
+}
+
+/* every entry dropped starts a new generation, see dfs_dentry_insert */
+static void dentry_next_gen(void)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    dentry_gen++;
+    rt_hw_interrupt_enable(level);
+}
+
+int dfs_dentry_lookup(struct dfs_filesystem *fs, const char *path, struct stat *st, rt_uint32_t *gen)
+{
+    struct dfs_dentry *d;
+    rt_uint32_t hash;
+    int result = -EAGAIN;
+
+    *gen = dentry_gen;
+    if (!dentry_cached(fs))
+        return -EAGAIN;
+
+    hash = dentry_hash_path(fs, path);
+    read_lock();
+    d = dentry_find(fs, path, hash);
+    if (d != RT_NULL)
+    {
+        d->ref = 1;
+        if (d->exist)
+        {
+            if (st != RT_NULL)
+                rt_memcpy(st, &d->st, sizeof(struct stat));
+            result = 0;
+        }
+        else
+        {
+            dentry_stat.negative++;
+            result = -ENOENT;
+        }
+        dentry_stat.hit++;
+    }
+    else
+    {
+        dentry_stat.miss++;
+    }
+    read_unlock();
+
+    return result;
+}
+
+void dfs_dentry_insert(struct dfs_filesystem *fs, const char *path, const struct stat *st, rt_uint32_t gen)
+{
+    struct dfs_dentry *d;
+    rt_uint32_t hash;
+    char *name;
+
+    if (!dentry_cached(fs))
+        return;
+
+    hash = dentry_hash_path(fs, path);
+    name = rt_strdup(path);
+    if (name == RT_NULL)
+        return;
+
+    write_lock();
+    /* the path may have changed while the file system looked it up */
+    if (gen != dentry_gen)
+    {
+        write_unlock();
+        rt_free(name);
+        return;
+    }
+
+    d = dentry_find(fs, path, hash);
+    if (d == RT_NULL)
+    {
+        d = dentry_alloc();
+        d->fs = fs;
+        d->path = name;
+        d->hash = hash;
+        d->next = dentry_hash[hash % DFS_DENTRY_CACHE_MAX];
+        dentry_hash[hash % DFS_DENTRY_CACHE_MAX] = d;
+        name = RT_NULL;
+        dentry_stat.insert++;
+    }
+    d->ref = 1;
+    d->exist = st != RT_NULL;
+    if (st != RT_NULL)
+        rt_memcpy(&d->st, st, sizeof(struct stat));
+    write_unlock();
+
+    rt_free(name);
+}
+
+void dfs_dentry_remove(struct dfs_filesystem *fs, const char *path)
+{
+    struct dfs_dentry *d;
+    rt_uint32_t hash;
+
+    if (fs == RT_NULL || !(fs->ops->flags & DFS_FS_FLAG_DENTRY))
+        return;
+
+    dentry_next_gen();
+
+    /* the path is written often, only take the write lock if it is cached */
+    hash = dentry_hash_path(fs, path);
+    read_lock();
+    d = dentry_find(fs, path, hash);
+    read_unlock();
+    if (d == RT_NULL)
+        return;
+
+    write_lock();
+    d = dentry_find(fs, path, hash);
+    if (d != RT_NULL)
+    {
+        dentry_free(d);
+        dentry_stat.invalidate++;
+    }
+    write_unlock();
+}
+
+void dfs_dentry_invalidate(struct dfs_filesystem *fs, const char *path)
+{
+    struct dfs_dentry *d;
+    rt_size_t len = rt_strlen(path);
+
+    if (fs == RT_NULL || !(fs->ops->flags & DFS_FS_FLAG_DENTRY))
+        return;
+
+    /* "/" is the root of the file system, everything is below it */
+    if (len == 1 && path[0] == '/')
+        len = 0;
+
+    dentry_next_gen();
+    write_lock();
+    for (d = &dentry_pool[0]; d < &dentry_pool[DFS_DENTRY_CACHE_MAX]; d++)
+    {
+        if (d->fs != fs || rt_strncmp(d->path, path, len) != 0)
+            continue;
+        if (d->path[len] != '\0' && d->path[len] != '/')
+            continue;
+
+        dentry_free(d);
+        dentry_stat.invalidate++;
+    }
+    write_unlock();
+}
+
+void dfs_dentry_flush(struct dfs_filesystem *fs)
+{
+    struct dfs_dentry *d;
+
+    dentry_next_gen();
+    write_lock();
+    for (d = &dentry_pool[0]; d < &dentry_pool[DFS_DENTRY_CACHE_MAX]; d++)
+    {
+        if (d->fs != RT_NULL && (fs == RT_NULL || d->fs == fs))
+            dentry_free(d);
+    }
+    write_unlock();
+}
+
+void dfs_dentry_enable(rt_bool_t enable)
+{
+    dentry_enabled = enable;
+    if (!enable)
+        dfs_dentry_flush(RT_NULL);
+}
+
+void dfs_dentry_get_stat(struct dfs_dentry_stat *stat)
+{
+    rt_memcpy(stat, &dentry_stat, sizeof(struct dfs_dentry_stat));
+}
+
+void dfs_dentry_reset_stat(void)
+{
+    rt_memset(&dentry_stat, 0, sizeof(struct dfs_dentry_stat));
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static void dentry_show(struct dfs_mnt_node *node, int depth)
+{
+    for (; node != RT_NULL; node = node->sibling)
+    {
+        rt_kprintf("%*s/%.*s", depth * 2, "", node->len, node->name);
+        if (node->fs != RT_NULL)
+            rt_kprintf(" [%s]", node->fs->ops->name);
+        rt_kprintf("\n");
+        dentry_show(node->child, depth + 1);
+    }
+}
+
+static int dentry(int argc, char **argv)
+{
+    struct dfs_dentry_stat stat;
+    struct dfs_dentry *d;
+    int used = 0, negative = 0;
+
+    if (argc > 1 && rt_strcmp(argv[1], "flush") == 0)
+    {
+        dfs_dentry_flush(RT_NULL);
+        return 0;
+    }
+    if (argc > 1 && rt_strcmp(argv[1], "reset") == 0)
+    {
+        dfs_dentry_reset_stat();
+        return 0;
+    }
+
+    rt_kprintf("mount points:\n");
+    read_lock();
+    rt_kprintf("/%s\n", mnt_root.fs != RT_NULL ? " [root]" : "");
+    dentry_show(mnt_root.child, 1);
+    for (d = &dentry_pool[0]; d < &dentry_pool[DFS_DENTRY_CACHE_MAX]; d++)
+    {
+        if (d->fs == RT_NULL)
+            continue;
+        used++;
+        if (!d->exist)
+            negative++;
+    }
+    read_unlock();
+
+    dfs_dentry_get_stat(&stat);
+    rt_kprintf("paths cached %d/%d, not existing %d\n", used, DFS_DENTRY_CACHE_MAX, negative);
+    rt_kprintf("hit %d (not existing %d), miss %d, insert %d, evict %d, invalidate %d\n",
+               stat.hit, stat.negative, stat.miss, stat.insert, stat.evict, stat.invalidate);
+
+    return 0;
+}
+MSH_CMD_EXPORT(dentry, show the dfs path cache: dentry [flush|reset]);
+#endif
@@ -0,0 +1,554 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and self test of the dfs path cache.
+ *
+ * A small file system in RAM holds a directory tree BENCH_DEPTH levels deep
+ * with BENCH_FILES files in every directory. Looking up a path costs a delay
+ * for every component, like a FAT volume reading a directory sector from the
+ * block cache, plus a scan of the name table.
+ *
+ * stat and open rates of existing and missing files are measured with the
+ * cache disabled and enabled. The self test checks that created, written,
+ * renamed and unlinked paths are seen at once, also while other threads stat
+ * the tree.
+ *
+ * msh: dentry_bench
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <dfs.h>
+#include <dfs_fs.h>
+#include <dfs_file.h>
+#include <dfs_dentry.h>
+#include <unistd.h>
+#include <stdio.h>
+
+#define BENCH_DEPTH             8
+#define BENCH_FILES             4
+#define BENCH_NODES_MAX         128
+#define BENCH_NAME_MAX          64
+#define BENCH_DIR_US            30      /* one directory sector scanned */
+#define BENCH_OPS               2000
+#define BENCH_READERS           2
+#define BENCH_CHANGES           200
+
+struct bench_node
+{
+    char path[BENCH_NAME_MAX];          /* empty: free node */
+    rt_bool_t dir;
+    rt_size_t size;
+};
+
+static struct bench_node bench_nodes[BENCH_NODES_MAX];
+static struct rt_mutex bench_lock;
+static char bench_root[16];
+static rt_uint32_t seed;
+static volatile rt_bool_t readers_stop;
+static volatile int readers_failed;
+static struct rt_semaphore readers_done;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static struct bench_node *bench_find(const char *path)
+{
+    struct bench_node *node;
+    const char *p;
+
+    /* a FAT volume searches the directory of every component */
+    for (p = path; *p; p++)
+    {
+        if (*p == '/')
+            rt_hw_us_delay(BENCH_DIR_US);
+    }
+
+    for (node = &bench_nodes[0]; node < &bench_nodes[BENCH_NODES_MAX]; node++)
+    {
+        if (node->path[0] != '\0' && rt_strcmp(node->path, path) == 0)
+            return node;
+    }
+
+    return RT_NULL;
+}
+
+static struct bench_node *bench_create(const char *path, rt_bool_t dir)
+{
+    struct bench_node *node;
+
+    if (rt_strlen(path) >= BENCH_NAME_MAX)
+        return RT_NULL;
+
+    for (node = &bench_nodes[0]; node < &bench_nodes[BENCH_NODES_MAX]; node++)
+    {
+        if (node->path[0] == '\0')
+        {
+            rt_strncpy(node->path, path, BENCH_NAME_MAX);
+            node->dir = dir;
+            node->size = 0;
+            return node;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static int bench_fs_mount(struct dfs_filesystem *fs, unsigned long rwflag, const void *data)
+{
+    return RT_EOK;
+}
+
+static int bench_fs_unmount(struct dfs_filesystem *fs)
+{
+    return RT_EOK;
+}
+
+static int bench_fs_open(struct dfs_fd *fd)
+{
+    struct bench_node *node;
+    int result = RT_EOK;
+
+    if (rt_strcmp(fd->path, "/") == 0)
+        return (fd->flags & O_DIRECTORY) ? RT_EOK : -ENOENT;
+
+    rt_mutex_take(&bench_lock, RT_WAITING_FOREVER);
+    node = bench_find(fd->path);
+    if (node == RT_NULL)
+    {
+        if (fd->flags & O_CREAT)
+        {
+            node = bench_create(fd->path, (fd->flags & O_DIRECTORY) != 0);
+            if (node == RT_NULL)
+                result = -ENOSPC;
+        }
+        else
+        {
+            result = -ENOENT;
+        }
+    }
+    else if ((fd->flags & O_DIRECTORY) && !node->dir)
+    {
+        result = -ENOTDIR;
+    }
+
+    if (result == RT_EOK)
+    {
+        if (fd->flags & O_TRUNC)
+            node->size = 0;
+        fd->data = node;
+        fd->size = node->size;
+        fd->pos = 0;
+    }
+    rt_mutex_release(&bench_lock);
+
+    return result;
+}
+
+static int bench_fs_close(struct dfs_fd *fd)
+{
+    return RT_EOK;
+}
+
+static int bench_fs_read(struct dfs_fd *fd, void *buf, size_t count)
+{
+    return 0;
+}
+
+static int bench_fs_write(struct dfs_fd *fd, const void *buf, size_t count)
+{
+    struct bench_node *node = (struct bench_node *)fd->data;
+
+    rt_mutex_take(&bench_lock, RT_WAITING_FOREVER);
+    fd->pos += count;
+    if (fd->pos > node->size)
+        node->size = fd->pos;
+    fd->size = node->size;
+    rt_mutex_release(&bench_lock);
+
+    return count;
+}
+
+static int bench_fs_stat(struct dfs_filesystem *fs, const char *path, struct stat *st)
+{
+    struct bench_node *node;
+    int result = RT_EOK;
+
+    rt_mutex_take(&bench_lock, RT_WAITING_FOREVER);
+    node = bench_find(path);
+    if (node != RT_NULL)
+    {
+        rt_memset(st, 0, sizeof(struct stat));
+        st->st_mode = (node->dir ? S_IFDIR : S_IFREG) | S_IRUSR | S_IWUSR;
+        st->st_size = node->size;
+    }
+    else
+    {
+        result = -ENOENT;
+    }
+    rt_mutex_release(&bench_lock);
+
+    return result;
+}
+
+static int bench_fs_unlink(struct dfs_filesystem *fs, const char *path)
+{
+    struct bench_node *node, *iter;
+    rt_size_t len = rt_strlen(path);
+    int result = RT_EOK;
+
+    rt_mutex_take(&bench_lock, RT_WAITING_FOREVER);
+    node = bench_find(path);
+    if (node == RT_NULL)
+    {
+        result = -ENOENT;
+        goto __exit;
+    }
+
+    for (iter = &bench_nodes[0]; node->dir && iter < &bench_nodes[BENCH_NODES_MAX]; iter++)
+    {
+        if (rt_strncmp(iter->path, path, len) == 0 && iter->path[len] == '/')
+        {
+            result = -ENOTEMPTY;
+            goto __exit;
+        }
+    }
+    node->path[0] = '\0';
+
+__exit:
+    rt_mutex_release(&bench_lock);
+    return result;
+}
+
+static int bench_fs_rename(struct dfs_filesystem *fs, const char *oldpath, const char *newpath)
+{
+    struct bench_node *iter;
+    rt_size_t oldlen = rt_strlen(oldpath);
+    char path[BENCH_NAME_MAX];
+    int result = RT_EOK;
+
+    rt_mutex_take(&bench_lock, RT_WAITING_FOREVER);
+    if (bench_find(newpath) != RT_NULL)
+        result = -EEXIST;
+    else if (bench_find(oldpath) == RT_NULL)
+        result = -ENOENT;
+
+    /* the node and everything below it */
+    for (iter = &bench_nodes[0]; result == RT_EOK && iter < &bench_nodes[BENCH_NODES_MAX]; iter++)
+    {
+        if (iter->path[0] == '\0' || rt_strncmp(iter->path, oldpath, oldlen) != 0)
+            continue;
+        if (iter->path[oldlen] != '\0' && iter->path[oldlen] != '/')
+            continue;
+
+        rt_snprintf(path, sizeof(path), "%s%s", newpath, iter->path + oldlen);
+        rt_strncpy(iter->path, path, BENCH_NAME_MAX);
+    }
+    rt_mutex_release(&bench_lock);
+
+    return result;
+}
+
+static const struct dfs_file_ops bench_fops =
+{
+    bench_fs_open,
+    bench_fs_close,
+    RT_NULL, /* ioctl */
+    bench_fs_read,
+    bench_fs_write,
+    RT_NULL, /* flush */
+    RT_NULL, /* lseek */
+    RT_NULL, /* getdents */
+};
+
+static const struct dfs_filesystem_ops bench_fs =
+{
+    "dbench",
+    DFS_FS_FLAG_DENTRY,
+    &bench_fops,
+
+    bench_fs_mount,
+    bench_fs_unmount,
+    RT_NULL, /* mkfs */
+    RT_NULL, /* statfs */
+
+    bench_fs_unlink,
+    bench_fs_stat,
+    bench_fs_rename,
+};
+
+static void bench_tree(void)
+{
+    char path[BENCH_NAME_MAX];
+    int depth, file, len = 0;
+
+    rt_memset(bench_nodes, 0, sizeof(bench_nodes));
+    for (depth = 0; depth < BENCH_DEPTH; depth++)
+    {
+        len += rt_snprintf(path + len, sizeof(path) - len, "/d%d", depth);
+        bench_create(path, RT_TRUE);
+        for (file = 0; file < BENCH_FILES; file++)
+        {
+            rt_snprintf(path + len, sizeof(path) - len, "/f%d", file);
+            bench_create(path, RT_FALSE);
+        }
+        path[len] = '\0';
+    }
+}
+
+/* a path of the tree, a file which exists or a missing one next to it */
+static void bench_path(char *path, rt_size_t size, rt_bool_t exist)
+{
+    int depth = bench_rand() % BENCH_DEPTH, i, len;
+
+    len = rt_snprintf(path, size, "%s", bench_root);
+    for (i = 0; i <= depth; i++)
+        len += rt_snprintf(path + len, size - len, "/d%d", i);
+    rt_snprintf(path + len, size - len, exist ? "/f%d" : "/x%d", bench_rand() % BENCH_FILES);
+}
+
+static rt_bool_t op_stat(const char *path, rt_bool_t exist)
+{
+    struct stat st;
+
+    return (stat(path, &st) == 0) == exist;
+}
+
+static rt_bool_t op_open(const char *path, rt_bool_t exist)
+{
+    int fd = open(path, O_RDONLY);
+
+    if (fd >= 0)
+        close(fd);
+    return (fd >= 0) == exist;
+}
+
+static void bench_run(const char *name, rt_bool_t (*op)(const char *, rt_bool_t), rt_bool_t exist)
+{
+    char path[BENCH_NAME_MAX + 16];
+    rt_tick_t tick[2];
+    int run, i, errors;
+
+    for (run = 0; run < 2; run++)
+    {
+        dfs_dentry_enable(run == 1);
+        seed = 1;
+        errors = 0;
+        tick[run] = rt_tick_get();
+        for (i = 0; i < BENCH_OPS; i++)
+        {
+            bench_path(path, sizeof(path), exist);
+            if (!op(path, exist))
+                errors++;
+        }
+        tick[run] = rt_tick_get() - tick[run];
+        if (errors)
+            rt_kprintf("%s: %d wrong results\n", name, errors);
+    }
+
+    rt_kprintf("%-14s %7d ops/s uncached, %7d ops/s cached\n", name,
+               BENCH_OPS * RT_TICK_PER_SECOND / (tick[0] ? tick[0] : 1),
+               BENCH_OPS * RT_TICK_PER_SECOND / (tick[1] ? tick[1] : 1));
+}
+
+#define CHECK(cond) do { if (!(cond)) { rt_kprintf("check failed, line %d: %s\n", __LINE__, #cond); return RT_FALSE; } } while (0)
+
+static rt_bool_t bench_check(void)
+{
+    char path[BENCH_NAME_MAX + 16], other[BENCH_NAME_MAX + 16];
+    struct stat st;
+    int fd;
+
+    dfs_dentry_enable(RT_TRUE);
+
+    /* a missing path is cached, then created */
+    rt_snprintf(path, sizeof(path), "%s/d0/d1/new", bench_root);
+    CHECK(stat(path, &st) < 0);
+    CHECK(open(path, O_RDONLY) < 0);
+    fd = open(path, O_WRONLY | O_CREAT);
+    CHECK(fd >= 0);
+    CHECK(stat(path, &st) == 0 && st.st_size == 0);
+
+    /* the size is seen while the file is open and after it is closed */
+    CHECK(write(fd, path, 10) == 10);
+    CHECK(stat(path, &st) == 0 && st.st_size == 10);
+    CHECK(write(fd, path, 10) == 10);
+    close(fd);
+    CHECK(stat(path, &st) == 0 && st.st_size == 20);
+
+    /* rename a file */
+    rt_snprintf(other, sizeof(other), "%s/d0/d1/other", bench_root);
+    CHECK(stat(other, &st) < 0);
+    CHECK(rename(path, other) == 0);
+    CHECK(stat(path, &st) < 0);
+    CHECK(stat(other, &st) == 0 && st.st_size == 20);
+
+    /* unlink it */
+    CHECK(unlink(other) == 0);
+    CHECK(stat(other, &st) < 0);
+    CHECK(open(other, O_RDONLY) < 0);
+
+    /* rename a directory, the paths below it change */
+    rt_snprintf(path, sizeof(path), "%s/d0/d1/d2/f0", bench_root);
+    rt_snprintf(other, sizeof(other), "%s/d0/e1/d2/f0", bench_root);
+    CHECK(stat(path, &st) == 0);
+    CHECK(stat(other, &st) < 0);
+    rt_snprintf(path, sizeof(path), "%s/d0/d1", bench_root);
+    rt_snprintf(other, sizeof(other), "%s/d0/e1", bench_root);
+    CHECK(rename(path, other) == 0);
+    rt_snprintf(path, sizeof(path), "%s/d0/d1/d2/f0", bench_root);
+    rt_snprintf(other, sizeof(other), "%s/d0/e1/d2/f0", bench_root);
+    CHECK(stat(path, &st) < 0);
+    CHECK(stat(other, &st) == 0);
+    rt_snprintf(path, sizeof(path), "%s/d0/e1", bench_root);
+    rt_snprintf(other, sizeof(other), "%s/d0/d1", bench_root);
+    CHECK(rename(path, other) == 0);
+
+    /* mkdir and rmdir */
+    rt_snprintf(path, sizeof(path), "%s/d0/dir", bench_root);
+    CHECK(stat(path, &st) < 0);
+    CHECK(mkdir(path, 0) == 0);
+    CHECK(stat(path, &st) == 0 && S_ISDIR(st.st_mode));
+    CHECK(rmdir(path) == 0);
+    CHECK(stat(path, &st) < 0);
+
+    return RT_TRUE;
+}
+
+/* stat the files which never change while the main thread changes others */
+static void bench_reader(void *parameter)
+{
+    char path[BENCH_NAME_MAX + 16];
+    struct stat st;
+    int i;
+
+    for (i = 0; !readers_stop; i++)
+    {
+        rt_snprintf(path, sizeof(path), "%s/d0/d1/f%d", bench_root, i % BENCH_FILES);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode))
+            readers_failed++;
+        rt_snprintf(path, sizeof(path), "%s/d0/d1/x%d", bench_root, i % BENCH_FILES);
+        if (stat(path, &st) == 0)
+            readers_failed++;
+        if (i % 16 == 0)
+            rt_thread_mdelay(1);
+    }
+    rt_sem_release(&readers_done);
+}
+
+static rt_bool_t bench_concurrent(void)
+{
+    char path[BENCH_NAME_MAX + 16], other[BENCH_NAME_MAX + 16];
+    rt_thread_t tid;
+    struct stat st;
+    int i, fd, readers, size;
+    rt_bool_t ok = RT_TRUE;
+
+    rt_sem_init(&readers_done, "dreader", 0, RT_IPC_FLAG_PRIO);
+    readers_stop = RT_FALSE;
+    readers_failed = 0;
+    for (readers = 0; readers < BENCH_READERS; readers++)
+    {
+        tid = rt_thread_create("dreader", bench_reader, RT_NULL, 2048,
+                               rt_thread_self()->current_priority, 2);
+        if (tid == RT_NULL)
+            break;
+        rt_thread_startup(tid);
+    }
+
+    rt_snprintf(path, sizeof(path), "%s/d0/tmp", bench_root);
+    rt_snprintf(other, sizeof(other), "%s/d0/tmp2", bench_root);
+    for (i = 0; i < BENCH_CHANGES && ok; i++)
+    {
+        size = i % BENCH_NAME_MAX;
+        fd = open(path, O_WRONLY | O_CREAT);
+        ok = fd >= 0 && write(fd, path, size) == size;
+        if (fd >= 0)
+            close(fd);
+        ok = ok && stat(path, &st) == 0 && st.st_size == size;
+        ok = ok && rename(path, other) == 0 && stat(path, &st) < 0 && stat(other, &st) == 0;
+        ok = ok && unlink(other) == 0 && stat(other, &st) < 0;
+    }
+    if (!ok)
+        rt_kprintf("change %d was not seen\n", i);
+
+    readers_stop = RT_TRUE;
+    while (readers-- > 0)
+        rt_sem_take(&readers_done, RT_WAITING_FOREVER);
+    rt_sem_detach(&readers_done);
+
+    return ok && readers_failed == 0;
+}
+
+static int dentry_bench(int argc, char **argv)
+{
+    static rt_bool_t registered = RT_FALSE;
+    struct dfs_dentry_stat cstat;
+    rt_bool_t made = RT_FALSE;
+    rt_bool_t ok;
+
+    if (!registered)
+    {
+        if (dfs_register(&bench_fs) < 0)
+        {
+            rt_kprintf("can't register the bench file system, DFS_FILESYSTEM_TYPES_MAX is %d\n",
+                       DFS_FILESYSTEM_TYPES_MAX);
+            return -RT_ERROR;
+        }
+        rt_mutex_init(&bench_lock, "dbench", RT_IPC_FLAG_PRIO);
+        registered = RT_TRUE;
+    }
+    bench_tree();
+
+    /* mount on the root or on a directory of the root file system */
+    if (dfs_filesystem_lookup("/") == RT_NULL)
+    {
+        bench_root[0] = '\0';
+        ok = dfs_mount(RT_NULL, "/", "dbench", 0, RT_NULL) == 0;
+    }
+    else
+    {
+        rt_strncpy(bench_root, "/dbench", sizeof(bench_root));
+        made = mkdir(bench_root, 0) == 0;
+        ok = dfs_mount(RT_NULL, bench_root, "dbench", 0, RT_NULL) == 0;
+    }
+    if (!ok)
+    {
+        rt_kprintf("can't mount the bench file system\n");
+        if (made)
+            rmdir(bench_root);
+        return -RT_ERROR;
+    }
+
+    rt_kprintf("tree of %d directories with %d files each, %d ops per run\n",
+               BENCH_DEPTH, BENCH_FILES, BENCH_OPS);
+    dfs_dentry_reset_stat();
+    bench_run("stat", op_stat, RT_TRUE);
+    bench_run("stat missing", op_stat, RT_FALSE);
+    bench_run("open", op_open, RT_TRUE);
+    bench_run("open missing", op_open, RT_FALSE);
+    dfs_dentry_get_stat(&cstat);
+    rt_kprintf("cache: hit %d (missing %d), miss %d, evict %d\n",
+               cstat.hit, cstat.negative, cstat.miss, cstat.evict);
+
+    rt_kprintf("invalidation: %s\n", bench_check() ? "PASS" : "FAIL");
+    rt_kprintf("concurrent:   %s\n", bench_concurrent() ? "PASS" : "FAIL");
+
+    dfs_unmount(bench_root[0] ? bench_root : "/");
+    if (made)
+        rmdir(bench_root);
+
+    return RT_EOK;
+}
+MSH_CMD_EXPORT(dentry_bench, dfs path cache benchmark on a deep directory tree);
@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Stress test of the fd table.
+ *
+ * Worker threads allocate, resolve and release descriptors as fast as they
+ * can, each keeping a few of them at a time, while another thread resolves
+ * random descriptor numbers like read() and write() of other sockets and
+ * files would. Every worker tags its descriptors and checks that nobody else
+ * got them, at the end the table must be as it was before.
+ *
+ * msh: fd_stress [loops]
+ */
+
+#include <rtthread.h>
+#include <dfs.h>
+#include <dfs_file.h>
+#include <stdlib.h>
+
+#define STRESS_WORKERS          4
+#define STRESS_HOLD_MAX         8
+
+static struct rt_semaphore stress_done;
+static volatile rt_bool_t stress_stop;
+static volatile int stress_errors;
+static int stress_loops;
+static int stress_hold;
+static rt_uint32_t stress_allocs[STRESS_WORKERS];
+static rt_uint32_t stress_resolves;
+
+static rt_uint32_t stress_rand(rt_uint32_t *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return *seed >> 8;
+}
+
+static void stress_error(const char *what, int fd)
+{
+    stress_errors++;
+    if (stress_errors < 10)
+        rt_kprintf("%s: fd %d\n", what, fd);
+}
+
+static void stress_worker(void *parameter)
+{
+    int fds[STRESS_HOLD_MAX];
+    rt_uint32_t id = (rt_uint32_t)(rt_ubase_t)parameter;
+    rt_uint32_t seed = id + 1;
+    struct dfs_fd *d;
+    int loop, i, n;
+
+    for (loop = 0; loop < stress_loops; loop++)
+    {
+        n = 1 + stress_rand(&seed) % stress_hold;
+        for (i = 0; i < n; i++)
+        {
+            fds[i] = fd_new();
+            d = fd_get(fds[i]);
+            if (d == RT_NULL)
+            {
+                stress_error("can't allocate", fds[i]);
+                n = i;
+                break;
+            }
+            d->data = (void *)(rt_ubase_t)((id << 24) | (loop << 4) | i);
+            fd_put(d);
+        }
+
+        if (loop % 8 == 0)
+            rt_thread_yield();
+
+        for (i = 0; i < n; i++)
+        {
+            d = fd_get(fds[i]);
+            if (d == RT_NULL || d->data != (void *)(rt_ubase_t)((id << 24) | (loop << 4) | i))
+                stress_error("taken by another thread", fds[i]);
+            if (d != RT_NULL)
+                fd_put(d);
+        }
+
+        /* like close() */
+        for (i = 0; i < n; i++)
+        {
+            d = fd_get(fds[i]);
+            if (d == RT_NULL)
+                continue;
+            fd_put(d);
+            fd_put(d);
+        }
+        stress_allocs[id] += n;
+    }
+
+    rt_sem_release(&stress_done);
+}
+
+static void stress_resolver(void *parameter)
+{
+    rt_uint32_t seed = 1234;
+    struct dfs_fd *d;
+    int fd;
+
+    while (!stress_stop)
+    {
+        fd = DFS_FD_OFFSET + stress_rand(&seed) % DFS_FD_MAX;
+        d = fd_get(fd);
+        if (d != RT_NULL)
+        {
+            if (d->magic != DFS_FD_MAGIC)
+                stress_error("bad descriptor", fd);
+            fd_put(d);
+        }
+        stress_resolves++;
+
+        if (stress_resolves % 64 == 0)
+            rt_thread_yield();
+    }
+
+    rt_sem_release(&stress_done);
+}
+
+static int fd_stress(int argc, char **argv)
+{
+    struct dfs_fdtable *fdt = dfs_fdtable_get();
+    rt_uint32_t used_before = 0, used_after = 0, allocs = 0;
+    rt_uint8_t priority = rt_thread_self()->current_priority;
+    rt_thread_t tid;
+    rt_tick_t tick;
+    int threads = 0, i;
+
+    dfs_lock();
+    for (i = 0; i < (int)fdt->maxfd; i++)
+        used_before += fdt->fds[i] != RT_NULL && fdt->fds[i]->ref_count > 0;
+    dfs_unlock();
+
+    /* share the free descriptors */
+    stress_loops = argc > 1 ? atoi(argv[1]) : 2000;
+    stress_hold = (DFS_FD_MAX - used_before) / STRESS_WORKERS;
+    if (stress_hold > STRESS_HOLD_MAX)
+        stress_hold = STRESS_HOLD_MAX;
+    if (stress_hold < 1)
+    {
+        rt_kprintf("no free descriptors\n");
+        return -RT_ERROR;
+    }
+
+    rt_sem_init(&stress_done, "fdstress", 0, RT_IPC_FLAG_PRIO);
+    stress_stop = RT_FALSE;
+    stress_errors = 0;
+    rt_memset(stress_allocs, 0, sizeof(stress_allocs));
+    stress_resolves = 0;
+
+    tick = rt_tick_get();
+    tid = rt_thread_create("fdres", stress_resolver, RT_NULL, 1024, priority + 1, 1);
+    if (tid != RT_NULL)
+    {
+        rt_thread_startup(tid);
+        threads++;
+    }
+    for (i = 0; i < STRESS_WORKERS; i++)
+    {
+        tid = rt_thread_create("fdwork", stress_worker, (void *)(rt_ubase_t)i, 1024, priority + 1, 1);
+        if (tid == RT_NULL)
+            break;
+        rt_thread_startup(tid);
+        threads++;
+    }
+
+    /* the workers finish, then the resolver is stopped */
+    for (i = 1; i < threads; i++)
+        rt_sem_take(&stress_done, RT_WAITING_FOREVER);
+    stress_stop = RT_TRUE;
+    if (threads > 0)
+        rt_sem_take(&stress_done, RT_WAITING_FOREVER);
+    tick = rt_tick_get() - tick;
+    rt_sem_detach(&stress_done);
+
+    dfs_lock();
+    for (i = 0; i < (int)fdt->maxfd; i++)
+        used_after += fdt->fds[i] != RT_NULL && fdt->fds[i]->ref_count > 0;
+    dfs_unlock();
+    if (used_after != used_before)
+        stress_error("descriptors left in the table", used_after - used_before);
+    for (i = 0; i < STRESS_WORKERS; i++)
+        allocs += stress_allocs[i];
+
+    rt_kprintf("%d workers holding up to %d descriptors, table of %d\n", threads - 1, stress_hold, fdt->maxfd);
+    rt_kprintf("%d allocations, %d resolutions in %d ms\n", allocs, stress_resolves,
+               tick * 1000 / RT_TICK_PER_SECOND);
+    rt_kprintf("fd_stress: %s\n", stress_errors ? "FAIL" : "PASS");
+
+    return stress_errors ? -RT_ERROR : RT_EOK;
+}
+MSH_CMD_EXPORT(fd_stress, fd table stress test: fd_stress [loops]);
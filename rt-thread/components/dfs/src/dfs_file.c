@@ -13,6 +13,7 @@
 
 #include <dfs.h>
 #include <dfs_file.h>
+#include <dfs_dentry.h>
 #include <dfs_private.h>
 
 /**
@@ -21,6 +22,27 @@
 
 /*@{*/
 
+/* the cached stat of a file is out of date after it is written */
+static void dfs_file_changed(struct dfs_fd *fd)
+{
+    if (fd->fs != NULL && fd->path != NULL)
+        dfs_dentry_remove(fd->fs, fd->path);
+}
+
+#ifdef DFS_USING_DENTRY_CACHE
+/* the path handed to the file system */
+static const char *dfs_file_fspath(struct dfs_filesystem *fs, const char *fullpath)
+{
+    const char *subpath;
+
+    if (fs->ops->flags & DFS_FS_FLAG_FULLPATH)
+        return fullpath;
+
+    subpath = dfs_subdir(fs->path, fullpath);
+    return subpath != NULL ? subpath : "/";
+}
+#endif
+
 /**
  * this function will open a file which specified by path with specified flags.
  *
@@ -34,6 +56,7 @@ int dfs_file_open(struct dfs_fd *fd, const char *path, int flags)
 {
     struct dfs_filesystem *fs;
     char *fullpath;
+    rt_uint32_t gen;
     int result;
 
     /* parameter check */
@@ -93,7 +116,18 @@ int dfs_file_open(struct dfs_fd *fd, const char *path, int flags)
         return -ENOSYS;
     }
 
-    if ((result = fd->fops->open(fd)) < 0)
+    if ((flags & (O_ACCMODE | O_CREAT)) != O_RDONLY)
+    {
+        result = fd->fops->open(fd);
+    }
+    else if ((result = dfs_dentry_lookup(fs, fd->path, NULL, &gen)) != -ENOENT)
+    {
+        /* a file which is only read is not created, remember it does not exist */
+        if ((result = fd->fops->open(fd)) == -ENOENT)
+            dfs_dentry_insert(fs, fd->path, NULL, gen);
+    }
+
+    if (result < 0)
     {
         /* clear fd */
         rt_free(fd->path);
@@ -104,6 +138,10 @@ int dfs_file_open(struct dfs_fd *fd, const char *path, int flags)
         return result;
     }
 
+    /* the file may be created or truncated */
+    if ((flags & (O_ACCMODE | O_CREAT | O_TRUNC)) != O_RDONLY)
+        dfs_dentry_remove(fs, fd->path);
+
     fd->flags |= DFS_F_OPEN;
     if (flags & O_DIRECTORY)
     {
@@ -136,6 +174,9 @@ int dfs_file_close(struct dfs_fd *fd)
     if (result < 0)
         return result;
 
+    if ((fd->flags & O_ACCMODE) != O_RDONLY)
+        dfs_file_changed(fd);
+
     rt_free(fd->path);
     fd->path = NULL;
 
@@ -177,7 +218,14 @@ int dfs_file_ioctl(struct dfs_fd *fd, int cmd, void *args)
     }
 
     if (fd->fops->ioctl != NULL)
-        return fd->fops->ioctl(fd, cmd, args);
+    {
+        int result = fd->fops->ioctl(fd, cmd, args);
+
+        /* the preallocated clusters are in the size */
+        if (cmd == RT_FIOEXPAND && result == 0)
+            dfs_file_changed(fd);
+        return result;
+    }
 
     return -ENOSYS;
 }
@@ -277,6 +325,9 @@ int dfs_file_unlink(const char *path)
     }
     else result = -ENOSYS;
 
+    /* a directory is unlinked with the paths below it */
+    dfs_dentry_invalidate(fs, dfs_file_fspath(fs, fullpath));
+
 __exit:
     rt_free(fullpath);
     return result;
@@ -293,13 +344,18 @@ __exit:
  */
 int dfs_file_write(struct dfs_fd *fd, const void *buf, size_t len)
 {
+    int result;
+
     if (fd == NULL)
         return -EINVAL;
 
     if (fd->fops->write == NULL)
         return -ENOSYS;
 
-    return fd->fops->write(fd, buf, len);
+    result = fd->fops->write(fd, buf, len);
+    dfs_file_changed(fd);
+
+    return result;
 }
 
 /**
@@ -311,13 +367,19 @@ int dfs_file_write(struct dfs_fd *fd, const void *buf, size_t len)
  */
 int dfs_file_flush(struct dfs_fd *fd)
 {
+    int result;
+
     if (fd == NULL)
         return -EINVAL;
 
     if (fd->fops->flush == NULL)
         return -ENOSYS;
 
-    return fd->fops->flush(fd);
+    result = fd->fops->flush(fd);
+    /* the directory entry is updated by the flush */
+    dfs_file_changed(fd);
+
+    return result;
 }
 
 /**
@@ -359,7 +421,9 @@ int dfs_file_stat(const char *path, struct stat *buf)
 {
     int result;
     char *fullpath;
+    const char *subpath;
     struct dfs_filesystem *fs;
+    rt_uint32_t gen;
 
     fullpath = dfs_normalize_path(NULL, path);
     if (fullpath == NULL)
@@ -405,9 +469,19 @@ int dfs_file_stat(const char *path, struct stat *buf)
 
         /* get the real file path and get file stat */
         if (fs->ops->flags & DFS_FS_FLAG_FULLPATH)
-            result = fs->ops->stat(fs, fullpath, buf);
+            subpath = fullpath;
         else
-            result = fs->ops->stat(fs, dfs_subdir(fs->path, fullpath), buf);
+            subpath = dfs_subdir(fs->path, fullpath);
+
+        result = dfs_dentry_lookup(fs, subpath, buf, &gen);
+        if (result == -EAGAIN)
+        {
+            result = fs->ops->stat(fs, subpath, buf);
+            if (result == 0)
+                dfs_dentry_insert(fs, subpath, buf, gen);
+            else if (result == -ENOENT)
+                dfs_dentry_insert(fs, subpath, NULL, gen);
+        }
     }
 
     rt_free(fullpath);
@@ -465,6 +539,10 @@ int dfs_file_rename(const char *oldpath, const char *newpath)
                 result = oldfs->ops->rename(oldfs,
                                             dfs_subdir(oldfs->path, oldfullpath),
                                             dfs_subdir(newfs->path, newfullpath));
+
+            /* the paths below both names change, even if the rename failed halfway */
+            dfs_dentry_invalidate(oldfs, dfs_file_fspath(oldfs, oldfullpath));
+            dfs_dentry_invalidate(oldfs, dfs_file_fspath(oldfs, newfullpath));
         }
     }
     else
@@ -505,6 +583,7 @@ int dfs_file_ftruncate(struct dfs_fd *fd, off_t length)
     /* update current size */
     if (result == 0)
         fd->size = length;
+    dfs_file_changed(fd);
 
     return result;
 }
@@ -14,6 +14,7 @@
 
 #include <dfs_fs.h>
 #include <dfs_file.h>
+#include <dfs_dentry.h>
 #include "dfs_private.h"
 
 /**
@@ -77,6 +78,12 @@ int dfs_register(const struct dfs_filesystem_ops *ops)
  */
 struct dfs_filesystem *dfs_filesystem_lookup(const char *path)
 {
+#ifdef DFS_USING_DENTRY_CACHE
+    RT_ASSERT(path);
+
+    /* walk the mount point tree, readers do not block each other */
+    return dfs_mnt_lookup(path);
+#else
     struct dfs_filesystem *iter;
     struct dfs_filesystem *fs = NULL;
     uint32_t fspath, prefixlen;
@@ -111,6 +118,7 @@ struct dfs_filesystem *dfs_filesystem_lookup(const char *path)
     dfs_unlock();
 
     return fs;
+#endif
 }
 
 /**
@@ -344,6 +352,24 @@ int dfs_mount(const char   *device_name,
         goto err1;
     }
 
+#ifdef DFS_USING_DENTRY_CACHE
+    /* the entry may be reused, drop the paths of the last file system in it */
+    dfs_dentry_flush(fs);
+    if (dfs_mnt_insert(fs) < 0)
+    {
+        if ((*ops)->unmount != NULL)
+            (*ops)->unmount(fs);
+        if (dev_id != NULL)
+            rt_device_close(fs->dev_id);
+
+        dfs_lock();
+        rt_memset(fs, 0, sizeof(struct dfs_filesystem));
+        rt_set_errno(-ENOMEM);
+
+        goto err1;
+    }
+#endif
+
     return 0;
 
 err1:
@@ -395,6 +421,11 @@ int dfs_unmount(const char *specialfile)
         goto err1;
     }
 
+#ifdef DFS_USING_DENTRY_CACHE
+    dfs_mnt_remove(fs);
+    dfs_dentry_flush(fs);
+#endif
+
     /* close device, but do not check the status of device */
     if (fs->dev_id != NULL)
         rt_device_close(fs->dev_id);
@@ -456,6 +487,8 @@ int dfs_mkfs(const char *fs_name, const char *device_name)
     {
         /* find file system operation */
         const struct dfs_filesystem_ops *ops = filesystem_operation_table[index];
+        int result;
+
         if (ops->mkfs == NULL)
         {
             LOG_E("The file system (%s) mkfs function was not implement", fs_name);
@@ -463,7 +496,12 @@ int dfs_mkfs(const char *fs_name, const char *device_name)
             return -1;
         }
 
-        return ops->mkfs(dev_id);
+        result = ops->mkfs(dev_id);
+
+        /* the file system on the device may be mounted */
+        dfs_dentry_flush(NULL);
+
+        return result;
     }
 
     LOG_E("File system (%s) was not found.", fs_name);
@@ -582,6 +620,11 @@ int dfs_unmount_device(rt_device_t dev)
         goto err1;
     }
 
+#ifdef DFS_USING_DENTRY_CACHE
+    dfs_mnt_remove(fs);
+    dfs_dentry_flush(fs);
+#endif
+
     /* close device, but do not check the status of device */
     if (fs->dev_id != NULL)
         rt_device_close(fs->dev_id);
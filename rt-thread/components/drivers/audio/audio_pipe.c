@@ -47,14 +47,16 @@ static rt_size_t rt_pipe_read(rt_device_t dev,
 
     if (!(pipe->flag & RT_PIPE_FLAG_BLOCK_RD))
     {
-        level = rt_hw_interrupt_disable();
-        read_nbytes = rt_ringbuffer_get(&(pipe->ringbuffer), (rt_uint8_t *)buffer, size);
+        /* the reader is the only consumer of the ring, it copies with interrupts enabled */
+        read_nbytes = rt_spsc_ring_get(&(pipe->ringbuffer), (rt_uint8_t *)buffer, size);
 
         /* if the ringbuffer is empty, there won't be any writer waiting */
         if (read_nbytes)
+        {
+            level = rt_hw_interrupt_disable();
             _rt_pipe_resume_writer(pipe);
-
-        rt_hw_interrupt_enable(level);
+            rt_hw_interrupt_enable(level);
+        }
 
         return read_nbytes;
     }
@@ -66,10 +68,18 @@ static rt_size_t rt_pipe_read(rt_device_t dev,
 
     do
     {
+        read_nbytes = rt_spsc_ring_get(&(pipe->ringbuffer), (rt_uint8_t *)buffer, size);
+
         level = rt_hw_interrupt_disable();
-        read_nbytes = rt_ringbuffer_get(&(pipe->ringbuffer), (rt_uint8_t *)buffer, size);
         if (read_nbytes == 0)
         {
+            /* the writer may have put data since the ring was found empty */
+            if (rt_spsc_ring_data_len(&(pipe->ringbuffer)) != 0)
+            {
+                rt_hw_interrupt_enable(level);
+                continue;
+            }
+
             rt_thread_suspend(thread);
             /* waiting on suspended read list */
             rt_list_insert_before(&(pipe->suspended_read_list),
@@ -94,7 +104,7 @@ static void _rt_pipe_resume_reader(struct rt_audio_pipe *pipe)
 {
     if (pipe->parent.rx_indicate)
         pipe->parent.rx_indicate(&pipe->parent,
-                                 rt_ringbuffer_data_len(&pipe->ringbuffer));
+                                 rt_spsc_ring_data_len(&pipe->ringbuffer));
 
     if (!rt_list_isempty(&pipe->suspended_read_list))
     {
@@ -130,15 +140,16 @@ static rt_size_t rt_pipe_write(rt_device_t dev,
     if ((pipe->flag & RT_PIPE_FLAG_FORCE_WR) ||
             !(pipe->flag & RT_PIPE_FLAG_BLOCK_WR))
     {
-        level = rt_hw_interrupt_disable();
-
+        /* the writer is the only producer of the ring, e.g. the record interrupt,
+         * a forced write over a reader still copying glitches data lost anyway */
         if (pipe->flag & RT_PIPE_FLAG_FORCE_WR)
-            write_nbytes = rt_ringbuffer_put_force(&(pipe->ringbuffer),
-                                                   (const rt_uint8_t *)buffer, size);
+            write_nbytes = rt_spsc_ring_put_force(&(pipe->ringbuffer),
+                                                  (const rt_uint8_t *)buffer, size);
         else
-            write_nbytes = rt_ringbuffer_put(&(pipe->ringbuffer),
-                                             (const rt_uint8_t *)buffer, size);
+            write_nbytes = rt_spsc_ring_put(&(pipe->ringbuffer),
+                                            (const rt_uint8_t *)buffer, size);
 
+        level = rt_hw_interrupt_disable();
         _rt_pipe_resume_reader(pipe);
 
         rt_hw_interrupt_enable(level);
@@ -153,10 +164,18 @@ static rt_size_t rt_pipe_write(rt_device_t dev,
 
     do
     {
+        write_nbytes = rt_spsc_ring_put(&(pipe->ringbuffer), (const rt_uint8_t *)buffer, size);
+
         level = rt_hw_interrupt_disable();
-        write_nbytes = rt_ringbuffer_put(&(pipe->ringbuffer), (const rt_uint8_t *)buffer, size);
         if (write_nbytes == 0)
         {
+            /* the reader may have taken data since the ring was found full */
+            if (rt_spsc_ring_space_len(&(pipe->ringbuffer)) != 0)
+            {
+                rt_hw_interrupt_enable(level);
+                continue;
+            }
+
             /* pipe full, waiting on suspended write list */
             rt_thread_suspend(thread);
             /* waiting on suspended read list */
@@ -185,7 +204,7 @@ static rt_err_t rt_pipe_control(rt_device_t dev, int cmd, void *args)
     pipe = (struct rt_audio_pipe *)dev;
 
     if (cmd == PIPE_CTRL_GET_SPACE && args)
-        *(rt_size_t *)args = rt_ringbuffer_space_len(&pipe->ringbuffer);
+        *(rt_size_t *)args = rt_spsc_ring_space_len(&pipe->ringbuffer);
     return RT_EOK;
 }
 
@@ -226,8 +245,8 @@ rt_err_t rt_audio_pipe_init(struct rt_audio_pipe *pipe,
     rt_list_init(&pipe->suspended_read_list);
     rt_list_init(&pipe->suspended_write_list);
 
-    /* initialize ring buffer */
-    rt_ringbuffer_init(&pipe->ringbuffer, buf, size);
+    /* initialize ring buffer, of the largest power of two in size */
+    rt_spsc_ring_init(&pipe->ringbuffer, buf, size);
 
     pipe->flag = flag;
 
@@ -264,9 +283,13 @@ rt_err_t rt_audio_pipe_create(const char *name, rt_int32_t flag, rt_size_t size)
 {
     rt_uint8_t *rb_memptr = RT_NULL;
     struct rt_audio_pipe *pipe = RT_NULL;
+    rt_size_t bufsz;
 
-    /* get aligned size */
-    size = RT_ALIGN(size, RT_ALIGN_SIZE);
+    /* get aligned size, a power of two for the ring */
+    bufsz = RT_ALIGN_SIZE;
+    while (bufsz < size)
+        bufsz <<= 1;
+    size = bufsz;
     pipe = (struct rt_audio_pipe *)rt_calloc(1, sizeof(struct rt_audio_pipe));
     if (pipe == RT_NULL)
         return -RT_ENOMEM;
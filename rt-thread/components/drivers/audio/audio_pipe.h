@@ -46,8 +46,8 @@ struct rt_audio_pipe
 {
     struct rt_device parent;
 
-    /* ring buffer in pipe device */
-    struct rt_ringbuffer ringbuffer;
+    /* lock-free ring buffer in pipe device, one writer and one reader */
+    struct rt_spsc_ring ringbuffer;
 
     rt_int32_t flag;
 
@@ -0,0 +1,848 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Sector cache stacked on a block device.
+ *
+ * The cache is a fixed pool of sector buffers with a hash for the lookup and
+ * a LRU list for the eviction. Misses next to each other are read with one
+ * device request, sequential reads extend the request with a read ahead
+ * window which grows while the reads stay sequential. Writes only mark the
+ * buffers dirty, they are written back sorted and merged into runs of
+ * contiguous sectors by the flush thread, when the cache runs short of
+ * clean buffers or on RT_DEVICE_CTRL_BLK_SYNC (fsync).
+ * Requests bigger than the staging buffer bypass the cache.
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#define DBG_TAG               "blk.cache"
+#define DBG_LVL               DBG_INFO
+#include <rtdbg.h>
+
+#ifndef RT_BLK_CACHE_IO_SECTORS
+#define RT_BLK_CACHE_IO_SECTORS         32
+#endif
+#ifndef RT_BLK_CACHE_READ_AHEAD_SECTORS
+#define RT_BLK_CACHE_READ_AHEAD_SECTORS 16
+#endif
+#ifndef RT_BLK_CACHE_FLUSH_MS
+#define RT_BLK_CACHE_FLUSH_MS           1000
+#endif
+#ifndef RT_BLK_CACHE_THREAD_PRIORITY
+#define RT_BLK_CACHE_THREAD_PRIORITY    22
+#endif
+#ifndef RT_BLK_CACHE_THREAD_STACK_SIZE
+#define RT_BLK_CACHE_THREAD_STACK_SIZE  1024
+#endif
+
+/* first read ahead window of a sequential stream */
+#define READ_AHEAD_MIN      4
+/* write back everything when more than 3/4 of the cache is dirty */
+#define DIRTY_HIGH(c)       ((c)->count - (c)->count / 4)
+#define BUF_ALIGN           32
+
+struct blk_cache_entry
+{
+    rt_list_t list;                     /* LRU list, the most recently used first */
+    struct blk_cache_entry *hash_next;
+    rt_uint32_t sector;
+    rt_uint8_t *buf;
+    rt_uint8_t valid;
+    rt_uint8_t dirty;
+    rt_uint8_t read_ahead;              /* read ahead and not used yet */
+};
+
+struct rt_blk_cache
+{
+    struct rt_device parent;
+    rt_device_t dev;                    /* the cached device */
+    struct rt_device_blk_geometry geometry;
+    struct rt_mutex lock;
+
+    struct blk_cache_entry *entries;
+    struct blk_cache_entry **hash;
+    struct blk_cache_entry **sort_buf;  /* the dirty entries in sector order */
+    rt_uint32_t hash_mask;
+    rt_uint32_t count;
+    rt_uint32_t io_sectors;
+    rt_list_t lru;
+    rt_uint8_t *pool;
+    rt_uint8_t *io_buf;                 /* staging buffer of the merged requests */
+    rt_bool_t in_memheap;
+
+    rt_uint32_t ra_next;                /* the sector after the last read */
+    rt_uint32_t ra_window;              /* 0: not sequential */
+
+    rt_tick_t dirty_tick;               /* when the cache became dirty */
+    struct rt_semaphore flush_sem;
+    rt_thread_t flush_thread;
+
+    struct rt_blk_cache_stat stat;
+};
+
+static void *cache_mem_alloc(struct rt_blk_cache *c, rt_size_t size)
+{
+#if defined(RT_USING_MEMHEAP) && defined(RT_BLK_CACHE_MEMHEAP)
+    struct rt_memheap *heap;
+
+    heap = (struct rt_memheap *)rt_object_find(RT_BLK_CACHE_MEMHEAP, RT_Object_Class_MemHeap);
+    if (heap != RT_NULL)
+    {
+        c->in_memheap = RT_TRUE;
+        return rt_memheap_alloc(heap, size);
+    }
+#endif
+    c->in_memheap = RT_FALSE;
+    return rt_malloc_align(size, BUF_ALIGN);
+}
+
+static void cache_mem_free(struct rt_blk_cache *c, void *ptr)
+{
+    if (ptr == RT_NULL)
+        return;
+#ifdef RT_USING_MEMHEAP
+    if (c->in_memheap)
+    {
+        rt_memheap_free(ptr);
+        return;
+    }
+#endif
+    rt_free_align(ptr);
+}
+
+static struct blk_cache_entry *cache_lookup(struct rt_blk_cache *c, rt_uint32_t sector)
+{
+    struct blk_cache_entry *e;
+
+    for (e = c->hash[sector & c->hash_mask]; e != RT_NULL; e = e->hash_next)
+    {
+        if (e->sector == sector)
+            return e;
+    }
+    return RT_NULL;
+}
+
+static void cache_hash_remove(struct rt_blk_cache *c, struct blk_cache_entry *e)
+{
+    struct blk_cache_entry **p = &c->hash[e->sector & c->hash_mask];
+
+    while (*p != e)
+        p = &(*p)->hash_next;
+    *p = e->hash_next;
+    e->hash_next = RT_NULL;
+    e->valid = 0;
+}
+
+static void cache_touch(struct rt_blk_cache *c, struct blk_cache_entry *e)
+{
+    rt_list_remove(&e->list);
+    rt_list_insert_after(&c->lru, &e->list);
+}
+
+/* drop an entry without writing it back, it's reused first */
+static void cache_drop(struct rt_blk_cache *c, struct blk_cache_entry *e)
+{
+    if (e->valid)
+        cache_hash_remove(c, e);
+    if (e->dirty)
+    {
+        e->dirty = 0;
+        c->stat.dirty--;
+    }
+    e->read_ahead = 0;
+    rt_list_remove(&e->list);
+    rt_list_insert_before(&c->lru, &e->list);
+}
+
+static rt_err_t cache_dev_read(struct rt_blk_cache *c, rt_uint32_t sector, void *buf, rt_uint32_t n)
+{
+    c->stat.dev_read++;
+    if (rt_device_read(c->dev, sector, buf, n) != n)
+    {
+        LOG_E("read %d sectors at %d failed", n, sector);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+static rt_err_t cache_dev_write(struct rt_blk_cache *c, rt_uint32_t sector, const void *buf, rt_uint32_t n)
+{
+    c->stat.dev_write++;
+    if (rt_device_write(c->dev, sector, buf, n) != n)
+    {
+        LOG_E("write %d sectors at %d failed", n, sector);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+/* write back all dirty entries, sorted and merged into runs of contiguous sectors */
+static rt_err_t cache_flush_locked(struct rt_blk_cache *c)
+{
+    rt_uint32_t i, j, k, n = 0;
+    rt_uint32_t ss = c->geometry.bytes_per_sector;
+    rt_err_t result = RT_EOK;
+    struct blk_cache_entry *e;
+
+    if (c->stat.dirty == 0)
+        return RT_EOK;
+
+    /* insertion sort, the dirty entries are mostly written in order */
+    for (i = 0; i < c->count; i++)
+    {
+        e = &c->entries[i];
+        if (!e->dirty)
+            continue;
+        for (j = n; j > 0 && c->sort_buf[j - 1]->sector > e->sector; j--)
+            c->sort_buf[j] = c->sort_buf[j - 1];
+        c->sort_buf[j] = e;
+        n++;
+    }
+
+    for (i = 0; i < n; i = j)
+    {
+        for (j = i + 1; j < n && j - i < c->io_sectors &&
+                c->sort_buf[j]->sector == c->sort_buf[j - 1]->sector + 1; j++);
+
+        if (j - i == 1)
+        {
+            if (cache_dev_write(c, c->sort_buf[i]->sector, c->sort_buf[i]->buf, 1) != RT_EOK)
+            {
+                result = -RT_EIO;
+                continue;
+            }
+        }
+        else
+        {
+            for (k = i; k < j; k++)
+                rt_memcpy(c->io_buf + (k - i) * ss, c->sort_buf[k]->buf, ss);
+            if (cache_dev_write(c, c->sort_buf[i]->sector, c->io_buf, j - i) != RT_EOK)
+            {
+                result = -RT_EIO;
+                continue;
+            }
+        }
+
+        for (k = i; k < j; k++)
+            c->sort_buf[k]->dirty = 0;
+        c->stat.dirty -= j - i;
+        c->stat.write_back += j - i;
+    }
+
+    return result;
+}
+
+/* take the least recently used entry, it's not hashed when returned */
+static struct blk_cache_entry *cache_alloc(struct rt_blk_cache *c)
+{
+    struct blk_cache_entry *e = rt_list_entry(c->lru.prev, struct blk_cache_entry, list);
+
+    if (e->dirty)
+    {
+        /* write back all of them at once, the next victims are likely dirty too */
+        if (cache_flush_locked(c) != RT_EOK)
+            return RT_NULL;
+    }
+    if (e->valid)
+        cache_hash_remove(c, e);
+    e->read_ahead = 0;
+    cache_touch(c, e);
+
+    return e;
+}
+
+static void cache_insert(struct rt_blk_cache *c, struct blk_cache_entry *e, rt_uint32_t sector)
+{
+    rt_uint32_t idx = sector & c->hash_mask;
+
+    e->sector = sector;
+    e->valid = 1;
+    e->hash_next = c->hash[idx];
+    c->hash[idx] = e;
+}
+
+static void cache_mark_dirty(struct rt_blk_cache *c, struct blk_cache_entry *e)
+{
+    if (e->dirty)
+        return;
+
+    e->dirty = 1;
+    if (c->stat.dirty++ == 0)
+    {
+        c->dirty_tick = rt_tick_get();
+        /* start the delayed write back */
+        rt_sem_release(&c->flush_sem);
+    }
+}
+
+/* read `n` missing sectors and `ra` sectors ahead of them through the cache */
+static rt_err_t cache_fill(struct rt_blk_cache *c, rt_uint32_t sector, rt_uint8_t *buffer,
+                           rt_uint32_t n, rt_uint32_t ra)
+{
+    struct blk_cache_entry *run[RT_BLK_CACHE_IO_SECTORS];
+    rt_uint32_t ss = c->geometry.bytes_per_sector;
+    rt_uint32_t k;
+
+    /* allocate first, it may write back dirty entries through the staging buffer */
+    for (k = 0; k < n + ra; k++)
+    {
+        run[k] = cache_alloc(c);
+        if (run[k] == RT_NULL)
+            break;
+    }
+    if (k < n + ra || cache_dev_read(c, sector, c->io_buf, n + ra) != RT_EOK)
+    {
+        while (k--)
+            cache_drop(c, run[k]);
+        return -RT_EIO;
+    }
+
+    for (k = 0; k < n + ra; k++)
+    {
+        rt_memcpy(run[k]->buf, c->io_buf + k * ss, ss);
+        run[k]->read_ahead = k >= n;
+        cache_insert(c, run[k], sector + k);
+    }
+    rt_memcpy(buffer, c->io_buf, n * ss);
+    c->stat.miss += n;
+    c->stat.read_ahead += ra;
+
+    return RT_EOK;
+}
+
+/* number of sectors to read ahead from `next` on, with `n` sectors read in front of them */
+static rt_uint32_t cache_read_ahead(struct rt_blk_cache *c, rt_uint32_t next, rt_uint32_t n)
+{
+    rt_uint32_t k, ra = c->ra_window;
+
+    if (ra > c->io_sectors - n)
+        ra = c->io_sectors - n;
+    if (next >= c->geometry.sector_count)
+        return 0;
+    if (ra > c->geometry.sector_count - next)
+        ra = c->geometry.sector_count - next;
+
+    /* stop in front of the sectors which are cached already */
+    for (k = 0; k < ra; k++)
+    {
+        if (cache_lookup(c, next + k) != RT_NULL)
+            break;
+    }
+
+    return k;
+}
+
+static rt_err_t rt_blk_cache_init(rt_device_t dev)
+{
+    return RT_EOK;
+}
+
+static rt_err_t rt_blk_cache_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    return RT_EOK;
+}
+
+static rt_err_t rt_blk_cache_close(rt_device_t dev)
+{
+    return rt_blk_cache_flush(dev);
+}
+
+static rt_size_t rt_blk_cache_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+    struct blk_cache_entry *e;
+    rt_uint32_t ss = c->geometry.bytes_per_sector;
+    rt_uint8_t *ptr = (rt_uint8_t *)buffer;
+    rt_uint32_t i, n, ra;
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+
+    if (size >= c->io_sectors)
+    {
+        /* big reads go to the device directly, only the dirty sectors are newer in the cache */
+        if (cache_dev_read(c, pos, buffer, size) != RT_EOK)
+        {
+            rt_mutex_release(&c->lock);
+            rt_set_errno(-RT_EIO);
+            return 0;
+        }
+        for (i = 0; i < size; i++)
+        {
+            e = cache_lookup(c, pos + i);
+            if (e != RT_NULL && e->dirty)
+                rt_memcpy(ptr + i * ss, e->buf, ss);
+        }
+        c->stat.miss += size;
+        c->ra_next = pos + size;
+        c->ra_window = 0;
+        rt_mutex_release(&c->lock);
+        return size;
+    }
+
+    if (pos == c->ra_next && RT_BLK_CACHE_READ_AHEAD_SECTORS > 0)
+    {
+        if (c->ra_window == 0)
+            c->ra_window = READ_AHEAD_MIN;
+        else if (c->ra_window < RT_BLK_CACHE_READ_AHEAD_SECTORS)
+            c->ra_window *= 2;
+        if (c->ra_window > RT_BLK_CACHE_READ_AHEAD_SECTORS)
+            c->ra_window = RT_BLK_CACHE_READ_AHEAD_SECTORS;
+    }
+    else
+    {
+        c->ra_window = 0;
+    }
+    c->ra_next = pos + size;
+
+    for (i = 0; i < size; i += n)
+    {
+        e = cache_lookup(c, pos + i);
+        if (e != RT_NULL)
+        {
+            rt_memcpy(ptr + i * ss, e->buf, ss);
+            cache_touch(c, e);
+            c->stat.hit++;
+            if (e->read_ahead)
+            {
+                e->read_ahead = 0;
+                c->stat.read_ahead_hit++;
+            }
+            n = 1;
+            continue;
+        }
+
+        /* merge the misses next to each other */
+        for (n = 1; i + n < size && cache_lookup(c, pos + i + n) == RT_NULL; n++);
+        ra = (i + n == size && c->ra_window) ? cache_read_ahead(c, pos + size, n) : 0;
+
+        if (cache_fill(c, pos + i, ptr + i * ss, n, ra) != RT_EOK)
+        {
+            rt_mutex_release(&c->lock);
+            rt_set_errno(-RT_EIO);
+            return i;
+        }
+    }
+
+    rt_mutex_release(&c->lock);
+
+    return size;
+}
+
+static rt_size_t rt_blk_cache_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+    struct blk_cache_entry *e;
+    rt_uint32_t ss = c->geometry.bytes_per_sector;
+    const rt_uint8_t *ptr = (const rt_uint8_t *)buffer;
+    rt_uint32_t i;
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+
+    if (size >= c->io_sectors)
+    {
+        /* big writes go to the device directly, the cached copies are updated */
+        if (cache_dev_write(c, pos, buffer, size) != RT_EOK)
+        {
+            rt_mutex_release(&c->lock);
+            rt_set_errno(-RT_EIO);
+            return 0;
+        }
+        for (i = 0; i < size; i++)
+        {
+            e = cache_lookup(c, pos + i);
+            if (e == RT_NULL)
+                continue;
+            rt_memcpy(e->buf, ptr + i * ss, ss);
+            if (e->dirty)
+            {
+                e->dirty = 0;
+                c->stat.dirty--;
+            }
+        }
+        rt_mutex_release(&c->lock);
+        return size;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        e = cache_lookup(c, pos + i);
+        if (e == RT_NULL)
+        {
+            e = cache_alloc(c);
+            if (e == RT_NULL)
+            {
+                rt_mutex_release(&c->lock);
+                rt_set_errno(-RT_EIO);
+                return i;
+            }
+            cache_insert(c, e, pos + i);
+        }
+        else
+        {
+            cache_touch(c, e);
+            e->read_ahead = 0;
+        }
+        rt_memcpy(e->buf, ptr + i * ss, ss);
+        cache_mark_dirty(c, e);
+    }
+
+    if (c->stat.dirty > DIRTY_HIGH(c))
+        cache_flush_locked(c);
+
+    rt_mutex_release(&c->lock);
+
+    return size;
+}
+
+static rt_err_t rt_blk_cache_control(rt_device_t dev, int cmd, void *args)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+    struct blk_cache_entry *e;
+    rt_uint32_t *range;
+    rt_uint32_t i;
+    rt_err_t result;
+
+    switch (cmd)
+    {
+    case RT_DEVICE_CTRL_BLK_GETGEOME:
+        rt_memcpy(args, &c->geometry, sizeof(struct rt_device_blk_geometry));
+        return RT_EOK;
+
+    case RT_DEVICE_CTRL_BLK_SYNC:
+        /* fsync barrier: everything written before is on the device when it returns */
+        result = rt_blk_cache_flush(dev);
+        rt_device_control(c->dev, cmd, args);
+        return result;
+
+    case RT_DEVICE_CTRL_BLK_ERASE:
+        /* the erased sectors [start, end] needn't be written back */
+        range = (rt_uint32_t *)args;
+        if (range != RT_NULL)
+        {
+            rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+            for (i = 0; i < c->count; i++)
+            {
+                e = &c->entries[i];
+                if (e->valid && e->sector >= range[0] && e->sector <= range[1])
+                    cache_drop(c, e);
+            }
+            rt_mutex_release(&c->lock);
+        }
+        return rt_device_control(c->dev, cmd, args);
+
+    default:
+        return rt_device_control(c->dev, cmd, args);
+    }
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops blk_cache_ops =
+{
+    rt_blk_cache_init,
+    rt_blk_cache_open,
+    rt_blk_cache_close,
+    rt_blk_cache_read,
+    rt_blk_cache_write,
+    rt_blk_cache_control
+};
+#endif
+
+static void blk_cache_flush_entry(void *parameter)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)parameter;
+    rt_tick_t delay = rt_tick_from_millisecond(RT_BLK_CACHE_FLUSH_MS);
+    rt_tick_t elapsed;
+
+    while (1)
+    {
+        /* released when the cache becomes dirty */
+        rt_sem_take(&c->flush_sem, RT_WAITING_FOREVER);
+
+        while (1)
+        {
+            rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+            if (c->stat.dirty == 0)
+            {
+                rt_mutex_release(&c->lock);
+                break;
+            }
+            elapsed = rt_tick_get() - c->dirty_tick;
+            if (elapsed >= delay)
+            {
+                cache_flush_locked(c);
+                rt_mutex_release(&c->lock);
+                break;
+            }
+            rt_mutex_release(&c->lock);
+            rt_thread_delay(delay - elapsed);
+        }
+    }
+}
+
+static void blk_cache_free(struct rt_blk_cache *c)
+{
+    cache_mem_free(c, c->pool);
+    cache_mem_free(c, c->io_buf);
+    rt_free(c->entries);
+    rt_free(c->hash);
+    rt_free(c->sort_buf);
+    rt_free(c);
+}
+
+rt_device_t rt_blk_cache_create(const char *name, const char *parent, rt_size_t sectors)
+{
+    struct rt_blk_cache *c;
+    rt_device_t dev;
+    rt_uint32_t i, hash_size;
+
+    dev = rt_device_find(parent);
+    if (dev == RT_NULL || dev->type != RT_Device_Class_Block)
+    {
+        LOG_E("block device %s not found", parent);
+        return RT_NULL;
+    }
+    if (sectors < 4)
+        sectors = 4;
+
+    c = (struct rt_blk_cache *)rt_calloc(1, sizeof(struct rt_blk_cache));
+    if (c == RT_NULL)
+        return RT_NULL;
+
+    c->dev = dev;
+    if (rt_device_open(dev, RT_DEVICE_OFLAG_RDWR) != RT_EOK ||
+        rt_device_control(dev, RT_DEVICE_CTRL_BLK_GETGEOME, &c->geometry) != RT_EOK ||
+        c->geometry.bytes_per_sector == 0)
+    {
+        LOG_E("can't get the geometry of %s", parent);
+        rt_free(c);
+        return RT_NULL;
+    }
+
+    /* keep enough entries for the biggest cached request */
+    c->count = sectors;
+    c->io_sectors = sectors / 2 < RT_BLK_CACHE_IO_SECTORS ? sectors / 2 : RT_BLK_CACHE_IO_SECTORS;
+    for (hash_size = 1; hash_size < sectors; hash_size <<= 1);
+    c->hash_mask = hash_size - 1;
+
+    c->entries = (struct blk_cache_entry *)rt_calloc(sectors, sizeof(struct blk_cache_entry));
+    c->hash = (struct blk_cache_entry **)rt_calloc(hash_size, sizeof(struct blk_cache_entry *));
+    c->sort_buf = (struct blk_cache_entry **)rt_calloc(sectors, sizeof(struct blk_cache_entry *));
+    c->pool = (rt_uint8_t *)cache_mem_alloc(c, sectors * c->geometry.bytes_per_sector);
+    c->io_buf = (rt_uint8_t *)cache_mem_alloc(c, c->io_sectors * c->geometry.bytes_per_sector);
+    if (c->entries == RT_NULL || c->hash == RT_NULL || c->sort_buf == RT_NULL ||
+        c->pool == RT_NULL || c->io_buf == RT_NULL)
+    {
+        LOG_E("no memory for %d sectors", sectors);
+        rt_device_close(dev);
+        blk_cache_free(c);
+        return RT_NULL;
+    }
+
+    rt_list_init(&c->lru);
+    for (i = 0; i < sectors; i++)
+    {
+        c->entries[i].buf = c->pool + i * c->geometry.bytes_per_sector;
+        rt_list_insert_before(&c->lru, &c->entries[i].list);
+    }
+    c->stat.sectors = sectors;
+    c->ra_next = (rt_uint32_t)-1;
+
+    rt_mutex_init(&c->lock, name, RT_IPC_FLAG_PRIO);
+    rt_sem_init(&c->flush_sem, name, 0, RT_IPC_FLAG_FIFO);
+    c->flush_thread = rt_thread_create(name, blk_cache_flush_entry, c,
+                                       RT_BLK_CACHE_THREAD_STACK_SIZE, RT_BLK_CACHE_THREAD_PRIORITY, 10);
+    if (c->flush_thread == RT_NULL)
+    {
+        rt_sem_detach(&c->flush_sem);
+        rt_mutex_detach(&c->lock);
+        rt_device_close(dev);
+        blk_cache_free(c);
+        return RT_NULL;
+    }
+
+    c->parent.type = RT_Device_Class_Block;
+#ifdef RT_USING_DEVICE_OPS
+    c->parent.ops = &blk_cache_ops;
+#else
+    c->parent.init = rt_blk_cache_init;
+    c->parent.open = rt_blk_cache_open;
+    c->parent.close = rt_blk_cache_close;
+    c->parent.read = rt_blk_cache_read;
+    c->parent.write = rt_blk_cache_write;
+    c->parent.control = rt_blk_cache_control;
+#endif
+    c->parent.user_data = c;
+    rt_device_register(&c->parent, name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_STANDALONE);
+    rt_thread_startup(c->flush_thread);
+
+    LOG_I("%s: %d sectors cache on %s", name, sectors, parent);
+
+    return &c->parent;
+}
+
+rt_err_t rt_blk_cache_delete(rt_device_t dev)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+    rt_err_t result;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+    result = cache_flush_locked(c);
+    if (result != RT_EOK)
+    {
+        rt_mutex_release(&c->lock);
+        return result;
+    }
+    /* it doesn't hold the lock now */
+    rt_thread_delete(c->flush_thread);
+    rt_mutex_release(&c->lock);
+
+    rt_device_unregister(&c->parent);
+    rt_sem_detach(&c->flush_sem);
+    rt_mutex_detach(&c->lock);
+    rt_device_close(c->dev);
+    blk_cache_free(c);
+
+    return RT_EOK;
+}
+
+rt_err_t rt_blk_cache_flush(rt_device_t dev)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+    rt_err_t result;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+    result = cache_flush_locked(c);
+    rt_mutex_release(&c->lock);
+
+    return result;
+}
+
+rt_err_t rt_blk_cache_invalidate(rt_device_t dev)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+    rt_err_t result;
+    rt_uint32_t i;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+    result = cache_flush_locked(c);
+    if (result == RT_EOK)
+    {
+        for (i = 0; i < c->count; i++)
+            cache_drop(c, &c->entries[i]);
+        c->ra_next = (rt_uint32_t)-1;
+        c->ra_window = 0;
+    }
+    rt_mutex_release(&c->lock);
+
+    return result;
+}
+
+void rt_blk_cache_get_stat(rt_device_t dev, struct rt_blk_cache_stat *stat)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+    *stat = c->stat;
+    rt_mutex_release(&c->lock);
+}
+
+void rt_blk_cache_reset_stat(rt_device_t dev)
+{
+    struct rt_blk_cache *c = (struct rt_blk_cache *)dev;
+
+    RT_ASSERT(dev != RT_NULL);
+
+    rt_mutex_take(&c->lock, RT_WAITING_FOREVER);
+    c->stat.hit = 0;
+    c->stat.miss = 0;
+    c->stat.read_ahead = 0;
+    c->stat.read_ahead_hit = 0;
+    c->stat.write_back = 0;
+    c->stat.dev_read = 0;
+    c->stat.dev_write = 0;
+    rt_mutex_release(&c->lock);
+}
+
+#ifdef RT_USING_FINSH
+#include <stdlib.h>
+
+static void blk_cache(int argc, char **argv)
+{
+    struct rt_blk_cache_stat stat;
+    rt_device_t dev;
+
+    if (argc == 4 && rt_strcmp(argv[1], "create") == 0)
+    {
+        /* blk_cache create sd0 <sectors>: the cache is named sd0c */
+        char name[RT_NAME_MAX];
+
+        rt_snprintf(name, sizeof(name), "%.*sc", RT_NAME_MAX - 2, argv[2]);
+        if (rt_blk_cache_create(name, argv[2], atoi(argv[3])) == RT_NULL)
+            rt_kprintf("create failed\n");
+        return;
+    }
+
+    if (argc < 3)
+    {
+        rt_kprintf("Usage:\n");
+        rt_kprintf("blk_cache create <blk dev> <sectors>\n");
+        rt_kprintf("blk_cache stat|flush|reset|delete <cache dev>\n");
+        return;
+    }
+
+    dev = rt_device_find(argv[2]);
+    if (dev == RT_NULL || dev->type != RT_Device_Class_Block)
+    {
+        rt_kprintf("%s not found\n", argv[2]);
+        return;
+    }
+#ifdef RT_USING_DEVICE_OPS
+    if (dev->ops != &blk_cache_ops)
+#else
+    if (dev->read != rt_blk_cache_read)
+#endif
+    {
+        rt_kprintf("%s is not a cache device\n", argv[2]);
+        return;
+    }
+
+    if (rt_strcmp(argv[1], "stat") == 0)
+    {
+        rt_blk_cache_get_stat(dev, &stat);
+        rt_kprintf("sectors %d, dirty %d\n", stat.sectors, stat.dirty);
+        rt_kprintf("hit %d, miss %d, read ahead %d (used %d), write back %d\n",
+                   stat.hit, stat.miss, stat.read_ahead, stat.read_ahead_hit, stat.write_back);
+        rt_kprintf("device reads %d, writes %d\n", stat.dev_read, stat.dev_write);
+    }
+    else if (rt_strcmp(argv[1], "flush") == 0)
+    {
+        rt_kprintf("flush: %d\n", rt_blk_cache_flush(dev));
+    }
+    else if (rt_strcmp(argv[1], "reset") == 0)
+    {
+        rt_blk_cache_reset_stat(dev);
+    }
+    else if (rt_strcmp(argv[1], "delete") == 0)
+    {
+        rt_kprintf("delete: %d\n", rt_blk_cache_delete(dev));
+    }
+}
+MSH_CMD_EXPORT(blk_cache, block device cache: blk_cache create|stat|flush|reset|delete);
+#endif /* RT_USING_FINSH */
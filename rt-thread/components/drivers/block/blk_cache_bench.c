@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and self test of the block cache.
+ *
+ * The workloads run on a RAM block device which delays every request like a
+ * SD card: a fixed command overhead and a transfer time per sector. Each
+ * workload runs on the RAM device directly and through a cache on it, the
+ * data read back is checked against the pattern of the last write.
+ *
+ * msh: blk_cache_bench [cache sectors]
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <rthw.h>
+#include <stdlib.h>
+
+#define RAMDISK_SECTORS         2048
+#define RAMDISK_SECTOR_SIZE     512
+#define RAMDISK_REQ_US          300     /* command and busy time of a request */
+#define RAMDISK_SECTOR_US       40      /* 512 bytes at 25MHz, 4 bit */
+
+#define HOT_SECTORS             64      /* FAT and directory sectors */
+#define RANDOM_OPS              2000
+#define SEQ_CHUNK               2       /* small reads of fonts, images and logs */
+#define BIG_CHUNK               40      /* bigger than the staging buffer, bypasses the cache */
+
+struct ramdisk
+{
+    struct rt_device parent;
+    rt_uint8_t *data;
+    rt_uint32_t reads;
+    rt_uint32_t writes;
+};
+
+static struct ramdisk ramdisk;
+static rt_uint8_t *versions;            /* the version of the pattern in each sector */
+static rt_uint32_t *sector_buf;
+static rt_uint32_t seed;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static rt_err_t ramdisk_control(rt_device_t dev, int cmd, void *args)
+{
+    struct rt_device_blk_geometry *geometry;
+
+    if (cmd == RT_DEVICE_CTRL_BLK_GETGEOME)
+    {
+        geometry = (struct rt_device_blk_geometry *)args;
+        geometry->bytes_per_sector = RAMDISK_SECTOR_SIZE;
+        geometry->block_size = RAMDISK_SECTOR_SIZE;
+        geometry->sector_count = RAMDISK_SECTORS;
+    }
+    return RT_EOK;
+}
+
+static rt_size_t ramdisk_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    if (pos + size > RAMDISK_SECTORS)
+        return 0;
+    rt_hw_us_delay(RAMDISK_REQ_US + RAMDISK_SECTOR_US * size);
+    rt_memcpy(buffer, ramdisk.data + pos * RAMDISK_SECTOR_SIZE, size * RAMDISK_SECTOR_SIZE);
+    ramdisk.reads++;
+    return size;
+}
+
+static rt_size_t ramdisk_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    if (pos + size > RAMDISK_SECTORS)
+        return 0;
+    rt_hw_us_delay(RAMDISK_REQ_US + RAMDISK_SECTOR_US * size);
+    rt_memcpy(ramdisk.data + pos * RAMDISK_SECTOR_SIZE, buffer, size * RAMDISK_SECTOR_SIZE);
+    ramdisk.writes++;
+    return size;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops ramdisk_ops =
+{
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    ramdisk_read,
+    ramdisk_write,
+    ramdisk_control
+};
+#endif
+
+static void pattern_fill(rt_uint32_t *buf, rt_uint32_t sector)
+{
+    rt_uint32_t i, v = sector * 2654435761u + versions[sector];
+
+    for (i = 0; i < RAMDISK_SECTOR_SIZE / 4; i++)
+        buf[i] = v + i;
+}
+
+static rt_bool_t pattern_check(const rt_uint32_t *buf, rt_uint32_t sector)
+{
+    rt_uint32_t i, v = sector * 2654435761u + versions[sector];
+
+    for (i = 0; i < RAMDISK_SECTOR_SIZE / 4; i++)
+    {
+        if (buf[i] != v + i)
+        {
+            rt_kprintf("sector %d: wrong data\n", sector);
+            return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+static rt_bool_t bench_read(rt_device_t dev, rt_uint32_t sector, rt_uint32_t n)
+{
+    rt_uint32_t i;
+
+    if (rt_device_read(dev, sector, sector_buf, n) != n)
+        return RT_FALSE;
+    for (i = 0; i < n; i++)
+    {
+        if (!pattern_check(sector_buf + i * RAMDISK_SECTOR_SIZE / 4, sector + i))
+            return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+static rt_bool_t bench_write(rt_device_t dev, rt_uint32_t sector, rt_uint32_t n)
+{
+    rt_uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        versions[sector + i]++;
+        pattern_fill(sector_buf + i * RAMDISK_SECTOR_SIZE / 4, sector + i);
+    }
+    return rt_device_write(dev, sector, sector_buf, n) == n;
+}
+
+/* 70% reads, 30% writes of 1 or 2 sectors, mostly in the hot area, a few big ones */
+static rt_bool_t workload_random(rt_device_t dev)
+{
+    rt_uint32_t i, sector, n;
+
+    for (i = 0; i < RANDOM_OPS; i++)
+    {
+        n = bench_rand() % 64 == 0 ? BIG_CHUNK : bench_rand() % 2 + 1;
+        if (bench_rand() % 4 == 0)
+            sector = bench_rand() % (RAMDISK_SECTORS - n);
+        else
+            sector = bench_rand() % (HOT_SECTORS + BIG_CHUNK - n);
+
+        if (bench_rand() % 10 < 7)
+        {
+            if (!bench_read(dev, sector, n))
+                return RT_FALSE;
+        }
+        else
+        {
+            if (!bench_write(dev, sector, n))
+                return RT_FALSE;
+        }
+    }
+    return rt_device_control(dev, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL) == RT_EOK;
+}
+
+static rt_bool_t workload_seq_read(rt_device_t dev)
+{
+    rt_uint32_t sector;
+
+    for (sector = HOT_SECTORS; sector + SEQ_CHUNK <= RAMDISK_SECTORS; sector += SEQ_CHUNK)
+    {
+        if (!bench_read(dev, sector, SEQ_CHUNK))
+            return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+/* appending a log: one sector at a time, then fsync */
+static rt_bool_t workload_seq_write(rt_device_t dev)
+{
+    rt_uint32_t sector;
+
+    for (sector = HOT_SECTORS; sector < RAMDISK_SECTORS; sector++)
+    {
+        if (!bench_write(dev, sector, 1))
+            return RT_FALSE;
+    }
+    return rt_device_control(dev, RT_DEVICE_CTRL_BLK_SYNC, RT_NULL) == RT_EOK;
+}
+
+static void bench_run(const char *name, rt_device_t dev, rt_bool_t (*workload)(rt_device_t))
+{
+    struct rt_blk_cache_stat stat;
+    rt_bool_t cached = dev != &ramdisk.parent;
+    rt_tick_t tick;
+    rt_bool_t ok;
+
+    if (cached)
+    {
+        /* the raw runs wrote behind the cache */
+        rt_blk_cache_invalidate(dev);
+        rt_blk_cache_reset_stat(dev);
+    }
+    ramdisk.reads = 0;
+    ramdisk.writes = 0;
+    seed = 1;
+    tick = rt_tick_get();
+    ok = workload(dev);
+    tick = rt_tick_get() - tick;
+
+    rt_kprintf("%-10s %-6s %6d ms, device reads %5d, writes %5d, %s\n", name, cached ? "cached" : "raw",
+               tick * 1000 / RT_TICK_PER_SECOND, ramdisk.reads, ramdisk.writes, ok ? "PASS" : "FAIL");
+    if (cached)
+    {
+        rt_blk_cache_get_stat(dev, &stat);
+        rt_kprintf("%-17s hit %d, miss %d, read ahead %d (used %d), write back %d\n", "",
+                   stat.hit, stat.miss, stat.read_ahead, stat.read_ahead_hit, stat.write_back);
+    }
+}
+
+static int blk_cache_bench(int argc, char **argv)
+{
+    rt_device_t cache;
+    rt_size_t sectors = argc > 1 ? atoi(argv[1]) : 128;
+    rt_uint32_t sector;
+
+    if (rt_device_find("bcram") == RT_NULL)
+    {
+        ramdisk.data = (rt_uint8_t *)rt_malloc(RAMDISK_SECTORS * RAMDISK_SECTOR_SIZE);
+        if (ramdisk.data == RT_NULL)
+        {
+            rt_kprintf("no memory for the RAM disk\n");
+            return -RT_ENOMEM;
+        }
+        ramdisk.parent.type = RT_Device_Class_Block;
+#ifdef RT_USING_DEVICE_OPS
+        ramdisk.parent.ops = &ramdisk_ops;
+#else
+        ramdisk.parent.read = ramdisk_read;
+        ramdisk.parent.write = ramdisk_write;
+        ramdisk.parent.control = ramdisk_control;
+#endif
+        rt_device_register(&ramdisk.parent, "bcram", RT_DEVICE_FLAG_RDWR);
+    }
+
+    versions = (rt_uint8_t *)rt_calloc(1, RAMDISK_SECTORS);
+    sector_buf = (rt_uint32_t *)rt_malloc(BIG_CHUNK * RAMDISK_SECTOR_SIZE);
+    if (versions == RT_NULL || sector_buf == RT_NULL)
+    {
+        rt_free(versions);
+        rt_free(sector_buf);
+        return -RT_ENOMEM;
+    }
+    for (sector = 0; sector < RAMDISK_SECTORS; sector++)
+        pattern_fill((rt_uint32_t *)(ramdisk.data + sector * RAMDISK_SECTOR_SIZE), sector);
+
+    cache = rt_blk_cache_create("bcache", "bcram", sectors);
+    if (cache != RT_NULL && rt_device_open(cache, RT_DEVICE_OFLAG_RDWR) != RT_EOK)
+    {
+        rt_blk_cache_delete(cache);
+        cache = RT_NULL;
+    }
+    if (cache == RT_NULL)
+    {
+        rt_free(versions);
+        rt_free(sector_buf);
+        return -RT_ERROR;
+    }
+
+    bench_run("random", &ramdisk.parent, workload_random);
+    bench_run("random", cache, workload_random);
+    bench_run("seq read", &ramdisk.parent, workload_seq_read);
+    bench_run("seq read", cache, workload_seq_read);
+    bench_run("seq write", &ramdisk.parent, workload_seq_write);
+    bench_run("seq write", cache, workload_seq_write);
+
+    rt_device_close(cache);
+    rt_blk_cache_delete(cache);
+    rt_free(versions);
+    rt_free(sector_buf);
+    versions = RT_NULL;
+    sector_buf = RT_NULL;
+
+    return RT_EOK;
+}
+MSH_CMD_EXPORT(blk_cache_bench, block cache benchmark on a RAM disk: blk_cache_bench [cache sectors]);
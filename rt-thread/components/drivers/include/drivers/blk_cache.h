@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __BLK_CACHE_H__
+#define __BLK_CACHE_H__
+
+#include <rtthread.h>
+
+struct rt_blk_cache_stat
+{
+    rt_uint32_t hit;            /* sectors found in the cache */
+    rt_uint32_t miss;           /* sectors read from the device on request */
+    rt_uint32_t read_ahead;     /* sectors read from the device ahead of the request */
+    rt_uint32_t read_ahead_hit; /* read ahead sectors used later */
+    rt_uint32_t write_back;     /* dirty sectors written to the device */
+    rt_uint32_t dev_read;       /* read requests sent to the device */
+    rt_uint32_t dev_write;      /* write requests sent to the device */
+    rt_uint32_t dirty;          /* sectors waiting for write back */
+    rt_uint32_t sectors;        /* size of the cache in sectors */
+};
+
+/*
+ * Create a cached block device named `name` on the block device `parent`.
+ * The cache has `sectors` buffers. Mount the file system on `name` instead
+ * of `parent`, the parent must not be accessed directly any more.
+ */
+rt_device_t rt_blk_cache_create(const char *name, const char *parent, rt_size_t sectors);
+rt_err_t rt_blk_cache_delete(rt_device_t dev);
+
+/* write all dirty sectors to the device, it's done by RT_DEVICE_CTRL_BLK_SYNC (fsync) too */
+rt_err_t rt_blk_cache_flush(rt_device_t dev);
+/* drop all sectors, the dirty ones are written first */
+rt_err_t rt_blk_cache_invalidate(rt_device_t dev);
+
+void rt_blk_cache_get_stat(rt_device_t dev, struct rt_blk_cache_stat *stat);
+void rt_blk_cache_reset_stat(rt_device_t dev);
+
+#endif /* __BLK_CACHE_H__ */
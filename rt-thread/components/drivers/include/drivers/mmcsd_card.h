@@ -129,6 +129,8 @@ struct rt_sdio_function {
 
 
 
+struct rt_mmcsd_queue;
+
 struct rt_mmcsd_card {
     struct rt_mmcsd_host *host;
     rt_uint32_t rca;        /* card addr */
@@ -162,6 +164,7 @@ struct rt_mmcsd_card {
     struct rt_sdio_cis     cis;  /* common tuple info */
     struct rt_sdio_function *sdio_function[SDIO_MAX_FUNCTIONS + 1]; /* SDIO functions (devices) */
     rt_list_t blk_devices;  /* for block device list */
+    struct rt_mmcsd_queue *blk_queue;  /* block request queue, RT_MMCSD_USING_QUEUE */
 };
 
 #ifdef __cplusplus
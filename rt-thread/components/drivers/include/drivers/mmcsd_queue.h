@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __MMCSD_QUEUE_H__
+#define __MMCSD_QUEUE_H__
+
+#include <rtthread.h>
+#include <drivers/mmcsd_card.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rt_mmcsd_sg
+{
+    void        *buf;
+    rt_uint32_t  blks;
+};
+
+struct rt_mmcsd_blk_req
+{
+    rt_uint32_t  sector;                /* block address on the card */
+    rt_uint32_t  blks;                  /* sum of the blocks of the segments */
+    const struct rt_mmcsd_sg *sg;
+    rt_uint32_t  sg_cnt;
+    rt_uint8_t   dir;                   /* 0: read, 1: write */
+    rt_err_t     err;                   /* result, set before done() is called */
+
+    /* called by the queue thread when the request is finished */
+    void (*done)(struct rt_mmcsd_blk_req *req);
+    void        *user_data;
+
+    /* private */
+    rt_list_t    list;                  /* the queue, only the first request of a transfer */
+    rt_list_t    node;                  /* the requests of a transfer in sector order */
+    rt_list_t    merged;                /* head of the node list */
+    rt_uint32_t  start;                 /* range of the transfer */
+    rt_uint32_t  total;
+};
+
+struct rt_mmcsd_queue_stat
+{
+    rt_uint32_t  submitted;             /* requests */
+    rt_uint32_t  merged;                /* requests merged into another one */
+    rt_uint32_t  transfers;             /* multi or single block commands */
+    rt_uint32_t  blocks;
+    rt_uint32_t  bounced;               /* transfers through the bounce buffer */
+    rt_uint32_t  pre_erase;             /* ACMD23 sent */
+    rt_uint32_t  errors;
+};
+
+struct rt_mmcsd_queue;
+
+struct rt_mmcsd_queue *mmcsd_queue_create(struct rt_mmcsd_card *card);
+void mmcsd_queue_delete(struct rt_mmcsd_queue *q);
+
+/*
+ * Queue a request and return, `done` is called from the queue thread.
+ * Requests next to each other in the same direction are merged into one
+ * multi-block transfer. A request is never moved in front of an earlier
+ * one which overlaps it, unless both are reads.
+ */
+rt_err_t mmcsd_queue_submit(struct rt_mmcsd_queue *q, struct rt_mmcsd_blk_req *req);
+/* submit a request of one buffer and wait for it */
+rt_err_t mmcsd_queue_rw(struct rt_mmcsd_queue *q, rt_uint32_t sector, void *buf, rt_uint32_t blks, rt_uint8_t dir);
+
+void mmcsd_queue_get_stat(struct rt_mmcsd_queue *q, struct rt_mmcsd_queue_stat *stat);
+void mmcsd_queue_reset_stat(struct rt_mmcsd_queue *q);
+
+/* single transfer without the queue, block_dev.c */
+rt_err_t rt_mmcsd_req_blk(struct rt_mmcsd_card *card, rt_uint32_t sector, void *buf, rt_size_t blks, rt_uint8_t dir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MMCSD_QUEUE_H__ */
@@ -63,12 +63,15 @@
 #define RT_SERIAL_TX_NON_BLOCKING       RT_DEVICE_FLAG_TX_NON_BLOCKING
 
 #define RT_DEVICE_CHECK_OPTMODE         0x20
+#define RT_SERIAL_CTRL_GET_STAT         0x21    /* copy the counters to a struct rt_serial_stat */
+#define RT_SERIAL_CTRL_RESET_STAT       0x22
 
 #define RT_SERIAL_EVENT_RX_IND          0x01    /* Rx indication */
 #define RT_SERIAL_EVENT_TX_DONE         0x02    /* Tx complete   */
 #define RT_SERIAL_EVENT_RX_DMADONE      0x03    /* Rx DMA transfer done */
 #define RT_SERIAL_EVENT_TX_DMADONE      0x04    /* Tx DMA transfer done */
 #define RT_SERIAL_EVENT_RX_TIMEOUT      0x05    /* Rx timeout    */
+#define RT_SERIAL_EVENT_RX_ERROR        0x06    /* Rx error, RT_SERIAL_ERR_xxx << 8 */
 
 #define RT_SERIAL_ERR_OVERRUN           0x01
 #define RT_SERIAL_ERR_FRAMING           0x02
@@ -116,7 +119,8 @@ struct serial_configure
  */
 struct rt_serial_rx_fifo
 {
-    struct rt_ringbuffer rb;
+    /* the driver produces, the reader consumes */
+    struct rt_spsc_ring rb;
 
     struct rt_completion rx_cpt;
 
@@ -143,6 +147,25 @@ struct rt_serial_tx_fifo
     rt_uint8_t buffer[];
 };
 
+/*
+ * Counters of a serial device, the latency is the time from the notification
+ * of the oldest unread data to its read, in microseconds with RT_USING_CPUTIME
+ * and in ticks converted to microseconds without it.
+ */
+struct rt_serial_stat
+{
+    rt_uint32_t rx_bytes;
+    rt_uint32_t rx_dropped;             /* bytes overwritten in the RX ring before they were read */
+    rt_uint32_t rx_overruns;            /* overrun errors of the UART */
+    rt_uint32_t rx_errors;              /* framing, noise and parity errors */
+    rt_uint32_t rx_events;              /* notifications of received data */
+    rt_uint32_t rx_reads;               /* reads that returned data */
+    rt_uint32_t rx_latency_max;
+    rt_uint32_t rx_latency_sum;
+    rt_uint32_t tx_bytes;
+    rt_uint32_t tx_transfers;           /* transmit() calls, one per DMA transfer */
+};
+
 struct rt_serial_device
 {
     struct rt_device          parent;
@@ -152,6 +175,10 @@ struct rt_serial_device
 
     void *serial_rx;
     void *serial_tx;
+
+    struct rt_serial_stat     stat;
+    rt_uint32_t               rx_stamp; /* time of the notification of the oldest unread data */
+    rt_bool_t                 rx_stamped;
 };
 
 /**
@@ -177,6 +204,28 @@ struct rt_uart_ops
 
 void rt_hw_serial_isr(struct rt_serial_device *serial, int event);
 
+/*
+ * Circular RX DMA: the DMA writes into the buffer of the RX ring and the
+ * driver reports the bytes written since the last event with
+ * RT_SERIAL_EVENT_RX_DMADONE | (length << 8) on the half transfer, transfer
+ * complete and IDLE line interrupts. The ring follows the position of the
+ * DMA, when the reader is too slow the oldest data is overwritten and the
+ * reader counts it as dropped.
+ */
+rt_size_t rt_serial_dma_rx_len(rt_size_t bufsz, rt_size_t *last_index, rt_size_t counter);
+
+/* the linear block of data at the read index of the TX ring */
+rt_size_t rt_serial_get_linear_buffer(struct rt_ringbuffer *rb, rt_uint8_t **ptr);
+rt_size_t rt_serial_update_read_index(struct rt_ringbuffer *rb, rt_uint16_t read_index);
+
+/*
+ * Zero-copy read of a device opened with RT_DEVICE_FLAG_RX_NON_BLOCKING:
+ * rt_serial_rx_peek() returns the linear block of data at the read index
+ * of the RX ring, rt_serial_rx_release() frees `size` bytes of it.
+ */
+rt_size_t rt_serial_rx_peek(rt_device_t dev, rt_uint8_t **ptr);
+void rt_serial_rx_release(rt_device_t dev, rt_size_t size);
+
 rt_err_t rt_hw_serial_register(struct rt_serial_device      *serial,
                                const  char                  *name,
                                       rt_uint32_t            flag,
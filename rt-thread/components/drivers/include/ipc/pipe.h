@@ -21,8 +21,8 @@ struct rt_pipe_device
     struct rt_device parent;
     rt_bool_t is_named;
 
-    /* ring buffer in pipe device */
-    struct rt_ringbuffer *fifo;
+    /* lock-free ring buffer in pipe device */
+    struct rt_spsc_ring *fifo;
     rt_uint16_t bufsz;
 
     rt_uint8_t readers;
@@ -31,7 +31,8 @@ struct rt_pipe_device
     rt_wqueue_t reader_queue;
     rt_wqueue_t writer_queue;
 
-    struct rt_mutex lock;
+    struct rt_mutex read_lock;
+    struct rt_mutex write_lock;
 };
 typedef struct rt_pipe_device rt_pipe_t;
 
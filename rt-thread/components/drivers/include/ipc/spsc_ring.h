@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+#ifndef SPSC_RING_H__
+#define SPSC_RING_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rtthread.h>
+
+/*
+ * Lock-free ring of one producer and one consumer, e.g. an interrupt and
+ * a thread. Neither side disables interrupts: the producer only writes
+ * write_index and the consumer only writes read_index, each publishes its
+ * index with a release store after the data access and loads the other
+ * index with an acquire load.
+ *
+ * The indexes run freely over 32 bits and the size is a power of two, so
+ * write_index - read_index is the data length and index & (size - 1) the
+ * position in the buffer.
+ *
+ * rt_spsc_ring_put_force() and rt_spsc_ring_commit_write_force() let a
+ * producer that can't wait, like a circular DMA, overwrite unread data.
+ * The consumer notices it at its next access, skips to the newest
+ * buffer_size bytes and adds the skipped bytes to `dropped`. A copy
+ * racing with the overwrite can return mixed data, like the DMA itself.
+ */
+struct rt_spsc_ring
+{
+    rt_uint8_t *buffer_ptr;
+    rt_uint32_t buffer_size;            /* a power of two */
+
+    volatile rt_uint32_t write_index;   /* written by the producer */
+    volatile rt_uint32_t read_index;    /* written by the consumer */
+    rt_uint32_t dropped;                /* written by the consumer */
+};
+
+void rt_spsc_ring_init(struct rt_spsc_ring *ring, rt_uint8_t *pool, rt_uint32_t size);
+void rt_spsc_ring_reset(struct rt_spsc_ring *ring);
+
+/* producer */
+rt_size_t rt_spsc_ring_put(struct rt_spsc_ring *ring, const rt_uint8_t *ptr, rt_size_t length);
+rt_size_t rt_spsc_ring_put_force(struct rt_spsc_ring *ring, const rt_uint8_t *ptr, rt_size_t length);
+rt_size_t rt_spsc_ring_putchar(struct rt_spsc_ring *ring, rt_uint8_t ch);
+rt_size_t rt_spsc_ring_peek_write(struct rt_spsc_ring *ring, rt_uint8_t **ptr);
+void rt_spsc_ring_commit_write(struct rt_spsc_ring *ring, rt_size_t length);
+void rt_spsc_ring_commit_write_force(struct rt_spsc_ring *ring, rt_size_t length);
+rt_size_t rt_spsc_ring_space_len(struct rt_spsc_ring *ring);
+
+/* consumer */
+rt_size_t rt_spsc_ring_get(struct rt_spsc_ring *ring, rt_uint8_t *ptr, rt_size_t length);
+rt_size_t rt_spsc_ring_peek_read(struct rt_spsc_ring *ring, rt_uint8_t **ptr);
+void rt_spsc_ring_commit_read(struct rt_spsc_ring *ring, rt_size_t length);
+
+/* either side */
+rt_size_t rt_spsc_ring_data_len(struct rt_spsc_ring *ring);
+
+#ifdef RT_USING_HEAP
+struct rt_spsc_ring *rt_spsc_ring_create(rt_uint32_t size);
+void rt_spsc_ring_destroy(struct rt_spsc_ring *ring);
+#endif
+
+rt_inline rt_uint32_t rt_spsc_ring_get_size(struct rt_spsc_ring *ring)
+{
+    RT_ASSERT(ring != RT_NULL);
+    return ring->buffer_size;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -27,15 +27,46 @@ enum
     RT_WORK_TYPE_DELAYED     = 0x0001,
 };
 
+/**
+ * work priority definitions, the workers take the work of the highest priority first
+ */
+enum
+{
+    RT_WORK_PRIORITY_HIGH    = 0,
+    RT_WORK_PRIORITY_NORMAL,
+    RT_WORK_PRIORITY_LOW,
+    RT_WORK_PRIORITY_MAX,
+};
+
+/* slots of the timer wheel of the delayed work of all queues, a power of two */
+#ifndef RT_WORKQUEUE_WHEEL_SIZE
+#define RT_WORKQUEUE_WHEEL_SIZE     32
+#endif
+
+struct rt_workqueue;
+
+/* a worker thread, the other workers of the queue steal from its run lists when idle */
+struct rt_workqueue_worker
+{
+    rt_list_t      work_list[RT_WORK_PRIORITY_MAX];
+    struct rt_work *work_current; /* current work */
+
+    rt_thread_t    thread;
+    struct rt_workqueue *queue;
+};
+
 /* workqueue implementation */
 struct rt_workqueue
 {
-    rt_list_t      work_list;
-    rt_list_t      delayed_list;
-    struct rt_work *work_current; /* current work */
+    struct rt_workqueue_worker *workers;
+    rt_uint8_t     worker_num;
+    rt_uint8_t     worker_next;   /* of the work submitted while no worker is idle */
+    rt_uint16_t    sync_waiters;  /* of rt_workqueue_cancel_work_sync() */
 
     struct rt_semaphore sem;
-    rt_thread_t    work_thread;
+
+    rt_uint32_t    work_done;
+    rt_uint32_t    work_stolen;
 };
 
 struct rt_work
@@ -46,7 +77,8 @@ struct rt_work
     void *work_data;
     rt_uint16_t flags;
     rt_uint16_t type;
-    struct rt_timer timer;
+    rt_uint8_t priority;
+    rt_tick_t timeout_tick;       /* of the delayed work in the timer wheel */
     struct rt_workqueue *workqueue;
 };
 
@@ -55,7 +87,10 @@ struct rt_work
  * WorkQueue for DeviceDriver
  */
 void rt_work_init(struct rt_work *work, void (*work_func)(struct rt_work *work, void *work_data), void *work_data);
+void rt_work_set_priority(struct rt_work *work, rt_uint8_t priority);
 struct rt_workqueue *rt_workqueue_create(const char *name, rt_uint16_t stack_size, rt_uint8_t priority);
+struct rt_workqueue *rt_workqueue_create_workers(const char *name, rt_uint16_t stack_size, rt_uint8_t priority,
+                                                 rt_uint8_t worker_num);
 rt_err_t rt_workqueue_destroy(struct rt_workqueue *queue);
 rt_err_t rt_workqueue_dowork(struct rt_workqueue *queue, struct rt_work *work);
 rt_err_t rt_workqueue_submit_work(struct rt_workqueue *queue, struct rt_work *work, rt_tick_t ticks);
@@ -15,6 +15,7 @@
 #include <rtthread.h>
 
 #include "ipc/ringbuffer.h"
+#include "ipc/spsc_ring.h"
 #include "ipc/completion.h"
 #include "ipc/dataqueue.h"
 #include "ipc/workqueue.h"
@@ -82,8 +83,15 @@ extern "C" {
 #include "drivers/mmcsd_core.h"
 #include "drivers/sd.h"
 #include "drivers/sdio.h"
+#ifdef RT_MMCSD_USING_QUEUE
+#include "drivers/mmcsd_queue.h"
+#endif /* RT_MMCSD_USING_QUEUE */
 #endif /* RT_USING_SDIO */
 
+#ifdef RT_USING_BLK_CACHE
+#include "drivers/blk_cache.h"
+#endif /* RT_USING_BLK_CACHE */
+
 
 #ifdef RT_USING_WDT
 #include "drivers/watchdog.h"
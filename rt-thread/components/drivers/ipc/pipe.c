@@ -13,6 +13,23 @@
 #include <stdint.h>
 #include <sys/errno.h>
 
+/*
+ * The fifo is a lock-free ring of one producer and one consumer: the
+ * writers take write_lock and the readers read_lock, so a reader and a
+ * writer don't wait for each other. Opening and closing take both.
+ */
+static void pipe_lock(rt_pipe_t *pipe)
+{
+    rt_mutex_take(&(pipe->write_lock), RT_WAITING_FOREVER);
+    rt_mutex_take(&(pipe->read_lock), RT_WAITING_FOREVER);
+}
+
+static void pipe_unlock(rt_pipe_t *pipe)
+{
+    rt_mutex_release(&(pipe->read_lock));
+    rt_mutex_release(&(pipe->write_lock));
+}
+
 #if defined(RT_USING_POSIX_DEVIO) && defined(RT_USING_POSIX_PIPE)
 #include <unistd.h>
 #include <fcntl.h>
@@ -40,11 +57,11 @@ static int pipe_fops_open(struct dfs_fd *fd)
     if (!pipe) return -1;
 
     device = &(pipe->parent);
-    rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+    pipe_lock(pipe);
 
     if (device->ref_count == 0)
     {
-        pipe->fifo = rt_ringbuffer_create(pipe->bufsz);
+        pipe->fifo = rt_spsc_ring_create(pipe->bufsz);
         if (pipe->fifo == RT_NULL)
         {
             rc = -RT_ENOMEM;
@@ -68,7 +85,7 @@ static int pipe_fops_open(struct dfs_fd *fd)
     device->ref_count ++;
 
 __exit:
-    rt_mutex_release(&(pipe->lock));
+    pipe_unlock(pipe);
 
     return rc;
 }
@@ -91,7 +108,7 @@ static int pipe_fops_close(struct dfs_fd *fd)
     if (!pipe) return -1;
 
     device = &(pipe->parent);
-    rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+    pipe_lock(pipe);
 
     switch (fd->flags & O_ACCMODE)
     {
@@ -120,12 +137,12 @@ static int pipe_fops_close(struct dfs_fd *fd)
     if (device->ref_count == 1)
     {
         if (pipe->fifo != RT_NULL)
-            rt_ringbuffer_destroy(pipe->fifo);
+            rt_spsc_ring_destroy(pipe->fifo);
         pipe->fifo = RT_NULL;
     }
     device->ref_count --;
 
-    rt_mutex_release(&(pipe->lock));
+    pipe_unlock(pipe);
 
     if (device->ref_count == 0 && pipe->is_named == RT_FALSE)
     {
@@ -163,10 +180,10 @@ static int pipe_fops_ioctl(struct dfs_fd *fd, int cmd, void *args)
     switch (cmd)
     {
         case FIONREAD:
-            *((int*)args) = rt_ringbuffer_data_len(pipe->fifo);
+            *((int*)args) = rt_spsc_ring_data_len(pipe->fifo);
             break;
         case FIONWRITE:
-            *((int*)args) = rt_ringbuffer_space_len(pipe->fifo);
+            *((int*)args) = rt_spsc_ring_space_len(pipe->fifo);
             break;
         default:
             ret = -EINVAL;
@@ -200,7 +217,7 @@ static int pipe_fops_read(struct dfs_fd *fd, void *buf, size_t count)
     if (pipe->writers == 0)
         return 0;
 
-    rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+    rt_mutex_take(&(pipe->read_lock), RT_WAITING_FOREVER);
 
     while (1)
     {
@@ -209,7 +226,7 @@ static int pipe_fops_read(struct dfs_fd *fd, void *buf, size_t count)
             goto out;
         }
 
-        len = rt_ringbuffer_get(pipe->fifo, buf, count);
+        len = rt_spsc_ring_get(pipe->fifo, buf, count);
 
         if (len > 0)
         {
@@ -223,10 +240,10 @@ static int pipe_fops_read(struct dfs_fd *fd, void *buf, size_t count)
                 goto out;
             }
 
-            rt_mutex_release(&pipe->lock);
+            rt_mutex_release(&pipe->read_lock);
             rt_wqueue_wakeup(&(pipe->writer_queue), (void*)POLLOUT);
             rt_wqueue_wait(&(pipe->reader_queue), 0, -1);
-            rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+            rt_mutex_take(&(pipe->read_lock), RT_WAITING_FOREVER);
         }
     }
 
@@ -234,7 +251,7 @@ static int pipe_fops_read(struct dfs_fd *fd, void *buf, size_t count)
     rt_wqueue_wakeup(&(pipe->writer_queue), (void*)POLLOUT);
 
 out:
-    rt_mutex_release(&pipe->lock);
+    rt_mutex_release(&pipe->read_lock);
     return len;
 }
 
@@ -271,7 +288,7 @@ static int pipe_fops_write(struct dfs_fd *fd, const void *buf, size_t count)
         return 0;
 
     pbuf = (uint8_t*)buf;
-    rt_mutex_take(&pipe->lock, -1);
+    rt_mutex_take(&pipe->write_lock, -1);
 
     while (1)
     {
@@ -282,7 +299,7 @@ static int pipe_fops_write(struct dfs_fd *fd, const void *buf, size_t count)
             break;
         }
 
-        len = rt_ringbuffer_put(pipe->fifo, pbuf, count - ret);
+        len = rt_spsc_ring_put(pipe->fifo, pbuf, count - ret);
         ret +=  len;
         pbuf += len;
         wakeup = 1;
@@ -304,13 +321,13 @@ static int pipe_fops_write(struct dfs_fd *fd, const void *buf, size_t count)
             }
         }
 
-        rt_mutex_release(&pipe->lock);
+        rt_mutex_release(&pipe->write_lock);
         rt_wqueue_wakeup(&(pipe->reader_queue), (void*)POLLIN);
         /* pipe full, waiting on suspended write list */
         rt_wqueue_wait(&(pipe->writer_queue), 0, -1);
-        rt_mutex_take(&pipe->lock, -1);
+        rt_mutex_take(&pipe->write_lock, -1);
     }
-    rt_mutex_release(&pipe->lock);
+    rt_mutex_release(&pipe->write_lock);
 
     if (wakeup)
     {
@@ -359,7 +376,7 @@ static int pipe_fops_poll(struct dfs_fd *fd, rt_pollreq_t *req)
 
     if (mode & 1)
     {
-        if (rt_ringbuffer_data_len(pipe->fifo) != 0)
+        if (rt_spsc_ring_data_len(pipe->fifo) != 0)
         {
             mask |= POLLIN;
         }
@@ -371,7 +388,7 @@ static int pipe_fops_poll(struct dfs_fd *fd, rt_pollreq_t *req)
 
     if (mode & 2)
     {
-        if (rt_ringbuffer_space_len(pipe->fifo) != 0)
+        if (rt_spsc_ring_space_len(pipe->fifo) != 0)
         {
             mask |= POLLOUT;
         }
@@ -421,18 +438,18 @@ static rt_err_t rt_pipe_open(rt_device_t device, rt_uint16_t oflag)
         goto __exit;
     }
 
-    rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+    pipe_lock(pipe);
 
     if (pipe->fifo == RT_NULL)
     {
-        pipe->fifo = rt_ringbuffer_create(pipe->bufsz);
+        pipe->fifo = rt_spsc_ring_create(pipe->bufsz);
         if (pipe->fifo == RT_NULL)
         {
             ret = -RT_ENOMEM;
         }
     }
 
-    rt_mutex_release(&(pipe->lock));
+    pipe_unlock(pipe);
 
 __exit:
     return ret;
@@ -452,15 +469,15 @@ static rt_err_t rt_pipe_close(rt_device_t device)
     rt_pipe_t *pipe = (rt_pipe_t *)device;
 
     if (device == RT_NULL) return -RT_EINVAL;
-    rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+    pipe_lock(pipe);
 
     if (device->ref_count == 1)
     {
-        rt_ringbuffer_destroy(pipe->fifo);
+        rt_spsc_ring_destroy(pipe->fifo);
         pipe->fifo = RT_NULL;
     }
 
-    rt_mutex_release(&(pipe->lock));
+    pipe_unlock(pipe);
 
     return RT_EOK;
 }
@@ -493,16 +510,16 @@ static rt_size_t rt_pipe_read(rt_device_t device, rt_off_t pos, void *buffer, rt
     if (count == 0) return 0;
 
     pbuf = (uint8_t*)buffer;
-    rt_mutex_take(&(pipe->lock), RT_WAITING_FOREVER);
+    rt_mutex_take(&(pipe->read_lock), RT_WAITING_FOREVER);
 
     while (read_bytes < count)
     {
-        int len = rt_ringbuffer_get(pipe->fifo, &pbuf[read_bytes], count - read_bytes);
+        int len = rt_spsc_ring_get(pipe->fifo, &pbuf[read_bytes], count - read_bytes);
         if (len <= 0) break;
 
         read_bytes += len;
     }
-    rt_mutex_release(&pipe->lock);
+    rt_mutex_release(&pipe->read_lock);
 
     return read_bytes;
 }
@@ -535,16 +552,16 @@ static rt_size_t rt_pipe_write(rt_device_t device, rt_off_t pos, const void *buf
     if (count == 0) return 0;
 
     pbuf = (uint8_t*)buffer;
-    rt_mutex_take(&pipe->lock, -1);
+    rt_mutex_take(&pipe->write_lock, -1);
 
     while (write_bytes < count)
     {
-        int len = rt_ringbuffer_put(pipe->fifo, &pbuf[write_bytes], count - write_bytes);
+        int len = rt_spsc_ring_put(pipe->fifo, &pbuf[write_bytes], count - write_bytes);
         if (len <= 0) break;
 
         write_bytes += len;
     }
-    rt_mutex_release(&pipe->lock);
+    rt_mutex_release(&pipe->write_lock);
 
     return write_bytes;
 }
@@ -599,7 +616,8 @@ rt_pipe_t *rt_pipe_create(const char *name, int bufsz)
 
     rt_memset(pipe, 0, sizeof(rt_pipe_t));
     pipe->is_named = RT_TRUE; /* initialize as a named pipe */
-    rt_mutex_init(&(pipe->lock), name, RT_IPC_FLAG_PRIO);
+    rt_mutex_init(&(pipe->read_lock), name, RT_IPC_FLAG_PRIO);
+    rt_mutex_init(&(pipe->write_lock), name, RT_IPC_FLAG_PRIO);
     rt_wqueue_init(&(pipe->reader_queue));
     rt_wqueue_init(&(pipe->writer_queue));
 
@@ -664,13 +682,14 @@ int rt_pipe_delete(const char *name)
 
             pipe = (rt_pipe_t *)device;
 
-            rt_mutex_detach(&(pipe->lock));
+            rt_mutex_detach(&(pipe->read_lock));
+            rt_mutex_detach(&(pipe->write_lock));
             rt_device_unregister(device);
 
             /* close fifo ringbuffer */
             if (pipe->fifo)
             {
-                rt_ringbuffer_destroy(pipe->fifo);
+                rt_spsc_ring_destroy(pipe->fifo);
                 pipe->fifo = RT_NULL;
             }
             rt_free(pipe);
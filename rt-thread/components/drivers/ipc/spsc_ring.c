@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <string.h>
+
+#if defined(__GNUC__)
+/* a DMB on Cortex-M */
+#define SPSC_LOAD_ACQUIRE(p)        __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(p, v)    __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+/* without the GNU atomics the calls keep the order of the accesses, enough on a single core */
+static rt_uint32_t spsc_load_acquire(volatile rt_uint32_t *p)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t value = *p;
+
+    rt_hw_interrupt_enable(level);
+    return value;
+}
+
+static void spsc_store_release(volatile rt_uint32_t *p, rt_uint32_t value)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    *p = value;
+    rt_hw_interrupt_enable(level);
+}
+
+#define SPSC_LOAD_ACQUIRE(p)        spsc_load_acquire(p)
+#define SPSC_STORE_RELEASE(p, v)    spsc_store_release(p, v)
+#endif
+
+/* the read index of the consumer, past the data overwritten by the producer */
+static rt_uint32_t spsc_read_index(struct rt_spsc_ring *ring, rt_uint32_t write_index)
+{
+    rt_uint32_t read_index = ring->read_index;
+
+    if (write_index - read_index > ring->buffer_size)
+    {
+        ring->dropped += write_index - read_index - ring->buffer_size;
+        read_index = write_index - ring->buffer_size;
+        SPSC_STORE_RELEASE(&ring->read_index, read_index);
+    }
+
+    return read_index;
+}
+
+/* the free space seen by the producer, none while the consumer hasn't skipped overwritten data */
+static rt_uint32_t spsc_space(struct rt_spsc_ring *ring, rt_uint32_t write_index)
+{
+    rt_uint32_t used = write_index - SPSC_LOAD_ACQUIRE(&ring->read_index);
+
+    return used >= ring->buffer_size ? 0 : ring->buffer_size - used;
+}
+
+/**
+ * @brief Initialize the ring object.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param pool      A pointer to the buffer.
+ * @param size      The size of the buffer in bytes, rounded down to a power of two.
+ */
+void rt_spsc_ring_init(struct rt_spsc_ring *ring, rt_uint8_t *pool, rt_uint32_t size)
+{
+    RT_ASSERT(ring != RT_NULL);
+    RT_ASSERT(size > 0);
+
+    /* keep the highest bit */
+    while (size & (size - 1))
+        size &= size - 1;
+
+    ring->buffer_ptr = pool;
+    ring->buffer_size = size;
+    ring->write_index = 0;
+    ring->read_index = 0;
+    ring->dropped = 0;
+}
+RTM_EXPORT(rt_spsc_ring_init);
+
+/**
+ * @brief Empty the ring, neither the producer nor the consumer may use it meanwhile.
+ *
+ * @param ring      A pointer to the ring object.
+ */
+void rt_spsc_ring_reset(struct rt_spsc_ring *ring)
+{
+    RT_ASSERT(ring != RT_NULL);
+
+    ring->write_index = 0;
+    ring->read_index = 0;
+    ring->dropped = 0;
+}
+RTM_EXPORT(rt_spsc_ring_reset);
+
+/**
+ * @brief Put a block of data into the ring, the data that doesn't fit is discarded. Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param ptr       A pointer to the data.
+ * @param length    The size of the data in bytes.
+ *
+ * @return Return the bytes put into the ring.
+ */
+rt_size_t rt_spsc_ring_put(struct rt_spsc_ring *ring, const rt_uint8_t *ptr, rt_size_t length)
+{
+    rt_uint32_t write_index, space, offset, first;
+
+    RT_ASSERT(ring != RT_NULL);
+
+    /* RT_MIN() evaluates twice, the consumer may free space in between */
+    write_index = ring->write_index;
+    space = spsc_space(ring, write_index);
+    length = RT_MIN(length, space);
+    if (length == 0)
+        return 0;
+
+    offset = write_index & (ring->buffer_size - 1);
+    first = RT_MIN(length, ring->buffer_size - offset);
+    memcpy(&ring->buffer_ptr[offset], ptr, first);
+    memcpy(&ring->buffer_ptr[0], &ptr[first], length - first);
+
+    SPSC_STORE_RELEASE(&ring->write_index, write_index + length);
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ring_put);
+
+/**
+ * @brief Put a block of data into the ring, overwriting the oldest data when it doesn't fit.
+ *        The consumer skips the overwritten data and counts it in `dropped`. Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param ptr       A pointer to the data.
+ * @param length    The size of the data in bytes, only the last buffer_size bytes are kept.
+ *
+ * @return Return the bytes put into the ring.
+ */
+rt_size_t rt_spsc_ring_put_force(struct rt_spsc_ring *ring, const rt_uint8_t *ptr, rt_size_t length)
+{
+    rt_uint32_t write_index, offset, first;
+
+    RT_ASSERT(ring != RT_NULL);
+
+    if (length > ring->buffer_size)
+    {
+        ptr = &ptr[length - ring->buffer_size];
+        length = ring->buffer_size;
+    }
+
+    write_index = ring->write_index;
+    offset = write_index & (ring->buffer_size - 1);
+    first = RT_MIN(length, ring->buffer_size - offset);
+    memcpy(&ring->buffer_ptr[offset], ptr, first);
+    memcpy(&ring->buffer_ptr[0], &ptr[first], length - first);
+
+    SPSC_STORE_RELEASE(&ring->write_index, write_index + length);
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ring_put_force);
+
+/**
+ * @brief Put a byte into the ring. Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param ch        The byte.
+ *
+ * @return Return 1, or 0 when the ring is full.
+ */
+rt_size_t rt_spsc_ring_putchar(struct rt_spsc_ring *ring, rt_uint8_t ch)
+{
+    rt_uint32_t write_index;
+
+    RT_ASSERT(ring != RT_NULL);
+
+    write_index = ring->write_index;
+    if (spsc_space(ring, write_index) == 0)
+        return 0;
+
+    ring->buffer_ptr[write_index & (ring->buffer_size - 1)] = ch;
+    SPSC_STORE_RELEASE(&ring->write_index, write_index + 1);
+
+    return 1;
+}
+RTM_EXPORT(rt_spsc_ring_putchar);
+
+/**
+ * @brief Get the contiguous free space at the write index, to be filled in place,
+ *        e.g. by a DMA, and published with rt_spsc_ring_commit_write(). Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param ptr       When this function returns, *ptr points to the free space.
+ *
+ * @return Return the size of the contiguous free space.
+ */
+rt_size_t rt_spsc_ring_peek_write(struct rt_spsc_ring *ring, rt_uint8_t **ptr)
+{
+    rt_uint32_t write_index, space, offset;
+
+    RT_ASSERT(ring != RT_NULL && ptr != RT_NULL);
+
+    write_index = ring->write_index;
+    space = spsc_space(ring, write_index);
+    offset = write_index & (ring->buffer_size - 1);
+    *ptr = &ring->buffer_ptr[offset];
+
+    return RT_MIN(space, ring->buffer_size - offset);
+}
+RTM_EXPORT(rt_spsc_ring_peek_write);
+
+/**
+ * @brief Publish the data written in place after rt_spsc_ring_peek_write(). Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param length    The bytes written, at most the free space.
+ */
+void rt_spsc_ring_commit_write(struct rt_spsc_ring *ring, rt_size_t length)
+{
+    RT_ASSERT(ring != RT_NULL);
+    RT_ASSERT(length <= spsc_space(ring, ring->write_index));
+
+    SPSC_STORE_RELEASE(&ring->write_index, ring->write_index + length);
+}
+RTM_EXPORT(rt_spsc_ring_commit_write);
+
+/**
+ * @brief Publish data written in place beyond the free space, e.g. by a circular DMA.
+ *        The consumer skips the overwritten data and counts it in `dropped`. Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param length    The bytes written.
+ */
+void rt_spsc_ring_commit_write_force(struct rt_spsc_ring *ring, rt_size_t length)
+{
+    RT_ASSERT(ring != RT_NULL);
+
+    SPSC_STORE_RELEASE(&ring->write_index, ring->write_index + length);
+}
+RTM_EXPORT(rt_spsc_ring_commit_write_force);
+
+/**
+ * @brief Get the free space of the ring. Producer only.
+ *
+ * @param ring      A pointer to the ring object.
+ *
+ * @return Return the free space in bytes.
+ */
+rt_size_t rt_spsc_ring_space_len(struct rt_spsc_ring *ring)
+{
+    RT_ASSERT(ring != RT_NULL);
+
+    return spsc_space(ring, ring->write_index);
+}
+RTM_EXPORT(rt_spsc_ring_space_len);
+
+/**
+ * @brief Get data from the ring. Consumer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param ptr       A pointer to the buffer of the data.
+ * @param length    The size of the buffer in bytes.
+ *
+ * @return Return the bytes copied.
+ */
+rt_size_t rt_spsc_ring_get(struct rt_spsc_ring *ring, rt_uint8_t *ptr, rt_size_t length)
+{
+    rt_uint32_t write_index, read_index, offset, first;
+
+    RT_ASSERT(ring != RT_NULL);
+
+    write_index = SPSC_LOAD_ACQUIRE(&ring->write_index);
+    read_index = spsc_read_index(ring, write_index);
+    length = RT_MIN(length, write_index - read_index);
+    if (length == 0)
+        return 0;
+
+    offset = read_index & (ring->buffer_size - 1);
+    first = RT_MIN(length, ring->buffer_size - offset);
+    memcpy(ptr, &ring->buffer_ptr[offset], first);
+    memcpy(&ptr[first], &ring->buffer_ptr[0], length - first);
+
+    SPSC_STORE_RELEASE(&ring->read_index, read_index + length);
+
+    return length;
+}
+RTM_EXPORT(rt_spsc_ring_get);
+
+/**
+ * @brief Get the contiguous data at the read index, to be read in place and
+ *        released with rt_spsc_ring_commit_read(). Consumer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param ptr       When this function returns, *ptr points to the data.
+ *
+ * @return Return the size of the contiguous data.
+ */
+rt_size_t rt_spsc_ring_peek_read(struct rt_spsc_ring *ring, rt_uint8_t **ptr)
+{
+    rt_uint32_t write_index, read_index, offset;
+
+    RT_ASSERT(ring != RT_NULL && ptr != RT_NULL);
+
+    write_index = SPSC_LOAD_ACQUIRE(&ring->write_index);
+    read_index = spsc_read_index(ring, write_index);
+    offset = read_index & (ring->buffer_size - 1);
+    *ptr = &ring->buffer_ptr[offset];
+
+    return RT_MIN(write_index - read_index, ring->buffer_size - offset);
+}
+RTM_EXPORT(rt_spsc_ring_peek_read);
+
+/**
+ * @brief Release the data read in place after rt_spsc_ring_peek_read(). Consumer only.
+ *
+ * @param ring      A pointer to the ring object.
+ * @param length    The bytes read, at most the size returned by rt_spsc_ring_peek_read().
+ */
+void rt_spsc_ring_commit_read(struct rt_spsc_ring *ring, rt_size_t length)
+{
+    RT_ASSERT(ring != RT_NULL);
+
+    SPSC_STORE_RELEASE(&ring->read_index, ring->read_index + length);
+}
+RTM_EXPORT(rt_spsc_ring_commit_read);
+
+/**
+ * @brief Get the data length of the ring, at most its size after an overwrite.
+ *
+ * @param ring      A pointer to the ring object.
+ *
+ * @return Return the data length in bytes.
+ */
+rt_size_t rt_spsc_ring_data_len(struct rt_spsc_ring *ring)
+{
+    rt_uint32_t read_index, length;
+
+    RT_ASSERT(ring != RT_NULL);
+
+    /* the read index first, the write index can't be behind it then */
+    read_index = SPSC_LOAD_ACQUIRE(&ring->read_index);
+    length = SPSC_LOAD_ACQUIRE(&ring->write_index) - read_index;
+
+    return RT_MIN(length, ring->buffer_size);
+}
+RTM_EXPORT(rt_spsc_ring_data_len);
+
+#ifdef RT_USING_HEAP
+
+/**
+ * @brief Create a ring object.
+ *
+ * @param size      The size of the buffer in bytes, rounded up to a power of two.
+ *
+ * @return Return a pointer to the ring object, RT_NULL when there is no memory.
+ */
+struct rt_spsc_ring *rt_spsc_ring_create(rt_uint32_t size)
+{
+    struct rt_spsc_ring *ring;
+    rt_uint8_t *pool;
+    rt_uint32_t bufsz = 1;
+
+    RT_ASSERT(size > 0);
+
+    while (bufsz < size)
+        bufsz <<= 1;
+
+    ring = (struct rt_spsc_ring *)rt_malloc(sizeof(struct rt_spsc_ring));
+    if (ring == RT_NULL)
+        goto exit;
+
+    pool = (rt_uint8_t *)rt_malloc(bufsz);
+    if (pool == RT_NULL)
+    {
+        rt_free(ring);
+        ring = RT_NULL;
+        goto exit;
+    }
+    rt_spsc_ring_init(ring, pool, bufsz);
+
+exit:
+    return ring;
+}
+RTM_EXPORT(rt_spsc_ring_create);
+
+/**
+ * @brief Destroy a ring object created by rt_spsc_ring_create().
+ *
+ * @param ring      A pointer to the ring object.
+ */
+void rt_spsc_ring_destroy(struct rt_spsc_ring *ring)
+{
+    RT_ASSERT(ring != RT_NULL);
+
+    rt_free(ring->buffer_ptr);
+    rt_free(ring);
+}
+RTM_EXPORT(rt_spsc_ring_destroy);
+
+#endif
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Stress test and benchmark of the lock-free SPSC ring.
+ *
+ * A producer puts numbered bytes into a small ring with rt_spsc_ring_put(),
+ * rt_spsc_ring_putchar() and rt_spsc_ring_peek_write() in turn, first from
+ * a hard timer, i.e. an interrupt, then from a thread of the priority of
+ * the consumer that preempts it at each tick. The consumer checks the
+ * sequence read with rt_spsc_ring_get() and rt_spsc_ring_peek_read() in
+ * turn. Then the overwrite of a full ring and the count of the dropped
+ * bytes are checked. Last the time per KB of a put and a get with
+ * rt_ringbuffer under the interrupt lock and with the SPSC ring are printed
+ * for blocks of 1, 16 and 256 bytes.
+ *
+ * msh: spsc_ring_bench [KB]
+ */
+
+#include <rtthread.h>
+
+#ifdef RT_SPSC_RING_USING_BENCH
+
+#include <stdlib.h>
+#include <rthw.h>
+#include <rtdevice.h>
+
+#define BENCH_RING_SIZE     256
+#define BENCH_STREAM_BYTES  (32 * 1024)
+#define BENCH_CHUNK_MAX     100
+#define BENCH_CHUNKS_PER_TICK 4
+#define BENCH_KBYTES        256
+#define BENCH_STACK_SIZE    2048
+#define BENCH_TIMEOUT       (RT_TICK_PER_SECOND * 10)
+
+struct bench_stream
+{
+    struct rt_spsc_ring ring;
+    rt_uint8_t pool[BENCH_RING_SIZE];
+    rt_uint32_t total;
+
+    /* producer */
+    rt_uint32_t put_seq;                /* of the next byte to put */
+    rt_uint32_t put_count;              /* of the chunks, picks the length and the way */
+    struct rt_completion put_exit;
+
+    /* consumer */
+    rt_uint32_t get_seq;                /* of the next byte to get */
+    rt_uint32_t get_count;
+    rt_bool_t error;
+};
+
+static struct bench_stream stream;
+
+static rt_uint8_t bench_byte(rt_uint32_t seq)
+{
+    return (rt_uint8_t)(seq ^ (seq >> 8) ^ (seq >> 16));
+}
+
+static rt_bool_t bench_check(const char *name, rt_bool_t ok)
+{
+    rt_kprintf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* put a chunk of the sequence, as much of it as fits */
+static void stream_produce(void)
+{
+    rt_uint8_t buf[BENCH_CHUNK_MAX];
+    rt_uint8_t *ptr;
+    rt_size_t len, i;
+
+    len = (stream.put_count * 37) % BENCH_CHUNK_MAX + 1;
+    len = RT_MIN(len, stream.total - stream.put_seq);
+
+    switch (stream.put_count++ % 3)
+    {
+    case 0:
+        for (i = 0; i < len; i++)
+            buf[i] = bench_byte(stream.put_seq + i);
+        stream.put_seq += rt_spsc_ring_put(&stream.ring, buf, len);
+        break;
+    case 1:
+        for (i = 0; i < len; i++)
+        {
+            if (rt_spsc_ring_putchar(&stream.ring, bench_byte(stream.put_seq)) == 0)
+                break;
+            stream.put_seq ++;
+        }
+        break;
+    default:
+        i = rt_spsc_ring_peek_write(&stream.ring, &ptr);
+        len = RT_MIN(len, i);
+        for (i = 0; i < len; i++)
+            ptr[i] = bench_byte(stream.put_seq + i);
+        rt_spsc_ring_commit_write(&stream.ring, len);
+        stream.put_seq += len;
+        break;
+    }
+}
+
+/* get a chunk and check it against the sequence */
+static rt_size_t stream_consume(void)
+{
+    rt_uint8_t buf[BENCH_CHUNK_MAX];
+    rt_uint8_t *ptr;
+    rt_size_t len, i;
+    rt_bool_t zero_copy;
+
+    zero_copy = (stream.get_count++ & 1) != 0;
+    if (zero_copy)
+    {
+        len = rt_spsc_ring_peek_read(&stream.ring, &ptr);
+    }
+    else
+    {
+        len = rt_spsc_ring_get(&stream.ring, buf, (stream.get_count * 13) % BENCH_CHUNK_MAX + 1);
+        ptr = buf;
+    }
+
+    for (i = 0; i < len; i++)
+    {
+        if (ptr[i] != bench_byte(stream.get_seq + i))
+            stream.error = RT_TRUE;
+    }
+    if (zero_copy)
+        rt_spsc_ring_commit_read(&stream.ring, len);
+    stream.get_seq += len;
+
+    if (rt_spsc_ring_data_len(&stream.ring) > BENCH_RING_SIZE)
+        stream.error = RT_TRUE;
+
+    return len;
+}
+
+static void stream_start(void)
+{
+    rt_spsc_ring_init(&stream.ring, stream.pool, sizeof(stream.pool));
+    stream.total = BENCH_STREAM_BYTES;
+    stream.put_seq = 0;
+    stream.put_count = 0;
+    stream.get_seq = 0;
+    stream.get_count = 0;
+    stream.error = RT_FALSE;
+}
+
+/* the consumer spins, the producer interrupts or preempts it in its copies */
+static rt_bool_t stream_consume_all(const char *name)
+{
+    rt_tick_t start = rt_tick_get();
+
+    while (stream.get_seq < stream.total && !stream.error)
+    {
+        if (stream_consume() == 0 && rt_tick_get() - start > BENCH_TIMEOUT)
+            break;
+    }
+
+    return bench_check(name, !stream.error && stream.get_seq == stream.total &&
+                       stream.ring.dropped == 0);
+}
+
+static void stream_timeout(void *parameter)
+{
+    int i;
+
+    for (i = 0; i < BENCH_CHUNKS_PER_TICK && stream.put_seq < stream.total; i++)
+        stream_produce();
+}
+
+/* the producer is an interrupt */
+static rt_bool_t bench_stream_isr(void)
+{
+    struct rt_timer timer;
+    rt_bool_t ok;
+
+    stream_start();
+    rt_timer_init(&timer, "spsctm", stream_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_start(&timer);
+
+    ok = stream_consume_all("interrupt to thread");
+
+    rt_timer_stop(&timer);
+    rt_timer_detach(&timer);
+
+    return ok;
+}
+
+static void stream_producer_entry(void *parameter)
+{
+    rt_tick_t start = rt_tick_get();
+
+    while (stream.put_seq < stream.total && rt_tick_get() - start <= BENCH_TIMEOUT)
+        stream_produce();
+
+    rt_completion_done(&stream.put_exit);
+}
+
+/* the producer is a thread of the same priority, the time slices end in the copies */
+static rt_bool_t bench_stream_thread(void)
+{
+    rt_thread_t thread;
+    rt_bool_t ok;
+
+    stream_start();
+    rt_completion_init(&stream.put_exit);
+    thread = rt_thread_create("spscput", stream_producer_entry, RT_NULL, BENCH_STACK_SIZE,
+                              rt_thread_self()->current_priority, 1);
+    if (thread == RT_NULL)
+    {
+        return bench_check("thread to thread", RT_FALSE);
+    }
+    rt_thread_startup(thread);
+
+    ok = stream_consume_all("thread to thread");
+    rt_completion_wait(&stream.put_exit, RT_WAITING_FOREVER);
+
+    return ok;
+}
+
+/* a full ring overwritten by the producer keeps the newest data */
+static rt_bool_t bench_overwrite(void)
+{
+    struct rt_spsc_ring ring;
+    rt_uint8_t pool[64], buf[100];
+    rt_uint32_t seq = 0, total = 3 * sizeof(pool) + 17, i;
+    rt_bool_t ok = RT_TRUE;
+    rt_size_t len;
+
+    rt_spsc_ring_init(&ring, pool, sizeof(pool));
+
+    /* in place like a circular DMA, then with copies */
+    while (seq < total / 2)
+    {
+        pool[seq & (sizeof(pool) - 1)] = bench_byte(seq);
+        seq ++;
+        rt_spsc_ring_commit_write_force(&ring, 1);
+    }
+    while (seq < total)
+    {
+        len = RT_MIN(10, total - seq);
+        for (i = 0; i < len; i++)
+            buf[i] = bench_byte(seq + i);
+        seq += rt_spsc_ring_put_force(&ring, buf, len);
+    }
+
+    ok = ok && rt_spsc_ring_space_len(&ring) == 0;
+    len = rt_spsc_ring_get(&ring, buf, sizeof(buf));
+    ok = ok && len == sizeof(pool) && ring.dropped == total - sizeof(pool);
+    for (i = 0; i < len; i++)
+        ok = ok && buf[i] == bench_byte(total - sizeof(pool) + i);
+    ok = ok && rt_spsc_ring_data_len(&ring) == 0 &&
+         rt_spsc_ring_space_len(&ring) == sizeof(pool);
+
+    /* of a block longer than the ring only the tail is kept */
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (rt_uint8_t)i;
+    ok = ok && rt_spsc_ring_put_force(&ring, buf, sizeof(buf)) == sizeof(pool);
+    len = rt_spsc_ring_get(&ring, buf, sizeof(buf));
+    ok = ok && len == sizeof(pool) && buf[0] == sizeof(buf) - sizeof(pool);
+
+    return bench_check("overwrite and dropped count", ok);
+}
+
+/* a put and a get of `block` bytes at a time, rt_ringbuffer under the interrupt lock vs the SPSC ring */
+static void bench_time(rt_uint32_t block, rt_uint32_t kbytes)
+{
+    struct rt_ringbuffer rb;
+    rt_uint8_t buf[256];
+    rt_uint32_t loops = kbytes * 1024 / block, n;
+    rt_tick_t locked, lock_free;
+    rt_base_t level;
+
+    rt_memset(buf, 0x5a, sizeof(buf));
+
+    rt_ringbuffer_init(&rb, stream.pool, sizeof(stream.pool));
+    locked = rt_tick_get();
+    for (n = 0; n < loops; n++)
+    {
+        level = rt_hw_interrupt_disable();
+        rt_ringbuffer_put(&rb, buf, block);
+        rt_hw_interrupt_enable(level);
+
+        level = rt_hw_interrupt_disable();
+        rt_ringbuffer_get(&rb, buf, block);
+        rt_hw_interrupt_enable(level);
+    }
+    locked = rt_tick_get() - locked;
+
+    rt_spsc_ring_init(&stream.ring, stream.pool, sizeof(stream.pool));
+    lock_free = rt_tick_get();
+    for (n = 0; n < loops; n++)
+    {
+        rt_spsc_ring_put(&stream.ring, buf, block);
+        rt_spsc_ring_get(&stream.ring, buf, block);
+    }
+    lock_free = rt_tick_get() - lock_free;
+
+    rt_kprintf("%3u byte blocks: ringbuffer+lock %6u us per KB, spsc_ring %6u us per KB\n", block,
+               locked * (1000000 / RT_TICK_PER_SECOND) / kbytes,
+               lock_free * (1000000 / RT_TICK_PER_SECOND) / kbytes);
+}
+
+static int spsc_ring_bench(int argc, char **argv)
+{
+    rt_uint32_t kbytes = BENCH_KBYTES;
+    rt_bool_t ok = RT_TRUE;
+
+    if (argc > 1)
+    {
+        kbytes = atoi(argv[1]);
+        if (kbytes == 0)
+        {
+            rt_kprintf("usage: spsc_ring_bench [KB]\n");
+            return -1;
+        }
+    }
+
+    ok = bench_stream_isr() && ok;
+    ok = bench_stream_thread() && ok;
+    ok = bench_overwrite() && ok;
+
+    bench_time(1, kbytes);
+    bench_time(16, kbytes);
+    bench_time(256, kbytes);
+
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(spsc_ring_bench, SPSC ring stress test and benchmark: spsc_ring_bench [KB]);
+
+#endif /* RT_SPSC_RING_USING_BENCH */
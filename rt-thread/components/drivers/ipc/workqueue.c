@@ -17,37 +17,205 @@
 
 #ifdef RT_USING_HEAP
 
-static void _delayed_work_timeout_handler(void *parameter);
+#ifndef RT_SYSTEM_WORKQUEUE_WORKERS
+#define RT_SYSTEM_WORKQUEUE_WORKERS 1
+#endif
 
-rt_inline rt_err_t _workqueue_work_completion(struct rt_workqueue *queue)
+#define WHEEL_MASK                  (RT_WORKQUEUE_WHEEL_SIZE - 1)
+#define TICK_AFTER_EQ(a, b)         ((rt_tick_t)((a) - (b)) < RT_TICK_MAX / 2)
+
+/*
+ * The delayed work of all queues waits in a hashed timer wheel driven by a
+ * single one-shot timer: the work due at tick t is in the slot t & WHEEL_MASK
+ * and the timer is armed at the next slot that isn't empty, at most a turn
+ * of the wheel ahead. A visit of a slot moves its due work to the run lists,
+ * the work due in a later turn stays there.
+ */
+static rt_list_t _wheel[RT_WORKQUEUE_WHEEL_SIZE];
+static struct rt_timer _wheel_timer;
+static rt_tick_t _wheel_tick;       /* the next slot to visit */
+static rt_tick_t _wheel_armed;      /* the tick the timer fires at */
+static rt_bool_t _wheel_running;
+static rt_uint32_t _wheel_count;    /* of the delayed work */
+static rt_bool_t _wheel_inited;
+
+static void _wheel_timeout_handler(void *parameter);
+
+static void _wheel_init(void)
 {
-    rt_err_t result;
+    int i;
 
     rt_enter_critical();
-    while (1)
+    if (!_wheel_inited)
     {
-        /* try to take condition semaphore */
-        result = rt_sem_trytake(&(queue->sem));
-        if (result == -RT_ETIMEOUT)
+        for (i = 0; i < RT_WORKQUEUE_WHEEL_SIZE; i++)
+            rt_list_init(&_wheel[i]);
+        rt_timer_init(&_wheel_timer, "wqwheel", _wheel_timeout_handler, RT_NULL, 1,
+                      RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_SOFT_TIMER);
+        _wheel_inited = RT_TRUE;
+    }
+    rt_exit_critical();
+}
+
+/* arm the timer at the next slot that isn't empty, call it with interrupts disabled */
+static void _wheel_arm(void)
+{
+    rt_tick_t now, tick, ticks;
+    int i;
+
+    if (_wheel_count == 0)
+    {
+        if (_wheel_running)
         {
-            /* it's timeout, release this semaphore */
-            rt_sem_release(&(queue->sem));
+            rt_timer_stop(&_wheel_timer);
+            _wheel_running = RT_FALSE;
         }
-        else if (result == RT_EOK)
+        return;
+    }
+
+    /* a slot the timer is late for fires at the next tick */
+    now = rt_tick_get();
+    tick = _wheel_tick;
+    for (i = 0; i < RT_WORKQUEUE_WHEEL_SIZE; i++, tick++)
+    {
+        if (!rt_list_isempty(&_wheel[tick & WHEEL_MASK]))
+            break;
+    }
+    ticks = TICK_AFTER_EQ(now, tick) ? 1 : tick - now;
+    tick = now + ticks;
+
+    if (_wheel_running && TICK_AFTER_EQ(tick, _wheel_armed))
+        return;
+
+    rt_timer_stop(&_wheel_timer);
+    rt_timer_control(&_wheel_timer, RT_TIMER_CTRL_SET_TIME, &ticks);
+    rt_timer_start(&_wheel_timer);
+    _wheel_armed = tick;
+    _wheel_running = RT_TRUE;
+}
+
+/* put the work into the wheel, call it with interrupts disabled */
+static void _wheel_add(struct rt_workqueue *queue, struct rt_work *work, rt_tick_t ticks)
+{
+    rt_tick_t now = rt_tick_get();
+
+    if (_wheel_count == 0)
+        _wheel_tick = now + 1;
+
+    work->timeout_tick = now + ticks;
+    work->workqueue = queue;
+    work->flags |= RT_WORK_STATE_SUBMITTING;
+    rt_list_insert_before(&_wheel[work->timeout_tick & WHEEL_MASK], &(work->list));
+    _wheel_count ++;
+
+    _wheel_arm();
+}
+
+/* take the work out of a run list or the wheel, call it with interrupts disabled */
+static void _workqueue_unlink_work(struct rt_work *work)
+{
+    rt_list_remove(&(work->list));
+    work->flags &= ~RT_WORK_STATE_PENDING;
+    if (work->flags & RT_WORK_STATE_SUBMITTING)
+    {
+        work->flags &= ~RT_WORK_STATE_SUBMITTING;
+        _wheel_count --;
+    }
+}
+
+static rt_bool_t _workqueue_work_running(struct rt_workqueue *queue, struct rt_work *work)
+{
+    int i;
+
+    for (i = 0; i < queue->worker_num; i++)
+    {
+        if (queue->workers[i].work_current == work)
+            return RT_TRUE;
+    }
+
+    return RT_FALSE;
+}
+
+rt_inline rt_bool_t _workqueue_worker_idle(struct rt_workqueue_worker *worker)
+{
+    return worker->work_current == RT_NULL &&
+           (worker->thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND;
+}
+
+/**
+ * Put the work into the run list of an idle worker, or else of the workers in
+ * turn, call it with interrupts disabled.
+ *
+ * @return RT_TRUE when a worker was resumed and the caller is to reschedule.
+ */
+static rt_bool_t _workqueue_enqueue_work(struct rt_workqueue *queue, struct rt_work *work, rt_bool_t urgent)
+{
+    struct rt_workqueue_worker *worker = RT_NULL;
+    rt_bool_t idle = RT_FALSE;
+    int i;
+
+    for (i = 0; i < queue->worker_num; i++)
+    {
+        if (_workqueue_worker_idle(&queue->workers[i]))
         {
-            /* keep the sem value = 0 */
-            result = RT_EOK;
+            worker = &queue->workers[i];
+            idle = RT_TRUE;
             break;
         }
-        else
+    }
+    if (worker == RT_NULL)
+    {
+        worker = &queue->workers[queue->worker_next];
+        queue->worker_next = (queue->worker_next + 1) % queue->worker_num;
+    }
+
+    if (urgent)
+        rt_list_insert_after(&(worker->work_list[RT_WORK_PRIORITY_HIGH]), &(work->list));
+    else
+        rt_list_insert_before(&(worker->work_list[work->priority]), &(work->list));
+    work->flags |= RT_WORK_STATE_PENDING;
+    work->workqueue = queue;
+
+    if (idle)
+    {
+        /* resume work thread */
+        rt_thread_resume(worker->thread);
+    }
+
+    return idle;
+}
+
+/**
+ * The next work of a worker: the first of its run list of the highest
+ * priority, or else the first of the same list of another worker. Call it
+ * with interrupts disabled.
+ */
+static struct rt_work *_workqueue_take_work(struct rt_workqueue_worker *worker)
+{
+    struct rt_workqueue *queue = worker->queue;
+    struct rt_workqueue_worker *victim;
+    struct rt_work *work;
+    int prio, i, index;
+
+    index = worker - queue->workers;
+    for (prio = 0; prio < RT_WORK_PRIORITY_MAX; prio++)
+    {
+        for (i = 0; i < queue->worker_num; i++)
         {
-            result = -RT_ERROR;
-            break;
+            victim = &queue->workers[(index + i) % queue->worker_num];
+            if (rt_list_isempty(&(victim->work_list[prio])))
+                continue;
+
+            if (victim != worker)
+                queue->work_stolen ++;
+
+            work = rt_list_first_entry(&(victim->work_list[prio]), struct rt_work, list);
+            rt_list_remove(&(work->list));
+            return work;
         }
     }
-    rt_exit_critical();
 
-    return result;
+    return RT_NULL;
 }
 
 static void _workqueue_thread_entry(void *parameter)
@@ -55,16 +223,20 @@ static void _workqueue_thread_entry(void *parameter)
     rt_base_t level;
     struct rt_work *work;
     struct rt_workqueue *queue;
+    struct rt_workqueue_worker *worker;
+    rt_uint16_t waiters;
 
-    queue = (struct rt_workqueue *) parameter;
-    RT_ASSERT(queue != RT_NULL);
+    worker = (struct rt_workqueue_worker *) parameter;
+    RT_ASSERT(worker != RT_NULL);
+    queue = worker->queue;
 
     while (1)
     {
         level = rt_hw_interrupt_disable();
-        if (rt_list_isempty(&(queue->work_list)))
+        work = _workqueue_take_work(worker);
+        if (work == RT_NULL)
         {
-            /* no software timer exist, suspend self. */
+            /* no work to do or to steal, suspend self. */
             rt_thread_suspend(rt_thread_self());
             rt_hw_interrupt_enable(level);
             rt_schedule();
@@ -72,20 +244,25 @@ static void _workqueue_thread_entry(void *parameter)
         }
 
         /* we have work to do with. */
-        work = rt_list_entry(queue->work_list.next, struct rt_work, list);
-        rt_list_remove(&(work->list));
-        queue->work_current = work;
+        worker->work_current = work;
         work->flags &= ~RT_WORK_STATE_PENDING;
         work->workqueue = RT_NULL;
         rt_hw_interrupt_enable(level);
 
         /* do work */
         work->work_func(work, work->work_data);
+
         /* clean current work */
-        queue->work_current = RT_NULL;
+        level = rt_hw_interrupt_disable();
+        worker->work_current = RT_NULL;
+        queue->work_done ++;
+        waiters = queue->sync_waiters;
+        queue->sync_waiters = 0;
+        rt_hw_interrupt_enable(level);
 
         /* ack work completion */
-        _workqueue_work_completion(queue);
+        while (waiters--)
+            rt_sem_release(&(queue->sem));
     }
 }
 
@@ -94,60 +271,34 @@ static rt_err_t _workqueue_submit_work(struct rt_workqueue *queue,
 {
     rt_base_t level;
     rt_err_t err;
+    rt_bool_t resume = RT_FALSE;
 
     level = rt_hw_interrupt_disable();
     /* remove list */
-    rt_list_remove(&(work->list));
-    work->flags &= ~RT_WORK_STATE_PENDING;
+    _workqueue_unlink_work(work);
 
     if (ticks == 0)
     {
-        if (queue->work_current != work)
+        if (!_workqueue_work_running(queue, work))
         {
-            rt_list_insert_after(queue->work_list.prev, &(work->list));
-            work->flags |= RT_WORK_STATE_PENDING;
-            work->workqueue = queue;
+            resume = _workqueue_enqueue_work(queue, work, RT_FALSE);
             err = RT_EOK;
         }
         else
         {
             err = -RT_EBUSY;
         }
+        rt_hw_interrupt_enable(level);
 
-        /* whether the workqueue is doing work */
-        if (queue->work_current == RT_NULL &&
-            ((queue->work_thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND))
-        {
-            /* resume work thread */
-            rt_thread_resume(queue->work_thread);
-            rt_hw_interrupt_enable(level);
+        if (resume)
             rt_schedule();
-        }
-        else
-        {
-            rt_hw_interrupt_enable(level);
-        }
         return err;
     }
     else if (ticks < RT_TICK_MAX / 2)
     {
-        /* Timer started */
-        if (work->flags & RT_WORK_STATE_SUBMITTING)
-        {
-            rt_timer_stop(&work->timer);
-            rt_timer_control(&work->timer, RT_TIMER_CTRL_SET_TIME, &ticks);
-        }
-        else
-        {
-            rt_timer_init(&(work->timer), "work", _delayed_work_timeout_handler,
-                        work, ticks, RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_SOFT_TIMER);
-            work->flags |= RT_WORK_STATE_SUBMITTING;
-        }
-        work->workqueue = queue;
-        /* insert delay work list */
-        rt_list_insert_after(queue->delayed_list.prev, &(work->list));
+        /* insert the timer wheel */
+        _wheel_add(queue, work, ticks);
         rt_hw_interrupt_enable(level);
-        rt_timer_start(&(work->timer));
         return RT_EOK;
     }
     rt_hw_interrupt_enable(level);
@@ -160,55 +311,54 @@ static rt_err_t _workqueue_cancel_work(struct rt_workqueue *queue, struct rt_wor
     rt_err_t err;
 
     level = rt_hw_interrupt_disable();
-    rt_list_remove(&(work->list));
-    work->flags &= ~RT_WORK_STATE_PENDING;
-    /* Timer started */
-    if (work->flags & RT_WORK_STATE_SUBMITTING)
-    {
-        rt_timer_stop(&(work->timer));
-        rt_timer_detach(&(work->timer));
-        work->flags &= ~RT_WORK_STATE_SUBMITTING;
-    }
-    err = queue->work_current != work ? RT_EOK : -RT_EBUSY;
+    _workqueue_unlink_work(work);
+    err = !_workqueue_work_running(queue, work) ? RT_EOK : -RT_EBUSY;
     work->workqueue = RT_NULL;
     rt_hw_interrupt_enable(level);
     return err;
 }
 
-static void _delayed_work_timeout_handler(void *parameter)
+static void _wheel_timeout_handler(void *parameter)
 {
     struct rt_work *work;
     struct rt_workqueue *queue;
+    rt_list_t *slot, *node, *next;
     rt_base_t level;
-
-    work = (struct rt_work *)parameter;
-    queue = work->workqueue;
-    RT_ASSERT(queue != RT_NULL);
+    rt_tick_t now;
+    rt_bool_t resume = RT_FALSE;
+    int i;
 
     level = rt_hw_interrupt_disable();
-    rt_timer_detach(&(work->timer));
-    work->flags &= ~RT_WORK_STATE_SUBMITTING;
-    /* remove delay list */
-    rt_list_remove(&(work->list));
-    /* insert work queue */
-    if (queue->work_current != work)
+    _wheel_running = RT_FALSE;
+    now = rt_tick_get();
+
+    /* the slots up to now, each once when the timer is late for a turn */
+    for (i = 0; i < RT_WORKQUEUE_WHEEL_SIZE && TICK_AFTER_EQ(now, _wheel_tick); i++, _wheel_tick++)
     {
-        rt_list_insert_after(queue->work_list.prev, &(work->list));
-        work->flags |= RT_WORK_STATE_PENDING;
+        slot = &_wheel[_wheel_tick & WHEEL_MASK];
+        for (node = slot->next; node != slot; node = next)
+        {
+            next = node->next;
+            work = rt_list_entry(node, struct rt_work, list);
+            if (!TICK_AFTER_EQ(now, work->timeout_tick))
+                continue;
+
+            queue = work->workqueue;
+            RT_ASSERT(queue != RT_NULL);
+            _workqueue_unlink_work(work);
+            /* insert work queue */
+            if (!_workqueue_work_running(queue, work))
+                resume = _workqueue_enqueue_work(queue, work, RT_FALSE) || resume;
+        }
     }
-    /* whether the workqueue is doing work */
-    if (queue->work_current == RT_NULL &&
-        ((queue->work_thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND))
-    {
-        /* resume work thread */
-        rt_thread_resume(queue->work_thread);
-        rt_hw_interrupt_enable(level);
+    if (TICK_AFTER_EQ(now, _wheel_tick))
+        _wheel_tick = now + 1;
+
+    _wheel_arm();
+    rt_hw_interrupt_enable(level);
+
+    if (resume)
         rt_schedule();
-    }
-    else
-    {
-        rt_hw_interrupt_enable(level);
-    }
 }
 
 /**
@@ -233,6 +383,24 @@ void rt_work_init(struct rt_work *work,
     work->workqueue = RT_NULL;
     work->flags = 0;
     work->type = 0;
+    work->priority = RT_WORK_PRIORITY_NORMAL;
+    work->timeout_tick = 0;
+}
+
+/**
+ * @brief Set the priority of a work item, RT_WORK_PRIORITY_NORMAL after rt_work_init().
+ *        The workers take the work of a higher priority first. Set it while the work isn't submitted.
+ *
+ * @param work is a pointer to the work item object.
+ *
+ * @param priority is RT_WORK_PRIORITY_HIGH, RT_WORK_PRIORITY_NORMAL or RT_WORK_PRIORITY_LOW.
+ */
+void rt_work_set_priority(struct rt_work *work, rt_uint8_t priority)
+{
+    RT_ASSERT(work != RT_NULL);
+    RT_ASSERT(priority < RT_WORK_PRIORITY_MAX);
+
+    work->priority = priority;
 }
 
 /**
@@ -247,29 +415,78 @@ void rt_work_init(struct rt_work *work,
  * @return Return a pointer to the workqueue object. It will return RT_NULL if failed.
  */
 struct rt_workqueue *rt_workqueue_create(const char *name, rt_uint16_t stack_size, rt_uint8_t priority)
+{
+    return rt_workqueue_create_workers(name, stack_size, priority, 1);
+}
+
+/**
+ * @brief Create a work queue with several worker threads inside. A work item is queued
+ *        to an idle worker, the idle workers steal the work queued to the busy ones.
+ *
+ * @param name is a name of the worker threads.
+ *
+ * @param stack_size is stack size of each worker thread.
+ *
+ * @param priority is a priority of the worker threads.
+ *
+ * @param worker_num is the number of worker threads.
+ *
+ * @return Return a pointer to the workqueue object. It will return RT_NULL if failed.
+ */
+struct rt_workqueue *rt_workqueue_create_workers(const char *name, rt_uint16_t stack_size, rt_uint8_t priority,
+                                                 rt_uint8_t worker_num)
 {
     struct rt_workqueue *queue = RT_NULL;
+    struct rt_workqueue_worker *worker;
+    int i, prio;
+
+    RT_ASSERT(worker_num > 0);
+
+    _wheel_init();
 
     queue = (struct rt_workqueue *)RT_KERNEL_MALLOC(sizeof(struct rt_workqueue));
-    if (queue != RT_NULL)
+    if (queue == RT_NULL)
+        return RT_NULL;
+
+    queue->workers = (struct rt_workqueue_worker *)RT_KERNEL_MALLOC(sizeof(struct rt_workqueue_worker) * worker_num);
+    if (queue->workers == RT_NULL)
+    {
+        RT_KERNEL_FREE(queue);
+        return RT_NULL;
+    }
+    queue->worker_num = worker_num;
+    queue->worker_next = 0;
+    queue->sync_waiters = 0;
+    queue->work_done = 0;
+    queue->work_stolen = 0;
+    rt_sem_init(&(queue->sem), "wqueue", 0, RT_IPC_FLAG_FIFO);
+
+    for (i = 0; i < worker_num; i++)
     {
+        worker = &queue->workers[i];
+
         /* initialize work list */
-        rt_list_init(&(queue->work_list));
-        rt_list_init(&(queue->delayed_list));
-        queue->work_current = RT_NULL;
-        rt_sem_init(&(queue->sem), "wqueue", 0, RT_IPC_FLAG_FIFO);
+        for (prio = 0; prio < RT_WORK_PRIORITY_MAX; prio++)
+            rt_list_init(&(worker->work_list[prio]));
+        worker->work_current = RT_NULL;
+        worker->queue = queue;
 
         /* create the work thread */
-        queue->work_thread = rt_thread_create(name, _workqueue_thread_entry, queue, stack_size, priority, 10);
-        if (queue->work_thread == RT_NULL)
+        worker->thread = rt_thread_create(name, _workqueue_thread_entry, worker, stack_size, priority, 10);
+        if (worker->thread == RT_NULL)
         {
+            while (i--)
+                rt_thread_delete(queue->workers[i].thread);
+            rt_sem_detach(&(queue->sem));
+            RT_KERNEL_FREE(queue->workers);
             RT_KERNEL_FREE(queue);
             return RT_NULL;
         }
-
-        rt_thread_startup(queue->work_thread);
     }
 
+    for (i = 0; i < worker_num; i++)
+        rt_thread_startup(queue->workers[i].thread);
+
     return queue;
 }
 
@@ -282,11 +499,15 @@ struct rt_workqueue *rt_workqueue_create(const char *name, rt_uint16_t stack_siz
  */
 rt_err_t rt_workqueue_destroy(struct rt_workqueue *queue)
 {
+    int i;
+
     RT_ASSERT(queue != RT_NULL);
 
     rt_workqueue_cancel_all_work(queue);
-    rt_thread_delete(queue->work_thread);
+    for (i = 0; i < queue->worker_num; i++)
+        rt_thread_delete(queue->workers[i].thread);
     rt_sem_detach(&(queue->sem));
+    RT_KERNEL_FREE(queue->workers);
     RT_KERNEL_FREE(queue);
 
     return RT_EOK;
@@ -341,7 +562,8 @@ rt_err_t rt_workqueue_submit_work(struct rt_workqueue *queue, struct rt_work *wo
  *
  * @param work is a pointer to the work item object.
  *
- * @return RT_EOK   Success.
+ * @return RT_EOK       Success.
+ *         -RT_EBUSY    This work item is executing.
  */
 rt_err_t rt_workqueue_urgent_work(struct rt_workqueue *queue, struct rt_work *work)
 {
@@ -352,14 +574,17 @@ rt_err_t rt_workqueue_urgent_work(struct rt_workqueue *queue, struct rt_work *wo
 
     level = rt_hw_interrupt_disable();
     /* NOTE: the work MUST be initialized firstly */
-    rt_list_remove(&(work->list));
-    rt_list_insert_after(&queue->work_list, &(work->list));
-    /* whether the workqueue is doing work */
-    if (queue->work_current == RT_NULL &&
-        ((queue->work_thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND))
+    _workqueue_unlink_work(work);
+    /* another worker would run it at the same time */
+    if (_workqueue_work_running(queue, work))
+    {
+        rt_hw_interrupt_enable(level);
+        return -RT_EBUSY;
+    }
+
+    /* at the head of the run list of the highest priority */
+    if (_workqueue_enqueue_work(queue, work, RT_TRUE))
     {
-        /* resume work thread */
-        rt_thread_resume(queue->work_thread);
         rt_hw_interrupt_enable(level);
         rt_schedule();
     }
@@ -400,18 +625,24 @@ rt_err_t rt_workqueue_cancel_work(struct rt_workqueue *queue, struct rt_work *wo
  */
 rt_err_t rt_workqueue_cancel_work_sync(struct rt_workqueue *queue, struct rt_work *work)
 {
+    rt_base_t level;
+
     RT_ASSERT(queue != RT_NULL);
     RT_ASSERT(work != RT_NULL);
 
-    if (queue->work_current == work) /* it's current work in the queue */
+    level = rt_hw_interrupt_disable();
+    while (_workqueue_work_running(queue, work)) /* it's current work of a worker */
     {
-        /* wait for work completion */
+        /* wait for work completion, the worker releases the semaphore once per waiter */
+        queue->sync_waiters ++;
+        rt_hw_interrupt_enable(level);
         rt_sem_take(&(queue->sem), RT_WAITING_FOREVER);
+        level = rt_hw_interrupt_disable();
     }
-    else
-    {
-        _workqueue_cancel_work(queue, work);
-    }
+    rt_hw_interrupt_enable(level);
+
+    /* the work may have submitted itself again */
+    _workqueue_cancel_work(queue, work);
 
     return RT_EOK;
 }
@@ -426,23 +657,39 @@ rt_err_t rt_workqueue_cancel_work_sync(struct rt_workqueue *queue, struct rt_wor
 rt_err_t rt_workqueue_cancel_all_work(struct rt_workqueue *queue)
 {
     struct rt_work *work;
+    rt_list_t *list, *node, *next;
+    rt_base_t level;
+    int i, prio;
 
     RT_ASSERT(queue != RT_NULL);
 
-    /* cancel work */
-    rt_enter_critical();
-    while (rt_list_isempty(&queue->work_list) == RT_FALSE)
+    /* cancel work, the timer wheel moves work to the run lists in an interrupt */
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < queue->worker_num; i++)
     {
-        work = rt_list_first_entry(&queue->work_list, struct rt_work, list);
-        _workqueue_cancel_work(queue, work);
+        for (prio = 0; prio < RT_WORK_PRIORITY_MAX; prio++)
+        {
+            list = &(queue->workers[i].work_list[prio]);
+            while (rt_list_isempty(list) == RT_FALSE)
+            {
+                work = rt_list_first_entry(list, struct rt_work, list);
+                _workqueue_cancel_work(queue, work);
+            }
+        }
     }
-    /* cancel delay work */
-    while (rt_list_isempty(&queue->delayed_list) == RT_FALSE)
+    /* cancel delay work of this queue in the shared wheel */
+    for (i = 0; i < RT_WORKQUEUE_WHEEL_SIZE; i++)
     {
-        work = rt_list_first_entry(&queue->delayed_list, struct rt_work, list);
-        _workqueue_cancel_work(queue, work);
+        list = &_wheel[i];
+        for (node = list->next; node != list; node = next)
+        {
+            next = node->next;
+            work = rt_list_entry(node, struct rt_work, list);
+            if (work->workqueue == queue)
+                _workqueue_cancel_work(queue, work);
+        }
     }
-    rt_exit_critical();
+    rt_hw_interrupt_enable(level);
 
     return RT_EOK;
 }
@@ -499,8 +746,8 @@ static int rt_work_sys_workqueue_init(void)
     if (sys_workq != RT_NULL)
         return RT_EOK;
 
-    sys_workq = rt_workqueue_create("sys workq", RT_SYSTEM_WORKQUEUE_STACKSIZE,
-                                    RT_SYSTEM_WORKQUEUE_PRIORITY);
+    sys_workq = rt_workqueue_create_workers("sys workq", RT_SYSTEM_WORKQUEUE_STACKSIZE,
+                                            RT_SYSTEM_WORKQUEUE_PRIORITY, RT_SYSTEM_WORKQUEUE_WORKERS);
     RT_ASSERT(sys_workq != RT_NULL);
 
     return RT_EOK;
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Test and benchmark of the multi-worker workqueue.
+ *
+ * The work queued behind a blocked work must run by priority, the work
+ * queued to a blocked worker must be stolen by an idle one, the delayed
+ * work of the timer wheel must run at its tick, also after a turn of the
+ * wheel, and rt_workqueue_cancel_work_sync() must wait for a running work.
+ * Then the time per submission of a batch of work and the time the workers
+ * take to drain it are printed for 1 and 4 workers, and the percentiles of
+ * the latency from a submission to the start of the work.
+ *
+ * msh: workqueue_bench [works]
+ */
+
+#include <rtthread.h>
+
+#ifdef RT_WORKQUEUE_USING_BENCH
+
+#include <stdlib.h>
+#include <rthw.h>
+#include <rtdevice.h>
+
+#ifdef RT_USING_CPUTIME
+#define BENCH_STAMP()               ((rt_uint32_t)clock_cpu_gettime())
+#define BENCH_STAMP_TO_US(stamp)    ((rt_uint32_t)clock_cpu_microsecond(stamp))
+#else
+#define BENCH_STAMP()               ((rt_uint32_t)rt_tick_get())
+#define BENCH_STAMP_TO_US(stamp)    ((stamp) * (1000000 / RT_TICK_PER_SECOND))
+#endif
+
+#define BENCH_WORKS         256
+#define BENCH_SAMPLES       200
+#define BENCH_DELAYED       8
+#define BENCH_STACK_SIZE    2048
+#define BENCH_TIMEOUT       (RT_TICK_PER_SECOND * 2)
+
+struct bench_work
+{
+    struct rt_work work;
+    rt_tick_t submit_tick;
+    rt_tick_t run_tick;
+    rt_uint32_t runs;
+};
+
+static struct
+{
+    struct rt_semaphore gate;           /* holds the gate work */
+    struct rt_semaphore done;           /* released by each work */
+
+    rt_uint8_t order[RT_WORK_PRIORITY_MAX];
+    rt_uint8_t order_count;
+
+    rt_uint32_t total;
+    volatile rt_uint32_t count;
+    volatile rt_bool_t sync_done;
+    rt_uint32_t stamp;
+} bench;
+
+static rt_bool_t bench_check(const char *name, rt_bool_t ok)
+{
+    rt_kprintf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static rt_uint8_t bench_priority(rt_int32_t offset)
+{
+    rt_int32_t priority = rt_thread_self()->current_priority + offset;
+
+    if (priority < 1)
+        priority = 1;
+    if (priority > RT_THREAD_PRIORITY_MAX - 2)
+        priority = RT_THREAD_PRIORITY_MAX - 2;
+
+    return (rt_uint8_t)priority;
+}
+
+/* wait for `count` releases of bench.done */
+static rt_bool_t bench_wait_done(int count, rt_int32_t timeout)
+{
+    while (count--)
+    {
+        if (rt_sem_take(&bench.done, timeout) != RT_EOK)
+            return RT_FALSE;
+    }
+
+    return RT_TRUE;
+}
+
+static void gate_work_func(struct rt_work *work, void *work_data)
+{
+    rt_sem_take(&bench.gate, BENCH_TIMEOUT);
+    rt_sem_release(&bench.done);
+}
+
+static void order_work_func(struct rt_work *work, void *work_data)
+{
+    if (bench.order_count < RT_WORK_PRIORITY_MAX)
+        bench.order[bench.order_count++] = work->priority;
+    rt_sem_release(&bench.done);
+}
+
+static void done_work_func(struct rt_work *work, void *work_data)
+{
+    rt_sem_release(&bench.done);
+}
+
+/* the work queued behind a blocked work runs by priority */
+static rt_bool_t bench_priority_order(void)
+{
+    struct rt_workqueue *queue;
+    struct rt_work gate, work[RT_WORK_PRIORITY_MAX];
+    rt_bool_t ok;
+    int i;
+
+    queue = rt_workqueue_create("wqbench", BENCH_STACK_SIZE, bench_priority(1));
+    if (queue == RT_NULL)
+        return bench_check("priority order", RT_FALSE);
+
+    rt_work_init(&gate, gate_work_func, RT_NULL);
+    rt_workqueue_dowork(queue, &gate);
+    rt_thread_mdelay(2);
+
+    bench.order_count = 0;
+    for (i = RT_WORK_PRIORITY_MAX - 1; i >= 0; i--)
+    {
+        rt_work_init(&work[i], order_work_func, RT_NULL);
+        rt_work_set_priority(&work[i], i);
+        rt_workqueue_dowork(queue, &work[i]);
+    }
+
+    rt_sem_release(&bench.gate);
+    ok = bench_wait_done(1 + RT_WORK_PRIORITY_MAX, BENCH_TIMEOUT);
+    for (i = 0; i < RT_WORK_PRIORITY_MAX; i++)
+        ok = ok && bench.order_count == RT_WORK_PRIORITY_MAX && bench.order[i] == i;
+
+    rt_workqueue_destroy(queue);
+    return bench_check("priority order", ok);
+}
+
+/* the work queued to the worker of the gate is stolen by the other one */
+static rt_bool_t bench_stealing(void)
+{
+    struct rt_workqueue *queue;
+    struct rt_work gate, work[4];
+    rt_bool_t ok;
+    int i;
+
+    queue = rt_workqueue_create_workers("wqbench", BENCH_STACK_SIZE, bench_priority(1), 2);
+    if (queue == RT_NULL)
+        return bench_check("work stealing", RT_FALSE);
+
+    rt_work_init(&gate, gate_work_func, RT_NULL);
+    rt_workqueue_dowork(queue, &gate);
+    rt_thread_mdelay(2);
+
+    /* the idle worker gets the first one, the others go to the workers in turn */
+    rt_enter_critical();
+    for (i = 0; i < 4; i++)
+    {
+        rt_work_init(&work[i], done_work_func, RT_NULL);
+        rt_workqueue_dowork(queue, &work[i]);
+    }
+    rt_exit_critical();
+
+    /* all done while the gate still holds its worker */
+    ok = bench_wait_done(4, BENCH_TIMEOUT / 4);
+    ok = ok && queue->work_stolen > 0;
+
+    rt_sem_release(&bench.gate);
+    ok = bench_wait_done(1, BENCH_TIMEOUT) && ok;
+
+    rt_workqueue_destroy(queue);
+    return bench_check("work stealing", ok);
+}
+
+static void delayed_work_func(struct rt_work *work, void *work_data)
+{
+    struct bench_work *bwork = (struct bench_work *)work;
+
+    bwork->run_tick = rt_tick_get();
+    bwork->runs ++;
+    rt_sem_release(&bench.done);
+}
+
+/* the delayed work runs at its tick, up to a late tick or two, also after a turn of the wheel */
+static rt_bool_t bench_delayed(void)
+{
+    static const rt_tick_t delays[BENCH_DELAYED] = {1, 2, 5, RT_WORKQUEUE_WHEEL_SIZE - 1, RT_WORKQUEUE_WHEEL_SIZE,
+                                                    RT_WORKQUEUE_WHEEL_SIZE + 1, 100, 300};
+    struct bench_work work[BENCH_DELAYED], cancelled, resubmitted;
+    struct rt_workqueue *queue;
+    rt_tick_t late;
+    rt_bool_t ok;
+    int i;
+
+    queue = rt_workqueue_create_workers("wqbench", BENCH_STACK_SIZE, bench_priority(-1), 2);
+    if (queue == RT_NULL)
+        return bench_check("delayed work", RT_FALSE);
+
+    rt_memset(work, 0, sizeof(work));
+    rt_memset(&cancelled, 0, sizeof(cancelled));
+    rt_memset(&resubmitted, 0, sizeof(resubmitted));
+    for (i = 0; i < BENCH_DELAYED; i++)
+    {
+        rt_work_init(&work[i].work, delayed_work_func, RT_NULL);
+        work[i].submit_tick = rt_tick_get();
+        rt_workqueue_submit_work(queue, &work[i].work, delays[i]);
+    }
+    rt_work_init(&cancelled.work, delayed_work_func, RT_NULL);
+    rt_workqueue_submit_work(queue, &cancelled.work, 10);
+    rt_work_init(&resubmitted.work, delayed_work_func, RT_NULL);
+    rt_workqueue_submit_work(queue, &resubmitted.work, 200);
+
+    rt_workqueue_cancel_work(queue, &cancelled.work);
+    resubmitted.submit_tick = rt_tick_get();
+    rt_workqueue_submit_work(queue, &resubmitted.work, 20);
+
+    /* the last one is due after the cancelled work and the first submission */
+    ok = bench_wait_done(BENCH_DELAYED + 1, BENCH_TIMEOUT);
+    ok = ok && cancelled.runs == 0 && resubmitted.runs == 1;
+    ok = ok && resubmitted.run_tick - resubmitted.submit_tick >= 20 &&
+         resubmitted.run_tick - resubmitted.submit_tick <= 20 + 2;
+    for (i = 0; i < BENCH_DELAYED; i++)
+    {
+        late = work[i].run_tick - work[i].submit_tick - delays[i];
+        if (work[i].runs != 1 || late > 2)
+        {
+            rt_kprintf("delay %u: %u runs, %d ticks late\n", delays[i], work[i].runs, (int)late);
+            ok = RT_FALSE;
+        }
+    }
+
+    rt_workqueue_destroy(queue);
+    return bench_check("delayed work", ok);
+}
+
+static void sync_work_func(struct rt_work *work, void *work_data)
+{
+    rt_thread_mdelay(20);
+    bench.sync_done = RT_TRUE;
+}
+
+/* the cancel of a running work waits for it */
+static rt_bool_t bench_cancel_sync(void)
+{
+    struct rt_workqueue *queue;
+    struct rt_work work;
+    rt_bool_t ok;
+
+    queue = rt_workqueue_create_workers("wqbench", BENCH_STACK_SIZE, bench_priority(-1), 2);
+    if (queue == RT_NULL)
+        return bench_check("cancel sync", RT_FALSE);
+
+    bench.sync_done = RT_FALSE;
+    rt_work_init(&work, sync_work_func, RT_NULL);
+    rt_workqueue_dowork(queue, &work);
+    rt_thread_mdelay(2);
+
+    ok = rt_workqueue_dowork(queue, &work) == -RT_EBUSY;
+    rt_workqueue_cancel_work_sync(queue, &work);
+    ok = ok && bench.sync_done;
+
+    rt_workqueue_destroy(queue);
+    return bench_check("cancel sync", ok);
+}
+
+static void count_work_func(struct rt_work *work, void *work_data)
+{
+    rt_base_t level;
+    rt_bool_t last;
+
+    level = rt_hw_interrupt_disable();
+    last = ++bench.count == bench.total;
+    rt_hw_interrupt_enable(level);
+
+    if (last)
+        rt_sem_release(&bench.done);
+}
+
+/* the time per submission of `works` work and to drain them, the workers run after the submissions */
+static void bench_throughput(rt_uint8_t worker_num, rt_uint32_t works)
+{
+    struct rt_workqueue *queue;
+    struct rt_work *work;
+    rt_uint32_t submit, drain, i;
+
+    work = (struct rt_work *)rt_malloc(sizeof(struct rt_work) * works);
+    queue = rt_workqueue_create_workers("wqbench", BENCH_STACK_SIZE, bench_priority(1), worker_num);
+    if (work == RT_NULL || queue == RT_NULL)
+    {
+        rt_kprintf("%u workers: no memory\n", worker_num);
+        goto __exit;
+    }
+
+    bench.total = works;
+    bench.count = 0;
+    for (i = 0; i < works; i++)
+        rt_work_init(&work[i], count_work_func, RT_NULL);
+
+    submit = BENCH_STAMP();
+    for (i = 0; i < works; i++)
+        rt_workqueue_dowork(queue, &work[i]);
+    drain = BENCH_STAMP();
+    submit = drain - submit;
+
+    bench_wait_done(1, BENCH_TIMEOUT);
+    drain = BENCH_STAMP() - drain;
+
+    rt_kprintf("%u workers: %6u ns per submission, %6u us to drain %u works (%u stolen)\n", worker_num,
+               BENCH_STAMP_TO_US(submit) * 1000 / works, BENCH_STAMP_TO_US(drain), works, queue->work_stolen);
+
+__exit:
+    if (queue != RT_NULL)
+        rt_workqueue_destroy(queue);
+    if (work != RT_NULL)
+        rt_free(work);
+}
+
+struct latency_work
+{
+    struct rt_work work;
+    rt_uint32_t latency;
+};
+
+static void latency_work_func(struct rt_work *work, void *work_data)
+{
+    struct latency_work *lwork = (struct latency_work *)work;
+
+    lwork->latency = BENCH_STAMP() - bench.stamp;
+    rt_sem_release(&bench.done);
+}
+
+/* the time from a submission to the start of the work, the worker preempts the submitter */
+static void bench_latency(void)
+{
+    struct rt_workqueue *queue;
+    struct latency_work *work;
+    rt_uint32_t value;
+    int i, j, samples;
+
+    work = (struct latency_work *)rt_malloc(sizeof(struct latency_work) * BENCH_SAMPLES);
+    queue = rt_workqueue_create_workers("wqbench", BENCH_STACK_SIZE, bench_priority(-1), 2);
+    if (work == RT_NULL || queue == RT_NULL)
+    {
+        rt_kprintf("latency: no memory\n");
+        goto __exit;
+    }
+
+    /* a work of its own for each sample, the last one may still be finishing */
+    for (samples = 0; samples < BENCH_SAMPLES; samples++)
+    {
+        rt_work_init(&work[samples].work, latency_work_func, RT_NULL);
+        bench.stamp = BENCH_STAMP();
+        rt_workqueue_dowork(queue, &work[samples].work);
+        if (!bench_wait_done(1, BENCH_TIMEOUT))
+            break;
+        work[samples].latency = BENCH_STAMP_TO_US(work[samples].latency);
+    }
+    if (samples == 0)
+    {
+        rt_kprintf("latency: no work done\n");
+        goto __exit;
+    }
+
+    /* insertion sort, the samples are few */
+    for (i = 1; i < samples; i++)
+    {
+        value = work[i].latency;
+        for (j = i; j > 0 && work[j - 1].latency > value; j--)
+            work[j].latency = work[j - 1].latency;
+        work[j].latency = value;
+    }
+
+    rt_kprintf("latency: p50 %u us, p90 %u us, p99 %u us, max %u us (%d samples)\n",
+               work[samples * 50 / 100].latency, work[samples * 90 / 100].latency,
+               work[samples * 99 / 100].latency, work[samples - 1].latency, samples);
+
+__exit:
+    if (queue != RT_NULL)
+        rt_workqueue_destroy(queue);
+    if (work != RT_NULL)
+        rt_free(work);
+}
+
+static int workqueue_bench(int argc, char **argv)
+{
+    rt_uint32_t works = BENCH_WORKS;
+    rt_bool_t ok = RT_TRUE;
+
+    if (argc > 1)
+    {
+        works = atoi(argv[1]);
+        if (works == 0)
+        {
+            rt_kprintf("usage: workqueue_bench [works]\n");
+            return -1;
+        }
+    }
+
+    rt_sem_init(&bench.gate, "wqgate", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&bench.done, "wqdone", 0, RT_IPC_FLAG_FIFO);
+
+    ok = bench_priority_order() && ok;
+    ok = bench_stealing() && ok;
+    ok = bench_delayed() && ok;
+    ok = bench_cancel_sync() && ok;
+
+    bench_throughput(1, works);
+    bench_throughput(4, works);
+    bench_latency();
+
+    rt_sem_detach(&bench.gate);
+    rt_sem_detach(&bench.done);
+
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(workqueue_bench, workqueue test and benchmark: workqueue_bench [works]);
+
+#endif /* RT_WORKQUEUE_USING_BENCH */
@@ -12,6 +12,7 @@
 #include <dfs_fs.h>
 
 #include <drivers/mmcsd_core.h>
+#include <drivers/mmcsd_queue.h>
 
 #define DBG_TAG               "SDIO"
 #ifdef RT_SDIO_DEBUG
@@ -99,11 +100,11 @@ rt_int32_t mmcsd_num_wr_blocks(struct rt_mmcsd_card *card)
     return blocks;
 }
 
-static rt_err_t rt_mmcsd_req_blk(struct rt_mmcsd_card *card,
-                                 rt_uint32_t           sector,
-                                 void                 *buf,
-                                 rt_size_t             blks,
-                                 rt_uint8_t            dir)
+rt_err_t rt_mmcsd_req_blk(struct rt_mmcsd_card *card,
+                          rt_uint32_t           sector,
+                          void                 *buf,
+                          rt_size_t             blks,
+                          rt_uint8_t            dir)
 {
     struct rt_mmcsd_cmd  cmd, stop;
     struct rt_mmcsd_data  data;
@@ -249,6 +250,20 @@ static rt_size_t rt_mmcsd_read(rt_device_t dev,
         return 0;
     }
 
+#ifdef RT_MMCSD_USING_QUEUE
+    if (blk_dev->card->blk_queue != RT_NULL)
+    {
+        /* the queue splits and merges the requests */
+        err = mmcsd_queue_rw(blk_dev->card->blk_queue, part->offset + pos, buffer, size, 0);
+        if (err)
+        {
+            rt_set_errno(-EIO);
+            return 0;
+        }
+        return size;
+    }
+#endif /* RT_MMCSD_USING_QUEUE */
+
     rt_sem_take(part->lock, RT_WAITING_FOREVER);
     while (remain_size)
     {
@@ -290,6 +305,19 @@ static rt_size_t rt_mmcsd_write(rt_device_t dev,
         return 0;
     }
 
+#ifdef RT_MMCSD_USING_QUEUE
+    if (blk_dev->card->blk_queue != RT_NULL)
+    {
+        err = mmcsd_queue_rw(blk_dev->card->blk_queue, part->offset + pos, wr_ptr, size, 1);
+        if (err)
+        {
+            rt_set_errno(-EIO);
+            return 0;
+        }
+        return size;
+    }
+#endif /* RT_MMCSD_USING_QUEUE */
+
     rt_sem_take(part->lock, RT_WAITING_FOREVER);
     while (remain_size)
     {
@@ -456,6 +484,11 @@ rt_int32_t rt_mmcsd_blk_probe(struct rt_mmcsd_card *card)
         /* Initial blk_device link-list. */
         rt_list_init(&card->blk_devices);
 
+#ifdef RT_MMCSD_USING_QUEUE
+        /* without the queue the requests are sent directly */
+        card->blk_queue = mmcsd_queue_create(card);
+#endif /* RT_MMCSD_USING_QUEUE */
+
         for (i = 0; i < RT_MMCSD_MAX_PARTITION; i++)
         {
             /* Get the first partition */
@@ -523,4 +556,12 @@ void rt_mmcsd_blk_remove(struct rt_mmcsd_card *card)
             rt_free(blk_dev);
         }
     }
+
+#ifdef RT_MMCSD_USING_QUEUE
+    if (card->blk_queue != RT_NULL)
+    {
+        mmcsd_queue_delete(card->blk_queue);
+        card->blk_queue = RT_NULL;
+    }
+#endif /* RT_MMCSD_USING_QUEUE */
 }
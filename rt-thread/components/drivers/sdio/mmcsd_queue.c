@@ -0,0 +1,420 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Asynchronous block request queue of a SD/MMC card.
+ *
+ * The requests are merged when they are submitted: a request which continues
+ * or precedes a queued transfer in the same direction joins it, so the next
+ * multi-block transfer is ready while the queue thread waits for the current
+ * one. The segments of a transfer are sent straight from the buffer of the
+ * caller when the host can DMA it, else through a bounce buffer. Big writes
+ * are preceded by ACMD23 so the card can erase the blocks in advance.
+ */
+
+#include <rtthread.h>
+#include <drivers/mmcsd_core.h>
+#include <drivers/mmcsd_queue.h>
+#include <ipc/completion.h>
+
+#define DBG_TAG               "SDIO"
+#ifdef RT_SDIO_DEBUG
+#define DBG_LVL               DBG_LOG
+#else
+#define DBG_LVL               DBG_INFO
+#endif /* RT_SDIO_DEBUG */
+#include <rtdbg.h>
+
+#ifndef RT_MMCSD_QUEUE_MAX_BLKS
+#define RT_MMCSD_QUEUE_MAX_BLKS         128
+#endif
+#ifndef RT_MMCSD_QUEUE_PRE_ERASE_BLKS
+#define RT_MMCSD_QUEUE_PRE_ERASE_BLKS   64
+#endif
+#ifndef RT_MMCSD_QUEUE_THREAD_PRIORITY
+#define RT_MMCSD_QUEUE_THREAD_PRIORITY  20
+#endif
+#ifndef RT_MMCSD_QUEUE_STACK_SIZE
+#define RT_MMCSD_QUEUE_STACK_SIZE       1024
+#endif
+
+#define MMCSD_BLK_SIZE                  512
+
+struct rt_mmcsd_queue
+{
+    struct rt_mmcsd_card *card;
+    rt_list_t pending;                  /* transfers in submission order */
+    struct rt_mutex lock;
+    struct rt_semaphore sem;            /* released for each new transfer */
+    struct rt_semaphore exit_sem;
+    rt_thread_t thread;
+    rt_bool_t quit;
+
+    rt_uint8_t *bounce;
+    rt_uint32_t max_blks;
+
+    struct rt_mmcsd_queue_stat stat;
+};
+
+static rt_bool_t range_overlap(rt_uint32_t s1, rt_uint32_t n1, rt_uint32_t s2, rt_uint32_t n2)
+{
+    return s1 < s2 + n2 && s2 < s1 + n1;
+}
+
+/* the segment of a transfer at `off` blocks and the blocks left in it */
+static rt_uint8_t *sg_locate(struct rt_mmcsd_blk_req *head, rt_uint32_t off, rt_uint32_t *left)
+{
+    struct rt_mmcsd_blk_req *req;
+    rt_list_t *l;
+    rt_uint32_t i;
+
+    for (l = head->merged.next; l != &head->merged; l = l->next)
+    {
+        req = rt_list_entry(l, struct rt_mmcsd_blk_req, node);
+        for (i = 0; i < req->sg_cnt; i++)
+        {
+            if (off < req->sg[i].blks)
+            {
+                *left = req->sg[i].blks - off;
+                return (rt_uint8_t *)req->sg[i].buf + off * MMCSD_BLK_SIZE;
+            }
+            off -= req->sg[i].blks;
+        }
+    }
+
+    *left = 0;
+    return RT_NULL;
+}
+
+static void sg_copy(struct rt_mmcsd_blk_req *head, rt_uint32_t off, rt_uint8_t *bounce,
+                    rt_uint32_t blks, rt_bool_t to_bounce)
+{
+    rt_uint8_t *ptr;
+    rt_uint32_t left;
+
+    while (blks)
+    {
+        ptr = sg_locate(head, off, &left);
+        if (left > blks)
+            left = blks;
+        if (to_bounce)
+            rt_memcpy(bounce, ptr, left * MMCSD_BLK_SIZE);
+        else
+            rt_memcpy(ptr, bounce, left * MMCSD_BLK_SIZE);
+        bounce += left * MMCSD_BLK_SIZE;
+        off += left;
+        blks -= left;
+    }
+}
+
+static rt_bool_t dma_direct(struct rt_mmcsd_host *host, void *buf, rt_uint32_t blks)
+{
+    if (blks * MMCSD_BLK_SIZE <= host->max_seg_size)
+        return RT_TRUE;
+
+    return (host->flags & MMCSD_SUP_BIG_DMA) && ((rt_ubase_t)buf & (MMCSD_DMA_ALIGN - 1)) == 0;
+}
+
+static rt_err_t mmcsd_pre_erase(struct rt_mmcsd_card *card, rt_uint32_t blks)
+{
+    struct rt_mmcsd_cmd cmd;
+
+    rt_memset(&cmd, 0, sizeof(struct rt_mmcsd_cmd));
+    cmd.cmd_code = APP_CMD;
+    cmd.arg = card->rca << 16;
+    cmd.flags = RESP_SPI_R1 | RESP_R1 | CMD_AC;
+    if (mmcsd_send_cmd(card->host, &cmd, 0))
+        return -RT_ERROR;
+
+    rt_memset(&cmd, 0, sizeof(struct rt_mmcsd_cmd));
+    cmd.cmd_code = SD_APP_SET_WR_BLK_ERASE_COUNT;
+    cmd.arg = blks & 0x7fffff;
+    cmd.flags = RESP_SPI_R1 | RESP_R1 | CMD_AC;
+    if (mmcsd_send_cmd(card->host, &cmd, 0))
+        return -RT_ERROR;
+
+    return RT_EOK;
+}
+
+static rt_err_t mmcsd_queue_xfer(struct rt_mmcsd_queue *q, rt_uint32_t sector, void *buf,
+                                 rt_uint32_t blks, rt_uint8_t dir)
+{
+    struct rt_mmcsd_card *card = q->card;
+    rt_err_t err;
+
+    mmcsd_host_lock(card->host);
+    if (dir && blks >= RT_MMCSD_QUEUE_PRE_ERASE_BLKS && card->card_type == CARD_TYPE_SD)
+    {
+        /* it's only a hint, the write works without it */
+        if (mmcsd_pre_erase(card, blks) == RT_EOK)
+            q->stat.pre_erase++;
+    }
+    err = rt_mmcsd_req_blk(card, sector, buf, blks, dir);
+    mmcsd_host_unlock(card->host);
+
+    q->stat.transfers++;
+    q->stat.blocks += blks;
+
+    return err;
+}
+
+static rt_err_t mmcsd_queue_do(struct rt_mmcsd_queue *q, struct rt_mmcsd_blk_req *head)
+{
+    rt_uint32_t off, blks, left, next;
+    rt_uint8_t *buf;
+    rt_bool_t bounce;
+    rt_err_t err;
+
+    for (off = 0; off < head->total; off += blks)
+    {
+        blks = head->total - off;
+        if (blks > q->max_blks)
+            blks = q->max_blks;
+
+        buf = sg_locate(head, off, &left);
+        /* segments which follow each other in memory are sent as one */
+        while (left < blks && sg_locate(head, off + left, &next) == buf + left * MMCSD_BLK_SIZE)
+            left += next;
+        bounce = left < blks || !dma_direct(q->card->host, buf, blks);
+        if (bounce)
+        {
+            buf = q->bounce;
+            if (head->dir)
+                sg_copy(head, off, buf, blks, RT_TRUE);
+            q->stat.bounced++;
+        }
+
+        err = mmcsd_queue_xfer(q, head->start + off, buf, blks, head->dir);
+        if (err != RT_EOK)
+        {
+            q->stat.errors++;
+            return err;
+        }
+
+        if (bounce && !head->dir)
+            sg_copy(head, off, buf, blks, RT_FALSE);
+    }
+
+    return RT_EOK;
+}
+
+static void mmcsd_queue_entry(void *parameter)
+{
+    struct rt_mmcsd_queue *q = (struct rt_mmcsd_queue *)parameter;
+    struct rt_mmcsd_blk_req *head, *req;
+    rt_list_t *l, *n;
+    rt_err_t err;
+
+    while (1)
+    {
+        rt_sem_take(&q->sem, RT_WAITING_FOREVER);
+
+        rt_mutex_take(&q->lock, RT_WAITING_FOREVER);
+        if (rt_list_isempty(&q->pending))
+        {
+            rt_mutex_release(&q->lock);
+            if (q->quit)
+                break;
+            continue;
+        }
+        head = rt_list_first_entry(&q->pending, struct rt_mmcsd_blk_req, list);
+        rt_list_remove(&head->list);
+        rt_mutex_release(&q->lock);
+
+        err = mmcsd_queue_do(q, head);
+
+        /* the request may be freed in done() */
+        for (l = head->merged.next, n = l->next; l != &head->merged; l = n, n = n->next)
+        {
+            req = rt_list_entry(l, struct rt_mmcsd_blk_req, node);
+            req->err = err;
+            if (req->done)
+                req->done(req);
+        }
+    }
+
+    rt_sem_release(&q->exit_sem);
+}
+
+struct rt_mmcsd_queue *mmcsd_queue_create(struct rt_mmcsd_card *card)
+{
+    struct rt_mmcsd_host *host = card->host;
+    struct rt_mmcsd_queue *q;
+
+    q = (struct rt_mmcsd_queue *)rt_calloc(1, sizeof(struct rt_mmcsd_queue));
+    if (q == RT_NULL)
+        return RT_NULL;
+
+    q->card = card;
+    q->max_blks = RT_MMCSD_QUEUE_MAX_BLKS;
+    if (q->max_blks > host->max_blk_count)
+        q->max_blks = host->max_blk_count;
+    if (!(host->flags & MMCSD_SUP_BIG_DMA) &&
+        q->max_blks > host->max_dma_segs * host->max_seg_size / MMCSD_BLK_SIZE)
+        q->max_blks = host->max_dma_segs * host->max_seg_size / MMCSD_BLK_SIZE;
+    if (q->max_blks == 0)
+        q->max_blks = 1;
+
+    q->bounce = (rt_uint8_t *)rt_malloc_align(q->max_blks * MMCSD_BLK_SIZE, MMCSD_DMA_ALIGN);
+    if (q->bounce == RT_NULL)
+    {
+        LOG_E("mmcsd queue: no memory");
+        rt_free(q);
+        return RT_NULL;
+    }
+
+    rt_list_init(&q->pending);
+    rt_mutex_init(&q->lock, "mmcsd_q", RT_IPC_FLAG_PRIO);
+    rt_sem_init(&q->sem, "mmcsd_q", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&q->exit_sem, "mmcsd_q", 0, RT_IPC_FLAG_FIFO);
+    q->thread = rt_thread_create("mmcsd_q", mmcsd_queue_entry, q,
+                                 RT_MMCSD_QUEUE_STACK_SIZE, RT_MMCSD_QUEUE_THREAD_PRIORITY, 20);
+    if (q->thread == RT_NULL)
+    {
+        rt_sem_detach(&q->exit_sem);
+        rt_sem_detach(&q->sem);
+        rt_mutex_detach(&q->lock);
+        rt_free_align(q->bounce);
+        rt_free(q);
+        return RT_NULL;
+    }
+    rt_thread_startup(q->thread);
+
+    return q;
+}
+
+void mmcsd_queue_delete(struct rt_mmcsd_queue *q)
+{
+    RT_ASSERT(q != RT_NULL);
+
+    /* the queued requests are finished first */
+    rt_mutex_take(&q->lock, RT_WAITING_FOREVER);
+    q->quit = RT_TRUE;
+    rt_mutex_release(&q->lock);
+    rt_sem_release(&q->sem);
+    rt_sem_take(&q->exit_sem, RT_WAITING_FOREVER);
+
+    rt_sem_detach(&q->exit_sem);
+    rt_sem_detach(&q->sem);
+    rt_mutex_detach(&q->lock);
+    rt_free_align(q->bounce);
+    rt_free(q);
+}
+
+rt_err_t mmcsd_queue_submit(struct rt_mmcsd_queue *q, struct rt_mmcsd_blk_req *req)
+{
+    struct rt_mmcsd_blk_req *head;
+    rt_list_t *l;
+    rt_uint32_t i, blks = 0;
+
+    RT_ASSERT(q != RT_NULL);
+    RT_ASSERT(req != RT_NULL);
+
+    for (i = 0; i < req->sg_cnt; i++)
+        blks += req->sg[i].blks;
+    if (blks == 0)
+        return -RT_EINVAL;
+
+    req->blks = blks;
+    req->err = RT_EOK;
+    rt_list_init(&req->merged);
+    rt_list_init(&req->node);
+
+    rt_mutex_take(&q->lock, RT_WAITING_FOREVER);
+    if (q->quit)
+    {
+        rt_mutex_release(&q->lock);
+        return -RT_ERROR;
+    }
+    q->stat.submitted++;
+
+    /* from the newest transfer back to the first one which must stay in front */
+    for (l = q->pending.prev; l != &q->pending; l = l->prev)
+    {
+        head = rt_list_entry(l, struct rt_mmcsd_blk_req, list);
+        if (head->dir == req->dir && head->total + blks <= q->max_blks)
+        {
+            if (head->start + head->total == req->sector)
+            {
+                rt_list_insert_before(&head->merged, &req->node);
+                head->total += blks;
+                q->stat.merged++;
+                rt_mutex_release(&q->lock);
+                return RT_EOK;
+            }
+            if (req->sector + blks == head->start)
+            {
+                rt_list_insert_after(&head->merged, &req->node);
+                head->start = req->sector;
+                head->total += blks;
+                q->stat.merged++;
+                rt_mutex_release(&q->lock);
+                return RT_EOK;
+            }
+        }
+        if ((head->dir || req->dir) && range_overlap(head->start, head->total, req->sector, blks))
+            break;
+    }
+
+    req->start = req->sector;
+    req->total = blks;
+    rt_list_insert_after(&req->merged, &req->node);
+    rt_list_insert_before(&q->pending, &req->list);
+    rt_mutex_release(&q->lock);
+
+    rt_sem_release(&q->sem);
+
+    return RT_EOK;
+}
+
+static void mmcsd_queue_rw_done(struct rt_mmcsd_blk_req *req)
+{
+    rt_completion_done((struct rt_completion *)req->user_data);
+}
+
+rt_err_t mmcsd_queue_rw(struct rt_mmcsd_queue *q, rt_uint32_t sector, void *buf, rt_uint32_t blks, rt_uint8_t dir)
+{
+    struct rt_completion completion;
+    struct rt_mmcsd_blk_req req;
+    struct rt_mmcsd_sg sg;
+    rt_err_t err;
+
+    sg.buf = buf;
+    sg.blks = blks;
+    rt_memset(&req, 0, sizeof(struct rt_mmcsd_blk_req));
+    req.sector = sector;
+    req.sg = &sg;
+    req.sg_cnt = 1;
+    req.dir = dir;
+    req.done = mmcsd_queue_rw_done;
+    req.user_data = &completion;
+    rt_completion_init(&completion);
+
+    err = mmcsd_queue_submit(q, &req);
+    if (err != RT_EOK)
+        return err;
+    rt_completion_wait(&completion, RT_WAITING_FOREVER);
+
+    return req.err;
+}
+
+void mmcsd_queue_get_stat(struct rt_mmcsd_queue *q, struct rt_mmcsd_queue_stat *stat)
+{
+    rt_mutex_take(&q->lock, RT_WAITING_FOREVER);
+    *stat = q->stat;
+    rt_mutex_release(&q->lock);
+}
+
+void mmcsd_queue_reset_stat(struct rt_mmcsd_queue *q)
+{
+    rt_mutex_take(&q->lock, RT_WAITING_FOREVER);
+    rt_memset(&q->stat, 0, sizeof(struct rt_mmcsd_queue_stat));
+    rt_mutex_release(&q->lock);
+}
@@ -0,0 +1,446 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Self test and benchmark of the block request queue on a simulated card.
+ *
+ * The simulated host keeps the card in RAM and delays every command like a
+ * SD card on a 25MHz 4 bit bus. The writes which weren't announced by ACMD23
+ * are slower. The tests check the merging and the ordering of overlapping
+ * requests, the benchmark compares the direct transfers of block_dev.c
+ * (chunks of max_seg_size) with the queue for 4KB random and 1MB sequential
+ * requests.
+ *
+ * msh: mmcsd_queue_bench
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <drivers/mmcsd_core.h>
+#include <drivers/mmcsd_queue.h>
+
+#ifndef RT_MMCSD_QUEUE_THREAD_PRIORITY
+#define RT_MMCSD_QUEUE_THREAD_PRIORITY  20
+#endif
+
+#define SIM_BLOCKS          4096        /* 2MB card */
+#define SIM_CMD_US          100         /* command and response */
+#define SIM_READ_US         200         /* access time of a read */
+#define SIM_BLK_US          41          /* 512 bytes at 25MHz, 4 bit */
+#define SIM_PROG_US         800         /* busy after a write */
+#define SIM_PROG_BLK_US     8           /* programming a block which isn't erased in advance */
+
+#define BENCH_REQS          256
+#define BENCH_REQ_BLKS      8           /* 4KB */
+
+struct sim_card
+{
+    rt_uint8_t *data;
+    rt_bool_t app_cmd;
+    rt_uint32_t erase_count;
+    rt_uint32_t transfers;
+};
+
+static struct sim_card sim;
+static rt_uint8_t *versions;
+static struct rt_semaphore bench_sem;
+static struct rt_semaphore gate_sem;
+ALIGN(MMCSD_DMA_ALIGN)
+static rt_uint8_t gate_buf[512];
+static rt_uint32_t seed;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static void sim_request(struct rt_mmcsd_host *host, struct rt_mmcsd_req *req)
+{
+    struct rt_mmcsd_cmd *cmd = req->cmd;
+    struct rt_mmcsd_data *data = req->data;
+    rt_uint32_t us = SIM_CMD_US;
+    rt_bool_t app_cmd = RT_FALSE;
+
+    cmd->err = RT_EOK;
+    switch (cmd->cmd_code)
+    {
+    case READ_SINGLE_BLOCK:
+    case READ_MULTIPLE_BLOCK:
+    case WRITE_BLOCK:
+    case WRITE_MULTIPLE_BLOCK:
+        if (cmd->arg + data->blks > SIM_BLOCKS)
+        {
+            data->err = -RT_ERROR;
+            break;
+        }
+        if (data->flags & DATA_DIR_READ)
+        {
+            rt_memcpy(data->buf, sim.data + cmd->arg * 512, data->blks * 512);
+            us += SIM_READ_US + data->blks * SIM_BLK_US;
+        }
+        else
+        {
+            rt_memcpy(sim.data + cmd->arg * 512, data->buf, data->blks * 512);
+            us += SIM_PROG_US + data->blks * SIM_BLK_US;
+            if (sim.erase_count < data->blks)
+                us += data->blks * SIM_PROG_BLK_US;
+            sim.erase_count = 0;
+        }
+        sim.transfers++;
+        break;
+    case SEND_STATUS:
+        cmd->resp[0] = R1_READY_FOR_DATA | (4 << 9);    /* transfer state */
+        break;
+    case APP_CMD:
+        cmd->resp[0] = R1_APP_CMD;
+        app_cmd = RT_TRUE;
+        break;
+    case SD_APP_SET_WR_BLK_ERASE_COUNT:
+        if (sim.app_cmd)
+            sim.erase_count = cmd->arg;
+        else
+            cmd->err = -RT_ERROR;
+        break;
+    default:
+        cmd->err = -RT_ERROR;
+        break;
+    }
+    sim.app_cmd = app_cmd;
+    if (req->stop != RT_NULL)
+        us += SIM_CMD_US;
+
+    rt_hw_us_delay(us);
+    mmcsd_req_complete(host);
+}
+
+static const struct rt_mmcsd_host_ops sim_ops =
+{
+    sim_request,
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+};
+
+static void pattern_fill(rt_uint32_t *buf, rt_uint32_t sector, rt_uint32_t blks)
+{
+    rt_uint32_t i, j, v;
+
+    for (i = 0; i < blks; i++, sector++)
+    {
+        v = sector * 2654435761u + versions[sector];
+        for (j = 0; j < 128; j++)
+            *buf++ = v + j;
+    }
+}
+
+static rt_bool_t pattern_check(const rt_uint32_t *buf, rt_uint32_t sector, rt_uint32_t blks)
+{
+    rt_uint32_t i, j, v;
+
+    for (i = 0; i < blks; i++, sector++)
+    {
+        v = sector * 2654435761u + versions[sector];
+        for (j = 0; j < 128; j++)
+        {
+            if (*buf++ != v + j)
+            {
+                rt_kprintf("block %d: wrong data\n", sector);
+                return RT_FALSE;
+            }
+        }
+    }
+    return RT_TRUE;
+}
+
+static void bench_done(struct rt_mmcsd_blk_req *req)
+{
+    rt_sem_release(&bench_sem);
+}
+
+struct bench_io
+{
+    struct rt_mmcsd_blk_req req;
+    struct rt_mmcsd_sg sg;
+};
+
+static void bench_io_init(struct bench_io *io, rt_uint32_t sector, void *buf, rt_uint32_t blks, rt_uint8_t dir)
+{
+    rt_memset(io, 0, sizeof(struct bench_io));
+    io->sg.buf = buf;
+    io->sg.blks = blks;
+    io->req.sector = sector;
+    io->req.sg = &io->sg;
+    io->req.sg_cnt = 1;
+    io->req.dir = dir;
+    io->req.done = bench_done;
+}
+
+/* the queue thread waits in the done() of the gate until the batch is queued */
+static void gate_done(struct rt_mmcsd_blk_req *req)
+{
+    rt_sem_release(&bench_sem);
+    rt_sem_take(&gate_sem, RT_WAITING_FOREVER);
+}
+
+/*
+ * submit the requests and wait for them. A batch is queued while the queue
+ * thread is held by a gate request, so the queue thread takes the first
+ * request only after the last one was merged, whatever the scheduling.
+ */
+static rt_bool_t bench_submit(struct rt_mmcsd_queue *q, struct bench_io *io, rt_uint32_t cnt, rt_bool_t batch)
+{
+    struct bench_io gate;
+    rt_uint32_t i;
+    rt_bool_t ok = RT_TRUE;
+
+    if (batch)
+    {
+        bench_io_init(&gate, SIM_BLOCKS - 1, gate_buf, 1, 0);
+        gate.req.done = gate_done;
+        if (mmcsd_queue_submit(q, &gate.req) != RT_EOK)
+            return RT_FALSE;
+        rt_sem_take(&bench_sem, RT_WAITING_FOREVER);
+        /* the gate isn't part of the batch */
+        mmcsd_queue_reset_stat(q);
+    }
+    for (i = 0; i < cnt && ok; i++)
+        ok = mmcsd_queue_submit(q, &io[i].req) == RT_EOK;
+    if (batch)
+        rt_sem_release(&gate_sem);
+    if (!ok)
+        return RT_FALSE;
+    for (i = 0; i < cnt; i++)
+    {
+        rt_sem_take(&bench_sem, RT_WAITING_FOREVER);
+        if (io[i].req.err != RT_EOK)
+            ok = RT_FALSE;
+    }
+    return ok;
+}
+
+static rt_bool_t test_merge(struct rt_mmcsd_queue *q, struct bench_io *io, rt_uint8_t *buf)
+{
+    struct rt_mmcsd_queue_stat stat;
+    rt_uint32_t i;
+
+    /* 16 single block writes in reverse order: one transfer */
+    for (i = 0; i < 16; i++)
+    {
+        versions[100 + 15 - i]++;
+        pattern_fill((rt_uint32_t *)(buf + i * 512), 100 + 15 - i, 1);
+        bench_io_init(&io[i], 100 + 15 - i, buf + i * 512, 1, 1);
+    }
+    if (!bench_submit(q, io, 16, RT_TRUE))
+        return RT_FALSE;
+    mmcsd_queue_get_stat(q, &stat);
+    if (stat.transfers != 1 || stat.merged != 15 || stat.bounced != 1)
+    {
+        rt_kprintf("merge: %d transfers, %d merged\n", stat.transfers, stat.merged);
+        return RT_FALSE;
+    }
+    return pattern_check((rt_uint32_t *)(sim.data + 100 * 512), 100, 16);
+}
+
+static rt_bool_t test_order(struct rt_mmcsd_queue *q, struct bench_io *io, rt_uint8_t *buf)
+{
+    struct rt_mmcsd_queue_stat stat;
+    rt_uint8_t *w1 = buf, *r1 = buf + 4096, *w2 = buf + 8192, *r2 = buf + 12288, *w3 = buf + 16384;
+    rt_uint8_t v1, v2, v308;
+
+    /* write, read, write, read of the same blocks: neither reordered nor merged */
+    versions[200]++;
+    pattern_fill((rt_uint32_t *)w1, 200, 8);
+    v1 = versions[200];
+    versions[200]++;
+    pattern_fill((rt_uint32_t *)w2, 200, 8);
+    v2 = versions[200];
+    versions[208]++;
+    pattern_fill((rt_uint32_t *)w3, 208, 1);
+    bench_io_init(&io[0], 200, w1, 8, 1);
+    bench_io_init(&io[1], 200, r1, 8, 0);
+    bench_io_init(&io[2], 200, w2, 8, 1);
+    bench_io_init(&io[3], 200, r2, 8, 0);
+    /* joins the second write, the read behind it doesn't overlap */
+    bench_io_init(&io[4], 208, w3, 1, 1);
+    if (!bench_submit(q, io, 5, RT_TRUE))
+        return RT_FALSE;
+    mmcsd_queue_get_stat(q, &stat);
+    if (stat.transfers != 4 || stat.merged != 1)
+    {
+        rt_kprintf("order: %d transfers, %d merged\n", stat.transfers, stat.merged);
+        return RT_FALSE;
+    }
+    versions[200] = v1;
+    if (!pattern_check((rt_uint32_t *)r1, 200, 1))
+        return RT_FALSE;
+    versions[200] = v2;
+    if (!pattern_check((rt_uint32_t *)r2, 200, 1) || !pattern_check((rt_uint32_t *)(sim.data + 208 * 512), 208, 1))
+        return RT_FALSE;
+
+    /* the write of block 308 can't join the first one, it would jump over the read */
+    pattern_fill((rt_uint32_t *)w1, 300, 8);
+    v308 = versions[308];
+    versions[308]++;
+    pattern_fill((rt_uint32_t *)w3, 308, 1);
+    bench_io_init(&io[0], 300, w1, 8, 1);
+    bench_io_init(&io[1], 304, r1, 8, 0);
+    bench_io_init(&io[2], 308, w3, 1, 1);
+    if (!bench_submit(q, io, 3, RT_TRUE))
+        return RT_FALSE;
+    mmcsd_queue_get_stat(q, &stat);
+    if (stat.transfers != 3 || stat.merged != 0)
+    {
+        rt_kprintf("order: %d transfers, %d merged\n", stat.transfers, stat.merged);
+        return RT_FALSE;
+    }
+    versions[308] = v308;
+    if (!pattern_check((rt_uint32_t *)r1, 304, 8))
+        return RT_FALSE;
+    versions[308]++;
+
+    return pattern_check((rt_uint32_t *)(sim.data + 300 * 512), 300, 9);
+}
+
+static void bench_report(const char *name, const char *mode, rt_tick_t tick, rt_uint32_t bytes, rt_bool_t ok)
+{
+    rt_uint32_t ms = tick * 1000 / RT_TICK_PER_SECOND;
+
+    rt_kprintf("%-12s %-6s %5d ms %6d KB/s, %4d commands, %s\n", name, mode, ms,
+               ms ? bytes / ms * 1000 / 1024 : 0, sim.transfers, ok ? "PASS" : "FAIL");
+}
+
+static void bench_run(struct rt_mmcsd_card *card, struct rt_mmcsd_queue *q, struct bench_io *io,
+                      rt_uint8_t *buf, const char *name, rt_bool_t random, rt_uint8_t dir)
+{
+    rt_uint32_t i, sector[BENCH_REQS];
+    rt_uint32_t max_blks = card->host->max_seg_size / 512;
+    rt_uint32_t j, n;
+    rt_tick_t tick;
+    rt_bool_t ok;
+
+    seed = 1;
+    for (i = 0; i < BENCH_REQS; i++)
+    {
+        sector[i] = random ? bench_rand() % (SIM_BLOCKS / BENCH_REQ_BLKS) * BENCH_REQ_BLKS : i * BENCH_REQ_BLKS;
+        if (dir)
+        {
+            versions[sector[i]]++;
+            pattern_fill((rt_uint32_t *)(buf + i * BENCH_REQ_BLKS * 512), sector[i], BENCH_REQ_BLKS);
+        }
+    }
+
+    /* without the queue, like block_dev.c: one command per max_seg_size */
+    sim.transfers = 0;
+    ok = RT_TRUE;
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_REQS && ok; i++)
+    {
+        for (j = 0; j < BENCH_REQ_BLKS && ok; j += n)
+        {
+            n = BENCH_REQ_BLKS - j < max_blks ? BENCH_REQ_BLKS - j : max_blks;
+            ok = rt_mmcsd_req_blk(card, sector[i] + j, buf + (i * BENCH_REQ_BLKS + j) * 512, n, dir) == RT_EOK;
+        }
+    }
+    tick = rt_tick_get() - tick;
+    for (i = 0; i < BENCH_REQS && ok && !dir; i++)
+        ok = pattern_check((rt_uint32_t *)(buf + i * BENCH_REQ_BLKS * 512), sector[i], BENCH_REQ_BLKS);
+    bench_report(name, "direct", tick, BENCH_REQS * BENCH_REQ_BLKS * 512, ok);
+
+    if (!dir)
+        rt_memset(buf, 0, BENCH_REQS * BENCH_REQ_BLKS * 512);
+    for (i = 0; i < BENCH_REQS; i++)
+        bench_io_init(&io[i], sector[i], buf + i * BENCH_REQ_BLKS * 512, BENCH_REQ_BLKS, dir);
+    sim.transfers = 0;
+    tick = rt_tick_get();
+    ok = bench_submit(q, io, BENCH_REQS, RT_FALSE);
+    tick = rt_tick_get() - tick;
+    for (i = 0; i < BENCH_REQS && ok && !dir; i++)
+        ok = pattern_check((rt_uint32_t *)(buf + i * BENCH_REQ_BLKS * 512), sector[i], BENCH_REQ_BLKS);
+    bench_report(name, "queue", tick, BENCH_REQS * BENCH_REQ_BLKS * 512, ok);
+}
+
+static int mmcsd_queue_bench(void)
+{
+    static struct rt_mmcsd_card card;
+    struct rt_mmcsd_queue_stat stat;
+    struct rt_mmcsd_host *host;
+    struct rt_mmcsd_queue *q = RT_NULL;
+    struct bench_io *io;
+    rt_uint8_t *buf;
+    rt_thread_t self = rt_thread_self();
+    rt_uint8_t prio, old_prio = self->current_priority;
+
+    host = mmcsd_alloc_host();
+    sim.data = (rt_uint8_t *)rt_malloc(SIM_BLOCKS * 512);
+    versions = (rt_uint8_t *)rt_calloc(1, SIM_BLOCKS);
+    io = (struct bench_io *)rt_malloc(BENCH_REQS * sizeof(struct bench_io));
+    buf = (rt_uint8_t *)rt_malloc_align(BENCH_REQS * BENCH_REQ_BLKS * 512, MMCSD_DMA_ALIGN);
+    if (host == RT_NULL || sim.data == RT_NULL || versions == RT_NULL || io == RT_NULL || buf == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        goto _exit;
+    }
+
+    /* the same buffer limits as drv_sdio.c */
+    host->ops = &sim_ops;
+    host->flags = MMCSD_BUSWIDTH_4 | MMCSD_MUTBLKWRITE | MMCSD_SUP_BIG_DMA;
+    host->max_seg_size = 4096;
+    host->max_blk_count = 512;
+    host->io_cfg.clock = 25000000;  /* the data timeout divides by it */
+    rt_memset(&card, 0, sizeof(card));
+    card.host = host;
+    card.rca = 1;
+    card.card_type = CARD_TYPE_SD;
+    card.flags = CARD_FLAG_SDHC;
+    host->card = &card;
+    pattern_fill((rt_uint32_t *)sim.data, 0, SIM_BLOCKS);
+    rt_sem_init(&bench_sem, "mmcsd_b", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&gate_sem, "mmcsd_g", 0, RT_IPC_FLAG_FIFO);
+
+    q = mmcsd_queue_create(&card);
+    if (q == RT_NULL)
+        goto _exit;
+
+    /* submit faster than the queue thread sends, like several callers */
+    prio = RT_MMCSD_QUEUE_THREAD_PRIORITY > 0 ? RT_MMCSD_QUEUE_THREAD_PRIORITY - 1 : 0;
+    rt_thread_control(self, RT_THREAD_CTRL_CHANGE_PRIORITY, &prio);
+
+    rt_kprintf("merge        %s\n", test_merge(q, io, buf) ? "PASS" : "FAIL");
+    rt_kprintf("order        %s\n", test_order(q, io, buf) ? "PASS" : "FAIL");
+
+    mmcsd_queue_reset_stat(q);
+    bench_run(&card, q, io, buf, "4K rand rd", RT_TRUE, 0);
+    bench_run(&card, q, io, buf, "4K rand wr", RT_TRUE, 1);
+    bench_run(&card, q, io, buf, "1M seq rd", RT_FALSE, 0);
+    bench_run(&card, q, io, buf, "1M seq wr", RT_FALSE, 1);
+
+    mmcsd_queue_get_stat(q, &stat);
+    rt_kprintf("queue: %d requests, %d merged, %d transfers, %d bounced, %d pre-erased\n",
+               stat.submitted, stat.merged, stat.transfers, stat.bounced, stat.pre_erase);
+
+    rt_thread_control(self, RT_THREAD_CTRL_CHANGE_PRIORITY, &old_prio);
+
+_exit:
+    if (q != RT_NULL)
+        mmcsd_queue_delete(q);
+    rt_sem_detach(&bench_sem);
+    rt_sem_detach(&gate_sem);
+    if (host != RT_NULL)
+        mmcsd_free_host(host);
+    rt_free(sim.data);
+    rt_free(versions);
+    rt_free(io);
+    if (buf != RT_NULL)
+        rt_free_align(buf);
+
+    return 0;
+}
+MSH_CMD_EXPORT(mmcsd_queue_bench, SD block request queue test and benchmark on a simulated card);
@@ -0,0 +1,665 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Test and benchmark of the serial_v2 rings.
+ *
+ * A simulated UART "sersim" receives numbered bytes, with a circular DMA
+ * reporting the half transfer, transfer complete and IDLE line events like
+ * drv_usart_v2.c or with an interrupt per byte. A reader thread of higher
+ * priority is woken by rx_indicate and checks the sequence with
+ * rt_device_read() and with the zero-copy rt_serial_rx_peek(). Then the
+ * overflow of the ring without a reader, a late DMA event, the chaining of
+ * non-blocking writes into DMA transfers and a blocking write are checked.
+ * Last the time and the notifications of the interrupt and the DMA
+ * reception of the same data are printed.
+ *
+ * msh: serial_bench [KB]
+ */
+
+#include <rtthread.h>
+
+#ifdef RT_SERIAL_USING_BENCH
+
+#include <stdlib.h>
+#include <rthw.h>
+#include <rtdevice.h>
+
+#define BENCH_NAME          "sersim"
+#define BENCH_RX_BUFSZ      256
+#define BENCH_TX_BUFSZ      256
+#define BENCH_FRAMES        300
+#define BENCH_FRAME_MAX     200
+#define BENCH_FRAME_LEN     64          /* of the benchmark */
+#define BENCH_KBYTES        64
+#define BENCH_TX_BYTES      4096
+#define BENCH_TX_CHUNK      100
+#define BENCH_BLOCK_BYTES   1000
+#define BENCH_STACK_SIZE    2048
+
+struct serial_sim
+{
+    struct rt_serial_device serial;
+    rt_bool_t dma;                      /* RX with the circular DMA, else an interrupt per byte */
+    rt_size_t dma_index;                /* where the DMA writes next */
+    rt_size_t last_index;               /* of rt_serial_dma_rx_len() */
+    rt_uint32_t seq;                    /* of the next received byte */
+
+    /* the TX DMA is a thread copying to the sink */
+    struct rt_semaphore tx_sem;
+    struct rt_completion tx_exit;
+    rt_uint8_t *tx_buf;
+    rt_size_t tx_size;
+    rt_bool_t tx_stop;
+    rt_uint8_t *sink;
+    rt_size_t sink_len;
+};
+
+struct bench_reader
+{
+    struct rt_semaphore rx_sem;
+    struct rt_completion done;
+    rt_uint32_t seq;                    /* of the next byte to read */
+    rt_uint32_t bytes;
+    rt_bool_t zero_copy;
+    rt_bool_t error;
+    rt_bool_t stop;
+};
+
+static struct serial_sim sim;
+static struct bench_reader reader;
+static struct rt_semaphore tx_space;
+static rt_bool_t sim_registered;
+
+static rt_uint8_t bench_byte(rt_uint32_t seq)
+{
+    /* a lap of the ring changes the byte */
+    return (rt_uint8_t)(seq * 7 + (seq >> 8));
+}
+
+static rt_err_t sim_configure(struct rt_serial_device *serial, struct serial_configure *cfg)
+{
+    return RT_EOK;
+}
+
+static rt_err_t sim_control(struct rt_serial_device *serial, int cmd, void *arg)
+{
+    rt_ubase_t flag = (rt_ubase_t)arg;
+
+    switch (cmd)
+    {
+    case RT_DEVICE_CTRL_CONFIG:
+        if (flag & (RT_DEVICE_FLAG_RX_BLOCKING | RT_DEVICE_FLAG_RX_NON_BLOCKING))
+        {
+            /* the DMA starts at the beginning of the ring */
+            sim.dma_index = 0;
+            sim.last_index = 0;
+        }
+        break;
+    case RT_DEVICE_CHECK_OPTMODE:
+        return RT_SERIAL_TX_BLOCKING_NO_BUFFER;
+    default:
+        break;
+    }
+
+    return RT_EOK;
+}
+
+static int sim_putc(struct rt_serial_device *serial, char c)
+{
+    if (sim.sink_len < BENCH_TX_BYTES)
+    {
+        sim.sink[sim.sink_len++] = c;
+    }
+    return 1;
+}
+
+static int sim_getc(struct rt_serial_device *serial)
+{
+    return -1;
+}
+
+static rt_size_t sim_transmit(struct rt_serial_device *serial, rt_uint8_t *buf, rt_size_t size, rt_uint32_t tx_flag)
+{
+    sim.tx_buf = buf;
+    sim.tx_size = size;
+    rt_sem_release(&sim.tx_sem);
+    return size;
+}
+
+static const struct rt_uart_ops sim_ops =
+{
+    sim_configure,
+    sim_control,
+    sim_putc,
+    sim_getc,
+    sim_transmit,
+};
+
+static void sim_isr(int event)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    rt_hw_serial_isr(&sim.serial, event);
+    rt_hw_interrupt_enable(level);
+}
+
+static void sim_tx_entry(void *parameter)
+{
+    rt_size_t size;
+
+    while (1)
+    {
+        rt_sem_take(&sim.tx_sem, RT_WAITING_FOREVER);
+        if (sim.tx_stop)
+        {
+            break;
+        }
+
+        size = RT_MIN(sim.tx_size, BENCH_TX_BYTES - sim.sink_len);
+        rt_memcpy(sim.sink + sim.sink_len, sim.tx_buf, size);
+        sim.sink_len += size;
+        sim_isr(RT_SERIAL_EVENT_TX_DMADONE);
+    }
+    rt_completion_done(&sim.tx_exit);
+}
+
+/* the half transfer, transfer complete or IDLE line interrupt of the RX DMA */
+static void sim_dma_event(void)
+{
+    struct rt_serial_rx_fifo *rx_fifo = (struct rt_serial_rx_fifo *)sim.serial.serial_rx;
+    rt_size_t size = rx_fifo->rb.buffer_size;
+    rt_size_t len;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    len = rt_serial_dma_rx_len(size, &sim.last_index, size - sim.dma_index);
+    if (len)
+    {
+        rt_hw_serial_isr(&sim.serial, RT_SERIAL_EVENT_RX_DMADONE | (len << 8));
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+/* the UART receives a frame of `len` bytes and the line goes idle */
+static void sim_receive(rt_size_t len)
+{
+    struct rt_serial_rx_fifo *rx_fifo = (struct rt_serial_rx_fifo *)sim.serial.serial_rx;
+    rt_size_t size = rx_fifo->rb.buffer_size;
+    rt_base_t level;
+
+    while (len--)
+    {
+        if (sim.dma)
+        {
+            rx_fifo->rb.buffer_ptr[sim.dma_index++] = bench_byte(sim.seq++);
+            if (sim.dma_index == size)
+            {
+                sim.dma_index = 0;
+            }
+            if (sim.dma_index == size / 2 || sim.dma_index == 0)
+            {
+                sim_dma_event();
+            }
+        }
+        else
+        {
+            level = rt_hw_interrupt_disable();
+            rt_spsc_ring_putchar(&rx_fifo->rb, bench_byte(sim.seq++));
+            rt_hw_serial_isr(&sim.serial, RT_SERIAL_EVENT_RX_IND);
+            rt_hw_interrupt_enable(level);
+        }
+    }
+
+    if (sim.dma)
+    {
+        sim_dma_event();
+    }
+}
+
+/* the gap to the next frame, until the reader took the data */
+static void sim_gap(void)
+{
+    struct rt_serial_rx_fifo *rx_fifo = (struct rt_serial_rx_fifo *)sim.serial.serial_rx;
+    int i;
+
+    for (i = 0; i < 100 && rt_spsc_ring_data_len(&rx_fifo->rb) > 0; i++)
+    {
+        rt_thread_mdelay(1);
+    }
+}
+
+static rt_err_t sim_open(rt_bool_t dma, rt_uint16_t oflag)
+{
+    rt_device_t dev = &sim.serial.parent;
+
+    if (dev->ref_count)
+    {
+        rt_device_close(dev);
+    }
+
+    sim.dma = dma;
+    sim.seq = 0;
+    sim.sink_len = 0;
+    if (rt_device_open(dev, RT_DEVICE_OFLAG_RDWR | oflag) != RT_EOK || sim.serial.serial_rx == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+    rt_device_control(dev, RT_SERIAL_CTRL_RESET_STAT, RT_NULL);
+
+    return RT_EOK;
+}
+
+static struct rt_serial_stat sim_stat(void)
+{
+    struct rt_serial_stat stat;
+
+    rt_device_control(&sim.serial.parent, RT_SERIAL_CTRL_GET_STAT, &stat);
+    return stat;
+}
+
+static void bench_check_data(const rt_uint8_t *data, rt_size_t len)
+{
+    rt_size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        if (data[i] != bench_byte(reader.seq + i))
+        {
+            reader.error = RT_TRUE;
+            break;
+        }
+    }
+    reader.seq += len;
+    reader.bytes += len;
+}
+
+static rt_size_t bench_read(void)
+{
+    rt_device_t dev = &sim.serial.parent;
+    rt_uint8_t buf[64], *ptr;
+    rt_size_t len;
+
+    if (reader.zero_copy)
+    {
+        len = rt_serial_rx_peek(dev, &ptr);
+        if (len)
+        {
+            bench_check_data(ptr, len);
+            rt_serial_rx_release(dev, len);
+        }
+    }
+    else
+    {
+        len = rt_device_read(dev, 0, buf, sizeof(buf));
+        bench_check_data(buf, len);
+    }
+
+    return len;
+}
+
+static rt_err_t bench_rx_ind(rt_device_t dev, rt_size_t size)
+{
+    rt_sem_release(&reader.rx_sem);
+    return RT_EOK;
+}
+
+static rt_err_t bench_tx_done(rt_device_t dev, void *buffer)
+{
+    rt_sem_release(&tx_space);
+    return RT_EOK;
+}
+
+static void bench_reader_entry(void *parameter)
+{
+    while (1)
+    {
+        rt_sem_take(&reader.rx_sem, RT_WAITING_FOREVER);
+        if (reader.stop)
+        {
+            break;
+        }
+        while (bench_read() > 0);
+    }
+    rt_completion_done(&reader.done);
+}
+
+static rt_bool_t bench_reader_start(rt_bool_t zero_copy)
+{
+    rt_thread_t thread;
+
+    reader.seq = 0;
+    reader.bytes = 0;
+    reader.zero_copy = zero_copy;
+    reader.error = RT_FALSE;
+    reader.stop = RT_FALSE;
+    rt_sem_control(&reader.rx_sem, RT_IPC_CMD_RESET, (void *)0);
+    rt_completion_init(&reader.done);
+
+    thread = rt_thread_create("serread", bench_reader_entry, RT_NULL, BENCH_STACK_SIZE,
+                              rt_thread_self()->current_priority - 1, 10);
+    if (thread == RT_NULL)
+    {
+        return RT_FALSE;
+    }
+    rt_thread_startup(thread);
+    sim.serial.parent.rx_indicate = bench_rx_ind;
+
+    return RT_TRUE;
+}
+
+/* wait for `bytes` to be read and stop the reader */
+static void bench_reader_stop(rt_uint32_t bytes)
+{
+    int i;
+
+    for (i = 0; i < 1000 && reader.bytes < bytes; i++)
+    {
+        rt_thread_mdelay(1);
+    }
+    sim.serial.parent.rx_indicate = RT_NULL;
+    reader.stop = RT_TRUE;
+    rt_sem_release(&reader.rx_sem);
+    rt_completion_wait(&reader.done, RT_WAITING_FOREVER);
+}
+
+static rt_bool_t bench_check(const char *name, rt_bool_t ok)
+{
+    rt_kprintf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/* frames of random length read by the reader thread */
+static rt_bool_t bench_frames(const char *name, rt_bool_t dma, rt_bool_t zero_copy)
+{
+    struct rt_serial_stat stat;
+    rt_uint32_t total = 0;
+    int i;
+
+    if (sim_open(dma, 0) != RT_EOK || !bench_reader_start(zero_copy))
+    {
+        return bench_check(name, RT_FALSE);
+    }
+
+    for (i = 0; i < BENCH_FRAMES; i++)
+    {
+        rt_size_t len = rand() % BENCH_FRAME_MAX + 1;
+
+        sim_receive(len);
+        total += len;
+        sim_gap();
+    }
+    bench_reader_stop(total);
+
+    stat = sim_stat();
+    return bench_check(name, !reader.error && reader.bytes == total && stat.rx_bytes == total &&
+                       stat.rx_dropped == 0 && stat.rx_events > 0 && stat.rx_reads > 0);
+}
+
+/* without a reader the DMA overwrites the oldest data */
+static rt_bool_t bench_overflow(void)
+{
+    struct rt_serial_rx_fifo *rx_fifo;
+    struct rt_serial_stat stat;
+    rt_uint32_t total = 0, size;
+
+    if (sim_open(RT_TRUE, 0) != RT_EOK)
+    {
+        return bench_check("DMA overflow", RT_FALSE);
+    }
+    rx_fifo = (struct rt_serial_rx_fifo *)sim.serial.serial_rx;
+    size = rx_fifo->rb.buffer_size;
+
+    while (total < 3 * size + 17)
+    {
+        sim_receive(100);
+        total += 100;
+    }
+
+    /* the newest data of a full ring is left */
+    reader.seq = total - size;
+    reader.bytes = 0;
+    reader.zero_copy = RT_FALSE;
+    reader.error = RT_FALSE;
+    while (bench_read() > 0);
+
+    stat = sim_stat();
+    return bench_check("DMA overflow", !reader.error && reader.bytes == size &&
+                       stat.rx_bytes == total && stat.rx_dropped == total - size);
+}
+
+/* an event without new data, e.g. the TC after the IDLE line at the end of the ring */
+static rt_bool_t bench_late_event(void)
+{
+    struct rt_serial_stat stat;
+    rt_size_t last = 200;
+    rt_bool_t ok;
+
+    ok = rt_serial_dma_rx_len(BENCH_RX_BUFSZ, &last, BENCH_RX_BUFSZ - 10) == BENCH_RX_BUFSZ - 200 + 10 &&
+         rt_serial_dma_rx_len(BENCH_RX_BUFSZ, &last, BENCH_RX_BUFSZ - 10) == 0;
+
+    if (sim_open(RT_TRUE, 0) != RT_EOK)
+    {
+        return bench_check("DMA late event", RT_FALSE);
+    }
+    reader.seq = 0;
+    reader.bytes = 0;
+    reader.zero_copy = RT_TRUE;
+    reader.error = RT_FALSE;
+
+    sim_receive(200);
+    sim_dma_event();
+    sim_dma_event();
+    ok = ok && sim_stat().rx_bytes == 200;
+    while (bench_read() > 0);
+
+    /* across the end of the ring */
+    sim_receive(BENCH_RX_BUFSZ - 200 + 44);
+    sim_dma_event();
+    while (bench_read() > 0);
+
+    stat = sim_stat();
+    return bench_check("DMA late event", ok && !reader.error && reader.bytes == BENCH_RX_BUFSZ + 44 &&
+                       stat.rx_bytes == BENCH_RX_BUFSZ + 44 && stat.rx_dropped == 0);
+}
+
+/* non-blocking writes are chained into DMA transfers of the TX ring */
+static rt_bool_t bench_tx_chain(void)
+{
+    rt_device_t dev = &sim.serial.parent;
+    struct rt_serial_stat stat;
+    rt_uint8_t buf[BENCH_TX_CHUNK];
+    rt_uint32_t seq = 0, writes = 0;
+    rt_size_t len, i, done;
+    rt_bool_t ok = RT_TRUE;
+
+    if (sim_open(RT_TRUE, RT_DEVICE_FLAG_TX_NON_BLOCKING) != RT_EOK)
+    {
+        return bench_check("TX chaining", RT_FALSE);
+    }
+    rt_sem_control(&tx_space, RT_IPC_CMD_RESET, (void *)0);
+    dev->tx_complete = bench_tx_done;
+
+    while (ok && seq < BENCH_TX_BYTES)
+    {
+        len = rand() % BENCH_TX_CHUNK + 1;
+        len = RT_MIN(len, BENCH_TX_BYTES - seq);
+        for (i = 0; i < len; i++)
+        {
+            buf[i] = bench_byte(seq + i);
+        }
+        for (done = 0; done < len;)
+        {
+            done += rt_device_write(dev, 0, buf + done, len - done);
+            writes++;
+            if (done < len && rt_sem_take(&tx_space, rt_tick_from_millisecond(100)) != RT_EOK)
+            {
+                ok = RT_FALSE;
+                break;
+            }
+        }
+        seq += len;
+    }
+
+    for (i = 0; i < 100 && sim.sink_len < BENCH_TX_BYTES; i++)
+    {
+        rt_thread_mdelay(1);
+    }
+    for (i = 0; ok && i < BENCH_TX_BYTES; i++)
+    {
+        ok = sim.sink_len == BENCH_TX_BYTES && sim.sink[i] == bench_byte(i);
+    }
+
+    stat = sim_stat();
+    rt_kprintf("%u writes, %u DMA transfers\n", writes, stat.tx_transfers);
+    return bench_check("TX chaining", ok && stat.tx_bytes == BENCH_TX_BYTES &&
+                       stat.tx_transfers > 0 && stat.tx_transfers < writes);
+}
+
+/* a blocking write waits for its DMA transfer */
+static rt_bool_t bench_tx_blocking(void)
+{
+    rt_size_t i;
+    rt_bool_t ok;
+
+    if (sim_open(RT_TRUE, 0) != RT_EOK)
+    {
+        return bench_check("TX blocking", RT_FALSE);
+    }
+    /* sent from the end of the sink */
+    for (i = 0; i < BENCH_BLOCK_BYTES; i++)
+    {
+        sim.sink[BENCH_TX_BYTES - BENCH_BLOCK_BYTES + i] = bench_byte(i);
+    }
+
+    ok = rt_device_write(&sim.serial.parent, 0, sim.sink + BENCH_TX_BYTES - BENCH_BLOCK_BYTES,
+                         BENCH_BLOCK_BYTES) == BENCH_BLOCK_BYTES;
+    for (i = 0; ok && i < BENCH_BLOCK_BYTES; i++)
+    {
+        ok = sim.sink_len == BENCH_BLOCK_BYTES && sim.sink[i] == bench_byte(i);
+    }
+
+    return bench_check("TX blocking", ok && sim_stat().tx_transfers == 1);
+}
+
+static void bench_time(const char *name, rt_bool_t dma, rt_uint32_t kbytes)
+{
+    struct rt_serial_stat stat;
+    rt_uint32_t total = kbytes * 1024, sent;
+    rt_tick_t tick;
+
+    if (sim_open(dma, 0) != RT_EOK || !bench_reader_start(RT_FALSE))
+    {
+        return;
+    }
+
+    tick = rt_tick_get();
+    for (sent = 0; sent < total; sent += BENCH_FRAME_LEN)
+    {
+        sim_receive(BENCH_FRAME_LEN);
+        sim_gap();
+    }
+    bench_reader_stop(total);
+    tick = rt_tick_get() - tick;
+
+    stat = sim_stat();
+    rt_kprintf("%-10s %7u events, %5u per KB, %6u us per KB, %u dropped%s\n", name,
+               stat.rx_events, stat.rx_events / kbytes,
+               tick * (1000000 / RT_TICK_PER_SECOND) / kbytes, stat.rx_dropped,
+               reader.error || reader.bytes != total ? ", BAD DATA" : "");
+}
+
+static int serial_bench(int argc, char **argv)
+{
+    rt_thread_t thread;
+    rt_uint32_t kbytes = BENCH_KBYTES;
+    rt_bool_t ok = RT_TRUE;
+
+    if (argc > 1)
+    {
+        kbytes = atoi(argv[1]);
+        if (kbytes == 0)
+        {
+            rt_kprintf("usage: serial_bench [KB]\n");
+            return -1;
+        }
+    }
+
+    if (!sim_registered)
+    {
+        struct serial_configure config = RT_SERIAL_CONFIG_DEFAULT;
+
+        config.rx_bufsz = BENCH_RX_BUFSZ;
+        config.tx_bufsz = BENCH_TX_BUFSZ;
+        sim.serial.ops = &sim_ops;
+        sim.serial.config = config;
+        if (rt_hw_serial_register(&sim.serial, BENCH_NAME, RT_DEVICE_FLAG_RDWR, RT_NULL) != RT_EOK)
+        {
+            rt_kprintf("no device\n");
+            return -1;
+        }
+        sim_registered = RT_TRUE;
+    }
+
+    sim.sink = (rt_uint8_t *)rt_malloc(BENCH_TX_BYTES);
+    if (sim.sink == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        return -1;
+    }
+    rt_sem_init(&sim.tx_sem, "sertx", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&reader.rx_sem, "serrx", 0, RT_IPC_FLAG_FIFO);
+    rt_sem_init(&tx_space, "serspc", 0, RT_IPC_FLAG_FIFO);
+    rt_completion_init(&sim.tx_exit);
+    sim.tx_stop = RT_FALSE;
+
+    /* below the writer, the TX ring fills up while the DMA is busy */
+    thread = rt_thread_create("serdma", sim_tx_entry, RT_NULL, BENCH_STACK_SIZE,
+                              rt_thread_self()->current_priority + 1, 10);
+    if (thread == RT_NULL)
+    {
+        rt_kprintf("no thread\n");
+        goto __exit;
+    }
+    rt_thread_startup(thread);
+
+    ok = bench_frames("DMA read", RT_TRUE, RT_FALSE) && ok;
+    ok = bench_frames("DMA zero-copy read", RT_TRUE, RT_TRUE) && ok;
+    ok = bench_frames("interrupt read", RT_FALSE, RT_FALSE) && ok;
+    ok = bench_overflow() && ok;
+    ok = bench_late_event() && ok;
+    ok = bench_tx_chain() && ok;
+    ok = bench_tx_blocking() && ok;
+
+    bench_time("interrupt", RT_FALSE, kbytes);
+    bench_time("DMA", RT_TRUE, kbytes);
+
+    sim.tx_stop = RT_TRUE;
+    rt_sem_release(&sim.tx_sem);
+    rt_completion_wait(&sim.tx_exit, RT_WAITING_FOREVER);
+
+__exit:
+    if (sim.serial.parent.ref_count)
+    {
+        rt_device_close(&sim.serial.parent);
+    }
+    rt_sem_detach(&sim.tx_sem);
+    rt_sem_detach(&reader.rx_sem);
+    rt_sem_detach(&tx_space);
+    rt_free(sim.sink);
+    sim.sink = RT_NULL;
+
+    rt_kprintf("%s\n", ok && thread ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(serial_bench, serial_v2 ring test and benchmark: serial_bench [KB]);
+
+#endif /* RT_SERIAL_USING_BENCH */
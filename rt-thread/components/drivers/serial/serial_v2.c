@@ -16,6 +16,19 @@
 #define DBG_LVL    DBG_INFO
 #include <rtdbg.h>
 
+/* timestamps of the RX latency */
+#ifdef RT_USING_CPUTIME
+#define SERIAL_STAMP()              ((rt_uint32_t)clock_cpu_gettime())
+#define SERIAL_STAMP_TO_US(stamp)   clock_cpu_microsecond(stamp)
+#else
+#define SERIAL_STAMP()              ((rt_uint32_t)rt_tick_get())
+#define SERIAL_STAMP_TO_US(stamp)   ((stamp) * (1000000 / RT_TICK_PER_SECOND))
+#endif
+
+#ifdef RT_SERIAL_USING_BUF_MEMHEAP
+static struct rt_memheap *serial_buf_heap = RT_NULL;
+#endif
+
 #ifdef RT_USING_POSIX_STDIO
 #include <unistd.h>
 #include <fcntl.h>
@@ -152,18 +165,14 @@ static int serial_fops_poll(struct dfs_fd *fd, struct rt_pollreq *req)
     flags = fd->flags & O_ACCMODE;
     if (flags == O_RDONLY || flags == O_RDWR)
     {
-        rt_base_t level;
         struct rt_serial_rx_fifo* rx_fifo;
 
         rt_poll_add(&(device->wait_queue), req);
 
         rx_fifo = (struct rt_serial_rx_fifo*) serial->serial_rx;
 
-        level = rt_hw_interrupt_disable();
-
-        if (rt_ringbuffer_data_len(&rx_fifo->rb))
+        if (rt_spsc_ring_data_len(&rx_fifo->rb))
             mask |= POLLIN;
-        rt_hw_interrupt_enable(level);
     }
     // mask|=POLLOUT;
    return mask;
@@ -183,8 +192,8 @@ const static struct dfs_file_ops _serial_fops =
 };
 #endif /* RT_USING_POSIX_STDIO */
 
-static rt_size_t rt_serial_get_linear_buffer(struct rt_ringbuffer       *rb,
-                                                    rt_uint8_t         **ptr)
+rt_size_t rt_serial_get_linear_buffer(struct rt_ringbuffer       *rb,
+                                            rt_uint8_t         **ptr)
 {
     rt_size_t size;
 
@@ -209,8 +218,8 @@ static rt_size_t rt_serial_get_linear_buffer(struct rt_ringbuffer       *rb,
     return rb->buffer_size - rb->read_index;
 }
 
-static rt_size_t rt_serial_update_read_index(struct rt_ringbuffer    *rb,
-                                                    rt_uint16_t       read_index)
+rt_size_t rt_serial_update_read_index(struct rt_ringbuffer    *rb,
+                                            rt_uint16_t       read_index)
 {
     rt_size_t size;
 
@@ -242,38 +251,111 @@ static rt_size_t rt_serial_update_read_index(struct rt_ringbuffer    *rb,
     return read_index;
 }
 
-static rt_size_t rt_serial_update_write_index(struct rt_ringbuffer  *rb,
-                                                     rt_uint16_t     write_index)
+/**
+  * @brief Get the bytes written by a circular RX DMA since the last event.
+  *        The half transfer and transfer complete interrupts report the DMA
+  *        twice per lap, so the bytes between two events are less than the
+  *        size of the buffer and an unchanged position means no data, also
+  *        when an event is handled after another one has seen its data.
+  * @param bufsz The length of the DMA transfer, the size of the RX ring.
+  * @param last_index The position of the DMA at the last event, updated.
+  * @param counter The bytes left to the end of the buffer, the counter of the DMA.
+  * @return Return the length of the new data.
+  */
+rt_size_t rt_serial_dma_rx_len(rt_size_t bufsz, rt_size_t *last_index, rt_size_t counter)
 {
-    rt_uint16_t size;
-    RT_ASSERT(rb != RT_NULL);
+    rt_size_t index, length;
 
-    /* whether has enough space */
-    size = rt_ringbuffer_space_len(rb);
+    RT_ASSERT(counter <= bufsz);
 
-    /* no space */
-    if (size == 0)
-        return 0;
+    /* the counter is reloaded at the end of the buffer */
+    index = (bufsz - counter) % bufsz;
+    if (index >= *last_index)
+        length = index - *last_index;
+    else
+        length = bufsz - *last_index + index;
+    *last_index = index;
 
-    /* drop some data */
-    if (size < write_index)
-        write_index = size;
+    return length;
+}
+
+static void *serial_buf_alloc(rt_size_t size)
+{
+#ifdef RT_SERIAL_USING_BUF_MEMHEAP
+    void *ptr;
 
-    if (rb->buffer_size - rb->write_index > write_index)
+    if (serial_buf_heap == RT_NULL)
+        serial_buf_heap = (struct rt_memheap *)rt_object_find(RT_SERIAL_BUF_MEMHEAP,
+                                                              RT_Object_Class_MemHeap);
+    if (serial_buf_heap != RT_NULL)
     {
-        /* this should not cause overflow because there is enough space for
-         * length of data in current mirror */
-        rb->write_index += write_index;
-        return write_index;
+        ptr = rt_memheap_alloc(serial_buf_heap, size);
+        if (ptr != RT_NULL)
+            return ptr;
     }
+#endif
 
-    /* we are going into the other side of the mirror */
-    rb->write_mirror = ~rb->write_mirror;
-    rb->write_index = write_index - (rb->buffer_size - rb->write_index);
+    return rt_malloc(size);
+}
+
+static void serial_buf_free(void *ptr)
+{
+#ifdef RT_SERIAL_USING_BUF_MEMHEAP
+    /* the buffers of the devices opened before the memheap was found are in the system heap */
+    if (serial_buf_heap != RT_NULL &&
+        (rt_uint8_t *)ptr >= (rt_uint8_t *)serial_buf_heap->start_addr &&
+        (rt_uint8_t *)ptr < (rt_uint8_t *)serial_buf_heap->start_addr + serial_buf_heap->pool_size)
+    {
+        rt_memheap_free(ptr);
+        return;
+    }
+#endif
+
+    rt_free(ptr);
+}
+
+/* count the data taken from the RX ring, call it from the reader */
+static void serial_rx_stat_read(struct rt_serial_device *serial, rt_size_t length)
+{
+    struct rt_serial_rx_fifo *rx_fifo;
+    rt_uint32_t latency;
+    rt_base_t level;
+
+    rx_fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
+
+    /* the data the DMA has overwritten, counted by the reader that owns the ring */
+    if (rx_fifo->rb.dropped)
+    {
+        serial->stat.rx_dropped += rx_fifo->rb.dropped;
+        rx_fifo->rb.dropped = 0;
+    }
+
+    if (length == 0) return;
 
-    return write_index;
+    level = rt_hw_interrupt_disable();
+    serial->stat.rx_reads ++;
+    if (serial->rx_stamped)
+    {
+        latency = SERIAL_STAMP_TO_US(SERIAL_STAMP() - serial->rx_stamp);
+        if (latency > serial->stat.rx_latency_max)
+            serial->stat.rx_latency_max = latency;
+        serial->stat.rx_latency_sum += latency;
+    }
+
+    /* the data left waits since the same notification */
+    if (rt_spsc_ring_data_len(&rx_fifo->rb) == 0)
+        serial->rx_stamped = RT_FALSE;
+    rt_hw_interrupt_enable(level);
 }
 
+static rt_size_t serial_transmit(struct rt_serial_device *serial,
+                                 rt_uint8_t              *buf,
+                                 rt_size_t                size,
+                                 rt_uint32_t              tx_flag)
+{
+    serial->stat.tx_transfers ++;
+    return serial->ops->transmit(serial, buf, size, tx_flag);
+}
 
 /**
   * @brief Serial polling receive data routine, This function will receive data
@@ -319,6 +401,7 @@ rt_size_t _serial_poll_rx(struct rt_device          *dev,
         }
     }
 
+    serial->stat.rx_bytes += getc_size - size;
    return getc_size - size;
 }
 
@@ -362,6 +445,7 @@ rt_size_t _serial_poll_tx(struct rt_device           *dev,
         -- size;
     }
 
+    serial->stat.tx_bytes += putc_size - size;
      return putc_size - size;
 }
 
@@ -403,30 +487,83 @@ static rt_size_t _serial_fifo_rx(struct rt_device        *dev,
 
             return 0;
         }
-        /* Get the length of the data from the ringbuffer */
-        recv_len = rt_ringbuffer_data_len(&(rx_fifo->rb));
+        /* Get the length of the data from the ringbuffer, the interrupt
+         * sees rx_cpt_index of the data that arrives after it */
+        level = rt_hw_interrupt_disable();
+        recv_len = rt_spsc_ring_data_len(&(rx_fifo->rb));
 
         if (recv_len < size)
         {
             /* When recv_len is less than size, rx_cpt_index is updated to the size
             * and rt_current_thread is suspend until rx_cpt_index is equal to 0 */
             rx_fifo->rx_cpt_index = size;
+            rt_hw_interrupt_enable(level);
             rt_completion_wait(&(rx_fifo->rx_cpt), RT_WAITING_FOREVER);
         }
+        else
+        {
+            rt_hw_interrupt_enable(level);
+        }
     }
 
     /* This part of the code is open_flag as RT_SERIAL_RX_NON_BLOCKING */
 
-    level = rt_hw_interrupt_disable();
     /* When open_flag is RT_SERIAL_RX_NON_BLOCKING,
-     * the data is retrieved directly from the ringbuffer and returned */
-    recv_len = rt_ringbuffer_get(&(rx_fifo->rb), buffer, size);
-
-    rt_hw_interrupt_enable(level);
+     * the data is retrieved directly from the ringbuffer and returned,
+     * the reader is the only consumer of the ring */
+    recv_len = rt_spsc_ring_get(&(rx_fifo->rb), buffer, size);
+    serial_rx_stat_read(serial, recv_len);
 
     return recv_len;
 }
 
+/**
+  * @brief Get the data at the read index of the RX ring without copying it.
+  *        The data stays in the ring until it's released, when the ring
+  *        overflows in the meantime the DMA can overwrite it.
+  * @param dev The pointer of device driver structure
+  * @param ptr The pointer of the data.
+  * @return Return the length of the linear block of data.
+  */
+rt_size_t rt_serial_rx_peek(rt_device_t dev, rt_uint8_t **ptr)
+{
+    struct rt_serial_device *serial;
+    struct rt_serial_rx_fifo *rx_fifo;
+
+    RT_ASSERT(dev != RT_NULL && ptr != RT_NULL);
+    serial = (struct rt_serial_device *)dev;
+    rx_fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
+    if (rx_fifo == RT_NULL)
+    {
+        *ptr = RT_NULL;
+        return 0;
+    }
+
+    return rt_spsc_ring_peek_read(&(rx_fifo->rb), ptr);
+}
+
+/**
+  * @brief Release the data of rt_serial_rx_peek().
+  * @param dev The pointer of device driver structure
+  * @param size The bytes to release, at most the length of the peeked block.
+  */
+void rt_serial_rx_release(rt_device_t dev, rt_size_t size)
+{
+    struct rt_serial_device *serial;
+    struct rt_serial_rx_fifo *rx_fifo;
+    rt_size_t length;
+
+    RT_ASSERT(dev != RT_NULL);
+    serial = (struct rt_serial_device *)dev;
+    rx_fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
+    if (rx_fifo == RT_NULL || size == 0) return;
+
+    length = rt_spsc_ring_data_len(&(rx_fifo->rb));
+    size = RT_MIN(size, length);
+    rt_spsc_ring_commit_read(&(rx_fifo->rb), size);
+    serial_rx_stat_read(serial, size);
+}
+
 /**
   * @brief Serial transmit data routines, This function will transmit
   *        data by using blocking_nbuf.
@@ -452,19 +589,27 @@ static rt_size_t _serial_fifo_tx_blocking_nbuf(struct rt_device        *dev,
     tx_fifo = (struct rt_serial_tx_fifo *) serial->serial_tx;
     RT_ASSERT(tx_fifo != RT_NULL);
 
+    if (rt_thread_self() == RT_NULL || rt_interrupt_get_nest() ||
+        (serial->parent.open_flag & RT_DEVICE_FLAG_STREAM))
+    {
+        /* the completion can't be waited for, e.g. by rt_kprintf() in an interrupt */
+        return _serial_poll_tx(dev, pos, buffer, size);
+    }
+
     /* When serial transmit in tx_blocking mode,
      * if the activated mode is RT_TRUE, it will return directly */
     if (tx_fifo->activated == RT_TRUE)  return 0;
 
     tx_fifo->activated = RT_TRUE;
     /* Call the transmit interface for transmission */
-    serial->ops->transmit(serial,
-                          (rt_uint8_t *)buffer,
-                          size,
-                          RT_SERIAL_TX_BLOCKING);
+    serial_transmit(serial,
+                    (rt_uint8_t *)buffer,
+                    size,
+                    RT_SERIAL_TX_BLOCKING);
     /* Waiting for the transmission to complete */
     rt_completion_wait(&(tx_fifo->tx_cpt), RT_WAITING_FOREVER);
 
+    serial->stat.tx_bytes += size;
     return size;
 }
 
@@ -517,14 +662,15 @@ static rt_size_t _serial_fifo_tx_blocking_buf(struct rt_device        *dev,
         offset += tx_fifo->put_size;
         size -= tx_fifo->put_size;
         /* Call the transmit interface for transmission */
-        serial->ops->transmit(serial,
-                             (rt_uint8_t *)buffer + offset,
-                             tx_fifo->put_size,
-                             RT_SERIAL_TX_BLOCKING);
+        serial_transmit(serial,
+                        (rt_uint8_t *)buffer + offset,
+                        tx_fifo->put_size,
+                        RT_SERIAL_TX_BLOCKING);
         /* Waiting for the transmission to complete */
         rt_completion_wait(&(tx_fifo->tx_cpt), RT_WAITING_FOREVER);
     }
 
+    serial->stat.tx_bytes += length;
     return length;
 }
 
@@ -563,6 +709,7 @@ static rt_size_t _serial_fifo_tx_nonblocking(struct rt_device        *dev,
         tx_fifo->activated = RT_TRUE;
         /* Copying data into the ringbuffer */
         length = rt_ringbuffer_put(&(tx_fifo->rb), buffer, size);
+        serial->stat.tx_bytes += length;
 
         rt_hw_interrupt_enable(level);
 
@@ -570,10 +717,10 @@ static rt_size_t _serial_fifo_tx_nonblocking(struct rt_device        *dev,
         /* Get the linear length buffer from rinbuffer */
         tx_fifo->put_size = rt_serial_get_linear_buffer(&(tx_fifo->rb), &put_ptr);
         /* Call the transmit interface for transmission */
-        serial->ops->transmit(serial,
-                              put_ptr,
-                              tx_fifo->put_size,
-                              RT_SERIAL_TX_NON_BLOCKING);
+        serial_transmit(serial,
+                        put_ptr,
+                        tx_fifo->put_size,
+                        RT_SERIAL_TX_NON_BLOCKING);
         /* In tx_nonblocking mode, there is no need to call rt_completion_wait() APIs to wait
          * for the rt_current_thread to resume */
         return length;
@@ -586,6 +733,7 @@ static rt_size_t _serial_fifo_tx_nonblocking(struct rt_device        *dev,
 
     /* Copying data into the ringbuffer */
     length = rt_ringbuffer_put(&(tx_fifo->rb), buffer, size);
+    serial->stat.tx_bytes += length;
 
     rt_hw_interrupt_enable(level);
 
@@ -641,7 +789,7 @@ static rt_err_t rt_serial_tx_enable(struct rt_device        *dev,
         if (optmode == RT_SERIAL_TX_BLOCKING_BUFFER)
         {
             /* If use RT_SERIAL_TX_BLOCKING_BUFFER, the ringbuffer is initialized */
-            tx_fifo = (struct rt_serial_tx_fifo *) rt_malloc
+            tx_fifo = (struct rt_serial_tx_fifo *) serial_buf_alloc
                     (sizeof(struct rt_serial_tx_fifo) + serial->config.tx_bufsz);
             RT_ASSERT(tx_fifo != RT_NULL);
 
@@ -661,6 +809,8 @@ static rt_err_t rt_serial_tx_enable(struct rt_device        *dev,
             tx_fifo = (struct rt_serial_tx_fifo*) rt_malloc
                     (sizeof(struct rt_serial_tx_fifo));
             RT_ASSERT(tx_fifo != RT_NULL);
+            /* the driver sends from the buffers of the writers */
+            tx_fifo->rb.buffer_ptr = RT_NULL;
 
             serial->serial_tx = tx_fifo;
 
@@ -684,7 +834,7 @@ static rt_err_t rt_serial_tx_enable(struct rt_device        *dev,
     /* When using RT_SERIAL_TX_NON_BLOCKING, ringbuffer needs to be initialized,
      * and initialize the tx_fifo->activated value is RT_FALSE.
      */
-    tx_fifo = (struct rt_serial_tx_fifo *) rt_malloc
+    tx_fifo = (struct rt_serial_tx_fifo *) serial_buf_alloc
             (sizeof(struct rt_serial_tx_fifo) + serial->config.tx_bufsz);
     RT_ASSERT(tx_fifo != RT_NULL);
 
@@ -720,6 +870,7 @@ static rt_err_t rt_serial_rx_enable(struct rt_device        *dev,
 {
     struct rt_serial_device *serial;
     struct rt_serial_rx_fifo *rx_fifo = RT_NULL;
+    rt_uint32_t bufsz;
 
     RT_ASSERT(dev != RT_NULL);
     serial = (struct rt_serial_device *)dev;
@@ -741,17 +892,20 @@ static rt_err_t rt_serial_rx_enable(struct rt_device        *dev,
         dev->open_flag |= RT_SERIAL_RX_BLOCKING;
         return RT_EOK;
     }
-    /* Limits the minimum value of rx_bufsz */
-    if (serial->config.rx_bufsz < RT_SERIAL_RX_MINBUFSZ)
-        serial->config.rx_bufsz = RT_SERIAL_RX_MINBUFSZ;
+    /* Limits the minimum value of rx_bufsz, the lock-free ring takes a power of two */
+    bufsz = RT_SERIAL_RX_MINBUFSZ;
+    while (bufsz < serial->config.rx_bufsz)
+        bufsz <<= 1;
+    serial->config.rx_bufsz = bufsz;
 
-    rx_fifo = (struct rt_serial_rx_fifo *) rt_malloc
+    rx_fifo = (struct rt_serial_rx_fifo *) serial_buf_alloc
             (sizeof(struct rt_serial_rx_fifo) + serial->config.rx_bufsz);
 
     RT_ASSERT(rx_fifo != RT_NULL);
-    rt_ringbuffer_init(&(rx_fifo->rb), rx_fifo->buffer, serial->config.rx_bufsz);
+    rt_spsc_ring_init(&(rx_fifo->rb), rx_fifo->buffer, serial->config.rx_bufsz);
 
     serial->serial_rx = rx_fifo;
+    serial->rx_stamped = RT_FALSE;
 
 #ifndef RT_USING_DEVICE_OPS
     dev->read = _serial_fifo_rx;
@@ -819,7 +973,7 @@ static rt_err_t rt_serial_rx_disable(struct rt_device        *dev,
 
     rx_fifo = (struct rt_serial_rx_fifo *)serial->serial_rx;
     RT_ASSERT(rx_fifo != RT_NULL);
-    rt_free(rx_fifo);
+    serial_buf_free(rx_fifo);
     serial->serial_rx = RT_NULL;
 
     return RT_EOK;
@@ -868,7 +1022,10 @@ static rt_err_t rt_serial_tx_disable(struct rt_device        *dev,
                             (void *)RT_SERIAL_TX_BLOCKING);
     } while (0);
 
-    rt_free(tx_fifo);
+    if (tx_fifo->rb.buffer_ptr != RT_NULL)
+        serial_buf_free(tx_fifo);
+    else
+        rt_free(tx_fifo);
     serial->serial_tx = RT_NULL;
 
     return RT_EOK;
@@ -1030,6 +1187,19 @@ static rt_err_t rt_serial_control(struct rt_device *dev,
 
             break;
 
+        case RT_SERIAL_CTRL_GET_STAT:
+            if (args == RT_NULL) return -RT_EINVAL;
+            *(struct rt_serial_stat *)args = serial->stat;
+            break;
+
+        case RT_SERIAL_CTRL_RESET_STAT:
+        {
+            rt_base_t level = rt_hw_interrupt_disable();
+            rt_memset(&serial->stat, 0, sizeof(serial->stat));
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+
         default :
             /* control device */
             ret = serial->ops->control(serial, cmd, args);
@@ -1081,7 +1251,7 @@ static rt_size_t rt_serial_write(struct rt_device *dev,
         return _serial_poll_tx(dev, pos, buffer, size);
     }
 
-    if (dev->open_flag | RT_SERIAL_TX_BLOCKING)
+    if (dev->open_flag & RT_SERIAL_TX_BLOCKING)
     {
         if ((tx_fifo->rb.buffer_ptr) == RT_NULL)
         {
@@ -1128,6 +1298,9 @@ rt_err_t rt_hw_serial_register(struct rt_serial_device *serial,
     device->rx_indicate = RT_NULL;
     device->tx_complete = RT_NULL;
 
+    rt_memset(&serial->stat, 0, sizeof(serial->stat));
+    serial->rx_stamped = RT_FALSE;
+
 #ifdef RT_USING_DEVICE_OPS
     device->ops         = &serial_ops;
 #else
@@ -1174,12 +1347,28 @@ void rt_hw_serial_isr(struct rt_serial_device *serial, int event)
             rx_length = (event & (~0xff)) >> 8;
 
             if (rx_length)
-                rt_serial_update_write_index(&(rx_fifo->rb), rx_length);
+            {
+                /* the DMA doesn't wait for the reader, it counts what's overwritten */
+                rt_spsc_ring_commit_write_force(&(rx_fifo->rb), rx_length);
+                serial->stat.rx_bytes += rx_length;
+            }
+            else
+            {
+                /* the driver put one byte into the ring */
+                serial->stat.rx_bytes ++;
+            }
 
             /* Get the length of the data from the ringbuffer */
-            rx_length = rt_ringbuffer_data_len(&rx_fifo->rb);
+            rx_length = rt_spsc_ring_data_len(&rx_fifo->rb);
             if (rx_length == 0) break;
 
+            serial->stat.rx_events ++;
+            if (!serial->rx_stamped)
+            {
+                serial->rx_stamp = SERIAL_STAMP();
+                serial->rx_stamped = RT_TRUE;
+            }
+
             if (serial->parent.open_flag & RT_SERIAL_RX_BLOCKING)
             {
                 if (rx_fifo->rx_cpt_index && rx_length >= rx_fifo->rx_cpt_index )
@@ -1222,12 +1411,12 @@ void rt_hw_serial_isr(struct rt_serial_device *serial, int event)
             /* Call the transmit interface for transmission again */
             /* Note that in interrupt mode, tx_fifo->buffer and tx_length
              * are inactive parameters */
-            serial->ops->transmit(serial,
-                                tx_fifo->buffer,
-                                tx_length,
-                                serial->parent.open_flag & ( \
-                                RT_SERIAL_TX_BLOCKING | \
-                                RT_SERIAL_TX_NON_BLOCKING));
+            serial_transmit(serial,
+                            tx_fifo->buffer,
+                            tx_length,
+                            serial->parent.open_flag & ( \
+                            RT_SERIAL_TX_BLOCKING | \
+                            RT_SERIAL_TX_NON_BLOCKING));
             break;
         }
 
@@ -1261,16 +1450,101 @@ void rt_hw_serial_isr(struct rt_serial_device *serial, int event)
                 /* Get the linear length buffer from rinbuffer */
                 tx_fifo->put_size = rt_serial_get_linear_buffer(&(tx_fifo->rb), &put_ptr);
                 /* Call the transmit interface for transmission again */
-                serial->ops->transmit(serial,
-                                    put_ptr,
-                                    tx_fifo->put_size,
-                                    RT_SERIAL_TX_NON_BLOCKING);
+                serial_transmit(serial,
+                                put_ptr,
+                                tx_fifo->put_size,
+                                RT_SERIAL_TX_NON_BLOCKING);
             }
 
             break;
         }
 
+        case RT_SERIAL_EVENT_RX_ERROR:
+        {
+            if ((event >> 8) == RT_SERIAL_ERR_OVERRUN)
+                serial->stat.rx_overruns ++;
+            else
+                serial->stat.rx_errors ++;
+            break;
+        }
+
         default:
             break;
     }
 }
+
+#ifdef RT_USING_MSH
+static rt_bool_t serial_is_v2(rt_device_t dev)
+{
+#ifdef RT_USING_DEVICE_OPS
+    return dev->ops == &serial_ops;
+#else
+    return dev->init == rt_serial_init;
+#endif
+}
+
+static void serial_stat_print(struct rt_serial_device *serial, rt_bool_t reset)
+{
+    struct rt_serial_stat stat;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    stat = serial->stat;
+    if (reset)
+        rt_memset(&serial->stat, 0, sizeof(serial->stat));
+    rt_hw_interrupt_enable(level);
+
+    rt_kprintf("%-8.*s rx %u bytes, %u dropped, %u overruns, %u errors, %u events\n",
+               RT_NAME_MAX, serial->parent.parent.name, stat.rx_bytes, stat.rx_dropped,
+               stat.rx_overruns, stat.rx_errors, stat.rx_events);
+    rt_kprintf("%-8s rx latency avg %u us, max %u us over %u reads\n", "",
+               stat.rx_reads ? stat.rx_latency_sum / stat.rx_reads : 0,
+               stat.rx_latency_max, stat.rx_reads);
+    rt_kprintf("%-8s tx %u bytes, %u transfers\n", "", stat.tx_bytes, stat.tx_transfers);
+}
+
+static int serial_stat(int argc, char **argv)
+{
+    struct rt_object_information *info;
+    struct rt_list_node *node;
+    rt_device_t devs[8];
+    rt_bool_t reset = RT_FALSE;
+    int num = 0, i;
+
+    if (argc > 1 && rt_strcmp(argv[argc - 1], "reset") == 0)
+    {
+        reset = RT_TRUE;
+        argc --;
+    }
+
+    if (argc > 1)
+    {
+        devs[0] = rt_device_find(argv[1]);
+        if (devs[0] == RT_NULL || !serial_is_v2(devs[0]))
+        {
+            rt_kprintf("%s isn't a serial device\n", argv[1]);
+            return -1;
+        }
+        num = 1;
+    }
+    else
+    {
+        info = rt_object_get_information(RT_Object_Class_Device);
+        rt_enter_critical();
+        rt_list_for_each(node, &info->object_list)
+        {
+            rt_device_t dev = (rt_device_t)rt_list_entry(node, struct rt_object, list);
+
+            if (num < (int)(sizeof(devs) / sizeof(devs[0])) && serial_is_v2(dev))
+                devs[num ++] = dev;
+        }
+        rt_exit_critical();
+    }
+
+    for (i = 0; i < num; i ++)
+        serial_stat_print((struct rt_serial_device *)devs[i], reset);
+
+    return 0;
+}
+MSH_CMD_EXPORT(serial_stat, serial device counters: serial_stat [device] [reset]);
+#endif /* RT_USING_MSH */
@@ -0,0 +1,1027 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "qspi_nor.h"
+
+#ifdef RT_USING_QSPI_NOR
+
+#define DBG_TAG              "qspi.nor"
+#define DBG_LVL              DBG_INFO
+#include <rtdbg.h>
+
+#ifndef RT_QSPI_NOR_THREAD_PRIORITY
+#define RT_QSPI_NOR_THREAD_PRIORITY     20
+#endif
+
+#ifndef RT_QSPI_NOR_THREAD_STACK_SIZE
+#define RT_QSPI_NOR_THREAD_STACK_SIZE   1024
+#endif
+
+#ifndef RT_QSPI_NOR_SPI_MAX_HZ
+#define RT_QSPI_NOR_SPI_MAX_HZ          50000000
+#endif
+
+#define QSPI_NOR_POLL_MS                1       /* status of a running erase */
+#define QSPI_NOR_ERASE_TIMEOUT_MS       4000    /* 64KB block erase, 2s max */
+#define QSPI_NOR_PROGRAM_TIMEOUT_US     5000    /* page program, 3ms max */
+#define QSPI_NOR_PROGRAM_POLL_US        20
+#define QSPI_NOR_SUSPEND_TIMEOUT_US     200     /* erase suspend latency, 20-30us max */
+#define QSPI_NOR_SUSPEND_POLL_US        2
+
+#define QSPI_NOR_CACHE_INVALID          0xFFFFFFFF
+
+static rt_uint32_t qspi_nor_time_us(void)
+{
+#ifdef RT_USING_CPUTIME
+    /* from the whole counter, the differences of the times are taken modulo 2^32 us */
+    return (rt_uint32_t)(clock_cpu_gettime() * (double)clock_cpu_getres() / 1000);
+#else
+    return rt_tick_get() * (1000000 / RT_TICK_PER_SECOND);
+#endif
+}
+
+static void qspi_nor_set_cmd(struct qspi_nor_cmd *cmd, rt_uint8_t opcode, rt_uint8_t addr_lines,
+                             rt_uint8_t data_lines, rt_uint8_t dummy_cycles)
+{
+    rt_memset(cmd, 0, sizeof(*cmd));
+    cmd->opcode = opcode;
+    cmd->addr_lines = addr_lines;
+    cmd->data_lines = data_lines;
+    cmd->dummy_cycles = dummy_cycles;
+}
+
+static void qspi_nor_unmap(struct qspi_nor *nor)
+{
+    if (nor->mapped)
+    {
+        nor->ops->unmap(nor);
+        nor->mapped = RT_NULL;
+    }
+}
+
+static rt_err_t qspi_nor_map(struct qspi_nor *nor)
+{
+    if (nor->mapped == RT_NULL)
+    {
+        nor->mapped = nor->ops->map(nor, &nor->read_cmd);
+    }
+
+    return nor->mapped ? RT_EOK : -RT_ERROR;
+}
+
+/* the commands leave the memory mapped mode */
+static rt_err_t qspi_nor_exec(struct qspi_nor *nor, const struct qspi_nor_cmd *cmd,
+                              const void *tx, void *rx, rt_size_t len)
+{
+    qspi_nor_unmap(nor);
+
+    return nor->ops->command(nor, cmd, tx, rx, len);
+}
+
+static rt_err_t qspi_nor_opcode(struct qspi_nor *nor, rt_uint8_t opcode)
+{
+    struct qspi_nor_cmd cmd;
+
+    qspi_nor_set_cmd(&cmd, opcode, 0, 0, 0);
+
+    return qspi_nor_exec(nor, &cmd, RT_NULL, RT_NULL, 0);
+}
+
+static rt_err_t qspi_nor_read_status(struct qspi_nor *nor, rt_uint8_t *status)
+{
+    struct qspi_nor_cmd cmd;
+
+    qspi_nor_set_cmd(&cmd, QSPI_NOR_CMD_READ_STATUS, 0, 1, 0);
+
+    return qspi_nor_exec(nor, &cmd, RT_NULL, status, 1);
+}
+
+static rt_err_t qspi_nor_wait_ready(struct qspi_nor *nor, rt_uint32_t timeout_us, rt_uint32_t poll_us)
+{
+    rt_uint32_t waited;
+    rt_uint8_t status;
+    rt_err_t result;
+
+    for (waited = 0; ; waited += poll_us)
+    {
+        result = qspi_nor_read_status(nor, &status);
+        if (result != RT_EOK)
+        {
+            return result;
+        }
+        if ((status & QSPI_NOR_STATUS_BUSY) == 0)
+        {
+            return RT_EOK;
+        }
+        if (waited >= timeout_us)
+        {
+            return -RT_ETIMEOUT;
+        }
+        rt_hw_us_delay(poll_us);
+    }
+}
+
+static void qspi_nor_cache_invalidate(struct qspi_nor *nor, rt_uint32_t addr, rt_uint32_t size)
+{
+#if RT_QSPI_NOR_CACHE_LINES > 0
+    int i;
+
+    for (i = 0; i < RT_QSPI_NOR_CACHE_LINES; i++)
+    {
+        if (nor->cache_addr[i] != QSPI_NOR_CACHE_INVALID
+                && nor->cache_addr[i] < addr + size && addr < nor->cache_addr[i] + RT_QSPI_NOR_CACHE_LINE_SIZE)
+        {
+            nor->cache_addr[i] = QSPI_NOR_CACHE_INVALID;
+            nor->cache_age[i] = 0;
+        }
+    }
+#endif
+}
+
+static rt_err_t qspi_nor_suspend(struct qspi_nor *nor)
+{
+    rt_uint32_t elapsed;
+    rt_err_t result;
+
+    if (!nor->erasing || nor->suspended)
+    {
+        return RT_EOK;
+    }
+
+    /* let the erase run since the last resume, or a stream of reads would stop it */
+    elapsed = qspi_nor_time_us() - nor->resume_time;
+    if (elapsed < nor->suspend_min_us)
+    {
+        rt_hw_us_delay(nor->suspend_min_us - elapsed);
+    }
+
+    result = qspi_nor_opcode(nor, QSPI_NOR_CMD_ERASE_SUSPEND);
+    if (result == RT_EOK)
+    {
+        result = qspi_nor_wait_ready(nor, QSPI_NOR_SUSPEND_TIMEOUT_US, QSPI_NOR_SUSPEND_POLL_US);
+    }
+    if (result != RT_EOK)
+    {
+        LOG_E("%s: erase suspend failed (%d)", nor->name, result);
+        return result;
+    }
+
+    nor->suspended = RT_TRUE;
+    nor->stat.suspends++;
+
+    return RT_EOK;
+}
+
+static void qspi_nor_resume(struct qspi_nor *nor)
+{
+    if (!nor->suspended)
+    {
+        return;
+    }
+
+    if (qspi_nor_opcode(nor, QSPI_NOR_CMD_ERASE_RESUME) != RT_EOK)
+    {
+        LOG_E("%s: erase resume failed", nor->name);
+    }
+    nor->suspended = RT_FALSE;
+    nor->resume_time = qspi_nor_time_us();
+}
+
+/* take the lock, the erase of the range is waited for */
+static void qspi_nor_begin(struct qspi_nor *nor, rt_uint32_t addr, rt_size_t size)
+{
+    rt_bool_t waited = RT_FALSE;
+
+    rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+
+    if (nor->erase_blocking)
+    {
+        addr = 0;
+        size = nor->size;
+    }
+
+    while (nor->erasing && addr < nor->erase_addr + nor->erase_size && nor->erase_addr < addr + size)
+    {
+        if (!waited)
+        {
+            nor->stat.erase_waits++;
+            waited = RT_TRUE;
+        }
+        rt_mutex_release(&nor->lock);
+        rt_thread_mdelay(QSPI_NOR_POLL_MS);
+        rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+    }
+}
+
+/* resume the erase and release the lock */
+static void qspi_nor_end(struct qspi_nor *nor)
+{
+    if (nor->xip_taken == 0)
+    {
+        qspi_nor_resume(nor);
+    }
+
+    rt_mutex_release(&nor->lock);
+}
+
+static rt_err_t qspi_nor_read_flash(struct qspi_nor *nor, rt_uint32_t addr, void *buf, rt_size_t size)
+{
+    struct qspi_nor_cmd cmd = nor->read_cmd;
+    rt_err_t result;
+
+    result = qspi_nor_suspend(nor);
+    if (result != RT_EOK)
+    {
+        return result;
+    }
+
+    cmd.addr = addr;
+
+    return qspi_nor_exec(nor, &cmd, RT_NULL, buf, size);
+}
+
+#if RT_QSPI_NOR_CACHE_LINES > 0
+static const rt_uint8_t *qspi_nor_cache_line(struct qspi_nor *nor, rt_uint32_t addr)
+{
+    rt_uint8_t *line;
+    int i, victim = 0;
+
+    for (i = 0; i < RT_QSPI_NOR_CACHE_LINES; i++)
+    {
+        if (nor->cache_addr[i] == addr)
+        {
+            nor->stat.cache_hits++;
+            nor->cache_age[i] = ++nor->cache_clock;
+            return nor->cache + i * RT_QSPI_NOR_CACHE_LINE_SIZE;
+        }
+        if (nor->cache_age[i] < nor->cache_age[victim])
+        {
+            victim = i;
+        }
+    }
+
+    nor->stat.cache_misses++;
+    line = nor->cache + victim * RT_QSPI_NOR_CACHE_LINE_SIZE;
+    nor->cache_addr[victim] = QSPI_NOR_CACHE_INVALID;
+    nor->cache_age[victim] = 0;
+    if (qspi_nor_read_flash(nor, addr, line, RT_QSPI_NOR_CACHE_LINE_SIZE) != RT_EOK)
+    {
+        return RT_NULL;
+    }
+    nor->cache_addr[victim] = addr;
+    nor->cache_age[victim] = ++nor->cache_clock;
+
+    return line;
+}
+#endif /* RT_QSPI_NOR_CACHE_LINES > 0 */
+
+/* the parts of lines go through the cache, the whole lines are read directly */
+static rt_err_t qspi_nor_read_cached(struct qspi_nor *nor, rt_uint32_t addr, rt_uint8_t *buf, rt_size_t size)
+{
+#if RT_QSPI_NOR_CACHE_LINES > 0
+    const rt_uint8_t *line;
+    rt_uint32_t offset;
+    rt_size_t len;
+    rt_err_t result;
+
+    while (size > 0)
+    {
+        offset = addr % RT_QSPI_NOR_CACHE_LINE_SIZE;
+        if (offset == 0 && size >= RT_QSPI_NOR_CACHE_LINE_SIZE)
+        {
+            len = size - size % RT_QSPI_NOR_CACHE_LINE_SIZE;
+            result = qspi_nor_read_flash(nor, addr, buf, len);
+            if (result != RT_EOK)
+            {
+                return result;
+            }
+        }
+        else
+        {
+            len = RT_QSPI_NOR_CACHE_LINE_SIZE - offset;
+            if (len > size)
+            {
+                len = size;
+            }
+            line = qspi_nor_cache_line(nor, addr - offset);
+            if (line == RT_NULL)
+            {
+                return -RT_EIO;
+            }
+            rt_memcpy(buf, line + offset, len);
+        }
+        addr += len;
+        buf += len;
+        size -= len;
+    }
+
+    return RT_EOK;
+#else
+    return qspi_nor_read_flash(nor, addr, buf, size);
+#endif /* RT_QSPI_NOR_CACHE_LINES > 0 */
+}
+
+int qspi_nor_read(struct qspi_nor *nor, rt_uint32_t addr, void *buf, rt_size_t size)
+{
+    rt_err_t result;
+
+    RT_ASSERT(nor);
+    RT_ASSERT(buf);
+
+    if (addr > nor->size || size > nor->size - addr)
+    {
+        return -RT_EINVAL;
+    }
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    qspi_nor_begin(nor, addr, size);
+    nor->stat.reads++;
+
+    if (nor->ops->map && qspi_nor_suspend(nor) == RT_EOK && qspi_nor_map(nor) == RT_EOK)
+    {
+        rt_memcpy(buf, nor->mapped + addr, size);
+        nor->stat.mapped_reads++;
+        result = RT_EOK;
+    }
+    else
+    {
+        result = qspi_nor_read_cached(nor, addr, buf, size);
+    }
+
+    qspi_nor_end(nor);
+
+    if (result != RT_EOK)
+    {
+        LOG_E("%s: read 0x%08X (%d) failed (%d)", nor->name, addr, size, result);
+        return -RT_EIO;
+    }
+
+    return size;
+}
+
+static rt_err_t qspi_nor_program_page(struct qspi_nor *nor, rt_uint32_t addr, const void *buf, rt_size_t size)
+{
+    struct qspi_nor_cmd cmd = nor->program_cmd;
+    rt_err_t result;
+
+    /* the flashes can program the pages out of the suspended sector */
+    result = qspi_nor_suspend(nor);
+    if (result != RT_EOK)
+    {
+        return result;
+    }
+
+    qspi_nor_cache_invalidate(nor, addr, size);
+
+    cmd.addr = addr;
+    result = qspi_nor_opcode(nor, QSPI_NOR_CMD_WRITE_ENABLE);
+    if (result == RT_EOK)
+    {
+        result = qspi_nor_exec(nor, &cmd, buf, RT_NULL, size);
+    }
+    if (result == RT_EOK)
+    {
+        result = qspi_nor_wait_ready(nor, QSPI_NOR_PROGRAM_TIMEOUT_US, QSPI_NOR_PROGRAM_POLL_US);
+    }
+
+    return result;
+}
+
+int qspi_nor_write(struct qspi_nor *nor, rt_uint32_t addr, const void *buf, rt_size_t size)
+{
+    const rt_uint8_t *data = buf;
+    rt_size_t left = size, len;
+    rt_err_t result = RT_EOK;
+
+    RT_ASSERT(nor);
+    RT_ASSERT(buf);
+
+    if (addr > nor->size || size > nor->size - addr)
+    {
+        return -RT_EINVAL;
+    }
+
+    /* a page at a time, the erase goes on between the pages */
+    while (left > 0 && result == RT_EOK)
+    {
+        len = nor->page_size - addr % nor->page_size;
+        if (len > left)
+        {
+            len = left;
+        }
+
+        qspi_nor_begin(nor, addr, len);
+        if (left == size)
+        {
+            nor->stat.writes++;
+        }
+        result = qspi_nor_program_page(nor, addr, data, len);
+        qspi_nor_end(nor);
+
+        addr += len;
+        data += len;
+        left -= len;
+    }
+
+    if (result != RT_EOK)
+    {
+        LOG_E("%s: write 0x%08X (%d) failed (%d)", nor->name, addr - len, len, result);
+        return -RT_EIO;
+    }
+
+    return size;
+}
+
+/* erase a sector or block, the lock is free while it runs */
+static rt_err_t qspi_nor_erase_unit(struct qspi_nor *nor, rt_uint8_t opcode, rt_uint32_t addr, rt_uint32_t size)
+{
+    struct qspi_nor_cmd cmd;
+    rt_uint32_t waited;
+    rt_uint8_t status;
+    rt_err_t result;
+
+    qspi_nor_set_cmd(&cmd, opcode, 1, 0, 0);
+    cmd.addr_size = nor->addr_size;
+    cmd.addr = addr;
+
+    rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+    qspi_nor_cache_invalidate(nor, addr, size);
+    result = qspi_nor_opcode(nor, QSPI_NOR_CMD_WRITE_ENABLE);
+    if (result == RT_EOK)
+    {
+        result = qspi_nor_exec(nor, &cmd, RT_NULL, RT_NULL, 0);
+    }
+    if (result == RT_EOK)
+    {
+        nor->erasing = RT_TRUE;
+        nor->erase_addr = addr;
+        nor->erase_size = size;
+        nor->resume_time = qspi_nor_time_us();
+        nor->stat.erases++;
+    }
+    rt_mutex_release(&nor->lock);
+
+    for (waited = 0; result == RT_EOK; waited += QSPI_NOR_POLL_MS)
+    {
+        rt_thread_mdelay(QSPI_NOR_POLL_MS);
+
+        /* the erase is never left suspended without the lock */
+        rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+        result = qspi_nor_read_status(nor, &status);
+        if (result == RT_EOK && (status & QSPI_NOR_STATUS_BUSY) == 0)
+        {
+            nor->erasing = RT_FALSE;
+            rt_mutex_release(&nor->lock);
+            return RT_EOK;
+        }
+        if (waited >= QSPI_NOR_ERASE_TIMEOUT_MS)
+        {
+            result = -RT_ETIMEOUT;
+        }
+        rt_mutex_release(&nor->lock);
+    }
+
+    rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+    nor->erasing = RT_FALSE;
+    rt_mutex_release(&nor->lock);
+    LOG_E("%s: erase 0x%08X failed (%d)", nor->name, addr, result);
+
+    return result;
+}
+
+static rt_err_t qspi_nor_erase_range(struct qspi_nor *nor, rt_uint32_t addr, rt_uint32_t size)
+{
+    rt_uint32_t end = addr + size;
+    rt_err_t result = RT_EOK;
+
+    while (addr < end && result == RT_EOK)
+    {
+        if (nor->block_size && addr % nor->block_size == 0 && end - addr >= nor->block_size)
+        {
+            result = qspi_nor_erase_unit(nor, QSPI_NOR_CMD_BLOCK_ERASE, addr, nor->block_size);
+            addr += nor->block_size;
+        }
+        else
+        {
+            result = qspi_nor_erase_unit(nor, QSPI_NOR_CMD_SECTOR_ERASE, addr, nor->sector_size);
+            addr += nor->sector_size;
+        }
+    }
+
+    return result;
+}
+
+static void qspi_nor_thread_entry(void *parameter)
+{
+    struct qspi_nor *nor = parameter;
+    struct qspi_nor_erase_req *req;
+    rt_err_t result;
+
+    while (1)
+    {
+        rt_sem_take(&nor->erase_sem, RT_WAITING_FOREVER);
+
+        rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+        req = rt_list_entry(nor->erase_list.next, struct qspi_nor_erase_req, list);
+        rt_mutex_release(&nor->lock);
+
+        result = qspi_nor_erase_range(nor, req->addr, req->size);
+
+        rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+        rt_list_remove(&req->list);
+        rt_mutex_release(&nor->lock);
+
+        if (req->done)
+        {
+            req->done(req, result);
+        }
+    }
+}
+
+rt_err_t qspi_nor_erase_async(struct qspi_nor *nor, struct qspi_nor_erase_req *req)
+{
+    rt_uint32_t end;
+
+    RT_ASSERT(nor);
+    RT_ASSERT(req);
+
+    if (req->size == 0 || req->addr >= nor->size || req->size > nor->size - req->addr)
+    {
+        return -RT_EINVAL;
+    }
+
+    end = req->addr + req->size;
+    req->addr -= req->addr % nor->sector_size;
+    req->size = (end + nor->sector_size - 1) / nor->sector_size * nor->sector_size - req->addr;
+
+    rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+    rt_list_insert_before(&nor->erase_list, &req->list);
+    rt_mutex_release(&nor->lock);
+    rt_sem_release(&nor->erase_sem);
+
+    return RT_EOK;
+}
+
+struct qspi_nor_erase_wait
+{
+    struct rt_semaphore sem;
+    rt_err_t result;
+};
+
+static void qspi_nor_erase_done(struct qspi_nor_erase_req *req, rt_err_t result)
+{
+    struct qspi_nor_erase_wait *wait = req->user_data;
+
+    wait->result = result;
+    rt_sem_release(&wait->sem);
+}
+
+int qspi_nor_erase(struct qspi_nor *nor, rt_uint32_t addr, rt_size_t size)
+{
+    struct qspi_nor_erase_wait wait;
+    struct qspi_nor_erase_req req;
+    rt_err_t result;
+
+    req.addr = addr;
+    req.size = size;
+    req.done = qspi_nor_erase_done;
+    req.user_data = &wait;
+
+    rt_sem_init(&wait.sem, "norwait", 0, RT_IPC_FLAG_FIFO);
+    result = qspi_nor_erase_async(nor, &req);
+    if (result == RT_EOK)
+    {
+        rt_sem_take(&wait.sem, RT_WAITING_FOREVER);
+        result = wait.result;
+    }
+    rt_sem_detach(&wait.sem);
+
+    return result == RT_EOK ? (int)size : result;
+}
+
+const void *qspi_nor_xip_take(struct qspi_nor *nor, rt_uint32_t addr, rt_size_t size)
+{
+    RT_ASSERT(nor);
+
+    if (nor->ops->map == RT_NULL || addr > nor->size || size > nor->size - addr)
+    {
+        return RT_NULL;
+    }
+
+    qspi_nor_begin(nor, addr, size);
+    if (qspi_nor_suspend(nor) == RT_EOK && qspi_nor_map(nor) == RT_EOK)
+    {
+        nor->xip_taken++;
+        return nor->mapped + addr;
+    }
+    qspi_nor_end(nor);
+
+    return RT_NULL;
+}
+
+void qspi_nor_xip_release(struct qspi_nor *nor)
+{
+    RT_ASSERT(nor);
+    RT_ASSERT(nor->xip_taken > 0);
+
+    nor->xip_taken--;
+    qspi_nor_end(nor);
+}
+
+void qspi_nor_get_stat(struct qspi_nor *nor, struct qspi_nor_stat *stat)
+{
+    RT_ASSERT(nor);
+    RT_ASSERT(stat);
+
+    rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+    *stat = nor->stat;
+    rt_mutex_release(&nor->lock);
+}
+
+static rt_err_t qspi_nor_probe(struct qspi_nor *nor)
+{
+    struct qspi_nor_cmd cmd;
+    rt_uint8_t *id = nor->jedec_id;
+    rt_err_t result;
+
+    qspi_nor_set_cmd(&cmd, QSPI_NOR_CMD_JEDEC_ID, 0, 1, 0);
+    result = nor->ops->command(nor, &cmd, RT_NULL, id, 3);
+    if (result != RT_EOK || id[0] == 0x00 || id[0] == 0xFF)
+    {
+        LOG_E("%s: no flash found, JEDEC ID %02X%02X%02X", nor->name, id[0], id[1], id[2]);
+        return -RT_EIO;
+    }
+
+    if (nor->size == 0)
+    {
+        /* the capacity code is log2 of the size, the codes of 64MB and above start at 0x20 */
+        if (id[2] >= 0x10 && id[2] <= 0x19)
+        {
+            nor->size = 1UL << id[2];
+        }
+        else if (id[2] >= 0x20 && id[2] <= 0x22)
+        {
+            nor->size = 1UL << (id[2] - 6);
+        }
+        else
+        {
+            LOG_E("%s: unknown capacity code 0x%02X, set the size", nor->name, id[2]);
+            return -RT_EIO;
+        }
+    }
+    if (nor->sector_size == 0)
+    {
+        nor->sector_size = 4096;
+    }
+    if (nor->block_size == 0 && nor->size >= 65536)
+    {
+        nor->block_size = 65536;
+    }
+    if (nor->page_size == 0)
+    {
+        nor->page_size = 256;
+    }
+
+    nor->addr_size = 3;
+    if (nor->size > 0x1000000)
+    {
+        nor->addr_size = 4;
+        result = qspi_nor_opcode(nor, QSPI_NOR_CMD_ENTER_4B_ADDR);
+        if (result != RT_EOK)
+        {
+            return result;
+        }
+    }
+    nor->read_cmd.addr_size = nor->addr_size;
+    nor->program_cmd.addr_size = nor->addr_size;
+
+    LOG_I("%s: JEDEC ID %02X%02X%02X, %d KB", nor->name, id[0], id[1], id[2], nor->size / 1024);
+
+    return RT_EOK;
+}
+
+rt_err_t qspi_nor_init(struct qspi_nor *nor, const char *name, const struct qspi_nor_ops *ops, void *user_data)
+{
+    rt_err_t result;
+    int i;
+
+    RT_ASSERT(nor);
+    RT_ASSERT(ops && ops->command);
+    RT_ASSERT(ops->map == RT_NULL || ops->unmap);
+
+    nor->name = name;
+    nor->ops = ops;
+    nor->user_data = user_data;
+    nor->mapped = RT_NULL;
+    nor->xip_taken = 0;
+    nor->erasing = RT_FALSE;
+    nor->suspended = RT_FALSE;
+    rt_memset(&nor->stat, 0, sizeof(nor->stat));
+    if (nor->suspend_min_us == 0)
+    {
+        nor->suspend_min_us = RT_QSPI_NOR_SUSPEND_MIN_US;
+    }
+    if (nor->read_cmd.opcode == 0)
+    {
+        qspi_nor_set_cmd(&nor->read_cmd, QSPI_NOR_CMD_FAST_READ, 1, 1, 8);
+    }
+    if (nor->program_cmd.opcode == 0)
+    {
+        qspi_nor_set_cmd(&nor->program_cmd, QSPI_NOR_CMD_PAGE_PROGRAM, 1, 1, 0);
+    }
+
+    result = qspi_nor_probe(nor);
+    if (result != RT_EOK)
+    {
+        return result;
+    }
+
+    nor->cache = RT_NULL;
+#if RT_QSPI_NOR_CACHE_LINES > 0
+    nor->cache = rt_malloc(RT_QSPI_NOR_CACHE_LINES * RT_QSPI_NOR_CACHE_LINE_SIZE);
+    if (nor->cache == RT_NULL)
+    {
+        LOG_E("%s: no memory for the read cache", name);
+        return -RT_ENOMEM;
+    }
+#endif
+    for (i = 0; i < (int)(sizeof(nor->cache_addr) / sizeof(nor->cache_addr[0])); i++)
+    {
+        nor->cache_addr[i] = QSPI_NOR_CACHE_INVALID;
+        nor->cache_age[i] = 0;
+    }
+    nor->cache_clock = 0;
+
+    rt_mutex_init(&nor->lock, name, RT_IPC_FLAG_PRIO);
+    rt_sem_init(&nor->erase_sem, name, 0, RT_IPC_FLAG_FIFO);
+    rt_list_init(&nor->erase_list);
+
+    nor->thread = rt_thread_create(name, qspi_nor_thread_entry, nor,
+                                   RT_QSPI_NOR_THREAD_STACK_SIZE, RT_QSPI_NOR_THREAD_PRIORITY, 10);
+    if (nor->thread == RT_NULL)
+    {
+        LOG_E("%s: create the erase thread failed", name);
+        rt_sem_detach(&nor->erase_sem);
+        rt_mutex_detach(&nor->lock);
+        rt_free(nor->cache);
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(nor->thread);
+
+    return RT_EOK;
+}
+
+void qspi_nor_deinit(struct qspi_nor *nor)
+{
+    RT_ASSERT(nor);
+
+    rt_mutex_take(&nor->lock, RT_WAITING_FOREVER);
+    RT_ASSERT(rt_list_isempty(&nor->erase_list));
+    rt_thread_delete(nor->thread);
+    qspi_nor_unmap(nor);
+    rt_mutex_release(&nor->lock);
+
+    rt_sem_detach(&nor->erase_sem);
+    rt_mutex_detach(&nor->lock);
+    if (nor->cache)
+    {
+        rt_free(nor->cache);
+        nor->cache = RT_NULL;
+    }
+}
+
+static rt_err_t qspi_nor_spi_command(struct qspi_nor *nor, const struct qspi_nor_cmd *cmd,
+                                     const void *tx, void *rx, rt_size_t len)
+{
+    struct rt_spi_device *spi = nor->user_data;
+    rt_uint8_t header[1 + 4 + 4];
+    rt_size_t n = 0;
+    int i;
+
+    header[n++] = cmd->opcode;
+    for (i = cmd->addr_size; i > 0; i--)
+    {
+        header[n++] = (rt_uint8_t)(cmd->addr >> ((i - 1) * 8));
+    }
+    for (i = 0; i < cmd->dummy_cycles / 8 && i < 4; i++)
+    {
+        header[n++] = 0xFF;
+    }
+
+    if (rx)
+    {
+        return rt_spi_send_then_recv(spi, header, n, rx, len);
+    }
+    if (tx)
+    {
+        return rt_spi_send_then_send(spi, header, n, tx, len);
+    }
+
+    return rt_spi_send(spi, header, n) == n ? RT_EOK : -RT_EIO;
+}
+
+rt_err_t qspi_nor_init_spi(struct qspi_nor *nor, const char *name, const char *spi_dev_name)
+{
+    static const struct qspi_nor_ops spi_ops =
+    {
+        qspi_nor_spi_command,
+        RT_NULL,
+        RT_NULL,
+    };
+    struct rt_spi_configuration cfg;
+    struct rt_spi_device *spi;
+
+    RT_ASSERT(nor);
+    RT_ASSERT(spi_dev_name);
+
+    spi = (struct rt_spi_device *)rt_device_find(spi_dev_name);
+    if (spi == RT_NULL)
+    {
+        LOG_E("%s: SPI device %s not found", name, spi_dev_name);
+        return -RT_ERROR;
+    }
+
+    cfg.mode = RT_SPI_MODE_0 | RT_SPI_MSB;
+    cfg.data_width = 8;
+    cfg.max_hz = RT_QSPI_NOR_SPI_MAX_HZ;
+    rt_spi_configure(spi, &cfg);
+
+    qspi_nor_set_cmd(&nor->read_cmd, QSPI_NOR_CMD_FAST_READ, 1, 1, 8);
+    qspi_nor_set_cmd(&nor->program_cmd, QSPI_NOR_CMD_PAGE_PROGRAM, 1, 1, 0);
+
+    return qspi_nor_init(nor, name, &spi_ops, spi);
+}
+
+#ifdef RT_USING_QSPI
+static void qspi_nor_qspi_message(const struct qspi_nor_cmd *cmd, struct rt_qspi_message *message,
+                                  const void *tx, void *rx, rt_size_t len)
+{
+    rt_memset(message, 0, sizeof(*message));
+
+    message->instruction.content = cmd->opcode;
+    message->instruction.qspi_lines = 1;
+    message->address.content = cmd->addr;
+    message->address.size = cmd->addr_size * 8;
+    message->address.qspi_lines = cmd->addr_size ? cmd->addr_lines : 0;
+    message->dummy_cycles = cmd->dummy_cycles;
+    message->qspi_data_lines = cmd->data_lines;
+
+    /* the controllers send the commands without data with a send buffer of length 0 */
+    message->parent.send_buf = (tx || rx) ? tx : &cmd->opcode;
+    message->parent.recv_buf = rx;
+    message->parent.length = len;
+    message->parent.cs_take = 1;
+    message->parent.cs_release = 1;
+}
+
+static rt_err_t qspi_nor_qspi_command(struct qspi_nor *nor, const struct qspi_nor_cmd *cmd,
+                                      const void *tx, void *rx, rt_size_t len)
+{
+    struct rt_qspi_message message;
+    rt_size_t result;
+
+    qspi_nor_qspi_message(cmd, &message, tx, rx, len);
+    if (len == 0)
+    {
+        message.qspi_data_lines = 0;
+    }
+
+    result = rt_qspi_transfer_message(nor->user_data, &message);
+    if (rt_get_errno() != RT_EOK || (len > 0 && result != len))
+    {
+        return -RT_EIO;
+    }
+
+    return RT_EOK;
+}
+
+static const void *qspi_nor_qspi_map(struct qspi_nor *nor, const struct qspi_nor_cmd *read_cmd)
+{
+    struct rt_qspi_message message;
+
+    qspi_nor_qspi_message(read_cmd, &message, RT_NULL, RT_NULL, 0);
+
+    return qspi_nor_port_map(nor->user_data, &message);
+}
+
+static void qspi_nor_qspi_unmap(struct qspi_nor *nor)
+{
+    qspi_nor_port_unmap(nor->user_data);
+}
+
+RT_WEAK const void *qspi_nor_port_map(struct rt_qspi_device *device, struct rt_qspi_message *message)
+{
+    return RT_NULL;
+}
+
+RT_WEAK void qspi_nor_port_unmap(struct rt_qspi_device *device)
+{
+}
+
+rt_err_t qspi_nor_init_qspi(struct qspi_nor *nor, const char *name, const char *qspi_dev_name)
+{
+    static const struct qspi_nor_ops qspi_ops =
+    {
+        qspi_nor_qspi_command,
+        qspi_nor_qspi_map,
+        qspi_nor_qspi_unmap,
+    };
+    struct rt_qspi_device *qspi;
+    rt_uint8_t lines;
+
+    RT_ASSERT(nor);
+    RT_ASSERT(qspi_dev_name);
+
+    qspi = (struct rt_qspi_device *)rt_device_find(qspi_dev_name);
+    if (qspi == RT_NULL)
+    {
+        LOG_E("%s: QSPI device %s not found", name, qspi_dev_name);
+        return -RT_ERROR;
+    }
+
+    lines = qspi->config.qspi_dl_width;
+    if (lines == 4)
+    {
+        qspi_nor_set_cmd(&nor->read_cmd, QSPI_NOR_CMD_QUAD_OUTPUT_READ, 1, 4, 8);
+        qspi_nor_set_cmd(&nor->program_cmd, QSPI_NOR_CMD_QUAD_PAGE_PROGRAM, 1, 4, 0);
+    }
+    else
+    {
+        qspi_nor_set_cmd(&nor->read_cmd, QSPI_NOR_CMD_FAST_READ, 1, 1, 8);
+        qspi_nor_set_cmd(&nor->program_cmd, QSPI_NOR_CMD_PAGE_PROGRAM, 1, 1, 0);
+    }
+    if (qspi->enter_qspi_mode)
+    {
+        qspi->enter_qspi_mode(qspi);
+    }
+
+    return qspi_nor_init(nor, name, &qspi_ops, qspi);
+}
+#endif /* RT_USING_QSPI */
+
+#ifdef RT_QSPI_NOR_USING_FAL
+
+#ifndef RT_QSPI_NOR_FAL_DEV_NAME
+#define RT_QSPI_NOR_FAL_DEV_NAME        "qspinor0"
+#endif
+
+static struct qspi_nor *fal_nor;
+
+static int qspi_nor_fal_init(void)
+{
+    if (fal_nor == RT_NULL)
+    {
+        return -1;
+    }
+
+    qspi_nor_flash0.len = fal_nor->size;
+    qspi_nor_flash0.blk_size = fal_nor->sector_size;
+
+    return 0;
+}
+
+static int qspi_nor_fal_read(long offset, rt_uint8_t *buf, size_t size)
+{
+    return qspi_nor_read(fal_nor, qspi_nor_flash0.addr + offset, buf, size);
+}
+
+static int qspi_nor_fal_write(long offset, const rt_uint8_t *buf, size_t size)
+{
+    return qspi_nor_write(fal_nor, qspi_nor_flash0.addr + offset, buf, size);
+}
+
+static int qspi_nor_fal_erase(long offset, size_t size)
+{
+    return qspi_nor_erase(fal_nor, qspi_nor_flash0.addr + offset, size);
+}
+
+struct fal_flash_dev qspi_nor_flash0 =
+{
+    .name       = RT_QSPI_NOR_FAL_DEV_NAME,
+    .addr       = 0,
+    .len        = 0,
+    .blk_size   = 4096,
+    .ops        = {qspi_nor_fal_init, qspi_nor_fal_read, qspi_nor_fal_write, qspi_nor_fal_erase},
+    .write_gran = 1
+};
+
+void qspi_nor_fal_bind(struct qspi_nor *nor)
+{
+    fal_nor = nor;
+}
+#endif /* RT_QSPI_NOR_USING_FAL */
+
+#endif /* RT_USING_QSPI_NOR */
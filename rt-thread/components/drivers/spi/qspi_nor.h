@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef _QSPI_NOR_H_
+#define _QSPI_NOR_H_
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef RT_QSPI_NOR_SUSPEND_MIN_US
+#define RT_QSPI_NOR_SUSPEND_MIN_US      500
+#endif
+
+#ifndef RT_QSPI_NOR_CACHE_LINES
+#define RT_QSPI_NOR_CACHE_LINES         4
+#endif
+
+#ifndef RT_QSPI_NOR_CACHE_LINE_SIZE
+#define RT_QSPI_NOR_CACHE_LINE_SIZE     256
+#endif
+
+/* commands of the SPI NOR flash */
+#define QSPI_NOR_CMD_WRITE_ENABLE       0x06
+#define QSPI_NOR_CMD_READ_STATUS        0x05
+#define QSPI_NOR_CMD_FAST_READ          0x0B
+#define QSPI_NOR_CMD_QUAD_OUTPUT_READ   0x6B
+#define QSPI_NOR_CMD_PAGE_PROGRAM       0x02
+#define QSPI_NOR_CMD_QUAD_PAGE_PROGRAM  0x32
+#define QSPI_NOR_CMD_SECTOR_ERASE       0x20    /* 4KB */
+#define QSPI_NOR_CMD_BLOCK_ERASE        0xD8    /* 64KB */
+#define QSPI_NOR_CMD_ERASE_SUSPEND      0x75
+#define QSPI_NOR_CMD_ERASE_RESUME       0x7A
+#define QSPI_NOR_CMD_JEDEC_ID           0x9F
+#define QSPI_NOR_CMD_ENTER_4B_ADDR      0xB7
+
+#define QSPI_NOR_STATUS_BUSY            0x01
+#define QSPI_NOR_STATUS_WEL             0x02
+
+struct qspi_nor;
+
+struct qspi_nor_cmd
+{
+    rt_uint8_t opcode;
+    rt_uint8_t addr_size;               /* bytes of the address, 0: no address */
+    rt_uint8_t addr_lines;
+    rt_uint8_t data_lines;
+    rt_uint8_t dummy_cycles;
+    rt_uint32_t addr;
+};
+
+/*
+ * The controller of the flash. `command` sends a command in the indirect
+ * mode with the data of `tx` or into `rx`, or without data when both are
+ * RT_NULL. `map` switches the controller to the memory mapped mode with the
+ * read command and returns the address of the flash in the memory, `unmap`
+ * leaves the mode. Controllers without the memory mapped mode set them to
+ * RT_NULL, the reads go through the read cache then.
+ */
+struct qspi_nor_ops
+{
+    rt_err_t (*command)(struct qspi_nor *nor, const struct qspi_nor_cmd *cmd,
+                        const void *tx, void *rx, rt_size_t len);
+    const void *(*map)(struct qspi_nor *nor, const struct qspi_nor_cmd *read_cmd);
+    void (*unmap)(struct qspi_nor *nor);
+};
+
+struct qspi_nor_stat
+{
+    rt_uint32_t reads;
+    rt_uint32_t mapped_reads;           /* reads from the memory mapped flash */
+    rt_uint32_t cache_hits;
+    rt_uint32_t cache_misses;
+    rt_uint32_t writes;
+    rt_uint32_t erases;                 /* sectors and blocks */
+    rt_uint32_t suspends;               /* erases suspended for a read or write */
+    rt_uint32_t erase_waits;            /* reads and writes waiting for the erase of their sector */
+};
+
+/* an erase in the background, see qspi_nor_erase_async() */
+struct qspi_nor_erase_req
+{
+    rt_list_t list;
+    rt_uint32_t addr;
+    rt_uint32_t size;
+    void (*done)(struct qspi_nor_erase_req *req, rt_err_t result);
+    void *user_data;
+};
+
+/*
+ * NOR flash on a SPI or QSPI controller.
+ *
+ * The erases run in a thread of the flash. The thread starts an erase and
+ * polls the status while the lock is free, so the reads and writes of the
+ * other sectors suspend the erase, run, and resume it instead of waiting for
+ * tens of milliseconds. A resumed erase runs at least `suspend_min_us` before
+ * it's suspended again, or a stream of reads would stop it.
+ *
+ * The structure is zeroed by the user. The geometry is read from the JEDEC ID
+ * unless it's set before qspi_nor_init(), e.g. for flashes with another capacity code. Set
+ * `erase_blocking` before it for flashes without erase suspend, the reads and
+ * writes wait for the erases then. `suspend_min_us` can be changed anytime.
+ */
+struct qspi_nor
+{
+    const char *name;
+    const struct qspi_nor_ops *ops;
+    void *user_data;                    /* of the controller */
+
+    rt_uint32_t size;
+    rt_uint32_t sector_size;            /* erase granularity */
+    rt_uint32_t block_size;             /* of the block erase, 0: sector erases only */
+    rt_uint16_t page_size;
+    rt_uint8_t addr_size;
+    rt_bool_t erase_blocking;           /* the flash can't suspend an erase */
+    rt_uint32_t suspend_min_us;
+    rt_uint8_t jedec_id[3];
+
+    struct qspi_nor_cmd read_cmd;
+    struct qspi_nor_cmd program_cmd;
+
+    struct rt_mutex lock;
+    const rt_uint8_t *mapped;           /* the flash in the memory in the memory mapped mode */
+    int xip_taken;
+
+    /* the erase of the thread */
+    rt_bool_t erasing;
+    rt_bool_t suspended;
+    rt_uint32_t erase_addr;
+    rt_uint32_t erase_size;
+    rt_uint32_t resume_time;
+    rt_list_t erase_list;
+    struct rt_semaphore erase_sem;
+    rt_thread_t thread;
+
+    rt_uint8_t *cache;
+    rt_uint32_t cache_addr[RT_QSPI_NOR_CACHE_LINES > 0 ? RT_QSPI_NOR_CACHE_LINES : 1];
+    rt_uint32_t cache_age[RT_QSPI_NOR_CACHE_LINES > 0 ? RT_QSPI_NOR_CACHE_LINES : 1];
+    rt_uint32_t cache_clock;
+
+    struct qspi_nor_stat stat;
+};
+
+/**
+ * probe the flash on a controller and start the erase thread
+ *
+ * @param nor flash
+ * @param name name of the flash and the thread
+ * @param ops operations of the controller
+ * @param user_data user data of the controller
+ *
+ * @return RT_EOK on success, -RT_EIO if the flash doesn't answer
+ */
+rt_err_t qspi_nor_init(struct qspi_nor *nor, const char *name, const struct qspi_nor_ops *ops, void *user_data);
+
+/**
+ * probe the flash on a SPI device, with the fast read and the page program
+ * commands on one line
+ */
+rt_err_t qspi_nor_init_spi(struct qspi_nor *nor, const char *name, const char *spi_dev_name);
+
+#ifdef RT_USING_QSPI
+/**
+ * probe the flash on a QSPI device, with the quad output read and the quad
+ * page program commands when the device has 4 data lines. The enter_qspi_mode
+ * callback of the device must set the quad enable bit of the flash.
+ *
+ * The memory mapped mode is used when the BSP implements qspi_nor_port_map()
+ * and qspi_nor_port_unmap().
+ */
+rt_err_t qspi_nor_init_qspi(struct qspi_nor *nor, const char *name, const char *qspi_dev_name);
+
+/* the memory mapped mode of the QSPI controller, implemented by the BSP */
+const void *qspi_nor_port_map(struct rt_qspi_device *device, struct rt_qspi_message *message);
+void qspi_nor_port_unmap(struct rt_qspi_device *device);
+#endif /* RT_USING_QSPI */
+
+/**
+ * stop the erase thread, no erase may be pending
+ */
+void qspi_nor_deinit(struct qspi_nor *nor);
+
+/**
+ * read the flash, an erase of other sectors is suspended
+ *
+ * @return the size on success, -RT_EINVAL or -RT_EIO on failure
+ */
+int qspi_nor_read(struct qspi_nor *nor, rt_uint32_t addr, void *buf, rt_size_t size);
+
+/**
+ * program the flash, the bits can only be cleared. An erase of other sectors
+ * is suspended for each page.
+ *
+ * @return the size on success, -RT_EINVAL or -RT_EIO on failure
+ */
+int qspi_nor_write(struct qspi_nor *nor, rt_uint32_t addr, const void *buf, rt_size_t size);
+
+/**
+ * erase the sectors of a range and wait for it, the reads and writes of the
+ * other sectors go on meanwhile
+ *
+ * @param nor flash
+ * @param addr start of the range, aligned down to the sector
+ * @param size size of the range, the end is aligned up to the sector
+ *
+ * @return the size on success, -RT_EINVAL, -RT_EIO or -RT_ETIMEOUT on failure
+ */
+int qspi_nor_erase(struct qspi_nor *nor, rt_uint32_t addr, rt_size_t size);
+
+/**
+ * queue an erase for the thread of the flash, `done` is called by the thread
+ * when it's finished. The request must stay valid until then.
+ *
+ * @return RT_EOK on success, -RT_EINVAL if the range isn't in the flash
+ */
+rt_err_t qspi_nor_erase_async(struct qspi_nor *nor, struct qspi_nor_erase_req *req);
+
+/**
+ * map a range of the flash to the memory, e.g. to show an image in place. The
+ * erases are suspended and the other commands wait until the range is
+ * released, so keep it short.
+ *
+ * @return the range in the memory, RT_NULL if the controller can't map it
+ */
+const void *qspi_nor_xip_take(struct qspi_nor *nor, rt_uint32_t addr, rt_size_t size);
+void qspi_nor_xip_release(struct qspi_nor *nor);
+
+void qspi_nor_get_stat(struct qspi_nor *nor, struct qspi_nor_stat *stat);
+
+#ifdef RT_QSPI_NOR_USING_FAL
+#include <fal.h>
+
+/* FAL flash device of qspi_nor_fal_bind(), add it to FAL_FLASH_DEV_TABLE */
+extern struct fal_flash_dev qspi_nor_flash0;
+
+/**
+ * use a flash for qspi_nor_flash0, before fal_init()
+ */
+void qspi_nor_fal_bind(struct qspi_nor *nor);
+#endif /* RT_QSPI_NOR_USING_FAL */
+
+#ifdef RT_QSPI_NOR_USING_SIM
+/*
+ * Simulated NOR flash in RAM with the timing of a QSPI NOR flash. An erase
+ * runs in the background from the erase command and completes when the
+ * status is read after its time, a suspend stops it and a resume starts it
+ * again after `resume_us`. The programs and reads take their time in the
+ * command. The commands the flash would reject, e.g. a program while an
+ * erase runs or a read of the suspended sector, are counted in `errors`.
+ */
+struct qspi_nor_sim
+{
+    rt_uint8_t *data;
+    rt_uint32_t size;
+    rt_bool_t xip;                      /* the controller has the memory mapped mode */
+    rt_uint8_t lines;                   /* data lines of the reads and programs */
+
+    /* timing */
+    rt_uint32_t sector_erase_us;
+    rt_uint32_t block_erase_us;
+    rt_uint32_t page_program_us;
+    rt_uint32_t suspend_us;             /* from the suspend to the end of the busy status */
+    rt_uint32_t resume_us;              /* from the resume to the progress of the erase */
+    rt_uint32_t command_ns;             /* instruction, address and dummy cycles */
+    rt_uint32_t byte_ns;                /* a data byte on one line */
+
+    /* state */
+    rt_bool_t wel;
+    rt_bool_t mapped;
+    rt_bool_t erasing;
+    rt_bool_t suspended;
+    rt_uint32_t erase_addr;
+    rt_uint32_t erase_size;
+    rt_uint32_t erase_left_us;
+    rt_uint32_t run_time;               /* of the erase command or the last resume */
+
+    rt_uint32_t errors;
+    rt_uint32_t erase_busy_us;          /* time of the completed erases, with the suspends */
+    rt_uint32_t erase_start;
+};
+
+/**
+ * create a simulated flash with the timing of a W25Q series flash, erased
+ *
+ * @param size size of the flash, a power of 2 of at least 64KB
+ * @param lines data lines, 1 or 4
+ * @param xip the controller has the memory mapped mode
+ */
+struct qspi_nor_sim *qspi_nor_sim_create(rt_uint32_t size, rt_uint8_t lines, rt_bool_t xip);
+void qspi_nor_sim_delete(struct qspi_nor_sim *sim);
+
+/**
+ * probe the simulated flash
+ */
+rt_err_t qspi_nor_init_sim(struct qspi_nor *nor, const char *name, struct qspi_nor_sim *sim);
+#endif /* RT_QSPI_NOR_USING_SIM */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QSPI_NOR_H_ */
@@ -0,0 +1,399 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and self test of the NOR flash driver on the simulated flash.
+ *
+ * The latency test erases sectors in the background while the shell thread
+ * reads other sectors every few milliseconds: with the reads waiting for the
+ * erases, with the erases suspended for the reads after a short and a long
+ * minimum erase time, and with the memory mapped mode. The cache test reads
+ * small records like a key-value store does. The self test erases, programs
+ * and reads different sectors from three threads and compares the flash with
+ * the data written, the simulated flash counts the commands a real flash
+ * would reject.
+ *
+ * Enable RT_USING_CPUTIME for the times in microseconds.
+ *
+ * msh: qspi_nor_bench
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "qspi_nor.h"
+
+#define BENCH_FLASH_SIZE        (1024 * 1024)
+#define BENCH_SECTOR_SIZE       4096
+#define BENCH_ERASE_ADDR        BENCH_SECTOR_SIZE   /* not aligned to a block, sector erases only */
+#define BENCH_ERASE_SECTORS     16
+#define BENCH_READ_ADDR         (128 * 1024)
+#define BENCH_READ_SIZE         256
+#define BENCH_READ_PERIOD_MS    4
+#define BENCH_RECORD_SIZE       16
+#define BENCH_RECORD_SECTORS    2
+#define BENCH_RECORD_READS      2000
+
+#define CHECK_ERASE_SECTORS     4
+#define CHECK_ROUNDS            6
+#define CHECK_READ_ADDR         (64 * 1024)
+#define CHECK_WRITE_ADDR        (128 * 1024)
+#define CHECK_AREA_SIZE         (64 * 1024)
+#define CHECK_PAGE_SIZE         256
+
+static rt_uint32_t seed;
+static struct rt_semaphore bench_sem;
+static rt_uint32_t erase_end;
+static rt_err_t erase_result;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static rt_uint32_t bench_time_us(void)
+{
+#ifdef RT_USING_CPUTIME
+    return (rt_uint32_t)(clock_cpu_gettime() * (double)clock_cpu_getres() / 1000);
+#else
+    return rt_tick_get() * (1000000 / RT_TICK_PER_SECOND);
+#endif
+}
+
+static void bench_erase_done(struct qspi_nor_erase_req *req, rt_err_t result)
+{
+    erase_end = bench_time_us();
+    erase_result = result;
+    rt_sem_release(&bench_sem);
+}
+
+static struct qspi_nor_sim *bench_open(struct qspi_nor *nor, rt_uint8_t lines, rt_bool_t xip,
+                                       rt_bool_t blocking, rt_uint32_t min_us)
+{
+    struct qspi_nor_sim *sim;
+
+    sim = qspi_nor_sim_create(BENCH_FLASH_SIZE, lines, xip);
+    if (sim == RT_NULL)
+    {
+        rt_kprintf("no memory for the simulated flash\n");
+        return RT_NULL;
+    }
+
+    rt_memset(nor, 0, sizeof(*nor));
+    nor->erase_blocking = blocking;
+    nor->suspend_min_us = min_us;
+    if (qspi_nor_init_sim(nor, "norbench", sim) != RT_EOK)
+    {
+        qspi_nor_sim_delete(sim);
+        return RT_NULL;
+    }
+
+    return sim;
+}
+
+static void bench_close(struct qspi_nor *nor, struct qspi_nor_sim *sim)
+{
+    qspi_nor_deinit(nor);
+    qspi_nor_sim_delete(sim);
+}
+
+static int bench_latency(const char *mode, rt_bool_t xip, rt_bool_t blocking, rt_uint32_t min_us)
+{
+    static rt_uint8_t buf[BENCH_READ_SIZE];
+    struct qspi_nor_erase_req req;
+    struct qspi_nor_stat stat;
+    struct qspi_nor_sim *sim;
+    struct qspi_nor nor;
+    rt_uint32_t start, time, latency, total = 0, max = 0, reads = 0;
+    rt_uint32_t addr, errors;
+
+    sim = bench_open(&nor, 4, xip, blocking, min_us);
+    if (sim == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    req.addr = BENCH_ERASE_ADDR;
+    req.size = BENCH_ERASE_SECTORS * BENCH_SECTOR_SIZE;
+    req.done = bench_erase_done;
+    start = bench_time_us();
+    qspi_nor_erase_async(&nor, &req);
+
+    while (rt_sem_trytake(&bench_sem) != RT_EOK)
+    {
+        addr = BENCH_READ_ADDR + bench_rand() % (BENCH_FLASH_SIZE - BENCH_READ_ADDR - BENCH_READ_SIZE);
+        time = bench_time_us();
+        qspi_nor_read(&nor, addr, buf, BENCH_READ_SIZE);
+        latency = bench_time_us() - time;
+        total += latency;
+        if (latency > max)
+        {
+            max = latency;
+        }
+        reads++;
+        rt_thread_mdelay(BENCH_READ_PERIOD_MS);
+    }
+
+    qspi_nor_get_stat(&nor, &stat);
+    errors = sim->errors;
+    bench_close(&nor, sim);
+
+    rt_kprintf("%-18s %6d %8d %8d %9d %9d\n", mode, reads, reads ? total / reads : 0, max,
+               (erase_end - start) / 1000, stat.suspends);
+    if (erase_result != RT_EOK || errors)
+    {
+        rt_kprintf("  erase result %d, %d commands rejected by the flash\n", erase_result, errors);
+        return -RT_ERROR;
+    }
+
+    return RT_EOK;
+}
+
+static int bench_cache(void)
+{
+    static rt_uint8_t buf[BENCH_SECTOR_SIZE];
+    struct qspi_nor_stat stat;
+    struct qspi_nor_sim *sim;
+    struct qspi_nor nor;
+    rt_uint32_t records = BENCH_RECORD_SECTORS * BENCH_SECTOR_SIZE / BENCH_RECORD_SIZE;
+    rt_uint32_t time, hits, misses, i;
+
+    /* SPI flash without the memory mapped mode */
+    sim = bench_open(&nor, 1, RT_FALSE, RT_FALSE, 0);
+    if (sim == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    rt_kprintf("\n%-18s %8s %8s %9s\n", "records", "reads", "us/read", "hit rate");
+
+    time = bench_time_us();
+    for (i = 0; i < records; i++)
+    {
+        qspi_nor_read(&nor, i * BENCH_RECORD_SIZE, buf, BENCH_RECORD_SIZE);
+    }
+    time = bench_time_us() - time;
+    qspi_nor_get_stat(&nor, &stat);
+    rt_kprintf("%-18s %8d %8d %8d%%\n", "sequential", records, time / records,
+               stat.cache_hits * 100 / (stat.cache_hits + stat.cache_misses));
+
+    hits = stat.cache_hits;
+    misses = stat.cache_misses;
+    time = bench_time_us();
+    for (i = 0; i < BENCH_RECORD_READS; i++)
+    {
+        qspi_nor_read(&nor, bench_rand() % records * BENCH_RECORD_SIZE, buf, BENCH_RECORD_SIZE);
+    }
+    time = bench_time_us() - time;
+    qspi_nor_get_stat(&nor, &stat);
+    hits = stat.cache_hits - hits;
+    misses = stat.cache_misses - misses;
+    rt_kprintf("%-18s %8d %8d %8d%%\n", "random", BENCH_RECORD_READS, time / BENCH_RECORD_READS,
+               hits * 100 / (hits + misses));
+
+    /* whole lines bypass the cache */
+    time = bench_time_us();
+    qspi_nor_read(&nor, 0, buf, BENCH_SECTOR_SIZE);
+    time = bench_time_us() - time;
+    rt_kprintf("%-18s %8d %8d\n", "sector", 1, time);
+
+    bench_close(&nor, sim);
+
+    return RT_EOK;
+}
+
+static rt_uint8_t check_pattern(rt_uint32_t addr, rt_uint32_t round)
+{
+    return (rt_uint8_t)(addr * 31 + (addr >> 8) + round * 7);
+}
+
+struct check_reader
+{
+    struct qspi_nor *nor;
+    volatile rt_bool_t stop;
+    rt_uint32_t reads;
+    rt_uint32_t mismatches;
+};
+
+static void check_reader_entry(void *parameter)
+{
+    struct check_reader *reader = parameter;
+    rt_uint8_t buf[64];
+    rt_uint32_t addr, i;
+
+    while (!reader->stop)
+    {
+        addr = CHECK_READ_ADDR + bench_rand() % (CHECK_AREA_SIZE - sizeof(buf));
+        if (qspi_nor_read(reader->nor, addr, buf, sizeof(buf)) != sizeof(buf))
+        {
+            reader->mismatches++;
+        }
+        for (i = 0; i < sizeof(buf); i++)
+        {
+            if (buf[i] != check_pattern(addr + i, 0))
+            {
+                reader->mismatches++;
+                break;
+            }
+        }
+        reader->reads++;
+        rt_thread_mdelay(1);
+    }
+
+    rt_sem_release(&bench_sem);
+}
+
+static rt_bool_t check_area(struct qspi_nor *nor, rt_uint32_t addr, rt_uint32_t size, int round)
+{
+    static rt_uint8_t buf[CHECK_PAGE_SIZE];
+    rt_uint32_t pos, i;
+
+    for (pos = 0; pos < size; pos += sizeof(buf))
+    {
+        if (qspi_nor_read(nor, addr + pos, buf, sizeof(buf)) != sizeof(buf))
+        {
+            return RT_FALSE;
+        }
+        for (i = 0; i < sizeof(buf); i++)
+        {
+            if (buf[i] != (round < 0 ? 0xFF : check_pattern(addr + pos + i, round)))
+            {
+                return RT_FALSE;
+            }
+        }
+    }
+
+    return RT_TRUE;
+}
+
+static rt_bool_t write_area(struct qspi_nor *nor, rt_uint32_t addr, rt_uint32_t size, int round)
+{
+    static rt_uint8_t buf[CHECK_PAGE_SIZE];
+    rt_uint32_t pos, i;
+
+    for (pos = 0; pos < size; pos += sizeof(buf))
+    {
+        for (i = 0; i < sizeof(buf); i++)
+        {
+            buf[i] = check_pattern(addr + pos + i, round);
+        }
+        if (qspi_nor_write(nor, addr + pos, buf, sizeof(buf)) != sizeof(buf))
+        {
+            return RT_FALSE;
+        }
+    }
+
+    return RT_TRUE;
+}
+
+/* erases, programs and reads of different sectors at the same time */
+static int bench_check(rt_bool_t xip)
+{
+    struct check_reader reader;
+    struct qspi_nor_erase_req req;
+    struct qspi_nor_stat stat;
+    struct qspi_nor_sim *sim;
+    struct qspi_nor nor;
+    rt_thread_t thread;
+    rt_uint32_t written = 0;
+    rt_bool_t pass = RT_TRUE;
+    int round;
+
+    sim = bench_open(&nor, 4, xip, RT_FALSE, 200);
+    if (sim == RT_NULL)
+    {
+        return -RT_ERROR;
+    }
+
+    write_area(&nor, CHECK_READ_ADDR, CHECK_AREA_SIZE, 0);
+    reader.nor = &nor;
+    reader.stop = RT_FALSE;
+    reader.reads = 0;
+    reader.mismatches = 0;
+    thread = rt_thread_create("norcheck", check_reader_entry, &reader, 1024, RT_THREAD_PRIORITY_MAX - 3, 10);
+    if (thread == RT_NULL)
+    {
+        bench_close(&nor, sim);
+        return -RT_ENOMEM;
+    }
+    rt_thread_startup(thread);
+
+    for (round = 1; round <= CHECK_ROUNDS && pass; round++)
+    {
+        req.addr = 0;
+        req.size = CHECK_ERASE_SECTORS * BENCH_SECTOR_SIZE;
+        req.done = bench_erase_done;
+        qspi_nor_erase_async(&nor, &req);
+
+        /* program the pages of another area while the sectors are erased */
+        while (rt_sem_trytake(&bench_sem) != RT_EOK)
+        {
+            if (written < CHECK_AREA_SIZE)
+            {
+                pass = write_area(&nor, CHECK_WRITE_ADDR + written, CHECK_PAGE_SIZE, 0) && pass;
+                written += CHECK_PAGE_SIZE;
+            }
+            else
+            {
+                rt_thread_mdelay(1);
+            }
+        }
+
+        pass = pass && erase_result == RT_EOK && check_area(&nor, 0, req.size, -1);
+        pass = pass && write_area(&nor, 0, req.size, round) && check_area(&nor, 0, req.size, round);
+    }
+
+    reader.stop = RT_TRUE;
+    rt_sem_take(&bench_sem, RT_WAITING_FOREVER);
+
+    if (written < CHECK_AREA_SIZE)
+    {
+        pass = pass && write_area(&nor, CHECK_WRITE_ADDR + written, CHECK_AREA_SIZE - written, 0);
+    }
+    pass = pass && check_area(&nor, CHECK_WRITE_ADDR, CHECK_AREA_SIZE, 0);
+    pass = pass && reader.mismatches == 0 && sim->errors == 0;
+
+    qspi_nor_get_stat(&nor, &stat);
+    rt_kprintf("self test%s: %s, %d reads and %d writes during %d erases, %d suspends, %d mismatches, "
+               "%d commands rejected by the flash\n", xip ? " (mapped)" : "", pass ? "PASS" : "FAIL",
+               reader.reads, stat.writes, stat.erases, stat.suspends, reader.mismatches, sim->errors);
+
+    bench_close(&nor, sim);
+
+    return pass ? RT_EOK : -RT_ERROR;
+}
+
+static int qspi_nor_bench(void)
+{
+    int result = RT_EOK;
+
+    seed = 1;
+    rt_sem_init(&bench_sem, "norbench", 0, RT_IPC_FLAG_FIFO);
+
+    rt_kprintf("%d sector erases, %d bytes read every %d ms from other sectors\n",
+               BENCH_ERASE_SECTORS, BENCH_READ_SIZE, BENCH_READ_PERIOD_MS);
+    rt_kprintf("%-18s %6s %8s %8s %9s %9s\n", "mode", "reads", "avg us", "max us", "erase ms", "suspends");
+    result |= bench_latency("blocking", RT_FALSE, RT_TRUE, 0);
+    result |= bench_latency("suspend 200us", RT_FALSE, RT_FALSE, 200);
+    result |= bench_latency("suspend 1000us", RT_FALSE, RT_FALSE, 1000);
+    result |= bench_latency("suspend 200us xip", RT_TRUE, RT_FALSE, 200);
+
+    result |= bench_cache();
+
+    rt_kprintf("\n");
+    result |= bench_check(RT_FALSE);
+    result |= bench_check(RT_TRUE);
+
+    rt_sem_detach(&bench_sem);
+
+    return result == RT_EOK ? 0 : -1;
+}
+MSH_CMD_EXPORT(qspi_nor_bench, benchmark of the NOR flash driver with background erases);
@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "qspi_nor.h"
+
+#ifdef RT_QSPI_NOR_USING_SIM
+
+#define SIM_PAGE_SIZE       256
+#define SIM_SECTOR_SIZE     4096
+#define SIM_BLOCK_SIZE      65536
+
+static rt_uint32_t sim_time_us(void)
+{
+#ifdef RT_USING_CPUTIME
+    return (rt_uint32_t)(clock_cpu_gettime() * (double)clock_cpu_getres() / 1000);
+#else
+    return rt_tick_get() * (1000000 / RT_TICK_PER_SECOND);
+#endif
+}
+
+/* time the erase has run since the command or the last resume */
+static rt_uint32_t sim_erase_run(struct qspi_nor_sim *sim)
+{
+    rt_uint32_t run = sim_time_us() - sim->run_time;
+
+    return run > sim->resume_us ? run - sim->resume_us : 0;
+}
+
+static void sim_update(struct qspi_nor_sim *sim)
+{
+    if (!sim->erasing || sim->suspended)
+    {
+        return;
+    }
+
+    if (sim_erase_run(sim) >= sim->erase_left_us)
+    {
+        rt_memset(sim->data + sim->erase_addr, 0xFF, sim->erase_size);
+        sim->erasing = RT_FALSE;
+        sim->erase_busy_us += sim_time_us() - sim->erase_start;
+    }
+}
+
+static rt_bool_t sim_in_erase(struct qspi_nor_sim *sim, rt_uint32_t addr, rt_size_t len)
+{
+    return sim->erasing && addr < sim->erase_addr + sim->erase_size && sim->erase_addr < addr + len;
+}
+
+static void sim_erase(struct qspi_nor_sim *sim, rt_uint32_t addr, rt_uint32_t size, rt_uint32_t time_us)
+{
+    sim->erasing = RT_TRUE;
+    sim->suspended = RT_FALSE;
+    sim->erase_addr = addr - addr % size;
+    sim->erase_size = size;
+    sim->erase_left_us = time_us;
+    sim->erase_start = sim->run_time = sim_time_us();
+    /* the erase starts right away */
+    sim->run_time -= sim->resume_us;
+}
+
+static rt_err_t sim_command(struct qspi_nor *nor, const struct qspi_nor_cmd *cmd,
+                            const void *tx, void *rx, rt_size_t len)
+{
+    struct qspi_nor_sim *sim = nor->user_data;
+    const rt_uint8_t *in = tx;
+    rt_uint8_t *out = rx;
+    rt_uint32_t addr = cmd->addr;
+    rt_uint32_t bus_ns;
+    rt_bool_t busy;
+    rt_size_t i;
+
+    if (sim->mapped)
+    {
+        /* the controller must leave the memory mapped mode first */
+        sim->errors++;
+    }
+    sim_update(sim);
+    busy = sim->erasing && !sim->suspended;
+
+    bus_ns = sim->command_ns + len * sim->byte_ns / (cmd->data_lines ? cmd->data_lines : 1);
+    if (bus_ns >= 1000)
+    {
+        rt_hw_us_delay(bus_ns / 1000);
+    }
+
+    if (cmd->addr_size && (addr >= sim->size || len > sim->size - addr))
+    {
+        sim->errors++;
+        return -RT_EIO;
+    }
+
+    switch (cmd->opcode)
+    {
+    case QSPI_NOR_CMD_READ_STATUS:
+        for (i = 0; i < len; i++)
+        {
+            out[i] = (busy ? QSPI_NOR_STATUS_BUSY : 0) | (sim->wel ? QSPI_NOR_STATUS_WEL : 0);
+        }
+        break;
+
+    case QSPI_NOR_CMD_JEDEC_ID:
+        /* Winbond W25Q, the capacity code is log2 of the size */
+        out[0] = 0xEF;
+        out[1] = 0x40;
+        out[2] = (rt_uint8_t)__rt_ffs(sim->size) - 1;
+        break;
+
+    case QSPI_NOR_CMD_WRITE_ENABLE:
+        if (busy)
+        {
+            sim->errors++;
+        }
+        sim->wel = RT_TRUE;
+        break;
+
+    case QSPI_NOR_CMD_FAST_READ:
+    case QSPI_NOR_CMD_QUAD_OUTPUT_READ:
+        /* the suspended sector reads as garbage */
+        if (busy || sim_in_erase(sim, addr, len))
+        {
+            sim->errors++;
+        }
+        rt_memcpy(out, sim->data + addr, len);
+        break;
+
+    case QSPI_NOR_CMD_PAGE_PROGRAM:
+    case QSPI_NOR_CMD_QUAD_PAGE_PROGRAM:
+        if (busy || !sim->wel || len > SIM_PAGE_SIZE - addr % SIM_PAGE_SIZE || sim_in_erase(sim, addr, len))
+        {
+            sim->errors++;
+            break;
+        }
+        for (i = 0; i < len; i++)
+        {
+            sim->data[addr + i] &= in[i];
+        }
+        sim->wel = RT_FALSE;
+        rt_hw_us_delay(sim->page_program_us);
+        break;
+
+    case QSPI_NOR_CMD_SECTOR_ERASE:
+    case QSPI_NOR_CMD_BLOCK_ERASE:
+        /* an erase can't start while another one is suspended */
+        if (busy || !sim->wel || sim->erasing)
+        {
+            sim->errors++;
+            break;
+        }
+        sim->wel = RT_FALSE;
+        if (cmd->opcode == QSPI_NOR_CMD_SECTOR_ERASE)
+        {
+            sim_erase(sim, addr, SIM_SECTOR_SIZE, sim->sector_erase_us);
+        }
+        else
+        {
+            sim_erase(sim, addr, SIM_BLOCK_SIZE, sim->block_erase_us);
+        }
+        break;
+
+    case QSPI_NOR_CMD_ERASE_SUSPEND:
+        if (busy)
+        {
+            sim->erase_left_us -= sim_erase_run(sim);
+            sim->suspended = RT_TRUE;
+            rt_hw_us_delay(sim->suspend_us);
+        }
+        break;
+
+    case QSPI_NOR_CMD_ERASE_RESUME:
+        if (sim->suspended)
+        {
+            sim->suspended = RT_FALSE;
+            sim->run_time = sim_time_us();
+        }
+        break;
+
+    case QSPI_NOR_CMD_ENTER_4B_ADDR:
+        break;
+
+    default:
+        sim->errors++;
+        return -RT_EIO;
+    }
+
+    return RT_EOK;
+}
+
+static const void *sim_map(struct qspi_nor *nor, const struct qspi_nor_cmd *read_cmd)
+{
+    struct qspi_nor_sim *sim = nor->user_data;
+
+    sim_update(sim);
+    if (sim->erasing && !sim->suspended)
+    {
+        sim->errors++;
+    }
+    sim->mapped = RT_TRUE;
+
+    return sim->data;
+}
+
+static void sim_unmap(struct qspi_nor *nor)
+{
+    struct qspi_nor_sim *sim = nor->user_data;
+
+    sim->mapped = RT_FALSE;
+}
+
+struct qspi_nor_sim *qspi_nor_sim_create(rt_uint32_t size, rt_uint8_t lines, rt_bool_t xip)
+{
+    struct qspi_nor_sim *sim;
+
+    RT_ASSERT(size >= SIM_BLOCK_SIZE && (size & (size - 1)) == 0);
+    RT_ASSERT(lines == 1 || lines == 4);
+
+    sim = rt_calloc(1, sizeof(struct qspi_nor_sim));
+    if (sim == RT_NULL)
+    {
+        return RT_NULL;
+    }
+    sim->data = rt_malloc(size);
+    if (sim->data == RT_NULL)
+    {
+        rt_free(sim);
+        return RT_NULL;
+    }
+    rt_memset(sim->data, 0xFF, size);
+    sim->size = size;
+    sim->lines = lines;
+    sim->xip = xip;
+
+    /* typical timing of the W25Q series at 50MHz */
+    sim->sector_erase_us = 45000;
+    sim->block_erase_us = 150000;
+    sim->page_program_us = 700;
+    sim->suspend_us = 20;
+    sim->resume_us = 100;
+    sim->command_ns = 40 * 20;
+    sim->byte_ns = 8 * 20;
+
+    return sim;
+}
+
+void qspi_nor_sim_delete(struct qspi_nor_sim *sim)
+{
+    RT_ASSERT(sim);
+
+    rt_free(sim->data);
+    rt_free(sim);
+}
+
+rt_err_t qspi_nor_init_sim(struct qspi_nor *nor, const char *name, struct qspi_nor_sim *sim)
+{
+    static const struct qspi_nor_ops sim_ops =
+    {
+        sim_command,
+        RT_NULL,
+        RT_NULL,
+    };
+    static const struct qspi_nor_ops sim_xip_ops =
+    {
+        sim_command,
+        sim_map,
+        sim_unmap,
+    };
+
+    RT_ASSERT(nor);
+    RT_ASSERT(sim);
+
+    if (sim->lines == 4)
+    {
+        nor->read_cmd.opcode = QSPI_NOR_CMD_QUAD_OUTPUT_READ;
+        nor->program_cmd.opcode = QSPI_NOR_CMD_QUAD_PAGE_PROGRAM;
+        nor->read_cmd.data_lines = nor->program_cmd.data_lines = 4;
+    }
+    else
+    {
+        nor->read_cmd.opcode = QSPI_NOR_CMD_FAST_READ;
+        nor->program_cmd.opcode = QSPI_NOR_CMD_PAGE_PROGRAM;
+        nor->read_cmd.data_lines = nor->program_cmd.data_lines = 1;
+    }
+    nor->read_cmd.addr_lines = nor->program_cmd.addr_lines = 1;
+    nor->read_cmd.dummy_cycles = 8;
+    nor->program_cmd.dummy_cycles = 0;
+
+    return qspi_nor_init(nor, name, sim->xip ? &sim_xip_ops : &sim_ops, sim);
+}
+
+#endif /* RT_QSPI_NOR_USING_SIM */
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef _FAL_KV_H_
+#define _FAL_KV_H_
+
+#include <fal.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct fal_kv_sector;
+struct fal_kv_index;
+
+struct fal_kv_stat
+{
+    rt_uint32_t keys;           /* live keys */
+    rt_uint32_t sectors;
+    rt_uint32_t empty_sectors;
+    rt_uint32_t live_bytes;     /* bytes of the live records */
+    rt_uint32_t dead_bytes;     /* bytes the garbage collection can reclaim */
+    rt_uint32_t erase_min;      /* erase counters of the sectors, kept on the flash */
+    rt_uint32_t erase_max;
+    rt_uint32_t erases;         /* sectors erased since the store was opened */
+    rt_uint32_t gc_runs;        /* sectors collected */
+    rt_uint32_t gc_moved;       /* live records copied by the garbage collection */
+    rt_uint32_t flash_reads;    /* read calls of the flash device */
+    rt_uint32_t flash_writes;   /* write calls of the flash device */
+};
+
+/*
+ * Log-structured key-value store on a FAL partition.
+ *
+ * Records are only appended, a new value of a key is a new record and the old
+ * one is marked obsolete. The keys are found through a hash index in RAM which
+ * is rebuilt by scanning the records when the store is opened. The garbage
+ * collection copies the live records of a sector to the write position and
+ * erases the sector. See fal_kv.c for the layout on the flash.
+ */
+struct fal_kv
+{
+    const struct fal_flash_dev *flash;
+    long offset;                        /* start of the store in the flash device */
+    rt_uint32_t sector_size;            /* erase block of the flash */
+    rt_uint16_t sector_cnt;
+    rt_uint16_t align;                  /* write granularity in bytes */
+    struct rt_mutex lock;
+
+    struct fal_kv_sector *sectors;
+    rt_uint16_t cur;                    /* sector of the next record */
+
+    struct fal_kv_index *index;
+    rt_uint32_t index_mask;
+    rt_uint32_t key_cnt;
+    rt_uint32_t seq;                    /* sequence number of the next record */
+
+    rt_uint32_t batch;                  /* id of the open batch, 0: none */
+    rt_uint32_t *batch_addr;            /* records written in the open batch */
+    rt_uint16_t batch_cnt;
+    rt_uint16_t batch_new;              /* keys the open batch adds to the index */
+
+    rt_uint8_t *buf;                    /* staging buffer of the flash writes */
+
+#ifdef FAL_KV_USING_GC_THREAD
+    rt_thread_t gc_thread;
+    struct rt_semaphore gc_sem;
+    struct rt_semaphore gc_exit_sem;
+    rt_bool_t gc_exit;
+#endif
+
+    struct fal_kv_stat stat;
+};
+
+/**
+ * open the store on a partition, an empty or damaged partition is formatted
+ *
+ * @param kv store
+ * @param part_name partition name
+ *
+ * @return RT_EOK on success, -RT_ERROR if the partition is not found
+ */
+int fal_kv_init(struct fal_kv *kv, const char *part_name);
+
+/**
+ * open the store on a range of a flash device
+ *
+ * @param kv store
+ * @param flash flash device
+ * @param offset start of the store in the flash device, aligned to its erase block
+ * @param len length of the store, at least 3 erase blocks
+ *
+ * @return RT_EOK on success
+ */
+int fal_kv_init_flash(struct fal_kv *kv, const struct fal_flash_dev *flash, long offset, size_t len);
+
+/**
+ * close the store, all the committed records are on the flash already
+ *
+ * @param kv store
+ */
+void fal_kv_deinit(struct fal_kv *kv);
+
+/**
+ * erase all the keys, the erase counters of the sectors are kept
+ *
+ * @param kv store
+ *
+ * @return RT_EOK on success
+ */
+int fal_kv_format(struct fal_kv *kv);
+
+/**
+ * set the value of a key, it's on the flash when the function returns
+ * unless a batch is open
+ *
+ * @param kv store
+ * @param key key, at most FAL_KV_KEY_MAX characters
+ * @param value value
+ * @param len length of the value
+ *
+ * @return RT_EOK on success, -RT_EFULL if there is no room for the record
+ */
+int fal_kv_set(struct fal_kv *kv, const char *key, const void *value, size_t len);
+
+/**
+ * get the value of a key
+ *
+ * @param kv store
+ * @param key key
+ * @param buf buffer of the value, can be NULL to get only the length
+ * @param size size of the buffer, a longer value is truncated
+ *
+ * @return >= 0: length of the value, -RT_EEMPTY: the key is not found
+ */
+int fal_kv_get(struct fal_kv *kv, const char *key, void *buf, size_t size);
+
+/**
+ * delete a key
+ *
+ * @param kv store
+ * @param key key
+ *
+ * @return RT_EOK on success, -RT_EEMPTY: the key is not found
+ */
+int fal_kv_del(struct fal_kv *kv, const char *key);
+
+/**
+ * start a batch. The sets and deletes that follow take effect together when
+ * the batch is committed, or not at all if the power fails before. The store
+ * is locked for the other threads until then.
+ *
+ * @param kv store
+ *
+ * @return RT_EOK on success, -RT_EBUSY if a batch is open already
+ */
+int fal_kv_batch_begin(struct fal_kv *kv);
+
+/**
+ * commit the open batch
+ *
+ * @param kv store
+ *
+ * @return RT_EOK on success
+ */
+int fal_kv_batch_commit(struct fal_kv *kv);
+
+/**
+ * drop the changes of the open batch
+ *
+ * @param kv store
+ */
+void fal_kv_batch_abort(struct fal_kv *kv);
+
+/**
+ * collect the sector with the most obsolete records
+ *
+ * @param kv store
+ *
+ * @return RT_EOK if a sector was collected, -RT_EEMPTY if there is nothing to collect
+ */
+int fal_kv_gc(struct fal_kv *kv);
+
+void fal_kv_get_stat(struct fal_kv *kv, struct fal_kv_stat *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FAL_KV_H_ */
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef _FAL_TSL_H_
+#define _FAL_TSL_H_
+
+#include <fal.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef FAL_TSL_FIELDS_MAX
+#define FAL_TSL_FIELDS_MAX          4       /* at most 16 */
+#endif
+
+/* flags of fal_tsl_init() */
+#define FAL_TSL_DELTA               0x01    /* store the differences to the previous sample */
+
+struct fal_tsl_seg;
+
+struct fal_tsl_sample
+{
+    rt_uint32_t time;
+    rt_int32_t value[FAL_TSL_FIELDS_MAX];
+};
+
+struct fal_tsl_stat
+{
+    rt_uint32_t samples;        /* samples in the log */
+    rt_uint32_t time_first;     /* time of the oldest sample */
+    rt_uint32_t time_last;
+    rt_uint32_t segments;       /* segments in use */
+    rt_uint32_t used_bytes;     /* bytes of the samples in the log */
+    rt_uint32_t raw_bytes;      /* the same samples without delta compression */
+    rt_uint32_t appends;        /* samples appended since the log was opened */
+    rt_uint32_t erases;
+    rt_uint32_t flash_reads;    /* read calls of the flash device */
+    rt_uint32_t flash_writes;   /* write calls of the flash device */
+};
+
+/*
+ * Time-series ring log on a FAL partition.
+ *
+ * The samples have a time and a fixed number of 32 bit values. They are
+ * appended to segments of an erase block, when the partition is full the
+ * oldest segment is erased. The times of the segments are kept in RAM so a
+ * time range is found by a binary search over the segments and a scan of one
+ * segment. The times must not decrease, e.g. seconds of the RTC or ticks.
+ */
+struct fal_tsl
+{
+    const struct fal_flash_dev *flash;
+    long offset;                        /* start of the log in the flash device */
+    rt_uint32_t seg_size;               /* erase block of the flash */
+    rt_uint16_t seg_cnt;
+    rt_uint16_t align;                  /* write granularity in bytes */
+    rt_uint8_t fields;
+    rt_uint8_t flags;
+    struct rt_mutex lock;
+
+    struct fal_tsl_seg *segs;
+    rt_uint16_t head;                   /* segment of the oldest samples */
+    rt_uint16_t cur;                    /* segment of the next sample */
+    rt_uint32_t head_seq;               /* sequence numbers of the segments */
+    rt_uint32_t cur_seq;
+    rt_uint32_t write_pos;              /* of the next record in the current segment */
+    rt_bool_t empty;
+
+    struct fal_tsl_sample last;         /* base of the delta of the next sample */
+
+    struct fal_tsl_stat stat;
+};
+
+/* a time range of the log, see fal_tsl_iter_init() */
+struct fal_tsl_iter
+{
+    struct fal_tsl *tsl;
+    rt_uint32_t from;
+    rt_uint32_t to;
+    rt_uint32_t seq;                    /* segment */
+    rt_uint32_t pos;                    /* of the next record in the segment */
+    struct fal_tsl_sample prev;
+    rt_uint8_t buf[128];                /* read ahead of the records */
+    rt_uint32_t buf_pos;
+    rt_uint16_t buf_len;
+    rt_bool_t end;                      /* a sample after the range was found */
+};
+
+/**
+ * open the log on a partition, a partition without the log or with another
+ * number of fields or flags is erased
+ *
+ * @param tsl log
+ * @param part_name partition name
+ * @param fields number of values of a sample, at most FAL_TSL_FIELDS_MAX
+ * @param flags FAL_TSL_DELTA or 0
+ *
+ * @return RT_EOK on success, -RT_ERROR if the partition is not found
+ */
+int fal_tsl_init(struct fal_tsl *tsl, const char *part_name, rt_uint8_t fields, rt_uint8_t flags);
+
+/**
+ * open the log on a range of a flash device
+ *
+ * @param tsl log
+ * @param flash flash device
+ * @param offset start of the log in the flash device, aligned to its erase block
+ * @param len length of the log, at least 2 erase blocks
+ * @param fields number of values of a sample
+ * @param flags FAL_TSL_DELTA or 0
+ *
+ * @return RT_EOK on success
+ */
+int fal_tsl_init_flash(struct fal_tsl *tsl, const struct fal_flash_dev *flash, long offset, size_t len,
+                       rt_uint8_t fields, rt_uint8_t flags);
+
+void fal_tsl_deinit(struct fal_tsl *tsl);
+
+/**
+ * erase all the samples
+ *
+ * @param tsl log
+ *
+ * @return RT_EOK on success
+ */
+int fal_tsl_clean(struct fal_tsl *tsl);
+
+/**
+ * append a sample, it's on the flash when the function returns
+ *
+ * @param tsl log
+ * @param time time of the sample, not before the last one
+ * @param values the values of the fields
+ *
+ * @return RT_EOK on success, -RT_EINVAL if the time is before the last sample
+ */
+int fal_tsl_append(struct fal_tsl *tsl, rt_uint32_t time, const rt_int32_t *values);
+
+/**
+ * start reading the samples of a time range
+ *
+ * @param tsl log
+ * @param iter iterator
+ * @param from first time, inclusive
+ * @param to last time, inclusive
+ *
+ * @return RT_EOK on success
+ */
+int fal_tsl_iter_init(struct fal_tsl *tsl, struct fal_tsl_iter *iter, rt_uint32_t from, rt_uint32_t to);
+
+/**
+ * read the next sample of the range. The samples overwritten by appends
+ * since the last call are skipped.
+ *
+ * @param iter iterator
+ * @param sample the sample
+ *
+ * @return RT_EOK on success, -RT_EEMPTY at the end of the range
+ */
+int fal_tsl_iter_next(struct fal_tsl_iter *iter, struct fal_tsl_sample *sample);
+
+/**
+ * average a field over `cnt` equal parts of a time range, e.g. to fill the y
+ * array of a chart series. The parts without samples are set to the max value
+ * of the type, which is LV_CHART_POINT_NONE for lv_coord_t:
+ *
+ *   lv_chart_set_x_start_point(chart, ser, 0);
+ *   fal_tsl_resample(tsl, from, to, 0, lv_chart_get_y_array(chart, ser), sizeof(lv_coord_t),
+ *                    lv_chart_get_point_count(chart));
+ *   lv_chart_refresh(chart);
+ *
+ * @param tsl log
+ * @param from first time, inclusive
+ * @param to last time, inclusive
+ * @param field field
+ * @param points array of the averages, rt_int16_t or rt_int32_t
+ * @param point_size 2 or 4
+ * @param cnt number of the points
+ *
+ * @return number of the samples in the range
+ */
+int fal_tsl_resample(struct fal_tsl *tsl, rt_uint32_t from, rt_uint32_t to, rt_uint8_t field,
+                     void *points, rt_size_t point_size, rt_uint16_t cnt);
+
+void fal_tsl_get_stat(struct fal_tsl *tsl, struct fal_tsl_stat *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FAL_TSL_H_ */
@@ -0,0 +1,1206 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Log-structured key-value store on a FAL partition.
+ *
+ * Every field is aligned to the write granularity A of the flash:
+ *
+ *   sector: | sector header | record | record | ... | erased |
+ *   record: | PRE | COMMIT | DEL | rec_hdr | key | value | padding |
+ *
+ * PRE, COMMIT and DEL are status slots of A bytes, erased (0xff) or written
+ * with zeros once. A record is written in three steps: PRE, then the header,
+ * key and value, then COMMIT. A record without COMMIT is ignored when the
+ * store is opened, a torn header closes the rest of its sector. The old record
+ * of a key is marked DEL after the new one is committed, if the power fails in
+ * between the record with the higher sequence number wins.
+ *
+ * The records of a batch carry its id and are written without COMMIT. The
+ * commit appends an end record, then writes COMMIT of the members, then DEL of
+ * the old records and of the end record. When the store is opened the members
+ * of a batch with a live end record are committed (rolled forward), the other
+ * uncommitted records are dropped.
+ *
+ * A delete is a tombstone record. It's marked DEL right after the old record
+ * so the garbage collection never has to copy tombstones.
+ *
+ * The garbage collection copies the records of a sector which the index refers
+ * to, with their sequence numbers, and erases the sector. If the power fails
+ * before the erase, the copies have the same sequence numbers as the originals
+ * and one of each pair is dropped when the store is opened. One empty sector
+ * is kept in reserve so the collection always has room. New sectors are taken
+ * by the lowest erase count and the background collection moves static data
+ * out of the least erased sectors when the counters drift apart.
+ */
+
+#include <fal_kv.h>
+#include <string.h>
+
+#define DBG_TAG               "fal.kv"
+#define DBG_LVL               DBG_INFO
+#include <rtdbg.h>
+
+#ifndef FAL_KV_KEY_MAX
+#define FAL_KV_KEY_MAX              32
+#endif
+#ifndef FAL_KV_MAX_KEYS
+#define FAL_KV_MAX_KEYS             128
+#endif
+#ifndef FAL_KV_BATCH_MAX
+#define FAL_KV_BATCH_MAX            16
+#endif
+#ifndef FAL_KV_WL_THRESHOLD
+#define FAL_KV_WL_THRESHOLD         16
+#endif
+#ifndef FAL_KV_GC_PERIOD_MS
+#define FAL_KV_GC_PERIOD_MS         1000
+#endif
+#ifndef FAL_KV_GC_THREAD_PRIORITY
+#define FAL_KV_GC_THREAD_PRIORITY   25
+#endif
+#ifndef FAL_KV_GC_THREAD_STACK_SIZE
+#define FAL_KV_GC_THREAD_STACK_SIZE 1024
+#endif
+
+#define SECTOR_MAGIC        0x30564B46      /* "FKV0" */
+#define REC_TOMBSTONE       0x01
+#define REC_BATCH_END       0x02
+
+#define SLOT_PRE            0
+#define SLOT_COMMIT         1
+#define SLOT_DEL            2
+
+#define ADDR_EMPTY          0xFFFFFFFF
+#define ADDR_REMOVED        0xFFFFFFFE
+#define ALIGN_MAX           32
+#define BUF_SIZE            128     /* a multiple of the write granularity */
+#define GC_RESERVE          1       /* empty sectors kept for the garbage collection */
+#define GC_EMPTY_MIN        2       /* empty sectors the background collection keeps */
+#define LOAD_BATCH_MAX      4       /* live end records when the store is opened */
+
+#define SLOTS_SIZE(kv)          (3 * (kv)->align)
+#define SECTOR_HDR_SIZE(kv)     RT_ALIGN(sizeof(struct sector_hdr), (kv)->align)
+#define REC_SIZE(kv, klen, vlen) \
+    RT_ALIGN(SLOTS_SIZE(kv) + sizeof(struct rec_hdr) + (klen) + (vlen), (kv)->align)
+#define SECTOR_OF(kv, addr)     ((addr) / (kv)->sector_size)
+#define REC_CRC_LEN             (sizeof(struct rec_hdr) - sizeof(rt_uint32_t))  /* the crc is the last field */
+
+struct sector_hdr
+{
+    rt_uint32_t magic;
+    rt_uint32_t erase_cnt;
+    rt_uint32_t erase_cnt_inv;      /* ~erase_cnt, detects a torn header */
+};
+
+struct rec_hdr
+{
+    rt_uint32_t seq;
+    rt_uint32_t batch;              /* id of the batch, 0: not in a batch */
+    rt_uint16_t value_len;
+    rt_uint8_t key_len;
+    rt_uint8_t flags;
+    rt_uint32_t crc;                /* of the fields above, the key and the value */
+};
+
+struct fal_kv_sector
+{
+    rt_uint32_t erase_cnt;
+    rt_uint32_t used;               /* offset of the erased space */
+    rt_uint32_t live;               /* bytes of the records in the index */
+};
+
+struct fal_kv_index
+{
+    rt_uint32_t hash;
+    rt_uint32_t addr;               /* of the record, ADDR_EMPTY or ADDR_REMOVED */
+    rt_uint32_t seq;
+};
+
+/* a record read from the flash */
+struct rec
+{
+    rt_uint32_t addr;
+    rt_bool_t slot[3];              /* the status slots written */
+    struct rec_hdr hdr;
+    char key[FAL_KV_KEY_MAX];
+};
+
+struct batch_end
+{
+    rt_uint32_t batch;
+    rt_uint32_t addr;
+};
+
+struct writer
+{
+    rt_uint32_t addr;
+    rt_uint32_t fill;
+};
+
+static rt_uint32_t crc32(rt_uint32_t crc, const void *buf, rt_size_t len)
+{
+    static const rt_uint32_t table[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const rt_uint8_t *p = (const rt_uint8_t *)buf;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static rt_uint32_t key_hash(const char *key, rt_size_t len)
+{
+    rt_uint32_t hash = 2166136261u;
+
+    while (len--)
+        hash = (hash ^ (rt_uint8_t)*key++) * 16777619u;
+    return hash;
+}
+
+static int flash_read(struct fal_kv *kv, rt_uint32_t addr, void *buf, rt_size_t size)
+{
+    kv->stat.flash_reads++;
+    if (kv->flash->ops.read(kv->offset + addr, (rt_uint8_t *)buf, size) != (int)size)
+    {
+        LOG_E("read %d bytes at 0x%08x failed", size, kv->offset + addr);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+static int flash_write(struct fal_kv *kv, rt_uint32_t addr, const void *buf, rt_size_t size)
+{
+    kv->stat.flash_writes++;
+    if (kv->flash->ops.write(kv->offset + addr, (const rt_uint8_t *)buf, size) != (int)size)
+    {
+        LOG_E("write %d bytes at 0x%08x failed", size, kv->offset + addr);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+static int slot_write(struct fal_kv *kv, rt_uint32_t addr, int slot)
+{
+    static const rt_uint8_t zero[ALIGN_MAX] = { 0 };
+
+    return flash_write(kv, addr + slot * kv->align, zero, kv->align);
+}
+
+/* write a record through the staging buffer, only whole write units go to the flash */
+static int writer_put(struct fal_kv *kv, struct writer *w, const void *data, rt_size_t len)
+{
+    const rt_uint8_t *p = (const rt_uint8_t *)data;
+    rt_size_t n;
+
+    while (len > 0)
+    {
+        n = BUF_SIZE - w->fill;
+        if (n > len)
+            n = len;
+        rt_memcpy(kv->buf + w->fill, p, n);
+        w->fill += n;
+        p += n;
+        len -= n;
+
+        if (w->fill == BUF_SIZE)
+        {
+            if (flash_write(kv, w->addr, kv->buf, BUF_SIZE) != RT_EOK)
+                return -RT_EIO;
+            w->addr += BUF_SIZE;
+            w->fill = 0;
+        }
+    }
+    return RT_EOK;
+}
+
+static int writer_end(struct fal_kv *kv, struct writer *w)
+{
+    rt_uint32_t len = RT_ALIGN(w->fill, kv->align);
+
+    if (len == 0)
+        return RT_EOK;
+    rt_memset(kv->buf + w->fill, 0xFF, len - w->fill);
+    return flash_write(kv, w->addr, kv->buf, len);
+}
+
+static int sector_write_hdr(struct fal_kv *kv, rt_uint16_t sector)
+{
+    struct fal_kv_sector *s = &kv->sectors[sector];
+    rt_uint8_t buf[RT_ALIGN(sizeof(struct sector_hdr), ALIGN_MAX)];
+    struct sector_hdr hdr;
+
+    hdr.magic = SECTOR_MAGIC;
+    hdr.erase_cnt = s->erase_cnt;
+    hdr.erase_cnt_inv = ~s->erase_cnt;
+    rt_memset(buf, 0xFF, sizeof(buf));
+    rt_memcpy(buf, &hdr, sizeof(hdr));
+    s->used = SECTOR_HDR_SIZE(kv);
+    s->live = 0;
+    return flash_write(kv, sector * kv->sector_size, buf, SECTOR_HDR_SIZE(kv));
+}
+
+static int sector_erase(struct fal_kv *kv, rt_uint16_t sector)
+{
+    kv->stat.erases++;
+    if (kv->flash->ops.erase(kv->offset + sector * kv->sector_size, kv->sector_size) < 0)
+    {
+        LOG_E("erase sector %d failed", sector);
+        /* don't write into it */
+        kv->sectors[sector].used = kv->sector_size;
+        return -RT_EIO;
+    }
+    kv->sectors[sector].erase_cnt++;
+    return sector_write_hdr(kv, sector);
+}
+
+static rt_bool_t sector_is_blank(struct fal_kv *kv, rt_uint16_t sector)
+{
+    rt_uint32_t addr, i;
+
+    for (addr = 0; addr < kv->sector_size; addr += BUF_SIZE)
+    {
+        if (flash_read(kv, sector * kv->sector_size + addr, kv->buf, BUF_SIZE) != RT_EOK)
+            return RT_FALSE;
+        for (i = 0; i < BUF_SIZE; i++)
+        {
+            if (kv->buf[i] != 0xFF)
+                return RT_FALSE;
+        }
+    }
+    return RT_TRUE;
+}
+
+static rt_bool_t sector_is_empty(struct fal_kv *kv, rt_uint16_t sector)
+{
+    return kv->sectors[sector].used == SECTOR_HDR_SIZE(kv);
+}
+
+static rt_uint16_t empty_count(struct fal_kv *kv)
+{
+    rt_uint16_t i, n = 0;
+
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        if (i != kv->cur && sector_is_empty(kv, i))
+            n++;
+    }
+    return n;
+}
+
+/* the empty sector with the lowest erase count, -1 if there is none */
+static int pick_empty(struct fal_kv *kv)
+{
+    int i, best = -1;
+
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        if (i == kv->cur || !sector_is_empty(kv, i))
+            continue;
+        if (best < 0 || kv->sectors[i].erase_cnt < kv->sectors[best].erase_cnt)
+            best = i;
+    }
+    return best;
+}
+
+static rt_size_t rec_size(struct fal_kv *kv, const struct rec_hdr *hdr)
+{
+    return REC_SIZE(kv, hdr->key_len, hdr->value_len);
+}
+
+static int rec_read(struct fal_kv *kv, rt_uint32_t addr, struct rec *r)
+{
+    rt_uint8_t buf[3 * ALIGN_MAX + sizeof(struct rec_hdr)];
+    rt_uint16_t i, j;
+
+    if (flash_read(kv, addr, buf, SLOTS_SIZE(kv) + sizeof(struct rec_hdr)) != RT_EOK)
+        return -RT_EIO;
+
+    r->addr = addr;
+    for (i = 0; i < 3; i++)
+    {
+        /* a slot torn by a power failure counts as written */
+        r->slot[i] = RT_FALSE;
+        for (j = 0; j < kv->align; j++)
+        {
+            if (buf[i * kv->align + j] != 0xFF)
+                r->slot[i] = RT_TRUE;
+        }
+    }
+    rt_memcpy(&r->hdr, buf + SLOTS_SIZE(kv), sizeof(struct rec_hdr));
+
+    if (r->hdr.key_len > 0 && r->hdr.key_len <= FAL_KV_KEY_MAX)
+        return flash_read(kv, addr + SLOTS_SIZE(kv) + sizeof(struct rec_hdr), r->key, r->hdr.key_len);
+    return RT_EOK;
+}
+
+static rt_bool_t rec_is_erased(const struct rec *r)
+{
+    return !r->slot[SLOT_PRE] && !r->slot[SLOT_COMMIT] && !r->slot[SLOT_DEL]
+           && r->hdr.seq == 0xFFFFFFFF && r->hdr.batch == 0xFFFFFFFF && r->hdr.value_len == 0xFFFF
+           && r->hdr.key_len == 0xFF && r->hdr.flags == 0xFF && r->hdr.crc == 0xFFFFFFFF;
+}
+
+/* the header is plausible and the record ends before `end` */
+static rt_bool_t rec_is_sane(struct fal_kv *kv, const struct rec *r, rt_uint32_t end)
+{
+    if (r->hdr.key_len > FAL_KV_KEY_MAX)
+        return RT_FALSE;
+    if (r->hdr.key_len == 0 && !(r->hdr.flags & REC_BATCH_END))
+        return RT_FALSE;
+    return r->addr + rec_size(kv, &r->hdr) <= end;
+}
+
+static rt_bool_t rec_crc_ok(struct fal_kv *kv, const struct rec *r)
+{
+    rt_uint32_t crc, addr, len, n;
+
+    crc = crc32(0, &r->hdr, REC_CRC_LEN);
+    crc = crc32(crc, r->key, r->hdr.key_len);
+
+    addr = r->addr + SLOTS_SIZE(kv) + sizeof(struct rec_hdr) + r->hdr.key_len;
+    for (len = r->hdr.value_len; len > 0; len -= n, addr += n)
+    {
+        n = len < BUF_SIZE ? len : BUF_SIZE;
+        if (flash_read(kv, addr, kv->buf, n) != RT_EOK)
+            return RT_FALSE;
+        crc = crc32(crc, kv->buf, n);
+    }
+    return crc == r->hdr.crc;
+}
+
+/* find the index entry of a key, `r` gets its record */
+static struct fal_kv_index *index_find(struct fal_kv *kv, const char *key, rt_size_t key_len,
+                                       rt_uint32_t hash, struct rec *r)
+{
+    struct fal_kv_index *e;
+    rt_uint32_t i, n;
+
+    i = hash & kv->index_mask;
+    for (n = 0; n <= kv->index_mask; n++, i = (i + 1) & kv->index_mask)
+    {
+        e = &kv->index[i];
+        if (e->addr == ADDR_EMPTY)
+            break;
+        if (e->addr == ADDR_REMOVED || e->hash != hash)
+            continue;
+        if (rec_read(kv, e->addr, r) == RT_EOK && r->hdr.key_len == key_len
+                && rt_memcmp(r->key, key, key_len) == 0)
+            return e;
+    }
+    return RT_NULL;
+}
+
+static void index_insert(struct fal_kv *kv, rt_uint32_t hash, rt_uint32_t addr, rt_uint32_t seq)
+{
+    struct fal_kv_index *e;
+    rt_uint32_t i;
+
+    for (i = hash & kv->index_mask; ; i = (i + 1) & kv->index_mask)
+    {
+        e = &kv->index[i];
+        if (e->addr == ADDR_EMPTY || e->addr == ADDR_REMOVED)
+            break;
+    }
+    e->hash = hash;
+    e->addr = addr;
+    e->seq = seq;
+    kv->key_cnt++;
+}
+
+static void index_remove(struct fal_kv *kv, struct fal_kv_index *e)
+{
+    e->addr = ADDR_REMOVED;
+    kv->key_cnt--;
+}
+
+/*
+ * Make a committed record the current one of its key and mark the old record
+ * obsolete. When the store is opened (`loading`) the records come in any
+ * order, an older one is dropped and tombstones stay in the index until the
+ * scan is finished so they hide the older records found after them.
+ */
+static int index_apply(struct fal_kv *kv, const struct rec *r, rt_bool_t loading)
+{
+    rt_uint32_t hash = key_hash(r->key, r->hdr.key_len);
+    rt_bool_t tombstone = (r->hdr.flags & REC_TOMBSTONE) != 0;
+    struct fal_kv_index *e;
+    struct rec old;
+
+    e = index_find(kv, r->key, r->hdr.key_len, hash, &old);
+    if (e != RT_NULL)
+    {
+        /* an older record, or a copy left by the garbage collection */
+        if (e->seq >= r->hdr.seq)
+            return slot_write(kv, r->addr, SLOT_DEL);
+
+        if (!(old.hdr.flags & REC_TOMBSTONE))
+            kv->sectors[SECTOR_OF(kv, old.addr)].live -= rec_size(kv, &old.hdr);
+        if (slot_write(kv, old.addr, SLOT_DEL) != RT_EOK)
+            return -RT_EIO;
+
+        if (tombstone && !loading)
+        {
+            index_remove(kv, e);
+            return slot_write(kv, r->addr, SLOT_DEL);
+        }
+        e->addr = r->addr;
+        e->seq = r->hdr.seq;
+    }
+    else
+    {
+        if (tombstone && !loading)
+            return slot_write(kv, r->addr, SLOT_DEL);
+        if (kv->key_cnt >= kv->index_mask)
+        {
+            LOG_E("too many keys, increase FAL_KV_MAX_KEYS");
+            return -RT_EFULL;
+        }
+        index_insert(kv, hash, r->addr, r->hdr.seq);
+    }
+
+    if (!tombstone)
+        kv->sectors[SECTOR_OF(kv, r->addr)].live += rec_size(kv, &r->hdr);
+    return RT_EOK;
+}
+
+static rt_bool_t sector_has_batch(struct fal_kv *kv, rt_uint16_t sector)
+{
+    rt_uint16_t i;
+
+    for (i = 0; i < kv->batch_cnt; i++)
+    {
+        if (SECTOR_OF(kv, kv->batch_addr[i]) == sector)
+            return RT_TRUE;
+    }
+    return RT_FALSE;
+}
+
+static int space_alloc(struct fal_kv *kv, rt_uint32_t size, rt_bool_t gc, rt_uint32_t *addr);
+
+/* copy a live record to the write position */
+static int rec_move(struct fal_kv *kv, struct fal_kv_index *e, const struct rec *r)
+{
+    rt_uint32_t size = rec_size(kv, &r->hdr);
+    rt_uint32_t dst, ofs, n;
+    int ret;
+
+    ret = space_alloc(kv, size, RT_TRUE, &dst);
+    if (ret != RT_EOK)
+        return ret;
+
+    ret = slot_write(kv, dst, SLOT_PRE);
+    for (ofs = SLOTS_SIZE(kv); ret == RT_EOK && ofs < size; ofs += n)
+    {
+        n = size - ofs < BUF_SIZE ? size - ofs : BUF_SIZE;
+        ret = flash_read(kv, r->addr + ofs, kv->buf, n);
+        if (ret == RT_EOK)
+            ret = flash_write(kv, dst + ofs, kv->buf, n);
+    }
+    if (ret == RT_EOK)
+        ret = slot_write(kv, dst, SLOT_COMMIT);
+    if (ret != RT_EOK)
+        return ret;
+
+    kv->sectors[SECTOR_OF(kv, r->addr)].live -= size;
+    kv->sectors[SECTOR_OF(kv, dst)].live += size;
+    e->addr = dst;
+    kv->stat.gc_moved++;
+    return RT_EOK;
+}
+
+static int gc_sector(struct fal_kv *kv, rt_uint16_t sector)
+{
+    rt_uint32_t base = sector * kv->sector_size;
+    rt_uint32_t end = base + kv->sectors[sector].used;
+    rt_uint32_t addr = base + SECTOR_HDR_SIZE(kv);
+    struct fal_kv_index *e;
+    struct rec r, cur;
+    int ret;
+
+    while (addr < end)
+    {
+        if (rec_read(kv, addr, &r) != RT_EOK)
+            return -RT_EIO;
+        if (!rec_is_sane(kv, &r, base + kv->sector_size))
+            break;
+
+        if (r.slot[SLOT_COMMIT] && !r.slot[SLOT_DEL] && !(r.hdr.flags & (REC_TOMBSTONE | REC_BATCH_END)))
+        {
+            e = index_find(kv, r.key, r.hdr.key_len, key_hash(r.key, r.hdr.key_len), &cur);
+            if (e != RT_NULL && e->addr == addr)
+            {
+                ret = rec_move(kv, e, &r);
+                if (ret != RT_EOK)
+                    return ret;
+            }
+        }
+        addr += rec_size(kv, &r.hdr);
+    }
+
+    kv->stat.gc_runs++;
+    return sector_erase(kv, sector);
+}
+
+/* collect the sector with the most space to reclaim, or the least erased one for wear leveling */
+static int gc_one(struct fal_kv *kv, rt_bool_t wear)
+{
+    rt_uint32_t reclaim, best = 0;
+    int i, victim = -1;
+    struct fal_kv_sector *s;
+
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        s = &kv->sectors[i];
+        if (i == kv->cur || sector_is_empty(kv, i) || sector_has_batch(kv, i))
+            continue;
+
+        if (wear)
+        {
+            if (victim < 0 || s->erase_cnt < kv->sectors[victim].erase_cnt)
+                victim = i;
+        }
+        else
+        {
+            reclaim = kv->sector_size - SECTOR_HDR_SIZE(kv) - s->live;
+            if (reclaim > best)
+            {
+                best = reclaim;
+                victim = i;
+            }
+        }
+    }
+
+    if (victim < 0)
+        return -RT_EEMPTY;
+    LOG_D("collect sector %d, %d live bytes", victim, kv->sectors[victim].live);
+    return gc_sector(kv, victim);
+}
+
+/*
+ * Take `size` bytes at the write position. A new sector is started when the
+ * current one is full, the garbage collection runs first if only the reserve
+ * is left, unless it's the collection itself asking.
+ */
+static int space_alloc(struct fal_kv *kv, rt_uint32_t size, rt_bool_t gc, rt_uint32_t *addr)
+{
+    struct fal_kv_sector *s;
+    rt_uint16_t tries = 0;
+    int next;
+
+    for (;;)
+    {
+        s = &kv->sectors[kv->cur];
+        if (s->used + size <= kv->sector_size)
+        {
+            *addr = kv->cur * kv->sector_size + s->used;
+            s->used += size;
+            return RT_EOK;
+        }
+
+        if (!gc && empty_count(kv) <= GC_RESERVE)
+        {
+            if (tries++ >= kv->sector_cnt || gc_one(kv, RT_FALSE) != RT_EOK)
+                return -RT_EFULL;
+            continue;
+        }
+
+        next = pick_empty(kv);
+        if (next < 0)
+            return -RT_EFULL;
+        kv->cur = next;
+#ifdef FAL_KV_USING_GC_THREAD
+        rt_sem_release(&kv->gc_sem);
+#endif
+    }
+}
+
+/* append a record, it's committed unless it belongs to the open batch */
+static int rec_append(struct fal_kv *kv, const char *key, rt_size_t key_len,
+                      const void *value, rt_size_t value_len, rt_uint8_t flags, struct rec *r)
+{
+    struct writer w;
+    int ret;
+
+    ret = space_alloc(kv, REC_SIZE(kv, key_len, value_len), RT_FALSE, &r->addr);
+    if (ret != RT_EOK)
+        return ret;
+
+    r->hdr.seq = kv->seq++;
+    r->hdr.batch = kv->batch;
+    r->hdr.value_len = value_len;
+    r->hdr.key_len = key_len;
+    r->hdr.flags = flags;
+    r->hdr.crc = crc32(0, &r->hdr, REC_CRC_LEN);
+    r->hdr.crc = crc32(r->hdr.crc, key, key_len);
+    r->hdr.crc = crc32(r->hdr.crc, value, value_len);
+    rt_memcpy(r->key, key, key_len);
+
+    /* the space stays used if a write fails, the record is dropped when the store is opened */
+    ret = slot_write(kv, r->addr, SLOT_PRE);
+    w.addr = r->addr + SLOTS_SIZE(kv);
+    w.fill = 0;
+    if (ret == RT_EOK)
+        ret = writer_put(kv, &w, &r->hdr, sizeof(struct rec_hdr));
+    if (ret == RT_EOK)
+        ret = writer_put(kv, &w, key, key_len);
+    if (ret == RT_EOK)
+        ret = writer_put(kv, &w, value, value_len);
+    if (ret == RT_EOK)
+        ret = writer_end(kv, &w);
+    if (ret == RT_EOK && (kv->batch == 0 || (flags & REC_BATCH_END)))
+        ret = slot_write(kv, r->addr, SLOT_COMMIT);
+    return ret;
+}
+
+static int kv_write(struct fal_kv *kv, const char *key, const void *value, rt_size_t len, rt_uint8_t flags)
+{
+    rt_size_t key_len = rt_strlen(key);
+    struct fal_kv_index *e;
+    struct rec r;
+    int ret;
+
+    if (key_len == 0 || key_len > FAL_KV_KEY_MAX || len > 0xFFFF
+            || REC_SIZE(kv, key_len, len) > kv->sector_size - SECTOR_HDR_SIZE(kv))
+        return -RT_EINVAL;
+
+    rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+    e = index_find(kv, key, key_len, key_hash(key, key_len), &r);
+
+    if (kv->batch == 0)
+    {
+        if (e == RT_NULL && (flags & REC_TOMBSTONE))
+            ret = -RT_EEMPTY;
+        else if (e == RT_NULL && kv->key_cnt >= FAL_KV_MAX_KEYS)
+            ret = -RT_EFULL;
+        else
+        {
+            ret = rec_append(kv, key, key_len, value, len, flags, &r);
+            if (ret == RT_EOK)
+                ret = index_apply(kv, &r, RT_FALSE);
+        }
+    }
+    else
+    {
+        /* a key new to the index is counted even if the batch sets it twice */
+        if (kv->batch_cnt >= FAL_KV_BATCH_MAX)
+            ret = -RT_EFULL;
+        else if (e == RT_NULL && !(flags & REC_TOMBSTONE) && kv->key_cnt + kv->batch_new >= FAL_KV_MAX_KEYS)
+            ret = -RT_EFULL;
+        else
+        {
+            ret = rec_append(kv, key, key_len, value, len, flags, &r);
+            if (ret == RT_EOK)
+            {
+                kv->batch_addr[kv->batch_cnt++] = r.addr;
+                if (e == RT_NULL && !(flags & REC_TOMBSTONE))
+                    kv->batch_new++;
+            }
+        }
+    }
+
+    rt_mutex_release(&kv->lock);
+    return ret;
+}
+
+/* first pass of the loading: the free space of a sector and the live end records of batches */
+static void sector_load(struct fal_kv *kv, rt_uint16_t sector, struct batch_end *ends, rt_uint16_t *end_cnt)
+{
+    rt_uint32_t base = sector * kv->sector_size;
+    rt_uint32_t end = base + kv->sector_size;
+    rt_uint32_t addr = base + SECTOR_HDR_SIZE(kv);
+    struct rec r;
+
+    while (addr + SLOTS_SIZE(kv) + sizeof(struct rec_hdr) <= end)
+    {
+        if (rec_read(kv, addr, &r) != RT_EOK)
+        {
+            addr = end;
+            break;
+        }
+        if (rec_is_erased(&r))
+            break;
+        /* an interrupted write, the rest of the sector is left to the garbage collection */
+        if (!r.slot[SLOT_PRE] || !rec_is_sane(kv, &r, end) || !rec_crc_ok(kv, &r))
+        {
+            addr = end;
+            break;
+        }
+
+        if (r.hdr.seq >= kv->seq)
+            kv->seq = r.hdr.seq + 1;
+        if (r.hdr.batch >= kv->seq)
+            kv->seq = r.hdr.batch + 1;
+        if ((r.hdr.flags & REC_BATCH_END) && r.slot[SLOT_COMMIT] && !r.slot[SLOT_DEL] && *end_cnt < LOAD_BATCH_MAX)
+        {
+            ends[*end_cnt].batch = r.hdr.batch;
+            ends[*end_cnt].addr = addr;
+            (*end_cnt)++;
+        }
+        addr += rec_size(kv, &r.hdr);
+    }
+
+    kv->sectors[sector].used = (addr < end ? addr : end) - base;
+}
+
+static rt_bool_t batch_is_committed(struct batch_end *ends, rt_uint16_t end_cnt, rt_uint32_t batch)
+{
+    rt_uint16_t i;
+
+    for (i = 0; i < end_cnt; i++)
+    {
+        if (ends[i].batch == batch)
+            return RT_TRUE;
+    }
+    return RT_FALSE;
+}
+
+/* second pass: the index */
+static int sector_index(struct fal_kv *kv, rt_uint16_t sector, struct batch_end *ends, rt_uint16_t end_cnt)
+{
+    rt_uint32_t base = sector * kv->sector_size;
+    rt_uint32_t addr = base + SECTOR_HDR_SIZE(kv);
+    rt_uint32_t end = base + kv->sectors[sector].used;
+    struct rec r;
+    int ret;
+
+    for (; addr < end; addr += rec_size(kv, &r.hdr))
+    {
+        if (rec_read(kv, addr, &r) != RT_EOK)
+            return -RT_EIO;
+        if (!rec_is_sane(kv, &r, base + kv->sector_size))
+            break;
+        if (r.slot[SLOT_DEL] || (r.hdr.flags & REC_BATCH_END))
+            continue;
+
+        if (!r.slot[SLOT_COMMIT])
+        {
+            if (r.hdr.batch == 0 || !batch_is_committed(ends, end_cnt, r.hdr.batch))
+                continue;
+            /* roll the committed batch forward */
+            if (slot_write(kv, addr, SLOT_COMMIT) != RT_EOK)
+                return -RT_EIO;
+        }
+
+        ret = index_apply(kv, &r, RT_TRUE);
+        if (ret != RT_EOK)
+            return ret;
+    }
+    return RT_EOK;
+}
+
+static int kv_load(struct fal_kv *kv)
+{
+    struct batch_end ends[LOAD_BATCH_MAX];
+    rt_uint16_t end_cnt = 0;
+    rt_uint32_t erase_max = 0, i, most_free = 0;
+    struct sector_hdr hdr;
+    struct rec r;
+    int ret, cur = -1;
+
+    kv->seq = 1;
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        if (flash_read(kv, i * kv->sector_size, &hdr, sizeof(hdr)) != RT_EOK)
+            return -RT_EIO;
+        if (hdr.magic != SECTOR_MAGIC || hdr.erase_cnt != ~hdr.erase_cnt_inv)
+        {
+            /* formatted below */
+            kv->sectors[i].used = 0;
+            continue;
+        }
+        kv->sectors[i].erase_cnt = hdr.erase_cnt;
+        if (hdr.erase_cnt > erase_max)
+            erase_max = hdr.erase_cnt;
+        sector_load(kv, i, ends, &end_cnt);
+    }
+
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        if (kv->sectors[i].used != 0)
+            continue;
+        /* new or torn by a power failure while it was erased, its count is lost */
+        kv->sectors[i].erase_cnt = erase_max;
+        ret = sector_is_blank(kv, i) ? sector_write_hdr(kv, i) : sector_erase(kv, i);
+        if (ret != RT_EOK)
+            return ret;
+    }
+
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        ret = sector_index(kv, i, ends, end_cnt);
+        if (ret != RT_EOK)
+            return ret;
+    }
+
+    /* the tombstones and the end records aren't needed any more */
+    for (i = 0; i <= kv->index_mask; i++)
+    {
+        if (kv->index[i].addr == ADDR_EMPTY || kv->index[i].addr == ADDR_REMOVED)
+            continue;
+        if (rec_read(kv, kv->index[i].addr, &r) != RT_EOK)
+            return -RT_EIO;
+        if (r.hdr.flags & REC_TOMBSTONE)
+        {
+            if (slot_write(kv, r.addr, SLOT_DEL) != RT_EOK)
+                return -RT_EIO;
+            index_remove(kv, &kv->index[i]);
+        }
+    }
+    for (i = 0; i < end_cnt; i++)
+    {
+        if (slot_write(kv, ends[i].addr, SLOT_DEL) != RT_EOK)
+            return -RT_EIO;
+    }
+
+    /* go on writing in the sector with the most free space, or an empty one */
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        if (sector_is_empty(kv, i) || kv->sector_size - kv->sectors[i].used <= most_free)
+            continue;
+        most_free = kv->sector_size - kv->sectors[i].used;
+        cur = i;
+    }
+    if (cur < 0)
+    {
+        kv->cur = kv->sector_cnt;
+        cur = pick_empty(kv);
+    }
+    /* all the sectors are closed by torn records, the first allocation collects one */
+    kv->cur = cur >= 0 ? cur : 0;
+    return RT_EOK;
+}
+
+#ifdef FAL_KV_USING_GC_THREAD
+/* one sector per round so the other threads aren't blocked for long, RT_TRUE if there is more to do */
+static rt_bool_t gc_background(struct fal_kv *kv)
+{
+    rt_uint32_t erase_min = 0xFFFFFFFF, erase_max = 0;
+    rt_uint16_t i;
+
+    if (empty_count(kv) < GC_EMPTY_MIN)
+        return gc_one(kv, RT_FALSE) == RT_EOK;
+
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        if (kv->sectors[i].erase_cnt < erase_min)
+            erase_min = kv->sectors[i].erase_cnt;
+        if (kv->sectors[i].erase_cnt > erase_max)
+            erase_max = kv->sectors[i].erase_cnt;
+    }
+    if (erase_max - erase_min > FAL_KV_WL_THRESHOLD)
+        return gc_one(kv, RT_TRUE) == RT_EOK;
+    return RT_FALSE;
+}
+
+static void gc_thread_entry(void *param)
+{
+    struct fal_kv *kv = (struct fal_kv *)param;
+    rt_int32_t timeout = rt_tick_from_millisecond(FAL_KV_GC_PERIOD_MS);
+    rt_bool_t more;
+
+    while (!kv->gc_exit)
+    {
+        rt_sem_take(&kv->gc_sem, timeout);
+        if (kv->gc_exit)
+            break;
+
+        rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+        more = gc_background(kv);
+        rt_mutex_release(&kv->lock);
+        timeout = more ? 0 : rt_tick_from_millisecond(FAL_KV_GC_PERIOD_MS);
+    }
+    rt_sem_release(&kv->gc_exit_sem);
+}
+#endif /* FAL_KV_USING_GC_THREAD */
+
+static void kv_free(struct fal_kv *kv)
+{
+    rt_free(kv->sectors);
+    rt_free(kv->index);
+    rt_free(kv->batch_addr);
+    rt_free(kv->buf);
+    kv->sectors = RT_NULL;
+    kv->index = RT_NULL;
+    kv->batch_addr = RT_NULL;
+    kv->buf = RT_NULL;
+}
+
+int fal_kv_init_flash(struct fal_kv *kv, const struct fal_flash_dev *flash, long offset, size_t len)
+{
+    rt_uint32_t index_size = 1;
+    int ret;
+
+    RT_ASSERT(kv != RT_NULL);
+    RT_ASSERT(flash != RT_NULL);
+
+    rt_memset(kv, 0, sizeof(struct fal_kv));
+    kv->flash = flash;
+    kv->offset = offset;
+    kv->sector_size = flash->blk_size;
+    kv->sector_cnt = len / flash->blk_size;
+    kv->align = flash->write_gran > 8 ? flash->write_gran / 8 : 1;
+    if (offset % flash->blk_size != 0 || kv->sector_cnt < GC_RESERVE + 2
+            || kv->align > ALIGN_MAX || BUF_SIZE % kv->align != 0)
+    {
+        LOG_E("unsupported flash layout: %d sectors of %d bytes, write granularity %d bytes",
+              kv->sector_cnt, kv->sector_size, kv->align);
+        return -RT_EINVAL;
+    }
+
+    /* at least half of the index stays empty */
+    while (index_size < 2 * FAL_KV_MAX_KEYS)
+        index_size <<= 1;
+    kv->index_mask = index_size - 1;
+
+    kv->sectors = (struct fal_kv_sector *)rt_calloc(kv->sector_cnt, sizeof(struct fal_kv_sector));
+    kv->index = (struct fal_kv_index *)rt_malloc(index_size * sizeof(struct fal_kv_index));
+    kv->batch_addr = (rt_uint32_t *)rt_malloc(FAL_KV_BATCH_MAX * sizeof(rt_uint32_t));
+    kv->buf = (rt_uint8_t *)rt_malloc(BUF_SIZE);
+    if (kv->sectors == RT_NULL || kv->index == RT_NULL || kv->batch_addr == RT_NULL || kv->buf == RT_NULL)
+    {
+        kv_free(kv);
+        return -RT_ENOMEM;
+    }
+    rt_memset(kv->index, 0xFF, index_size * sizeof(struct fal_kv_index));
+
+    ret = kv_load(kv);
+    if (ret != RT_EOK)
+    {
+        LOG_E("load the store on %s failed (%d)", flash->name, ret);
+        kv_free(kv);
+        return ret;
+    }
+    rt_mutex_init(&kv->lock, "fal_kv", RT_IPC_FLAG_PRIO);
+
+#ifdef FAL_KV_USING_GC_THREAD
+    rt_sem_init(&kv->gc_sem, "fkv_gc", 0, RT_IPC_FLAG_PRIO);
+    rt_sem_init(&kv->gc_exit_sem, "fkv_gce", 0, RT_IPC_FLAG_PRIO);
+    kv->gc_thread = rt_thread_create("fkv_gc", gc_thread_entry, kv, FAL_KV_GC_THREAD_STACK_SIZE,
+                                     FAL_KV_GC_THREAD_PRIORITY, 10);
+    if (kv->gc_thread != RT_NULL)
+        rt_thread_startup(kv->gc_thread);
+    else
+        LOG_W("no garbage collection thread, it runs when a sector is needed only");
+#endif
+
+    LOG_D("%d keys on %s, %d of %d sectors empty", kv->key_cnt, flash->name, empty_count(kv), kv->sector_cnt);
+    return RT_EOK;
+}
+
+int fal_kv_init(struct fal_kv *kv, const char *part_name)
+{
+    const struct fal_partition *part;
+    const struct fal_flash_dev *flash;
+
+    part = fal_partition_find(part_name);
+    if (part == RT_NULL)
+    {
+        LOG_E("partition %s not found", part_name);
+        return -RT_ERROR;
+    }
+    flash = fal_flash_device_find(part->flash_name);
+    if (flash == RT_NULL)
+    {
+        LOG_E("flash device %s not found", part->flash_name);
+        return -RT_ERROR;
+    }
+    return fal_kv_init_flash(kv, flash, part->offset, part->len);
+}
+
+void fal_kv_deinit(struct fal_kv *kv)
+{
+#ifdef FAL_KV_USING_GC_THREAD
+    if (kv->gc_thread != RT_NULL)
+    {
+        kv->gc_exit = RT_TRUE;
+        rt_sem_release(&kv->gc_sem);
+        rt_sem_take(&kv->gc_exit_sem, RT_WAITING_FOREVER);
+    }
+    rt_sem_detach(&kv->gc_sem);
+    rt_sem_detach(&kv->gc_exit_sem);
+#endif
+    rt_mutex_detach(&kv->lock);
+    kv_free(kv);
+}
+
+int fal_kv_format(struct fal_kv *kv)
+{
+    rt_uint16_t i;
+    int ret = RT_EOK;
+
+    rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < kv->sector_cnt && ret == RT_EOK; i++)
+        ret = sector_erase(kv, i);
+    rt_memset(kv->index, 0xFF, (kv->index_mask + 1) * sizeof(struct fal_kv_index));
+    kv->key_cnt = 0;
+    kv->cur = kv->sector_cnt;
+    kv->cur = pick_empty(kv);
+    rt_mutex_release(&kv->lock);
+    return ret;
+}
+
+int fal_kv_set(struct fal_kv *kv, const char *key, const void *value, size_t len)
+{
+    return kv_write(kv, key, value, len, 0);
+}
+
+int fal_kv_del(struct fal_kv *kv, const char *key)
+{
+    return kv_write(kv, key, RT_NULL, 0, REC_TOMBSTONE);
+}
+
+int fal_kv_get(struct fal_kv *kv, const char *key, void *buf, size_t size)
+{
+    rt_size_t key_len = rt_strlen(key);
+    struct fal_kv_index *e;
+    struct rec r;
+    int ret;
+
+    if (key_len == 0 || key_len > FAL_KV_KEY_MAX)
+        return -RT_EEMPTY;
+
+    rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+    e = index_find(kv, key, key_len, key_hash(key, key_len), &r);
+    if (e == RT_NULL)
+    {
+        ret = -RT_EEMPTY;
+    }
+    else
+    {
+        ret = r.hdr.value_len;
+        if (size > r.hdr.value_len)
+            size = r.hdr.value_len;
+        if (buf != RT_NULL && size > 0
+                && flash_read(kv, r.addr + SLOTS_SIZE(kv) + sizeof(struct rec_hdr) + key_len, buf, size) != RT_EOK)
+            ret = -RT_EIO;
+    }
+    rt_mutex_release(&kv->lock);
+    return ret;
+}
+
+int fal_kv_batch_begin(struct fal_kv *kv)
+{
+    rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+    if (kv->batch != 0)
+    {
+        rt_mutex_release(&kv->lock);
+        return -RT_EBUSY;
+    }
+
+    /* the lock is held until the batch is committed or aborted */
+    kv->batch = kv->seq++;
+    kv->batch_cnt = 0;
+    kv->batch_new = 0;
+    return RT_EOK;
+}
+
+static void batch_drop(struct fal_kv *kv)
+{
+    rt_uint16_t i;
+
+    for (i = 0; i < kv->batch_cnt; i++)
+        slot_write(kv, kv->batch_addr[i], SLOT_DEL);
+}
+
+int fal_kv_batch_commit(struct fal_kv *kv)
+{
+    struct rec end, r;
+    rt_uint16_t i;
+    int ret = RT_EOK;
+
+    if (kv->batch == 0)
+        return -RT_ERROR;
+
+    if (kv->batch_cnt > 0)
+    {
+        /* the batch is committed with the end record, if the power fails after it
+         * the rest is done when the store is opened */
+        ret = rec_append(kv, "", 0, RT_NULL, 0, REC_BATCH_END, &end);
+        if (ret != RT_EOK)
+            batch_drop(kv);
+
+        for (i = 0; ret == RT_EOK && i < kv->batch_cnt; i++)
+        {
+            ret = rec_read(kv, kv->batch_addr[i], &r);
+            if (ret == RT_EOK && !rec_is_sane(kv, &r, kv->batch_addr[i] + kv->sector_size))
+                ret = -RT_EIO;
+            if (ret == RT_EOK)
+                ret = slot_write(kv, r.addr, SLOT_COMMIT);
+            if (ret == RT_EOK)
+                ret = index_apply(kv, &r, RT_FALSE);
+        }
+        if (ret == RT_EOK)
+            ret = slot_write(kv, end.addr, SLOT_DEL);
+    }
+
+    kv->batch = 0;
+    kv->batch_cnt = 0;
+    rt_mutex_release(&kv->lock);
+    return ret;
+}
+
+void fal_kv_batch_abort(struct fal_kv *kv)
+{
+    if (kv->batch == 0)
+        return;
+
+    batch_drop(kv);
+    kv->batch = 0;
+    kv->batch_cnt = 0;
+    rt_mutex_release(&kv->lock);
+}
+
+int fal_kv_gc(struct fal_kv *kv)
+{
+    int ret;
+
+    rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+    ret = gc_one(kv, RT_FALSE);
+    rt_mutex_release(&kv->lock);
+    return ret;
+}
+
+void fal_kv_get_stat(struct fal_kv *kv, struct fal_kv_stat *stat)
+{
+    struct fal_kv_sector *s;
+    rt_uint16_t i;
+
+    rt_mutex_take(&kv->lock, RT_WAITING_FOREVER);
+    *stat = kv->stat;
+    stat->keys = kv->key_cnt;
+    stat->sectors = kv->sector_cnt;
+    stat->empty_sectors = 0;
+    stat->live_bytes = 0;
+    stat->dead_bytes = 0;
+    stat->erase_min = 0xFFFFFFFF;
+    stat->erase_max = 0;
+    for (i = 0; i < kv->sector_cnt; i++)
+    {
+        s = &kv->sectors[i];
+        if (sector_is_empty(kv, i))
+            stat->empty_sectors++;
+        stat->live_bytes += s->live;
+        stat->dead_bytes += s->used - SECTOR_HDR_SIZE(kv) - s->live;
+        if (s->erase_cnt < stat->erase_min)
+            stat->erase_min = s->erase_cnt;
+        if (s->erase_cnt > stat->erase_max)
+            stat->erase_max = s->erase_cnt;
+    }
+    rt_mutex_release(&kv->lock);
+}
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and power failure test of the key-value store on a simulated NOR
+ * flash.
+ *
+ * The simulated flash keeps the data in RAM, a write can only clear bits and
+ * the erases and programs are delayed like a SPI NOR flash. The benchmark
+ * measures the get and set throughput, the erase counts of a hot counter
+ * compared with rewriting a sector per update, and batched against single
+ * sets. The power failure test cuts the power after each flash operation of a
+ * workload in turn, the last operation is torn, then opens the store again and
+ * checks that every key has its old or its new value and the batches are
+ * applied completely or not at all.
+ *
+ * msh: fal_kv_bench
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <fal_kv.h>
+#include "fal_sim_flash.h"
+
+#define PF_SECTOR_SIZE      1024        /* small sectors, the garbage collection runs often */
+#define PF_SECTORS          4
+#define PF_KEYS             6
+#define PF_STEPS            48
+
+#define BENCH_KEYS          64
+#define BENCH_VALUE_SIZE    32
+#define BENCH_GETS          2000
+#define BENCH_UPDATES       2000
+#define BENCH_REWRITES      100         /* an erase each, 4s */
+#define BENCH_BATCH         8
+#define BENCH_BATCHES       64
+
+static rt_uint32_t seed;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+static void value_fill(rt_uint8_t *value, rt_uint32_t key, rt_uint32_t version)
+{
+    rt_uint32_t i;
+
+    for (i = 0; i < BENCH_VALUE_SIZE; i++)
+        value[i] = (rt_uint8_t)(key * 31 + version * 7 + i);
+    rt_memcpy(value, &version, sizeof(version));
+}
+
+static rt_uint32_t report_ms(rt_tick_t tick)
+{
+    return (rt_tick_get() - tick) * 1000 / RT_TICK_PER_SECOND;
+}
+
+static void bench_throughput(struct fal_kv *kv)
+{
+    rt_uint8_t value[BENCH_VALUE_SIZE], buf[BENCH_VALUE_SIZE];
+    char key[12];
+    rt_uint32_t i, k, ms, errors = 0;
+    rt_tick_t tick;
+
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_KEYS; i++)
+    {
+        rt_snprintf(key, sizeof(key), "key%d", i);
+        value_fill(value, i, 0);
+        if (fal_kv_set(kv, key, value, sizeof(value)) != RT_EOK)
+            errors++;
+    }
+    ms = report_ms(tick);
+    rt_kprintf("set          %4d keys  %5d ms %6d ops/s\n", BENCH_KEYS, ms, ms ? BENCH_KEYS * 1000 / ms : 0);
+
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_GETS; i++)
+    {
+        k = bench_rand() % BENCH_KEYS;
+        rt_snprintf(key, sizeof(key), "key%d", k);
+        value_fill(value, k, 0);
+        if (fal_kv_get(kv, key, buf, sizeof(buf)) != sizeof(buf) || rt_memcmp(buf, value, sizeof(buf)) != 0)
+            errors++;
+    }
+    ms = report_ms(tick);
+    rt_kprintf("get          %4d reads %5d ms %6d ops/s, %s\n", BENCH_GETS, ms,
+               ms ? BENCH_GETS * 1000 / ms : 0, errors ? "FAIL" : "PASS");
+}
+
+static void bench_hot_counter(struct fal_kv *kv)
+{
+    rt_uint32_t i, ms, sum, min, max, counter = 0, errors = 0;
+    rt_tick_t tick;
+
+    rt_memset(fal_sim.erases, 0, sizeof(fal_sim.erases));
+    tick = rt_tick_get();
+    for (i = 1; i <= BENCH_UPDATES; i++)
+    {
+        if (fal_kv_set(kv, "counter", &i, sizeof(i)) != RT_EOK)
+            errors++;
+    }
+    ms = report_ms(tick);
+    if (fal_kv_get(kv, "counter", &counter, sizeof(counter)) != sizeof(counter) || counter != BENCH_UPDATES)
+        errors++;
+    sum = fal_sim_flash_erases(&min, &max);
+    rt_kprintf("kv counter   %4d sets  %5d ms, %4d erases, %4d per 1000 updates, sector erases %d..%d, %s\n",
+               BENCH_UPDATES, ms, sum, sum * 1000 / BENCH_UPDATES, min, max,
+               errors ? "FAIL" : "PASS");
+}
+
+/* the baseline rewrites the sector of the counter for every update */
+static void bench_rewrite(void)
+{
+    rt_uint32_t i, ms, sum, min, max;
+    rt_uint8_t *sector;
+    rt_tick_t tick;
+
+    sector = (rt_uint8_t *)rt_malloc(FAL_SIM_SECTOR_SIZE);
+    if (sector == RT_NULL)
+        return;
+    fal_sim_flash_reset(FAL_SIM_SECTOR_SIZE);
+    tick = rt_tick_get();
+    for (i = 1; i <= BENCH_REWRITES; i++)
+    {
+        fal_sim_dev.ops.read(0, sector, FAL_SIM_SECTOR_SIZE);
+        rt_memcpy(sector, &i, sizeof(i));
+        fal_sim_dev.ops.erase(0, FAL_SIM_SECTOR_SIZE);
+        fal_sim_dev.ops.write(0, sector, FAL_SIM_SECTOR_SIZE);
+    }
+    ms = report_ms(tick);
+    sum = fal_sim_flash_erases(&min, &max);
+    rt_kprintf("rewrite      %4d sets  %5d ms, %4d erases, %4d per 1000 updates, sector erases %d..%d\n",
+               BENCH_REWRITES, ms, sum, sum * 1000 / BENCH_REWRITES, min, max);
+    rt_free(sector);
+}
+
+static void bench_batch(struct fal_kv *kv)
+{
+    rt_uint8_t value[BENCH_VALUE_SIZE];
+    struct fal_kv_stat stat;
+    rt_uint32_t i, j, ms, writes, errors = 0;
+    char key[12];
+    rt_tick_t tick;
+
+    fal_kv_get_stat(kv, &stat);
+    writes = stat.flash_writes;
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_BATCHES; i++)
+    {
+        for (j = 0; j < BENCH_BATCH; j++)
+        {
+            rt_snprintf(key, sizeof(key), "key%d", j);
+            value_fill(value, j, i + 1);
+            if (fal_kv_set(kv, key, value, sizeof(value)) != RT_EOK)
+                errors++;
+        }
+    }
+    ms = report_ms(tick);
+    fal_kv_get_stat(kv, &stat);
+    rt_kprintf("single sets  %4d sets  %5d ms, %5d flash writes, %s\n", BENCH_BATCHES * BENCH_BATCH, ms,
+               stat.flash_writes - writes, errors ? "FAIL" : "PASS");
+
+    writes = stat.flash_writes;
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_BATCHES; i++)
+    {
+        fal_kv_batch_begin(kv);
+        for (j = 0; j < BENCH_BATCH; j++)
+        {
+            rt_snprintf(key, sizeof(key), "key%d", j);
+            value_fill(value, j, BENCH_BATCHES + i + 1);
+            if (fal_kv_set(kv, key, value, sizeof(value)) != RT_EOK)
+                errors++;
+        }
+        if (fal_kv_batch_commit(kv) != RT_EOK)
+            errors++;
+    }
+    ms = report_ms(tick);
+    fal_kv_get_stat(kv, &stat);
+    rt_kprintf("batch of %d  %4d sets  %5d ms, %5d flash writes, %s\n", BENCH_BATCH, BENCH_BATCHES * BENCH_BATCH,
+               ms, stat.flash_writes - writes, errors ? "FAIL" : "PASS");
+}
+
+/*
+ * The workload of the power failure test. Step s sets a key to version s or
+ * deletes it, every fourth step sets the keys "ba" and "bb" in a batch. The
+ * versions of the completed steps go to `done`, the versions of the step which
+ * was interrupted to `pending`, version 0 is a deleted key.
+ */
+static rt_bool_t pf_step(struct fal_kv *kv, rt_uint32_t step, rt_uint32_t *done, rt_uint32_t *pending)
+{
+    rt_uint8_t value[BENCH_VALUE_SIZE];
+    rt_uint32_t k = step % PF_KEYS;
+    char key[4] = "k0";
+
+    if (step % 4 == 3)
+    {
+        value_fill(value, PF_KEYS, step);
+        pending[PF_KEYS] = step;
+        fal_kv_batch_begin(kv);
+        fal_kv_set(kv, "ba", value, sizeof(value));
+        fal_kv_set(kv, "bb", value, sizeof(value));
+        fal_kv_batch_commit(kv);
+        k = PF_KEYS;
+    }
+    else
+    {
+        key[1] = '0' + k;
+        pending[k] = step % 7 == 5 ? 0 : step;
+        if (pending[k] == 0)
+        {
+            fal_kv_del(kv, key);
+        }
+        else
+        {
+            value_fill(value, k, step);
+            fal_kv_set(kv, key, value, sizeof(value));
+        }
+    }
+
+    if (fal_sim.cut)
+        return RT_FALSE;
+    done[k] = pending[k];
+    return RT_TRUE;
+}
+
+static rt_bool_t pf_value_ok(struct fal_kv *kv, const char *key, rt_uint32_t k, rt_uint32_t *version,
+                             rt_uint32_t done, rt_uint32_t pending)
+{
+    rt_uint8_t value[BENCH_VALUE_SIZE], exp[BENCH_VALUE_SIZE];
+    int len;
+
+    len = fal_kv_get(kv, key, value, sizeof(value));
+    if (len == -RT_EEMPTY)
+    {
+        *version = 0;
+    }
+    else
+    {
+        if (len != sizeof(value))
+            return RT_FALSE;
+        rt_memcpy(version, value, sizeof(*version));
+        value_fill(exp, k, *version);
+        if (rt_memcmp(value, exp, sizeof(exp)) != 0)
+            return RT_FALSE;
+    }
+    return *version == done || *version == pending;
+}
+
+static rt_bool_t pf_check(struct fal_kv *kv, rt_uint32_t *done, rt_uint32_t *pending)
+{
+    rt_uint32_t k, va, vb;
+    char key[4] = "k0";
+
+    for (k = 0; k < PF_KEYS; k++)
+    {
+        key[1] = '0' + k;
+        if (!pf_value_ok(kv, key, k, &va, done[k], pending[k]))
+        {
+            rt_kprintf("%s: version %d, expected %d or %d\n", key, va, done[k], pending[k]);
+            return RT_FALSE;
+        }
+    }
+    if (!pf_value_ok(kv, "ba", PF_KEYS, &va, done[PF_KEYS], pending[PF_KEYS])
+            || !pf_value_ok(kv, "bb", PF_KEYS, &vb, done[PF_KEYS], pending[PF_KEYS]) || va != vb)
+    {
+        rt_kprintf("batch: versions %d and %d, expected %d or %d\n", va, vb, done[PF_KEYS], pending[PF_KEYS]);
+        return RT_FALSE;
+    }
+    return RT_TRUE;
+}
+
+/* cut the power after each flash operation of the workload in turn */
+static void bench_power_fail(struct fal_kv *kv)
+{
+    rt_uint32_t done[PF_KEYS + 1], pending[PF_KEYS + 1];
+    rt_uint32_t step, ops, cuts = 0, gc_runs = 0;
+    struct fal_kv_stat stat;
+    rt_bool_t ok = RT_TRUE;
+    rt_int32_t cut;
+
+    /* count the flash operations of the workload */
+    rt_memset(done, 0, sizeof(done));
+    rt_memset(pending, 0, sizeof(pending));
+    fal_sim_flash_reset(PF_SECTOR_SIZE);
+    if (fal_kv_init_flash(kv, &fal_sim_dev, 0, PF_SECTOR_SIZE * PF_SECTORS) != RT_EOK)
+        return;
+    fal_sim.budget = 0x7FFFFFFF;
+    for (step = 1; step <= PF_STEPS; step++)
+        pf_step(kv, step, done, pending);
+    ops = 0x7FFFFFFF - fal_sim.budget;
+    fal_kv_deinit(kv);
+
+    for (cut = 0; cut < (rt_int32_t)ops && ok; cut++)
+    {
+        fal_sim_flash_reset(PF_SECTOR_SIZE);
+        rt_memset(done, 0, sizeof(done));
+        rt_memset(pending, 0, sizeof(pending));
+        if (fal_kv_init_flash(kv, &fal_sim_dev, 0, PF_SECTOR_SIZE * PF_SECTORS) != RT_EOK)
+        {
+            ok = RT_FALSE;
+            break;
+        }
+
+        fal_sim.budget = cut;
+        for (step = 1; step <= PF_STEPS && pf_step(kv, step, done, pending); step++);
+        if (!fal_sim.cut)
+        {
+            /* a garbage collection thread consumed operations of the workload */
+            fal_kv_deinit(kv);
+            continue;
+        }
+        fal_kv_get_stat(kv, &stat);
+        gc_runs += stat.gc_runs;
+        fal_kv_deinit(kv);
+
+        /* power on */
+        cuts++;
+        fal_sim.budget = -1;
+        fal_sim.cut = RT_FALSE;
+        if (fal_kv_init_flash(kv, &fal_sim_dev, 0, PF_SECTOR_SIZE * PF_SECTORS) != RT_EOK)
+        {
+            rt_kprintf("cut after %d operations: open failed\n", cut);
+            ok = RT_FALSE;
+            break;
+        }
+        ok = pf_check(kv, done, pending);
+        /* the store goes on working after the recovery */
+        if (ok)
+            ok = pf_step(kv, PF_STEPS + 1, done, pending) && pf_check(kv, done, pending);
+        if (!ok)
+            rt_kprintf("cut after %d operations: FAIL\n", cut);
+        fal_kv_deinit(kv);
+    }
+
+    rt_kprintf("power fail   %4d cuts, %d sectors collected before the cuts, %s\n", cuts, gc_runs,
+               ok ? "PASS" : "FAIL");
+}
+
+static int fal_kv_bench(void)
+{
+    static struct fal_kv kv;
+    struct fal_kv_stat stat;
+
+    if (fal_sim_flash_create() != RT_EOK)
+    {
+        rt_kprintf("no memory\n");
+        return 0;
+    }
+    seed = 1;
+
+    fal_sim.delay = RT_TRUE;
+    if (fal_kv_init_flash(&kv, &fal_sim_dev, 0, fal_sim.size) == RT_EOK)
+    {
+        bench_throughput(&kv);
+        bench_batch(&kv);
+        bench_hot_counter(&kv);
+
+        fal_kv_get_stat(&kv, &stat);
+        rt_kprintf("store: %d keys, %d live bytes, %d dead bytes, %d sectors collected, %d records moved, "
+                   "sector erase counts %d..%d\n", stat.keys, stat.live_bytes, stat.dead_bytes,
+                   stat.gc_runs, stat.gc_moved, stat.erase_min, stat.erase_max);
+        fal_kv_deinit(&kv);
+    }
+    bench_rewrite();
+
+    fal_sim.delay = RT_FALSE;
+    bench_power_fail(&kv);
+
+    fal_sim_flash_delete();
+    return 0;
+}
+MSH_CMD_EXPORT(fal_kv_bench, FAL key-value store benchmark and power failure test on a simulated flash);
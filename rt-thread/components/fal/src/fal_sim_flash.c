@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include "fal_sim_flash.h"
+
+#define SIM_ERASE_US        40000       /* 4KB sector erase */
+#define SIM_WRITE_US        10          /* command and address */
+#define SIM_WRITE_BYTE_NS   2700        /* 256 bytes page program in 0.7ms */
+
+struct fal_sim_flash fal_sim;
+
+static int sim_init(void)
+{
+    return 0;
+}
+
+static int sim_read(long offset, rt_uint8_t *buf, size_t size)
+{
+    if (offset + size > fal_sim.size)
+        return -1;
+    rt_memcpy(buf, fal_sim.data + offset, size);
+    return size;
+}
+
+/* the operation torn by the power failure does half its work, the ones after it nothing */
+static rt_bool_t sim_power(size_t *size)
+{
+    if (fal_sim.cut)
+        return RT_FALSE;
+    if (fal_sim.budget >= 0 && fal_sim.budget-- == 0)
+    {
+        fal_sim.cut = RT_TRUE;
+        *size /= 2;
+    }
+    return RT_TRUE;
+}
+
+static int sim_write(long offset, const rt_uint8_t *buf, size_t size)
+{
+    size_t i, n = size;
+
+    if (offset + size > fal_sim.size)
+        return -1;
+    if (fal_sim.delay)
+        rt_hw_us_delay(SIM_WRITE_US + size * SIM_WRITE_BYTE_NS / 1000);
+    if (!sim_power(&n))
+        return size;
+    for (i = 0; i < n; i++)
+        fal_sim.data[offset + i] &= buf[i];
+    return size;
+}
+
+static int sim_erase(long offset, size_t size)
+{
+    rt_uint32_t block = offset / fal_sim_dev.blk_size;
+    size_t n = size;
+
+    if (offset % fal_sim_dev.blk_size != 0 || offset + size > fal_sim.size)
+        return -1;
+    if (fal_sim.delay)
+        rt_hw_us_delay(SIM_ERASE_US);
+    if (!sim_power(&n))
+        return size;
+    if (block < FAL_SIM_SECTORS)
+        fal_sim.erases[block]++;
+    rt_memset(fal_sim.data + offset, 0xFF, n);
+    return size;
+}
+
+struct fal_flash_dev fal_sim_dev =
+{
+    .name = "falsim",
+    .addr = 0,
+    .len = FAL_SIM_SECTOR_SIZE * FAL_SIM_SECTORS,
+    .blk_size = FAL_SIM_SECTOR_SIZE,
+    .ops = { sim_init, sim_read, sim_write, sim_erase },
+    .write_gran = 1,
+};
+
+/* allocate the erased flash */
+int fal_sim_flash_create(void)
+{
+    fal_sim.size = FAL_SIM_SECTOR_SIZE * FAL_SIM_SECTORS;
+    fal_sim.data = (rt_uint8_t *)rt_malloc(fal_sim.size);
+    if (fal_sim.data == RT_NULL)
+        return -RT_ENOMEM;
+    fal_sim.delay = RT_FALSE;
+    fal_sim_flash_reset(FAL_SIM_SECTOR_SIZE);
+    return RT_EOK;
+}
+
+void fal_sim_flash_delete(void)
+{
+    rt_free(fal_sim.data);
+    fal_sim.data = RT_NULL;
+}
+
+/* erase the flash with the given block size, clear the erase counts and turn the power on */
+void fal_sim_flash_reset(rt_uint32_t blk_size)
+{
+    fal_sim_dev.blk_size = blk_size;
+    rt_memset(fal_sim.data, 0xFF, fal_sim.size);
+    rt_memset(fal_sim.erases, 0, sizeof(fal_sim.erases));
+    fal_sim.budget = -1;
+    fal_sim.cut = RT_FALSE;
+}
+
+/* the sum of the erase counts and the counts of the least and the most erased block */
+rt_uint32_t fal_sim_flash_erases(rt_uint32_t *min, rt_uint32_t *max)
+{
+    rt_uint32_t i, blocks, sum = 0;
+
+    blocks = RT_MIN(fal_sim.size / fal_sim_dev.blk_size, FAL_SIM_SECTORS);
+    *min = 0xFFFFFFFF;
+    *max = 0;
+    for (i = 0; i < blocks; i++)
+    {
+        sum += fal_sim.erases[i];
+        if (fal_sim.erases[i] < *min)
+            *min = fal_sim.erases[i];
+        if (fal_sim.erases[i] > *max)
+            *max = fal_sim.erases[i];
+    }
+    return sum;
+}
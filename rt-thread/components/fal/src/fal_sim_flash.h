@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef _FAL_SIM_FLASH_H_
+#define _FAL_SIM_FLASH_H_
+
+#include <fal.h>
+
+#define FAL_SIM_SECTOR_SIZE     4096
+#define FAL_SIM_SECTORS         16
+
+/*
+ * The NOR flash simulated in RAM for the benchmarks of the key-value store and
+ * the time-series log. A write can only clear bits, with `delay` the erases
+ * and programs take as long as on a SPI NOR flash. The flash operations have
+ * no context, so there is one simulated flash.
+ */
+struct fal_sim_flash
+{
+    rt_uint8_t *data;
+    rt_uint32_t size;
+    rt_uint32_t erases[FAL_SIM_SECTORS];    /* erases of each block */
+    rt_bool_t delay;
+    rt_int32_t budget;          /* program and erase operations before the power is cut, < 0: no cut */
+    rt_bool_t cut;              /* the power was cut, the operations do nothing */
+};
+
+extern struct fal_sim_flash fal_sim;
+extern struct fal_flash_dev fal_sim_dev;
+
+int fal_sim_flash_create(void);
+void fal_sim_flash_delete(void);
+void fal_sim_flash_reset(rt_uint32_t blk_size);
+rt_uint32_t fal_sim_flash_erases(rt_uint32_t *min, rt_uint32_t *max);
+
+#endif /* _FAL_SIM_FLASH_H_ */
@@ -0,0 +1,719 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Time-series ring log on a FAL partition.
+ *
+ *   segment: | segment header | record | record | ... | erased |
+ *   record:  | len | payload (len bytes) | crc8 | padding to the write granularity |
+ *
+ * The segments are the erase blocks of the partition and are used in turn, a
+ * new segment gets the next sequence number and the oldest one is erased when
+ * the partition is full. The sequence numbers of the segments in use are
+ * contiguous, so a segment is found from its sequence number without a search.
+ *
+ * The payload is the time and the values, or with FAL_TSL_DELTA their
+ * differences to the previous sample as zigzag varints. The first sample of a
+ * segment is relative to zero so the segments can be read separately.
+ *
+ * A record is one flash write. A record torn by a power failure fails its crc,
+ * it and the rest of its segment are ignored and the next sample goes to a new
+ * segment.
+ */
+
+#include <fal_tsl.h>
+#include <string.h>
+
+#define DBG_TAG               "fal.tsl"
+#define DBG_LVL               DBG_INFO
+#include <rtdbg.h>
+
+#define SEG_MAGIC           0x30535446      /* "FTS0" */
+#define ALIGN_MAX           32
+#define REC_PAYLOAD_MAX     (5 * (1 + FAL_TSL_FIELDS_MAX))
+#define REC_LEN_ERASED      0xFF
+
+#define SEG_HDR_SIZE(tsl)   RT_ALIGN(sizeof(struct seg_hdr), (tsl)->align)
+#define REC_SIZE(tsl, len)  RT_ALIGN((len) + 2, (tsl)->align)
+#define SEG_ADDR(tsl, seg)  ((rt_uint32_t)(seg) * (tsl)->seg_size)
+
+struct seg_hdr
+{
+    rt_uint32_t magic;
+    rt_uint32_t seq;
+    rt_uint32_t seq_inv;            /* ~seq, detects a torn header */
+    rt_uint8_t fields;
+    rt_uint8_t flags;
+    rt_uint16_t reserved;
+};
+
+struct fal_tsl_seg
+{
+    rt_uint32_t seq;
+    rt_uint32_t time_min;
+    rt_uint32_t time_max;
+    rt_uint32_t count;              /* samples */
+    rt_uint32_t used;               /* end of the records, 0: not in use */
+};
+
+static rt_uint8_t crc8(const rt_uint8_t *buf, rt_size_t len)
+{
+    rt_uint8_t crc = 0;
+    int i;
+
+    while (len--)
+    {
+        crc ^= *buf++;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+static rt_uint8_t *put_varint(rt_uint8_t *p, rt_uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = (rt_uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (rt_uint8_t)v;
+    return p;
+}
+
+static const rt_uint8_t *get_varint(const rt_uint8_t *p, const rt_uint8_t *end, rt_uint32_t *v)
+{
+    rt_uint32_t shift;
+
+    *v = 0;
+    for (shift = 0; p < end && shift < 35; shift += 7)
+    {
+        *v |= (rt_uint32_t)(*p & 0x7F) << shift;
+        if (!(*p++ & 0x80))
+            return p;
+    }
+    return RT_NULL;
+}
+
+static int flash_read(struct fal_tsl *tsl, rt_uint32_t addr, void *buf, rt_size_t size)
+{
+    tsl->stat.flash_reads++;
+    if (tsl->flash->ops.read(tsl->offset + addr, (rt_uint8_t *)buf, size) != (int)size)
+    {
+        LOG_E("read %d bytes at 0x%08x failed", size, tsl->offset + addr);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+static int flash_write(struct fal_tsl *tsl, rt_uint32_t addr, const void *buf, rt_size_t size)
+{
+    tsl->stat.flash_writes++;
+    if (tsl->flash->ops.write(tsl->offset + addr, (const rt_uint8_t *)buf, size) != (int)size)
+    {
+        LOG_E("write %d bytes at 0x%08x failed", size, tsl->offset + addr);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+static rt_uint16_t seg_of(struct fal_tsl *tsl, rt_uint32_t seq)
+{
+    return (tsl->head + (seq - tsl->head_seq)) % tsl->seg_cnt;
+}
+
+/* the payload of a sample, relative to `base` with FAL_TSL_DELTA */
+static rt_size_t rec_encode(struct fal_tsl *tsl, rt_uint8_t *p, const struct fal_tsl_sample *s,
+                            const struct fal_tsl_sample *base)
+{
+    rt_uint8_t *start = p;
+    rt_int32_t d;
+    int i;
+
+    if (tsl->flags & FAL_TSL_DELTA)
+    {
+        p = put_varint(p, s->time - base->time);
+        for (i = 0; i < tsl->fields; i++)
+        {
+            d = (rt_int32_t)((rt_uint32_t)s->value[i] - (rt_uint32_t)base->value[i]);
+            p = put_varint(p, ((rt_uint32_t)d << 1) ^ (rt_uint32_t)(d >> 31));
+        }
+    }
+    else
+    {
+        rt_memcpy(p, &s->time, sizeof(rt_uint32_t));
+        rt_memcpy(p + sizeof(rt_uint32_t), s->value, tsl->fields * sizeof(rt_int32_t));
+        p += sizeof(rt_uint32_t) + tsl->fields * sizeof(rt_int32_t);
+    }
+    return p - start;
+}
+
+static int rec_decode(struct fal_tsl *tsl, const rt_uint8_t *p, rt_size_t len, struct fal_tsl_sample *s,
+                      const struct fal_tsl_sample *base)
+{
+    const rt_uint8_t *end = p + len;
+    rt_uint32_t v;
+    int i;
+
+    if (tsl->flags & FAL_TSL_DELTA)
+    {
+        p = get_varint(p, end, &v);
+        if (p == RT_NULL)
+            return -RT_ERROR;
+        s->time = base->time + v;
+        for (i = 0; i < tsl->fields; i++)
+        {
+            p = get_varint(p, end, &v);
+            if (p == RT_NULL)
+                return -RT_ERROR;
+            s->value[i] = (rt_int32_t)((rt_uint32_t)base->value[i] + ((v >> 1) ^ (0 - (v & 1))));
+        }
+        return p == end ? RT_EOK : -RT_ERROR;
+    }
+
+    if (len != sizeof(rt_uint32_t) + tsl->fields * sizeof(rt_int32_t))
+        return -RT_ERROR;
+    rt_memcpy(&s->time, p, sizeof(rt_uint32_t));
+    rt_memcpy(s->value, p + sizeof(rt_uint32_t), tsl->fields * sizeof(rt_int32_t));
+    return RT_EOK;
+}
+
+/* check and decode the record at the start of `buf`, return its size on the flash or 0 */
+static rt_size_t rec_parse(struct fal_tsl *tsl, const rt_uint8_t *buf, rt_size_t avail,
+                           struct fal_tsl_sample *s, const struct fal_tsl_sample *base)
+{
+    rt_uint8_t len = buf[0];
+
+    if (len == 0 || len > REC_PAYLOAD_MAX || avail < (rt_size_t)len + 2)
+        return 0;
+    if (crc8(buf, len + 1) != buf[len + 1])
+        return 0;
+    if (rec_decode(tsl, buf + 1, len, s, base) != RT_EOK)
+        return 0;
+    return REC_SIZE(tsl, len);
+}
+
+/* scan the records of a segment, the next record goes to a new segment if one is torn */
+static int seg_scan(struct fal_tsl *tsl, rt_uint16_t seg, rt_uint32_t *write_pos, struct fal_tsl_sample *last)
+{
+    struct fal_tsl_seg *sg = &tsl->segs[seg];
+    struct fal_tsl_sample s, prev;
+    rt_uint8_t buf[REC_PAYLOAD_MAX + 2];
+    rt_uint32_t pos = SEG_HDR_SIZE(tsl), n;
+    rt_size_t size;
+
+    rt_memset(&prev, 0, sizeof(prev));
+    sg->count = 0;
+    *write_pos = tsl->seg_size;
+    while (pos < tsl->seg_size)
+    {
+        n = tsl->seg_size - pos < sizeof(buf) ? tsl->seg_size - pos : sizeof(buf);
+        if (flash_read(tsl, SEG_ADDR(tsl, seg) + pos, buf, n) != RT_EOK)
+            return -RT_EIO;
+        if (buf[0] == REC_LEN_ERASED)
+        {
+            *write_pos = pos;
+            break;
+        }
+        size = rec_parse(tsl, buf, n, &s, &prev);
+        if (size == 0)
+        {
+            LOG_W("torn record in segment %d at %d", seg, pos);
+            break;
+        }
+        if (sg->count++ == 0)
+            sg->time_min = s.time;
+        sg->time_max = s.time;
+        prev = s;
+        pos += size;
+    }
+
+    sg->used = pos;
+    *last = prev;
+    return RT_EOK;
+}
+
+static int seg_erase(struct fal_tsl *tsl, rt_uint16_t seg)
+{
+    tsl->stat.erases++;
+    tsl->segs[seg].used = 0;
+    if (tsl->flash->ops.erase(tsl->offset + SEG_ADDR(tsl, seg), tsl->seg_size) < 0)
+    {
+        LOG_E("erase segment %d failed", seg);
+        return -RT_EIO;
+    }
+    return RT_EOK;
+}
+
+/* start the segment after the current one, the oldest is dropped if the log is full */
+static int seg_new(struct fal_tsl *tsl)
+{
+    rt_uint8_t buf[RT_ALIGN(sizeof(struct seg_hdr), ALIGN_MAX)];
+    struct seg_hdr hdr;
+    rt_uint16_t seg;
+    rt_uint32_t seq;
+    int ret;
+
+    seg = tsl->empty ? tsl->cur : (tsl->cur + 1) % tsl->seg_cnt;
+    seq = tsl->cur_seq + 1;
+    if (!tsl->empty && seg == tsl->head)
+    {
+        tsl->head = (tsl->head + 1) % tsl->seg_cnt;
+        tsl->head_seq++;
+    }
+
+    ret = seg_erase(tsl, seg);
+    if (ret != RT_EOK)
+        return ret;
+
+    hdr.magic = SEG_MAGIC;
+    hdr.seq = seq;
+    hdr.seq_inv = ~seq;
+    hdr.fields = tsl->fields;
+    hdr.flags = tsl->flags;
+    hdr.reserved = 0xFFFF;
+    rt_memset(buf, 0xFF, sizeof(buf));
+    rt_memcpy(buf, &hdr, sizeof(hdr));
+    ret = flash_write(tsl, SEG_ADDR(tsl, seg), buf, SEG_HDR_SIZE(tsl));
+    if (ret != RT_EOK)
+        return ret;
+
+    if (tsl->empty)
+    {
+        tsl->head = seg;
+        tsl->head_seq = seq;
+        tsl->empty = RT_FALSE;
+    }
+    tsl->cur = seg;
+    tsl->cur_seq = seq;
+    tsl->segs[seg].seq = seq;
+    tsl->segs[seg].count = 0;
+    tsl->segs[seg].used = SEG_HDR_SIZE(tsl);
+    return RT_EOK;
+}
+
+static int tsl_load(struct fal_tsl *tsl, rt_uint32_t *write_pos)
+{
+    struct fal_tsl_sample last;
+    struct seg_hdr hdr;
+    rt_uint32_t pos, max_seq = 0;
+    rt_uint16_t i, seg;
+    rt_bool_t found = RT_FALSE, reformat = RT_FALSE;
+    int ret;
+
+    for (i = 0; i < tsl->seg_cnt; i++)
+    {
+        tsl->segs[i].used = 0;
+        if (flash_read(tsl, SEG_ADDR(tsl, i), &hdr, sizeof(hdr)) != RT_EOK)
+            return -RT_EIO;
+        /* blank, or torn by a power failure while it was started */
+        if (hdr.magic != SEG_MAGIC || hdr.seq != ~hdr.seq_inv)
+            continue;
+        if (hdr.fields != tsl->fields || hdr.flags != tsl->flags)
+        {
+            reformat = RT_TRUE;
+            continue;
+        }
+        tsl->segs[i].seq = hdr.seq;
+        tsl->segs[i].used = SEG_HDR_SIZE(tsl);
+        if (!found || hdr.seq > max_seq)
+        {
+            max_seq = hdr.seq;
+            tsl->cur = i;
+            found = RT_TRUE;
+        }
+    }
+
+    tsl->empty = RT_TRUE;
+    tsl->cur_seq = max_seq;
+    if (reformat)
+    {
+        LOG_W("the log has other fields, erase it");
+        for (i = 0; i < tsl->seg_cnt; i++)
+        {
+            ret = seg_erase(tsl, i);
+            if (ret != RT_EOK)
+                return ret;
+        }
+        tsl->cur = 0;
+        return RT_EOK;
+    }
+    if (!found)
+        return RT_EOK;
+
+    /* the segments before the newest one with contiguous sequence numbers */
+    tsl->empty = RT_FALSE;
+    tsl->head = tsl->cur;
+    tsl->head_seq = tsl->cur_seq;
+    for (i = 1; i < tsl->seg_cnt; i++)
+    {
+        seg = (tsl->cur + tsl->seg_cnt - i) % tsl->seg_cnt;
+        if (tsl->segs[seg].used == 0 || tsl->segs[seg].seq != tsl->head_seq - 1)
+            break;
+        tsl->head = seg;
+        tsl->head_seq--;
+    }
+    for (i = 0; i < tsl->seg_cnt; i++)
+    {
+        if (tsl->segs[i].used == 0)
+            continue;
+        if (tsl->segs[i].seq - tsl->head_seq > tsl->cur_seq - tsl->head_seq)
+        {
+            /* left over, it's erased when it's used next */
+            tsl->segs[i].used = 0;
+            continue;
+        }
+        ret = seg_scan(tsl, i, &pos, &last);
+        if (ret != RT_EOK)
+            return ret;
+        if (i == tsl->cur)
+        {
+            *write_pos = pos;
+            tsl->last = last;
+        }
+    }
+    return RT_EOK;
+}
+
+int fal_tsl_init_flash(struct fal_tsl *tsl, const struct fal_flash_dev *flash, long offset, size_t len,
+                       rt_uint8_t fields, rt_uint8_t flags)
+{
+    rt_uint32_t write_pos = 0;
+    int ret;
+
+    RT_ASSERT(tsl != RT_NULL);
+    RT_ASSERT(flash != RT_NULL);
+
+    rt_memset(tsl, 0, sizeof(struct fal_tsl));
+    tsl->flash = flash;
+    tsl->offset = offset;
+    tsl->seg_size = flash->blk_size;
+    tsl->seg_cnt = len / flash->blk_size;
+    tsl->align = flash->write_gran > 8 ? flash->write_gran / 8 : 1;
+    tsl->fields = fields;
+    tsl->flags = flags;
+    if (fields == 0 || fields > FAL_TSL_FIELDS_MAX || offset % flash->blk_size != 0 || tsl->seg_cnt < 2
+            || tsl->align > ALIGN_MAX)
+    {
+        LOG_E("unsupported log: %d fields, %d segments, write granularity %d bytes",
+              fields, tsl->seg_cnt, tsl->align);
+        return -RT_EINVAL;
+    }
+
+    tsl->segs = (struct fal_tsl_seg *)rt_calloc(tsl->seg_cnt, sizeof(struct fal_tsl_seg));
+    if (tsl->segs == RT_NULL)
+        return -RT_ENOMEM;
+
+    ret = tsl_load(tsl, &write_pos);
+    if (ret != RT_EOK)
+    {
+        LOG_E("load the log on %s failed (%d)", flash->name, ret);
+        rt_free(tsl->segs);
+        tsl->segs = RT_NULL;
+        return ret;
+    }
+    /* a torn record closed the current segment, write_pos is at its end then */
+    tsl->write_pos = write_pos;
+    rt_mutex_init(&tsl->lock, "fal_tsl", RT_IPC_FLAG_PRIO);
+
+    LOG_D("%d segments on %s, sequence %d..%d", tsl->seg_cnt, flash->name, tsl->head_seq, tsl->cur_seq);
+    return RT_EOK;
+}
+
+int fal_tsl_init(struct fal_tsl *tsl, const char *part_name, rt_uint8_t fields, rt_uint8_t flags)
+{
+    const struct fal_partition *part;
+    const struct fal_flash_dev *flash;
+
+    part = fal_partition_find(part_name);
+    if (part == RT_NULL)
+    {
+        LOG_E("partition %s not found", part_name);
+        return -RT_ERROR;
+    }
+    flash = fal_flash_device_find(part->flash_name);
+    if (flash == RT_NULL)
+    {
+        LOG_E("flash device %s not found", part->flash_name);
+        return -RT_ERROR;
+    }
+    return fal_tsl_init_flash(tsl, flash, part->offset, part->len, fields, flags);
+}
+
+void fal_tsl_deinit(struct fal_tsl *tsl)
+{
+    rt_mutex_detach(&tsl->lock);
+    rt_free(tsl->segs);
+    tsl->segs = RT_NULL;
+}
+
+int fal_tsl_clean(struct fal_tsl *tsl)
+{
+    rt_uint16_t i;
+    int ret = RT_EOK;
+
+    rt_mutex_take(&tsl->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < tsl->seg_cnt && ret == RT_EOK; i++)
+    {
+        if (tsl->segs[i].used != 0)
+            ret = seg_erase(tsl, i);
+    }
+    tsl->empty = RT_TRUE;
+    rt_mutex_release(&tsl->lock);
+    return ret;
+}
+
+int fal_tsl_append(struct fal_tsl *tsl, rt_uint32_t time, const rt_int32_t *values)
+{
+    static const struct fal_tsl_sample zero;
+    rt_uint8_t buf[RT_ALIGN(REC_PAYLOAD_MAX + 2, ALIGN_MAX)];
+    struct fal_tsl_seg *sg;
+    struct fal_tsl_sample s;
+    rt_size_t len, size;
+    int ret;
+
+    s.time = time;
+    rt_memcpy(s.value, values, tsl->fields * sizeof(rt_int32_t));
+
+    rt_mutex_take(&tsl->lock, RT_WAITING_FOREVER);
+    if (!tsl->empty && time < tsl->last.time)
+    {
+        rt_mutex_release(&tsl->lock);
+        return -RT_EINVAL;
+    }
+
+    len = tsl->empty ? 0 : rec_encode(tsl, buf + 1, &s, tsl->segs[tsl->cur].count ? &tsl->last : &zero);
+    if (tsl->empty || tsl->write_pos + REC_SIZE(tsl, len) > tsl->seg_size)
+    {
+        ret = seg_new(tsl);
+        if (ret != RT_EOK)
+        {
+            rt_mutex_release(&tsl->lock);
+            return ret;
+        }
+        tsl->write_pos = SEG_HDR_SIZE(tsl);
+        len = rec_encode(tsl, buf + 1, &s, &zero);
+    }
+
+    size = REC_SIZE(tsl, len);
+    buf[0] = len;
+    buf[len + 1] = crc8(buf, len + 1);
+    rt_memset(buf + len + 2, 0xFF, size - len - 2);
+    ret = flash_write(tsl, SEG_ADDR(tsl, tsl->cur) + tsl->write_pos, buf, size);
+    if (ret != RT_EOK)
+    {
+        /* the segment is closed, the next sample goes to a new one */
+        tsl->write_pos = tsl->seg_size;
+    }
+    else
+    {
+        sg = &tsl->segs[tsl->cur];
+        if (sg->count++ == 0)
+            sg->time_min = time;
+        sg->time_max = time;
+        tsl->write_pos += size;
+        sg->used = tsl->write_pos;
+        tsl->last = s;
+        tsl->stat.appends++;
+    }
+    rt_mutex_release(&tsl->lock);
+    return ret;
+}
+
+int fal_tsl_iter_init(struct fal_tsl *tsl, struct fal_tsl_iter *iter, rt_uint32_t from, rt_uint32_t to)
+{
+    rt_uint32_t lo, hi, mid;
+
+    rt_memset(iter, 0, sizeof(struct fal_tsl_iter));
+    iter->tsl = tsl;
+    iter->from = from;
+    iter->to = to;
+    iter->pos = SEG_HDR_SIZE(tsl);
+
+    rt_mutex_take(&tsl->lock, RT_WAITING_FOREVER);
+    if (tsl->empty)
+    {
+        iter->end = RT_TRUE;
+    }
+    else
+    {
+        /* the first segment which ends at or after `from` */
+        lo = tsl->head_seq;
+        hi = tsl->cur_seq + 1;
+        while (lo != hi)
+        {
+            mid = lo + (hi - lo) / 2;
+            if (tsl->segs[seg_of(tsl, mid)].count == 0 || tsl->segs[seg_of(tsl, mid)].time_max < from)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        iter->seq = lo;
+    }
+    rt_mutex_release(&tsl->lock);
+    return RT_EOK;
+}
+
+/* the record at the position of the iterator, read ahead through its buffer */
+static const rt_uint8_t *iter_fetch(struct fal_tsl_iter *iter, rt_uint32_t used, rt_size_t *avail)
+{
+    struct fal_tsl *tsl = iter->tsl;
+    rt_uint32_t addr = SEG_ADDR(tsl, seg_of(tsl, iter->seq)) + iter->pos;
+    rt_uint32_t need, n;
+
+    need = used - iter->pos < REC_PAYLOAD_MAX + 2 ? used - iter->pos : REC_PAYLOAD_MAX + 2;
+    if (iter->buf_len == 0 || addr < iter->buf_pos || addr + need > iter->buf_pos + iter->buf_len)
+    {
+        n = used - iter->pos < sizeof(iter->buf) ? used - iter->pos : sizeof(iter->buf);
+        if (flash_read(tsl, addr, iter->buf, n) != RT_EOK)
+            return RT_NULL;
+        iter->buf_pos = addr;
+        iter->buf_len = n;
+    }
+    *avail = need;
+    return iter->buf + (addr - iter->buf_pos);
+}
+
+static void iter_next_seg(struct fal_tsl_iter *iter, rt_uint32_t seq)
+{
+    iter->seq = seq;
+    iter->pos = SEG_HDR_SIZE(iter->tsl);
+    iter->buf_len = 0;
+    rt_memset(&iter->prev, 0, sizeof(iter->prev));
+}
+
+int fal_tsl_iter_next(struct fal_tsl_iter *iter, struct fal_tsl_sample *sample)
+{
+    struct fal_tsl *tsl = iter->tsl;
+    const rt_uint8_t *rec;
+    rt_size_t avail, size;
+    rt_uint32_t used;
+    int ret = -RT_EEMPTY;
+
+    rt_mutex_take(&tsl->lock, RT_WAITING_FOREVER);
+    while (!iter->end && !tsl->empty && iter->seq != tsl->cur_seq + 1)
+    {
+        /* the segment was overwritten, go on with the oldest one */
+        if (iter->seq - tsl->head_seq > tsl->cur_seq - tsl->head_seq)
+            iter_next_seg(iter, tsl->head_seq);
+
+        used = tsl->segs[seg_of(tsl, iter->seq)].used;
+        rec = iter->pos < used ? iter_fetch(iter, used, &avail) : RT_NULL;
+        size = rec != RT_NULL ? rec_parse(tsl, rec, avail, sample, &iter->prev) : 0;
+        if (size == 0)
+        {
+            /* the end of the segment, the current one may grow later */
+            if (iter->seq == tsl->cur_seq)
+                break;
+            iter_next_seg(iter, iter->seq + 1);
+            continue;
+        }
+
+        iter->pos += size;
+        iter->prev = *sample;
+        if (sample->time < iter->from)
+            continue;
+        if (sample->time > iter->to)
+        {
+            iter->end = RT_TRUE;
+            break;
+        }
+        ret = RT_EOK;
+        break;
+    }
+    rt_mutex_release(&tsl->lock);
+    return ret;
+}
+
+static void point_put(void *points, rt_size_t point_size, rt_uint16_t i, rt_int64_t v)
+{
+    rt_int32_t max = point_size == sizeof(rt_int16_t) ? 0x7FFF : 0x7FFFFFFF;
+
+    /* the max value means no point */
+    if (v >= max)
+        v = max - 1;
+    if (v < -max - 1)
+        v = -max - 1;
+    if (point_size == sizeof(rt_int16_t))
+        ((rt_int16_t *)points)[i] = (rt_int16_t)v;
+    else
+        ((rt_int32_t *)points)[i] = (rt_int32_t)v;
+}
+
+int fal_tsl_resample(struct fal_tsl *tsl, rt_uint32_t from, rt_uint32_t to, rt_uint8_t field,
+                     void *points, rt_size_t point_size, rt_uint16_t cnt)
+{
+    rt_uint64_t span = (rt_uint64_t)to - from + 1;
+    struct fal_tsl_sample s;
+    struct fal_tsl_iter iter;
+    rt_int64_t sum = 0;
+    rt_uint32_t n = 0, samples = 0;
+    rt_uint16_t i, bucket = 0;
+
+    if (field >= tsl->fields || cnt == 0 || to < from)
+        return 0;
+
+    for (i = 0; i < cnt; i++)
+    {
+        if (point_size == sizeof(rt_int16_t))
+            ((rt_int16_t *)points)[i] = 0x7FFF;
+        else
+            ((rt_int32_t *)points)[i] = 0x7FFFFFFF;
+    }
+
+    /* the samples come in time order, a part is complete when the next one starts */
+    fal_tsl_iter_init(tsl, &iter, from, to);
+    while (fal_tsl_iter_next(&iter, &s) == RT_EOK)
+    {
+        i = (rt_uint16_t)((rt_uint64_t)(s.time - from) * cnt / span);
+        if (n > 0 && i != bucket)
+        {
+            point_put(points, point_size, bucket, sum / n);
+            sum = 0;
+            n = 0;
+        }
+        bucket = i;
+        sum += s.value[field];
+        n++;
+        samples++;
+    }
+    if (n > 0)
+        point_put(points, point_size, bucket, sum / n);
+    return samples;
+}
+
+void fal_tsl_get_stat(struct fal_tsl *tsl, struct fal_tsl_stat *stat)
+{
+    struct fal_tsl_seg *sg;
+    rt_uint32_t seq;
+
+    rt_mutex_take(&tsl->lock, RT_WAITING_FOREVER);
+    *stat = tsl->stat;
+    stat->samples = 0;
+    stat->segments = 0;
+    stat->used_bytes = 0;
+    stat->time_first = 0;
+    stat->time_last = 0;
+    if (!tsl->empty)
+    {
+        for (seq = tsl->head_seq; seq != tsl->cur_seq + 1; seq++)
+        {
+            sg = &tsl->segs[seg_of(tsl, seq)];
+            if (sg->count > 0 && stat->samples == 0)
+                stat->time_first = sg->time_min;
+            stat->samples += sg->count;
+            stat->segments++;
+            stat->used_bytes += sg->used - SEG_HDR_SIZE(tsl);
+        }
+        stat->time_last = tsl->last.time;
+    }
+    stat->raw_bytes = stat->samples * REC_SIZE(tsl, sizeof(rt_uint32_t) + tsl->fields * sizeof(rt_int32_t));
+    rt_mutex_release(&tsl->lock);
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark of the time-series log on a simulated NOR flash.
+ *
+ * The simulated flash keeps the data in RAM, a write can only clear bits and
+ * the erases and programs are delayed like a SPI NOR flash. The benchmark
+ * appends sensor-like samples until the log wraps around several times, with
+ * and without delta compression, and measures the append rate and the
+ * latency of short range queries against a scan from the oldest sample. Every
+ * sample read is checked, the chart resampling is checked against averages
+ * computed from the generator. The power failure test cuts the power during
+ * appends and checks that the log opens with the samples written before.
+ *
+ * msh: fal_tsl_bench
+ */
+
+#include <rtthread.h>
+#include <rthw.h>
+#include <fal_tsl.h>
+#include "fal_sim_flash.h"
+
+#define BENCH_FIELDS        3
+#define BENCH_SAMPLES       20000
+#define BENCH_STEP          10          /* time between the samples */
+#define BENCH_QUERIES       200
+#define BENCH_QUERY_SPAN    (60 * BENCH_STEP)
+#define BENCH_POINTS        100
+#define PF_SAMPLES          600
+#define PF_CUTS             40
+
+static rt_uint32_t seed;
+
+static rt_uint32_t bench_rand(void)
+{
+    seed = seed * 1103515245 + 12345;
+    return seed >> 8;
+}
+
+/* sample i: a temperature, a humidity and an event counter changing slowly */
+static rt_uint32_t gen_time(rt_uint32_t i)
+{
+    return i * BENCH_STEP + (i * 7) % 5;
+}
+
+static void gen_values(rt_uint32_t i, rt_int32_t *values)
+{
+    values[0] = 2500 + (rt_int32_t)((i * 37) % 61) - 30;
+    values[1] = 4000 + (rt_int32_t)(i % 100);
+    values[2] = i / 50;
+}
+
+static rt_bool_t sample_ok(const struct fal_tsl_sample *s)
+{
+    rt_int32_t values[BENCH_FIELDS];
+    rt_uint32_t i = s->time / BENCH_STEP;
+
+    gen_values(i, values);
+    return s->time == gen_time(i) && rt_memcmp(s->value, values, sizeof(values)) == 0;
+}
+
+static rt_uint32_t elapsed_us(rt_tick_t tick, rt_uint32_t n)
+{
+    return (rt_uint64_t)(rt_tick_get() - tick) * 1000000 / RT_TICK_PER_SECOND / n;
+}
+
+static rt_bool_t bench_append(struct fal_tsl *tsl, rt_uint8_t flags)
+{
+    rt_int32_t values[BENCH_FIELDS];
+    struct fal_tsl_stat stat;
+    rt_uint32_t i, ms, erases, min, max;
+    rt_tick_t tick;
+
+    erases = fal_sim_flash_erases(&min, &max);
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_SAMPLES; i++)
+    {
+        gen_values(i, values);
+        if (fal_tsl_append(tsl, gen_time(i), values) != RT_EOK)
+        {
+            rt_kprintf("append %d failed\n", i);
+            return RT_FALSE;
+        }
+    }
+    ms = (rt_tick_get() - tick) * 1000 / RT_TICK_PER_SECOND;
+
+    fal_tsl_get_stat(tsl, &stat);
+    rt_kprintf("%-6s append %5d samples %5d ms %6d samples/s, %2d.%d bytes/sample (raw %d), %3d erases, %5d kept\n",
+               flags & FAL_TSL_DELTA ? "delta" : "raw", BENCH_SAMPLES, ms, ms ? BENCH_SAMPLES * 1000 / ms : 0,
+               stat.used_bytes / stat.samples, stat.used_bytes * 10 / stat.samples % 10,
+               stat.raw_bytes / stat.samples, fal_sim_flash_erases(&min, &max) - erases, stat.samples);
+    return RT_TRUE;
+}
+
+/* short ranges through the segment index, and the same ranges scanned from the oldest sample */
+static rt_bool_t bench_query(struct fal_tsl *tsl, rt_uint8_t flags)
+{
+    struct fal_tsl_sample s;
+    struct fal_tsl_iter iter;
+    struct fal_tsl_stat stat;
+    rt_uint32_t q, n, exp, from, first, reads, errors = 0;
+    rt_uint32_t us[2], per_query[2];
+    rt_tick_t tick;
+    int scan;
+
+    fal_tsl_get_stat(tsl, &stat);
+    first = stat.time_first / BENCH_STEP + 1;
+    for (scan = 0; scan < 2; scan++)
+    {
+        seed = 1;
+        reads = tsl->stat.flash_reads;
+        tick = rt_tick_get();
+        for (q = 0; q < BENCH_QUERIES; q++)
+        {
+            from = (first + bench_rand() % (BENCH_SAMPLES - first - BENCH_QUERY_SPAN / BENCH_STEP)) * BENCH_STEP;
+            fal_tsl_iter_init(tsl, &iter, scan ? 0 : from, from + BENCH_QUERY_SPAN - 1);
+            n = 0;
+            while (fal_tsl_iter_next(&iter, &s) == RT_EOK)
+            {
+                if (s.time < from)
+                    continue;
+                if (!sample_ok(&s))
+                    errors++;
+                n++;
+            }
+            exp = BENCH_QUERY_SPAN / BENCH_STEP;
+            if (n != exp)
+                errors++;
+        }
+        us[scan] = elapsed_us(tick, BENCH_QUERIES);
+        per_query[scan] = (tsl->stat.flash_reads - reads) / BENCH_QUERIES;
+    }
+
+    rt_kprintf("%-6s query  %d samples: %5d us, %3d flash reads; scan: %6d us, %4d flash reads, %s\n",
+               flags & FAL_TSL_DELTA ? "delta" : "raw", BENCH_QUERY_SPAN / BENCH_STEP, us[0], per_query[0],
+               us[1], per_query[1], errors ? "FAIL" : "PASS");
+    return errors == 0;
+}
+
+/* the chart points of the whole log against the averages of the generator */
+static rt_bool_t bench_resample(struct fal_tsl *tsl)
+{
+    rt_int16_t points[BENCH_POINTS];
+    rt_int32_t values[BENCH_FIELDS];
+    struct fal_tsl_stat stat;
+    rt_uint32_t i, p, from, to, cnt[BENCH_POINTS];
+    rt_int64_t sum[BENCH_POINTS];
+    rt_uint32_t errors = 0, us;
+    rt_tick_t tick;
+    int n;
+
+    fal_tsl_get_stat(tsl, &stat);
+    from = stat.time_first;
+    to = stat.time_last;
+    tick = rt_tick_get();
+    n = fal_tsl_resample(tsl, from, to, 0, points, sizeof(rt_int16_t), BENCH_POINTS);
+    us = elapsed_us(tick, 1);
+
+    rt_memset(sum, 0, sizeof(sum));
+    rt_memset(cnt, 0, sizeof(cnt));
+    for (i = from / BENCH_STEP; i < BENCH_SAMPLES; i++)
+    {
+        p = (rt_uint64_t)(gen_time(i) - from) * BENCH_POINTS / ((rt_uint64_t)to - from + 1);
+        gen_values(i, values);
+        sum[p] += values[0];
+        cnt[p]++;
+    }
+    for (p = 0; p < BENCH_POINTS; p++)
+    {
+        if (points[p] != (cnt[p] ? sum[p] / cnt[p] : 0x7FFF))
+            errors++;
+    }
+
+    rt_kprintf("resample %d samples to %d points: %d us, %s\n", n, BENCH_POINTS, us,
+               errors || n != (int)stat.samples ? "FAIL" : "PASS");
+    return errors == 0;
+}
+
+/* the samples after a power failure are the samples appended before it, maybe the last one too */
+static rt_bool_t pf_check(struct fal_tsl *tsl, rt_uint32_t done)
+{
+    struct fal_tsl_sample s;
+    struct fal_tsl_iter iter;
+    rt_uint32_t n = 0;
+
+    fal_tsl_iter_init(tsl, &iter, 0, 0xFFFFFFFF);
+    while (fal_tsl_iter_next(&iter, &s) == RT_EOK)
+    {
+        if (s.time != gen_time(n) || !sample_ok(&s))
+            return RT_FALSE;
+        n++;
+    }
+    return n == done || n == done + 1;
+}
+
+static rt_bool_t bench_power_fail(struct fal_tsl *tsl)
+{
+    rt_int32_t values[BENCH_FIELDS];
+    rt_uint32_t cut, i, done;
+    rt_bool_t ok = RT_TRUE;
+
+    for (cut = 0; cut < PF_CUTS && ok; cut++)
+    {
+        fal_sim_flash_reset(FAL_SIM_SECTOR_SIZE);
+        if (fal_tsl_init_flash(tsl, &fal_sim_dev, 0, FAL_SIM_SECTOR_SIZE * 4, BENCH_FIELDS, FAL_TSL_DELTA) != RT_EOK)
+            return RT_FALSE;
+
+        /* spread the cuts over the appends, some of them are segment starts */
+        fal_sim.budget = cut * (PF_SAMPLES / PF_CUTS) + cut % 3;
+        for (done = 0; done < PF_SAMPLES; done++)
+        {
+            gen_values(done, values);
+            fal_tsl_append(tsl, gen_time(done), values);
+            if (fal_sim.cut)
+                break;
+        }
+        fal_tsl_deinit(tsl);
+
+        /* power on */
+        fal_sim.budget = -1;
+        fal_sim.cut = RT_FALSE;
+        if (fal_tsl_init_flash(tsl, &fal_sim_dev, 0, FAL_SIM_SECTOR_SIZE * 4, BENCH_FIELDS, FAL_TSL_DELTA) != RT_EOK)
+            return RT_FALSE;
+        ok = pf_check(tsl, done);
+        /* the log goes on after the recovery */
+        for (i = done + 1; ok && i < done + 1 + 400; i++)
+        {
+            gen_values(i, values);
+            ok = fal_tsl_append(tsl, gen_time(i), values) == RT_EOK;
+        }
+        if (!ok)
+            rt_kprintf("cut at sample %d: FAIL\n", done);
+        fal_tsl_deinit(tsl);
+    }
+
+    rt_kprintf("power fail %d cuts, %s\n", PF_CUTS, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+static int fal_tsl_bench(void)
+{
+    static struct fal_tsl tsl;
+    rt_uint8_t flags[] = { FAL_TSL_DELTA, 0 };
+    rt_uint32_t i;
+
+    if (fal_sim_flash_create() != RT_EOK)
+    {
+        rt_kprintf("no memory\n");
+        return 0;
+    }
+
+    for (i = 0; i < sizeof(flags); i++)
+    {
+        fal_sim_flash_reset(FAL_SIM_SECTOR_SIZE);
+        fal_sim.delay = RT_TRUE;
+        if (fal_tsl_init_flash(&tsl, &fal_sim_dev, 0, fal_sim.size, BENCH_FIELDS, flags[i]) != RT_EOK)
+            break;
+        if (bench_append(&tsl, flags[i]))
+        {
+            fal_sim.delay = RT_FALSE;
+            bench_query(&tsl, flags[i]);
+            if (flags[i] & FAL_TSL_DELTA)
+                bench_resample(&tsl);
+        }
+        fal_tsl_deinit(&tsl);
+    }
+
+    fal_sim.delay = RT_FALSE;
+    bench_power_fail(&tsl);
+
+    fal_sim_flash_delete();
+    return 0;
+}
+MSH_CMD_EXPORT(fal_tsl_bench, FAL time-series log benchmark on a simulated flash);
@@ -299,7 +299,7 @@ static void lwp_cleanup(struct rt_thread *tid)
     rt_lwp_mem_deinit(lwp);
 
     /* cleanup fd table */
-    rt_free(lwp->fdt.fds);
+    dfs_fdtable_free(&lwp->fdt);
     rt_free(lwp->args);
 
     dbg_log(DBG_LOG, "lwp free: %p\n", lwp);
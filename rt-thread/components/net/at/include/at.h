@@ -50,6 +50,11 @@ extern "C" {
 #define AT_CLIENT_NUM_MAX              1
 #endif
 
+/* the maximum size of one read from the AT client device */
+#ifndef AT_CLIENT_RX_BUFF_SIZE
+#define AT_CLIENT_RX_BUFF_SIZE         128
+#endif
+
 #define AT_CMD_EXPORT(_name_, _args_expr_, _test_, _query_, _setup_, _exec_)   \
     RT_USED static const struct at_cmd __at_cmd_##_test_##_query_##_setup_##_exec_ RT_SECTION("RtAtCmdTab") = \
     {                                                                          \
@@ -142,6 +147,7 @@ struct at_response
 typedef struct at_response *at_response_t;
 
 struct at_client;
+struct at_urc_trie;
 
 /* URC(Unsolicited Result Code) object, such as: 'RING', 'READY' request by AT server */
 struct at_urc
@@ -175,12 +181,21 @@ struct at_client
     rt_sem_t rx_notice;
     rt_mutex_t lock;
 
+    /* the data read from the device and not parsed yet */
+    char *rx_buf;
+    rt_size_t rx_len;
+    rt_size_t rx_pos;
+
     at_response_t resp;
     rt_sem_t resp_notice;
     at_resp_status_t resp_status;
 
     struct at_urc_table *urc_table;
     rt_size_t urc_table_size;
+    /* the URC prefixes of all the tables */
+    struct at_urc_trie *urc_trie;
+    /* changed with urc_trie, the parser checks it to restart the matching */
+    rt_uint32_t urc_trie_gen;
 
     rt_thread_t parser;
 };
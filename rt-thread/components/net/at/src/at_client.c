@@ -27,6 +27,43 @@
 #define AT_RESP_END_FAIL               "FAIL"
 #define AT_END_CR_LF                   "\r\n"
 
+#define AT_URC_NONE                    0xFFFF
+
+/* a node of the URC prefix trie, node 0 is the empty prefix */
+struct at_urc_node
+{
+    rt_uint16_t parent;
+    rt_uint16_t child;                 /* the first child, 0 for none */
+    rt_uint16_t sibling;               /* the next child of the parent, 0 for none */
+    rt_uint16_t chain;                 /* the first URC with the prefix of the node or a shorter one */
+    char ch;
+};
+
+struct at_urc_entry
+{
+    const struct at_urc *urc;
+    rt_uint16_t prefix_len;
+    rt_uint16_t suffix_len;
+    rt_uint16_t node;
+    rt_uint16_t next;                  /* the next URC of the chain */
+};
+
+struct at_urc_trie
+{
+    rt_uint16_t node_num;
+    struct at_urc_entry *entries;      /* in the order of the URC tables */
+    struct at_urc_node *nodes;
+};
+
+/* the URC matching of the line being received */
+struct at_urc_match
+{
+    struct at_urc_trie *trie;
+    rt_uint32_t trie_gen;              /* the urc_trie_gen of the client when the trie was taken */
+    rt_uint16_t node;                  /* the longest prefix that matches the line */
+    rt_bool_t end;                     /* no longer prefix matches the line */
+};
+
 static struct at_client at_client_table[AT_CLIENT_NUM_MAX] = { 0 };
 
 extern rt_size_t at_utils_send(rt_device_t dev,
@@ -456,8 +493,16 @@ static rt_err_t at_client_getchar(at_client_t client, char *ch, rt_int32_t timeo
 {
     rt_err_t result = RT_EOK;
 
-    while (rt_device_read(client->device, 0, ch, 1) == 0)
+    /* read all the received data at once, the next characters come from the buffer */
+    while (client->rx_pos >= client->rx_len)
     {
+        client->rx_pos = 0;
+        client->rx_len = rt_device_read(client->device, 0, client->rx_buf, AT_CLIENT_RX_BUFF_SIZE);
+        if (client->rx_len > 0)
+        {
+            break;
+        }
+
         result = rt_sem_take(client->rx_notice, rt_tick_from_millisecond(timeout));
         if (result != RT_EOK)
         {
@@ -467,6 +512,8 @@ static rt_err_t at_client_getchar(at_client_t client, char *ch, rt_int32_t timeo
         rt_sem_control(client->rx_notice, RT_IPC_CMD_RESET, RT_NULL);
     }
 
+    *ch = client->rx_buf[client->rx_pos++];
+
     return RT_EOK;
 }
 
@@ -495,7 +542,21 @@ rt_size_t at_client_obj_recv(at_client_t client, char *buf, rt_size_t size, rt_i
         return 0;
     }
 
-    while (1)
+    /* the data after the URC line may have been read from the device already */
+    if (client->rx_pos < client->rx_len)
+    {
+        len = client->rx_len - client->rx_pos;
+        if (len > size)
+        {
+            len = size;
+        }
+        rt_memcpy(buf, client->rx_buf + client->rx_pos, len);
+        client->rx_pos += len;
+        size -= len;
+    }
+
+    /* the rest is read from the device straight into the buffer */
+    while (size > 0)
     {
         rt_size_t read_len;
 
@@ -506,9 +567,6 @@ rt_size_t at_client_obj_recv(at_client_t client, char *buf, rt_size_t size, rt_i
         {
             len += read_len;
             size -= read_len;
-            if(size == 0)
-                break;
-
             continue;
         }
 
@@ -540,6 +598,135 @@ void at_obj_set_end_sign(at_client_t client, char ch)
     client->end_sign = ch;
 }
 
+/* build the prefix trie of the URC tables, the first URC of the tables wins like before */
+static struct at_urc_trie *at_urc_trie_create(const struct at_urc_table *tables, rt_size_t table_num)
+{
+    struct at_urc_trie *trie;
+    struct at_urc_node *nodes;
+    struct at_urc_entry *entry;
+    const struct at_urc *urc;
+    const char *prefix;
+    rt_size_t i, j, entry_num = 0, node_max = 1, idx = 0;
+    rt_uint16_t cur, child, tail;
+
+    for (i = 0; i < table_num; i++)
+    {
+        entry_num += tables[i].urc_size;
+        for (j = 0; j < tables[i].urc_size; j++)
+        {
+            node_max += rt_strlen(tables[i].urc[j].cmd_prefix);
+        }
+    }
+    if (entry_num >= AT_URC_NONE || node_max >= AT_URC_NONE)
+    {
+        return RT_NULL;
+    }
+
+    trie = (struct at_urc_trie *) rt_malloc(sizeof(struct at_urc_trie) +
+                                            entry_num * sizeof(struct at_urc_entry) + node_max * sizeof(struct at_urc_node));
+    if (trie == RT_NULL)
+    {
+        return RT_NULL;
+    }
+    trie->entries = (struct at_urc_entry *) (trie + 1);
+    trie->nodes = (struct at_urc_node *) (trie->entries + entry_num);
+    nodes = trie->nodes;
+
+    rt_memset(&nodes[0], 0x00, sizeof(struct at_urc_node));
+    nodes[0].chain = AT_URC_NONE;
+    trie->node_num = 1;
+
+    for (i = 0; i < table_num; i++)
+    {
+        for (j = 0; j < tables[i].urc_size; j++)
+        {
+            urc = &tables[i].urc[j];
+            entry = &trie->entries[idx++];
+            entry->urc = urc;
+            entry->prefix_len = rt_strlen(urc->cmd_prefix);
+            entry->suffix_len = rt_strlen(urc->cmd_suffix);
+
+            cur = 0;
+            for (prefix = urc->cmd_prefix; *prefix; prefix++)
+            {
+                for (child = nodes[cur].child; child && nodes[child].ch != *prefix; child = nodes[child].sibling);
+                if (child == 0)
+                {
+                    child = trie->node_num++;
+                    nodes[child].ch = *prefix;
+                    nodes[child].parent = cur;
+                    nodes[child].child = 0;
+                    nodes[child].sibling = nodes[cur].child;
+                    nodes[child].chain = AT_URC_NONE;
+                    nodes[cur].child = child;
+                }
+                cur = child;
+            }
+            entry->node = cur;
+        }
+    }
+
+    /* the URCs of every node in the order of the tables */
+    for (i = entry_num; i > 0; i--)
+    {
+        entry = &trie->entries[i - 1];
+        entry->next = nodes[entry->node].chain;
+        nodes[entry->node].chain = i - 1;
+    }
+
+    /* followed by the URCs of the parent, which is always created before its children */
+    for (i = 1; i < trie->node_num; i++)
+    {
+        if (nodes[i].chain == AT_URC_NONE)
+        {
+            nodes[i].chain = nodes[nodes[i].parent].chain;
+            continue;
+        }
+
+        for (tail = nodes[i].chain; trie->entries[tail].next != AT_URC_NONE; tail = trie->entries[tail].next);
+        trie->entries[tail].next = nodes[nodes[i].parent].chain;
+    }
+
+    return trie;
+}
+
+/* the URC of the first `len` characters of the line, one character after the last call */
+static const struct at_urc *at_urc_match_step(struct at_urc_match *match, const char *line, rt_size_t len)
+{
+    struct at_urc_trie *trie = match->trie;
+    const struct at_urc_entry *entry;
+    rt_uint16_t child, idx, found = AT_URC_NONE;
+    char ch = line[len - 1];
+
+    if (!match->end)
+    {
+        for (child = trie->nodes[match->node].child; child && trie->nodes[child].ch != ch;
+                child = trie->nodes[child].sibling);
+        if (child)
+        {
+            match->node = child;
+        }
+        else
+        {
+            match->end = RT_TRUE;
+        }
+    }
+
+    /* the prefixes of the chain match, check the suffixes */
+    for (idx = trie->nodes[match->node].chain; idx != AT_URC_NONE; idx = entry->next)
+    {
+        entry = &trie->entries[idx];
+        if (idx < found && len >= (rt_size_t) entry->prefix_len + entry->suffix_len &&
+                (entry->suffix_len == 0 || (entry->urc->cmd_suffix[entry->suffix_len - 1] == ch &&
+                 !rt_memcmp(line + len - entry->suffix_len, entry->urc->cmd_suffix, entry->suffix_len))))
+        {
+            found = idx;
+        }
+    }
+
+    return (found == AT_URC_NONE) ? RT_NULL : trie->entries[found].urc;
+}
+
 /**
  * set URC(Unsolicited Result Code) table
  *
@@ -549,6 +736,7 @@ void at_obj_set_end_sign(at_client_t client, char ch)
  */
 int at_obj_set_urc_table(at_client_t client, const struct at_urc *urc_table, rt_size_t table_sz)
 {
+    struct at_urc_trie *trie, *old_trie;
     rt_size_t idx;
 
     if (client == RT_NULL)
@@ -592,6 +780,30 @@ int at_obj_set_urc_table(at_client_t client, const struct at_urc *urc_table, rt_
 
     }
 
+    trie = at_urc_trie_create(client->urc_table, client->urc_table_size);
+    if (trie == RT_NULL)
+    {
+        client->urc_table_size--;
+        if (client->urc_table_size == 0)
+        {
+            rt_free(client->urc_table);
+            client->urc_table = RT_NULL;
+        }
+        return -RT_ENOMEM;
+    }
+
+    /* the parser matches the lines in a critical section */
+    rt_enter_critical();
+    old_trie = client->urc_trie;
+    client->urc_trie = trie;
+    client->urc_trie_gen++;
+    rt_exit_critical();
+
+    if (old_trie)
+    {
+        rt_free(old_trie);
+    }
+
     return RT_EOK;
 }
 
@@ -610,7 +822,8 @@ at_client_t at_client_get(const char *dev_name)
 
     for (idx = 0; idx < AT_CLIENT_NUM_MAX; idx++)
     {
-        if (rt_strcmp(at_client_table[idx].device->parent.name, dev_name) == 0)
+        if (at_client_table[idx].device &&
+                rt_strcmp(at_client_table[idx].device->parent.name, dev_name) == 0)
         {
             return &at_client_table[idx];
         }
@@ -634,63 +847,71 @@ at_client_t at_client_get_first(void)
     return &at_client_table[0];
 }
 
-static const struct at_urc *get_urc_obj(at_client_t client)
+/* the URC of the received line after its last character */
+static const struct at_urc *get_urc_obj(at_client_t client, struct at_urc_match *match)
 {
-    rt_size_t i, j, prefix_len, suffix_len;
-    rt_size_t bufsz;
-    char *buffer = RT_NULL;
     const struct at_urc *urc = RT_NULL;
-    struct at_urc_table *urc_table = RT_NULL;
-
-    if (client->urc_table == RT_NULL)
-    {
-        return RT_NULL;
-    }
-
-    buffer = client->recv_line_buf;
-    bufsz = client->recv_line_len;
+    rt_size_t len;
 
-    for (i = 0; i < client->urc_table_size; i++)
+    /* at_obj_set_urc_table() replaces the trie in a critical section */
+    rt_enter_critical();
+    /* the old trie is freed, a new one can get its address, compare the generations */
+    if (match->trie_gen != client->urc_trie_gen)
     {
-        for (j = 0; j < client->urc_table[i].urc_size; j++)
+        /* a new URC table, match the whole line again */
+        match->trie = client->urc_trie;
+        match->trie_gen = client->urc_trie_gen;
+        match->node = 0;
+        match->end = RT_FALSE;
+        for (len = 1; match->trie && len <= client->recv_line_len; len++)
         {
-            urc_table = client->urc_table + i;
-            urc = urc_table->urc + j;
-
-            prefix_len = rt_strlen(urc->cmd_prefix);
-            suffix_len = rt_strlen(urc->cmd_suffix);
-            if (bufsz < prefix_len + suffix_len)
-            {
-                continue;
-            }
-            if ((prefix_len ? !rt_strncmp(buffer, urc->cmd_prefix, prefix_len) : 1)
-                    && (suffix_len ? !rt_strncmp(buffer + bufsz - suffix_len, urc->cmd_suffix, suffix_len) : 1))
-            {
-                return urc;
-            }
+            urc = at_urc_match_step(match, client->recv_line_buf, len);
         }
     }
+    else if (match->trie)
+    {
+        urc = at_urc_match_step(match, client->recv_line_buf, client->recv_line_len);
+    }
+    rt_exit_critical();
 
-    return RT_NULL;
+    return urc;
 }
 
-static int at_recv_readline(at_client_t client)
+static int at_recv_readline(at_client_t client, const struct at_urc **urc)
 {
+    struct at_urc_match match;
     rt_size_t read_len = 0;
     char ch = 0, last_ch = 0;
     rt_bool_t is_full = RT_FALSE;
 
-    rt_memset(client->recv_line_buf, 0x00, client->recv_bufsz);
+    client->recv_line_buf[0] = '\0';
     client->recv_line_len = 0;
+    match.trie = RT_NULL;
+    match.trie_gen = 0;
+    *urc = RT_NULL;
 
     while (1)
     {
-        at_client_getchar(client, &ch, RT_WAITING_FOREVER);
+        if (client->rx_pos < client->rx_len)
+        {
+            ch = client->rx_buf[client->rx_pos++];
+        }
+        else
+        {
+            at_client_getchar(client, &ch, RT_WAITING_FOREVER);
+        }
 
         if (read_len < client->recv_bufsz)
         {
             client->recv_line_buf[read_len++] = ch;
             client->recv_line_len = read_len;
+            /* the handlers parse the line as a string */
+            if (read_len < client->recv_bufsz)
+            {
+                client->recv_line_buf[read_len] = '\0';
+            }
+
+            *urc = get_urc_obj(client, &match);
         }
         else
         {
@@ -699,13 +920,14 @@ static int at_recv_readline(at_client_t client)
 
         /* is newline or URC data */
         if ((ch == '\n' && last_ch == '\r') || (client->end_sign != 0 && ch == client->end_sign)
-                || get_urc_obj(client))
+                || *urc)
         {
             if (is_full)
             {
                 LOG_E("read line failed. The line data length is out of buffer size(%d)!", client->recv_bufsz);
                 rt_memset(client->recv_line_buf, 0x00, client->recv_bufsz);
                 client->recv_line_len = 0;
+                *urc = RT_NULL;
                 return -RT_EFULL;
             }
             break;
@@ -726,9 +948,9 @@ static void client_parser(at_client_t client)
 
     while(1)
     {
-        if (at_recv_readline(client) > 0)
+        if (at_recv_readline(client, &urc) > 0)
         {
-            if ((urc = get_urc_obj(client)) != RT_NULL)
+            if (urc != RT_NULL)
             {
                 /* current receive is request, try to execute related operations */
                 if (urc->func != RT_NULL)
@@ -834,6 +1056,16 @@ static int at_client_para_init(at_client_t client)
         goto __exit;
     }
 
+    client->rx_len = 0;
+    client->rx_pos = 0;
+    client->rx_buf = (char *) rt_malloc(AT_CLIENT_RX_BUFF_SIZE);
+    if (client->rx_buf == RT_NULL)
+    {
+        LOG_E("AT client initialize failed! No memory for device read buffer.");
+        result = -RT_ENOMEM;
+        goto __exit;
+    }
+
     rt_snprintf(name, RT_NAME_MAX, "%s%d", AT_CLIENT_LOCK_NAME, at_client_num);
     client->lock = rt_mutex_create(name, RT_IPC_FLAG_PRIO);
     if (client->lock == RT_NULL)
@@ -863,6 +1095,8 @@ static int at_client_para_init(at_client_t client)
 
     client->urc_table = RT_NULL;
     client->urc_table_size = 0;
+    client->urc_trie = RT_NULL;
+    client->urc_trie_gen = 0;
 
     rt_snprintf(name, RT_NAME_MAX, "%s%d", AT_CLIENT_THREAD_NAME, at_client_num);
     client->parser = rt_thread_create(name,
@@ -905,6 +1139,11 @@ __exit:
             rt_free(client->recv_line_buf);
         }
 
+        if (client->rx_buf)
+        {
+            rt_free(client->rx_buf);
+        }
+
         rt_memset(client, 0x00, sizeof(struct at_client));
     }
     else
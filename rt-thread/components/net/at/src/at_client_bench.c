@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Test and benchmark of the AT client parser.
+ *
+ * A simulated modem device takes the place of the serial device: the data
+ * it sends to the client is put in a ring buffer and announced like a DMA
+ * receive, every command line written to it is answered with OK. The test
+ * sends socket data as "+IPD,<len>:<payload>" frames with binary payloads,
+ * mixed with the lines of a table of common URCs, and checks that every URC
+ * is matched and that the handler receives every payload. The time of the
+ * whole stream and the time of a command and its response are printed.
+ *
+ * The simulated modem takes one of the AT_CLIENT_NUM_MAX clients, the
+ * client isn't deleted after the test.
+ *
+ * msh: at_client_bench [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <rthw.h>
+#include <rtdevice.h>
+#include <at.h>
+
+#define BENCH_DEVICE_NAME   "atsim"
+#define BENCH_RX_SIZE       2048
+#define BENCH_BLOCK_SIZE    512         /* the data announced at once */
+#define BENCH_LINE_SIZE     256
+#define BENCH_PAYLOAD_MAX   1460
+#define BENCH_FRAMES        2000
+#define BENCH_CMDS          100
+#define BENCH_TIMEOUT_MS    1000
+
+struct bench_modem
+{
+    struct rt_device parent;
+    struct rt_ringbuffer rx;            /* the data for the client */
+    rt_uint8_t rx_pool[BENCH_RX_SIZE];
+};
+
+struct bench_state
+{
+    rt_uint32_t frames;
+    rt_uint32_t bytes;
+    rt_uint32_t sum;
+    rt_uint32_t urcs;
+    rt_uint32_t errors;
+    rt_uint32_t frame_num;              /* the frames of the test */
+    rt_uint8_t payload[BENCH_PAYLOAD_MAX];
+    struct rt_completion done;
+};
+
+static struct bench_modem modem;
+static struct bench_state state;
+static at_client_t bench_client;
+
+static void bench_urc_line(struct at_client *client, const char *data, rt_size_t size);
+static void bench_urc_ipd(struct at_client *client, const char *data, rt_size_t size);
+
+/* the URCs of a cellular and a WiFi module */
+static const struct at_urc bench_urc_table[] =
+{
+    {"RING",            "\r\n",             bench_urc_line},
+    {"RDY",             "\r\n",             bench_urc_line},
+    {"NO CARRIER",      "\r\n",             bench_urc_line},
+    {"+CPIN:",          "\r\n",             bench_urc_line},
+    {"+CREG:",          "\r\n",             bench_urc_line},
+    {"+CGREG:",         "\r\n",             bench_urc_line},
+    {"+CEREG:",         "\r\n",             bench_urc_line},
+    {"+CMTI:",          "\r\n",             bench_urc_line},
+    {"+CLIP:",          "\r\n",             bench_urc_line},
+    {"+CSQ:",           "\r\n",             bench_urc_line},
+    {"+QIOPEN:",        "\r\n",             bench_urc_line},
+    {"+QIURC: \"closed\"", "\r\n",          bench_urc_line},
+    {"+QIURC: \"pdpdeact\"", "\r\n",        bench_urc_line},
+    {"+PDP DEACT",      "\r\n",             bench_urc_line},
+    {"SEND OK",         "\r\n",             bench_urc_line},
+    {"SEND FAIL",       "\r\n",             bench_urc_line},
+    {"WIFI CONNECTED",  "\r\n",             bench_urc_line},
+    {"WIFI DISCONNECT", "\r\n",             bench_urc_line},
+    {"",                ",CONNECT OK\r\n",  bench_urc_line},
+    {"",                ",CLOSED\r\n",      bench_urc_line},
+    {"+IPD",            ":",                bench_urc_ipd},
+};
+
+static const char *bench_lines[] =
+{
+    "+CSQ: 24,99\r\n",
+    "+CEREG: 1,\"4E2A\",\"0C8F4D02\",7\r\n",
+    "+QIURC: \"closed\",3\r\n",
+    "2,CONNECT OK\r\n",
+    "SEND OK\r\n",
+    "2,CLOSED\r\n",
+    "RING\r\n",
+    "+CMTI: \"SM\",12\r\n",
+};
+
+static rt_size_t bench_modem_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+    rt_base_t level;
+    rt_size_t len;
+
+    level = rt_hw_interrupt_disable();
+    len = rt_ringbuffer_get(&modem.rx, (rt_uint8_t *) buffer, size);
+    rt_hw_interrupt_enable(level);
+
+    return len;
+}
+
+static rt_size_t bench_modem_put(const void *data, rt_size_t size)
+{
+    rt_base_t level;
+    rt_size_t len;
+
+    /* the parser has a higher priority and reads the data at once */
+    while (rt_ringbuffer_space_len(&modem.rx) < size)
+    {
+        rt_thread_mdelay(1);
+    }
+
+    level = rt_hw_interrupt_disable();
+    len = rt_ringbuffer_put(&modem.rx, (const rt_uint8_t *) data, size);
+    rt_hw_interrupt_enable(level);
+
+    if (modem.parent.rx_indicate)
+    {
+        modem.parent.rx_indicate(&modem.parent, len);
+    }
+
+    return len;
+}
+
+static rt_size_t bench_modem_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+    const char *data = (const char *) buffer;
+    rt_size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        if (data[i] == '\n')
+        {
+            bench_modem_put("OK\r\n", 4);
+        }
+    }
+
+    return size;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops bench_modem_ops =
+{
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    bench_modem_read,
+    bench_modem_write,
+    RT_NULL,
+};
+#endif
+
+static rt_err_t bench_modem_register(void)
+{
+    rt_ringbuffer_init(&modem.rx, modem.rx_pool, BENCH_RX_SIZE);
+
+    modem.parent.type = RT_Device_Class_Char;
+    modem.parent.rx_indicate = RT_NULL;
+    modem.parent.tx_complete = RT_NULL;
+
+#ifdef RT_USING_DEVICE_OPS
+    modem.parent.ops         = &bench_modem_ops;
+#else
+    modem.parent.init        = RT_NULL;
+    modem.parent.open        = RT_NULL;
+    modem.parent.close       = RT_NULL;
+    modem.parent.read        = bench_modem_read;
+    modem.parent.write       = bench_modem_write;
+    modem.parent.control     = RT_NULL;
+#endif
+
+    return rt_device_register(&modem.parent, BENCH_DEVICE_NAME, RT_DEVICE_FLAG_RDWR);
+}
+
+static void bench_urc_line(struct at_client *client, const char *data, rt_size_t size)
+{
+    state.urcs++;
+}
+
+static void bench_urc_ipd(struct at_client *client, const char *data, rt_size_t size)
+{
+    rt_size_t i;
+    int len;
+
+    if (sscanf(data, "+IPD,%d:", &len) != 1 || len <= 0 || len > BENCH_PAYLOAD_MAX)
+    {
+        state.errors++;
+        return;
+    }
+
+    /* a socket driver receives the payload straight into the socket packet */
+    if (at_client_obj_recv(client, (char *) state.payload, len, BENCH_TIMEOUT_MS) != (rt_size_t) len)
+    {
+        state.errors++;
+        return;
+    }
+
+    for (i = 0; i < (rt_size_t) len; i++)
+    {
+        state.sum += state.payload[i];
+    }
+    state.bytes += len;
+    state.frames++;
+    if (state.frames == state.frame_num)
+    {
+        rt_completion_done(&state.done);
+    }
+}
+
+/* the stream of the test, sent in blocks, the expected results in `bytes`, `sum` and `urcs` */
+static rt_uint32_t bench_feed(rt_uint32_t frame_num, rt_uint32_t *bytes, rt_uint32_t *sum, rt_uint32_t *urcs)
+{
+    static char block[BENCH_BLOCK_SIZE + BENCH_LINE_SIZE + BENCH_PAYLOAD_MAX];
+    rt_size_t fill = 0, len, i, sent = 0;
+    rt_uint32_t frame;
+    const char *line;
+    char *p;
+
+    for (frame = 0; frame < frame_num; frame++)
+    {
+        if (frame % 4 == 0)
+        {
+            line = bench_lines[frame / 4 % (sizeof(bench_lines) / sizeof(bench_lines[0]))];
+            len = rt_strlen(line);
+            rt_memcpy(block + fill, line, len);
+            fill += len;
+            (*urcs)++;
+        }
+
+        /* binary payloads, with line ends and URC prefixes in them */
+        len = frame * 97 % BENCH_PAYLOAD_MAX + 1;
+        fill += rt_snprintf(block + fill, BENCH_LINE_SIZE, "+IPD,%d:", (int) len);
+        p = block + fill;
+        for (i = 0; i < len; i++)
+        {
+            p[i] = (frame % 8 == 1 && i < 6) ? "\r\nRING"[i] : (char) ((frame + i) * 31);
+            *sum += (rt_uint8_t) p[i];
+        }
+        fill += len;
+        *bytes += len;
+
+        if (fill >= BENCH_BLOCK_SIZE || frame == frame_num - 1)
+        {
+            /* the ring buffer takes at most a block at once */
+            for (i = 0; i < fill; i += len)
+            {
+                len = (fill - i > BENCH_BLOCK_SIZE) ? BENCH_BLOCK_SIZE : fill - i;
+                bench_modem_put(block + i, len);
+            }
+            sent += fill;
+            fill = 0;
+        }
+    }
+
+    return sent;
+}
+
+static void bench_print(const char *name, rt_uint32_t bytes, rt_tick_t tick)
+{
+    rt_uint32_t us = tick * (1000000 / RT_TICK_PER_SECOND);
+
+    if (us == 0)
+    {
+        us = 1;
+    }
+    rt_kprintf("%-24s %7u KB %4u.%02u MB/s\n", name, bytes / 1024,
+               (rt_uint32_t) ((rt_uint64_t) bytes * 100 / us / 100),
+               (rt_uint32_t) ((rt_uint64_t) bytes * 100 / us % 100));
+}
+
+static int at_client_bench(int argc, char **argv)
+{
+    at_response_t resp;
+    rt_uint32_t frame_num = BENCH_FRAMES, bytes = 0, sum = 0, urcs = 0, sent, i;
+    rt_tick_t tick;
+    rt_bool_t ok;
+
+    if (argc > 1)
+    {
+        frame_num = atoi(argv[1]);
+        if (frame_num == 0)
+        {
+            rt_kprintf("usage: at_client_bench [frames]\n");
+            return -1;
+        }
+    }
+
+    if (bench_client == RT_NULL)
+    {
+        if (rt_device_find(BENCH_DEVICE_NAME) == RT_NULL && bench_modem_register() != RT_EOK)
+        {
+            rt_kprintf("no simulated modem device\n");
+            return -1;
+        }
+        if (at_client_init(BENCH_DEVICE_NAME, BENCH_LINE_SIZE) != RT_EOK)
+        {
+            rt_kprintf("no AT client, raise AT_CLIENT_NUM_MAX\n");
+            return -1;
+        }
+        bench_client = at_client_get(BENCH_DEVICE_NAME);
+        if (at_obj_set_urc_table(bench_client, bench_urc_table,
+                                 sizeof(bench_urc_table) / sizeof(bench_urc_table[0])) != RT_EOK)
+        {
+            rt_kprintf("no memory\n");
+            bench_client = RT_NULL;
+            return -1;
+        }
+    }
+
+    rt_memset(&state, 0x00, sizeof(state));
+    state.frame_num = frame_num;
+    rt_completion_init(&state.done);
+
+    tick = rt_tick_get();
+    sent = bench_feed(frame_num, &bytes, &sum, &urcs);
+    ok = rt_completion_wait(&state.done, rt_tick_from_millisecond(BENCH_TIMEOUT_MS)) == RT_EOK;
+    tick = rt_tick_get() - tick;
+
+    bench_print("stream", sent, tick);
+    rt_kprintf("%u of %u frames, %u of %u URCs, %u errors\n", state.frames, frame_num, state.urcs, urcs, state.errors);
+    ok = ok && state.errors == 0 && state.bytes == bytes && state.sum == sum && state.urcs == urcs;
+
+    resp = at_create_resp(64, 0, rt_tick_from_millisecond(BENCH_TIMEOUT_MS));
+    if (resp == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        return -1;
+    }
+    tick = rt_tick_get();
+    for (i = 0; i < BENCH_CMDS; i++)
+    {
+        if (at_obj_exec_cmd(bench_client, resp, "AT") != RT_EOK)
+        {
+            ok = RT_FALSE;
+            break;
+        }
+    }
+    tick = rt_tick_get() - tick;
+    at_delete_resp(resp);
+    rt_kprintf("command and response: %u us\n", tick * (1000000 / RT_TICK_PER_SECOND) / BENCH_CMDS);
+
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(at_client_bench, AT client parser test and benchmark: at_client_bench [frames]);
@@ -63,6 +63,7 @@
 #include <lwip/dhcp.h>
 #include <lwip/netifapi.h>
 #include <lwip/inet.h>
+#include <lwip/ip.h>
 #include <netif/etharp.h>
 #include <netif/ethernetif.h>
 
@@ -81,6 +82,11 @@
 #define RT_ETHERNETIF_THREAD_PREORITY   RT_LWIP_ETHTHREAD_PRIORITY
 #endif
 
+#if defined(RT_LWIP_USING_ETH_NAPI) && !defined(LWIP_NO_TX_THREAD)
+/* the sender calls the driver, the Tx thread isn't needed */
+#define LWIP_NO_TX_THREAD
+#endif
+
 #ifndef LWIP_NO_TX_THREAD
 /**
  * Tx message structure for Ethernet interface
@@ -113,6 +119,22 @@ static char eth_rx_thread_stack[1024];
 static char eth_rx_thread_mb_pool[RT_LWIP_ETHTHREAD_MBOX_SIZE * sizeof(rt_ubase_t)];
 static char eth_rx_thread_stack[RT_LWIP_ETHTHREAD_STACKSIZE];
 #endif
+
+#ifdef RT_LWIP_USING_ETH_NAPI
+/**
+ * Frames received by the Rx thread in one pass, handed to the lwIP thread
+ * with one message
+ */
+struct eth_rx_batch
+{
+    struct netif    *netif;
+    struct pbuf     *frames[RT_LWIP_ETH_RX_BUDGET];
+    rt_uint16_t     num;
+    struct rt_completion done;
+};
+
+static struct eth_rx_batch eth_rx_batch;
+#endif
 #endif
 
 #ifdef RT_USING_NETDEV
@@ -447,11 +469,21 @@ static err_t ethernetif_linkoutput(struct netif *netif, struct pbuf *p)
     }
 #else
     struct eth_device* enetif;
+    rt_err_t result;
 
     RT_ASSERT(netif != RT_NULL);
     enetif = (struct eth_device*)netif->state;
 
-    if (enetif->eth_tx(&(enetif->parent), p) != RT_EOK)
+#ifdef RT_LWIP_USING_ETH_NAPI
+    /* the driver waits for its tx ring if it's full */
+    rt_mutex_take(&enetif->tx_lock, RT_WAITING_FOREVER);
+    result = enetif->eth_tx(&(enetif->parent), p);
+    rt_mutex_release(&enetif->tx_lock);
+#else
+    result = enetif->eth_tx(&(enetif->parent), p);
+#endif
+
+    if (result != RT_EOK)
     {
         return ERR_IF;
     }
@@ -563,6 +595,13 @@ rt_err_t eth_device_init_with_flag(struct eth_device *dev, const char *name, rt_
     dev->link_changed = 0x00;
     /* avoid send the same mail to mailbox */
     dev->rx_notice = 0x00;
+#ifdef RT_LWIP_USING_ETH_NAPI
+    if (dev->rx_budget == 0 || dev->rx_budget > RT_LWIP_ETH_RX_BUDGET)
+    {
+        dev->rx_budget = RT_LWIP_ETH_RX_BUDGET;
+    }
+    rt_mutex_init(&(dev->tx_lock), name, RT_IPC_FLAG_PRIO);
+#endif
     dev->parent.type = RT_Device_Class_NetIf;
     /* register to RT-Thread device manager */
     rt_device_register(&(dev->parent), name, RT_DEVICE_FLAG_RDWR);
@@ -640,10 +679,56 @@ void eth_device_deinit(struct eth_device *dev)
 #endif
     rt_device_close(&(dev->parent));
     rt_device_unregister(&(dev->parent));
+#ifdef RT_LWIP_USING_ETH_NAPI
+    rt_mutex_detach(&(dev->tx_lock));
+#endif
     rt_free(netif);
 }
 
 #ifndef LWIP_NO_RX_THREAD
+#ifdef RT_LWIP_USING_ETH_NAPI
+rt_err_t eth_device_ready(struct eth_device* dev)
+{
+    rt_base_t level;
+    rt_err_t result;
+
+    if (dev->netif == RT_NULL)
+    {
+        /* netif is not initialized yet, just return. */
+        return -RT_ERROR;
+    }
+
+    level = rt_hw_interrupt_disable();
+    if (dev->rx_notice)
+    {
+        /* the rx thread is receiving, it checks the device again before it's idle */
+        rt_hw_interrupt_enable(level);
+        return RT_EOK;
+    }
+    dev->rx_notice = RT_TRUE;
+    /* no more interrupts until the rx thread has received all frames */
+    if (dev->eth_rx_irq)
+    {
+        dev->eth_rx_irq(&(dev->parent), RT_FALSE);
+    }
+    rt_hw_interrupt_enable(level);
+
+    /* post message to Ethernet thread */
+    result = rt_mb_send(&eth_rx_thread_mb, (rt_ubase_t)dev);
+    if (result != RT_EOK)
+    {
+        level = rt_hw_interrupt_disable();
+        dev->rx_notice = RT_FALSE;
+        if (dev->eth_rx_irq)
+        {
+            dev->eth_rx_irq(&(dev->parent), RT_TRUE);
+        }
+        rt_hw_interrupt_enable(level);
+    }
+
+    return result;
+}
+#else
 rt_err_t eth_device_ready(struct eth_device* dev)
 {
     if (dev->netif)
@@ -660,6 +745,7 @@ rt_err_t eth_device_ready(struct eth_device* dev)
     else
         return -RT_ERROR; /* netif is not initialized yet, just return. */
 }
+#endif /* RT_LWIP_USING_ETH_NAPI */
 
 rt_err_t eth_device_linkchange(struct eth_device* dev, rt_bool_t up)
 {
@@ -724,6 +810,144 @@ static void eth_tx_thread_entry(void* parameter)
 #endif
 
 #ifndef LWIP_NO_RX_THREAD
+#ifdef RT_LWIP_USING_ETH_NAPI
+/* input the frames of a batch in the lwIP thread, like tcpip_input() does */
+static void eth_rx_batch_input(void *ctx)
+{
+    struct eth_rx_batch *batch = (struct eth_rx_batch *)ctx;
+    struct netif *netif = batch->netif;
+    struct pbuf *p;
+    err_t err;
+    int i;
+
+    for (i = 0; i < batch->num; i++)
+    {
+        p = batch->frames[i];
+#if LWIP_ETHERNET
+        if (netif->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET))
+        {
+            err = ethernet_input(p, netif);
+        }
+        else
+#endif /* LWIP_ETHERNET */
+        {
+            err = ip_input(p, netif);
+        }
+
+        if (err != ERR_OK)
+        {
+            LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: Input error\n"));
+            pbuf_free(p);
+        }
+    }
+
+    rt_completion_done(&batch->done);
+}
+
+static void eth_rx_batch_flush(struct eth_rx_batch *batch)
+{
+    struct netif *netif = batch->netif;
+    int i;
+
+    if (batch->num == 0)
+    {
+        return;
+    }
+
+    /* one message to the lwIP thread for the batch instead of one per frame */
+    if (batch->num > 1 && netif->input == tcpip_input)
+    {
+        rt_completion_init(&batch->done);
+        if (tcpip_callback(eth_rx_batch_input, batch) == ERR_OK)
+        {
+            rt_completion_wait(&batch->done, RT_WAITING_FOREVER);
+            batch->num = 0;
+            return;
+        }
+    }
+
+    for (i = 0; i < batch->num; i++)
+    {
+        if (netif->input(batch->frames[i], netif) != ERR_OK)
+        {
+            LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: Input error\n"));
+            pbuf_free(batch->frames[i]);
+        }
+    }
+    batch->num = 0;
+}
+
+/*
+ * Receive up to rx_budget frames of the device. The rx interrupt stays masked
+ * and 'rx_notice' set while there are frames, the device is posted again if
+ * the budget is used up, so the other devices get their turn. The device is
+ * checked once more after the interrupt is unmasked, a frame received before
+ * that would not raise it.
+ */
+static void eth_rx_poll(struct eth_device* device)
+{
+    struct eth_rx_batch *batch = &eth_rx_batch;
+    rt_base_t level;
+    struct pbuf *p;
+
+    batch->netif = device->netif;
+    batch->num = 0;
+
+    while (1)
+    {
+        while (batch->num < device->rx_budget)
+        {
+            p = device->eth_rx(&(device->parent));
+            if (p == RT_NULL)
+            {
+                break;
+            }
+            batch->frames[batch->num++] = p;
+        }
+
+        if (batch->num == device->rx_budget)
+        {
+            eth_rx_batch_flush(batch);
+            if (rt_mb_send(&eth_rx_thread_mb, (rt_ubase_t)device) == RT_EOK)
+            {
+                return;
+            }
+            /* the mailbox is full, go on with this device */
+            continue;
+        }
+
+        level = rt_hw_interrupt_disable();
+        /* 'rx_notice' will be modify in the interrupt or here */
+        device->rx_notice = RT_FALSE;
+        if (device->eth_rx_irq)
+        {
+            device->eth_rx_irq(&(device->parent), RT_TRUE);
+        }
+        rt_hw_interrupt_enable(level);
+
+        p = device->eth_rx(&(device->parent));
+        if (p == RT_NULL)
+        {
+            break;
+        }
+
+        level = rt_hw_interrupt_disable();
+        if (device->rx_notice == RT_FALSE)
+        {
+            device->rx_notice = RT_TRUE;
+            if (device->eth_rx_irq)
+            {
+                device->eth_rx_irq(&(device->parent), RT_FALSE);
+            }
+        }
+        rt_hw_interrupt_enable(level);
+        batch->frames[batch->num++] = p;
+    }
+
+    eth_rx_batch_flush(batch);
+}
+#endif /* RT_LWIP_USING_ETH_NAPI */
+
 /* Ethernet Rx Thread */
 static void eth_rx_thread_entry(void* parameter)
 {
@@ -753,6 +977,14 @@ static void eth_rx_thread_entry(void* parameter)
                     netifapi_netif_set_link_down(device->netif);
             }
 
+#ifdef RT_LWIP_USING_ETH_NAPI
+            if (device->eth_rx != RT_NULL && device->rx_notice)
+            {
+                eth_rx_poll(device);
+            }
+            continue;
+#endif /* RT_LWIP_USING_ETH_NAPI */
+
             level = rt_hw_interrupt_disable();
             /* 'rx_notice' will be modify in the interrupt or here */
             device->rx_notice = RT_FALSE;
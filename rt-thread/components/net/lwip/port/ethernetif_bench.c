@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark of the batched receive and the direct transmit of ethernetif.
+ *
+ * A simulated device is registered as an lwIP interface. Its MAC is a thread
+ * with a higher priority than the Rx thread, which puts frames into a ring as
+ * fast as the ring has room and raises the "interrupt" when it isn't masked.
+ * The frames have a type lwIP doesn't know, so the lwIP thread frees them.
+ * The frames are received with the configured budget and with a budget of one
+ * frame and the interrupt never masked, like the Rx thread without batches.
+ * The frames are sent by the caller and by a thread the caller waits for,
+ * like the Tx thread. Every run prints the frames per second, the interrupts
+ * and the context switches per frame, and checks that no frame was lost.
+ *
+ * msh: eth_napi_bench [frames]
+ */
+
+#include <stdlib.h>
+#include <rtthread.h>
+#include <rthw.h>
+#include <ipc/completion.h>
+
+#include <lwip/pbuf.h>
+#include <lwip/netif.h>
+#include <netif/ethernetif.h>
+
+#ifdef RT_LWIP_USING_ETH_BENCH
+
+#define SIM_RX_RING         32
+#define SIM_RX_WAKE         (SIM_RX_RING / 4)   /* free ring entries the MAC waits for */
+#define SIM_FRAME_SIZE      60
+#define SIM_ETH_TYPE        0x88B5              /* local experimental, dropped by lwIP */
+#define BENCH_FRAMES        20000
+
+struct sim_mac
+{
+    struct pbuf *ring[SIM_RX_RING];
+    rt_uint16_t head;
+    rt_uint16_t tail;
+    rt_uint16_t count;
+    rt_bool_t irq_masked;
+    rt_bool_t full;
+    struct rt_semaphore space;
+    struct rt_completion done;
+    rt_uint32_t frames;
+
+    rt_uint32_t irqs;
+    rt_uint32_t rx_frames;
+    rt_uint32_t tx_frames;
+};
+
+static struct sim_mac sim;
+static struct eth_device bench_dev;
+static volatile rt_uint32_t switches;
+
+static void bench_switch_hook(rt_thread_t from, rt_thread_t to)
+{
+    switches++;
+}
+
+static struct pbuf *sim_rx(rt_device_t dev)
+{
+    struct pbuf *p = RT_NULL;
+    rt_bool_t wake = RT_FALSE;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (sim.count > 0)
+    {
+        p = sim.ring[sim.tail];
+        sim.tail = (sim.tail + 1) % SIM_RX_RING;
+        sim.count--;
+        sim.rx_frames++;
+        if (sim.full && sim.count <= SIM_RX_RING - SIM_RX_WAKE)
+        {
+            sim.full = RT_FALSE;
+            wake = RT_TRUE;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (wake)
+    {
+        rt_sem_release(&sim.space);
+    }
+    return p;
+}
+
+static rt_err_t sim_tx(rt_device_t dev, struct pbuf *p)
+{
+    sim.tx_frames++;
+    return RT_EOK;
+}
+
+/* a frame received while the interrupt is masked raises nothing when it's unmasked */
+static void sim_rx_irq(rt_device_t dev, rt_bool_t enable)
+{
+    sim.irq_masked = !enable;
+}
+
+static rt_err_t sim_control(rt_device_t dev, int cmd, void *args)
+{
+    static const rt_uint8_t mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+
+    if (cmd == NIOCTL_GADDR && args != RT_NULL)
+    {
+        rt_memcpy(args, mac, sizeof(mac));
+        return RT_EOK;
+    }
+    return -RT_ERROR;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops sim_ops =
+{
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    sim_control
+};
+#endif
+
+static struct pbuf *sim_frame(void)
+{
+    struct pbuf *p;
+    rt_uint8_t *data;
+
+    p = pbuf_alloc(PBUF_RAW, SIM_FRAME_SIZE, PBUF_RAM);
+    if (p == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    data = (rt_uint8_t *)p->payload;
+    rt_memset(data, 0xFF, 6);
+    sim_control(RT_NULL, NIOCTL_GADDR, data + 6);
+    data[12] = SIM_ETH_TYPE >> 8;
+    data[13] = SIM_ETH_TYPE & 0xFF;
+    rt_memset(data + 14, 0x5A, SIM_FRAME_SIZE - 14);
+    return p;
+}
+
+/* the MAC, puts the frames into the ring and raises the interrupt */
+static void sim_mac_entry(void *parameter)
+{
+    struct pbuf *p;
+    rt_bool_t irq;
+    rt_base_t level;
+    rt_uint32_t i;
+
+    for (i = 0; i < sim.frames; i++)
+    {
+        p = sim_frame();
+        if (p == RT_NULL)
+        {
+            rt_thread_mdelay(1);
+            i--;
+            continue;
+        }
+
+        level = rt_hw_interrupt_disable();
+        while (sim.count == SIM_RX_RING)
+        {
+            sim.full = RT_TRUE;
+            rt_hw_interrupt_enable(level);
+            rt_sem_take(&sim.space, RT_WAITING_FOREVER);
+            level = rt_hw_interrupt_disable();
+        }
+        sim.ring[sim.head] = p;
+        sim.head = (sim.head + 1) % SIM_RX_RING;
+        sim.count++;
+        irq = !sim.irq_masked;
+        if (irq)
+        {
+            sim.irqs++;
+        }
+        rt_hw_interrupt_enable(level);
+
+        if (irq)
+        {
+            eth_device_ready(&bench_dev);
+        }
+    }
+
+    rt_completion_done(&sim.done);
+}
+
+static rt_bool_t bench_idle(void)
+{
+    rt_bool_t idle;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    idle = sim.count == 0 && !bench_dev.rx_notice;
+    rt_hw_interrupt_enable(level);
+    return idle;
+}
+
+static void bench_print(const char *name, rt_uint32_t frames, rt_tick_t ticks,
+                        rt_uint32_t irqs, rt_uint32_t sw, rt_bool_t ok)
+{
+    rt_uint32_t rate;
+
+    if (ticks == 0)
+    {
+        ticks = 1;
+    }
+    rate = (rt_uint64_t)frames * RT_TICK_PER_SECOND / ticks;
+    rt_kprintf("%-20s %6d frames/s, %2d.%02d irqs/frame, %2d.%02d switches/frame, %s\n",
+               name, rate, irqs / frames, irqs * 100 / frames % 100,
+               sw / frames, sw * 100 / frames % 100, ok ? "PASS" : "FAIL");
+}
+
+static rt_bool_t bench_rx(const char *name, rt_uint32_t frames, rt_uint16_t budget, rt_bool_t mask)
+{
+    rt_thread_t mac;
+    rt_tick_t tick;
+    rt_uint32_t sw;
+    rt_bool_t ok;
+
+    bench_dev.rx_budget = budget;
+    bench_dev.eth_rx_irq = mask ? sim_rx_irq : RT_NULL;
+
+    sim.head = sim.tail = sim.count = 0;
+    sim.irq_masked = RT_FALSE;
+    sim.full = RT_FALSE;
+    sim.frames = frames;
+    sim.irqs = 0;
+    sim.rx_frames = 0;
+    rt_completion_init(&sim.done);
+
+    mac = rt_thread_create("bmac", sim_mac_entry, RT_NULL, 1024,
+                           RT_LWIP_ETHTHREAD_PRIORITY > 0 ? RT_LWIP_ETHTHREAD_PRIORITY - 1 : 0, 10);
+    if (mac == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        return RT_FALSE;
+    }
+
+    switches = 0;
+    tick = rt_tick_get();
+    rt_thread_startup(mac);
+    rt_completion_wait(&sim.done, RT_WAITING_FOREVER);
+    while (!bench_idle())
+    {
+        rt_thread_mdelay(1);
+    }
+    tick = rt_tick_get() - tick;
+    sw = switches;
+
+    ok = sim.rx_frames == frames && !sim.irq_masked;
+    bench_print(name, frames, tick, sim.irqs, sw, ok);
+    return ok;
+}
+
+struct bench_tx_msg
+{
+    struct pbuf *p;
+    struct rt_completion ack;
+};
+
+static struct rt_mailbox bench_tx_mb;
+static rt_ubase_t bench_tx_mb_pool[4];
+
+/* like the Tx thread of ethernetif without batches */
+static void bench_tx_entry(void *parameter)
+{
+    struct bench_tx_msg *msg;
+
+    while (rt_mb_recv(&bench_tx_mb, (rt_ubase_t *)&msg, RT_WAITING_FOREVER) == RT_EOK)
+    {
+        if (msg == RT_NULL)
+        {
+            break;
+        }
+        bench_dev.eth_tx(&(bench_dev.parent), msg->p);
+        rt_completion_done(&msg->ack);
+    }
+}
+
+static rt_bool_t bench_tx(const char *name, rt_uint32_t frames, rt_bool_t handoff)
+{
+    struct netif *netif = bench_dev.netif;
+    struct bench_tx_msg msg;
+    rt_thread_t thread = RT_NULL;
+    struct pbuf *p;
+    rt_tick_t tick;
+    rt_uint32_t i, sw, sent;
+    rt_bool_t ok = RT_TRUE;
+
+    p = sim_frame();
+    if (p == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        return RT_FALSE;
+    }
+
+    if (handoff)
+    {
+        rt_mb_init(&bench_tx_mb, "btxmb", bench_tx_mb_pool,
+                   sizeof(bench_tx_mb_pool) / sizeof(bench_tx_mb_pool[0]), RT_IPC_FLAG_FIFO);
+        thread = rt_thread_create("btx", bench_tx_entry, RT_NULL, 1024, RT_LWIP_ETHTHREAD_PRIORITY, 10);
+        if (thread == RT_NULL)
+        {
+            rt_mb_detach(&bench_tx_mb);
+            pbuf_free(p);
+            rt_kprintf("no memory\n");
+            return RT_FALSE;
+        }
+        rt_thread_startup(thread);
+    }
+
+    sent = sim.tx_frames;
+    switches = 0;
+    tick = rt_tick_get();
+    for (i = 0; i < frames; i++)
+    {
+        if (handoff)
+        {
+            msg.p = p;
+            rt_completion_init(&msg.ack);
+            rt_mb_send_wait(&bench_tx_mb, (rt_ubase_t)&msg, RT_WAITING_FOREVER);
+            rt_completion_wait(&msg.ack, RT_WAITING_FOREVER);
+        }
+        else if (netif->linkoutput(netif, p) != ERR_OK)
+        {
+            ok = RT_FALSE;
+        }
+    }
+    tick = rt_tick_get() - tick;
+    sw = switches;
+    sent = sim.tx_frames - sent;
+
+    if (handoff)
+    {
+        /* the thread exits on the empty message */
+        rt_mb_send_wait(&bench_tx_mb, 0, RT_WAITING_FOREVER);
+        while (rt_thread_find("btx") != RT_NULL)
+        {
+            rt_thread_mdelay(1);
+        }
+        rt_mb_detach(&bench_tx_mb);
+    }
+    pbuf_free(p);
+
+    /* DHCP of the interface may send frames too */
+    ok = ok && sent >= frames;
+    bench_print(name, frames, tick, 0, sw, ok);
+    return ok;
+}
+
+static int eth_napi_bench(int argc, char **argv)
+{
+    rt_uint32_t frames = BENCH_FRAMES;
+    rt_bool_t ok = RT_TRUE;
+
+    if (argc > 1)
+    {
+        frames = atoi(argv[1]);
+        if (frames == 0)
+        {
+            rt_kprintf("usage: eth_napi_bench [frames]\n");
+            return -1;
+        }
+    }
+
+    rt_sem_init(&sim.space, "bspace", 0, RT_IPC_FLAG_FIFO);
+    rt_memset(&bench_dev, 0, sizeof(bench_dev));
+#ifdef RT_USING_DEVICE_OPS
+    bench_dev.parent.ops = &sim_ops;
+#else
+    bench_dev.parent.control = sim_control;
+#endif
+    bench_dev.eth_rx = sim_rx;
+    bench_dev.eth_tx = sim_tx;
+    if (eth_device_init(&bench_dev, "eb") != RT_EOK || bench_dev.netif == RT_NULL)
+    {
+        rt_kprintf("eth_device_init failed\n");
+        rt_sem_detach(&sim.space);
+        return -1;
+    }
+
+    rt_scheduler_sethook(bench_switch_hook);
+    ok = bench_rx("rx batch", frames, RT_LWIP_ETH_RX_BUDGET, RT_TRUE) && ok;
+    ok = bench_rx("rx batch, no mask", frames, RT_LWIP_ETH_RX_BUDGET, RT_FALSE) && ok;
+    ok = bench_rx("rx frame by frame", frames, 1, RT_FALSE) && ok;
+    ok = bench_tx("tx in caller", frames, RT_FALSE) && ok;
+    ok = bench_tx("tx by thread", frames, RT_TRUE) && ok;
+    rt_scheduler_sethook(RT_NULL);
+
+    eth_device_deinit(&bench_dev);
+    rt_sem_detach(&sim.space);
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(eth_napi_bench, ethernetif batched receive benchmark: eth_napi_bench [frames]);
+
+#endif /* RT_LWIP_USING_ETH_BENCH */
@@ -352,6 +352,10 @@
 #define ETH_PAD_SIZE                RT_LWIP_ETH_PAD_SIZE
 #endif
 
+/* LWIP_SUPPORT_CUSTOM_PBUF: the Ethernet drivers hand their DMA buffers
+   to the stack as custom pbufs. */
+#define LWIP_SUPPORT_CUSTOM_PBUF    1
+
 #ifdef LWIP_USING_NAT
 #define IP_NAT                      1
 #else
@@ -45,6 +45,15 @@ struct eth_device
     /* eth device interface */
     struct pbuf* (*eth_rx)(rt_device_t dev);
     rt_err_t (*eth_tx)(rt_device_t dev, struct pbuf* p);
+
+#ifdef RT_LWIP_USING_ETH_NAPI
+    /* mask or unmask the rx interrupt, called with interrupts disabled, RT_NULL if not supported */
+    void (*eth_rx_irq)(rt_device_t dev, rt_bool_t enable);
+    /* frames received per wakeup of the rx thread */
+    rt_uint16_t rx_budget;
+    /* eth_tx is called by the sender under this lock */
+    struct rt_mutex tx_lock;
+#endif
 };
 
 int eth_system_device_init(void);
@@ -170,6 +170,246 @@ static void event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len
 }
 #endif /* SAL_USING_POSIX */
 
+#if defined(SAL_USING_ZBUF) && (LWIP_VERSION >= 0x20100ff)
+#define SAL_LWIP_USING_ZBUF
+
+#ifndef SAL_USING_POSIX
+#include <lwip/priv/sockets_priv.h>
+
+extern struct lwip_sock *lwip_tryget_socket(int s);
+#endif
+
+static void inet_zbuf_pbuf_release(struct sal_zbuf *buf)
+{
+    if (buf->priv)
+    {
+        pbuf_free((struct pbuf *) buf->priv);
+    }
+}
+
+static void inet_zbuf_netbuf_release(struct sal_zbuf *buf)
+{
+    netbuf_delete((struct netbuf *) buf->priv);
+}
+
+static const struct sal_socket_ops lwip_socket_ops;
+
+/* describe the pbufs of a chain with a zbuf of as many segments */
+static struct sal_zbuf *inet_zbuf_from_pbuf(struct pbuf *p)
+{
+    struct sal_zbuf *buf, *seg;
+    struct pbuf *q;
+    size_t num = 0;
+
+    for (q = p; q != NULL; q = q->next)
+    {
+        if (q->len > 0 || q == p)
+        {
+            num++;
+        }
+    }
+
+    buf = sal_zbuf_new(num, 0);
+    if (buf == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    for (q = p, seg = buf; q != NULL; q = q->next)
+    {
+        if (q->len > 0 || q == p)
+        {
+            seg->data = q->payload;
+            seg->len = q->len;
+            seg->tot_len = q->tot_len;
+            seg = seg->next;
+        }
+    }
+    buf->owner = &lwip_socket_ops;
+
+    return buf;
+}
+
+static int inet_recv_zc(int socket, struct sal_zbuf **buf, int flags)
+{
+    struct lwip_sock *sock;
+    struct sal_zbuf *zbuf;
+    u8_t apiflags = 0;
+    err_t err;
+
+    sock = lwip_tryget_socket(socket);
+    if (sock == NULL)
+    {
+        set_errno(EBADF);
+        return -1;
+    }
+
+    if (flags & MSG_DONTWAIT)
+    {
+        apiflags |= NETCONN_DONTBLOCK;
+    }
+
+    if (NETCONNTYPE_GROUP(netconn_type(sock->conn)) == NETCONN_TCP)
+    {
+        struct pbuf *p = sock->lastdata.pbuf;
+
+        /* the rest of a recv() comes first, lwip_recv_tcp() hasn't updated the window for it */
+        if (p == NULL)
+        {
+            err = netconn_recv_tcp_pbuf_flags(sock->conn, &p, apiflags | NETCONN_NOAUTORCVD);
+            if (err == ERR_CLSD)
+            {
+                return 0;
+            }
+            if (err != ERR_OK)
+            {
+                set_errno(err_to_errno(err));
+                return -1;
+            }
+            sock->lastdata.pbuf = p;
+        }
+
+        zbuf = inet_zbuf_from_pbuf(p);
+        if (zbuf == RT_NULL)
+        {
+            /* the data stays for the next receive */
+            set_errno(ENOMEM);
+            return -1;
+        }
+        sock->lastdata.pbuf = NULL;
+        zbuf->priv = p;
+        zbuf->release = inet_zbuf_pbuf_release;
+
+        netconn_tcp_recvd(sock->conn, p->tot_len);
+    }
+    else
+    {
+        struct netbuf *nbuf = sock->lastdata.netbuf;
+
+        if (nbuf == NULL)
+        {
+            err = netconn_recv_udp_raw_netbuf_flags(sock->conn, &nbuf, apiflags);
+            if (err != ERR_OK)
+            {
+                set_errno(err_to_errno(err));
+                return -1;
+            }
+            sock->lastdata.netbuf = nbuf;
+        }
+
+        zbuf = inet_zbuf_from_pbuf(nbuf->p);
+        if (zbuf == RT_NULL)
+        {
+            set_errno(ENOMEM);
+            return -1;
+        }
+        sock->lastdata.netbuf = NULL;
+        zbuf->priv = nbuf;
+        zbuf->release = inet_zbuf_netbuf_release;
+    }
+
+    *buf = zbuf;
+    return (int) zbuf->tot_len;
+}
+
+static struct sal_zbuf *inet_zbuf_alloc(int socket, size_t size)
+{
+    struct sal_zbuf *buf;
+    struct pbuf *p;
+
+    /* pbuf_alloc() fails when the headers don't fit either */
+    if (size > 0xFFFF)
+    {
+        return RT_NULL;
+    }
+
+    p = pbuf_alloc(PBUF_TRANSPORT, (u16_t) size, PBUF_RAM);
+    if (p == NULL)
+    {
+        return RT_NULL;
+    }
+
+    buf = inet_zbuf_from_pbuf(p);
+    if (buf == RT_NULL)
+    {
+        pbuf_free(p);
+        return RT_NULL;
+    }
+    buf->priv = p;
+    buf->release = inet_zbuf_pbuf_release;
+
+    return buf;
+}
+
+static int inet_send_zc(int socket, struct sal_zbuf *buf, int flags)
+{
+    struct lwip_sock *sock;
+    struct pbuf *p = (struct pbuf *) buf->priv;
+    u16_t len;
+    err_t err;
+
+    sock = lwip_tryget_socket(socket);
+    if (sock == NULL)
+    {
+        set_errno(EBADF);
+        return -1;
+    }
+
+    /* buffers of sal_zbuf_alloc() have one segment */
+    RT_ASSERT(buf->next == RT_NULL && buf->release == inet_zbuf_pbuf_release);
+    RT_ASSERT(buf->len <= p->tot_len);
+    len = (u16_t) buf->len;
+
+    if (NETCONNTYPE_GROUP(netconn_type(sock->conn)) == NETCONN_TCP)
+    {
+        u8_t write_flags = NETCONN_COPY;
+        size_t written = 0;
+
+        /* TCP keeps the data until it's acknowledged, lwIP queues it in its own segments */
+        if (flags & MSG_MORE)
+        {
+            write_flags |= NETCONN_MORE;
+        }
+        if (flags & MSG_DONTWAIT)
+        {
+            write_flags |= NETCONN_DONTBLOCK;
+        }
+        err = netconn_write_partly(sock->conn, p->payload, len, write_flags, &written);
+        if (err != ERR_OK)
+        {
+            set_errno(err_to_errno(err));
+            return -1;
+        }
+        return (int) written;
+    }
+    else
+    {
+        struct netbuf *nbuf;
+
+        nbuf = netbuf_new();
+        if (nbuf == NULL)
+        {
+            set_errno(ENOMEM);
+            return -1;
+        }
+
+        /* the netbuf takes the pbuf, the datagram is sent from the buffer it was written to */
+        pbuf_realloc(p, len);
+        nbuf->p = nbuf->ptr = p;
+        buf->priv = NULL;
+
+        err = netconn_send(sock->conn, nbuf);
+        netbuf_delete(nbuf);
+        if (err != ERR_OK)
+        {
+            set_errno(err_to_errno(err));
+            return -1;
+        }
+        return (int) len;
+    }
+}
+#endif /* SAL_USING_ZBUF && LWIP_VERSION >= 0x20100ff */
+
 static int inet_socket(int domain, int type, int protocol)
 {
 #ifdef SAL_USING_POSIX
@@ -303,6 +543,11 @@ static const struct sal_socket_ops lwip_socket_ops =
 #ifdef SAL_USING_POSIX
     inet_poll,
 #endif
+#ifdef SAL_LWIP_USING_ZBUF
+    inet_recv_zc,
+    inet_zbuf_alloc,
+    inet_send_zc,
+#endif
 };
 
 static const struct sal_netdb_ops lwip_netdb_ops =
@@ -16,6 +16,9 @@
 #ifdef SAL_USING_POSIX
 #include <dfs_file.h>
 #endif
+#ifdef SAL_USING_ZBUF
+#include <sal_zbuf.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -58,6 +61,9 @@ struct sal_socket
 #ifdef SAL_USING_TLS
     void *user_data_tls;               /* user-specific TLS data */
 #endif
+#ifdef SAL_USING_EPOLL
+    rt_list_t epoll_items;             /* epoll items of the socket */
+#endif
 };
 
 /* network interface socket opreations */
@@ -80,6 +86,12 @@ struct sal_socket_ops
 #ifdef SAL_USING_POSIX
     int (*poll)       (struct dfs_fd *file, struct rt_pollreq *req);
 #endif
+#ifdef SAL_USING_ZBUF
+    /* zero-copy API, RT_NULL if the stack copies the data, then SAL uses recvfrom and sendto */
+    int (*recv_zc)    (int s, struct sal_zbuf **buf, int flags);
+    struct sal_zbuf *(*zbuf_alloc)(int s, size_t size);
+    int (*send_zc)    (int s, struct sal_zbuf *buf, int flags);
+#endif
 };
 
 /* sal network database name resolving */
@@ -107,6 +119,16 @@ struct sal_socket *sal_get_socket(int sock);
 /* check SAL socket netweork interface device internet status */
 int sal_check_netdev_internet_up(struct netdev *netdev);
 
+#ifdef SAL_USING_ZBUF
+/* allocate a chain of `num` segments, with `size` bytes of data after it for the first one */
+struct sal_zbuf *sal_zbuf_new(size_t num, size_t size);
+#endif
+
+#ifdef SAL_USING_EPOLL
+/* remove a socket that is being closed from the epoll instances */
+void sal_epoll_socket_close(struct sal_socket *sock);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,9 @@
 
 #include <stddef.h>
 #include <arpa/inet.h>
+#ifdef SAL_USING_ZBUF
+#include <sal_zbuf.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -211,6 +214,13 @@ int sal_socket(int domain, int type, int protocol);
 int sal_closesocket(int socket);
 int sal_ioctlsocket(int socket, long cmd, void *arg);
 
+#ifdef SAL_USING_ZBUF
+int sal_recv_zc(int socket, struct sal_zbuf **buf, int flags);
+struct sal_zbuf *sal_zbuf_alloc(int socket, size_t size);
+int sal_send_zc(int socket, struct sal_zbuf *buf, int flags);
+void sal_zbuf_free(struct sal_zbuf *buf);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef SAL_ZBUF_H__
+#define SAL_ZBUF_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Buffer chain of the zero-copy socket API.
+ *
+ * A chain received by sal_recv_zc() points at the buffers of the protocol
+ * stack, its segments are read in place and the chain is given back with
+ * sal_zbuf_free(). A buffer from sal_zbuf_alloc() is filled in place and its
+ * ownership goes to sal_send_zc(). Only the first segment of a chain is freed,
+ * the other ones belong to it.
+ */
+struct sal_zbuf
+{
+    struct sal_zbuf *next;             /* next segment, NULL for the last one */
+    void *data;                        /* data of the segment */
+    size_t len;                        /* length of the segment */
+    size_t tot_len;                    /* length of this segment and the next ones */
+
+    /* used by the protocol stack that owns the data */
+    const void *owner;
+    void *priv;
+    void (*release)(struct sal_zbuf *buf);
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SAL_ZBUF_H__ */
@@ -41,6 +41,11 @@ int sendto(int s, const void *dataptr, size_t size, int flags,
 int socket(int domain, int type, int protocol);
 int closesocket(int s);
 int ioctlsocket(int s, long cmd, void *arg);
+#ifdef SAL_USING_ZBUF
+int recv_zc(int s, struct sal_zbuf **buf, int flags);
+struct sal_zbuf *zbuf_alloc(int s, size_t size);
+int send_zc(int s, struct sal_zbuf *buf, int flags);
+#endif
 #else
 #define accept(s, addr, addrlen)                           sal_accept(s, addr, addrlen)
 #define bind(s, name, namelen)                             sal_bind(s, name, namelen)
@@ -58,8 +63,17 @@ int ioctlsocket(int s, long cmd, void *arg);
 #define socket(domain, type, protocol)                     sal_socket(domain, type, protocol)
 #define closesocket(s)                                     sal_closesocket(s)
 #define ioctlsocket(s, cmd, arg)                           sal_ioctlsocket(s, cmd, arg)
+#ifdef SAL_USING_ZBUF
+#define recv_zc(s, buf, flags)                             sal_recv_zc(s, buf, flags)
+#define zbuf_alloc(s, size)                                sal_zbuf_alloc(s, size)
+#define send_zc(s, buf, flags)                             sal_send_zc(s, buf, flags)
+#endif
 #endif /* SAL_USING_POSIX */
 
+#ifdef SAL_USING_ZBUF
+#define zbuf_free(buf)                                     sal_zbuf_free(buf)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
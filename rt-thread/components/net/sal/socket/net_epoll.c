@@ -0,0 +1,553 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+#include <dfs.h>
+#include <dfs_file.h>
+#include <dfs_net.h>
+#include <sys/errno.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sal.h>
+
+/*
+ * An epoll instance keeps its sockets registered on their wait queues. The
+ * wake function of a socket puts it on the ready list of the instance, so
+ * epoll_wait() only polls the sockets that had events. A level-triggered
+ * socket stays on the ready list while it's ready.
+ */
+#define EPOLL_FLAGS          (EPOLLET | EPOLLONESHOT)
+
+struct epoll;
+
+struct epoll_item
+{
+    struct epoll *ep;
+    int fd;
+    struct epoll_event event;
+
+    rt_list_t ep_node;                 /* node of the items of the instance */
+    rt_list_t sock_node;               /* node of the epoll items of the socket */
+    rt_list_t ready_node;              /* node of the ready list, empty when not ready */
+
+    rt_pollreq_t req;
+    struct rt_wqueue_node wqn;         /* node in the wait queue of the socket */
+    rt_bool_t queued;
+    rt_bool_t disabled;                /* reported with EPOLLONESHOT */
+};
+
+struct epoll
+{
+    rt_list_t items;
+    rt_list_t ready_list;              /* protected by disabling the interrupts */
+    rt_wqueue_t wq;                    /* threads in epoll_wait() */
+};
+
+/* protects the items of the instances and of the sockets */
+static struct rt_mutex epoll_lock;
+
+static int epoll_item_wake(struct rt_wqueue_node *wait, void *key)
+{
+    struct epoll_item *item = rt_container_of(wait, struct epoll_item, wqn);
+    struct epoll *ep = item->ep;
+
+    /* called by rt_wqueue_wakeup() with the interrupts disabled */
+    if (item->disabled || (key && !((rt_ubase_t) key & wait->key)))
+    {
+        return -1;
+    }
+
+    if (rt_list_isempty(&item->ready_node))
+    {
+        rt_list_insert_before(&ep->ready_list, &item->ready_node);
+    }
+    rt_wqueue_wakeup(&ep->wq, key);
+
+    /* stay on the wait queue and let the other waiters of the socket be woken */
+    return -1;
+}
+
+static void epoll_item_queue(rt_wqueue_t *wq, rt_pollreq_t *req)
+{
+    struct epoll_item *item = rt_container_of(req, struct epoll_item, req);
+
+    item->wqn.polling_thread = RT_NULL;
+    item->wqn.wakeup = epoll_item_wake;
+    item->wqn.key = req->_key;
+    rt_list_init(&item->wqn.list);
+    rt_wqueue_add(wq, &item->wqn);
+    item->queued = RT_TRUE;
+}
+
+static rt_uint32_t epoll_item_key(const struct epoll_item *item)
+{
+    if (item->disabled)
+    {
+        return 0;
+    }
+    return (item->event.events & ~EPOLL_FLAGS) | EPOLLERR | EPOLLHUP;
+}
+
+/* the current events of the socket, the socket is registered if `req` has a queue function */
+static int epoll_item_poll(struct epoll_item *item, rt_pollreq_t *req)
+{
+    struct dfs_fd *d;
+    int mask;
+
+    d = fd_get(item->fd);
+    if (d == RT_NULL)
+    {
+        return -1;
+    }
+
+    req->_key = epoll_item_key(item);
+    mask = d->fops->poll(d, req);
+    fd_put(d);
+    if (mask < 0)
+    {
+        return mask;
+    }
+
+    return mask & epoll_item_key(item);
+}
+
+static void epoll_item_ready(struct epoll_item *item)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (rt_list_isempty(&item->ready_node))
+    {
+        rt_list_insert_before(&item->ep->ready_list, &item->ready_node);
+    }
+    rt_hw_interrupt_enable(level);
+
+    rt_wqueue_wakeup(&item->ep->wq, RT_NULL);
+}
+
+static void epoll_item_free(struct epoll_item *item)
+{
+    rt_base_t level;
+
+    if (item->queued)
+    {
+        rt_wqueue_remove(&item->wqn);
+    }
+
+    level = rt_hw_interrupt_disable();
+    rt_list_remove(&item->ready_node);
+    rt_hw_interrupt_enable(level);
+
+    rt_list_remove(&item->ep_node);
+    rt_list_remove(&item->sock_node);
+    rt_free(item);
+}
+
+static int epoll_close(struct dfs_fd *file)
+{
+    struct epoll *ep = (struct epoll *) file->data;
+    struct epoll_item *item;
+
+    rt_mutex_take(&epoll_lock, RT_WAITING_FOREVER);
+    while (!rt_list_isempty(&ep->items))
+    {
+        item = rt_list_first_entry(&ep->items, struct epoll_item, ep_node);
+        epoll_item_free(item);
+    }
+    rt_mutex_release(&epoll_lock);
+
+    rt_free(ep);
+    file->data = RT_NULL;
+
+    return 0;
+}
+
+static const struct dfs_file_ops _epoll_fops =
+{
+    NULL,    /* open     */
+    epoll_close,
+    NULL,    /* ioctl    */
+    NULL,    /* read     */
+    NULL,    /* write    */
+    NULL,
+    NULL,    /* lseek    */
+    NULL,    /* getdents */
+    NULL,    /* poll     */
+};
+
+static struct epoll *epoll_get(int epfd)
+{
+    struct dfs_fd *d;
+    struct epoll *ep = RT_NULL;
+
+    d = fd_get(epfd);
+    if (d == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    if (d->type == FT_USER && d->fops == &_epoll_fops)
+    {
+        ep = (struct epoll *) d->data;
+    }
+    fd_put(d);
+
+    return ep;
+}
+
+int epoll_create1(int flags)
+{
+    struct epoll *ep;
+    struct dfs_fd *d;
+    int fd;
+
+    ep = (struct epoll *) rt_calloc(1, sizeof(struct epoll));
+    if (ep == RT_NULL)
+    {
+        rt_set_errno(-ENOMEM);
+        return -1;
+    }
+    rt_list_init(&ep->items);
+    rt_list_init(&ep->ready_list);
+    rt_wqueue_init(&ep->wq);
+
+    fd = fd_new();
+    if (fd < 0)
+    {
+        rt_free(ep);
+        rt_set_errno(-ENOMEM);
+        return -1;
+    }
+    d = fd_get(fd);
+
+    d->type = FT_USER;
+    d->path = NULL;
+    d->fops = &_epoll_fops;
+    d->flags = O_RDONLY;
+    d->size = 0;
+    d->pos = 0;
+    d->data = (void *) ep;
+
+    fd_put(d);
+
+    return fd;
+}
+RTM_EXPORT(epoll_create1);
+
+int epoll_create(int size)
+{
+    if (size <= 0)
+    {
+        rt_set_errno(-EINVAL);
+        return -1;
+    }
+
+    return epoll_create1(0);
+}
+RTM_EXPORT(epoll_create);
+
+static struct epoll_item *epoll_item_find(struct epoll *ep, struct sal_socket *sock)
+{
+    struct epoll_item *item;
+
+    /* a socket is rarely in more than one instance */
+    rt_list_for_each_entry(item, &sock->epoll_items, sock_node)
+    {
+        if (item->ep == ep)
+        {
+            return item;
+        }
+    }
+
+    return RT_NULL;
+}
+
+static int epoll_add(struct epoll *ep, struct sal_socket *sock, int fd, const struct epoll_event *event)
+{
+    struct epoll_item *item;
+    int mask;
+
+    item = (struct epoll_item *) rt_calloc(1, sizeof(struct epoll_item));
+    if (item == RT_NULL)
+    {
+        return -ENOMEM;
+    }
+
+    item->ep = ep;
+    item->fd = fd;
+    item->event = *event;
+    rt_list_init(&item->ep_node);
+    rt_list_init(&item->sock_node);
+    rt_list_init(&item->ready_node);
+    item->req._proc = epoll_item_queue;
+
+    mask = epoll_item_poll(item, &item->req);
+    if (mask < 0 || !item->queued)
+    {
+        /* the stack of the socket has no wait queue */
+        if (item->queued)
+        {
+            rt_wqueue_remove(&item->wqn);
+        }
+        rt_free(item);
+        return -EPERM;
+    }
+
+    rt_list_insert_before(&ep->items, &item->ep_node);
+    rt_list_insert_before(&sock->epoll_items, &item->sock_node);
+    if (mask)
+    {
+        epoll_item_ready(item);
+    }
+
+    return 0;
+}
+
+static int epoll_mod(struct epoll_item *item, const struct epoll_event *event)
+{
+    rt_pollreq_t query = {RT_NULL, 0};
+    rt_base_t level;
+    int mask;
+
+    level = rt_hw_interrupt_disable();
+    item->event = *event;
+    item->disabled = RT_FALSE;
+    item->wqn.key = epoll_item_key(item);
+    rt_hw_interrupt_enable(level);
+
+    mask = epoll_item_poll(item, &query);
+    if (mask > 0)
+    {
+        epoll_item_ready(item);
+    }
+
+    return 0;
+}
+
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+    struct epoll *ep;
+    struct sal_socket *sock;
+    struct epoll_item *item;
+    int result = 0;
+
+    ep = epoll_get(epfd);
+    if (ep == RT_NULL)
+    {
+        rt_set_errno(-EBADF);
+        return -1;
+    }
+
+    /* sockets only, the close of other files isn't seen */
+    sock = sal_get_socket(dfs_net_getsocket(fd));
+    if (sock == RT_NULL)
+    {
+        rt_set_errno(-EPERM);
+        return -1;
+    }
+
+    if (op != EPOLL_CTL_DEL && event == RT_NULL)
+    {
+        rt_set_errno(-EFAULT);
+        return -1;
+    }
+
+    rt_mutex_take(&epoll_lock, RT_WAITING_FOREVER);
+    item = epoll_item_find(ep, sock);
+    switch (op)
+    {
+    case EPOLL_CTL_ADD:
+        result = item ? -EEXIST : epoll_add(ep, sock, fd, event);
+        break;
+    case EPOLL_CTL_MOD:
+        result = item ? epoll_mod(item, event) : -ENOENT;
+        break;
+    case EPOLL_CTL_DEL:
+        if (item)
+        {
+            epoll_item_free(item);
+        }
+        else
+        {
+            result = -ENOENT;
+        }
+        break;
+    default:
+        result = -EINVAL;
+        break;
+    }
+    rt_mutex_release(&epoll_lock);
+
+    if (result < 0)
+    {
+        rt_set_errno(result);
+        return -1;
+    }
+
+    return 0;
+}
+RTM_EXPORT(epoll_ctl);
+
+/* report up to `maxevents` sockets of the ready list */
+static int epoll_harvest(struct epoll *ep, struct epoll_event *events, int maxevents)
+{
+    rt_pollreq_t query = {RT_NULL, 0};
+    struct epoll_item *item;
+    rt_list_t ready;
+    rt_base_t level;
+    int mask, num = 0;
+
+    rt_list_init(&ready);
+
+    level = rt_hw_interrupt_disable();
+    if (!rt_list_isempty(&ep->ready_list))
+    {
+        /* take the whole list, the wake functions start a new one */
+        ready.next = ep->ready_list.next;
+        ready.prev = ep->ready_list.prev;
+        ready.next->prev = &ready;
+        ready.prev->next = &ready;
+        rt_list_init(&ep->ready_list);
+    }
+    rt_hw_interrupt_enable(level);
+
+    while (num < maxevents)
+    {
+        level = rt_hw_interrupt_disable();
+        if (rt_list_isempty(&ready))
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        item = rt_list_first_entry(&ready, struct epoll_item, ready_node);
+        rt_list_remove(&item->ready_node);
+        rt_hw_interrupt_enable(level);
+
+        /* the events may have been consumed since the socket was woken */
+        mask = epoll_item_poll(item, &query);
+        if (mask <= 0)
+        {
+            continue;
+        }
+
+        events[num].events = mask;
+        events[num].data = item->event.data;
+        num++;
+
+        if (item->event.events & EPOLLONESHOT)
+        {
+            /* nothing is reported until EPOLL_CTL_MOD */
+            level = rt_hw_interrupt_disable();
+            item->disabled = RT_TRUE;
+            item->wqn.key = 0;
+            rt_hw_interrupt_enable(level);
+        }
+        else if (!(item->event.events & EPOLLET))
+        {
+            /* level-triggered, polled again by the next call */
+            level = rt_hw_interrupt_disable();
+            if (rt_list_isempty(&item->ready_node))
+            {
+                rt_list_insert_before(&ep->ready_list, &item->ready_node);
+            }
+            rt_hw_interrupt_enable(level);
+        }
+    }
+
+    level = rt_hw_interrupt_disable();
+    while (!rt_list_isempty(&ready))
+    {
+        /* the sockets that didn't fit go first next time */
+        item = rt_list_entry(ready.prev, struct epoll_item, ready_node);
+        rt_list_remove(&item->ready_node);
+        rt_list_insert_after(&ep->ready_list, &item->ready_node);
+    }
+    rt_hw_interrupt_enable(level);
+
+    return num;
+}
+
+int epoll_wait(int epfd, struct epoll_event *events, int maxevents, int timeout)
+{
+    struct epoll *ep;
+    rt_tick_t start, elapsed, wait_tick = 0;
+    int num;
+
+    ep = epoll_get(epfd);
+    if (ep == RT_NULL)
+    {
+        rt_set_errno(-EBADF);
+        return -1;
+    }
+
+    if (events == RT_NULL || maxevents <= 0)
+    {
+        rt_set_errno(-EINVAL);
+        return -1;
+    }
+
+    if (timeout > 0)
+    {
+        wait_tick = rt_tick_from_millisecond(timeout);
+    }
+    start = rt_tick_get();
+
+    while (1)
+    {
+        rt_mutex_take(&epoll_lock, RT_WAITING_FOREVER);
+        num = epoll_harvest(ep, events, maxevents);
+        rt_mutex_release(&epoll_lock);
+
+        if (num > 0 || timeout == 0)
+        {
+            break;
+        }
+
+        if (timeout < 0)
+        {
+            rt_wqueue_wait(&ep->wq, 0, RT_WAITING_FOREVER);
+            continue;
+        }
+
+        elapsed = rt_tick_get() - start;
+        if (elapsed >= wait_tick)
+        {
+            break;
+        }
+
+        /* a wake up between the harvest and here is kept in the flag of the queue */
+        rt_wqueue_wait(&ep->wq, 0, (wait_tick - elapsed) * 1000 / RT_TICK_PER_SECOND + 1);
+    }
+
+    return num;
+}
+RTM_EXPORT(epoll_wait);
+
+void sal_epoll_socket_close(struct sal_socket *sock)
+{
+    struct epoll_item *item;
+
+    rt_mutex_take(&epoll_lock, RT_WAITING_FOREVER);
+    while (!rt_list_isempty(&sock->epoll_items))
+    {
+        item = rt_list_first_entry(&sock->epoll_items, struct epoll_item, sock_node);
+        epoll_item_free(item);
+    }
+    rt_mutex_release(&epoll_lock);
+}
+
+static int sal_epoll_init(void)
+{
+    rt_mutex_init(&epoll_lock, "sal_ep", RT_IPC_FLAG_PRIO);
+
+    return 0;
+}
+INIT_COMPONENT_EXPORT(sal_epoll_init);
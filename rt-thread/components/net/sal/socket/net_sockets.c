@@ -194,6 +194,32 @@ int sendto(int s, const void *dataptr, size_t size, int flags,
 }
 RTM_EXPORT(sendto);
 
+#ifdef SAL_USING_ZBUF
+int recv_zc(int s, struct sal_zbuf **buf, int flags)
+{
+    int socket = dfs_net_getsocket(s);
+
+    return sal_recv_zc(socket, buf, flags);
+}
+RTM_EXPORT(recv_zc);
+
+struct sal_zbuf *zbuf_alloc(int s, size_t size)
+{
+    int socket = dfs_net_getsocket(s);
+
+    return sal_zbuf_alloc(socket, size);
+}
+RTM_EXPORT(zbuf_alloc);
+
+int send_zc(int s, struct sal_zbuf *buf, int flags)
+{
+    int socket = dfs_net_getsocket(s);
+
+    return sal_send_zc(socket, buf, flags);
+}
+RTM_EXPORT(send_zc);
+#endif /* SAL_USING_ZBUF */
+
 int socket(int domain, int type, int protocol)
 {
     /* create a BSD socket */
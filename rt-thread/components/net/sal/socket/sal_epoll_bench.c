@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Test and benchmark of epoll for sockets.
+ *
+ * TCP connections are opened to the address of the default network
+ * interface, lwIP loops them back without the driver. The accepted sockets
+ * are added to an epoll instance, one byte is sent on some connections and
+ * the sockets reported by epoll_wait() are checked in the level-triggered,
+ * edge-triggered and one-shot modes, after EPOLL_CTL_DEL and after a close.
+ * A thread sends while epoll_wait() blocks to check the wake up. Then a few
+ * connections are made ready and the time of epoll_wait() and of poll() on
+ * all the sockets is printed. Every connection takes two sockets, raise
+ * DFS_FD_MAX, RT_MEMP_NUM_NETCONN and RT_LWIP_TCP_PCB_NUM for many of them.
+ *
+ * msh: sal_epoll_bench [connections], at least 10 connections
+ */
+
+#include <stdlib.h>
+#include <rtthread.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <netdev.h>
+
+#define BENCH_PORT          5040
+#define BENCH_CONNS         16
+#define BENCH_READY         4
+#define BENCH_LOOPS         1000
+#define BENCH_SETTLE_MS     20          /* time for lwIP to deliver the data */
+
+struct bench_conn
+{
+    int client;
+    int server;
+};
+
+static struct bench_conn *conns;
+static int conn_num;
+static int epfd = -1;
+
+static void bench_send(int idx)
+{
+    char c = (char) idx;
+
+    send(conns[idx].client, &c, 1, 0);
+}
+
+static void bench_drain(int idx)
+{
+    char buf[16];
+
+    while (recv(conns[idx].server, buf, sizeof(buf), MSG_DONTWAIT) > 0);
+}
+
+/* the number of reported sockets, -1 if one of them isn't in `expect` */
+static int bench_wait(const rt_uint8_t *expect, int timeout)
+{
+    struct epoll_event events[BENCH_CONNS];
+    int num, i;
+
+    num = epoll_wait(epfd, events, BENCH_CONNS, timeout);
+    for (i = 0; i < num; i++)
+    {
+        if (events[i].data.u32 >= (rt_uint32_t) conn_num || !expect[events[i].data.u32] ||
+                !(events[i].events & EPOLLIN))
+        {
+            return -1;
+        }
+    }
+
+    return num;
+}
+
+static rt_bool_t bench_mod(int idx, rt_uint32_t events)
+{
+    struct epoll_event event;
+
+    event.events = events;
+    event.data.u32 = idx;
+    return epoll_ctl(epfd, EPOLL_CTL_MOD, conns[idx].server, &event) == 0;
+}
+
+static void bench_late_send(void *parameter)
+{
+    rt_thread_mdelay(50);
+    bench_send((int) (rt_ubase_t) parameter);
+}
+
+static rt_bool_t bench_check(const char *name, rt_bool_t ok)
+{
+    rt_kprintf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static rt_bool_t bench_modes(void)
+{
+    rt_uint8_t *expect;
+    rt_thread_t thread;
+    rt_tick_t tick;
+    int i, ready = 0;
+    rt_bool_t ok = RT_TRUE;
+
+    expect = (rt_uint8_t *) rt_calloc(conn_num, 1);
+    if (expect == RT_NULL)
+    {
+        return RT_FALSE;
+    }
+
+    /* level-triggered: reported until it's read */
+    for (i = 0; i < conn_num; i += 3)
+    {
+        expect[i] = 1;
+        ready++;
+        bench_send(i);
+    }
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+    ok = bench_check("level-triggered", bench_wait(expect, 100) == RT_MIN(ready, BENCH_CONNS) &&
+                     bench_wait(expect, 0) == RT_MIN(ready, BENCH_CONNS)) && ok;
+    for (i = 0; i < conn_num; i += 3)
+    {
+        bench_drain(i);
+    }
+    ok = bench_check("level-triggered, read", bench_wait(expect, 0) == 0) && ok;
+
+    /* edge-triggered: reported once for every new data */
+    ok = bench_mod(0, EPOLLIN | EPOLLET) && ok;
+    bench_send(0);
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+    ok = bench_check("edge-triggered", bench_wait(expect, 100) == 1 && bench_wait(expect, 0) == 0) && ok;
+    bench_send(0);
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+    ok = bench_check("edge-triggered, new data", bench_wait(expect, 100) == 1) && ok;
+    bench_drain(0);
+
+    /* one-shot: reported once until it's modified */
+    ok = bench_mod(3, EPOLLIN | EPOLLONESHOT) && ok;
+    bench_send(3);
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+    ok = bench_check("one-shot", bench_wait(expect, 100) == 1) && ok;
+    bench_send(3);
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+    ok = bench_check("one-shot, disabled", bench_wait(expect, 0) == 0) && ok;
+    ok = bench_check("one-shot, modified", bench_mod(3, EPOLLIN | EPOLLONESHOT) && bench_wait(expect, 0) == 1) && ok;
+    bench_drain(3);
+    ok = bench_mod(0, EPOLLIN) && bench_mod(3, EPOLLIN) && ok;
+
+    /* blocking wait */
+    thread = rt_thread_create("epsend", bench_late_send, (void *) 0, 1024, RT_THREAD_PRIORITY_MAX / 2, 10);
+    if (thread)
+    {
+        rt_thread_startup(thread);
+        tick = rt_tick_get();
+        ok = bench_check("blocking wait", bench_wait(expect, 1000) == 1 &&
+                         rt_tick_get() - tick < rt_tick_from_millisecond(500)) && ok;
+        bench_drain(0);
+    }
+
+    /* removed and closed sockets aren't reported */
+    ok = epoll_ctl(epfd, EPOLL_CTL_DEL, conns[6].server, RT_NULL) == 0 && ok;
+    bench_send(6);
+    bench_send(9);
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+    closesocket(conns[9].server);
+    conns[9].server = -1;
+    ok = bench_check("deleted and closed", bench_wait(expect, 0) == 0) && ok;
+    ok = bench_check("deleted twice", epoll_ctl(epfd, EPOLL_CTL_DEL, conns[6].server, RT_NULL) < 0) && ok;
+    bench_drain(6);
+
+    rt_free(expect);
+    return ok;
+}
+
+static void bench_time(void)
+{
+    struct epoll_event events[BENCH_READY];
+    struct pollfd *fds;
+    rt_tick_t epoll_tick, poll_tick;
+    int i, num = 0, ready = 0;
+
+    fds = (struct pollfd *) rt_calloc(conn_num, sizeof(struct pollfd));
+    if (fds == RT_NULL)
+    {
+        return;
+    }
+    for (i = 0; i < conn_num; i++)
+    {
+        fds[i].fd = conns[i].server;
+        fds[i].events = (conns[i].server >= 0) ? POLLIN : 0;
+    }
+
+    for (i = conn_num - 1; i >= 0 && ready < BENCH_READY; i -= conn_num / BENCH_READY + 1)
+    {
+        if (conns[i].server >= 0)
+        {
+            bench_send(i);
+            ready++;
+        }
+    }
+    rt_thread_mdelay(BENCH_SETTLE_MS);
+
+    epoll_tick = rt_tick_get();
+    for (i = 0; i < BENCH_LOOPS; i++)
+    {
+        num = epoll_wait(epfd, events, BENCH_READY, 0);
+    }
+    epoll_tick = rt_tick_get() - epoll_tick;
+
+    poll_tick = rt_tick_get();
+    for (i = 0; i < BENCH_LOOPS; i++)
+    {
+        poll(fds, conn_num, 0);
+    }
+    poll_tick = rt_tick_get() - poll_tick;
+
+    rt_kprintf("%d connections, %d ready (%d reported)\n", conn_num, ready, num);
+    rt_kprintf("epoll_wait: %6u us per call\n", epoll_tick * (1000000 / RT_TICK_PER_SECOND) / BENCH_LOOPS);
+    rt_kprintf("poll:       %6u us per call\n", poll_tick * (1000000 / RT_TICK_PER_SECOND) / BENCH_LOOPS);
+
+    for (i = 0; i < conn_num; i++)
+    {
+        if (conns[i].server >= 0)
+        {
+            bench_drain(i);
+        }
+    }
+    rt_free(fds);
+}
+
+static void bench_close(int listener)
+{
+    int i;
+
+    for (i = 0; i < conn_num; i++)
+    {
+        if (conns[i].client >= 0)
+        {
+            closesocket(conns[i].client);
+        }
+        if (conns[i].server >= 0)
+        {
+            closesocket(conns[i].server);
+        }
+    }
+    if (listener >= 0)
+    {
+        closesocket(listener);
+    }
+    if (epfd >= 0)
+    {
+        close(epfd);
+        epfd = -1;
+    }
+    rt_free(conns);
+    conns = RT_NULL;
+}
+
+static int sal_epoll_bench(int argc, char **argv)
+{
+    struct sockaddr_in addr;
+    struct epoll_event event;
+    int listener = -1, nodelay = 1, i;
+    rt_bool_t ok = RT_FALSE;
+
+    conn_num = BENCH_CONNS;
+    if (argc > 1)
+    {
+        conn_num = atoi(argv[1]);
+        if (conn_num < 10)
+        {
+            rt_kprintf("usage: sal_epoll_bench [connections >= 10]\n");
+            return -1;
+        }
+    }
+
+    if (netdev_default == RT_NULL || !netdev_is_up(netdev_default))
+    {
+        rt_kprintf("no network interface\n");
+        return -1;
+    }
+
+    conns = (struct bench_conn *) rt_malloc(conn_num * sizeof(struct bench_conn));
+    if (conns == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        return -1;
+    }
+    for (i = 0; i < conn_num; i++)
+    {
+        conns[i].client = conns[i].server = -1;
+    }
+
+    rt_memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+#if NETDEV_IPV4 && NETDEV_IPV6
+    addr.sin_addr.s_addr = netdev_default->ip_addr.u_addr.ip4.addr;
+#else
+    addr.sin_addr.s_addr = netdev_default->ip_addr.addr;
+#endif
+
+    epfd = epoll_create(conn_num);
+    listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (epfd < 0 || listener < 0 || bind(listener, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+            listen(listener, 4) < 0)
+    {
+        rt_kprintf("no listening socket\n");
+        goto __exit;
+    }
+
+    for (i = 0; i < conn_num; i++)
+    {
+        conns[i].client = socket(AF_INET, SOCK_STREAM, 0);
+        /* every byte is sent at once, not after the ACK of the previous one */
+        if (conns[i].client < 0 ||
+                setsockopt(conns[i].client, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0 ||
+                connect(conns[i].client, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+                (conns[i].server = accept(listener, RT_NULL, RT_NULL)) < 0)
+        {
+            rt_kprintf("connection %d failed\n", i);
+            goto __exit;
+        }
+
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, conns[i].server, &event) < 0)
+        {
+            rt_kprintf("epoll_ctl failed\n");
+            goto __exit;
+        }
+    }
+
+    ok = bench_modes();
+    bench_time();
+
+__exit:
+    bench_close(listener);
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(sal_epoll_bench, SAL epoll test and benchmark: sal_epoll_bench [connections]);
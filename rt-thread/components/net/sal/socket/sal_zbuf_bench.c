@@ -0,0 +1,370 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark of the zero-copy socket API.
+ *
+ * Data is streamed to the address of the default network interface, lwIP
+ * loops it back without the driver. A thread with a higher priority than the
+ * sender receives it with recv() into a buffer or with recv_zc() in the
+ * pbufs of lwIP, and sums every byte like a parser would read it. The data is
+ * sent with send() and with send_zc() from buffers of zbuf_alloc(), over TCP
+ * and as UDP datagrams. The CPU is busy for the whole run, so the time per
+ * byte is the time of the sender, the receiver and lwIP together. The TCP
+ * runs check the length and the sum of the received data, the UDP runs print
+ * the datagrams dropped by lwIP.
+ *
+ * msh: sal_zbuf_bench [KB]
+ */
+
+#include <stdlib.h>
+#include <rtthread.h>
+#include <ipc/completion.h>
+#include <sys/socket.h>
+#include <netdev.h>
+
+#define BENCH_PORT          5025
+#define BENCH_TCP_CHUNK     1460
+#define BENCH_UDP_CHUNK     1024
+#define BENCH_KBYTES        4096
+#define BENCH_TIMEOUT_MS    1000
+#define BENCH_STACK_SIZE    2048
+
+struct bench_rx
+{
+    int sock;
+    int type;
+    rt_bool_t zc;
+    rt_uint32_t bytes;
+    rt_uint32_t packets;
+    rt_uint32_t sum;
+    rt_bool_t error;
+    struct rt_completion done;
+};
+
+static rt_uint32_t bench_sum(const rt_uint8_t *data, size_t len, rt_uint32_t sum)
+{
+    while (len--)
+    {
+        sum += *data++;
+    }
+    return sum;
+}
+
+static void bench_fill(rt_uint8_t *data, size_t len, rt_uint32_t offset)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        data[i] = (rt_uint8_t) ((offset + i) * 7);
+    }
+}
+
+static void bench_rx_entry(void *parameter)
+{
+    struct bench_rx *rx = (struct bench_rx *) parameter;
+    struct sal_zbuf *buf, *seg;
+    rt_uint8_t *mem = RT_NULL;
+    int len;
+
+    if (!rx->zc)
+    {
+        mem = (rt_uint8_t *) rt_malloc(BENCH_TCP_CHUNK);
+        if (mem == RT_NULL)
+        {
+            rx->error = RT_TRUE;
+            rt_completion_done(&rx->done);
+            return;
+        }
+    }
+
+    while (1)
+    {
+        if (rx->zc)
+        {
+            len = recv_zc(rx->sock, &buf, 0);
+            if (len > 0)
+            {
+                for (seg = buf; seg; seg = seg->next)
+                {
+                    rx->sum = bench_sum((const rt_uint8_t *) seg->data, seg->len, rx->sum);
+                }
+                zbuf_free(buf);
+            }
+        }
+        else
+        {
+            len = recv(rx->sock, mem, BENCH_TCP_CHUNK, 0);
+            if (len > 0)
+            {
+                rx->sum = bench_sum(mem, len, rx->sum);
+            }
+        }
+
+        /* the end of a TCP stream, or one byte after the UDP datagrams */
+        if (len == 0 || (len == 1 && rx->type == SOCK_DGRAM))
+        {
+            break;
+        }
+        if (len < 0)
+        {
+            /* the receive timeout also ends the UDP runs that lost the last datagram */
+            rx->error = (rx->type == SOCK_STREAM);
+            break;
+        }
+        rx->bytes += len;
+        rx->packets++;
+    }
+
+    if (mem)
+    {
+        rt_free(mem);
+    }
+    rt_completion_done(&rx->done);
+}
+
+static int bench_send(int sock, const rt_uint8_t *data, size_t len, rt_bool_t zc)
+{
+    struct sal_zbuf *buf;
+
+    if (!zc)
+    {
+        return send(sock, data, len, 0);
+    }
+
+    buf = zbuf_alloc(sock, len);
+    if (buf == RT_NULL)
+    {
+        return -1;
+    }
+    /* a real sender writes its data in the buffer in the first place */
+    rt_memcpy(buf->data, data, len);
+    return send_zc(sock, buf, 0);
+}
+
+static void bench_print(const char *name, rt_uint32_t bytes, rt_tick_t tick)
+{
+    rt_uint32_t us = tick * (1000000 / RT_TICK_PER_SECOND);
+
+    if (us == 0)
+    {
+        us = 1;
+    }
+    rt_kprintf("%-24s %7u KB %4u.%02u MB/s %4u.%u ns/byte\n", name, bytes / 1024,
+               (rt_uint32_t) ((rt_uint64_t) bytes * 100 / us / 100),
+               (rt_uint32_t) ((rt_uint64_t) bytes * 100 / us % 100),
+               (rt_uint32_t) ((rt_uint64_t) us * 10000 / bytes / 10),
+               (rt_uint32_t) ((rt_uint64_t) us * 10000 / bytes % 10));
+}
+
+static void bench_timeout(int sock)
+{
+    struct timeval timeout;
+
+    timeout.tv_sec = BENCH_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (BENCH_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+static int bench_socket(int type, const struct sockaddr_in *addr, rt_bool_t do_bind)
+{
+    int sock;
+
+    sock = socket(AF_INET, type, 0);
+    if (sock < 0)
+    {
+        return -1;
+    }
+
+    bench_timeout(sock);
+    if (do_bind && bind(sock, (const struct sockaddr *) addr, sizeof(*addr)) < 0)
+    {
+        closesocket(sock);
+        return -1;
+    }
+
+    return sock;
+}
+
+static rt_bool_t bench_run(const char *name, int type, struct sockaddr_in *addr,
+                           rt_uint32_t total, rt_bool_t zc_send, rt_bool_t zc_recv)
+{
+    struct bench_rx rx;
+    rt_thread_t thread;
+    rt_uint8_t *data;
+    int chunk = (type == SOCK_STREAM) ? BENCH_TCP_CHUNK : BENCH_UDP_CHUNK;
+    int server = -1, sock = -1, len, i;
+    rt_uint32_t sent = 0, sum = 0, packets = 0;
+    rt_tick_t tick;
+    rt_bool_t ok = RT_FALSE;
+
+    /* every run has its own port, the closed connections may still use theirs */
+    addr->sin_port = htons(ntohs(addr->sin_port) + 1);
+
+    rt_memset(&rx, 0x00, sizeof(rx));
+    rx.sock = -1;
+    rx.type = type;
+    rx.zc = zc_recv;
+    rt_completion_init(&rx.done);
+
+    data = (rt_uint8_t *) rt_malloc(chunk);
+    if (data == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        return RT_FALSE;
+    }
+
+    if (type == SOCK_STREAM)
+    {
+        server = bench_socket(SOCK_STREAM, addr, RT_TRUE);
+        sock = bench_socket(SOCK_STREAM, addr, RT_FALSE);
+        if (server < 0 || sock < 0 || listen(server, 1) < 0 ||
+                connect(sock, (const struct sockaddr *) addr, sizeof(*addr)) < 0)
+        {
+            rt_kprintf("%s: connect failed\n", name);
+            goto __exit;
+        }
+        rx.sock = accept(server, RT_NULL, RT_NULL);
+        if (rx.sock >= 0)
+        {
+            bench_timeout(rx.sock);
+        }
+    }
+    else
+    {
+        rx.sock = bench_socket(SOCK_DGRAM, addr, RT_TRUE);
+        sock = bench_socket(SOCK_DGRAM, addr, RT_FALSE);
+        if (sock < 0 || connect(sock, (const struct sockaddr *) addr, sizeof(*addr)) < 0)
+        {
+            rt_kprintf("%s: connect failed\n", name);
+            goto __exit;
+        }
+    }
+    if (rx.sock < 0)
+    {
+        rt_kprintf("%s: no receive socket\n", name);
+        goto __exit;
+    }
+
+    thread = rt_thread_create("zbrx", bench_rx_entry, &rx, BENCH_STACK_SIZE,
+                              rt_thread_self()->current_priority - 1, 10);
+    if (thread == RT_NULL)
+    {
+        rt_kprintf("no memory\n");
+        goto __exit;
+    }
+    rt_thread_startup(thread);
+
+    tick = rt_tick_get();
+    while (sent < total)
+    {
+        len = (total - sent < (rt_uint32_t) chunk) ? (int) (total - sent) : chunk;
+        /* datagrams of one byte end the UDP runs */
+        if (type == SOCK_DGRAM && len == 1)
+        {
+            len = 2;
+        }
+        bench_fill(data, len, sent);
+        len = bench_send(sock, data, len, zc_send);
+        if (len <= 0)
+        {
+            rt_kprintf("%s: send failed\n", name);
+            break;
+        }
+        sum = bench_sum(data, len, sum);
+        sent += len;
+        packets++;
+    }
+
+    if (type == SOCK_STREAM)
+    {
+        closesocket(sock);
+        sock = -1;
+    }
+    else
+    {
+        for (i = 0; i < 3; i++)
+        {
+            send(sock, data, 1, 0);
+        }
+    }
+    rt_completion_wait(&rx.done, RT_WAITING_FOREVER);
+    tick = rt_tick_get() - tick;
+
+    bench_print(name, rx.bytes, tick);
+    if (type == SOCK_STREAM)
+    {
+        ok = !rx.error && rx.bytes == sent && rx.sum == sum;
+    }
+    else
+    {
+        ok = !rx.error && rx.bytes <= sent;
+        rt_kprintf("%-24s %u of %u datagrams lost\n", "", packets - rx.packets, packets);
+    }
+
+__exit:
+    if (rx.sock >= 0)
+    {
+        closesocket(rx.sock);
+    }
+    if (sock >= 0)
+    {
+        closesocket(sock);
+    }
+    if (server >= 0)
+    {
+        closesocket(server);
+    }
+    rt_free(data);
+    return ok;
+}
+
+static int sal_zbuf_bench(int argc, char **argv)
+{
+    struct sockaddr_in addr;
+    rt_uint32_t total = BENCH_KBYTES * 1024;
+    rt_bool_t ok = RT_TRUE;
+
+    if (argc > 1)
+    {
+        total = atoi(argv[1]) * 1024;
+        if (total == 0)
+        {
+            rt_kprintf("usage: sal_zbuf_bench [KB]\n");
+            return -1;
+        }
+    }
+
+    if (netdev_default == RT_NULL || !netdev_is_up(netdev_default))
+    {
+        rt_kprintf("no network interface\n");
+        return -1;
+    }
+
+    rt_memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(BENCH_PORT);
+#if NETDEV_IPV4 && NETDEV_IPV6
+    addr.sin_addr.s_addr = netdev_default->ip_addr.u_addr.ip4.addr;
+#else
+    addr.sin_addr.s_addr = netdev_default->ip_addr.addr;
+#endif
+
+    ok = bench_run("tcp send/recv", SOCK_STREAM, &addr, total, RT_FALSE, RT_FALSE) && ok;
+    ok = bench_run("tcp send/recv_zc", SOCK_STREAM, &addr, total, RT_FALSE, RT_TRUE) && ok;
+    ok = bench_run("tcp send_zc/recv_zc", SOCK_STREAM, &addr, total, RT_TRUE, RT_TRUE) && ok;
+    ok = bench_run("udp send/recv", SOCK_DGRAM, &addr, total, RT_FALSE, RT_FALSE) && ok;
+    ok = bench_run("udp send_zc/recv_zc", SOCK_DGRAM, &addr, total, RT_TRUE, RT_TRUE) && ok;
+
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(sal_zbuf_bench, SAL zero-copy socket benchmark: sal_zbuf_bench [KB]);
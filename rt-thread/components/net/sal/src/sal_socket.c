@@ -551,6 +551,9 @@ static int socket_new(void)
 #ifdef SAL_USING_TLS
     sock->user_data_tls = RT_NULL;
 #endif
+#ifdef SAL_USING_EPOLL
+    rt_list_init(&sock->epoll_items);
+#endif
 
 __result:
     sal_unlock();
@@ -933,6 +936,210 @@ int sal_sendto(int socket, const void *dataptr, size_t size, int flags,
 #endif
 }
 
+#ifdef SAL_USING_ZBUF
+/* the size of the buffers received by copying */
+#ifndef SAL_ZBUF_RECV_SIZE
+#define SAL_ZBUF_RECV_SIZE             1460
+#endif
+
+#ifdef SAL_USING_TLS
+#define SAL_ZBUF_PROTO_TLS(sock)       IS_SOCKET_PROTO_TLS(sock)
+#else
+#define SAL_ZBUF_PROTO_TLS(sock)       0
+#endif
+
+struct sal_zbuf *sal_zbuf_new(size_t num, size_t size)
+{
+    struct sal_zbuf *buf;
+    size_t i;
+
+    RT_ASSERT(num > 0);
+
+    buf = (struct sal_zbuf *) rt_malloc(num * sizeof(struct sal_zbuf) + size);
+    if (buf == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    rt_memset(buf, 0x00, num * sizeof(struct sal_zbuf));
+    for (i = 0; i + 1 < num; i++)
+    {
+        buf[i].next = &buf[i + 1];
+    }
+    if (size > 0)
+    {
+        buf->data = (void *) (buf + num);
+    }
+    buf->len = buf->tot_len = size;
+
+    return buf;
+}
+
+void sal_zbuf_free(struct sal_zbuf *buf)
+{
+    if (buf == RT_NULL)
+    {
+        return;
+    }
+
+    if (buf->release)
+    {
+        buf->release(buf);
+    }
+    rt_free(buf);
+}
+
+/**
+ * This function receives the next data of a socket in the buffers of the
+ * protocol stack. TCP data comes as it was received, not merged into a given
+ * length. Stacks without zero-copy support, TLS sockets and MSG_PEEK receive
+ * up to SAL_ZBUF_RECV_SIZE bytes into a new buffer.
+ *
+ * @param socket the socket descriptor
+ * @param buf the received chain, free it with sal_zbuf_free()
+ * @param flags MSG_DONTWAIT or MSG_PEEK
+ *
+ * @return the number of bytes received, 0 if the connection is closed, -1 on error
+ */
+int sal_recv_zc(int socket, struct sal_zbuf **buf, int flags)
+{
+    struct sal_socket *sock;
+    struct sal_proto_family *pf;
+    struct sal_zbuf *zbuf;
+    int ret;
+
+    RT_ASSERT(buf);
+    *buf = RT_NULL;
+
+    /* get the socket object by socket descriptor */
+    SAL_SOCKET_OBJ_GET(sock, socket);
+
+    /* check the network interface is up status  */
+    SAL_NETDEV_IS_UP(sock->netdev);
+    /* check the network interface socket opreation */
+    SAL_NETDEV_SOCKETOPS_VALID(sock->netdev, pf, recvfrom);
+
+    if (pf->skt_ops->recv_zc && !(flags & MSG_PEEK) && !SAL_ZBUF_PROTO_TLS(sock))
+    {
+        return pf->skt_ops->recv_zc((int) sock->user_data, buf, flags);
+    }
+
+    zbuf = sal_zbuf_new(1, SAL_ZBUF_RECV_SIZE);
+    if (zbuf == RT_NULL)
+    {
+        return -1;
+    }
+
+    ret = sal_recvfrom(socket, zbuf->data, SAL_ZBUF_RECV_SIZE, flags, RT_NULL, RT_NULL);
+    if (ret <= 0)
+    {
+        sal_zbuf_free(zbuf);
+        return ret;
+    }
+
+    zbuf->len = zbuf->tot_len = ret;
+    *buf = zbuf;
+    return ret;
+}
+
+/**
+ * This function allocates a buffer to be filled and sent by sal_send_zc().
+ * It's a buffer of the protocol stack if the stack supports zero-copy.
+ *
+ * @param socket the socket descriptor
+ * @param size the size of the buffer
+ *
+ * @return the buffer of one segment, RT_NULL on failure
+ */
+struct sal_zbuf *sal_zbuf_alloc(int socket, size_t size)
+{
+    struct sal_socket *sock;
+    struct sal_proto_family *pf;
+    struct sal_zbuf *buf;
+
+    sock = sal_get_socket(socket);
+    if (sock == RT_NULL || sock->netdev == RT_NULL)
+    {
+        return RT_NULL;
+    }
+
+    pf = (struct sal_proto_family *) sock->netdev->sal_user_data;
+    if (pf->skt_ops->zbuf_alloc && !SAL_ZBUF_PROTO_TLS(sock))
+    {
+        buf = pf->skt_ops->zbuf_alloc((int) sock->user_data, size);
+        if (buf)
+        {
+            return buf;
+        }
+    }
+
+    return sal_zbuf_new(1, size);
+}
+
+/**
+ * This function sends the data of a chain and frees it, also on failure.
+ * The `len` of a buffer from sal_zbuf_alloc() may be lowered before, its
+ * data is sent without copying if the stack supports it. A chain of several
+ * segments is sent at once, it's copied into one buffer if the stack copies.
+ *
+ * @param socket the socket descriptor
+ * @param buf the chain
+ * @param flags the flags of send()
+ *
+ * @return the number of bytes sent, -1 on error
+ */
+int sal_send_zc(int socket, struct sal_zbuf *buf, int flags)
+{
+    struct sal_socket *sock;
+    struct sal_proto_family *pf;
+    struct sal_zbuf *seg;
+    rt_uint8_t *data;
+    size_t offset;
+    int ret = -1;
+
+    RT_ASSERT(buf);
+
+    sock = sal_get_socket(socket);
+    if (sock == RT_NULL || !netdev_is_up(sock->netdev))
+    {
+        goto __exit;
+    }
+
+    pf = (struct sal_proto_family *) sock->netdev->sal_user_data;
+    if (pf->skt_ops->send_zc && buf->owner == pf->skt_ops && !SAL_ZBUF_PROTO_TLS(sock))
+    {
+        ret = pf->skt_ops->send_zc((int) sock->user_data, buf, flags);
+        goto __exit;
+    }
+
+    data = (rt_uint8_t *) buf->data;
+    if (buf->next)
+    {
+        /* a datagram can't be sent in pieces */
+        data = (rt_uint8_t *) rt_malloc(buf->tot_len);
+        if (data == RT_NULL)
+        {
+            goto __exit;
+        }
+        for (seg = buf, offset = 0; seg; seg = seg->next)
+        {
+            rt_memcpy(data + offset, seg->data, seg->len);
+            offset += seg->len;
+        }
+    }
+
+    ret = sal_sendto(socket, data, buf->next ? buf->tot_len : buf->len, flags, RT_NULL, 0);
+    if (data != buf->data)
+    {
+        rt_free(data);
+    }
+
+__exit:
+    sal_zbuf_free(buf);
+    return ret;
+}
+#endif /* SAL_USING_ZBUF */
+
 int sal_socket(int domain, int type, int protocol)
 {
     int retval;
@@ -1001,6 +1208,11 @@ int sal_closesocket(int socket)
     /* valid the network interface socket opreation */
     SAL_NETDEV_SOCKETOPS_VALID(sock->netdev, pf, closesocket);
 
+#ifdef SAL_USING_EPOLL
+    /* the wait queue of the socket goes away with it */
+    sal_epoll_socket_close(sock);
+#endif
+
     if (pf->skt_ops->closesocket((int) sock->user_data) == 0)
     {
 #ifdef SAL_USING_TLS
@@ -0,0 +1,709 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * File backend: the output copies the lines to a buffer in RAM, a thread
+ * compresses the buffer when it is full, or every ULOG_FILE_BE_FLUSH_MS,
+ * and writes it as a block to <dir>/<name>.ulz. The output fills the other
+ * buffer meanwhile, a line is dropped when both are full. The file is
+ * renamed to <name>_1.ulz when the next block doesn't fit in the file size,
+ * the older ones up to <name>_<file_max - 1>.ulz, the oldest is removed.
+ *
+ * A block starts at a multiple of ULOG_FILE_BE_SECTOR_SIZE and is zero
+ * padded to the next one, so FatFs writes its sectors straight from the
+ * buffer. The file is synced after every block: a power loss loses the
+ * lines in RAM and the block being written, not the blocks before it.
+ * The reader skips a sector that doesn't start a valid block.
+ *
+ *   magic      "ULZB"
+ *   seq        of the block since the backend was started
+ *   raw_size   of the lines
+ *   data_size  of the data after the header, the lines in the LZ4 block
+ *              format when it is less than raw_size, else the lines as is
+ *   crc        CRC-32 of the fields above and the data
+ *
+ * ulog_file_cat prints a file, rt-thread/tools/ulog_file_decode.py too.
+ */
+
+#include <rthw.h>
+#include <ulog.h>
+
+#ifdef ULOG_BACKEND_USING_FILE
+
+#include <dfs_file.h>
+#include <unistd.h>
+
+#if ULOG_FILE_BE_BLOCK_SIZE > 0xffff
+#error "the block size of the file backend (ULOG_FILE_BE_BLOCK_SIZE) must be less than 64KB"
+#endif
+
+#define FILE_BE_MAGIC                  0x425a4c55 /* "ULZB" */
+#define FILE_BE_SECTOR                 ULOG_FILE_BE_SECTOR_SIZE
+#define FILE_BE_BLOCK_MAX              RT_ALIGN(sizeof(struct file_be_block) + ULOG_FILE_BE_BLOCK_SIZE, FILE_BE_SECTOR)
+#define FILE_BE_FLUSH_TIMEOUT          (RT_TICK_PER_SECOND * 2)
+
+#define FILE_BE_EVENT_BLOCK            0x01 /* a buffer is full */
+#define FILE_BE_EVENT_FLUSH            0x02
+#define FILE_BE_EVENT_STOP             0x04
+#define FILE_BE_EVENT_FLUSHED          0x08 /* from the writer */
+#define FILE_BE_EVENT_STOPPED          0x10
+
+/* the LZ4 block format */
+#define LZ4_HASH_LOG                   11
+#define LZ4_HASH(v)                    (((v) * 2654435761u) >> (32 - LZ4_HASH_LOG))
+#define LZ4_MIN_MATCH                  4
+#define LZ4_LAST_LITERALS              5  /* the block ends with literals */
+#define LZ4_MATCH_LIMIT                12 /* no match starts in the last bytes */
+
+struct file_be_block
+{
+    rt_uint32_t magic;
+    rt_uint32_t seq;
+    rt_uint32_t raw_size;
+    rt_uint32_t data_size;
+    rt_uint32_t crc;
+};
+
+static rt_uint32_t file_be_crc32(rt_uint32_t crc, const void *buf, rt_size_t len)
+{
+    static const rt_uint32_t table[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const rt_uint8_t *p = (const rt_uint8_t *)buf;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static rt_uint32_t file_be_block_crc(const struct file_be_block *block)
+{
+    /* the fields before the crc */
+    rt_uint32_t crc = file_be_crc32(0, block, sizeof(struct file_be_block) - sizeof(rt_uint32_t));
+
+    return file_be_crc32(crc, block + 1, block->data_size);
+}
+
+static rt_uint32_t lz4_read32(const rt_uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((rt_uint32_t)p[3] << 24);
+}
+
+/* a length from 15 on, in bytes of 255 and the rest */
+static rt_uint8_t *lz4_put_len(rt_uint8_t *op, rt_size_t len)
+{
+    while (len >= 255)
+    {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (rt_uint8_t)len;
+
+    return op;
+}
+
+/* a sequence of the literals and a match, no match when match_len is 0 */
+static rt_uint8_t *lz4_put_seq(rt_uint8_t *op, rt_uint8_t *op_end, const rt_uint8_t *literals, rt_size_t lit_len,
+                               rt_size_t offset, rt_size_t match_len)
+{
+    rt_size_t ml = match_len ? match_len - LZ4_MIN_MATCH : 0;
+    rt_uint8_t *token;
+
+    if (op + 1 + lit_len / 255 + 1 + lit_len + 2 + ml / 255 + 1 > op_end)
+        return RT_NULL;
+
+    token = op++;
+    *token = (rt_uint8_t)((lit_len < 15 ? lit_len : 15) << 4);
+    if (lit_len >= 15)
+        op = lz4_put_len(op, lit_len - 15);
+    rt_memcpy(op, literals, lit_len);
+    op += lit_len;
+
+    if (match_len)
+    {
+        *op++ = (rt_uint8_t)offset;
+        *op++ = (rt_uint8_t)(offset >> 8);
+        *token |= (rt_uint8_t)(ml < 15 ? ml : 15);
+        if (ml >= 15)
+            op = lz4_put_len(op, ml - 15);
+    }
+
+    return op;
+}
+
+/**
+ * compress to the LZ4 block format, greedy with a hash of 4 bytes
+ *
+ * @return the size, 0 when it doesn't fit in dst_size
+ */
+static rt_size_t lz4_compress(rt_uint16_t *hash, const rt_uint8_t *src, rt_size_t src_size,
+                              rt_uint8_t *dst, rt_size_t dst_size)
+{
+    const rt_uint8_t *ip = src, *anchor = src, *ref;
+    const rt_uint8_t *src_end = src + src_size;
+    rt_uint8_t *op = dst, *op_end = dst + dst_size;
+    rt_uint32_t value, h;
+    rt_size_t len;
+
+    rt_memset(hash, 0, sizeof(rt_uint16_t) << LZ4_HASH_LOG);
+
+    while (src_size > LZ4_MATCH_LIMIT && ip < src_end - LZ4_MATCH_LIMIT)
+    {
+        value = lz4_read32(ip);
+        h = LZ4_HASH(value);
+        ref = src + hash[h];
+        hash[h] = (rt_uint16_t)(ip - src);
+        if (ref >= ip || lz4_read32(ref) != value)
+        {
+            /* faster over the data that doesn't repeat */
+            ip += 1 + ((ip - anchor) >> 6);
+            continue;
+        }
+
+        /* the match back to the literals and on to the last literals */
+        while (ip > anchor && ref > src && ip[-1] == ref[-1])
+        {
+            ip--;
+            ref--;
+        }
+        len = LZ4_MIN_MATCH;
+        while (ip + len < src_end - LZ4_LAST_LITERALS && ip[len] == ref[len])
+            len++;
+
+        op = lz4_put_seq(op, op_end, anchor, ip - anchor, ip - ref, len);
+        if (op == RT_NULL)
+            return 0;
+        ip += len;
+        anchor = ip;
+    }
+
+    op = lz4_put_seq(op, op_end, anchor, src_end - anchor, 0, 0);
+    if (op == RT_NULL)
+        return 0;
+
+    return op - dst;
+}
+
+/* the length after a token, RT_NULL with a broken block */
+static const rt_uint8_t *lz4_get_len(const rt_uint8_t *ip, const rt_uint8_t *ip_end, rt_size_t *len)
+{
+    rt_uint8_t byte;
+
+    if (*len != 15)
+        return ip;
+    do
+    {
+        if (ip >= ip_end)
+            return RT_NULL;
+        byte = *ip++;
+        *len += byte;
+    } while (byte == 255);
+
+    return ip;
+}
+
+/**
+ * decompress a block of the LZ4 block format
+ *
+ * @return the size, 0 when the block is broken
+ */
+static rt_size_t lz4_decompress(const rt_uint8_t *src, rt_size_t src_size, rt_uint8_t *dst, rt_size_t dst_size)
+{
+    const rt_uint8_t *ip = src, *ip_end = src + src_size;
+    rt_uint8_t *op = dst, *op_end = dst + dst_size;
+    rt_size_t len, offset;
+    rt_uint8_t token;
+
+    while (ip < ip_end)
+    {
+        token = *ip++;
+        len = token >> 4;
+        ip = lz4_get_len(ip, ip_end, &len);
+        if (ip == RT_NULL || len > (rt_size_t)(ip_end - ip) || len > (rt_size_t)(op_end - op))
+            return 0;
+        rt_memcpy(op, ip, len);
+        op += len;
+        ip += len;
+        /* the last literals */
+        if (ip == ip_end)
+            break;
+
+        if (ip_end - ip < 2)
+            return 0;
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        len = token & 15;
+        ip = lz4_get_len(ip, ip_end, &len);
+        len += LZ4_MIN_MATCH;
+        if (ip == RT_NULL || offset == 0 || offset > (rt_size_t)(op - dst) || len > (rt_size_t)(op_end - op))
+            return 0;
+        /* the match may overlap its copy */
+        while (len--)
+        {
+            *op = *(op - offset);
+            op++;
+        }
+    }
+
+    return op - dst;
+}
+
+static void file_be_path(ulog_file_be_t be, char *path, rt_size_t size, int index)
+{
+    if (index == 0)
+        rt_snprintf(path, size, "%s/%s.ulz", be->dir, be->name);
+    else
+        rt_snprintf(path, size, "%s/%s_%d.ulz", be->dir, be->name, index);
+}
+
+/* open the current file to append blocks */
+static rt_err_t file_be_open(ulog_file_be_t be)
+{
+    static const rt_uint8_t zeros[32] = { 0 };
+    char path[DFS_PATH_MAX];
+    off_t size;
+    rt_size_t pad;
+
+    mkdir(be->dir, 0);
+    file_be_path(be, path, sizeof(path), 0);
+    be->fd = open(path, O_WRONLY | O_CREAT);
+    if (be->fd < 0)
+        return -RT_ERROR;
+
+    size = lseek(be->fd, 0, SEEK_END);
+    if (size < 0)
+        goto __fail;
+
+    /* the next block starts at a sector, also after a write cut short */
+    be->file_pos = RT_ALIGN(size, FILE_BE_SECTOR);
+    while (size < be->file_pos)
+    {
+        pad = be->file_pos - size < sizeof(zeros) ? be->file_pos - size : sizeof(zeros);
+        if (write(be->fd, zeros, pad) != (ssize_t)pad)
+            goto __fail;
+        size += pad;
+    }
+
+    return RT_EOK;
+
+__fail:
+    close(be->fd);
+    be->fd = -1;
+    return -RT_ERROR;
+}
+
+/* <name>.ulz becomes <name>_1.ulz, the oldest is removed */
+static void file_be_rotate(ulog_file_be_t be)
+{
+    char from[DFS_PATH_MAX], to[DFS_PATH_MAX];
+    int i;
+
+    close(be->fd);
+    be->fd = -1;
+
+    file_be_path(be, to, sizeof(to), be->file_max - 1);
+    unlink(to);
+    for (i = be->file_max - 1; i > 0; i--)
+    {
+        file_be_path(be, from, sizeof(from), i - 1);
+        file_be_path(be, to, sizeof(to), i);
+        rename(from, to);
+    }
+}
+
+static void file_be_write_block(ulog_file_be_t be, const rt_uint8_t *lines, rt_size_t len)
+{
+    struct file_be_block *block = (struct file_be_block *)be->block;
+    rt_uint8_t *data = (rt_uint8_t *)(block + 1);
+    rt_size_t size, total;
+
+    /* as is when it doesn't get smaller */
+    size = lz4_compress(be->hash, lines, len, data, len - 1);
+    if (size == 0)
+    {
+        rt_memcpy(data, lines, len);
+        size = len;
+    }
+
+    block->magic = FILE_BE_MAGIC;
+    block->seq = be->seq++;
+    block->raw_size = len;
+    block->data_size = size;
+    block->crc = file_be_block_crc(block);
+    total = RT_ALIGN(sizeof(struct file_be_block) + size, FILE_BE_SECTOR);
+    rt_memset(data + size, 0, total - sizeof(struct file_be_block) - size);
+
+    if (be->fd >= 0 && be->file_pos > 0 && be->file_pos + total > be->file_size)
+        file_be_rotate(be);
+    if (be->fd < 0 && file_be_open(be) != RT_EOK)
+    {
+        be->lost++;
+        return;
+    }
+
+    if (write(be->fd, be->block, total) != (ssize_t)total || fsync(be->fd) != 0)
+    {
+        /* reopened at the next block */
+        close(be->fd);
+        be->fd = -1;
+        be->lost++;
+        return;
+    }
+    be->file_pos += total;
+    be->blocks++;
+    be->raw_bytes += len;
+    be->written_bytes += total;
+}
+
+/* write the full buffer, and the one filled with `partial` */
+static void file_be_write_pending(ulog_file_be_t be, rt_bool_t partial)
+{
+    rt_base_t irq;
+    rt_int8_t index;
+    int i;
+
+    /* the pending buffer, then the one filled meanwhile */
+    for (i = 0; i < 2; i++)
+    {
+        irq = rt_hw_interrupt_disable();
+        if (be->pending < 0 && partial && be->len[be->fill] > 0)
+        {
+            be->pending = be->fill;
+            be->fill ^= 1;
+            be->len[be->fill] = 0;
+        }
+        index = be->pending;
+        rt_hw_interrupt_enable(irq);
+
+        if (index < 0)
+            break;
+        file_be_write_block(be, be->buf[index], be->len[index]);
+
+        irq = rt_hw_interrupt_disable();
+        be->pending = -1;
+        rt_hw_interrupt_enable(irq);
+    }
+}
+
+static void file_be_thread_entry(void *parameter)
+{
+    ulog_file_be_t be = (ulog_file_be_t)parameter;
+    rt_uint32_t recved;
+
+    while (1)
+    {
+        if (rt_event_recv(&be->event, FILE_BE_EVENT_BLOCK | FILE_BE_EVENT_FLUSH | FILE_BE_EVENT_STOP,
+                          RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, rt_tick_from_millisecond(ULOG_FILE_BE_FLUSH_MS),
+                          &recved) != RT_EOK)
+        {
+            /* the lines don't wait longer than the flush period */
+            file_be_write_pending(be, RT_TRUE);
+            continue;
+        }
+
+        file_be_write_pending(be, (recved & (FILE_BE_EVENT_FLUSH | FILE_BE_EVENT_STOP)) != 0);
+        if (recved & FILE_BE_EVENT_FLUSH)
+            rt_event_send(&be->event, FILE_BE_EVENT_FLUSHED);
+        if (recved & FILE_BE_EVENT_STOP)
+            break;
+    }
+
+    if (be->fd >= 0)
+    {
+        close(be->fd);
+        be->fd = -1;
+    }
+    rt_event_send(&be->event, FILE_BE_EVENT_STOPPED);
+}
+
+static void file_be_output(struct ulog_backend *backend, rt_uint32_t level, const char *tag, rt_bool_t is_raw,
+                           const char *log, rt_size_t len)
+{
+    ulog_file_be_t be = (ulog_file_be_t)backend;
+    rt_bool_t wake = RT_FALSE;
+    rt_base_t irq;
+
+    if (len > ULOG_FILE_BE_BLOCK_SIZE)
+        len = ULOG_FILE_BE_BLOCK_SIZE;
+
+    /* a copy of a line, from the threads and the ISRs */
+    irq = rt_hw_interrupt_disable();
+    if (!be->running)
+    {
+        rt_hw_interrupt_enable(irq);
+        return;
+    }
+    if (be->len[be->fill] + len > ULOG_FILE_BE_BLOCK_SIZE)
+    {
+        if (be->pending >= 0)
+        {
+            be->dropped++;
+            rt_hw_interrupt_enable(irq);
+            return;
+        }
+        be->pending = be->fill;
+        be->fill ^= 1;
+        be->len[be->fill] = 0;
+        wake = RT_TRUE;
+    }
+    rt_memcpy(be->buf[be->fill] + be->len[be->fill], log, len);
+    be->len[be->fill] += len;
+    be->lines++;
+    rt_hw_interrupt_enable(irq);
+
+    if (wake)
+        rt_event_send(&be->event, FILE_BE_EVENT_BLOCK);
+}
+
+static void file_be_flush(struct ulog_backend *backend)
+{
+    ulog_file_be_t be = (ulog_file_be_t)backend;
+    rt_uint32_t recved;
+
+    if (!be->running)
+        return;
+
+    /* only a thread waits for the writer */
+    if (rt_interrupt_get_nest() != 0 || rt_critical_level() != 0 || rt_thread_self() == be->thread)
+    {
+        rt_event_send(&be->event, FILE_BE_EVENT_FLUSH);
+        return;
+    }
+
+    rt_mutex_take(&be->flush_lock, RT_WAITING_FOREVER);
+    rt_event_recv(&be->event, FILE_BE_EVENT_FLUSHED, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_NO, &recved);
+    rt_event_send(&be->event, FILE_BE_EVENT_FLUSH);
+    rt_event_recv(&be->event, FILE_BE_EVENT_FLUSHED, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, FILE_BE_FLUSH_TIMEOUT,
+                  &recved);
+    rt_mutex_release(&be->flush_lock);
+}
+
+static void file_be_free(ulog_file_be_t be)
+{
+    rt_free(be->buf[0]);
+    rt_free(be->buf[1]);
+    rt_free(be->block);
+    rt_free(be->hash);
+    be->buf[0] = be->buf[1] = be->block = RT_NULL;
+    be->hash = RT_NULL;
+}
+
+static void file_be_deinit(struct ulog_backend *backend)
+{
+    ulog_file_be_t be = (ulog_file_be_t)backend;
+    rt_uint32_t recved;
+    rt_base_t irq;
+
+    /* the lines so far are written, the later ones are ignored */
+    irq = rt_hw_interrupt_disable();
+    be->running = RT_FALSE;
+    rt_hw_interrupt_enable(irq);
+
+    rt_event_send(&be->event, FILE_BE_EVENT_STOP);
+    rt_event_recv(&be->event, FILE_BE_EVENT_STOPPED, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_FOREVER,
+                  &recved);
+    be->thread = RT_NULL;
+
+    rt_event_detach(&be->event);
+    rt_mutex_detach(&be->flush_lock);
+    file_be_free(be);
+}
+
+/**
+ * start a file backend, call it after the file system is mounted
+ *
+ * @param be the backend
+ * @param name of the backend, its thread and its files
+ * @param dir of the files, made when it doesn't exist
+ * @param file_size the file is rotated when the next block doesn't fit in it
+ * @param file_max the files kept with the current one
+ *
+ * @return RT_EOK, -RT_ENOMEM
+ */
+rt_err_t ulog_file_backend_init(ulog_file_be_t be, const char *name, const char *dir, rt_uint32_t file_size,
+                                rt_uint16_t file_max)
+{
+    RT_ASSERT(be);
+    RT_ASSERT(name);
+    RT_ASSERT(dir);
+    RT_ASSERT(file_max > 0);
+
+    rt_memset(be, 0, sizeof(struct ulog_file_be));
+    be->dir = dir;
+    be->name = name;
+    be->file_size = file_size;
+    be->file_max = file_max;
+    be->fd = -1;
+    be->pending = -1;
+
+    be->buf[0] = (rt_uint8_t *)rt_malloc(ULOG_FILE_BE_BLOCK_SIZE);
+    be->buf[1] = (rt_uint8_t *)rt_malloc(ULOG_FILE_BE_BLOCK_SIZE);
+    be->block = (rt_uint8_t *)rt_malloc(FILE_BE_BLOCK_MAX);
+    be->hash = (rt_uint16_t *)rt_malloc(sizeof(rt_uint16_t) << LZ4_HASH_LOG);
+    if (be->buf[0] == RT_NULL || be->buf[1] == RT_NULL || be->block == RT_NULL || be->hash == RT_NULL)
+    {
+        file_be_free(be);
+        return -RT_ENOMEM;
+    }
+
+    be->thread = rt_thread_create(name, file_be_thread_entry, be, ULOG_FILE_BE_THREAD_STACK,
+                                  ULOG_FILE_BE_THREAD_PRIORITY, 20);
+    if (be->thread == RT_NULL)
+    {
+        file_be_free(be);
+        return -RT_ENOMEM;
+    }
+    rt_event_init(&be->event, name, RT_IPC_FLAG_PRIO);
+    rt_mutex_init(&be->flush_lock, name, RT_IPC_FLAG_PRIO);
+    be->running = RT_TRUE;
+    rt_thread_startup(be->thread);
+
+    be->parent.output = file_be_output;
+    be->parent.flush = file_be_flush;
+    be->parent.deinit = file_be_deinit;
+    ulog_backend_register(&be->parent, name, RT_FALSE);
+
+    return RT_EOK;
+}
+
+/**
+ * write the lines so far and stop the backend
+ */
+rt_err_t ulog_file_backend_deinit(ulog_file_be_t be)
+{
+    RT_ASSERT(be);
+
+    return ulog_backend_unregister(&be->parent);
+}
+
+/**
+ * read the blocks of a log file
+ *
+ * @param path of the file
+ * @param read_cb gets the lines of every valid block, in the order of the file
+ * @param parameter of read_cb
+ * @param skipped the sectors that don't start a valid block, e.g. of a block cut by a power loss, or RT_NULL
+ *
+ * @return RT_EOK, -RT_ERROR when the file can't be opened, -RT_ENOMEM
+ */
+rt_err_t ulog_file_backend_read(const char *path, ulog_file_read_t read_cb, void *parameter, rt_uint32_t *skipped)
+{
+    struct file_be_block *block;
+    rt_uint8_t *lines = RT_NULL;
+    rt_size_t total, len;
+    rt_uint32_t bad = 0;
+    rt_err_t result = RT_EOK;
+    off_t pos = 0;
+    int fd;
+
+    RT_ASSERT(path);
+    RT_ASSERT(read_cb);
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return -RT_ERROR;
+
+    block = (struct file_be_block *)rt_malloc(FILE_BE_BLOCK_MAX);
+    lines = (rt_uint8_t *)rt_malloc(ULOG_FILE_BE_BLOCK_SIZE + 1);
+    if (block == RT_NULL || lines == RT_NULL)
+    {
+        result = -RT_ENOMEM;
+        goto __exit;
+    }
+
+    while (lseek(fd, pos, SEEK_SET) == pos && read(fd, block, FILE_BE_SECTOR) == FILE_BE_SECTOR)
+    {
+        /* the next sector unless a block starts here */
+        pos += FILE_BE_SECTOR;
+        if (block->magic != FILE_BE_MAGIC || block->raw_size == 0 || block->raw_size > ULOG_FILE_BE_BLOCK_SIZE ||
+            block->data_size > block->raw_size)
+        {
+            bad++;
+            continue;
+        }
+
+        total = RT_ALIGN(sizeof(struct file_be_block) + block->data_size, FILE_BE_SECTOR);
+        if ((total > FILE_BE_SECTOR &&
+             read(fd, (rt_uint8_t *)block + FILE_BE_SECTOR, total - FILE_BE_SECTOR) != (ssize_t)(total - FILE_BE_SECTOR)) ||
+            file_be_block_crc(block) != block->crc)
+        {
+            bad++;
+            continue;
+        }
+
+        if (block->data_size < block->raw_size)
+        {
+            len = lz4_decompress((rt_uint8_t *)(block + 1), block->data_size, lines, ULOG_FILE_BE_BLOCK_SIZE);
+        }
+        else
+        {
+            rt_memcpy(lines, block + 1, block->raw_size);
+            len = block->raw_size;
+        }
+        if (len != block->raw_size)
+        {
+            bad++;
+            continue;
+        }
+
+        pos += total - FILE_BE_SECTOR;
+        lines[len] = '\0';
+        read_cb(block->seq, (const char *)lines, len, parameter);
+    }
+
+__exit:
+    close(fd);
+    rt_free(block);
+    rt_free(lines);
+    if (skipped)
+        *skipped = bad;
+
+    return result;
+}
+
+#ifdef RT_USING_FINSH
+#include <finsh.h>
+
+static void file_be_cat_lines(rt_uint32_t seq, const char *lines, rt_size_t len, void *parameter)
+{
+    rt_kputs(lines);
+}
+
+static int ulog_file_cat(int argc, char **argv)
+{
+    rt_uint32_t skipped;
+
+    if (argc != 2)
+    {
+        rt_kprintf("usage: ulog_file_cat <file>\n");
+        return -1;
+    }
+
+    if (ulog_file_backend_read(argv[1], file_be_cat_lines, RT_NULL, &skipped) != RT_EOK)
+    {
+        rt_kprintf("can't read %s\n", argv[1]);
+        return -1;
+    }
+    if (skipped)
+        rt_kprintf("%u sectors skipped\n", skipped);
+
+    return 0;
+}
+MSH_CMD_EXPORT(ulog_file_cat, print a log file of the ulog file backend: ulog_file_cat <file>);
+#endif /* RT_USING_FINSH */
+
+#endif /* ULOG_BACKEND_USING_FILE */
@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Benchmark and self test of the ulog file backend.
+ *
+ * A FAT image in RAM is formatted and mounted, every sector read or written
+ * costs BENCH_SECTOR_US and every write request BENCH_WRITE_US more, like an
+ * SD card busy after a write. The same lines are written once by a write()
+ * per line with a sync every block, and once through the file backend, which
+ * rotates BENCH_FILES files of BENCH_FILE_SIZE bytes. The bench waits when
+ * both buffers of the backend are full, so its rate is the one of the writer.
+ *
+ * The self test reads the files back and checks the lines kept are the last
+ * ones in order. Then a block cut by a power loss is appended to the current
+ * file, the backend is started again on it and the lines read back skip the
+ * cut block only.
+ *
+ * msh: ulog_file_bench [lines]
+ */
+
+#include <rtthread.h>
+
+#ifdef ULOG_FILE_BE_USING_BENCH
+
+#include <stdlib.h>
+#include <ulog.h>
+#include <dfs.h>
+#include <dfs_fs.h>
+#include <dfs_file.h>
+#include <dfs_bench_disk.h>
+#include <unistd.h>
+
+#define BENCH_SECTORS           8192    /* 4 MB image */
+#define BENCH_SECTOR_US         100
+#define BENCH_WRITE_US          500
+#define BENCH_LINES             20000
+#define BENCH_AFTER_CUT         1000    /* lines written after the power loss */
+#define BENCH_FILE_SIZE         (64 * 1024)
+#define BENCH_FILES             4
+#define BENCH_NAME              "ulfbench"
+#define BENCH_MARK              "ulfbench #"
+
+struct bench_read
+{
+    rt_uint32_t first;
+    rt_uint32_t next;
+    rt_uint32_t lines;
+    rt_uint32_t gaps;
+};
+
+static struct dfs_bench_disk bench_disk;
+static struct ulog_file_be bench_be;
+static char bench_root[16];
+
+/* a line of a sensor log, the values change a little from line to line */
+static rt_size_t bench_line(char *line, rt_size_t size, rt_uint32_t n)
+{
+    static const char *const states[] = { "idle", "sampling", "sending" };
+
+    return rt_snprintf(line, size, "[%8u] I/sensor: " BENCH_MARK "%u temp=%d.%d C hum=%d%% vbat=%d mV state=%s\r\n",
+                       n * 7, n, 21 + n % 5, n % 10, 40 + n % 13, 3700 - n % 200, states[n / 16 % 3]);
+}
+
+static void bench_path(char *path, rt_size_t size, const char *name)
+{
+    rt_snprintf(path, size, "%s/%s", bench_root, name);
+}
+
+/* a write() and a line, a sync every block; returns the time in ms */
+static rt_uint32_t bench_write_lines(rt_uint32_t lines, rt_uint32_t *sectors)
+{
+    char line[ULOG_LINE_BUF_SIZE], path[32];
+    rt_uint32_t n, unsynced = 0;
+    rt_tick_t tick;
+    rt_size_t len;
+    int fd;
+
+    bench_path(path, sizeof(path), "lines.log");
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+    if (fd < 0)
+        return 0;
+
+    *sectors = bench_disk.writes;
+    tick = rt_tick_get();
+    for (n = 0; n < lines; n++)
+    {
+        len = bench_line(line, sizeof(line), n);
+        write(fd, line, len);
+        unsynced += len;
+        if (unsynced >= ULOG_FILE_BE_BLOCK_SIZE)
+        {
+            fsync(fd);
+            unsynced = 0;
+        }
+    }
+    close(fd);
+    tick = rt_tick_get() - tick;
+    *sectors = bench_disk.writes - *sectors;
+    unlink(path);
+
+    return tick * 1000 / RT_TICK_PER_SECOND;
+}
+
+/* the lines to the backend, numbered from `first`; returns the time in ms */
+static rt_uint32_t bench_backend_lines(rt_uint32_t first, rt_uint32_t lines, rt_uint32_t *sectors)
+{
+    char line[ULOG_LINE_BUF_SIZE];
+    rt_uint32_t n;
+    rt_tick_t tick;
+    rt_size_t len;
+
+    *sectors = bench_disk.writes;
+    tick = rt_tick_get();
+    for (n = first; n < first + lines; n++)
+    {
+        len = bench_line(line, sizeof(line), n);
+        /* as fast as the writer takes the blocks, no line is dropped */
+        while (bench_be.pending >= 0 && bench_be.len[bench_be.fill] + len > ULOG_FILE_BE_BLOCK_SIZE)
+            rt_thread_mdelay(1);
+        bench_be.parent.output(&bench_be.parent, LOG_LVL_INFO, "sensor", RT_FALSE, line, len);
+    }
+    bench_be.parent.flush(&bench_be.parent);
+    tick = rt_tick_get() - tick;
+    *sectors = bench_disk.writes - *sectors;
+
+    return tick * 1000 / RT_TICK_PER_SECOND;
+}
+
+/* the numbers of the bench lines follow each other, the other logs are skipped */
+static void bench_read_lines(rt_uint32_t seq, const char *lines, rt_size_t len, void *parameter)
+{
+    struct bench_read *back = (struct bench_read *)parameter;
+    const char *mark = lines;
+    rt_uint32_t n;
+
+    while ((mark = rt_strstr(mark, BENCH_MARK)) != RT_NULL)
+    {
+        mark += sizeof(BENCH_MARK) - 1;
+        n = strtoul(mark, RT_NULL, 10);
+        if (back->lines == 0)
+            back->first = n;
+        else if (n != back->next)
+            back->gaps++;
+        back->next = n + 1;
+        back->lines++;
+    }
+}
+
+/* read the files from the oldest one */
+static rt_bool_t bench_read_files(struct bench_read *back, rt_uint32_t *skipped, int *files)
+{
+    char name[24], path[40];
+    struct stat st;
+    rt_uint32_t bad;
+    int i;
+
+    rt_memset(back, 0, sizeof(struct bench_read));
+    *skipped = 0;
+    *files = 0;
+    for (i = BENCH_FILES; i >= 0; i--)
+    {
+        if (i == 0)
+            rt_snprintf(name, sizeof(name), "%s.ulz", BENCH_NAME);
+        else
+            rt_snprintf(name, sizeof(name), "%s_%d.ulz", BENCH_NAME, i);
+        bench_path(path, sizeof(path), name);
+        if (stat(path, &st) != 0)
+            continue;
+        /* one more file than kept */
+        if (i == BENCH_FILES)
+            return RT_FALSE;
+
+        if (ulog_file_backend_read(path, bench_read_lines, back, &bad) != RT_EOK)
+            return RT_FALSE;
+        *skipped += bad;
+        (*files)++;
+    }
+
+    return RT_TRUE;
+}
+
+/* append the first sector of a block that was being written, its crc doesn't match the rest */
+static rt_bool_t bench_cut_block(void)
+{
+    rt_uint8_t sector[DFS_BENCH_DISK_SECTOR_SIZE];
+    rt_uint32_t header[5] = { 0x425a4c55, 0xffff, ULOG_FILE_BE_BLOCK_SIZE, ULOG_FILE_BE_BLOCK_SIZE / 2, 0 };
+    char path[32];
+    rt_bool_t ok;
+    int fd, i;
+
+    for (i = 0; i < DFS_BENCH_DISK_SECTOR_SIZE; i++)
+        sector[i] = (rt_uint8_t)(i * 7);
+    rt_memcpy(sector, header, sizeof(header));
+
+    bench_path(path, sizeof(path), BENCH_NAME ".ulz");
+    fd = open(path, O_WRONLY);
+    if (fd < 0)
+        return RT_FALSE;
+    /* the size isn't aligned to a sector either */
+    ok = lseek(fd, 0, SEEK_END) >= 0 && write(fd, sector, sizeof(sector)) == (ssize_t)sizeof(sector) &&
+         write(fd, sector, 100) == 100;
+    close(fd);
+
+    return ok;
+}
+
+static rt_bool_t bench_check(const char *name, rt_bool_t ok)
+{
+    rt_kprintf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static void bench_remove_files(void)
+{
+    char name[24], path[40];
+    int i;
+
+    for (i = 0; i <= BENCH_FILES; i++)
+    {
+        if (i == 0)
+            rt_snprintf(name, sizeof(name), "%s.ulz", BENCH_NAME);
+        else
+            rt_snprintf(name, sizeof(name), "%s_%d.ulz", BENCH_NAME, i);
+        bench_path(path, sizeof(path), name);
+        unlink(path);
+    }
+}
+
+static int ulog_file_bench(int argc, char **argv)
+{
+    struct bench_read back;
+    rt_uint32_t lines = BENCH_LINES, sectors[2], ms[2], raw_bytes, skipped, dropped;
+    rt_bool_t made = RT_FALSE, ok = RT_TRUE;
+    int files;
+
+    if (argc > 1)
+    {
+        lines = atoi(argv[1]);
+        if (lines == 0)
+        {
+            rt_kprintf("usage: ulog_file_bench [lines]\n");
+            return -1;
+        }
+    }
+
+    if (dfs_bench_disk_create(&bench_disk, "ulfbd", BENCH_SECTORS) != RT_EOK)
+    {
+        rt_kprintf("no memory for the image of %d KB\n", BENCH_SECTORS * DFS_BENCH_DISK_SECTOR_SIZE / 1024);
+        return -RT_ENOMEM;
+    }
+    bench_disk.sector_us = BENCH_SECTOR_US;
+    bench_disk.write_us = BENCH_WRITE_US;
+    if (dfs_mkfs("elm", "ulfbd") != 0)
+    {
+        rt_kprintf("can't format the image\n");
+        dfs_bench_disk_delete(&bench_disk);
+        return -RT_ERROR;
+    }
+
+    /* mount on the root or on a directory of the root file system */
+    if (dfs_filesystem_lookup("/") == RT_NULL)
+    {
+        rt_strncpy(bench_root, "/", sizeof(bench_root));
+        ok = dfs_mount("ulfbd", "/", "elm", 0, RT_NULL) == 0;
+    }
+    else
+    {
+        rt_strncpy(bench_root, "/ulfbench", sizeof(bench_root));
+        made = mkdir(bench_root, 0) == 0;
+        ok = dfs_mount("ulfbd", bench_root, "elm", 0, RT_NULL) == 0;
+    }
+    if (!ok)
+    {
+        rt_kprintf("can't mount the image, RT_DFS_ELM_DRIVES is %d\n", RT_DFS_ELM_DRIVES);
+        if (made)
+            rmdir(bench_root);
+        dfs_bench_disk_delete(&bench_disk);
+        return -RT_ERROR;
+    }
+
+    ms[0] = bench_write_lines(lines, &sectors[0]);
+
+    if (ulog_file_backend_init(&bench_be, BENCH_NAME, bench_root, BENCH_FILE_SIZE, BENCH_FILES) != RT_EOK)
+    {
+        rt_kprintf("no memory for the file backend\n");
+        ok = RT_FALSE;
+        goto __exit;
+    }
+    ms[1] = bench_backend_lines(0, lines, &sectors[1]);
+    raw_bytes = bench_be.raw_bytes;
+    dropped = bench_be.dropped;
+    ok = bench_check("all blocks written", bench_be.lost == 0) && ok;
+    rt_kprintf("%d us a sector, %d us a write, %u lines of %u bytes\n", BENCH_SECTOR_US, BENCH_WRITE_US,
+               lines, raw_bytes / lines);
+    rt_kprintf("line by line: %6u ms, %5u KB/s, %5u sectors written\n", ms[0],
+               ms[0] ? raw_bytes / ms[0] * 1000 / 1024 : 0, sectors[0]);
+    rt_kprintf("file backend: %6u ms, %5u KB/s, %5u sectors written, %u.%u:1 compressed, %u lines dropped\n", ms[1],
+               ms[1] ? raw_bytes / ms[1] * 1000 / 1024 : 0, sectors[1],
+               raw_bytes / bench_be.written_bytes, raw_bytes * 10 / bench_be.written_bytes % 10, dropped);
+    ulog_file_backend_deinit(&bench_be);
+
+    /* the last lines are kept in order */
+    ok = bench_check("rotated files read back", bench_read_files(&back, &skipped, &files)) && ok;
+    ok = bench_check("last lines in order", back.lines > 0 && back.next == lines && back.gaps == 0 &&
+                     skipped == 0 && dropped == 0) && ok;
+    rt_kprintf("%u lines from %u in %d files\n", back.lines, back.first, files);
+
+    /* a power loss cut the block being written, the backend goes on after it */
+    ok = bench_check("cut block", bench_cut_block()) && ok;
+    if (ulog_file_backend_init(&bench_be, BENCH_NAME, bench_root, BENCH_FILE_SIZE, BENCH_FILES) != RT_EOK)
+    {
+        ok = RT_FALSE;
+        goto __exit;
+    }
+    bench_backend_lines(lines, BENCH_AFTER_CUT, &sectors[1]);
+    dropped = bench_be.dropped;
+    ulog_file_backend_deinit(&bench_be);
+    ok = bench_check("read back after the cut", bench_read_files(&back, &skipped, &files)) && ok;
+    ok = bench_check("only the cut block skipped", back.next == lines + BENCH_AFTER_CUT && back.gaps == 0 &&
+                     skipped > 0 && dropped == 0) && ok;
+
+__exit:
+    bench_remove_files();
+    dfs_unmount(bench_root);
+    if (made)
+        rmdir(bench_root);
+    dfs_bench_disk_delete(&bench_disk);
+
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(ulog_file_bench, ulog file backend test and benchmark: ulog_file_bench [lines]);
+
+#endif /* ULOG_FILE_BE_USING_BENCH */
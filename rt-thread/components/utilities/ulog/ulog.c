@@ -95,6 +95,12 @@ struct rt_ulog
     struct rt_semaphore async_notice;
 #endif
 
+#ifdef ULOG_USING_DEFERRED_FORMAT
+    /* the log of the deferred format being formatted, it has the tick and thread of the log call */
+    ulog_deferred_msg_t deferred_msg;
+    char deferred_text[ULOG_LINE_BUF_SIZE + 1];
+#endif
+
 #ifdef ULOG_USING_FILTER
     struct
     {
@@ -311,7 +317,11 @@ RT_WEAK rt_size_t ulog_formater(char *log_buf, rt_uint32_t level, const char *ta
         static rt_size_t tick_len = 0;
 
         log_buf[log_len] = '[';
+#ifdef ULOG_USING_DEFERRED_FORMAT
+        tick_len = ulog_ultoa(log_buf + log_len + 1, ulog.deferred_msg ? ulog.deferred_msg->tick : rt_tick_get());
+#else
         tick_len = ulog_ultoa(log_buf + log_len + 1, rt_tick_get());
+#endif
         log_buf[log_len + 1 + tick_len] = ']';
         log_buf[log_len + 1 + tick_len + 1] = '\0';
 #endif /* ULOG_TIME_USING_TIMESTAMP */
@@ -348,6 +358,14 @@ RT_WEAK rt_size_t ulog_formater(char *log_buf, rt_uint32_t level, const char *ta
         log_len += ulog_strcpy(log_len, log_buf + log_len, " ");
 #endif
 
+#ifdef ULOG_USING_DEFERRED_FORMAT
+        if (ulog.deferred_msg)
+        {
+            log_len += ulog_strcpy(log_len, log_buf + log_len,
+                    ulog.deferred_msg->is_isr ? "ISR" : ulog.deferred_msg->thread_name);
+        }
+        else
+#endif /* ULOG_USING_DEFERRED_FORMAT */
         /* is not in interrupt context */
         if (rt_interrupt_get_nest() == 0)
         {
@@ -588,6 +606,15 @@ void ulog_voutput(rt_uint32_t level, const char *tag, rt_bool_t newline, const c
     }
 #endif /* ULOG_USING_FILTER */
 
+#ifdef ULOG_USING_DEFERRED_FORMAT
+    /* store the format and the arguments without a lock, the async output formats them */
+    if (ulog.async_enabled && ulog_deferred_voutput(level, tag, newline, format, args))
+    {
+        rt_sem_release(&ulog.async_notice);
+        return;
+    }
+#endif /* ULOG_USING_DEFERRED_FORMAT */
+
     /* get log buffer */
     log_buf = get_log_buf();
 
@@ -1369,6 +1396,58 @@ ulog_backend_t ulog_backend_find(const char *name)
  *
  * @note you must call this function when ULOG_ASYNC_OUTPUT_BY_THREAD is disable
  */
+#ifdef ULOG_USING_DEFERRED_FORMAT
+static rt_size_t deferred_formater(char *log_buf, ulog_deferred_msg_t msg, const char *format, ...)
+{
+    rt_size_t log_len;
+    va_list args;
+
+    va_start(args, format);
+    log_len = ulog_formater(log_buf, msg->level, msg->tag, msg->newline, format, args);
+    va_end(args);
+
+    return log_len;
+}
+
+/* format the logs of the deferred format and output them to all backends */
+static void deferred_output(void)
+{
+    struct ulog_deferred_msg msg;
+    rt_size_t log_len;
+
+    while (1)
+    {
+        /* a log at a time, the callers formatting their logs wait for the lock */
+        output_lock();
+        if (!ulog_deferred_get(&msg, ulog.deferred_text, sizeof(ulog.deferred_text)))
+        {
+            output_unlock();
+            break;
+        }
+
+        ulog.deferred_msg = &msg;
+        log_len = deferred_formater(ulog.log_buf_th, &msg, "%s", msg.text);
+        ulog.deferred_msg = RT_NULL;
+
+#ifdef ULOG_USING_FILTER
+        /* keyword filter */
+        if (ulog.filter.keyword[0] != '\0')
+        {
+            ulog.log_buf_th[log_len] = '\0';
+            if (!rt_strstr(ulog.log_buf_th, ulog.filter.keyword))
+            {
+                output_unlock();
+                continue;
+            }
+        }
+#endif /* ULOG_USING_FILTER */
+
+        ulog_output_to_all_backend(msg.level, msg.tag, RT_FALSE, ulog.log_buf_th, log_len);
+        output_unlock();
+    }
+}
+#endif /* ULOG_USING_DEFERRED_FORMAT */
+
 void ulog_async_output(void)
 {
     rt_rbb_blk_t log_blk;
@@ -1379,6 +1458,10 @@ void ulog_async_output(void)
         return;
     }
 
+#ifdef ULOG_USING_DEFERRED_FORMAT
+    deferred_output();
+#endif
+
     while ((log_blk = rt_rbb_blk_get(ulog.async_rbb)) != RT_NULL)
     {
         log_frame = (ulog_frame_t) log_blk->buf;
@@ -1489,6 +1572,9 @@ int ulog_init(void)
         return -RT_ENOMEM;
     }
     rt_sem_init(&ulog.async_notice, "ulog", 0, RT_IPC_FLAG_FIFO);
+#ifdef ULOG_USING_DEFERRED_FORMAT
+    ulog_deferred_init();
+#endif
 #endif /* ULOG_USING_ASYNC_OUTPUT */
 
 #ifdef ULOG_USING_FILTER
@@ -84,6 +84,27 @@ void ulog_async_output_enabled(rt_bool_t enabled);
 void ulog_async_waiting_log(rt_int32_t time);
 #endif
 
+#ifdef ULOG_USING_DEFERRED_FORMAT
+/*
+ * deferred format API, the async output formats the logs
+ */
+void ulog_deferred_init(void);
+void ulog_deferred_format_enabled(rt_bool_t enabled);
+rt_uint32_t ulog_deferred_dropped(void);
+rt_bool_t ulog_deferred_voutput(rt_uint32_t level, const char *tag, rt_bool_t newline, const char *format, va_list args);
+rt_bool_t ulog_deferred_get(ulog_deferred_msg_t msg, char *text, rt_size_t text_size);
+#endif
+
+#ifdef ULOG_BACKEND_USING_FILE
+/*
+ * file backend API
+ */
+rt_err_t ulog_file_backend_init(ulog_file_be_t be, const char *name, const char *dir, rt_uint32_t file_size,
+                                rt_uint16_t file_max);
+rt_err_t ulog_file_backend_deinit(ulog_file_be_t be);
+rt_err_t ulog_file_backend_read(const char *path, ulog_file_read_t read_cb, void *parameter, rt_uint32_t *skipped);
+#endif
+
 /*
  * dump the hex format data to log
  */
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Test and benchmark of the deferred format of ulog.
+ *
+ * Logs of various formats go through the deferred format to a backend of
+ * the bench, which checks their text against rt_snprintf, also for a string
+ * changed after the log call and for a log from a hard timer, i.e. an ISR.
+ * Then the time of a log call is printed with the deferred format and with
+ * the format by the caller, the async output as before the deferred format.
+ * The console backend is muted meanwhile.
+ *
+ * msh: ulog_bench [logs]
+ */
+
+#include <rtthread.h>
+
+#ifdef ULOG_DEFERRED_USING_BENCH
+
+#include <stdlib.h>
+#include <ulog.h>
+
+#ifdef RT_USING_CPUTIME
+#include <rtdevice.h>
+#define BENCH_STAMP()               ((rt_uint32_t)clock_cpu_gettime())
+#define BENCH_STAMP_TO_US(stamp)    ((rt_uint32_t)clock_cpu_microsecond(stamp))
+#else
+#define BENCH_STAMP()               ((rt_uint32_t)rt_tick_get())
+#define BENCH_STAMP_TO_US(stamp)    ((stamp) * (1000000 / RT_TICK_PER_SECOND))
+#endif
+
+#define BENCH_TAG           "ulbench"
+#define BENCH_LOGS          4096
+#define BENCH_BATCH         16
+#define BENCH_CASES         10
+
+static struct
+{
+    struct ulog_backend backend;
+    char expected[BENCH_CASES][ULOG_LINE_BUF_SIZE];
+    char line[BENCH_CASES][ULOG_LINE_BUF_SIZE + 1];
+    int cases;
+    int lines;
+    rt_uint32_t outputs;
+} bench;
+
+static rt_bool_t bench_check(const char *name, rt_bool_t ok)
+{
+    rt_kprintf("%-32s %s\n", name, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static void bench_backend_output(struct ulog_backend *backend, rt_uint32_t level, const char *tag, rt_bool_t is_raw,
+                                 const char *log, rt_size_t len)
+{
+    if (tag == RT_NULL || rt_strcmp(tag, BENCH_TAG) != 0)
+        return;
+
+    bench.outputs ++;
+    if (bench.lines < BENCH_CASES)
+    {
+        len = len < ULOG_LINE_BUF_SIZE ? len : ULOG_LINE_BUF_SIZE;
+        rt_memcpy(bench.line[bench.lines], log, len);
+        bench.line[bench.lines][len] = '\0';
+        bench.lines ++;
+    }
+}
+
+/* log it deferred and keep the text of rt_snprintf */
+#define BENCH_CASE(...)                                                                         \
+    do                                                                                          \
+    {                                                                                           \
+        rt_snprintf(bench.expected[bench.cases++], ULOG_LINE_BUF_SIZE, __VA_ARGS__);            \
+        ulog_output(LOG_LVL_INFO, BENCH_TAG, RT_TRUE, __VA_ARGS__);                             \
+    } while (0)
+
+static void bench_isr_timeout(void *parameter)
+{
+    BENCH_CASE("isr %d %s", 99, "in timer");
+}
+
+/* the deferred logs read like the ones of rt_snprintf */
+static rt_bool_t bench_render(void)
+{
+    struct rt_timer timer;
+    char name[12];
+    rt_bool_t ok = RT_TRUE;
+    int i;
+
+    bench.cases = 0;
+    bench.lines = 0;
+
+    BENCH_CASE("int %d %i %u %x %X %o %c", -5, 42, 3000000000u, 0xbeef, 0xBEEF, 8, 'z');
+    BENCH_CASE("long %ld %lu %lx", -100000L, 100000UL, 0x1234abcdL);
+    BENCH_CASE("width %5d|%-5d|%05d|%*d|%.*s", 1, 2, 3, 6, 4, 3, "abcdef");
+    BENCH_CASE("str %s %10s %-4s| %s", "hello", "right", "l", "");
+    BENCH_CASE("ptr %p, 100%% %d", (void *)0x1234, 7);
+    BENCH_CASE("no argument");
+
+    /* the string is copied at the log call */
+    rt_strncpy(name, "before", sizeof(name));
+    BENCH_CASE("copied %s", name);
+    rt_strncpy(name, "after", sizeof(name));
+
+    rt_timer_init(&timer, "ulbench", bench_isr_timeout, RT_NULL, 1,
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_start(&timer);
+    rt_thread_mdelay(5);
+    rt_timer_detach(&timer);
+
+    ulog_flush();
+
+    ok = bench.lines == bench.cases;
+    for (i = 0; i < bench.lines && i < bench.cases; i++)
+    {
+        if (rt_strstr(bench.line[i], bench.expected[i]) == RT_NULL)
+        {
+            rt_kprintf("got \"%s\", expected \"%s\"\n", bench.line[i], bench.expected[i]);
+            ok = RT_FALSE;
+        }
+    }
+
+    return bench_check("deferred format", ok);
+}
+
+/* the arguments that don't fit in a record are left out */
+static rt_bool_t bench_truncate(void)
+{
+    static char text[ULOG_LINE_BUF_SIZE];
+    rt_bool_t ok;
+
+    rt_memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    bench.lines = 0;
+    ulog_output(LOG_LVL_INFO, BENCH_TAG, RT_FALSE, "%s %d %s", text, 5, text);
+    ulog_flush();
+
+    ok = bench.lines == 1 && rt_strstr(bench.line[0], "xxxxxxxx") != RT_NULL;
+    return bench_check("truncated record", ok);
+}
+
+/* the time per log call, flushed by batches so the buffers don't overflow */
+static rt_uint32_t bench_time(rt_uint32_t logs)
+{
+    rt_uint32_t stamp, total = 0, i;
+
+    for (i = 0; i < logs; i++)
+    {
+        stamp = BENCH_STAMP();
+        ulog_output(LOG_LVL_INFO, BENCH_TAG, RT_TRUE, "frame %d took %u us on %s", i, i * 3, "lvgl");
+        total += BENCH_STAMP() - stamp;
+
+        if ((i + 1) % BENCH_BATCH == 0)
+            ulog_flush();
+    }
+    ulog_flush();
+
+    return BENCH_STAMP_TO_US(total) * 1000 / logs;
+}
+
+static int ulog_bench(int argc, char **argv)
+{
+    rt_uint32_t logs = BENCH_LOGS, dropped, outputs;
+    rt_uint32_t deferred_ns, caller_ns;
+    ulog_backend_t console;
+    rt_uint32_t console_level = 0;
+    rt_bool_t ok = RT_TRUE;
+
+    if (argc > 1)
+    {
+        logs = atoi(argv[1]);
+        if (logs == 0)
+        {
+            rt_kprintf("usage: ulog_bench [logs]\n");
+            return -1;
+        }
+    }
+
+    console = ulog_backend_find("console");
+    if (console)
+    {
+        console_level = console->out_level;
+        console->out_level = LOG_FILTER_LVL_SILENT;
+    }
+    bench.backend.output = bench_backend_output;
+    ulog_backend_register(&bench.backend, "ulbench", RT_FALSE);
+
+    ok = bench_render() && ok;
+    ok = bench_truncate() && ok;
+
+    dropped = ulog_deferred_dropped();
+    bench.outputs = 0;
+    deferred_ns = bench_time(logs);
+    outputs = bench.outputs;
+    dropped = ulog_deferred_dropped() - dropped;
+
+    ulog_deferred_format_enabled(RT_FALSE);
+    caller_ns = bench_time(logs);
+    ulog_deferred_format_enabled(RT_TRUE);
+
+    ulog_backend_unregister(&bench.backend);
+    if (console)
+        console->out_level = console_level;
+
+    ok = bench_check("no log lost", outputs == logs && dropped == 0) && ok;
+    rt_kprintf("log call: deferred format %u ns, caller format %u ns (%u logs)\n", deferred_ns, caller_ns, logs);
+
+    rt_kprintf("%s\n", ok ? "PASS" : "FAIL");
+    return 0;
+}
+MSH_CMD_EXPORT(ulog_bench, ulog deferred format test and benchmark: ulog_bench [logs]);
+
+#endif /* ULOG_DEFERRED_USING_BENCH */
@@ -199,6 +199,20 @@ struct ulog_frame
 };
 typedef struct ulog_frame *ulog_frame_t;
 
+/* a log of the deferred format, rendered by the async output */
+struct ulog_deferred_msg
+{
+    rt_uint32_t level;
+    rt_bool_t newline;
+    rt_bool_t is_isr;
+    rt_tick_t tick;
+    const char *tag;
+    char thread_name[RT_NAME_MAX + 1];
+    char *text;
+    rt_size_t text_len;
+};
+typedef struct ulog_deferred_msg *ulog_deferred_msg_t;
+
 struct ulog_backend
 {
     char name[RT_NAME_MAX];
@@ -215,6 +229,43 @@ struct ulog_backend
 typedef struct ulog_backend *ulog_backend_t;
 typedef rt_bool_t (*ulog_backend_filter_t)(struct ulog_backend *backend, rt_uint32_t level, const char *tag, rt_bool_t is_raw, const char *log, rt_size_t len);
 
+#ifdef ULOG_BACKEND_USING_FILE
+/* the file backend, the lines are written in compressed blocks to rotated files */
+struct ulog_file_be
+{
+    struct ulog_backend parent;
+    const char *dir;
+    const char *name;
+    rt_uint32_t file_size;             /* the file is rotated when it reaches it */
+    rt_uint16_t file_max;              /* the files kept, <name>.ulz and <name>_1.ulz up to <name>_<file_max - 1>.ulz */
+    rt_bool_t running;
+
+    rt_uint8_t *buf[2];                /* the lines, filled in turns */
+    rt_uint32_t len[2];
+    rt_int8_t fill;                    /* the buffer of the output */
+    rt_int8_t pending;                 /* the full buffer for the writer, -1: none */
+    rt_uint8_t *block;                 /* the block written, padded to sectors */
+    rt_uint16_t *hash;                 /* of the compressor */
+    int fd;
+    rt_uint32_t file_pos;
+    rt_uint32_t seq;
+    struct rt_event event;
+    struct rt_mutex flush_lock;
+    rt_thread_t thread;
+
+    /* statistics */
+    rt_uint32_t lines;
+    rt_uint32_t dropped;               /* lines, both buffers were full */
+    rt_uint32_t lost;                  /* blocks the file system didn't take */
+    rt_uint32_t blocks;
+    rt_uint32_t raw_bytes;
+    rt_uint32_t written_bytes;         /* with the headers and the padding */
+};
+typedef struct ulog_file_be *ulog_file_be_t;
+/* gets the lines of a block of a log file */
+typedef void (*ulog_file_read_t)(rt_uint32_t seq, const char *lines, rt_size_t len, void *parameter);
+#endif /* ULOG_BACKEND_USING_FILE */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,626 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <stdarg.h>
+#include <rthw.h>
+#include "ulog.h"
+
+#ifdef ULOG_USING_DEFERRED_FORMAT
+
+/*
+ * Deferred format: a log call stores the tag and format pointers and the raw
+ * arguments in a binary record and returns, the async output thread renders
+ * the record later. The format is only scanned for the kinds of the
+ * arguments on the caller side, the strings of %s are copied as they may
+ * not live until the output.
+ *
+ * There is a ring per CPU. The producers, threads and ISRs, reserve a
+ * record with a compare and swap of the head, write it and publish it with
+ * a release store of its first word. The consumer stops at a record whose
+ * first word is still zero, it clears the records it has read so the free
+ * space is always zero.
+ *
+ * A record, aligned to the size of a pointer:
+ *
+ *   info     the size of the record in bytes (bits 0-15), the level (bits 16-23)
+ *            and DEFER_FLAG_* (bits 24-31), written last
+ *   tick     of the log call
+ *   tag      pointer to the tag
+ *   format   pointer to the format
+ *   thread   RT_NAME_MAX bytes of the name of the calling thread, with ULOG_OUTPUT_THREAD_NAME
+ *   args     in the order of the format, each aligned to the size of a pointer: int, long and
+ *            pointers by their size, long long and double by 8 bytes, a string by a 16 bit
+ *            length, its bytes and a '\0'. The arguments that don't fit are left out.
+ *
+ * rt-thread/tools/ulog_decode.py renders a memory dump of ulog_deferred_rings
+ * with the ELF of the firmware, e.g. the logs not output yet at a crash.
+ */
+
+#ifndef ULOG_USING_ASYNC_OUTPUT
+#error "the deferred format (ULOG_USING_DEFERRED_FORMAT) needs the async output (ULOG_USING_ASYNC_OUTPUT)"
+#endif
+
+#if ULOG_DEFERRED_BUF_SIZE & (ULOG_DEFERRED_BUF_SIZE - 1)
+#error "the deferred format buffer size (ULOG_DEFERRED_BUF_SIZE) must be a power of two"
+#endif
+
+#if ULOG_DEFERRED_BUF_SIZE < 4 * ULOG_LINE_BUF_SIZE
+#error "the deferred format buffer size (ULOG_DEFERRED_BUF_SIZE) must be more than 4 log lines"
+#endif
+
+#ifdef RT_USING_SMP
+#define DEFER_RINGS                    RT_CPUS_NR
+#define DEFER_CPU_ID()                 rt_hw_cpu_id()
+#else
+#define DEFER_RINGS                    1
+#define DEFER_CPU_ID()                 0
+#endif
+
+#define DEFER_RING_MAGIC               0x52444c55 /* "ULDR" */
+#define DEFER_ALIGN(size)              RT_ALIGN(size, sizeof(void *))
+#define DEFER_RECORD_MAX               DEFER_ALIGN(ULOG_LINE_BUF_SIZE + sizeof(struct defer_record))
+
+#define DEFER_FLAG_NEWLINE             0x01
+#define DEFER_FLAG_ISR                 0x02
+#define DEFER_FLAG_PAD                 0x04 /* fills the end of the buffer, no log */
+
+#define DEFER_INFO(size, level, flags) ((rt_uint32_t)(size) | ((rt_uint32_t)(level) << 16) | ((rt_uint32_t)(flags) << 24))
+#define DEFER_INFO_SIZE(info)          ((info) & 0xffff)
+#define DEFER_INFO_LEVEL(info)         (((info) >> 16) & 0xff)
+#define DEFER_INFO_FLAGS(info)         ((info) >> 24)
+
+#if defined(__GNUC__)
+#define DEFER_LOAD_ACQUIRE(p)          __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define DEFER_STORE_RELEASE(p, v)      __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#define DEFER_CAS(p, old, new)         __atomic_compare_exchange_n(p, old, new, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#define DEFER_ADD(p, v)                __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+#else
+/* without the GNU atomics a short interrupt lock does it on a single core */
+static rt_uint32_t defer_load_acquire(volatile rt_uint32_t *p)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_uint32_t value = *p;
+
+    rt_hw_interrupt_enable(level);
+    return value;
+}
+
+static void defer_store_release(volatile rt_uint32_t *p, rt_uint32_t value)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    *p = value;
+    rt_hw_interrupt_enable(level);
+}
+
+static rt_bool_t defer_cas(volatile rt_uint32_t *p, rt_uint32_t *old, rt_uint32_t new)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    rt_bool_t ok = (*p == *old);
+
+    if (ok)
+        *p = new;
+    else
+        *old = *p;
+    rt_hw_interrupt_enable(level);
+    return ok;
+}
+
+static void defer_add(volatile rt_uint32_t *p, rt_uint32_t value)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+
+    *p += value;
+    rt_hw_interrupt_enable(level);
+}
+
+#define DEFER_LOAD_ACQUIRE(p)          defer_load_acquire(p)
+#define DEFER_STORE_RELEASE(p, v)      defer_store_release(p, v)
+#define DEFER_CAS(p, old, new)         defer_cas(p, old, new)
+#define DEFER_ADD(p, v)                defer_add(p, v)
+#endif
+
+/* the kinds of the arguments */
+enum
+{
+    DEFER_ARG_NONE,
+    DEFER_ARG_INT,
+    DEFER_ARG_LONG,
+    DEFER_ARG_LLONG,
+    DEFER_ARG_PTR,
+    DEFER_ARG_DOUBLE,
+    DEFER_ARG_STR,
+};
+
+struct defer_record
+{
+    rt_uint32_t info;
+    rt_tick_t tick;
+    const char *tag;
+    const char *format;
+#ifdef ULOG_OUTPUT_THREAD_NAME
+    char thread[RT_NAME_MAX];
+#endif
+};
+
+struct defer_ring
+{
+    rt_uint32_t magic;
+    rt_uint8_t pointer_size;           /* for the decoder */
+    rt_uint8_t long_size;
+    rt_uint16_t record_size;           /* of struct defer_record, the arguments follow */
+    rt_uint32_t size;
+    volatile rt_uint32_t head;         /* reserved by the producers */
+    volatile rt_uint32_t tail;         /* released by the consumer */
+    volatile rt_uint32_t dropped;      /* of the logs that didn't fit */
+    rt_uint8_t buf[ULOG_DEFERRED_BUF_SIZE];
+};
+
+/* not static, a debugger dumps it for ulog_decode.py */
+struct defer_ring ulog_deferred_rings[DEFER_RINGS];
+static rt_bool_t defer_enabled = RT_TRUE;
+
+/**
+ * The next conversion of the format.
+ *
+ * @param format points past the '%'
+ * @param stars the number of the '*' of the width and the precision, int arguments before its argument
+ * @param kind DEFER_ARG_NONE for a '%%' or an unknown conversion
+ *
+ * @return the format past the conversion
+ */
+static const char *defer_parse(const char *format, int *stars, int *kind)
+{
+    int longs = 0;
+
+    *stars = 0;
+
+    /* flags */
+    while (*format == '-' || *format == '+' || *format == ' ' || *format == '#' || *format == '0')
+        format++;
+    /* width */
+    if (*format == '*')
+    {
+        (*stars)++;
+        format++;
+    }
+    while (*format >= '0' && *format <= '9')
+        format++;
+    /* precision */
+    if (*format == '.')
+    {
+        format++;
+        if (*format == '*')
+        {
+            (*stars)++;
+            format++;
+        }
+        while (*format >= '0' && *format <= '9')
+            format++;
+    }
+    /* length */
+    while (1)
+    {
+        if (*format == 'l' || *format == 'z' || *format == 't')
+            longs++;
+        else if (*format == 'L' || *format == 'q' || *format == 'j')
+            longs += 2;
+        else if (*format != 'h')
+            break;
+        format++;
+    }
+
+    switch (*format)
+    {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        *kind = longs == 0 ? DEFER_ARG_INT : (longs == 1 ? DEFER_ARG_LONG : DEFER_ARG_LLONG);
+        break;
+    case 'p': case 'n':
+        *kind = DEFER_ARG_PTR;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *kind = DEFER_ARG_DOUBLE;
+        break;
+    case 's':
+        *kind = DEFER_ARG_STR;
+        break;
+    case '\0':
+        *kind = DEFER_ARG_NONE;
+        return format;
+    default:
+        *kind = DEFER_ARG_NONE;
+        break;
+    }
+
+    return format + 1;
+}
+
+/* store the arguments of the format, return their size, up to the first one that doesn't fit */
+static rt_size_t defer_encode(rt_uint8_t *buf, rt_size_t size, const char *format, va_list args)
+{
+    rt_size_t len = 0, str_len;
+    int stars, kind;
+    const char *str;
+    union
+    {
+        int i;
+        long l;
+        long long ll;
+        void *p;
+        double d;
+    } value;
+    rt_size_t value_size;
+
+    while (*format)
+    {
+        if (*format++ != '%')
+            continue;
+        if (*format == '%')
+        {
+            format++;
+            continue;
+        }
+
+        format = defer_parse(format, &stars, &kind);
+        while (stars--)
+        {
+            if (len + DEFER_ALIGN(sizeof(int)) > size)
+                return len;
+            value.i = va_arg(args, int);
+            rt_memcpy(buf + len, &value.i, sizeof(int));
+            len += DEFER_ALIGN(sizeof(int));
+        }
+
+        switch (kind)
+        {
+        case DEFER_ARG_INT:
+            value.i = va_arg(args, int);
+            value_size = sizeof(int);
+            break;
+        case DEFER_ARG_LONG:
+            value.l = va_arg(args, long);
+            value_size = sizeof(long);
+            break;
+        case DEFER_ARG_LLONG:
+            value.ll = va_arg(args, long long);
+            value_size = sizeof(long long);
+            break;
+        case DEFER_ARG_PTR:
+            value.p = va_arg(args, void *);
+            value_size = sizeof(void *);
+            break;
+        case DEFER_ARG_DOUBLE:
+            value.d = va_arg(args, double);
+            value_size = sizeof(double);
+            break;
+        case DEFER_ARG_STR:
+            str = va_arg(args, const char *);
+            if (str == RT_NULL)
+                str = "(null)";
+            if (len + DEFER_ALIGN(sizeof(rt_uint16_t) + 1) > size)
+                return len;
+            /* as much of it as fits */
+            str_len = rt_strnlen(str, size - len - sizeof(rt_uint16_t) - 1);
+            *(rt_uint16_t *)(buf + len) = (rt_uint16_t)str_len;
+            rt_memcpy(buf + len + sizeof(rt_uint16_t), str, str_len);
+            buf[len + sizeof(rt_uint16_t) + str_len] = '\0';
+            len += DEFER_ALIGN(sizeof(rt_uint16_t) + str_len + 1);
+            continue;
+        default:
+            continue;
+        }
+
+        if (len + DEFER_ALIGN(value_size) > size)
+            return len;
+        rt_memcpy(buf + len, &value, value_size);
+        len += DEFER_ALIGN(value_size);
+    }
+
+    return len;
+}
+
+/* reserve a record of `size` bytes, past a pad record at the end of the buffer */
+static struct defer_record *defer_reserve(struct defer_ring *ring, rt_uint32_t size)
+{
+    rt_uint32_t head, tail, pos, pad;
+
+    head = ring->head;
+    do
+    {
+        tail = DEFER_LOAD_ACQUIRE(&ring->tail);
+        pos = head & (ring->size - 1);
+        pad = ring->size - pos < size ? ring->size - pos : 0;
+        if (head + pad + size - tail > ring->size)
+        {
+            DEFER_ADD(&ring->dropped, 1);
+            return RT_NULL;
+        }
+    } while (!DEFER_CAS(&ring->head, &head, head + pad + size));
+
+    if (pad)
+    {
+        DEFER_STORE_RELEASE((rt_uint32_t *)&ring->buf[pos], DEFER_INFO(pad, 0, DEFER_FLAG_PAD));
+        pos = 0;
+    }
+
+    return (struct defer_record *)&ring->buf[pos];
+}
+
+/**
+ * store a log in the ring of the current CPU
+ *
+ * @return RT_FALSE when the deferred format is disabled, the caller formats the log
+ */
+rt_bool_t ulog_deferred_voutput(rt_uint32_t level, const char *tag, rt_bool_t newline, const char *format, va_list args)
+{
+    union
+    {
+        struct defer_record record;
+        rt_uint8_t buf[DEFER_RECORD_MAX];
+    } stage;
+    struct defer_ring *ring;
+    struct defer_record *record;
+    rt_size_t args_len, size;
+    rt_uint8_t flags = newline ? DEFER_FLAG_NEWLINE : 0;
+
+    if (!defer_enabled)
+        return RT_FALSE;
+
+    ring = &ulog_deferred_rings[DEFER_CPU_ID()];
+    if (ring->magic != DEFER_RING_MAGIC)
+        return RT_FALSE;
+
+    /* the arguments are copied once to the stack, then the record once to the ring */
+    args_len = defer_encode(stage.buf + sizeof(struct defer_record), sizeof(stage) - sizeof(struct defer_record),
+                            format, args);
+    size = sizeof(struct defer_record) + args_len;
+
+    stage.record.tick = rt_tick_get();
+    stage.record.tag = tag;
+    stage.record.format = format;
+#ifdef ULOG_OUTPUT_THREAD_NAME
+    if (rt_interrupt_get_nest() == 0 && rt_thread_self() != RT_NULL)
+        rt_strncpy(stage.record.thread, rt_thread_self()->name, RT_NAME_MAX);
+    else
+        rt_memset(stage.record.thread, 0, RT_NAME_MAX);
+#endif
+    if (rt_interrupt_get_nest() != 0)
+        flags |= DEFER_FLAG_ISR;
+
+    record = defer_reserve(ring, size);
+    if (record == RT_NULL)
+        return RT_TRUE;
+
+    /* the info word is zero until it is published */
+    rt_memcpy((rt_uint8_t *)record + sizeof(rt_uint32_t), stage.buf + sizeof(rt_uint32_t),
+              size - sizeof(rt_uint32_t));
+    DEFER_STORE_RELEASE(&record->info, DEFER_INFO(size, level, flags));
+
+    return RT_TRUE;
+}
+
+/* render the format of the record with its arguments */
+static rt_size_t defer_render(struct defer_record *record, char *text, rt_size_t text_size)
+{
+    const rt_uint8_t *args = (const rt_uint8_t *)record + sizeof(struct defer_record);
+    const rt_uint8_t *args_end = (const rt_uint8_t *)record + DEFER_INFO_SIZE(record->info);
+    const char *format = record->format, *conv;
+    char spec[16];
+    rt_size_t len = 0, spec_len, room, value_size;
+    int stars, kind, star[2], n, i;
+    union
+    {
+        int i;
+        long l;
+        long long ll;
+        void *p;
+        double d;
+    } value;
+
+    RT_ASSERT(text_size > 0);
+
+    while (*format && len < text_size - 1)
+    {
+        if (*format != '%')
+        {
+            text[len++] = *format++;
+            continue;
+        }
+        if (format[1] == '%')
+        {
+            text[len++] = '%';
+            format += 2;
+            continue;
+        }
+
+        conv = format;
+        format = defer_parse(format + 1, &stars, &kind);
+        spec_len = format - conv;
+        if (kind == DEFER_ARG_NONE || spec_len >= sizeof(spec))
+            continue;
+        rt_memcpy(spec, conv, spec_len);
+        spec[spec_len] = '\0';
+
+        for (i = 0; i < stars; i++)
+        {
+            if (args + DEFER_ALIGN(sizeof(int)) > args_end)
+                goto __truncated;
+            rt_memcpy(&star[i], args, sizeof(int));
+            args += DEFER_ALIGN(sizeof(int));
+        }
+
+        switch (kind)
+        {
+        case DEFER_ARG_INT:
+            value_size = sizeof(int);
+            break;
+        case DEFER_ARG_LONG:
+            value_size = sizeof(long);
+            break;
+        case DEFER_ARG_LLONG:
+            value_size = sizeof(long long);
+            break;
+        case DEFER_ARG_PTR:
+            value_size = sizeof(void *);
+            break;
+        case DEFER_ARG_DOUBLE:
+            value_size = sizeof(double);
+            break;
+        default:
+            if (args + DEFER_ALIGN(sizeof(rt_uint16_t) + 1) > args_end)
+                goto __truncated;
+            value_size = sizeof(rt_uint16_t) + *(const rt_uint16_t *)args + 1;
+            value.p = (void *)(args + sizeof(rt_uint16_t));
+            break;
+        }
+        if (args + DEFER_ALIGN(value_size) > args_end)
+            goto __truncated;
+        if (kind != DEFER_ARG_STR)
+            rt_memcpy(&value, args, value_size);
+        args += DEFER_ALIGN(value_size);
+        /* nothing is written through a pointer of the record */
+        if (format[-1] == 'n')
+            continue;
+
+        room = text_size - len;
+#define DEFER_SNPRINTF(v) (stars == 0 ? rt_snprintf(text + len, room, spec, v) : \
+                          (stars == 1 ? rt_snprintf(text + len, room, spec, star[0], v) : \
+                                        rt_snprintf(text + len, room, spec, star[0], star[1], v)))
+        switch (kind)
+        {
+        case DEFER_ARG_INT:
+            n = DEFER_SNPRINTF(value.i);
+            break;
+        case DEFER_ARG_LONG:
+            n = DEFER_SNPRINTF(value.l);
+            break;
+        case DEFER_ARG_LLONG:
+            n = DEFER_SNPRINTF(value.ll);
+            break;
+        case DEFER_ARG_DOUBLE:
+            n = DEFER_SNPRINTF(value.d);
+            break;
+        default:
+            n = DEFER_SNPRINTF(value.p);
+            break;
+        }
+#undef DEFER_SNPRINTF
+        if (n > 0)
+            len += (rt_size_t)n < room ? (rt_size_t)n : room - 1;
+    }
+    text[len] = '\0';
+    return len;
+
+__truncated:
+    /* the arguments that didn't fit in the record */
+    len += rt_snprintf(text + len, text_size - len, "...");
+    if (len >= text_size)
+        len = text_size - 1;
+    return len;
+}
+
+/**
+ * get the next log of the rings, rendered into `text`, and release its record
+ *
+ * @return RT_FALSE when there is no log
+ */
+rt_bool_t ulog_deferred_get(ulog_deferred_msg_t msg, char *text, rt_size_t text_size)
+{
+    struct defer_ring *ring;
+    struct defer_record *record;
+    rt_uint32_t tail, info;
+    int cpu;
+
+    for (cpu = 0; cpu < DEFER_RINGS; cpu++)
+    {
+        ring = &ulog_deferred_rings[cpu];
+        if (ring->magic != DEFER_RING_MAGIC)
+            continue;
+
+        tail = ring->tail;
+        while (tail != DEFER_LOAD_ACQUIRE(&ring->head))
+        {
+            record = (struct defer_record *)&ring->buf[tail & (ring->size - 1)];
+            info = DEFER_LOAD_ACQUIRE(&record->info);
+            /* still written */
+            if (info == 0)
+                break;
+
+            if ((DEFER_INFO_FLAGS(info) & DEFER_FLAG_PAD) == 0)
+            {
+                msg->level = DEFER_INFO_LEVEL(info);
+                msg->newline = (DEFER_INFO_FLAGS(info) & DEFER_FLAG_NEWLINE) != 0;
+                msg->tick = record->tick;
+                msg->tag = record->tag;
+                msg->thread_name[0] = '\0';
+                msg->is_isr = (DEFER_INFO_FLAGS(info) & DEFER_FLAG_ISR) != 0;
+#ifdef ULOG_OUTPUT_THREAD_NAME
+                rt_strncpy(msg->thread_name, record->thread, RT_NAME_MAX);
+                msg->thread_name[RT_NAME_MAX] = '\0';
+#endif
+                msg->text = text;
+                msg->text_len = defer_render(record, text, text_size);
+            }
+
+            /* the free space is zero */
+            rt_memset(record, 0, DEFER_INFO_SIZE(info));
+            tail += DEFER_INFO_SIZE(info);
+            DEFER_STORE_RELEASE(&ring->tail, tail);
+
+            if ((DEFER_INFO_FLAGS(info) & DEFER_FLAG_PAD) == 0)
+                return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+/**
+ * the number of the logs dropped as the rings were full
+ */
+rt_uint32_t ulog_deferred_dropped(void)
+{
+    rt_uint32_t dropped = 0;
+    int cpu;
+
+    for (cpu = 0; cpu < DEFER_RINGS; cpu++)
+        dropped += ulog_deferred_rings[cpu].dropped;
+
+    return dropped;
+}
+
+/**
+ * enable or disable the deferred format, the log is formatted by the caller when it is disabled
+ *
+ * @param enabled RT_TRUE: enabled, RT_FALSE: disabled
+ */
+void ulog_deferred_format_enabled(rt_bool_t enabled)
+{
+    defer_enabled = enabled;
+}
+
+void ulog_deferred_init(void)
+{
+    struct defer_ring *ring;
+    int cpu;
+
+    for (cpu = 0; cpu < DEFER_RINGS; cpu++)
+    {
+        ring = &ulog_deferred_rings[cpu];
+        rt_memset(ring, 0, sizeof(struct defer_ring));
+        ring->pointer_size = sizeof(void *);
+        ring->long_size = sizeof(long);
+        ring->record_size = sizeof(struct defer_record);
+        ring->size = ULOG_DEFERRED_BUF_SIZE;
+        DEFER_STORE_RELEASE(&ring->magic, DEFER_RING_MAGIC);
+    }
+}
+
+#endif /* ULOG_USING_DEFERRED_FORMAT */
@@ -337,6 +337,22 @@ typedef int (*init_fn_t)(void);
  */
 #define RT_ALIGN_DOWN(size, align)      ((size) & ~((align) - 1))
 
+/**
+ * @ingroup BasicDef
+ *
+ * @def RT_MIN(a, b)
+ * Return the smaller of a and b, which are evaluated twice.
+ */
+#define RT_MIN(a, b)                    ((a) < (b) ? (a) : (b))
+
+/**
+ * @ingroup BasicDef
+ *
+ * @def RT_MAX(a, b)
+ * Return the larger of a and b, which are evaluated twice.
+ */
+#define RT_MAX(a, b)                    ((a) > (b) ? (a) : (b))
+
 /**
  * @ingroup BasicDef
  *
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __BOARD_H__
+#define __BOARD_H__
+
+/*
+ * Board of the drivers of the BSP built on the host. A test only builds the
+ * parts of a driver which don't touch the hardware, the BSP_USING_* options
+ * are given by its CMakeLists.txt.
+ */
+
+#include <rtthread.h>
+
+#endif /* __BOARD_H__ */
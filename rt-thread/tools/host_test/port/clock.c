@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include <pthread.h>
+#include <time.h>
+
+#include "rthost.h"
+
+static rt_tick_t rt_tick = 0;
+static rt_thread_t _timer_thread;
+
+/* the tick is read without the lock, by the threads running at once */
+rt_tick_t rt_tick_get(void)
+{
+    return __atomic_load_n(&rt_tick, __ATOMIC_RELAXED);
+}
+
+void rt_tick_set(rt_tick_t tick)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    __atomic_store_n(&rt_tick, tick, __ATOMIC_RELAXED);
+    rt_hw_interrupt_enable(level);
+}
+
+/* no time slices, the threads of the host run at once */
+void rt_tick_increase(void)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    __atomic_add_fetch(&rt_tick, 1, __ATOMIC_RELAXED);
+    rt_hw_interrupt_enable(level);
+
+    rt_timer_check();
+
+#ifdef RT_USING_TIMER_SOFT
+    /* the timer thread suspends itself after it found no soft timer without
+     * the lock, a timer started right then by a thread running at the same
+     * time would be missed, so wake it when it sleeps without a timeout */
+    if (_timer_thread != RT_NULL)
+    {
+        level = rt_hw_interrupt_disable();
+        if ((_timer_thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND &&
+            rt_list_isempty(&(_timer_thread->tlist)) &&
+            (_timer_thread->thread_timer.parent.flag & RT_TIMER_FLAG_ACTIVATED) == 0)
+        {
+            rt_thread_resume(_timer_thread);
+        }
+        rt_hw_interrupt_enable(level);
+    }
+#endif /* RT_USING_TIMER_SOFT */
+}
+
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms)
+{
+    rt_tick_t tick;
+
+    if (ms < 0)
+    {
+        tick = (rt_tick_t)RT_WAITING_FOREVER;
+    }
+    else
+    {
+        tick = RT_TICK_PER_SECOND * (ms / 1000);
+        tick += (RT_TICK_PER_SECOND * (ms % 1000) + 999) / 1000;
+    }
+
+    return tick;
+}
+
+rt_tick_t rt_tick_get_millisecond(void)
+{
+    return rt_tick_get() * (1000u / RT_TICK_PER_SECOND);
+}
+
+static void *_tick_entry(void *parameter)
+{
+    struct timespec next;
+
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (1)
+    {
+        next.tv_nsec += 1000000000 / RT_TICK_PER_SECOND;
+        if (next.tv_nsec >= 1000000000)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, RT_NULL);
+
+        rt_interrupt_enter();
+        rt_tick_increase();
+        rt_interrupt_leave();
+    }
+
+    return RT_NULL;
+}
+
+void rt_host_tick_start(void)
+{
+    pthread_t tick;
+
+#ifdef RT_USING_TIMER_SOFT
+    _timer_thread = rt_thread_find("timer");
+#endif
+    pthread_create(&tick, RT_NULL, _tick_entry, RT_NULL);
+    pthread_detach(tick);
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "rthost.h"
+
+pthread_mutex_t rt_host_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the lock is taken by the first rt_hw_interrupt_disable() of a thread and
+ * nested by the others, every disable is paired with one enable */
+static __thread rt_base_t _lock_depth;
+static __thread rt_uint8_t _interrupt_nest;
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    if (_lock_depth == 0)
+    {
+        pthread_mutex_lock(&rt_host_lock);
+    }
+
+    return _lock_depth++;
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    RT_ASSERT(_lock_depth > 0);
+
+    if (--_lock_depth == 0)
+    {
+        pthread_mutex_unlock(&rt_host_lock);
+    }
+}
+
+rt_base_t rt_host_lock_save(void)
+{
+    rt_base_t depth = _lock_depth;
+
+    _lock_depth = 0;
+    return depth;
+}
+
+void rt_host_lock_restore(rt_base_t depth)
+{
+    _lock_depth = depth;
+}
+
+void rt_interrupt_enter(void)
+{
+    _interrupt_nest++;
+}
+
+void rt_interrupt_leave(void)
+{
+    _interrupt_nest--;
+}
+
+rt_uint8_t rt_interrupt_get_nest(void)
+{
+    return _interrupt_nest;
+}
+
+void rt_hw_us_delay(rt_uint32_t us)
+{
+    struct timespec now, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    end.tv_sec += us / 1000000;
+    end.tv_nsec += (us % 1000000) * 1000;
+    if (end.tv_nsec >= 1000000000)
+    {
+        end.tv_sec++;
+        end.tv_nsec -= 1000000000;
+    }
+
+    do
+    {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    }
+    while (now.tv_sec < end.tv_sec || (now.tv_sec == end.tv_sec && now.tv_nsec < end.tv_nsec));
+}
+
+void rt_hw_console_output(const char *str)
+{
+    fputs(str, stdout);
+    fflush(stdout);
+}
+
+void rt_hw_cpu_shutdown(void)
+{
+    exit(EXIT_FAILURE);
+}
+
+void *rt_malloc(rt_size_t size)
+{
+    return malloc(size);
+}
+
+void *rt_realloc(void *rmem, rt_size_t newsize)
+{
+    if (newsize == 0)
+    {
+        free(rmem);
+        return RT_NULL;
+    }
+
+    return realloc(rmem, newsize);
+}
+
+void *rt_calloc(rt_size_t count, rt_size_t size)
+{
+    return calloc(count, size);
+}
+
+void rt_free(void *rmem)
+{
+    free(rmem);
+}
+
+void rt_memory_info(rt_size_t *total, rt_size_t *used, rt_size_t *max_used)
+{
+    if (total != RT_NULL)
+        *total = 0;
+    if (used != RT_NULL)
+        *used = 0;
+    if (max_used != RT_NULL)
+        *max_used = 0;
+}
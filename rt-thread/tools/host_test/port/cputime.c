@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#include <rthw.h>
+#include <rtdevice.h>
+#include <rtthread.h>
+
+#include <time.h>
+
+/* Use the monotonic clock of the host in ns for CPU time */
+
+static float host_cputime_getres(void)
+{
+    return 1.0f;
+}
+
+static uint64_t host_cputime_gettime(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+const static struct rt_clock_cputime_ops _host_ops =
+{
+    host_cputime_getres,
+    host_cputime_gettime
+};
+
+int host_cputime_init(void)
+{
+    clock_cpu_setops(&_host_ops);
+
+    return 0;
+}
+INIT_BOARD_EXPORT(host_cputime_init);
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Ethernet device of the host test build, without a wire.
+ *
+ * The device is the default network interface with the static address of
+ * RT_LWIP_IPADDR and its link up. The frames sent are dropped and none is
+ * received, the tests of the sockets connect to the address of the
+ * interface, which lwIP loops back with LWIP_NETIF_LOOPBACK.
+ */
+
+#include <rtthread.h>
+
+#include <netif/ethernetif.h>
+
+static struct eth_device host_eth;
+
+static rt_err_t host_eth_control(rt_device_t dev, int cmd, void *args)
+{
+    static const rt_uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+    if (cmd == NIOCTL_GADDR && args != RT_NULL)
+    {
+        rt_memcpy(args, mac, sizeof(mac));
+        return RT_EOK;
+    }
+
+    return -RT_ERROR;
+}
+
+static struct pbuf *host_eth_rx(rt_device_t dev)
+{
+    return RT_NULL;
+}
+
+static rt_err_t host_eth_tx(rt_device_t dev, struct pbuf *p)
+{
+    return RT_EOK;
+}
+
+#ifdef RT_USING_DEVICE_OPS
+const static struct rt_device_ops host_eth_ops =
+{
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    RT_NULL,
+    host_eth_control
+};
+#endif
+
+int host_eth_init(void)
+{
+#ifdef RT_USING_DEVICE_OPS
+    host_eth.parent.ops = &host_eth_ops;
+#else
+    host_eth.parent.control = host_eth_control;
+#endif
+    host_eth.eth_rx = host_eth_rx;
+    host_eth.eth_tx = host_eth_tx;
+
+    return eth_device_init_with_flag(&host_eth, "e0",
+                                     NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | ETHIF_LINK_PHYUP);
+}
+INIT_DEVICE_EXPORT(host_eth_init);
@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * The directory entries of dfs instead of the ones of the host. The other
+ * headers of the common libc would conflict with the C library of the host.
+ */
+
+#include "../../../../components/libc/compilers/common/dirent.h"
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * The <sys/time.h> of the host, with the <time.h> the one of the common libc
+ * includes and the file systems rely on.
+ */
+
+#ifndef __HOST_SYS_TIME_H__
+#define __HOST_SYS_TIME_H__
+
+#include <time.h>
+#include_next <sys/time.h>
+
+#endif /* __HOST_SYS_TIME_H__ */
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+#ifndef __RTHOST_H__
+#define __RTHOST_H__
+
+#include <rtthread.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the interrupt lock, which is the one lock of the kernel */
+extern pthread_mutex_t rt_host_lock;
+
+/**
+ * hand over the interrupt lock held by the calling thread, before it waits
+ * on a condition variable with rt_host_lock or unlocks it
+ *
+ * @return the depth of the lock, for rt_host_lock_restore()
+ */
+rt_base_t rt_host_lock_save(void);
+void rt_host_lock_restore(rt_base_t depth);
+
+/**
+ * make the calling thread of the host an initialized RT-Thread thread, which
+ * runs from now on, e.g. the main thread of the process
+ */
+void rt_host_thread_adopt(rt_thread_t thread);
+
+/**
+ * start the thread of the host which increases the tick every 1/RT_TICK_PER_SECOND
+ */
+void rt_host_tick_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RTHOST_H__ */
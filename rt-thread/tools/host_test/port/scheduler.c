@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Scheduler of the host test build.
+ *
+ * Every RT-Thread thread runs on a thread of the host, all of them at once.
+ * The interrupt lock of cpuport.c is the one lock of the kernel, a suspended
+ * thread waits on its condition variable with the lock released, and it
+ * runs again once rt_schedule_insert_thread() made it ready. The priorities
+ * are kept for the kernel but the host doesn't order the threads by them.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include "rthost.h"
+
+struct host_thread
+{
+    pthread_t pthread;
+    pthread_cond_t cond;
+    rt_bool_t started;
+
+    void (*entry)(void *parameter);
+    void *parameter;
+    void (*exit)(void);
+};
+
+static __thread struct rt_thread *_current_thread;
+static rt_uint16_t _critical_level;
+
+#ifndef __on_rt_scheduler_hook
+    #define __on_rt_scheduler_hook(from, to)        __ON_HOOK_ARGS(rt_scheduler_hook, (from, to))
+#endif
+
+#ifdef RT_USING_HOOK
+static void (*rt_scheduler_hook)(struct rt_thread *from, struct rt_thread *to);
+
+void rt_scheduler_sethook(void (*hook)(struct rt_thread *from, struct rt_thread *to))
+{
+    rt_scheduler_hook = hook;
+}
+#endif /* RT_USING_HOOK */
+
+struct rt_thread **rt_host_current_thread(void)
+{
+    return &_current_thread;
+}
+
+rt_uint8_t *rt_hw_stack_init(void       *entry,
+                             void       *parameter,
+                             rt_uint8_t *stack_addr,
+                             void       *exit)
+{
+    struct host_thread *host;
+
+    /* the thread runs on the stack of its host thread, the sp keeps the context */
+    host = (struct host_thread *)calloc(1, sizeof(struct host_thread));
+    RT_ASSERT(host != RT_NULL);
+
+    pthread_cond_init(&host->cond, RT_NULL);
+    host->entry = (void (*)(void *))entry;
+    host->parameter = parameter;
+    host->exit = (void (*)(void))exit;
+
+    return (rt_uint8_t *)host;
+}
+
+/* the work of the idle thread for a closed thread, called with the lock */
+static void _thread_defunct(struct rt_thread *thread)
+{
+    struct host_thread *host = (struct host_thread *)thread->sp;
+
+    if (thread->cleanup != RT_NULL)
+    {
+        thread->cleanup(thread);
+    }
+
+    if (rt_object_is_systemobject((rt_object_t)thread) == RT_TRUE)
+    {
+        rt_object_detach((rt_object_t)thread);
+    }
+    else
+    {
+        RT_KERNEL_FREE(thread->stack_addr);
+        rt_object_delete((rt_object_t)thread);
+    }
+
+    pthread_cond_destroy(&host->cond);
+    free(host);
+}
+
+static void _thread_close(struct rt_thread *thread)
+{
+    _thread_defunct(thread);
+
+    _current_thread = RT_NULL;
+    rt_host_lock_save();
+    pthread_mutex_unlock(&rt_host_lock);
+    pthread_exit(RT_NULL);
+}
+
+static void _thread_run(struct rt_thread *thread)
+{
+    if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_READY)
+    {
+        thread->stat = RT_THREAD_RUNNING | (thread->stat & ~RT_THREAD_STAT_MASK);
+        RT_OBJECT_HOOK_CALL(rt_scheduler_hook, (RT_NULL, thread));
+    }
+}
+
+static void *_thread_entry(void *parameter)
+{
+    struct rt_thread *thread = (struct rt_thread *)parameter;
+    struct host_thread *host = (struct host_thread *)thread->sp;
+    rt_base_t level;
+
+    _current_thread = thread;
+
+    level = rt_hw_interrupt_disable();
+    if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_CLOSE)
+    {
+        _thread_close(thread);
+    }
+    _thread_run(thread);
+    rt_hw_interrupt_enable(level);
+
+    host->entry(host->parameter);
+    host->exit();
+
+    return RT_NULL;
+}
+
+void rt_host_thread_adopt(rt_thread_t thread)
+{
+    struct host_thread *host = (struct host_thread *)thread->sp;
+
+    RT_ASSERT((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_INIT);
+
+    host->pthread = pthread_self();
+    host->started = RT_TRUE;
+    thread->stat = RT_THREAD_RUNNING;
+    _current_thread = thread;
+}
+
+void rt_system_scheduler_init(void)
+{
+    _critical_level = 0;
+}
+
+void rt_schedule(void)
+{
+    struct rt_thread *thread = _current_thread;
+    struct host_thread *host;
+    rt_base_t level, depth;
+
+    /* the interrupts and the threads of the host don't switch */
+    if (thread == RT_NULL || rt_interrupt_get_nest() != 0)
+        return;
+
+    host = (struct host_thread *)thread->sp;
+    level = rt_hw_interrupt_disable();
+
+    if (_critical_level != 0)
+    {
+        rt_hw_interrupt_enable(level);
+        return;
+    }
+
+    while ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_SUSPEND)
+    {
+        depth = rt_host_lock_save();
+        pthread_cond_wait(&host->cond, &rt_host_lock);
+        rt_host_lock_restore(depth);
+    }
+
+    if ((thread->stat & RT_THREAD_STAT_MASK) == RT_THREAD_CLOSE)
+    {
+        _thread_close(thread);
+    }
+
+    _thread_run(thread);
+
+    if (thread->stat & RT_THREAD_STAT_YIELD_MASK)
+    {
+        thread->stat &= ~RT_THREAD_STAT_YIELD_MASK;
+
+        depth = rt_host_lock_save();
+        pthread_mutex_unlock(&rt_host_lock);
+        sched_yield();
+        pthread_mutex_lock(&rt_host_lock);
+        rt_host_lock_restore(depth);
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+void rt_schedule_insert_thread(struct rt_thread *thread)
+{
+    struct host_thread *host = (struct host_thread *)thread->sp;
+    pthread_attr_t attr;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+
+    thread->stat = RT_THREAD_READY | (thread->stat & ~RT_THREAD_STAT_MASK);
+
+    if (host->started)
+    {
+        pthread_cond_signal(&host->cond);
+    }
+    else
+    {
+        /* the first start of the thread, it waits for the lock */
+        host->started = RT_TRUE;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (pthread_create(&host->pthread, &attr, _thread_entry, thread) != 0)
+        {
+            rt_kprintf("can't create the host thread of %s\n", thread->name);
+            RT_ASSERT(0);
+        }
+        pthread_attr_destroy(&attr);
+    }
+
+    rt_hw_interrupt_enable(level);
+}
+
+void rt_schedule_remove_thread(struct rt_thread *thread)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    rt_list_remove(&(thread->tlist));
+    rt_hw_interrupt_enable(level);
+}
+
+void rt_thread_defunct_enqueue(rt_thread_t thread)
+{
+    struct host_thread *host = (struct host_thread *)thread->sp;
+
+    /* a thread closes itself in rt_schedule(), one that never ran is closed here */
+    if (host->started)
+    {
+        pthread_cond_signal(&host->cond);
+    }
+    else
+    {
+        _thread_defunct(thread);
+    }
+}
+
+void rt_enter_critical(void)
+{
+    /* keep the lock, the other threads wait for it */
+    rt_hw_interrupt_disable();
+    _critical_level++;
+}
+
+void rt_exit_critical(void)
+{
+    rt_uint16_t level;
+
+    RT_ASSERT(_critical_level > 0);
+
+    level = --_critical_level;
+    rt_hw_interrupt_enable(level);
+
+    if (level == 0)
+    {
+        rt_schedule();
+    }
+}
+
+rt_uint16_t rt_critical_level(void)
+{
+    return _critical_level;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     godmial      first version
+ */
+
+/*
+ * Start the kernel on the host and run one msh command of the test in the
+ * main thread: <test> <command> [args...]. The exit status is the one of a
+ * negative return of the command.
+ */
+
+#include <rthw.h>
+#include <rtthread.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rthost.h"
+
+typedef int (*cmd_function_t)(int argc, char **argv);
+
+extern const struct finsh_syscall __start_FSymTab[];
+extern const struct finsh_syscall __stop_FSymTab[];
+
+static struct rt_thread main_thread;
+ALIGN(RT_ALIGN_SIZE)
+static rt_uint8_t main_thread_stack[RT_MAIN_THREAD_STACK_SIZE];
+
+static void host_assert_hook(const char *ex, const char *func, rt_size_t line)
+{
+    rt_kprintf("(%s) assertion failed at function:%s, line number:%d \n", ex, func, (int)line);
+    abort();
+}
+
+static const struct finsh_syscall *host_cmd_find(const char *name)
+{
+    const struct finsh_syscall *call;
+
+    for (call = __start_FSymTab; call < __stop_FSymTab; call++)
+    {
+        if (strcmp(call->name, name) == 0)
+            return call;
+    }
+
+    return RT_NULL;
+}
+
+int main(int argc, char **argv)
+{
+    const struct finsh_syscall *call;
+    int result;
+
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <command> [args...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    call = host_cmd_find(argv[1]);
+    if (call == RT_NULL)
+    {
+        fprintf(stderr, "%s: command not found.\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    rt_assert_set_hook(host_assert_hook);
+
+    rt_system_timer_init();
+    rt_system_scheduler_init();
+
+    rt_thread_init(&main_thread, "main", RT_NULL, RT_NULL,
+                   main_thread_stack, sizeof(main_thread_stack),
+                   RT_MAIN_THREAD_PRIORITY, 20);
+    rt_host_thread_adopt(&main_thread);
+
+    rt_system_timer_thread_init();
+    rt_host_tick_start();
+
+    rt_components_board_init();
+    rt_components_init();
+
+    result = ((cmd_function_t)call->func)(argc - 1, argv + 1);
+
+    fflush(stdout);
+    return result < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -12,8 +12,8 @@ parser = argparse.ArgumentParser()
 parser.add_argument('rootdir', type=str, help='the path to rootfs')
 parser.add_argument('output', type=argparse.FileType('wb'), nargs='?', help='output file name')
 parser.add_argument('--dump', action='store_true', help='dump the fs hierarchy')
-parser.add_argument('--binary', action='store_true', help='output binary file')
-parser.add_argument('--addr', default='0', help='set the base address of the binary file, default to 0.')
+parser.add_argument('--binary', action='store_true', help='output binary file, it can be mounted with dfs_romfs_image()')
+parser.add_argument('--addr', default='0', help='set the base address of the binary file, default to 0. An image in RAM is relocated when it is mounted, an image in flash must be at this address.')
 
 class File(object):
     def __init__(self, name):
@@ -32,7 +32,8 @@ class File(object):
     def bin_name(self):
         # Pad to 4 bytes boundary with \0
         pad_len = 4
-        bn = self._name + '\0' * (pad_len - len(self._name) % pad_len)
+        bn = self._name.encode('utf-8')
+        bn += b'\0' * (pad_len - len(bn) % pad_len)
         return bn
 
     def c_data(self, prefix=''):
@@ -59,7 +60,8 @@ class File(object):
         print('%s%s' % (' ' * indent, self._name))
 
 class Folder(object):
-    bin_fmt = struct.Struct('IIII')
+    # the dirent of a 32-bit little endian target
+    bin_fmt = struct.Struct('<IIII')
     bin_item = namedtuple('dirent', 'type, name, data, size')
 
     def __init__(self, name):
@@ -79,7 +81,8 @@ class Folder(object):
     def bin_name(self):
         # Pad to 4 bytes boundary with \0
         pad_len = 4
-        bn = self._name + '\0' * (pad_len - len(self._name) % pad_len)
+        bn = self._name.encode('utf-8')
+        bn += b'\0' * (pad_len - len(bn) % pad_len)
         return bn
 
     def walk(self):
@@ -191,7 +194,7 @@ class Folder(object):
             else:
                 assert False, 'Unkown instance:%s' % str(c)
 
-            name = bytes(c.bin_name)
+            name = c.bin_name
             name_addr = v_len
             v_len += len(name)
 
@@ -200,7 +203,7 @@ class Folder(object):
             # pad the data to 4 bytes boundary
             pad_len = 4
             if len(data) % pad_len != 0:
-                data += '\0' * (pad_len - len(data) % pad_len)
+                data += b'\0' * (pad_len - len(data) % pad_len)
             v_len += len(data)
 
             d_li.append(self.bin_fmt.pack(*self.bin_item(
@@ -232,7 +235,7 @@ const struct romfs_dirent {name} = {{
 
 def get_bin_data(tree, base_addr):
     v_len = base_addr + Folder.bin_fmt.size
-    name = bytes('/\0\0\0')
+    name = b'/\0\0\0'
     name_addr = v_len
     v_len += len(name)
     data_addr = v_len
@@ -262,6 +265,6 @@ if __name__ == '__main__':
 
     output = args.output
     if not output:
-        output = sys.stdout
+        output = sys.stdout.buffer
 
     output.write(data)
@@ -0,0 +1,238 @@
+#!/usr/bin/env python
+
+# Render the logs of the deferred format of ulog (ULOG_USING_DEFERRED_FORMAT)
+# that are still in a memory dump of ulog_deferred_rings, e.g. after a crash.
+#
+# The records keep the addresses of the tag and the format, they are read
+# from the ELF of the firmware. Dump the rings with the debugger, e.g. gdb:
+#
+#   dump binary value rings.bin ulog_deferred_rings
+#
+# then: ulog_decode.py rtthread.elf rings.bin
+
+import sys
+import struct
+
+import argparse
+parser = argparse.ArgumentParser()
+parser.add_argument('elf', type=argparse.FileType('rb'), help='the ELF of the firmware')
+parser.add_argument('dump', type=argparse.FileType('rb'), help='the binary dump of ulog_deferred_rings')
+
+RING_MAGIC = 0x52444c55
+RING_HEADER = '<IBBHIIII'
+
+FLAG_NEWLINE = 0x01
+FLAG_ISR = 0x02
+FLAG_PAD = 0x04
+
+LEVELS = {0: 'A', 3: 'E', 4: 'W', 6: 'I', 7: 'D'}
+
+ARG_NONE, ARG_INT, ARG_LONG, ARG_LLONG, ARG_PTR, ARG_DOUBLE, ARG_STR = range(7)
+
+class Elf(object):
+    '''The allocated sections of an ELF, to read the strings by their address.'''
+
+    def __init__(self, data):
+        if data[:4] != b'\x7fELF':
+            raise ValueError('not an ELF file')
+        self.is64 = data[4] == 2 or data[4] == b'\x02'
+        self.endian = '<' if data[5] == 1 or data[5] == b'\x01' else '>'
+        self.sections = []
+
+        if self.is64:
+            shoff, = struct.unpack_from(self.endian + 'Q', data, 0x28)
+            shentsize, shnum = struct.unpack_from(self.endian + 'HH', data, 0x3a)
+            section = self.endian + 'IIQQQQ'
+        else:
+            shoff, = struct.unpack_from(self.endian + 'I', data, 0x20)
+            shentsize, shnum = struct.unpack_from(self.endian + 'HH', data, 0x2e)
+            section = self.endian + 'IIIIII'
+
+        for i in range(shnum):
+            _, sh_type, flags, addr, offset, size = struct.unpack_from(section, data, shoff + i * shentsize)
+            # SHF_ALLOC, not SHT_NOBITS
+            if flags & 0x2 and sh_type != 8 and size:
+                self.sections.append((addr, data[offset:offset + size]))
+
+    def string(self, addr):
+        for base, content in self.sections:
+            if base <= addr < base + len(content):
+                end = content.find(b'\0', addr - base)
+                if end < 0:
+                    end = len(content)
+                return content[addr - base:end].decode('utf-8', 'replace')
+        return '<0x%x?>' % addr
+
+def parse(fmt, pos):
+    '''The next conversion of the format past the '%' like defer_parse() of ulog_deferred.c.
+
+    return (the end of the conversion, the number of '*', the kind, the python spec)'''
+    start = pos
+    stars = 0
+    while pos < len(fmt) and fmt[pos] in '-+ #0':
+        pos += 1
+    if pos < len(fmt) and fmt[pos] == '*':
+        stars += 1
+        pos += 1
+    while pos < len(fmt) and fmt[pos].isdigit():
+        pos += 1
+    if pos < len(fmt) and fmt[pos] == '.':
+        pos += 1
+        if pos < len(fmt) and fmt[pos] == '*':
+            stars += 1
+            pos += 1
+        while pos < len(fmt) and fmt[pos].isdigit():
+            pos += 1
+    spec = fmt[start:pos]
+
+    longs = 0
+    while pos < len(fmt):
+        if fmt[pos] in 'lzt':
+            longs += 1
+        elif fmt[pos] in 'Lqj':
+            longs += 2
+        elif fmt[pos] != 'h':
+            break
+        pos += 1
+
+    if pos >= len(fmt):
+        return pos, stars, ARG_NONE, None
+    conv = fmt[pos]
+    if conv in 'diuoxXc':
+        kind = ARG_INT if longs == 0 else (ARG_LONG if longs == 1 else ARG_LLONG)
+    elif conv in 'pn':
+        kind = ARG_PTR
+    elif conv in 'fFeEgGaA':
+        kind = ARG_DOUBLE
+        conv = {'a': 'e', 'A': 'E'}.get(conv, conv)
+    elif conv == 's':
+        kind = ARG_STR
+    else:
+        kind = ARG_NONE
+    return pos + 1, stars, kind, '%' + spec + conv
+
+class Record(object):
+    def __init__(self, ring, buf, pos):
+        self.info, self.tick = struct.unpack_from('<II', buf, pos)
+        self.size = self.info & 0xffff
+        self.level = (self.info >> 16) & 0xff
+        self.flags = self.info >> 24
+        if self.flags & FLAG_PAD:
+            return
+
+        ptr = 'Q' if ring.pointer_size == 8 else 'I'
+        self.tag, self.format = struct.unpack_from('<' + ptr + ptr, buf, pos + 8)
+        thread = pos + 8 + 2 * ring.pointer_size
+        self.thread = buf[thread:pos + ring.record_size].split(b'\0')[0].decode('utf-8', 'replace')
+        self.args = buf[pos + ring.record_size:pos + self.size]
+
+class Ring(object):
+    def __init__(self, dump, offset):
+        (self.magic, self.pointer_size, self.long_size, self.record_size, self.size,
+         self.head, self.tail, self.dropped) = struct.unpack_from(RING_HEADER, dump, offset)
+        start = offset + struct.calcsize(RING_HEADER)
+        self.buf = dump[start:start + self.size]
+        self.end = start + self.size
+
+    def records(self):
+        tail = self.tail
+        while tail != self.head:
+            pos = tail & (self.size - 1)
+            if pos + 4 > len(self.buf):
+                break
+            record = Record(self, self.buf, pos)
+            # still written at the dump
+            if record.info == 0 or record.size == 0:
+                break
+            if not record.flags & FLAG_PAD:
+                yield record
+            tail = (tail + record.size) & 0xffffffff
+
+    def align(self, size):
+        return (size + self.pointer_size - 1) & ~(self.pointer_size - 1)
+
+    def render(self, elf, record):
+        '''The text of the record like defer_render() of ulog_deferred.c'''
+        fmt = elf.string(record.format)
+        args = record.args
+        sizes = {ARG_INT: 4, ARG_LONG: self.long_size, ARG_LLONG: 8, ARG_PTR: self.pointer_size, ARG_DOUBLE: 8}
+        text = ''
+        pos = 0
+        offset = 0
+
+        while pos < len(fmt):
+            if fmt[pos] != '%':
+                text += fmt[pos]
+                pos += 1
+                continue
+            if fmt[pos + 1:pos + 2] == '%':
+                text += '%'
+                pos += 2
+                continue
+
+            pos, stars, kind, spec = parse(fmt, pos + 1)
+            if kind == ARG_NONE:
+                continue
+
+            values = []
+            for _ in range(stars):
+                if offset + self.align(4) > len(args):
+                    return text + '...'
+                values.append(int.from_bytes(args[offset:offset + 4], 'little', signed=True))
+                offset += self.align(4)
+
+            if kind == ARG_STR:
+                if offset + self.align(3) > len(args):
+                    return text + '...'
+                length, = struct.unpack_from('<H', args, offset)
+                size = 2 + length + 1
+            else:
+                size = sizes[kind]
+            if offset + self.align(size) > len(args):
+                return text + '...'
+
+            if kind == ARG_STR:
+                value = args[offset + 2:offset + 2 + length].decode('utf-8', 'replace')
+            elif kind == ARG_DOUBLE:
+                value, = struct.unpack_from('<d', args, offset)
+            else:
+                # the C signedness is in the conversion
+                value = int.from_bytes(args[offset:offset + size], 'little', signed=spec[-1] in 'di')
+            offset += self.align(size)
+
+            if spec[-1] == 'n':
+                continue
+            if spec[-1] == 'p':
+                spec = '0x%' + spec[1:-1] + 'x'
+            elif spec[-1] == 'u':
+                spec = spec[:-1] + 'd'
+            text += spec % tuple(values + [value])
+
+        return text
+
+def main():
+    args = parser.parse_args()
+    elf = Elf(args.elf.read())
+    dump = args.dump.read()
+
+    offset = 0
+    cpu = 0
+    while offset + struct.calcsize(RING_HEADER) <= len(dump):
+        ring = Ring(dump, offset)
+        if ring.magic != RING_MAGIC:
+            if cpu == 0:
+                sys.exit('no ulog_deferred_rings in the dump')
+            break
+
+        print('cpu %d: %d logs dropped' % (cpu, ring.dropped))
+        for record in ring.records():
+            thread = 'ISR' if record.flags & FLAG_ISR else record.thread
+            print('[%u] %s/%s %s: %s' % (record.tick, LEVELS.get(record.level, '?'), elf.string(record.tag),
+                                         thread, ring.render(elf, record)))
+
+        # the next ring, struct defer_ring is aligned to 4 bytes
+        offset = (ring.end + 3) & ~3
+        cpu += 1
+
+if __name__ == '__main__':
+    main()
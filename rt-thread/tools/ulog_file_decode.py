@@ -0,0 +1,108 @@
+#!/usr/bin/env python
+
+# Print the log files of the file backend of ulog (ULOG_BACKEND_USING_FILE),
+# e.g. copied from the SD card. Give the files oldest first:
+#
+#   ulog_file_decode.py log_2.ulz log_1.ulz log.ulz
+#
+# Every block starts at a sector, a sector that doesn't start a valid block,
+# e.g. of a block cut by a power loss, is skipped like ulog_file_backend_read()
+# of file_be.c does.
+
+import sys
+import struct
+import zlib
+
+import argparse
+parser = argparse.ArgumentParser()
+parser.add_argument('files', nargs='+', type=argparse.FileType('rb'), help='the log files, oldest first')
+parser.add_argument('-s', '--sector', type=int, default=512, help='ULOG_FILE_BE_SECTOR_SIZE, default: 512')
+parser.add_argument('-q', '--seq', action='store_true', help='print the sequence number of every block')
+
+BLOCK_MAGIC = 0x425a4c55
+BLOCK_HEADER = '<IIIII'
+
+def lz4_decompress(src, size):
+    '''The lines of a block in the LZ4 block format, None when it is corrupt.'''
+    dst = bytearray()
+    pos = 0
+
+    def length(pos, value):
+        if value == 15:
+            while True:
+                if pos >= len(src):
+                    return pos, None
+                value += src[pos]
+                pos += 1
+                if src[pos - 1] != 255:
+                    break
+        return pos, value
+
+    while pos < len(src):
+        token = src[pos]
+        pos, literals = length(pos + 1, token >> 4)
+        if literals is None or pos + literals > len(src):
+            return None
+        dst += src[pos:pos + literals]
+        pos += literals
+        # the last sequence has no match
+        if pos == len(src):
+            break
+
+        if pos + 2 > len(src):
+            return None
+        offset, = struct.unpack_from('<H', src, pos)
+        pos, match = length(pos + 2, token & 15)
+        if match is None or offset == 0 or offset > len(dst):
+            return None
+        match += 4
+        # the match may overlap the bytes it copies
+        for _ in range(match):
+            dst.append(dst[-offset])
+
+    return bytes(dst) if len(dst) == size else None
+
+def blocks(data, sector):
+    '''The (seq, lines) of the valid blocks and the number of the skipped sectors.'''
+    header = struct.calcsize(BLOCK_HEADER)
+    result = []
+    skipped = 0
+    pos = 0
+
+    while pos + sector <= len(data):
+        magic, seq, raw_size, data_size, crc = struct.unpack_from(BLOCK_HEADER, data, pos)
+        total = (header + data_size + sector - 1) // sector * sector
+        if (magic != BLOCK_MAGIC or raw_size == 0 or data_size > raw_size or pos + total > len(data) or
+                zlib.crc32(data[pos + header:pos + header + data_size], zlib.crc32(data[pos:pos + header - 4])) != crc):
+            skipped += 1
+            pos += sector
+            continue
+
+        payload = data[pos + header:pos + header + data_size]
+        lines = lz4_decompress(payload, raw_size) if data_size < raw_size else payload
+        if lines is None:
+            skipped += 1
+            pos += sector
+            continue
+
+        result.append((seq, lines))
+        pos += total
+
+    return result, skipped
+
+def main():
+    args = parser.parse_args()
+    out = sys.stdout.buffer if hasattr(sys.stdout, 'buffer') else sys.stdout
+
+    for f in args.files:
+        result, skipped = blocks(f.read(), args.sector)
+        for seq, lines in result:
+            if args.seq:
+                out.write(b'--- block %d\n' % seq)
+            out.write(lines)
+        out.flush()
+        if skipped:
+            sys.stderr.write('%s: %d sectors skipped\n' % (f.name, skipped))
+
+if __name__ == '__main__':
+    main()
@@ -85,8 +85,10 @@
 
 #define RT_USING_DEVICE_IPC
 #define RT_USING_SERIAL
-#define RT_USING_SERIAL_V1
-#define RT_SERIAL_RB_BUFSZ 64
+#define RT_USING_SERIAL_V2
+#define RT_SERIAL_USING_DMA
+#define RT_SERIAL_USING_BUF_MEMHEAP
+#define RT_SERIAL_BUF_MEMHEAP "sdram"
 #define RT_USING_PIN
 
 /* Using USB */
@@ -307,4 +309,15 @@
 /* end of samples: kernel and components samples */
 #define RT_STUDIO_BUILT_IN
 
+/* Apollo Board Config */
+
+#define BSP_LVGL_DRAW_DMA2D
+#define BSP_LVGL_GRAD_CACHE_SIZE 16384
+#define BSP_LVGL_GRAD_CACHE_IN_SDRAM
+#define BSP_UART1_RX_USING_DMA
+#define BSP_UART1_TX_USING_DMA
+#define BSP_UART1_RX_BUFSIZE 1024
+#define BSP_UART1_TX_BUFSIZE 256
+/* end of Apollo Board Config */
+
 #endif